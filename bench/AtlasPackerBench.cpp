@@ -0,0 +1,69 @@
+#include "gfx/AtlasPacker.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// UI/スプライト相当の 8..64px の矩形を、入らなくなるまで詰める。args: ページの辺
+void BM_AtlasFill(benchmark::State& state) {
+    const uint32_t page = uint32_t(state.range(0));
+    double inserted = 0.0, occupancy = 0.0;
+    for (auto _ : state) {
+        AtlasPacker packer(page, page);
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<uint32_t> side(8, 64);
+        AtlasRect r;
+        uint32_t count = 0, misses = 0;
+        // 大きい矩形が入らなくなっても小さいものは入るので、連続で 32 回外れたら満杯とみなす
+        while (misses < 32) {
+            if (packer.Insert(side(rng), side(rng), r)) {
+                ++count;
+                misses = 0;
+            } else {
+                ++misses;
+            }
+        }
+        inserted = count;
+        occupancy = packer.GetOccupancy();
+        benchmark::DoNotOptimize(r);
+    }
+    state.counters["rects"] = inserted;
+    state.counters["occupancy"] = occupancy;
+    state.counters["insert/s"] = benchmark::Counter(inserted, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// 8 割まで詰めたページで、ランダムに 1 つ返却して新しい矩形を 1 つ入れる操作を繰り返す（断片化の影響を見る）
+void BM_AtlasChurn(benchmark::State& state) {
+    const uint32_t page = uint32_t(state.range(0));
+    AtlasPacker packer(page, page);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint32_t> side(8, 64);
+    std::vector<AtlasRect> live;
+    AtlasRect r;
+    while (packer.GetOccupancy() < 0.8f && packer.Insert(side(rng), side(rng), r)) live.push_back(r);
+
+    uint64_t attempts = 0, failures = 0;
+    for (auto _ : state) {
+        const size_t victim = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+        packer.Remove(live[victim]);
+        live[victim] = live.back();
+        live.pop_back();
+        ++attempts;
+        if (packer.Insert(side(rng), side(rng), r)) {
+            live.push_back(r);
+        } else {
+            ++failures;
+        }
+    }
+    state.counters["occupancy"] = packer.GetOccupancy();
+    state.counters["freeRects"] = double(packer.GetFreeRectCount());
+    state.counters["failRate"] = attempts ? double(failures) / double(attempts) : 0.0;
+}
+
+} // namespace
+
+BENCHMARK(BM_AtlasFill)->ArgName("page")->Arg(1024)->Arg(2048)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AtlasChurn)->ArgName("page")->Arg(1024)->Arg(2048)->Iterations(20000);
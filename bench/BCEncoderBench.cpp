@@ -0,0 +1,39 @@
+#include "gfx/BCEncoder.h"
+#include "BenchImages.h"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// 1024x1024 を 1 枚圧縮する。args: 形式, 品質, 並列
+void BM_EncodeBC(benchmark::State& state) {
+    const BCFormat format = BCFormat(state.range(0));
+    const Image img = MakeBenchImage(1024, 1024);
+    const size_t pitch = BCRowPitch(format, img.width);
+    std::vector<uint8_t> out(BCSurfaceSize(format, img.width, img.height));
+    BCEncodeOptions opt;
+    opt.format = format;
+    opt.quality = BCQuality(state.range(1));
+    opt.parallel = state.range(2) != 0;
+    for (auto _ : state) {
+        EncodeBC(img.View(), opt, out.data(), pitch);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["MPix"] = benchmark::Counter(double(img.width) * img.height / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void EncodeArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "format", "high", "parallel" });
+    for (BCFormat f : { BCFormat::BC1, BCFormat::BC3, BCFormat::BC4, BCFormat::BC5, BCFormat::BC7 }) {
+        for (int q = 0; q < 2; ++q) b->Args({ int64_t(f), q, 0 });
+    }
+    // 並列の伸びは代表的な形式だけ見る
+    b->Args({ int64_t(BCFormat::BC1), 0, 1 });
+    b->Args({ int64_t(BCFormat::BC7), 1, 1 });
+}
+
+} // namespace
+
+BENCHMARK(BM_EncodeBC)->Apply(EncodeArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,30 @@
+#pragma once
+#include "gfx/ImageData.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace jisaku {
+
+// ベンチマーク用の RGBA8 入力。グラデーション + ノイズ + 硬い縁で、単色ばかりの画像より実データに近い
+inline Image MakeBenchImage(uint32_t width, uint32_t height, uint32_t seed = 1) {
+    Image img;
+    img.Allocate(width, height);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> noise(-8, 8);
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* row = img.View().Row(y);
+        for (uint32_t x = 0; x < width; ++x) {
+            const float u = float(x) / float(width), v = float(y) / float(height);
+            int r = int(255.0f * u), g = int(255.0f * v), b = int(128.0f + 127.0f * std::sin(12.0f * (u + v)));
+            if ((x / 53 + y / 41) % 4 == 0) r = 255 - r;
+            row[x * 4 + 0] = uint8_t(std::clamp(r + noise(rng), 0, 255));
+            row[x * 4 + 1] = uint8_t(std::clamp(g + noise(rng), 0, 255));
+            row[x * 4 + 2] = uint8_t(std::clamp(b + noise(rng), 0, 255));
+            row[x * 4 + 3] = uint8_t(x < width / 2 ? 255 : int(255.0f * v));
+        }
+    }
+    return img;
+}
+
+} // namespace jisaku
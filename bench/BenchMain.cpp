@@ -0,0 +1,29 @@
+#include "core/CpuFeatures.h"
+#include "tools/ShaderFarm.h"
+#include <benchmark/benchmark.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <string_view>
+
+using namespace jisaku;
+
+// SIMD カーネルは実行時に振り分けるので、どの経路で測ったかを結果に残す
+int main(int argc, char** argv) {
+    // ShaderFarmBench がローカルのワーカーとして自分を起動したとき（JisakuShaderPack --worker と同じ）
+    if (argc >= 2 && std::string_view(argv[1]) == "--worker") {
+        spdlog::set_default_logger(spdlog::stderr_color_st("worker"));
+        const std::string dxc = argc >= 4 && std::string_view(argv[2]) == "--dxc" ? argv[3] : "dxc";
+        std::unique_ptr<FarmChannel> channel = MakeStdioChannel();
+        RunFarmWorker(*channel, dxc, QueryDxcVersion(dxc));
+        return 0;
+    }
+
+    const CpuFeatures& cpu = GetCpuFeatures();
+    benchmark::AddCustomContext("jisaku_simd", cpu.avx2 ? "avx2" : cpu.sse41 ? "sse4.1" : "scalar");
+    benchmark::AddCustomContext("jisaku_f16c", cpu.f16c ? "yes" : "no");
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace jisaku {
+
+// dxc の代わりに、引数を読んで -Fo（と、あれば -Fc）を書くだけのシェルスクリプト。
+// プロセスの起動・やり取り・キャッシュといった dxc の外側の手間だけを測るときに使う
+inline const char* const kBenchFakeDxc = R"sh(#!/bin/sh
+if [ "$1" = "--version" ]; then echo "fake-dxc 1.0 (bench)"; exit 0; fi
+fc=
+while [ $# -gt 1 ]; do
+  case "$1" in
+    -Fo) fo=$2; shift 2 ;;
+    -Fc) fc=$2; shift 2 ;;
+    -T|-E|-Fe|-D) shift 2 ;;
+    *) shift ;;
+  esac
+done
+cat "$1" > "$fo" && { [ -z "$fc" ] || echo "; listing" > "$fc"; }
+)sh";
+
+// JISAKU_BENCH_DXC があればそれを、無ければ directory に置いた kBenchFakeDxc を返す
+inline std::string PrepareBenchDxc(const std::filesystem::path& directory) {
+    if (const char* env = std::getenv("JISAKU_BENCH_DXC"); env && *env) return env;
+    const std::filesystem::path script = directory / "fake-dxc.sh";
+    std::ofstream(script, std::ios::binary) << kBenchFakeDxc;
+    std::filesystem::permissions(script, std::filesystem::perms::owner_all);
+    return script.string();
+}
+
+// RenderPass_TexturedQuad 程度の VSMain / PSMain。FEATURE0..(featureBits - 1) の define で PS が少しずつ変わる
+inline std::string MakeBenchShaderSource(uint32_t featureBits) {
+    std::string source = "cbuffer Frame : register(b0) { float4x4 viewProj; float4 tint; float time; };\n"
+                         "Texture2D tex : register(t0);\nSamplerState samp : register(s0);\n"
+                         "struct VSIn { float3 pos : POSITION; float2 uv : TEXCOORD0; };\n"
+                         "struct PSIn { float4 pos : SV_Position; float2 uv : TEXCOORD0; };\n"
+                         "PSIn VSMain(VSIn v) { PSIn o; o.pos = mul(viewProj, float4(v.pos, 1)); o.uv = v.uv; return o; }\n"
+                         "float4 PSMain(PSIn i) : SV_Target {\n  float4 c = tex.Sample(samp, i.uv) * tint;\n";
+    for (uint32_t f = 0; f < featureBits; ++f) {
+        const std::string n = std::to_string(f);
+        source += "#if FEATURE";
+        source += n;
+        source += "\n  c.rgb = lerp(c.rgb, c.gbr, 0.1 * sin(time + ";
+        source += n;
+        source += "));\n#endif\n";
+    }
+    source += "  return c;\n}\n";
+    return source;
+}
+
+} // namespace jisaku
@@ -0,0 +1,136 @@
+#include "core/AtomicFile.h"
+#include "core/Compression.h"
+#include "core/Vfs.h"
+#include "BenchImages.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// 格子メッシュの頂点バッファ（位置 + 法線 + UV の float x 8）。規則的なので画像より縮む
+std::vector<uint8_t> MakeMeshPayload(uint32_t side) {
+    std::vector<float> v;
+    v.reserve(size_t(side) * side * 8);
+    for (uint32_t y = 0; y < side; ++y) {
+        for (uint32_t x = 0; x < side; ++x) {
+            const float u = float(x) / float(side - 1), w = float(y) / float(side - 1);
+            v.insert(v.end(), { u * 100.0f, 0.0f, w * 100.0f, 0.0f, 1.0f, 0.0f, u, w });
+        }
+    }
+    std::vector<uint8_t> bytes(v.size() * sizeof(float));
+    std::memcpy(bytes.data(), v.data(), bytes.size());
+    return bytes;
+}
+
+// 約 16 MB。0: 2048x2048 RGBA8 のテクスチャ（ノイズ入りでほぼ縮まない）, 1: 頂点バッファ
+const std::vector<uint8_t>& Payload(int64_t kind) {
+    static const std::vector<uint8_t> s_texture = MakeBenchImage(2048, 2048).pixels;
+    static const std::vector<uint8_t> s_mesh = MakeMeshPayload(724);
+    return kind == 0 ? s_texture : s_mesh;
+}
+
+// args: データ, コーデック, level, チャンクサイズ(KB)
+bool CompressPayload(benchmark::State& state, ChunkedData& out) {
+    const auto& src = Payload(state.range(0));
+    if (!CompressChunked(src.data(), src.size(), Codec(state.range(1)), int(state.range(2)), uint32_t(state.range(3)) * 1024, out)) {
+        state.SkipWithError("compress failed");
+        return false;
+    }
+    return true;
+}
+
+void SetRatioCounter(benchmark::State& state, const ChunkedData& c) {
+    state.counters["ratio"] = double(c.rawSize) / double(c.data.size());
+}
+
+// 全チャンクを JobSystem で並列に展開する（パックから読むときと同じ経路）
+void BM_DecompressChunked(benchmark::State& state) {
+    ChunkedData c;
+    if (!CompressPayload(state, c)) return;
+    std::vector<uint8_t> dst(c.rawSize);
+    for (auto _ : state) {
+        if (!DecompressChunked(c, dst.data())) state.SkipWithError("decompress failed");
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(c.rawSize));
+    SetRatioCounter(state, c);
+}
+
+// 同じデータを 1 スレッドでチャンク順に展開する（並列化の効果を見る基準）
+void BM_DecompressSerial(benchmark::State& state) {
+    ChunkedData c;
+    if (!CompressPayload(state, c)) return;
+    std::vector<uint8_t> dst(c.rawSize);
+    for (auto _ : state) {
+        size_t in = 0;
+        for (uint32_t i = 0; i < c.chunkSizes.size(); ++i) {
+            const uint64_t rawOffset = uint64_t(i) * c.chunkSize;
+            const size_t raw = size_t(std::min<uint64_t>(c.chunkSize, c.rawSize - rawOffset));
+            if (!DecompressChunk(c.codec, c.data.data() + in, c.chunkSizes[i], dst.data() + rawOffset, raw)) state.SkipWithError("decompress failed");
+            in += c.chunkSizes[i];
+        }
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(c.rawSize));
+    SetRatioCounter(state, c);
+}
+
+void BM_CompressChunked(benchmark::State& state) {
+    ChunkedData c;
+    for (auto _ : state) {
+        if (!CompressPayload(state, c)) return;
+        benchmark::DoNotOptimize(c.data.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(Payload(state.range(0)).size()));
+    SetRatioCounter(state, c);
+}
+
+void CodecArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "data", "codec", "level", "chunkKB" });
+    for (int64_t data : { 0, 1 }) {
+        for (int64_t chunk : { 64, 128, 256 }) {
+            b->Args({ data, int64_t(Codec::LZ4), 0, chunk });
+            b->Args({ data, int64_t(Codec::Zstd), 0, chunk });
+        }
+        b->Args({ data, int64_t(Codec::LZ4), 9, 128 }); // HC
+        b->Args({ data, int64_t(Codec::Zstd), 19, 128 });
+    }
+}
+
+// パックに入れた 16 MB のエントリを Vfs::ReadFile で読み終えるまで（I/O + 展開）。args: データ, コーデック
+void BM_PackLoadLatency(benchmark::State& state) {
+    const Codec codec = Codec(state.range(1));
+    const std::filesystem::path root = CreateTempDirectory("jisaku-compbench-");
+    const auto& src = Payload(state.range(0));
+    WriteFileAtomic(root / "payload.bin", src.data(), src.size());
+    if (!WritePack(root / "assets.jpak", { { "payload.bin", root / "payload.bin", codec, 0 } })) {
+        state.SkipWithError("pack failed");
+        return;
+    }
+    {
+        AsyncIo io;
+        Vfs vfs(io);
+        vfs.MountPack("", root / "assets.jpak");
+        std::vector<uint8_t> out;
+        for (auto _ : state) {
+            if (!vfs.ReadFile("payload.bin", out) || out.size() != src.size()) state.SkipWithError("read failed");
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.counters["packMB"] = double(std::filesystem::file_size(root / "assets.jpak")) / 1e6;
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(src.size()));
+}
+
+} // namespace
+
+BENCHMARK(BM_CompressChunked)->Apply(CodecArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_DecompressChunked)->Apply(CodecArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_DecompressSerial)->Apply(CodecArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_PackLoadLatency)->ArgNames({ "data", "codec" })->ArgsProduct({ { 0, 1 }, { 0, 1, 2 } })->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,137 @@
+#include "core/AssetManifest.h"
+#include "core/AtomicFile.h"
+#include "core/MappedFile.h"
+#include "tools/AssetCook.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace jisaku;
+
+// アセットビルドのうち、クック以外（入力のハッシュ・ストアの照会・マニフェスト）を測る。
+// クック自体（デコード・ミップ・BC 圧縮）は MipGenerator / BCEncoder のベンチマークを参照
+
+namespace {
+
+constexpr uint32_t kInputCount = 3000;
+constexpr size_t kInputSize = 64 * 1024; // 128x128 RGBA の TGA 相当
+
+// AssetCook の MakeCookKey と同じ組み立て（ツールのバージョン + 種類 + 設定 + 入力の中身）
+ContentKey CookKey(const ContentKey& inputHash) {
+    std::string source = std::string(kCookToolVersion) + '\0' + "texture" + '\0' + "bc=bc7;q=high;mip=kaiser" + '\0';
+    source.append(reinterpret_cast<const char*>(&inputHash), sizeof(inputHash));
+    return HashContent(source.data(), source.size());
+}
+
+// 入力 kInputCount 個と、それを全部クック済みのストア（ウォームビルドの状態）
+struct StoreCorpus {
+    std::filesystem::path root;
+    std::filesystem::path objects;
+    std::vector<std::filesystem::path> inputs;
+
+    StoreCorpus() {
+        root = CreateTempDirectory("jisaku-storebench-");
+        objects = root / "objects";
+        std::mt19937 rng(1);
+        std::vector<uint8_t> bytes(kInputSize);
+        for (uint32_t i = 0; i < kInputCount; ++i) {
+            for (uint8_t& b : bytes) b = uint8_t(rng());
+            inputs.push_back(root / "in" / (std::to_string(i) + ".tga"));
+            std::filesystem::create_directories(inputs.back().parent_path());
+            WriteFileAtomic(inputs.back(), bytes.data(), bytes.size());
+            const std::filesystem::path object = ContentObjectPath(objects, CookKey(HashContent(bytes.data(), bytes.size())));
+            std::filesystem::create_directories(object.parent_path());
+            WriteFileAtomic(object, bytes.data(), 1024);
+        }
+    }
+
+    ~StoreCorpus() {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+};
+
+const StoreCorpus& Corpus() {
+    static const StoreCorpus s_corpus;
+    return s_corpus;
+}
+
+// args: バイト数
+void BM_HashContent(benchmark::State& state) {
+    std::vector<uint8_t> data(size_t(state.range(0)));
+    std::mt19937 rng(2);
+    for (uint8_t& b : data) b = uint8_t(rng());
+    for (auto _ : state) benchmark::DoNotOptimize(HashContent(data.data(), data.size()));
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+// --rehash のウォームビルド: 全入力をマップしてハッシュし、キーを作ってストアにあるか調べる
+void BM_WarmBuildRehash(benchmark::State& state) {
+    const StoreCorpus& c = Corpus();
+    for (auto _ : state) {
+        uint32_t hits = 0;
+        for (const auto& input : c.inputs) {
+            std::shared_ptr<MappedFile> file = MappedFile::Open(input);
+            if (!file) continue;
+            const ContentKey key = CookKey(HashContent(file->GetData(), size_t(file->GetSize())));
+            std::error_code ec;
+            hits += std::filesystem::exists(ContentObjectPath(c.objects, key), ec) ? 1 : 0;
+        }
+        if (hits != kInputCount) state.SkipWithError("store miss");
+    }
+    state.counters["inputs/s"] = benchmark::Counter(kInputCount, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// 既定のウォームビルド: 更新時刻とサイズが前回と同じなら前回のキーを使う（入力は読まない）
+void BM_WarmBuildStat(benchmark::State& state) {
+    const StoreCorpus& c = Corpus();
+    struct Cached {
+        std::filesystem::file_time_type time;
+        uintmax_t size;
+        ContentKey key;
+    };
+    std::vector<Cached> cache;
+    for (const auto& input : c.inputs) {
+        std::shared_ptr<MappedFile> file = MappedFile::Open(input);
+        cache.push_back({ std::filesystem::last_write_time(input), std::filesystem::file_size(input),
+                          CookKey(HashContent(file->GetData(), size_t(file->GetSize()))) });
+    }
+    for (auto _ : state) {
+        uint32_t hits = 0;
+        for (size_t i = 0; i < c.inputs.size(); ++i) {
+            std::error_code ec;
+            const auto time = std::filesystem::last_write_time(c.inputs[i], ec);
+            const auto size = std::filesystem::file_size(c.inputs[i], ec);
+            if (time != cache[i].time || size != cache[i].size) continue;
+            hits += std::filesystem::exists(ContentObjectPath(c.objects, cache[i].key), ec) ? 1 : 0;
+        }
+        if (hits != kInputCount) state.SkipWithError("store miss");
+    }
+    state.counters["inputs/s"] = benchmark::Counter(kInputCount, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// kInputCount エントリのマニフェストを書いて読み直す
+void BM_ManifestSaveLoad(benchmark::State& state) {
+    const StoreCorpus& c = Corpus();
+    AssetManifest manifest;
+    manifest.SetObjectRoot("objects");
+    for (uint32_t i = 0; i < kInputCount; ++i) {
+        const std::string name = "textures/" + std::to_string(i) + ".tga";
+        manifest.Add(name, HashContent(name.data(), name.size()), kInputSize);
+    }
+    const std::filesystem::path file = c.root / "assets.jman";
+    for (auto _ : state) {
+        AssetManifest loaded;
+        if (!manifest.Save(file) || !loaded.Load(file) || loaded.Size() != kInputCount) state.SkipWithError("manifest failed");
+    }
+    state.counters["entries/s"] = benchmark::Counter(kInputCount, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+} // namespace
+
+BENCHMARK(BM_HashContent)->ArgName("bytes")->Arg(4 << 10)->Arg(64 << 10)->Arg(16 << 20);
+BENCHMARK(BM_WarmBuildRehash)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_WarmBuildStat)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ManifestSaveLoad)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,113 @@
+#include "core/AtomicFile.h"
+#include "core/CookClient.h"
+#include "core/CookProtocol.h"
+#include "core/Socket.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// クック済みの中身をそのまま返すだけのサーバー（JisakuCookServer のキャッシュヒット時と同じやり取り）。
+// 1 接続だけ受け付け、要求を受信スレッドで順に返す。クライアントを先に切ってから破棄すること
+class EchoCookServer {
+public:
+    EchoCookServer(const std::string& address, size_t bodySize) : m_body(bodySize, 0x42) {
+        m_listener = Socket::Listen(address);
+        if (m_listener) m_thread = std::thread([this]() { Serve_(); });
+    }
+
+    ~EchoCookServer() {
+        if (m_listener) m_listener->Shutdown();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    bool IsListening() const { return m_listener != nullptr; }
+
+private:
+    void Serve_() {
+        std::unique_ptr<Socket> socket = m_listener->Accept();
+        if (!socket) return;
+        CookMessage type;
+        uint32_t size = 0;
+        std::vector<uint8_t> payload;
+        uint8_t hello[kCookHelloSize];
+        if (!ReceiveCookFrameHeader(*socket, type, size) || type != CookMessage::Hello || size != kCookHelloSize ||
+            !socket->Receive(hello, sizeof(hello)))
+            return;
+        EncodeCookHello(hello);
+        if (!SendCookFrame(*socket, CookMessage::Hello, hello, sizeof(hello))) return;
+        while (ReceiveCookFrameHeader(*socket, type, size)) {
+            payload.resize(size);
+            if (size && !socket->Receive(payload.data(), size)) break;
+            uint32_t id = 0;
+            std::string name;
+            if (type != CookMessage::Get || !DecodeCookGet(payload.data(), payload.size(), id, name)) continue;
+            CookReplyHead head;
+            head.id = id;
+            head.status = CookStatus::Ok;
+            head.key = HashContent(name.data(), name.size());
+            uint8_t out[kCookReplyHeadSize];
+            EncodeCookReplyHead(out, head);
+            if (!SendCookFrame(*socket, CookMessage::Reply, out, sizeof(out), m_body.data(), m_body.size())) break;
+        }
+    }
+
+    std::vector<uint8_t> m_body;
+    std::unique_ptr<Socket> m_listener;
+    std::thread m_thread;
+};
+
+std::string BenchAddress(int64_t transport, const std::filesystem::path& dir) {
+    if (transport == 0) return "unix:" + (dir / "cook.sock").string();
+    return "tcp:127.0.0.1:47801"; // 既定のクックサーバー（47800）とは別のポート
+}
+
+// args: 転送路（0: unix, 1: tcp）, 中身のバイト数, 同時に投げる要求数
+void BM_CookRoundTrip(benchmark::State& state) {
+    const std::filesystem::path dir = CreateTempDirectory("jisaku-cookbench-");
+    const size_t body = size_t(state.range(1));
+    const uint32_t inFlight = uint32_t(state.range(2));
+    {
+        const std::string address = BenchAddress(state.range(0), dir);
+        EchoCookServer server(address, body);
+        std::shared_ptr<CookClient> client = server.IsListening() ? CookClient::Connect(address) : nullptr;
+        if (!client) {
+            // 接続できなかったときは待ち受けを止めるまでサーバーのスレッドが Accept で待つ
+            state.SkipWithError("connect failed");
+        } else {
+            std::vector<std::future<CookResult>> futures(inFlight);
+            for (auto _ : state) {
+                for (uint32_t i = 0; i < inFlight; ++i) futures[i] = client->RequestAsync("textures/a.png");
+                for (auto& f : futures) {
+                    const CookResult r = f.get();
+                    if (r.status != CookStatus::Ok || r.data.size() != body) state.SkipWithError("bad reply");
+                }
+            }
+            state.counters["requests/s"] = benchmark::Counter(inFlight, benchmark::Counter::kIsIterationInvariantRate);
+            state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(body) * inFlight);
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+void CookArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "tcp", "bytes", "inFlight" });
+    for (int64_t transport : { 0, 1 }) {
+        for (int64_t bytes : { 256, 64 << 10, 4 << 20 }) {
+            b->Args({ transport, bytes, 1 });
+            b->Args({ transport, bytes, 32 });
+        }
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_CookRoundTrip)->Apply(CookArgs)->Unit(benchmark::kMicrosecond)->UseRealTime();
@@ -0,0 +1,126 @@
+#include "core/AtomicFile.h"
+#include "core/FileWatcher.h"
+#include "core/HotReloadScheduler.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jisaku;
+
+// ホットリロードの監視コスト: OS の通知（FileWatcher）と更新時刻のポーリングを、監視ファイル数を変えて比べる
+
+namespace {
+
+constexpr uint32_t kMaxFiles = 1000;
+
+// シェーダーのソース置き場に見立てた kMaxFiles 個のファイル（10 ディレクトリに分ける）
+struct WatchCorpus {
+    std::filesystem::path root;
+    std::vector<std::filesystem::path> files;
+
+    WatchCorpus() {
+        root = CreateTempDirectory("jisaku-watchbench-");
+        for (uint32_t i = 0; i < kMaxFiles; ++i) {
+            const std::filesystem::path dir = root / std::to_string(i % 10);
+            std::filesystem::create_directories(dir);
+            files.push_back(dir / (std::to_string(i) + ".hlsl"));
+            std::ofstream(files.back(), std::ios::binary) << "float4 main() : SV_Target { return 0; }\n";
+        }
+    }
+
+    ~WatchCorpus() {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+};
+
+const WatchCorpus& Corpus() {
+    static const WatchCorpus s_corpus;
+    return s_corpus;
+}
+
+// 何も変わっていないフレームの Update 1 回。args: ファイル数, OS の通知を使うか。
+// ポーリングは毎回全ファイルの stat（pollInterval = 0 で毎フレームにしてある。既定の 0.5 秒なら 1/30 フレームに 1 回の山）
+void BM_SchedulerIdleUpdate(benchmark::State& state) {
+    const uint32_t count = uint32_t(state.range(0));
+    HotReloadScheduler::Config config;
+    config.pollInterval = 0.0;
+    config.useFileWatcher = state.range(1) != 0;
+    HotReloadScheduler scheduler(config);
+    for (uint32_t i = 0; i < count; ++i) scheduler.Add(i, Corpus().files[i]);
+    if (config.useFileWatcher && scheduler.GetWatchedCount() != count) {
+        state.SkipWithError("OS change notification is not available");
+        return;
+    }
+    double now = 0.0;
+    for (auto _ : state) {
+        now += 1.0 / 60.0;
+        benchmark::DoNotOptimize(scheduler.Update(now));
+    }
+    state.counters["files"] = double(count);
+}
+
+// 保存から Update で発火するまでの遅延。args: OS の通知を使うか
+// （ポーリングは既定の間隔 0.5 秒・落ち着き待ち 0.2 秒で 60 fps の Update を回す。通知は debounce 0.02 秒）
+void BM_ChangeToReloadLatency(benchmark::State& state) {
+    const bool watch = state.range(0) != 0;
+    HotReloadScheduler::Config config;
+    config.useFileWatcher = watch;
+    config.settleTime = watch ? 0.02 : 0.2;
+    HotReloadScheduler scheduler(config);
+    for (uint32_t i = 0; i < kMaxFiles; ++i) scheduler.Add(i, Corpus().files[i]);
+    if (watch && scheduler.GetWatchedCount() != kMaxFiles) {
+        state.SkipWithError("OS change notification is not available");
+        return;
+    }
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point origin = Clock::now();
+    auto seconds = [origin] { return std::chrono::duration<double>(Clock::now() - origin).count(); };
+    scheduler.Update(seconds());
+
+    uint32_t round = 0;
+    for (auto _ : state) {
+        const uint32_t id = (round * 37) % kMaxFiles;
+        std::ofstream(Corpus().files[id], std::ios::binary | std::ios::app) << round++ << '\n';
+        for (;;) {
+            std::this_thread::sleep_for(std::chrono::microseconds(16667));
+            const std::vector<uint64_t> fired = scheduler.Update(seconds());
+            for (uint64_t f : fired) scheduler.Complete(f);
+            if (std::find(fired.begin(), fired.end(), id) != fired.end()) break;
+        }
+    }
+}
+
+// FileWatcher 単体の通知の遅延（debounce 0 で、書き込みから Poll で受け取るまで）
+void BM_WatcherEventLatency(benchmark::State& state) {
+    FileWatcher::Config config;
+    config.debounce = 0.0;
+    FileWatcher watcher(config);
+    for (uint32_t i = 0; i < kMaxFiles; ++i) watcher.Watch(i, Corpus().files[i]);
+    if (!watcher.IsAvailable() || watcher.GetWatchCount() != kMaxFiles) {
+        state.SkipWithError("OS change notification is not available");
+        return;
+    }
+    std::vector<uint64_t> changed;
+    uint32_t round = 0;
+    for (auto _ : state) {
+        const uint32_t id = (round * 37) % kMaxFiles;
+        std::ofstream(Corpus().files[id], std::ios::binary | std::ios::app) << round++ << '\n';
+        // 前の回の書き込みの残りの通知は読み捨てる
+        changed.clear();
+        while (std::find(changed.begin(), changed.end(), id) == changed.end()) {
+            if (watcher.Poll(changed) == 0) std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_SchedulerIdleUpdate)->ArgNames({ "files", "watch" })->ArgsProduct({ { 10, 100, 1000 }, { 0, 1 } })->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ChangeToReloadLatency)->ArgName("watch")->Arg(0)->Arg(1)->Iterations(10)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_WatcherEventLatency)->Unit(benchmark::kMicrosecond)->UseRealTime();
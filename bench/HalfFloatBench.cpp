@@ -0,0 +1,57 @@
+#include "core/HalfFloat.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// HDR 画像相当の値域（0..64 の輝度）
+std::vector<float> MakeFloats(size_t count) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(0.0f, 64.0f);
+    std::vector<float> v(count);
+    for (float& f : v) f = dist(rng);
+    return v;
+}
+
+// float32 -> float16。args: 要素数, 配列版（F16C）
+void BM_FloatToHalf(benchmark::State& state) {
+    const size_t count = size_t(state.range(0));
+    const std::vector<float> src = MakeFloats(count);
+    std::vector<uint16_t> dst(count);
+    for (auto _ : state) {
+        if (state.range(1)) {
+            FloatToHalf(dst.data(), src.data(), count);
+        } else {
+            for (size_t i = 0; i < count; ++i) dst[i] = FloatToHalf(src[i]);
+        }
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.counters["Mval"] = benchmark::Counter(double(count) / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// float16 -> float32。args: 要素数, 配列版（F16C）
+void BM_HalfToFloat(benchmark::State& state) {
+    const size_t count = size_t(state.range(0));
+    const std::vector<float> floats = MakeFloats(count);
+    std::vector<uint16_t> src(count);
+    FloatToHalf(src.data(), floats.data(), count);
+    std::vector<float> dst(count);
+    for (auto _ : state) {
+        if (state.range(1)) {
+            HalfToFloat(dst.data(), src.data(), count);
+        } else {
+            for (size_t i = 0; i < count; ++i) dst[i] = HalfToFloat(src[i]);
+        }
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.counters["Mval"] = benchmark::Counter(double(count) / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+} // namespace
+
+// 2048x1024 RGBA（環境マップ 1 枚分）と、キャッシュに収まる 64K 要素
+BENCHMARK(BM_FloatToHalf)->ArgNames({ "count", "array" })->ArgsProduct({ { 1 << 16, 2048 * 1024 * 4 }, { 0, 1 } })->UseRealTime();
+BENCHMARK(BM_HalfToFloat)->ArgNames({ "count", "array" })->ArgsProduct({ { 1 << 16, 2048 * 1024 * 4 }, { 0, 1 } })->UseRealTime();
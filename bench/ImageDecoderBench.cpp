@@ -0,0 +1,218 @@
+#include "gfx/ImageDecoder.h"
+#include "core/ByteOrder.h"
+#include "core/JobSystem.h"
+#include "BenchImages.h"
+#include <benchmark/benchmark.h>
+#ifndef JISAKU_NO_IMAGE_CODECS
+#include <spng.h>
+#include <turbojpeg.h>
+#endif
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace jisaku;
+
+// JISAKU_BENCH_IMAGES に実画像（.png/.jpg/.tga/.bmp）のディレクトリを渡すとそれを使う。
+// 無ければ合成画像を各形式にエンコードしたものを使う。
+// JISAKU_NO_IMAGE_CODECS のビルドでは PNG/JPEG の項目はスキップし、コーパスは TGA/BMP だけになる
+
+namespace {
+
+enum class Format { Png, Jpeg, Tga, Bmp };
+
+#ifndef JISAKU_NO_IMAGE_CODECS
+std::vector<uint8_t> EncodePng(const Image& img) {
+    std::vector<uint8_t> out;
+    spng_ctx* enc = spng_ctx_new(SPNG_CTX_ENCODER);
+    spng_set_option(enc, SPNG_ENCODE_TO_BUFFER, 1);
+    spng_ihdr ihdr{};
+    ihdr.width = img.width;
+    ihdr.height = img.height;
+    ihdr.bit_depth = 8;
+    ihdr.color_type = SPNG_COLOR_TYPE_TRUECOLOR_ALPHA;
+    spng_set_ihdr(enc, &ihdr);
+    if (spng_encode_image(enc, img.pixels.data(), img.pixels.size(), SPNG_FMT_PNG, SPNG_ENCODE_FINALIZE) == 0) {
+        size_t size = 0;
+        int err = 0;
+        if (void* buf = spng_get_png_buffer(enc, &size, &err)) {
+            out.assign(static_cast<uint8_t*>(buf), static_cast<uint8_t*>(buf) + size);
+            std::free(buf);
+        }
+    }
+    spng_ctx_free(enc);
+    return out;
+}
+
+std::vector<uint8_t> EncodeJpeg(const Image& img) {
+    std::vector<uint8_t> out;
+    tjhandle tj = tjInitCompress();
+    unsigned char* buf = nullptr;
+    unsigned long size = 0;
+    if (tjCompress2(tj, img.pixels.data(), int(img.width), int(img.RowPitch()), int(img.height), TJPF_RGBA,
+                    &buf, &size, TJSAMP_420, 90, 0) == 0)
+        out.assign(buf, buf + size);
+    tjFree(buf);
+    tjDestroy(tj);
+    return out;
+}
+
+#endif // JISAKU_NO_IMAGE_CODECS
+
+// 非圧縮 32bit、左上原点
+std::vector<uint8_t> EncodeTga(const Image& img) {
+    std::vector<uint8_t> out(18 + img.pixels.size());
+    out[2] = 2;
+    out[12] = uint8_t(img.width);
+    out[13] = uint8_t(img.width >> 8);
+    out[14] = uint8_t(img.height);
+    out[15] = uint8_t(img.height >> 8);
+    out[16] = 32;
+    out[17] = 0x28;
+    for (size_t i = 0; i < img.pixels.size(); i += 4) {
+        out[18 + i + 0] = img.pixels[i + 2];
+        out[18 + i + 1] = img.pixels[i + 1];
+        out[18 + i + 2] = img.pixels[i + 0];
+        out[18 + i + 3] = img.pixels[i + 3];
+    }
+    return out;
+}
+
+// 24bit BI_RGB、下から上
+std::vector<uint8_t> EncodeBmp(const Image& img) {
+    const uint32_t stride = (img.width * 3 + 3) & ~3u;
+    const uint32_t dataOffset = 14 + 40;
+    std::vector<uint8_t> out(dataOffset + size_t(stride) * img.height);
+    out[0] = 'B';
+    out[1] = 'M';
+    WriteU32(&out[2], uint32_t(out.size()));
+    WriteU32(&out[10], dataOffset);
+    WriteU32(&out[14], 40);
+    WriteU32(&out[18], img.width);
+    WriteU32(&out[22], img.height);
+    out[26] = 1;
+    out[28] = 24;
+    for (uint32_t y = 0; y < img.height; ++y) {
+        const uint8_t* src = img.View().Row(y);
+        uint8_t* dst = &out[dataOffset + size_t(img.height - 1 - y) * stride];
+        for (uint32_t x = 0; x < img.width; ++x) {
+            dst[x * 3 + 0] = src[x * 4 + 2];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 0];
+        }
+    }
+    return out;
+}
+
+// このビルドで扱える形式か
+bool IsAvailable(Format format) {
+#ifdef JISAKU_NO_IMAGE_CODECS
+    return format == Format::Tga || format == Format::Bmp;
+#else
+    (void)format;
+    return true;
+#endif
+}
+
+std::vector<uint8_t> Encode(const Image& img, Format format) {
+    switch (format) {
+#ifndef JISAKU_NO_IMAGE_CODECS
+    case Format::Png: return EncodePng(img);
+    case Format::Jpeg: return EncodeJpeg(img);
+#else
+    case Format::Png:
+    case Format::Jpeg: return {};
+#endif
+    case Format::Tga: return EncodeTga(img);
+    case Format::Bmp: return EncodeBmp(img);
+    }
+    return {};
+}
+
+std::vector<std::vector<uint8_t>> LoadCorpus() {
+    std::vector<std::vector<uint8_t>> files;
+    if (const char* dir = std::getenv("JISAKU_BENCH_IMAGES")) {
+        std::error_code ec;
+        for (const auto& e : std::filesystem::directory_iterator(dir, ec)) {
+            std::ifstream f(e.path(), std::ios::binary);
+            std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+            if (ImageDecoderRegistry::Get().Find(bytes.data(), bytes.size())) files.push_back(std::move(bytes));
+        }
+        if (!files.empty()) return files;
+    }
+    // 512x512 を扱える形式（最大 4 つ）x 8 枚
+    for (uint32_t i = 0; i < 8; ++i) {
+        const Image img = MakeBenchImage(512, 512, i + 1);
+        for (Format f : { Format::Png, Format::Jpeg, Format::Tga, Format::Bmp }) {
+            if (IsAvailable(f)) files.push_back(Encode(img, f));
+        }
+    }
+    return files;
+}
+
+const std::vector<std::vector<uint8_t>>& Corpus() {
+    static const std::vector<std::vector<uint8_t>> s_corpus = LoadCorpus();
+    return s_corpus;
+}
+
+// 1024x1024 を 1 枚デコードする。args: 形式
+void BM_DecodeFormat(benchmark::State& state) {
+    if (!IsAvailable(Format(state.range(0)))) {
+        state.SkipWithError("built without libspng / libjpeg-turbo");
+        return;
+    }
+    const Image img = MakeBenchImage(1024, 1024);
+    const std::vector<uint8_t> file = Encode(img, Format(state.range(0)));
+    const IImageDecoder* decoder = ImageDecoderRegistry::Get().Find(file.data(), file.size());
+    if (!decoder) {
+        state.SkipWithError("no decoder");
+        return;
+    }
+    Image out;
+    out.Allocate(img.width, img.height);
+    for (auto _ : state) {
+        if (!decoder->Decode(file.data(), file.size(), out.View())) state.SkipWithError("decode failed");
+        benchmark::DoNotOptimize(out.pixels.data());
+    }
+    state.counters["MPix"] = benchmark::Counter(double(img.width) * img.height / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["bytes"] = double(file.size());
+}
+
+// コーパス全体をデコードする（TextureLoader::LoadBatch のデコード段と同じく 1 ファイル 1 ジョブ）。args: 並列
+void BM_DecodeBatch(benchmark::State& state) {
+    const auto& corpus = Corpus();
+    const bool parallel = state.range(0) != 0;
+    std::vector<Image> out(corpus.size());
+    double pixels = 0.0;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        ImageInfo info;
+        const IImageDecoder* decoder = ImageDecoderRegistry::Get().Find(corpus[i].data(), corpus[i].size());
+        if (decoder && decoder->ReadInfo(corpus[i].data(), corpus[i].size(), info)) pixels += double(info.width) * info.height;
+    }
+    std::atomic<size_t> failed{ 0 };
+    auto decodeRange = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            if (!DecodeImage(corpus[i].data(), corpus[i].size(), out[i])) failed.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    for (auto _ : state) {
+        if (parallel) {
+            JobSystem::Get().ParallelFor(uint32_t(corpus.size()), 1, decodeRange);
+        } else {
+            decodeRange(0, uint32_t(corpus.size()));
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    if (failed.load() != 0) state.SkipWithError("decode failed");
+    state.counters["files"] = benchmark::Counter(double(corpus.size()), benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["MPix"] = benchmark::Counter(pixels / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+} // namespace
+
+BENCHMARK(BM_DecodeFormat)->ArgName("format")->DenseRange(0, 3)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_DecodeBatch)->ArgName("parallel")->DenseRange(0, 1)->Unit(benchmark::kMillisecond)->UseRealTime();
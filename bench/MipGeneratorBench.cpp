@@ -0,0 +1,61 @@
+#include "gfx/MipGenerator.h"
+#include "BenchImages.h"
+#include "MipReference.h"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// 1 段目の画素数（チェーン全体は約 4/3 倍）
+void SetPixelCounter(benchmark::State& state, uint32_t size) {
+    state.counters["MPix"] = benchmark::Counter(double(size) * size / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// size x size の全ミップチェーン。args: フィルタ, 辺の長さ, 並列
+void BM_MipChain(benchmark::State& state) {
+    const uint32_t size = uint32_t(state.range(1));
+    const Image img = MakeBenchImage(size, size);
+    MipOptions opt;
+    opt.filter = MipFilter(state.range(0));
+    opt.parallel = state.range(2) != 0;
+    std::vector<Image> levels;
+    for (auto _ : state) {
+        GenerateMipChain(img.View(), opt, levels);
+        benchmark::DoNotOptimize(levels.data());
+    }
+    SetPixelCounter(state, size);
+}
+
+// 同じ計算のスカラー・単一スレッド版（比較の基準）。args: フィルタ, 辺の長さ
+void BM_MipChainReference(benchmark::State& state) {
+    const uint32_t size = uint32_t(state.range(1));
+    const Image img = MakeBenchImage(size, size);
+    for (auto _ : state) {
+        std::vector<Image> levels = MipReference::Generate(img, MipFilter(state.range(0)), true, true);
+        benchmark::DoNotOptimize(levels.data());
+    }
+    SetPixelCounter(state, size);
+}
+
+void MipArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "filter", "size", "parallel" });
+    for (MipFilter f : { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos }) {
+        for (int64_t size : { 256, 1024, 2048 }) {
+            for (int p = 0; p < 2; ++p) b->Args({ int64_t(f), size, p });
+        }
+    }
+}
+
+void ReferenceArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "filter", "size" });
+    for (MipFilter f : { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos }) {
+        for (int64_t size : { 256, 1024, 2048 }) b->Args({ int64_t(f), size });
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_MipChain)->Apply(MipArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_MipChainReference)->Apply(ReferenceArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,140 @@
+#include "core/AtomicFile.h"
+#include "core/SceneFile.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#if JISAKU_HAVE_SIMDJSON
+#include <simdjson.h>
+#endif
+
+using namespace jisaku;
+
+namespace {
+
+constexpr uint32_t kEntityCount = 1000000;
+constexpr uint32_t kTextureCount = 64;
+
+// 1M エンティティのシーンを .jscn と同内容の JSON の両方で書き出しておく（プロセス終了時に消す）
+struct SceneCorpus {
+    std::filesystem::path root;
+    std::filesystem::path scene;
+    std::filesystem::path json;
+
+    SceneCorpus() {
+        root = CreateTempDirectory("jisaku-scenebench-");
+        scene = root / "scene.jscn";
+        json = root / "scene.json";
+        EntityStore store;
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> pos(-1000.0f, 1000.0f);
+        for (uint32_t i = 0; i < kTextureCount; ++i) {
+            const std::string path = "textures/t" + std::to_string(i) + ".png";
+            store.AddTexture(AssetPathHash(path), path);
+        }
+        for (uint32_t i = 0; i < kEntityCount; ++i) {
+            store.Create({ pos(rng), pos(rng), pos(rng) }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f },
+                         rng() % kTextureCount, i == 0 || rng() % 4 == 0 ? kNoEntity : uint32_t(rng() % i));
+        }
+        WriteScene(scene, store);
+        WriteJson(store);
+    }
+
+    ~SceneCorpus() {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+
+    void WriteJson(const EntityStore& store) const {
+        std::ofstream out(json, std::ios::binary);
+        out << "{\"textures\":[";
+        for (size_t i = 0; i < store.GetTextures().size(); ++i) {
+            const TextureRef& t = store.GetTextures()[i];
+            out << (i ? "," : "") << "{\"hash\":" << t.assetHash << ",\"path\":\"" << t.path << "\"}";
+        }
+        out << "],\"entities\":[";
+        char buf[512];
+        for (size_t i = 0; i < store.Size(); ++i) {
+            const Float3& p = store.Positions()[i];
+            const Quat& r = store.Rotations()[i];
+            const Float3& s = store.Scales()[i];
+            const uint32_t parent = store.Parents()[i];
+            const int n = std::snprintf(buf, sizeof(buf), "%s{\"p\":[%.9g,%.9g,%.9g],\"r\":[%.9g,%.9g,%.9g,%.9g],\"s\":[%.9g,%.9g,%.9g],\"t\":%u,\"parent\":%lld}",
+                                        i ? "," : "", p.x, p.y, p.z, r.x, r.y, r.z, r.w, s.x, s.y, s.z, store.Textures()[i],
+                                        parent == kNoEntity ? -1ll : (long long)parent);
+            out.write(buf, n);
+        }
+        out << "]}";
+    }
+};
+
+const SceneCorpus& Corpus() {
+    static const SceneCorpus s_corpus;
+    return s_corpus;
+}
+
+// マップ + 目次の付け替えだけ
+void BM_SceneOpen(benchmark::State& state) {
+    const SceneCorpus& c = Corpus();
+    for (auto _ : state) {
+        SceneFile scene;
+        if (!scene.Open(c.scene)) state.SkipWithError("open failed");
+        benchmark::DoNotOptimize(scene.GetEntityCount());
+    }
+    state.counters["fileMB"] = double(std::filesystem::file_size(c.scene)) / 1e6;
+}
+
+// マップ + 付け替え + EntityStore への取り込み
+void BM_SceneLoad(benchmark::State& state) {
+    const SceneCorpus& c = Corpus();
+    for (auto _ : state) {
+        EntityStore store;
+        if (!LoadScene(c.scene, store) || store.Size() != kEntityCount) state.SkipWithError("load failed");
+        benchmark::DoNotOptimize(store.Positions());
+    }
+    state.counters["entities/s"] = benchmark::Counter(kEntityCount, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+#if JISAKU_HAVE_SIMDJSON
+// 比較の基準: 同じ内容の JSON を simdjson（ondemand）で読み、同じ EntityStore に入れる
+void BM_SceneJson(benchmark::State& state) {
+    const SceneCorpus& c = Corpus();
+    simdjson::ondemand::parser parser;
+    for (auto _ : state) {
+        simdjson::padded_string text = simdjson::padded_string::load(c.json.string());
+        simdjson::ondemand::document doc = parser.iterate(text);
+        EntityStore store;
+        store.Reserve(kEntityCount);
+        std::vector<uint32_t> remap;
+        for (auto t : doc["textures"]) {
+            const uint64_t hash = t["hash"].get_uint64();
+            const std::string_view path = t["path"].get_string();
+            remap.push_back(store.AddTexture(hash, path));
+        }
+        for (auto e : doc["entities"]) {
+            float v[10];
+            int k = 0;
+            for (double x : e["p"]) v[k++] = float(x);
+            for (double x : e["r"]) v[k++] = float(x);
+            for (double x : e["s"]) v[k++] = float(x);
+            const uint32_t texture = remap[size_t(uint64_t(e["t"]))];
+            const int64_t parent = e["parent"];
+            store.Create({ v[0], v[1], v[2] }, { v[3], v[4], v[5], v[6] }, { v[7], v[8], v[9] }, texture,
+                         parent < 0 ? kNoEntity : uint32_t(parent));
+        }
+        if (store.Size() != kEntityCount) state.SkipWithError("parse failed");
+        benchmark::DoNotOptimize(store.Positions());
+    }
+    state.counters["fileMB"] = double(std::filesystem::file_size(c.json)) / 1e6;
+    state.counters["entities/s"] = benchmark::Counter(kEntityCount, benchmark::Counter::kIsIterationInvariantRate);
+}
+#endif
+
+} // namespace
+
+BENCHMARK(BM_SceneOpen)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_SceneLoad)->Unit(benchmark::kMillisecond)->UseRealTime();
+#if JISAKU_HAVE_SIMDJSON
+BENCHMARK(BM_SceneJson)->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
@@ -0,0 +1,190 @@
+#include "core/AtomicFile.h"
+#include "core/ChildProcess.h"
+#include "core/ShaderCache.h"
+#include "core/Socket.h"
+#include "tools/ShaderFarm.h"
+#include "BenchShaders.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jisaku;
+
+// シェーダーパックの全ビルド（ForceRebuildAll 相当）の時間。
+// 既定では dxc の代わりに、引数を読んで -Fo / -Fc を書くだけのシェルスクリプト（kBenchFakeDxc）を使う
+// （プロセスの起動・やり取り・キャッシュといったファームの手間だけを測る）。
+// 本物のコンパイル時間を見るときは JISAKU_BENCH_DXC に dxc のパスを入れる
+
+namespace {
+
+constexpr uint32_t kFeatureBits = 6; // 64 パーミュテーション × VS/PS = 128 件
+
+struct FarmCorpus {
+    std::filesystem::path root;
+    std::string dxc;
+    std::string compiler;
+    std::vector<FarmJob> jobs;
+
+    FarmCorpus() {
+        root = CreateTempDirectory("jisaku-farmbench-");
+        dxc = PrepareBenchDxc(root);
+        compiler = QueryDxcVersion(dxc);
+
+        const std::string source = MakeBenchShaderSource(kFeatureBits);
+
+        for (uint32_t key = 0; key < (1u << kFeatureBits); ++key) {
+            for (const char* stage : { "vs", "ps" }) {
+                FarmJob job;
+                job.name = "shaders/bench.hlsl";
+                job.source = source;
+                job.entry = stage[0] == 'v' ? "VSMain" : "PSMain";
+                job.target = std::string(stage) + "_6_0";
+                for (uint32_t f = 0; f < kFeatureBits; ++f) {
+                    if (key & (1u << f)) job.defines.push_back(std::string("FEATURE").append(std::to_string(f)).append("=1"));
+                }
+                jobs.push_back(std::move(job));
+            }
+        }
+    }
+
+    ~FarmCorpus() {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+};
+
+const FarmCorpus& Corpus() {
+    static const FarmCorpus s_corpus;
+    return s_corpus;
+}
+
+// --serve の代わり（同じプロセスの中で、接続 1 本につきスレッド 1 本で RunFarmWorker を動かす）
+class LocalFarmServer {
+public:
+    explicit LocalFarmServer(const std::string& address) {
+        m_listener = Socket::Listen(address);
+        if (m_listener) m_thread = std::thread([this]() { Serve_(); });
+    }
+
+    ~LocalFarmServer() {
+        if (m_listener) m_listener->Shutdown();
+        if (m_thread.joinable()) m_thread.join();
+        // 接続は ShaderFarm::Run が戻るときに閉じているので、ワーカーのスレッドは終わっている
+        for (std::thread& t : m_workers) t.join();
+    }
+
+    bool IsListening() const { return m_listener != nullptr; }
+
+private:
+    void Serve_() {
+        while (std::unique_ptr<Socket> socket = m_listener->Accept()) {
+            m_workers.emplace_back([socket = std::move(socket)]() mutable {
+                std::unique_ptr<FarmChannel> channel = MakeSocketChannel(std::move(socket));
+                RunFarmWorker(*channel, Corpus().dxc, Corpus().compiler);
+            });
+        }
+    }
+
+    std::unique_ptr<Socket> m_listener;
+    std::thread m_thread;
+    std::vector<std::thread> m_workers;
+};
+
+bool AllOk(const std::vector<FarmResult>& results) {
+    for (const FarmResult& r : results) {
+        if (r.status != FarmStatus::Ok) return false;
+    }
+    return true;
+}
+
+// 今の ShaderReloader::ForceRebuildAll と同じく、1 件ずつ dxc を起動して待つ
+void BM_RebuildSerialDxc(benchmark::State& state) {
+    const FarmCorpus& corpus = Corpus();
+    if (corpus.compiler.empty()) {
+        state.SkipWithError("cannot run dxc");
+        return;
+    }
+    const std::filesystem::path source = corpus.root / "serial.hlsl", object = corpus.root / "serial.dxil",
+                                listing = corpus.root / "serial.txt";
+    std::ofstream(source, std::ios::binary) << corpus.jobs[0].source;
+    for (auto _ : state) {
+        for (const FarmJob& job : corpus.jobs) {
+            std::vector<std::string> args = { corpus.dxc, "-T", job.target, "-E", job.entry, "-Zpr",
+                                              "-Fo", object.string(), "-Fc", listing.string() };
+            for (const std::string& d : job.defines) {
+                args.push_back("-D");
+                args.push_back(d);
+            }
+            args.push_back(source.string());
+            std::unique_ptr<ChildProcess> process = ChildProcess::Spawn(args, false);
+            if (!process || process->Wait() != 0) {
+                state.SkipWithError("dxc failed");
+                return;
+            }
+        }
+    }
+    state.counters["jobs/s"] = benchmark::Counter(double(corpus.jobs.size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// args: ワーカーの種類（0: --worker の子プロセス, 1: ソケットの先の --serve 相当）, ワーカー数, キャッシュ（0: 無し, 1: 全件ヒット）
+void BM_RebuildFarm(benchmark::State& state) {
+    const FarmCorpus& corpus = Corpus();
+    if (corpus.compiler.empty()) {
+        state.SkipWithError("cannot run dxc");
+        return;
+    }
+    const bool remote = state.range(0) != 0;
+    const uint32_t workers = uint32_t(state.range(1));
+    const bool warm = state.range(2) != 0;
+    const std::filesystem::path dir = CreateTempDirectory("jisaku-farmrun-");
+    const std::string address = "unix:" + (dir / "farm.sock").string();
+    {
+        ShaderCache cache(dir / "cache");
+        std::unique_ptr<LocalFarmServer> server;
+        if (remote) server = std::make_unique<LocalFarmServer>(address);
+        ShaderFarm::Config config;
+        config.executable = ChildProcess::GetExecutablePath().string();
+        config.dxc = corpus.dxc;
+        config.compiler = corpus.compiler;
+        if (remote) config.remotes.assign(workers, address);
+        else config.localWorkers = workers;
+        config.cache = warm ? &cache : nullptr;
+
+        std::vector<FarmResult> results;
+        if (warm) ShaderFarm(config).Run(corpus.jobs, results); // キャッシュを埋めておく
+        if (server && !server->IsListening()) state.SkipWithError("cannot listen");
+        for (auto _ : state) {
+            ShaderFarm farm(config);
+            farm.Run(corpus.jobs, results);
+            if (!AllOk(results)) {
+                state.SkipWithError("farm compile failed");
+                break;
+            }
+            if (warm && farm.GetStats().cached != corpus.jobs.size()) {
+                state.SkipWithError("cache missed");
+                break;
+            }
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    state.counters["jobs/s"] = benchmark::Counter(double(corpus.jobs.size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void FarmArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "remote", "workers", "warm" });
+    for (int remote = 0; remote < 2; ++remote) {
+        for (int workers : { 1, 4, 8 }) b->Args({ remote, workers, 0 });
+    }
+    b->Args({ 0, 4, 1 });
+}
+
+} // namespace
+
+BENCHMARK(BM_RebuildSerialDxc)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_RebuildFarm)->Apply(FarmArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
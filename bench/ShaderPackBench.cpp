@@ -0,0 +1,214 @@
+#include "core/AtomicFile.h"
+#include "core/ChildProcess.h"
+#include "core/ShaderCache.h"
+#include "core/ShaderPack.h"
+#include "tools/ShaderFarm.h"
+#include "BenchShaders.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace jisaku;
+
+// 起動時に N 件のシェーダーを用意する時間を、ShaderCompiler の 2 つの経路で比べる。
+// - パック: .jspk を読んで ShaderPack::Load し、MakeShaderId で引いたバイトコードを blob 相当にコピーする（ShaderCompiler::Load）
+// - コンパイル: #include の展開 → キャッシュのキー → ShaderCache を見て、無ければ dxc（ShaderCompiler::Compile）
+// ShaderCompiler は D3D に依存するので、同じ手順をここで portable な部品から組み立てる。
+// Windows の ShaderCompiler は DXC をプロセス内で呼ぶが、ここでは dxc を 1 件ずつ起動する。
+// 既定の dxc は偽物（ShaderFarmBench と同じ）なので、コンパイル側は起動と読み書きだけの下限になる。
+// 本物のコンパイル時間を見るときは JISAKU_BENCH_DXC に dxc のパスを入れる
+
+namespace {
+
+constexpr uint32_t kFeatureBits = 6; // 64 パーミュテーション × VS/PS = 128 件
+constexpr const char* kShaderPath = "shaders/bench.hlsl";
+constexpr const char* kCompileArgs = "-Zi -Qembed_debug -Zpr"; // ShaderCompiler の kArgs
+
+std::vector<uint8_t> ReadBytes(const std::filesystem::path& path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+// source を entry / target / defines で 1 件コンパイルする。listing が null でなければ -Fc も書かせて読む
+bool RunDxc(const std::string& dxc, const std::filesystem::path& source, const ShaderPackEntry& entry,
+            const std::filesystem::path& object, std::vector<uint8_t>& bytecode, std::string* listing = nullptr) {
+    std::vector<std::string> args = { dxc, "-T", entry.target, "-E", entry.entry, "-Zi", "-Qembed_debug", "-Zpr",
+                                      "-Fo", object.string() };
+    const std::filesystem::path listingFile = std::filesystem::path(object).replace_extension(".txt");
+    if (listing) {
+        args.push_back("-Fc");
+        args.push_back(listingFile.string());
+    }
+    for (const std::string& d : entry.defines) {
+        args.push_back("-D");
+        args.push_back(d);
+    }
+    args.push_back(source.string());
+    std::unique_ptr<ChildProcess> process = ChildProcess::Spawn(args, false);
+    if (!process || process->Wait() != 0) return false;
+    bytecode = ReadBytes(object);
+    if (listing) {
+        const std::vector<uint8_t> text = ReadBytes(listingFile);
+        listing->assign(text.begin(), text.end());
+    }
+    return !bytecode.empty();
+}
+
+// ソースツリーの代わりのディレクトリと、そこから JisakuShaderPack と同じ手順で作ったパック
+struct PackCorpus {
+    std::filesystem::path root;
+    std::string dxc;
+    std::string compiler;
+    std::vector<ShaderPackEntry> entries;
+    std::filesystem::path pack;
+    bool ok = false;
+
+    PackCorpus() {
+        root = CreateTempDirectory("jisaku-packbench-");
+        std::filesystem::create_directories(root / "shaders");
+        dxc = PrepareBenchDxc(root);
+        compiler = QueryDxcVersion(dxc);
+        if (compiler.empty()) return;
+        std::ofstream(root / kShaderPath, std::ios::binary) << MakeBenchShaderSource(kFeatureBits);
+
+        for (uint32_t key = 0; key < (1u << kFeatureBits); ++key) {
+            for (const char* stage : { "vs", "ps" }) {
+                ShaderPackEntry entry;
+                entry.path = kShaderPath;
+                entry.entry = stage[0] == 'v' ? "VSMain" : "PSMain";
+                entry.target = std::string(stage) + "_6_0";
+                for (uint32_t f = 0; f < kFeatureBits; ++f) {
+                    if (key & (1u << f)) entry.defines.push_back(std::string("FEATURE").append(std::to_string(f)).append("=1"));
+                }
+                entry.id = MakeShaderId(entry.path, entry.entry, entry.defines);
+                entries.push_back(std::move(entry));
+            }
+        }
+
+        std::vector<std::vector<uint8_t>> bytecodes(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            std::string listing;
+            if (!RunDxc(dxc, root / kShaderPath, entries[i], root / "pack.dxil", bytecodes[i], &listing)) return;
+            if (!ParseDxilReflection(listing, entries[i].reflection)) return;
+        }
+        pack = root / "shaders.jspk";
+        std::string error;
+        ok = WriteShaderPack(pack, entries, bytecodes, error);
+    }
+
+    ~PackCorpus() {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+};
+
+const PackCorpus& Corpus() {
+    static const PackCorpus s_corpus;
+    return s_corpus;
+}
+
+// パックを読み、先頭から N 件を ID で引いてバイトコードをコピーする。args: 件数
+void BM_ShaderStartupPack(benchmark::State& state) {
+    const PackCorpus& corpus = Corpus();
+    if (!corpus.ok) {
+        state.SkipWithError("cannot build the shader pack (dxc failed)");
+        return;
+    }
+    const size_t count = size_t(state.range(0));
+    std::vector<uint8_t> blob;
+    for (auto _ : state) {
+        ShaderPack pack;
+        if (!pack.Load(ReadBytes(corpus.pack))) {
+            state.SkipWithError("pack load failed");
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const ShaderPackEntry& want = corpus.entries[i];
+            const ShaderPackEntry* entry = pack.Find(MakeShaderId(want.path, want.entry, want.defines));
+            if (!entry) {
+                state.SkipWithError("entry missing from the pack");
+                return;
+            }
+            const uint8_t* bytecode = pack.GetBytecode(*entry);
+            blob.assign(bytecode, bytecode + entry->size);
+            benchmark::DoNotOptimize(blob.data());
+        }
+    }
+    state.counters["shaders/s"] = benchmark::Counter(double(count), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// 先頭から N 件を ShaderCompiler::Compile と同じ手順で用意する。args: 件数, キャッシュ（0: 空から, 1: 全件ヒット）
+void BM_ShaderStartupCompile(benchmark::State& state) {
+    const PackCorpus& corpus = Corpus();
+    if (!corpus.ok) {
+        state.SkipWithError("cannot build the shader pack (dxc failed)");
+        return;
+    }
+    const size_t count = size_t(state.range(0));
+    const bool warm = state.range(1) != 0;
+    const ShaderFileReader read = [&corpus](const std::string& path, std::string& out) {
+        std::ifstream f(corpus.root / path, std::ios::binary);
+        if (!f) return false;
+        out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        return true;
+    };
+    const std::filesystem::path expanded = corpus.root / "expanded.hlsl", object = corpus.root / "compile.dxil";
+
+    // 1 件分: 展開 → キー → キャッシュ → 無ければ dxc で作ってキャッシュへ
+    auto prepare = [&](ShaderCache& cache, const ShaderPackEntry& entry, std::vector<uint8_t>& bytecode) {
+        ShaderSource source;
+        std::string error;
+        if (!ExpandShaderIncludes(entry.path, read, {}, source, error)) return false;
+        ShaderKeyDesc keyDesc;
+        keyDesc.source = source.text;
+        keyDesc.entry = entry.entry;
+        keyDesc.target = entry.target;
+        keyDesc.defines = &entry.defines;
+        keyDesc.compiler = corpus.compiler;
+        keyDesc.args = kCompileArgs;
+        const ContentKey key = MakeShaderCacheKey(keyDesc);
+        if (cache.Load(key, bytecode)) return true;
+        std::ofstream(expanded, std::ios::binary) << source.text;
+        return RunDxc(corpus.dxc, expanded, entry, object, bytecode) && cache.Store(key, bytecode.data(), bytecode.size());
+    };
+
+    std::vector<uint8_t> bytecode;
+    std::unique_ptr<ShaderCache> cache;
+    const std::filesystem::path cacheRoot = corpus.root / "cache";
+    uint32_t generation = 0;
+    if (warm) {
+        cache = std::make_unique<ShaderCache>(cacheRoot / "warm");
+        for (size_t i = 0; i < count; ++i) {
+            if (!prepare(*cache, corpus.entries[i], bytecode)) {
+                state.SkipWithError("dxc failed");
+                return;
+            }
+        }
+    }
+    for (auto _ : state) {
+        if (!warm) {
+            state.PauseTiming();
+            cache = std::make_unique<ShaderCache>(cacheRoot / std::to_string(generation++));
+            state.ResumeTiming();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (!prepare(*cache, corpus.entries[i], bytecode)) {
+                state.SkipWithError("dxc failed");
+                return;
+            }
+            benchmark::DoNotOptimize(bytecode.data());
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(cacheRoot, ec);
+    state.counters["shaders/s"] = benchmark::Counter(double(count), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+} // namespace
+
+BENCHMARK(BM_ShaderStartupPack)->ArgName("shaders")->Arg(16)->Arg(128)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ShaderStartupCompile)->ArgNames({ "shaders", "warm" })->ArgsProduct({ { 16, 128 }, { 0, 1 } })->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,228 @@
+#include "core/AtomicFile.h"
+#include "core/StreamingCopy.h"
+#include "gfx/BCEncoder.h"
+#include "gfx/ImageDecoder.h"
+#include "gfx/MipGenerator.h"
+#include "gfx/TextureContainer.h"
+#include "BenchImages.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace jisaku;
+
+// 起動時のテクスチャ読み込みを、ディレクトリ 1 つ分で比べる。
+// - DDS: クック済みの DDS を読み、LoadContainer で解析してアップロードバッファへ行コピーする（TextureLoader::LoadContainerToStaging_ と同じ）
+// - デコード: 元画像を読み、デコード → ミップ生成 → BC7 圧縮してアップロードバッファへ書く（DDS 導入前の起動時の経路）
+// JISAKU_BENCH_IMAGES に画像ディレクトリを渡すとそれを使う。無ければ合成画像を TGA で置く
+// （TGA はデコードが最も軽い形式なので、デコード側の時間は下限になる）。DDS はどちらもここで BC7 High でクックする
+
+namespace {
+
+constexpr uint32_t kBenchSize = 1024;
+constexpr uint32_t kBenchCount = 8;
+constexpr uint32_t kDxgiBC7Srgb = 99;       // DXGI_FORMAT_BC7_UNORM_SRGB
+constexpr size_t kPitchAlign = 256;         // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+constexpr size_t kPlacementAlign = 512;     // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+
+size_t AlignUp(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+std::vector<uint8_t> ReadBytes(const std::filesystem::path& path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+// 非圧縮 32bit、左上原点
+std::vector<uint8_t> EncodeTga(const Image& img) {
+    std::vector<uint8_t> out(18 + img.pixels.size());
+    out[2] = 2;
+    out[12] = uint8_t(img.width);
+    out[13] = uint8_t(img.width >> 8);
+    out[14] = uint8_t(img.height);
+    out[15] = uint8_t(img.height >> 8);
+    out[16] = 32;
+    out[17] = 0x28;
+    for (size_t i = 0; i < img.pixels.size(); i += 4) {
+        out[18 + i + 0] = img.pixels[i + 2];
+        out[18 + i + 1] = img.pixels[i + 1];
+        out[18 + i + 2] = img.pixels[i + 0];
+        out[18 + i + 3] = img.pixels[i + 3];
+    }
+    return out;
+}
+
+MipOptions LoaderMipOptions() {
+    MipOptions mips;
+    mips.filter = MipFilter::Kaiser; // TextureLoader の既定
+    return mips;
+}
+
+// デコード済み画像から、ミップ付き BC7 の DDS を作る（JisakuAssetBuild の CookTexture と同じ）
+bool CookDds(const Image& image, std::vector<uint8_t>& out) {
+    std::vector<Image> levels;
+    if (!GenerateMipChain(image.View(), LoaderMipOptions(), levels)) return false;
+    BCEncodeOptions enc;
+    enc.format = BCFormat::BC7;
+    enc.quality = BCQuality::High;
+    ContainerInfo info;
+    info.container = ContainerFormat::DDS;
+    info.dxgiFormat = kDxgiBC7Srgb;
+    info.width = image.width;
+    info.height = image.height;
+    info.mipLevels = uint32_t(levels.size());
+    std::vector<std::vector<uint8_t>> encoded(levels.size());
+    std::vector<ContainerSubresource> subresources(levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        ContainerSubresource& sr = subresources[i];
+        sr.rowPitch = BCRowPitch(enc.format, levels[i].width);
+        sr.rowCount = (levels[i].height + 3) / 4;
+        sr.slicePitch = sr.rowPitch * sr.rowCount;
+        encoded[i].resize(BCSurfaceSize(enc.format, levels[i].width, levels[i].height));
+        if (!EncodeBC(levels[i].View(), enc, encoded[i].data(), sr.rowPitch)) return false;
+        sr.data = encoded[i].data();
+    }
+    return WriteDds(info, subresources, out);
+}
+
+// 元画像のディレクトリと、同じ画像をクックした DDS のディレクトリ
+struct ContainerCorpus {
+    std::filesystem::path root;
+    std::vector<std::filesystem::path> sources;
+    std::vector<std::filesystem::path> dds;
+    double pixels = 0.0; // ミップ 0 の画素数の合計
+    bool ok = true;
+
+    ContainerCorpus() {
+        root = CreateTempDirectory("jisaku-containerbench-");
+        std::filesystem::create_directories(root / "source");
+        std::filesystem::create_directories(root / "dds");
+        if (const char* dir = std::getenv("JISAKU_BENCH_IMAGES")) {
+            std::error_code ec;
+            for (const auto& e : std::filesystem::directory_iterator(dir, ec)) {
+                const std::vector<uint8_t> bytes = ReadBytes(e.path());
+                if (ImageDecoderRegistry::Get().Find(bytes.data(), bytes.size())) sources.push_back(e.path());
+            }
+        }
+        if (sources.empty()) {
+            for (uint32_t i = 0; i < kBenchCount; ++i) {
+                sources.push_back(root / "source" / (std::to_string(i) + ".tga"));
+                const std::vector<uint8_t> tga = EncodeTga(MakeBenchImage(kBenchSize, kBenchSize, i + 1));
+                std::ofstream(sources.back(), std::ios::binary).write(reinterpret_cast<const char*>(tga.data()), std::streamsize(tga.size()));
+            }
+        }
+        for (size_t i = 0; i < sources.size() && ok; ++i) {
+            const std::vector<uint8_t> bytes = ReadBytes(sources[i]);
+            Image image;
+            std::vector<uint8_t> cooked;
+            ok = DecodeImage(bytes.data(), bytes.size(), image) && CookDds(image, cooked);
+            dds.push_back(root / "dds" / (std::to_string(i) + ".dds"));
+            std::ofstream(dds.back(), std::ios::binary).write(reinterpret_cast<const char*>(cooked.data()), std::streamsize(cooked.size()));
+            pixels += double(image.width) * image.height;
+        }
+    }
+
+    ~ContainerCorpus() {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+};
+
+const ContainerCorpus& Corpus() {
+    static const ContainerCorpus s_corpus;
+    return s_corpus;
+}
+
+// GetCopyableFootprints 相当の配置（行ピッチ 256・サブリソース 512 揃え）で、BC7 の全ミップを置くアップロードバッファ
+struct UploadFootprint {
+    std::vector<size_t> offsets, rowPitches;
+    std::vector<uint32_t> rowCounts;
+    size_t total = 0;
+
+    UploadFootprint(uint32_t width, uint32_t height, uint32_t levels) {
+        for (uint32_t i = 0; i < levels; ++i) {
+            total = AlignUp(total, kPlacementAlign);
+            offsets.push_back(total);
+            rowPitches.push_back(AlignUp(BCRowPitch(BCFormat::BC7, MipExtent(width, i)), kPitchAlign));
+            rowCounts.push_back((MipExtent(height, i) + 3) / 4);
+            total += rowPitches.back() * rowCounts.back();
+        }
+    }
+};
+
+// DDS のディレクトリを読み、解析してアップロードバッファへ行コピーする
+void BM_StartupDds(benchmark::State& state) {
+    const ContainerCorpus& corpus = Corpus();
+    if (!corpus.ok) {
+        state.SkipWithError("cannot cook the corpus");
+        return;
+    }
+    std::vector<uint8_t> upload;
+    for (auto _ : state) {
+        for (const std::filesystem::path& path : corpus.dds) {
+            const std::vector<uint8_t> bytes = ReadBytes(path);
+            ContainerTexture tex;
+            if (!LoadContainer(bytes.data(), bytes.size(), TranscodeTarget::BC7, tex)) {
+                state.SkipWithError("dds parse failed");
+                return;
+            }
+            const UploadFootprint footprint(tex.info.width, tex.info.height, tex.info.mipLevels);
+            upload.resize((std::max)(upload.size(), footprint.total));
+            for (size_t i = 0; i < tex.subresources.size(); ++i) {
+                const ContainerSubresource& sr = tex.subresources[i];
+                const size_t rowBytes = (std::min)(footprint.rowPitches[i], sr.rowPitch);
+                uint8_t* dst = upload.data() + footprint.offsets[i];
+                for (uint32_t row = 0; row < sr.rowCount; ++row)
+                    StreamCopy(dst + size_t(row) * footprint.rowPitches[i], sr.data + row * sr.rowPitch, rowBytes);
+            }
+            StreamFence();
+            benchmark::DoNotOptimize(upload.data());
+        }
+    }
+    state.counters["files"] = benchmark::Counter(double(corpus.dds.size()), benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["MPix"] = benchmark::Counter(corpus.pixels / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// 元画像のディレクトリを読み、デコード → ミップ生成 → BC7 圧縮でアップロードバッファへ書く。args: BC7 の品質（0: Fast, 1: High）
+void BM_StartupDecode(benchmark::State& state) {
+    const ContainerCorpus& corpus = Corpus();
+    if (!corpus.ok) {
+        state.SkipWithError("cannot cook the corpus");
+        return;
+    }
+    BCEncodeOptions enc;
+    enc.format = BCFormat::BC7;
+    enc.quality = state.range(0) != 0 ? BCQuality::High : BCQuality::Fast;
+    std::vector<uint8_t> upload;
+    std::vector<Image> levels;
+    for (auto _ : state) {
+        for (const std::filesystem::path& path : corpus.sources) {
+            const std::vector<uint8_t> bytes = ReadBytes(path);
+            Image image;
+            if (!DecodeImage(bytes.data(), bytes.size(), image) || !GenerateMipChain(image.View(), LoaderMipOptions(), levels)) {
+                state.SkipWithError("decode failed");
+                return;
+            }
+            const UploadFootprint footprint(image.width, image.height, uint32_t(levels.size()));
+            upload.resize((std::max)(upload.size(), footprint.total));
+            for (size_t i = 0; i < levels.size(); ++i) {
+                if (!EncodeBC(levels[i].View(), enc, upload.data() + footprint.offsets[i], footprint.rowPitches[i])) {
+                    state.SkipWithError("block compression failed");
+                    return;
+                }
+            }
+            benchmark::DoNotOptimize(upload.data());
+        }
+    }
+    state.counters["files"] = benchmark::Counter(double(corpus.sources.size()), benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["MPix"] = benchmark::Counter(corpus.pixels / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+} // namespace
+
+BENCHMARK(BM_StartupDds)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_StartupDecode)->ArgName("high")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
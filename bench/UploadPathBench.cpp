@@ -0,0 +1,127 @@
+#include "core/StreamingCopy.h"
+#include "gfx/MipGenerator.h"
+#include "BenchImages.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <vector>
+
+using namespace jisaku;
+
+// Linux ではアップロードヒープ（WC メモリ）を用意できないので、アップロード先は通常のヒープで代用する。
+// 時間は WC での効果を過小に見せるが、パスごとのメモリ転送量（counters）は D3D12 上と同じ
+
+namespace {
+
+constexpr size_t kPitchAlign = 256;     // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+constexpr size_t kPlacementAlign = 512; // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+
+size_t AlignUp(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+// GetCopyableFootprints 相当のレイアウトで確保したアップロードバッファ
+struct UploadLayout {
+    std::vector<uint8_t> buffer;
+    std::vector<ImageView> levels;
+
+    UploadLayout(uint32_t width, uint32_t height) {
+        const uint32_t count = CalcMipCount(width, height);
+        std::vector<size_t> offsets;
+        size_t total = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            total = AlignUp(total, kPlacementAlign);
+            offsets.push_back(total);
+            total += AlignUp(size_t(MipExtent(width, i)) * 4, kPitchAlign) * MipExtent(height, i);
+        }
+        buffer.resize(total);
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t w = MipExtent(width, i), h = MipExtent(height, i);
+            levels.push_back({ buffer.data() + offsets[i], w, h, AlignUp(size_t(w) * 4, kPitchAlign) });
+        }
+    }
+};
+
+// ミップ 0 とそれ以降（1..）の RGBA8 バイト数
+void MipBytes(uint32_t width, uint32_t height, double& mip0, double& rest) {
+    mip0 = double(width) * height * 4;
+    rest = 0.0;
+    for (uint32_t i = 1; i < CalcMipCount(width, height); ++i) rest += double(MipExtent(width, i)) * MipExtent(height, i) * 4;
+}
+
+void SetTrafficCounters(benchmark::State& state, double readBytes, double writeBytes) {
+    state.counters["readMB"] = readBytes / 1e6;
+    state.counters["writeMB"] = writeBytes / 1e6;
+}
+
+// 旧経路: デコード → ScratchImage、ミップ生成で 2 つ目の ScratchImage（ミップ 0 のコピーを含む）、
+// 最後に全レベルを行ごとに memcpy でアップロードバッファへ。args: 辺の長さ
+// デコーダの書き込みは decoded からの memcpy で代用する（両経路で共通）
+void BM_UploadScratchPath(benchmark::State& state) {
+    const uint32_t size = uint32_t(state.range(0));
+    const Image decoded = MakeBenchImage(size, size);
+    UploadLayout upload(size, size);
+    Image scratch;
+    scratch.Allocate(size, size);
+    std::vector<Image> chain;
+    MipOptions opt;
+    for (auto _ : state) {
+        std::memcpy(scratch.pixels.data(), decoded.pixels.data(), decoded.pixels.size());
+        GenerateMipChain(scratch.View(), opt, chain);
+        for (size_t i = 0; i < chain.size(); ++i) {
+            const ImageView& dst = upload.levels[i];
+            for (uint32_t y = 0; y < dst.height; ++y) std::memcpy(dst.Row(y), chain[i].View().Row(y), size_t(dst.width) * 4);
+        }
+        benchmark::DoNotOptimize(upload.buffer.data());
+    }
+    double mip0 = 0.0, rest = 0.0;
+    MipBytes(size, size, mip0, rest);
+    // 読み: デコード元 + チェーンへのミップ 0 コピー元 + ミップ生成の入力 + 全レベルのアップロード元
+    // 書き: ScratchImage + チェーンのミップ 0 と 1.. + アップロードバッファ
+    SetTrafficCounters(state, mip0 * 4 + rest, mip0 * 3 + rest * 2);
+    state.counters["MPix"] = benchmark::Counter(double(size) * size / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// 新経路: ミップ 0 はキャッシュ上にデコードして StreamCopy、1.. は GenerateMips が非テンポラルストアで直接書く
+void BM_UploadDirectPath(benchmark::State& state) {
+    const uint32_t size = uint32_t(state.range(0));
+    const Image decoded = MakeBenchImage(size, size);
+    UploadLayout upload(size, size);
+    Image mip0Image;
+    mip0Image.Allocate(size, size);
+    MipOptions opt;
+    opt.streamingStores = true;
+    for (auto _ : state) {
+        std::memcpy(mip0Image.pixels.data(), decoded.pixels.data(), decoded.pixels.size());
+        const ImageView& dst0 = upload.levels[0];
+        for (uint32_t y = 0; y < size; ++y) StreamCopy(dst0.Row(y), mip0Image.View().Row(y), size_t(size) * 4);
+        GenerateMips(mip0Image.View(), opt, upload.levels.data() + 1, uint32_t(upload.levels.size() - 1));
+        StreamFence();
+        benchmark::DoNotOptimize(upload.buffer.data());
+    }
+    double mip0 = 0.0, rest = 0.0;
+    MipBytes(size, size, mip0, rest);
+    // 読み: デコード元 + StreamCopy 元 + ミップ生成の入力 / 書き: キャッシュ上のミップ 0 + アップロードバッファ
+    SetTrafficCounters(state, mip0 * 3, mip0 * 2 + rest);
+    state.counters["MPix"] = benchmark::Counter(double(size) * size / 1e6, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// 大きなコピー単体: 非テンポラルストア vs memcpy。args: バイト数, 非テンポラル
+void BM_Copy(benchmark::State& state) {
+    const size_t bytes = size_t(state.range(0));
+    const bool stream = state.range(1) != 0;
+    std::vector<uint8_t> src(bytes, 0x5a), dst(bytes);
+    for (auto _ : state) {
+        if (stream) {
+            StreamCopy(dst.data(), src.data(), bytes);
+            StreamFence();
+        } else {
+            std::memcpy(dst.data(), src.data(), bytes);
+        }
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(bytes));
+}
+
+} // namespace
+
+BENCHMARK(BM_UploadScratchPath)->ArgName("size")->Arg(1024)->Arg(2048)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_UploadDirectPath)->ArgName("size")->Arg(1024)->Arg(2048)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Copy)->ArgNames({ "bytes", "stream" })->ArgsProduct({ { 1 << 16, 1 << 20, 16 << 20, 64 << 20 }, { 0, 1 } })->UseRealTime();
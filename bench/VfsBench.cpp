@@ -0,0 +1,114 @@
+#include "core/AsyncIo.h"
+#include "core/AtomicFile.h"
+#include "core/Vfs.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+constexpr uint32_t kFileCount = 4096;
+constexpr size_t kFileSize = 4096;
+
+// 4 KB のファイル kFileCount 個を、ばらばらのファイルとパックの両方で用意する（プロセス終了時に消す）
+struct SmallFileCorpus {
+    std::filesystem::path root;
+    std::filesystem::path loose;
+    std::filesystem::path pack;
+    std::vector<std::string> names;
+
+    SmallFileCorpus() {
+        root = CreateTempDirectory("jisaku-vfsbench-");
+        loose = root / "loose";
+        pack = root / "assets.jpak";
+        std::filesystem::create_directories(loose);
+        std::vector<PackSource> sources;
+        std::vector<char> bytes(kFileSize);
+        for (uint32_t i = 0; i < kFileCount; ++i) {
+            names.push_back(std::to_string(i) + ".bin");
+            for (size_t j = 0; j < bytes.size(); ++j) bytes[j] = char(i * 31 + j);
+            std::ofstream(loose / names.back(), std::ios::binary).write(bytes.data(), std::streamsize(bytes.size()));
+            sources.push_back({ names.back(), loose / names.back() });
+        }
+        WritePack(pack, sources);
+    }
+
+    ~SmallFileCorpus() {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+};
+
+const SmallFileCorpus& Corpus() {
+    static const SmallFileCorpus s_corpus;
+    return s_corpus;
+}
+
+// 比較の基準: 1 ファイルずつ ifstream で開いて読む
+void BM_ReadSyncIfstream(benchmark::State& state) {
+    const SmallFileCorpus& c = Corpus();
+    std::vector<char> buf(kFileSize);
+    for (auto _ : state) {
+        for (const std::string& name : c.names) {
+            std::ifstream f(c.loose / name, std::ios::binary);
+            f.read(buf.data(), std::streamsize(buf.size()));
+        }
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.counters["reads"] = benchmark::Counter(kFileCount, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// 全ファイルを Vfs::ReadRangeAsync で一度に投げて待つ。args: バックエンド, キューの深さ, パック
+void BM_ReadVfs(benchmark::State& state) {
+    const SmallFileCorpus& c = Corpus();
+    AsyncIo::Config config;
+    config.backend = IoBackend(state.range(0));
+    config.queueDepth = uint32_t(state.range(1));
+    AsyncIo io(config);
+    if (io.GetBackend() != config.backend) {
+        state.SkipWithError("backend unavailable");
+        return;
+    }
+    Vfs vfs(io);
+    const bool pack = state.range(2) != 0;
+    if (!(pack ? vfs.MountPack("", c.pack) : vfs.MountDirectory("", c.loose))) {
+        state.SkipWithError("mount failed");
+        return;
+    }
+    std::vector<uint8_t> buf(size_t(kFileCount) * kFileSize);
+    std::atomic<uint32_t> done{ 0 }, failed{ 0 };
+    for (auto _ : state) {
+        done.store(0);
+        for (uint32_t i = 0; i < kFileCount; ++i) {
+            vfs.ReadRangeAsync(c.names[i], 0, kFileSize, buf.data() + size_t(i) * kFileSize, IoPriority::Normal, [&](bool ok) {
+                if (!ok) failed.fetch_add(1, std::memory_order_relaxed);
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }
+        while (done.load(std::memory_order_acquire) < kFileCount) std::this_thread::yield();
+        benchmark::DoNotOptimize(buf.data());
+    }
+    if (failed.load() != 0) state.SkipWithError("read failed");
+    state.counters["reads"] = benchmark::Counter(kFileCount, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["maxInFlight"] = io.GetStats().maxInFlight;
+}
+
+void VfsArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "backend", "qd", "pack" });
+    for (IoBackend backend : { IoBackend::IoUring, IoBackend::ThreadPool }) {
+        for (int64_t qd : { 1, 16, 256 }) {
+            for (int pack = 0; pack < 2; ++pack) b->Args({ int64_t(backend), qd, pack });
+        }
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_ReadSyncIfstream)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ReadVfs)->Apply(VfsArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -1,3 +1,6 @@
+// パーミュテーション（RenderPass_TexturedQuad::GetPermutationSchema の機能ビット）
+//   GRAYSCALE : 輝度だけで描く
+//   SHOW_UV   : テクスチャの代わりに UV を色にする（デバッグ用）
 cbuffer CB : register(b0)
 {
   float4x4 gMVP;
@@ -12,10 +15,16 @@ PSIn VSMain(VSIn i){
 }
 Texture2D    gTex  : register(t0);
 SamplerState gSamp : register(s0);
-float4 PSMain(PSIn i):SV_TARGET { return gTex.Sample(gSamp, i.uv); }
 float4 PSMain(PSIn i):SV_TARGET
 {
+#if SHOW_UV
+    float3 rgb = float3(i.uv, 0);
+#else
     float3 rgb = gTex.Sample(gSamp, i.uv).rgb;
+#endif
+#if GRAYSCALE
     float luma = dot(rgb, float3(0.299, 0.587, 0.114));
-    return float4(luma.xxx, 1);
+    rgb = luma.xxx;
+#endif
+    return float4(rgb, 1);
 }
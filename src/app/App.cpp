@@ -1,9 +1,14 @@
 #include "App.h"
+#include "core/CookClient.h"
+#include "core/Vfs.h"
+#include "core/SceneFile.h"
 #include "gfx/DX12Device.h"
+#include "gfx/PipelineCache.h"
 #include "gfx/Swapchain.h"
 #include "gfx/RenderPass_Clear.h"
 #include "gfx/RenderPass_Triangle.h"
 #include "gfx/RenderPass_TexturedQuad.h"
+#include "gfx/ShaderCompiler.h"
 #include "gfx/TextureLoader.h"
 #include "ui/ImGuiLayer.h"
 #include "imgui_impl_win32.h"
@@ -11,6 +16,8 @@
 #include <commdlg.h>
 #include <imgui.h>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
 
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
@@ -22,6 +29,21 @@ namespace jisaku
 
     App::~App()
     {
+        // 受信スレッドが Vfs より先に止まるように
+        if (m_cookClient) Vfs::Get().Unmount("");
+        // 今回使ったパーミュテーションを次の起動で先に作る
+        if (m_permutations && !m_permutations->SaveUsage("shaderusage.txt")) spdlog::warn("Failed to write shaderusage.txt");
+        // 解放待ちのもの（古い PSO・テクスチャのスロット等）は、それを返す先のオブジェクトが破棄される前に手放す
+        if (m_device && m_device->GetReleaseQueue().Size() != 0)
+        {
+            m_device->WaitIdle();
+            m_device->GetReleaseQueue().ReleaseAll();
+        }
+        // 今回使った PSO を次の起動でドライバーにコンパイルさせない
+        if (m_device && m_device->GetPipelineCache() && !m_device->GetPipelineCache()->Save("pipelines.bin"))
+        {
+            spdlog::warn("Failed to write pipelines.bin");
+        }
     }
 
     bool App::Initialize(HINSTANCE hInstance)
@@ -68,6 +90,54 @@ namespace jisaku
             DispatchMessage(&msg);
         }
 
+        // 作業ディレクトリにパックがあれば、ばらばらのファイルより優先して読む
+        if (Vfs::Get().MountPack("", L"assets.jpak"))
+        {
+            spdlog::info("Mounted assets.jpak ({} I/O)", IoBackendName(Vfs::Get().GetIo().GetBackend()));
+        }
+        // アセットビルドの出力（JisakuAssetBuild が書く）。パックより新しいはずなので後からマウントして優先する
+        if (Vfs::Get().MountManifest("", L"assets.jman"))
+        {
+            spdlog::info("Mounted assets.jman");
+        }
+        // クックサーバーがあれば最後にマウントして最優先にする（"1" なら既定のアドレス）。
+        // 読めないものは上のマウントへ回るので、サーバーが落ちても続けられる
+        char cookAddress[256] = {};
+        const DWORD cookAddressLength = GetEnvironmentVariableA("JISAKU_COOK_SERVER", cookAddress, sizeof(cookAddress));
+        if (cookAddressLength > 0 && cookAddressLength < sizeof(cookAddress))
+        {
+            const std::string address = std::string(cookAddress) == "1" ? kDefaultCookAddress : cookAddress;
+            m_cookClient = CookClient::Connect(address);
+            if (m_cookClient && Vfs::Get().MountCookServer("", m_cookClient))
+            {
+                spdlog::info("Connected to cook server {}", address);
+            }
+            else
+            {
+                m_cookClient.reset();
+                spdlog::warn("Cook server {} is not running; reading local files", address);
+            }
+        }
+
+        // シェーダーは JisakuShaderPack が書いた shaders.jspk から読み、実行時にはコンパイルしない。
+        // JISAKU_SHADER_HOT_RELOAD=1 のとき（パックが無いときも）は元の HLSL をコンパイルして変更を監視する
+        char hotReload[8] = {};
+        const DWORD hotReloadLength = GetEnvironmentVariableA("JISAKU_SHADER_HOT_RELOAD", hotReload, sizeof(hotReload));
+        m_shaderHotReload = hotReloadLength > 0 && hotReloadLength < sizeof(hotReload) && std::string(hotReload) != "0";
+        if (!m_shaderHotReload)
+        {
+            if (ShaderCompiler::Get().LoadPack(L"shaders.jspk"))
+            {
+                ShaderCompiler::Get().SetRuntimeCompile(false);
+                spdlog::info("Loaded shaders.jspk ({} shaders)", ShaderCompiler::Get().GetPack().Size());
+            }
+            else
+            {
+                m_shaderHotReload = true;
+                spdlog::warn("shaders.jspk not found; compiling shaders at runtime (build the shaderpack target)");
+            }
+        }
+
         // DX12Device初期化
         m_device = std::make_unique<DX12Device>();
         if (!m_device->Initialize())
@@ -77,6 +147,8 @@ namespace jisaku
         }
         // アップロード専用コンテキスト初期化
         m_device->InitUploadContext();
+        // 前回までに作った PSO（無い・ドライバーが変わったときは空から）
+        m_device->GetPipelineCache()->Load("pipelines.bin");
 
         // スワップチェーン初期化
         m_swapchain = std::make_unique<Swapchain>();
@@ -117,6 +189,9 @@ namespace jisaku
             spdlog::error("Failed to initialize RenderPass_TexturedQuad");
             return false;
         }
+        m_texCache = std::make_unique<TextureCache>(*m_texQuad->GetTextureLoader());
+        m_texReloader = std::make_unique<TextureReloader>(*m_texQuad->GetTextureLoader(), m_device->GetDevice());
+        m_scene.Create({ 0.0f, 0.0f, 0.0f }, {}, { 256.0f, 256.0f, 1.0f });
 
         // ImGui初期化
         if (!m_imgui.Init(m_device.get(), m_swapchain.get(), m_hwnd))
@@ -132,11 +207,30 @@ namespace jisaku
         // 入力管理
         m_input = std::make_unique<InputManager>();
         
-        // シェーダーホットリロード初期化
-        m_shaderReloader = std::make_unique<ShaderReloader>();
-        m_shaderReloader->Init(m_device.get());
-        m_shaderReloader->Register({L"shaders/Triangle.hlsl", L"VSMain", L"PSMain"}, m_trianglePass.get());
-        m_shaderReloader->Register({L"shaders/TexturedQuad.hlsl", L"VSMain", L"PSMain"}, m_texQuad.get());
+        // シェーダーホットリロード初期化（パックから読んだときは監視しない）
+        if (m_shaderHotReload)
+        {
+            m_shaderReloader = std::make_unique<ShaderReloader>();
+            m_shaderReloader->Init(m_device.get());
+            m_shaderReloader->Register(RenderPass_Triangle::GetShaderDesc(), m_trianglePass.get());
+            m_shaderReloader->Register(RenderPass_TexturedQuad::GetShaderDesc(), m_texQuad.get());
+        }
+
+        // パーミュテーション（機能ビットの組ごとの PSO は使われたときにワーカーで作る）。前回使ったものは先に作り始める
+        m_permutations = std::make_unique<ShaderPermutationManager>();
+        m_texQuad->SetPermutations(m_permutations.get(), m_permutations->Register(
+            RenderPass_TexturedQuad::GetShaderDesc(), RenderPass_TexturedQuad::GetPermutationSchema(), m_texQuad.get()));
+        if (const size_t warmed = m_permutations->LoadUsage("shaderusage.txt"))
+        {
+            spdlog::info("Warming {} shader permutations from shaderusage.txt", warmed);
+        }
+
+        // パスの PSO は各 Initialize がワーカーに投げてある（その間に上の初期化を進めた）
+        if (!m_trianglePass->WaitPipelineState() || !m_texQuad->WaitPipelineState())
+        {
+            spdlog::error("Failed to create pipeline state");
+            return false;
+        }
         
         // Raw Input API登録
         RAWINPUTDEVICE rid[1];
@@ -148,6 +242,16 @@ namespace jisaku
             spdlog::warn("Failed to register Raw Input device");
         }
 
+        {
+            const jisaku::ShaderCompiler& sc = jisaku::ShaderCompiler::Get();
+            const jisaku::ShaderCache::Stats cs = sc.GetCacheStats();
+            spdlog::info("Shaders: {} from pack, {} cached, {} compiled, {:.1f} ms total ({:.2f} ms loading cache)",
+                sc.GetPackLoadCount(), cs.hits, sc.GetCompileCount(), sc.GetTotalMs(), cs.loadMs);
+            const jisaku::PipelineCache::Stats ps = m_device->GetPipelineCache()->GetStats();
+            spdlog::info("Pipelines: {} from pipelines.bin, {} created, {} reused, {:.1f} ms total",
+                ps.libraryHits, ps.created, ps.hits, ps.createMs);
+        }
+
         m_running = true;
         spdlog::info("Application initialized successfully");
         return true;
@@ -308,23 +412,58 @@ namespace jisaku
             }
 
             // フレーム開始前に、前フレームからの遅延ロードを処理
-            if (!m_pendingTexturePath.empty()) {
-                auto path = m_pendingTexturePath; // 退避
-                m_pendingTexturePath.clear();
-                jisaku::TextureHandle h;
+            if (!m_pendingTexturePaths.empty()) {
+                auto paths = std::move(m_pendingTexturePaths); // 退避
+                m_pendingTexturePaths.clear();
+                std::vector<jisaku::TexturePtr> loaded;
                 m_device->UploadAndWait([&](ID3D12GraphicsCommandList* cmd) {
-                    m_texQuad->GetTextureLoader()->LoadFromFile(m_device->GetDevice(), cmd, path, h, /*forceSRGB=*/true, /*generateMips=*/true);
+                    m_texCache->LoadBatch(m_device->GetDevice(), cmd, paths, loaded, /*forceSRGB=*/true, /*generateMips=*/true);
                 });
-                m_texQuad->GetTextureLoader()->FlushUploads();
-                if (h.resource) {
-                    m_textures.push_back(h);
-                    m_activeTex = (int)m_textures.size() - 1;
-                    if (m_texQuad) m_texQuad->SetActiveSlot(h.slot);
+                // UploadAndWait は GPU の完了まで待っているので、アップロードバッファは次の BeginFrame で手放してよい
+                m_texQuad->GetTextureLoader()->FlushUploads(m_device->GetReleaseQueue(), m_device->GetCompletedFenceValue());
+                for (size_t i = 0; i < loaded.size(); ++i) {
+                    const auto& t = loaded[i];
+                    if (!t) continue;
+                    m_texReloader->Watch(paths[i], *m_texCache, t, /*forceSRGB=*/true, /*generateMips=*/true);
+                    // 読み込み済みのものはキャッシュから同じハンドルが返るので、一覧には追加せず選択だけする
+                    auto it = std::find(m_textures.begin(), m_textures.end(), t);
+                    if (it == m_textures.end()) {
+                        it = m_textures.insert(m_textures.end(), t);
+                        m_texturePaths.push_back(paths[i]);
+                    }
+                    m_activeTex = (int)(it - m_textures.begin());
+                    if (m_texQuad) m_texQuad->SetActiveSlot(t->slot);
                 }
             }
 
+            // ワーカーでできあがったシェーダーの PSO に差し替える（記録前なので、このフレームから新しい PSO で描く）
+            if (m_shaderReloader) {
+                std::vector<std::wstring> reloaded;
+                m_shaderReloader->Apply(m_device->GetReleaseQueue(), m_device->GetNextFenceValue(), &reloaded);
+                // 基本形が変わったら、そのシェーダーのパーミュテーションも作り直す（できるまでは新しい基本形で描く）
+                for (const std::wstring& path : reloaded) {
+                    if (m_permutations) m_permutations->Invalidate(path, m_device->GetReleaseQueue(), m_device->GetNextFenceValue());
+                }
+            }
+            if (m_permutations) {
+                m_permutations->Apply(m_device->GetReleaseQueue(), m_device->GetNextFenceValue());
+            }
+
+            // 一覧から外したテクスチャは、前のフレームが読み終えてからリソースとスロットを返す（BeginFrame で解放）
+            if (m_collectTextures) {
+                m_collectTextures = false;
+                m_texCache->CollectGarbage(m_device->GetReleaseQueue(), m_device->GetNextFenceValue());
+            }
+
             const float clear[4] = { 0.392f, 0.584f, 0.929f, 1.0f }; // CornflowerBlue-ish
             m_device->BeginFrame();
+            // 読み直しの済んだテクスチャを差し替える。コピーはこのフレームの描画の前に積み、SRV はスロットの空いている側へ作るので、
+            // 前のフレームを待たない。古いリソース・SRV・アップロードバッファはこのフレームのフェンスで手放す
+            if (m_texReloader->HasReady()) {
+                const UINT64 retireFence = m_device->GetNextFenceValue();
+                m_texReloader->Apply(m_device->GetCommandList(), m_device->GetReleaseQueue(), retireFence);
+                m_texQuad->GetTextureLoader()->FlushUploads(m_device->GetReleaseQueue(), retireFence);
+            }
             if (m_gpuTimer) m_gpuTimer->NewFrame();
             m_imgui.NewFrame();
             // 入力更新（デルタタイム計算）
@@ -343,10 +482,23 @@ namespace jisaku
                 
                 m_input->UpdateCamera(dt);
                 
-                // シェーダーホットリロード更新
+                // クックサーバーが元ファイルの変更を知らせてきたものは、自前の監視を待たずに読み直す
+                if (m_cookClient) {
+                    bool rebuildShaders = false;
+                    for (const std::string& name : m_cookClient->TakeInvalidations()) {
+                        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".cso") == 0) rebuildShaders = true;
+                        else if (m_texReloader) m_texReloader->Invalidate(std::filesystem::path(std::u8string(name.begin(), name.end())).wstring());
+                    }
+                    if (rebuildShaders && m_shaderReloader) m_shaderReloader->ForceRebuildAll();
+                }
+                // シェーダーホットリロード（コンパイルと PSO 作成はワーカーで行い、差し替えは次フレームの頭）
                 if (m_shaderReloader) {
                     m_shaderReloader->Tick(m_dtSmoothed, 0.5);
                 }
+                // テクスチャホットリロード（読み直しはワーカーで行い、差し替えは次フレームの頭）
+                if (m_texReloader) {
+                    m_texReloader->Tick(dt);
+                }
                 
                 // 右クリック時はマウスカーソルを非表示にする（Raw Input使用）
                 if (m_input->IsMouseDown(1)) { // 右クリック（ボタン1）
@@ -370,30 +522,70 @@ namespace jisaku
             // ImGuiデバッグウィンドウ
             if (ImGui::Begin("Debug")) {
                 if (ImGui::Button("Add Texture...")) {
-                    wchar_t path[MAX_PATH] = {};
+                    // 複数選択時は "ディレクトリ\0ファイル1\0ファイル2\0\0" の形で返る
+                    std::vector<wchar_t> buf(32 * 1024, L'\0');
                     OPENFILENAMEW ofn{};
                     ofn.lStructSize = sizeof(ofn);
                     ofn.hwndOwner = m_hwnd;
-                    ofn.lpstrFilter = L"Images\0*.png;*.jpg;*.jpeg;*.bmp;*.tga;*.gif\0All\0*.*\0";
-                    ofn.lpstrFile = path;
-                    ofn.nMaxFile = MAX_PATH;
-                    ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST;
+                    ofn.lpstrFilter = L"Images\0*.png;*.jpg;*.jpeg;*.bmp;*.tga;*.gif;*.hdr;*.exr;*.dds;*.ktx2\0All\0*.*\0";
+                    ofn.lpstrFile = buf.data();
+                    ofn.nMaxFile = (DWORD)buf.size();
+                    ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST | OFN_ALLOWMULTISELECT | OFN_EXPLORER;
                     if (GetOpenFileNameW(&ofn)) {
                         // フレーム外でメインスレッドが安全なタイミングで実行するため、パスのみ保持
-                        m_pendingTexturePath = path;
+                        const wchar_t* p = buf.data();
+                        std::wstring first = p;
+                        p += first.size() + 1;
+                        if (*p == L'\0') {
+                            m_pendingTexturePaths.push_back(first); // 単一選択
+                        } else {
+                            for (; *p; p += wcslen(p) + 1) {
+                                m_pendingTexturePaths.push_back(first + L"\\" + p);
+                            }
+                        }
+                    }
+                }
+                // ブロック圧縮設定（以降に読み込むテクスチャに適用）
+                if (TextureLoader* loader = m_texQuad ? m_texQuad->GetTextureLoader() : nullptr) {
+                    static int bcIndex = 0;
+                    static bool bcHigh = false;
+                    const char* bcNames[] = { "None", "BC1", "BC3", "BC7" };
+                    const BCFormat bcFormats[] = { BCFormat::None, BCFormat::BC1, BCFormat::BC3, BCFormat::BC7 };
+                    bool changed = ImGui::Combo("Compression", &bcIndex, bcNames, IM_ARRAYSIZE(bcNames));
+                    changed |= ImGui::Checkbox("High Quality BC", &bcHigh);
+                    if (changed) {
+                        loader->SetCompression(bcFormats[bcIndex], bcHigh ? BCQuality::High : BCQuality::Fast);
+                    }
+                    bool hdrBC6H = loader->GetHdrCompression();
+                    if (ImGui::Checkbox("HDR as BC6H", &hdrBC6H)) {
+                        loader->SetHdrCompression(hdrBC6H);
+                    }
+
+                    int mipFilter = (int)loader->GetMipFilter();
+                    const char* filterNames[] = { "Box", "Kaiser", "Lanczos" };
+                    if (ImGui::Combo("Mip Filter", &mipFilter, filterNames, IM_ARRAYSIZE(filterNames))) {
+                        loader->SetMipFilter((MipFilter)mipFilter);
                     }
                 }
                 for (int i = 0; i < (int)m_textures.size(); ++i) {
-                    char label[64]; sprintf_s(label, "Tex %d", i);
+                    char label[64]; sprintf_s(label, "Tex %d (slot %u)", i, m_textures[i]->slot);
                     bool selected = (m_activeTex == i);
                     if (ImGui::Selectable(label, selected)) {
                         m_activeTex = i;
-                        if (m_texQuad) m_texQuad->SetActiveSlot(m_textures[i].slot);
+                        if (m_texQuad) m_texQuad->SetActiveSlot(m_textures[i]->slot);
                     }
                 }
                 if (m_activeTex >= 0) {
                     ImGui::Text("Active: %d", m_activeTex);
+                    if (ImGui::Button("Remove Texture")) {
+                        m_textures.erase(m_textures.begin() + m_activeTex);
+                        m_texturePaths.erase(m_texturePaths.begin() + m_activeTex);
+                        m_activeTex = -1;
+                        if (m_texQuad) m_texQuad->SetActiveSlot(UINT32_MAX); // チェッカーボードに戻す
+                        m_collectTextures = true;
+                    }
                 }
+                ImGui::Text("Cached textures: %zu", m_texCache ? m_texCache->GetLiveCount() : (size_t)0);
 
                 // Mouse sensitivity control
                 if (m_input) {
@@ -403,21 +595,84 @@ namespace jisaku
                     }
                 }
 
-                // Transform controls (tx, ty, rot, sx, sy)
-                static float tx = 0.0f, ty = 0.0f, rot = 0.0f, sx = 256.0f, sy = 256.0f;
-                ImGui::SliderFloat("Trans X", &tx, -500.0f, 500.0f);
-                ImGui::SliderFloat("Trans Y", &ty, -500.0f, 500.0f);
-                ImGui::SliderFloat("Rotate(deg)", &rot, -180.0f, 180.0f);
-                ImGui::SliderFloat("Scale X", &sx, 0.1f, 5.0f);
-                ImGui::SliderFloat("Scale Y", &sy, 0.1f, 5.0f);
-                if (m_texQuad) m_texQuad->SetTransform(tx, ty, rot, sx, sy);
-                
-                // シェーダー再コンパイルボタン
-                if (ImGui::Button("Recompile Shaders")) {
-                    if (m_shaderReloader) {
-                        m_shaderReloader->ForceRebuildAll();
+                // Transform controls (tx, ty, rot, sx, sy)。値はシーンのエンティティ 0 に持つ
+                if (m_scene.Size() > 0) {
+                    constexpr float kDegToRad = 3.14159265f / 180.0f;
+                    jisaku::Float3& pos = m_scene.Positions()[0];
+                    jisaku::Quat& q = m_scene.Rotations()[0];
+                    jisaku::Float3& scale = m_scene.Scales()[0];
+                    float rot = 2.0f * std::atan2(q.z, q.w) / kDegToRad; // Z 軸回りのみ
+                    ImGui::SliderFloat("Trans X", &pos.x, -500.0f, 500.0f);
+                    ImGui::SliderFloat("Trans Y", &pos.y, -500.0f, 500.0f);
+                    if (ImGui::SliderFloat("Rotate(deg)", &rot, -180.0f, 180.0f)) {
+                        q = { 0.0f, 0.0f, std::sin(rot * kDegToRad * 0.5f), std::cos(rot * kDegToRad * 0.5f) };
+                    }
+                    ImGui::SliderFloat("Scale X", &scale.x, 0.1f, 5.0f);
+                    ImGui::SliderFloat("Scale Y", &scale.y, 0.1f, 5.0f);
+                    if (m_texQuad) m_texQuad->SetTransform(pos.x, pos.y, rot, scale.x, scale.y);
+                }
+
+                // シェーダーの機能ビット（初めて選んだ組み合わせはワーカーで作り、できるまでは近いもので描く）
+                if (m_texQuad) {
+                    using Quad = jisaku::RenderPass_TexturedQuad;
+                    jisaku::PermutationKey features = m_texQuad->GetFeatures();
+                    bool grayscale = (features & Quad::kFeatureGrayscale) != 0;
+                    bool showUV = (features & Quad::kFeatureShowUV) != 0;
+                    ImGui::Checkbox("Grayscale", &grayscale);
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Show UV", &showUV);
+                    features = (grayscale ? Quad::kFeatureGrayscale : 0u) | (showUV ? Quad::kFeatureShowUV : 0u);
+                    m_texQuad->SetFeatures(features);
+                    if (m_permutations) {
+                        ImGui::Text("Permutations: %zu ready, %u building, %zu queued", m_permutations->GetVariantCount(),
+                            m_permutations->GetBuildingCount(), m_permutations->GetPendingCount());
+                    }
+                }
+
+                // シーンの保存・読み込み（テクスチャはパスのハッシュで参照し、読み込み時に遅延ロードへ回す）
+                if (ImGui::Button("Save Scene") && m_scene.Size() > 0) {
+                    uint32_t texture = jisaku::kNoTexture;
+                    if (m_activeTex >= 0) {
+                        const std::u8string u8 = std::filesystem::path(m_texturePaths[m_activeTex]).generic_u8string();
+                        const std::string path(u8.begin(), u8.end());
+                        texture = m_scene.AddTexture(jisaku::AssetPathHash(path), path);
                     }
+                    m_scene.Textures()[0] = texture;
+                    if (!jisaku::WriteScene("scene.jscn", m_scene)) spdlog::error("Failed to save scene.jscn");
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Load Scene")) {
+                    jisaku::EntityStore loaded;
+                    if (jisaku::LoadScene("scene.jscn", loaded) && loaded.Size() > 0) {
+                        m_scene = std::move(loaded);
+                        const uint32_t texture = m_scene.Textures()[0];
+                        if (texture != jisaku::kNoTexture) {
+                            const std::string& path = m_scene.GetTextures()[texture].path;
+                            m_pendingTexturePaths.push_back(std::filesystem::path(std::u8string(path.begin(), path.end())).wstring());
+                        }
+                    } else {
+                        spdlog::error("Failed to load scene.jscn");
+                    }
+                }
+                
+                // シェーダー再コンパイルボタン（ホットリロード時だけ）
+                if (m_shaderReloader && ImGui::Button("Recompile Shaders")) {
+                    m_shaderReloader->ForceRebuildAll();
+                }
+                if (!m_shaderHotReload) {
+                    ImGui::Text("Shaders: %llu from pack", (unsigned long long)jisaku::ShaderCompiler::Get().GetPackLoadCount());
+                } else {
+                    const jisaku::ShaderCache::Stats cs = jisaku::ShaderCompiler::Get().GetCacheStats();
+                    const uint64_t lookups = cs.hits + cs.misses;
+                    ImGui::Text("Shader cache: %llu/%llu hits (%.0f%%)", (unsigned long long)cs.hits,
+                        (unsigned long long)lookups, lookups ? 100.0 * double(cs.hits) / double(lookups) : 0.0);
+                }
+                if (m_shaderReloader && m_shaderReloader->GetBuildingCount() > 0) {
+                    ImGui::Text("Compiling shaders: %u", m_shaderReloader->GetBuildingCount());
                 }
+                ImGui::Text("Pipelines: %zu cached, %llu evicted", m_device->GetPipelineCache()->Size(),
+                    (unsigned long long)m_device->GetPipelineCache()->GetStats().evicted);
+                ImGui::Text("Pending releases: %zu", m_device->GetReleaseQueue().Size());
             }
             ImGui::End();
             if (m_gpuTimer) m_gpuTimer->DrawImGui();
@@ -7,9 +7,13 @@
 #include <thread>
 #include "ui/ImGuiLayer.h"
 #include "gfx/TextureLoader.h"
+#include "gfx/TextureCache.h"
+#include "gfx/TextureReloader.h"
 #include "gfx/GPUTimer.h"
 #include "core/InputManager.h"
+#include "core/EntityStore.h"
 #include "gfx/ShaderReloader.h"
+#include "gfx/ShaderPermutationManager.h"
 
 namespace jisaku
 {
@@ -19,6 +23,7 @@ namespace jisaku
     class RenderPass_Triangle;
     class RenderPass_TexturedQuad;
     class TextureLoader;
+    class CookClient;
     struct TextureHandle;
 
     class App
@@ -49,8 +54,8 @@ namespace jisaku
         std::unique_ptr<TextureLoader> m_texLoader;
         TextureHandle m_loadedTex;
 
-        // 遅延ロード用の一時パス
-        std::wstring m_pendingTexturePath;
+        // 遅延ロード用の一時パス（複数選択可）
+        std::vector<std::wstring> m_pendingTexturePaths;
 
         // 非同期ロード制御
         std::atomic<bool> m_loading{ false };
@@ -58,9 +63,17 @@ namespace jisaku
         TextureHandle m_loadedTemp;
         std::thread m_loaderThread;
 
-        // 複数テクスチャ管理
-        std::vector<jisaku::TextureHandle> m_textures;
+        // 複数テクスチャ管理（同じファイルはキャッシュで共有。参照が無くなったら GPU 待ち後に解放）
+        std::unique_ptr<jisaku::TextureCache> m_texCache;
+        std::vector<jisaku::TexturePtr> m_textures;
+        std::vector<std::wstring> m_texturePaths; // m_textures と同じ並び
         int m_activeTex = -1;
+        bool m_collectTextures = false;
+        // 元画像が書き換えられたら同じスロットへ読み直す（キャッシュより先に破棄されるよう後ろに置く）
+        std::unique_ptr<jisaku::TextureReloader> m_texReloader;
+
+        // シーン（現在はクアッド 1 つ = エンティティ 0）。scene.jscn へ保存・読み込みする
+        jisaku::EntityStore m_scene;
 
         // GPUタイマー
         std::unique_ptr<jisaku::GPUTimer> m_gpuTimer;
@@ -68,7 +81,13 @@ namespace jisaku
         
         // シェーダーホットリロード
         std::unique_ptr<jisaku::ShaderReloader> m_shaderReloader;
+        bool m_shaderHotReload = false; // false ならシェーダーパックから読むだけ（m_shaderReloader は null）
+        // 機能ビットごとの PSO（パスより先に破棄する）
+        std::unique_ptr<jisaku::ShaderPermutationManager> m_permutations;
         double m_dtSmoothed = 0.0;
+
+        // クックサーバー（環境変数 JISAKU_COOK_SERVER を設定したときだけつなぐ）。Vfs にマウントして共有する
+        std::shared_ptr<jisaku::CookClient> m_cookClient;
         
         // マウスカーソル状態管理
         bool m_cursorHidden = false;
@@ -0,0 +1,109 @@
+#include "core/AssetManifest.h"
+#include <xxhash.h>
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+constexpr const char* kManifestMagic = "JMAN 1";
+
+std::string ToUtf8(const std::filesystem::path& path) {
+    const std::u8string u8 = path.generic_u8string();
+    return std::string(u8.begin(), u8.end());
+}
+
+std::filesystem::path FromUtf8(std::string_view s) {
+    return std::filesystem::path(std::u8string(s.begin(), s.end()));
+}
+
+bool ParseHex64(std::string_view s, uint64_t& out) {
+    auto [p, ec] = std::from_chars(s.data(), s.data() + s.size(), out, 16);
+    return ec == std::errc() && p == s.data() + s.size();
+}
+
+} // namespace
+
+std::string ContentKey::ToHex() const {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string s(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        s[15 - i] = kDigits[(hi >> (4 * i)) & 0xF];
+        s[31 - i] = kDigits[(lo >> (4 * i)) & 0xF];
+    }
+    return s;
+}
+
+bool ContentKey::FromHex(std::string_view hex, ContentKey& out) {
+    return hex.size() == 32 && ParseHex64(hex.substr(0, 16), out.hi) && ParseHex64(hex.substr(16), out.lo);
+}
+
+ContentKey jisaku::HashContent(const void* data, size_t size) {
+    const XXH128_hash_t h = XXH3_128bits(data, size);
+    return ContentKey{ h.high64, h.low64 };
+}
+
+std::filesystem::path jisaku::ContentObjectPath(const std::filesystem::path& root, const ContentKey& key) {
+    const std::string hex = key.ToHex();
+    return root / hex.substr(0, 2) / hex;
+}
+
+bool AssetManifest::Load(const std::filesystem::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) return false;
+    std::string line;
+    if (!std::getline(in, line) || line != kManifestMagic) return false;
+    if (!std::getline(in, line) || line.rfind("root ", 0) != 0) return false;
+    std::filesystem::path root = FromUtf8(std::string_view(line).substr(5));
+    m_objectRoot = root.is_absolute() ? root : file.parent_path() / root;
+
+    m_entries.clear();
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        // <キー> <サイズ> <仮想パス>（仮想パスは空白を含んでよいので行末まで）
+        const size_t a = line.find(' ');
+        const size_t b = a == std::string::npos ? a : line.find(' ', a + 1);
+        if (b == std::string::npos || b + 1 >= line.size()) return false;
+        ManifestEntry e;
+        const std::string_view sizeText = std::string_view(line).substr(a + 1, b - a - 1);
+        auto [p, ec] = std::from_chars(sizeText.data(), sizeText.data() + sizeText.size(), e.size);
+        if (!ContentKey::FromHex(std::string_view(line).substr(0, a), e.key) || ec != std::errc() ||
+            p != sizeText.data() + sizeText.size())
+            return false;
+        m_entries[line.substr(b + 1)] = e;
+    }
+    return true;
+}
+
+bool AssetManifest::Save(const std::filesystem::path& file) const {
+    // 差分が読みやすいよう名前順に並べる
+    std::vector<const std::pair<const std::string, ManifestEntry>*> sorted;
+    sorted.reserve(m_entries.size());
+    for (const auto& e : m_entries) sorted.push_back(&e);
+    std::sort(sorted.begin(), sorted.end(), [](auto* a, auto* b) { return a->first < b->first; });
+
+    std::filesystem::path tmp = file;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out << kManifestMagic << '\n' << "root " << ToUtf8(m_objectRoot) << '\n';
+        for (auto* e : sorted) out << e->second.key.ToHex() << ' ' << e->second.size << ' ' << e->first << '\n';
+        if (!out) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, file, ec);
+    return !ec;
+}
+
+void AssetManifest::Add(const std::string& name, const ContentKey& key, uint64_t size) {
+    m_entries[name] = ManifestEntry{ key, size };
+}
+
+const ManifestEntry* AssetManifest::Find(const std::string& name) const {
+    auto it = m_entries.find(name);
+    return it == m_entries.end() ? nullptr : &it->second;
+}
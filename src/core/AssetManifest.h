@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace jisaku {
+
+// コンテンツアドレス型ストアのキー（XXH3 128bit）。
+// アセットビルドでは「入力の中身 + ビルド設定 + ツールのバージョン」から作り、同じキーの出力は作り直さない
+struct ContentKey {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    bool operator==(const ContentKey& o) const { return hi == o.hi && lo == o.lo; }
+    bool operator!=(const ContentKey& o) const { return !(*this == o); }
+    bool IsZero() const { return hi == 0 && lo == 0; }
+
+    std::string ToHex() const; // 小文字 32 桁
+    static bool FromHex(std::string_view hex, ContentKey& out);
+};
+
+ContentKey HashContent(const void* data, size_t size);
+
+// ストア内の置き場所: root/<先頭 2 桁>/<32 桁>
+std::filesystem::path ContentObjectPath(const std::filesystem::path& root, const ContentKey& key);
+
+struct ManifestEntry {
+    ContentKey key;
+    uint64_t size = 0;
+};
+
+// アセットビルドの出力一覧（仮想パス → ストア内のオブジェクト）。Vfs::MountManifest で読める。
+// テキスト形式（UTF-8、1 行 1 エントリ）:
+//   JMAN 1
+//   root <オブジェクトのディレクトリ。相対ならマニフェストのあるディレクトリ基準>
+//   <キー 32 桁> <サイズ> <仮想パス>
+class AssetManifest {
+public:
+    bool Load(const std::filesystem::path& file);
+    // 一時ファイルに書いてから置き換える（読み込み中のプロセスが半端な状態を見ない）
+    bool Save(const std::filesystem::path& file) const;
+
+    void SetObjectRoot(const std::filesystem::path& root) { m_objectRoot = root; }
+    const std::filesystem::path& GetObjectRoot() const { return m_objectRoot; }
+
+    void Add(const std::string& name, const ContentKey& key, uint64_t size);
+    const ManifestEntry* Find(const std::string& name) const;
+    std::filesystem::path GetObjectPath(const ManifestEntry& entry) const { return ContentObjectPath(m_objectRoot, entry.key); }
+
+    size_t Size() const { return m_entries.size(); }
+    const std::unordered_map<std::string, ManifestEntry>& GetEntries() const { return m_entries; }
+
+private:
+    std::filesystem::path m_objectRoot; // Load 後は絶対パス（またはカレント基準）に解決済み
+    std::unordered_map<std::string, ManifestEntry> m_entries;
+};
+
+} // namespace jisaku
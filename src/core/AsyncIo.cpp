@@ -0,0 +1,564 @@
+#include "core/AsyncIo.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace jisaku;
+
+namespace {
+
+// 1 回の読み込み要求の上限（ReadFile / readv の長さは 32bit 前後に制限される）
+constexpr uint64_t kMaxChunk = 1ull << 30;
+
+} // namespace
+
+const char* jisaku::IoBackendName(IoBackend backend) {
+    switch (backend) {
+    case IoBackend::IoUring: return "io_uring";
+    case IoBackend::Iocp: return "IOCP";
+    case IoBackend::ThreadPool: return "ThreadPool";
+    default: return "Auto";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// IoFile
+// ---------------------------------------------------------------------------
+std::shared_ptr<IoFile> IoFile::Open(const std::filesystem::path& path) {
+    std::shared_ptr<IoFile> f(new IoFile());
+#ifdef _WIN32
+    // ホットリロード中にエディタが書き換えられるよう書き込み共有も許す
+    HANDLE h = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return nullptr;
+    f->m_handle = h;
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(h, &size)) return nullptr;
+    f->m_size = uint64_t(size.QuadPart);
+#else
+    f->m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (f->m_fd < 0) return nullptr;
+    struct stat st {};
+    if (fstat(f->m_fd, &st) != 0 || !S_ISREG(st.st_mode)) return nullptr;
+    f->m_size = uint64_t(st.st_size);
+#endif
+    return f;
+}
+
+IoFile::~IoFile() {
+#ifdef _WIN32
+    if (m_handle) CloseHandle(m_handle);
+#else
+    if (m_fd >= 0) ::close(m_fd);
+#endif
+}
+
+bool IoFile::ReadAt(uint64_t offset, void* dst, size_t size) const {
+    uint8_t* p = static_cast<uint8_t*>(dst);
+#ifdef _WIN32
+    // 下位ビットを立てたイベントを渡すと、IOCP に関連付け済みのハンドルでも完了ポートへ通知されない
+    HANDLE event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!event) return false;
+    bool ok = true;
+    while (size > 0 && ok) {
+        OVERLAPPED ov{};
+        ov.Offset = DWORD(offset);
+        ov.OffsetHigh = DWORD(offset >> 32);
+        ov.hEvent = reinterpret_cast<HANDLE>(reinterpret_cast<uintptr_t>(event) | 1);
+        const DWORD chunk = DWORD(std::min<uint64_t>(size, kMaxChunk));
+        DWORD n = 0;
+        if (!ReadFile(m_handle, p, chunk, nullptr, &ov) && GetLastError() != ERROR_IO_PENDING) ok = false;
+        else if (!GetOverlappedResult(m_handle, &ov, &n, TRUE) || n == 0) ok = false;
+        p += n;
+        offset += n;
+        size -= n;
+    }
+    CloseHandle(event);
+    return ok;
+#else
+    while (size > 0) {
+        const ssize_t n = ::pread(m_fd, p, std::min<uint64_t>(size, kMaxChunk), off_t(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        offset += uint64_t(n);
+        size -= size_t(n);
+    }
+    return true;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// AsyncIo
+// ---------------------------------------------------------------------------
+struct AsyncIo::Op_ {
+#ifdef _WIN32
+    OVERLAPPED ov{}; // 完了通知からの逆引き用に先頭に置く
+#else
+    iovec iov{};
+#endif
+    IoReadRequest req;
+    std::vector<uint8_t> owned;
+    uint8_t* dst = nullptr;
+    uint64_t size = 0; // 読む総バイト数（prepare_ で確定）
+    uint64_t done = 0; // 読めたバイト数
+};
+
+struct AsyncIo::Backend_ {
+    bool waiting = false; // カーネル側で完了待ち中（Submit から起こす必要がある）。m_mutex で保護
+
+#ifdef __linux__
+    static constexpr uint64_t kWakeTag = 0; // eventfd の poll 完了（Op_ のアドレスは 0 にならない）
+
+    int ringFd = -1;
+    int eventFd = -1;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned toSubmit = 0;
+
+    bool InitUring(unsigned entries) {
+        io_uring_params p{};
+        ringFd = int(syscall(__NR_io_uring_setup, entries, &p));
+        if (ringFd < 0) return false;
+
+        sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) { sqRing = nullptr; return false; }
+        if (single) {
+            cqRing = sqRing;
+        } else {
+            cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) { cqRing = nullptr; return false; }
+        }
+        sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+        void* s = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (s == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(s);
+
+        auto at = [](void* base, uint32_t off) { return reinterpret_cast<unsigned*>(static_cast<uint8_t*>(base) + off); };
+        sqTail = at(sqRing, p.sq_off.tail);
+        sqMask = at(sqRing, p.sq_off.ring_mask);
+        sqArray = at(sqRing, p.sq_off.array);
+        cqHead = at(cqRing, p.cq_off.head);
+        cqTail = at(cqRing, p.cq_off.tail);
+        cqMask = at(cqRing, p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(static_cast<uint8_t*>(cqRing) + p.cq_off.cqes);
+
+        eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        return eventFd >= 0;
+    }
+
+    io_uring_sqe* NextSqe(uint64_t userData) {
+        const unsigned tail = *sqTail; // 書き手はこのスレッドだけ
+        const unsigned idx = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = userData;
+        sqArray[idx] = idx;
+        std::atomic_ref<unsigned>(*sqTail).store(tail + 1, std::memory_order_release);
+        ++toSubmit;
+        return sqe;
+    }
+
+    void PushRead(Op_& op) {
+        const uint64_t offset = op.req.offset + op.done;
+        op.iov.iov_base = op.dst + op.done;
+        op.iov.iov_len = size_t(std::min(op.size - op.done, kMaxChunk));
+        io_uring_sqe* sqe = NextSqe(reinterpret_cast<uint64_t>(&op));
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = op.req.file->GetFd();
+        sqe->addr = reinterpret_cast<uint64_t>(&op.iov);
+        sqe->len = 1;
+        sqe->off = offset;
+        // ベストエフォート クラス内の優先度（0 が最優先。RT クラスは特権が要るので使わない）
+        static const uint16_t kLevels[kIoPriorityCount] = { 7, 4, 2, 0 };
+        sqe->ioprio = uint16_t((2 << 13) | kLevels[uint32_t(op.req.priority)]);
+    }
+
+    void PushWakePoll() {
+        io_uring_sqe* sqe = NextSqe(kWakeTag);
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = eventFd;
+        sqe->poll_events = POLLIN;
+    }
+
+    // 溜めた SQE を発行し、minComplete 件の完了まで待つ
+    bool Enter(unsigned minComplete) {
+        for (;;) {
+            const int r = int(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete,
+                                      minComplete ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+            if (r >= 0) { toSubmit -= unsigned(r); return true; }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) return false;
+        }
+    }
+
+    void Wake() {
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t n = ::write(eventFd, &one, sizeof(one));
+    }
+#endif
+
+#ifdef _WIN32
+    static constexpr ULONG_PTR kWakeKey = 1;
+    HANDLE port = nullptr;
+
+    bool InitIocp() {
+        port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+        return port != nullptr;
+    }
+
+    void Wake() { PostQueuedCompletionStatus(port, 0, kWakeKey, nullptr); }
+#endif
+
+    ~Backend_() {
+#ifdef __linux__
+        if (sqes) munmap(sqes, sqesSize);
+        if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing) munmap(sqRing, sqRingSize);
+        if (eventFd >= 0) ::close(eventFd);
+        if (ringFd >= 0) ::close(ringFd);
+#endif
+#ifdef _WIN32
+        if (port) CloseHandle(port);
+#endif
+    }
+};
+
+AsyncIo::AsyncIo(const Config& config) : m_config(config) {
+    m_config.queueDepth = std::max(m_config.queueDepth, 1u);
+    const IoBackend want = config.backend;
+#ifdef __linux__
+    if (want == IoBackend::Auto || want == IoBackend::IoUring) {
+        auto impl = std::make_unique<Backend_>();
+        // +1 は起床用 poll の分
+        if (impl->InitUring(m_config.queueDepth + 1)) {
+            m_impl = std::move(impl);
+            m_backend = IoBackend::IoUring;
+            m_threads.emplace_back([this]() { uringLoop_(); });
+            return;
+        }
+    }
+#endif
+#ifdef _WIN32
+    if (want == IoBackend::Auto || want == IoBackend::Iocp) {
+        auto impl = std::make_unique<Backend_>();
+        if (impl->InitIocp()) {
+            m_impl = std::move(impl);
+            m_backend = IoBackend::Iocp;
+            m_threads.emplace_back([this]() { iocpLoop_(); });
+            return;
+        }
+    }
+#endif
+    (void)want;
+    m_backend = IoBackend::ThreadPool;
+    const uint32_t threads = std::clamp(m_config.poolThreads, 1u, m_config.queueDepth);
+    for (uint32_t i = 0; i < threads; ++i) m_threads.emplace_back([this]() { poolLoop_(); });
+}
+
+AsyncIo::~AsyncIo() {
+    bool wakeKernel = false;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_quit = true;
+        wakeKernel = m_impl && m_impl->waiting;
+    }
+    m_cv.notify_all();
+#if defined(__linux__) || defined(_WIN32)
+    if (wakeKernel) m_impl->Wake();
+#endif
+    for (auto& t : m_threads) t.join();
+}
+
+AsyncIo& AsyncIo::Get() {
+    static AsyncIo s_instance;
+    return s_instance;
+}
+
+void AsyncIo::Submit(IoReadRequest request) {
+    auto op = std::make_unique<Op_>();
+    op->req = std::move(request);
+    bool wakeKernel = false;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_pending[uint32_t(op->req.priority)].push_back(std::move(op));
+        ++m_pendingCount;
+        wakeKernel = m_impl && m_impl->waiting;
+    }
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+#if defined(__linux__) || defined(_WIN32)
+    if (wakeKernel) { m_impl->Wake(); return; }
+#endif
+    m_cv.notify_one();
+}
+
+void AsyncIo::WaitIdle() {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_idleCv.wait(lk, [this]() { return m_pendingCount == 0 && m_inFlight == 0; });
+}
+
+AsyncIo::Stats AsyncIo::GetStats() const {
+    Stats s;
+    s.requests = m_requests.load(std::memory_order_relaxed);
+    s.bytes = m_bytes.load(std::memory_order_relaxed);
+    s.maxInFlight = m_maxInFlight.load(std::memory_order_relaxed);
+    return s;
+}
+
+std::unique_ptr<AsyncIo::Op_> AsyncIo::popPending_() {
+    for (uint32_t p = kIoPriorityCount; p-- > 0;) {
+        if (m_pending[p].empty()) continue;
+        std::unique_ptr<Op_> op = std::move(m_pending[p].front());
+        m_pending[p].pop_front();
+        --m_pendingCount;
+        ++m_inFlight;
+        if (m_inFlight > m_maxInFlight.load(std::memory_order_relaxed)) m_maxInFlight.store(m_inFlight, std::memory_order_relaxed);
+        return op;
+    }
+    return nullptr;
+}
+
+bool AsyncIo::prepare_(Op_& op) {
+    IoReadRequest& req = op.req;
+    if (!req.file) req.file = IoFile::Open(req.path);
+    if (!req.file) return false;
+    const uint64_t fileSize = req.file->GetSize();
+    if (req.offset > fileSize) return false;
+    op.size = req.size == kIoWholeFile ? fileSize - req.offset : req.size;
+    if (op.size > fileSize - req.offset) return false;
+    if (req.dst) {
+        op.dst = req.dst;
+    } else {
+        try {
+            op.owned.resize(size_t(op.size));
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        op.dst = op.owned.data();
+    }
+#ifdef _WIN32
+    if (m_backend == IoBackend::Iocp && req.file->m_port != m_impl->port) {
+        if (req.file->m_port || !CreateIoCompletionPort(req.file->m_handle, m_impl->port, 0, 0)) return false;
+        req.file->m_port = m_impl->port;
+    }
+#endif
+    return true;
+}
+
+void AsyncIo::complete_(std::unique_ptr<Op_> op, bool ok) {
+    IoReadResult result;
+    result.ok = ok;
+    result.bytes = ok ? op->done : 0;
+    if (ok) {
+        result.data = std::move(op->owned);
+        m_bytes.fetch_add(op->done, std::memory_order_relaxed);
+    }
+    auto onComplete = std::move(op->req.onComplete);
+    op.reset(); // 一時オープンしたファイルはここで閉じる
+    if (onComplete) {
+        try {
+            onComplete(std::move(result));
+        } catch (...) {
+            // コールバックの例外で I/O スレッドを止めない
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    --m_inFlight;
+    if (m_inFlight == 0 && m_pendingCount == 0) m_idleCv.notify_all();
+}
+
+void AsyncIo::poolLoop_() {
+    for (;;) {
+        std::unique_ptr<Op_> op;
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            m_cv.wait(lk, [this]() { return m_quit || m_pendingCount > 0; });
+            if (m_pendingCount == 0) return; // m_quit
+            op = popPending_();
+        }
+        bool ok = prepare_(*op);
+        if (ok && op->size > 0) ok = op->req.file->ReadAt(op->req.offset, op->dst, size_t(op->size));
+        if (ok) op->done = op->size;
+        complete_(std::move(op), ok);
+    }
+}
+
+void AsyncIo::uringLoop_() {
+#ifdef __linux__
+    Backend_& ring = *m_impl;
+    uint32_t inRing = 0;      // カーネルに渡した読み込み数
+    bool pollArmed = false;
+    std::vector<std::unique_ptr<Op_>> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            if (inRing == 0) m_cv.wait(lk, [this]() { return m_quit || m_pendingCount > 0; });
+            if (m_quit && m_pendingCount == 0 && inRing == 0) return;
+            while (inRing + batch.size() < m_config.queueDepth && m_pendingCount > 0) batch.push_back(popPending_());
+        }
+
+        for (auto& op : batch) {
+            if (!prepare_(*op)) { complete_(std::move(op), false); continue; }
+            if (op->size == 0) { complete_(std::move(op), true); continue; }
+            ring.PushRead(*op);
+            op.release(); // 完了まで所有権はリング側（user_data）
+            ++inRing;
+        }
+        batch.clear();
+        if (inRing == 0) {
+            if (ring.toSubmit > 0) ring.Enter(0);
+            continue;
+        }
+        if (!pollArmed) {
+            ring.PushWakePoll();
+            pollArmed = true;
+        }
+
+        // 空きがあるのに次の要求が来ていれば待たずに刈り取るだけにする（Submit が起床を見逃した場合の保険）
+        bool block = false;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            block = m_pendingCount == 0 || inRing >= m_config.queueDepth;
+            ring.waiting = block;
+        }
+        const bool entered = ring.Enter(block ? 1 : 0);
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            ring.waiting = false;
+        }
+        if (!entered) {
+            // リングが使えなくなると発行済みの完了を受け取れず、待っている側が永久に止まる。続行できない
+            std::abort();
+        }
+
+        unsigned head = *ring.cqHead;
+        const unsigned tail = std::atomic_ref<unsigned>(*ring.cqTail).load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+            if (cqe.user_data == Backend_::kWakeTag) {
+                uint64_t value = 0;
+                [[maybe_unused]] const ssize_t n = ::read(ring.eventFd, &value, sizeof(value));
+                pollArmed = false;
+                continue;
+            }
+            std::unique_ptr<Op_> op(reinterpret_cast<Op_*>(cqe.user_data));
+            if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                ring.PushRead(*op);
+                op.release();
+                continue;
+            }
+            --inRing;
+            if (cqe.res <= 0) { complete_(std::move(op), false); continue; }
+            op->done += uint64_t(cqe.res);
+            if (op->done < op->size) {
+                // 短い読み込みは続きを出し直す
+                ring.PushRead(*op);
+                op.release();
+                ++inRing;
+                continue;
+            }
+            complete_(std::move(op), true);
+        }
+        std::atomic_ref<unsigned>(*ring.cqHead).store(head, std::memory_order_release);
+    }
+#endif
+}
+
+void AsyncIo::iocpLoop_() {
+#ifdef _WIN32
+    Backend_& iocp = *m_impl;
+    uint32_t inPort = 0;
+    std::vector<std::unique_ptr<Op_>> batch;
+    auto issue = [&](std::unique_ptr<Op_> op) {
+        const uint64_t offset = op->req.offset + op->done;
+        op->ov = OVERLAPPED{};
+        op->ov.Offset = DWORD(offset);
+        op->ov.OffsetHigh = DWORD(offset >> 32);
+        const DWORD chunk = DWORD(std::min(op->size - op->done, kMaxChunk));
+        // 同期完了でも完了ポートへは通知される（FILE_SKIP_COMPLETION_PORT_ON_SUCCESS は立てない）
+        if (!ReadFile(op->req.file->m_handle, op->dst + op->done, chunk, nullptr, &op->ov) && GetLastError() != ERROR_IO_PENDING) {
+            complete_(std::move(op), false);
+            return;
+        }
+        op.release();
+        ++inPort;
+    };
+
+    OVERLAPPED_ENTRY entries[64];
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            if (inPort == 0) m_cv.wait(lk, [this]() { return m_quit || m_pendingCount > 0; });
+            if (m_quit && m_pendingCount == 0 && inPort == 0) return;
+            while (inPort + batch.size() < m_config.queueDepth && m_pendingCount > 0) batch.push_back(popPending_());
+        }
+        for (auto& op : batch) {
+            if (!prepare_(*op)) { complete_(std::move(op), false); continue; }
+            if (op->size == 0) { complete_(std::move(op), true); continue; }
+            issue(std::move(op));
+        }
+        batch.clear();
+        if (inPort == 0) continue;
+
+        bool block = false;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            block = m_pendingCount == 0 || inPort >= m_config.queueDepth;
+            iocp.waiting = block;
+        }
+        ULONG count = 0;
+        const BOOL got = GetQueuedCompletionStatusEx(iocp.port, entries, ULONG(std::size(entries)), &count, block ? INFINITE : 0, FALSE);
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            iocp.waiting = false;
+        }
+        if (!got) continue;
+
+        for (ULONG i = 0; i < count; ++i) {
+            if (entries[i].lpCompletionKey == Backend_::kWakeKey) continue;
+            std::unique_ptr<Op_> op(CONTAINING_RECORD(entries[i].lpOverlapped, Op_, ov));
+            --inPort;
+            const DWORD n = entries[i].dwNumberOfBytesTransferred;
+            if (op->ov.Internal != 0 || n == 0) { complete_(std::move(op), false); continue; }
+            op->done += n;
+            if (op->done < op->size) { issue(std::move(op)); continue; }
+            complete_(std::move(op), true);
+        }
+    }
+#endif
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jisaku {
+
+// 非同期ファイル読み込みキュー。
+// バックエンドは Linux: io_uring、Windows: IOCP。使えない環境（古いカーネル・seccomp 等）では
+// 読み込み専用スレッドのプールで pread/ReadFile する（JobSystem のワーカーを I/O 待ちで塞がない）。
+// 要求は優先度の高い順に取り出し、最大 queueDepth 件を同時に発行する。
+enum class IoPriority : uint8_t {
+    Low,      // 先読み・ストリーミング
+    Normal,
+    High,     // 次のフレームで必要
+    Critical, // 呼び出し側が同期で待っている
+};
+constexpr uint32_t kIoPriorityCount = 4;
+
+enum class IoBackend : uint8_t {
+    Auto,
+    IoUring,
+    Iocp,
+    ThreadPool,
+};
+
+const char* IoBackendName(IoBackend backend);
+
+// 読み込み用に開いたファイル。パックのように開きっぱなしにするものは共有して使い回す
+class IoFile {
+public:
+    static std::shared_ptr<IoFile> Open(const std::filesystem::path& path);
+    ~IoFile();
+
+    IoFile(const IoFile&) = delete;
+    IoFile& operator=(const IoFile&) = delete;
+
+    uint64_t GetSize() const { return m_size; }
+    // 同期読み込み（短い読み込みは続けて読む）。スレッドプール経路とパックの目次読み込みで使う
+    bool ReadAt(uint64_t offset, void* dst, size_t size) const;
+
+#ifdef _WIN32
+    void* GetHandle() const { return m_handle; }
+#else
+    int GetFd() const { return m_fd; }
+#endif
+
+private:
+    friend class AsyncIo;
+    IoFile() = default;
+#ifdef _WIN32
+    void* m_handle = nullptr; // FILE_FLAG_OVERLAPPED で開く（IOCP に関連付けられる）
+    void* m_port = nullptr;   // 関連付け済みの完了ポート（ハンドルは 1 つのポートにしか結べない）
+#else
+    int m_fd = -1;
+#endif
+    uint64_t m_size = 0;
+};
+
+constexpr uint64_t kIoWholeFile = ~0ull;
+
+struct IoReadResult {
+    bool ok = false;
+    uint64_t bytes = 0;
+    std::vector<uint8_t> data; // IoReadRequest::dst が null のときだけ入る
+};
+
+struct IoReadRequest {
+    std::shared_ptr<IoFile> file;  // 開いてあるファイル
+    std::filesystem::path path;    // file が null ならキュー側で開き、読み終わったら閉じる
+    uint64_t offset = 0;
+    uint64_t size = kIoWholeFile;  // kIoWholeFile: offset からファイル末尾まで
+    uint8_t* dst = nullptr;        // null ならキュー側で確保する。非 null なら完了まで生かしておくこと
+    IoPriority priority = IoPriority::Normal;
+    // I/O スレッドから呼ばれる。重い処理はジョブに回すこと
+    std::function<void(IoReadResult&&)> onComplete;
+};
+
+class AsyncIo {
+public:
+    struct Config {
+        IoBackend backend = IoBackend::Auto;
+        uint32_t queueDepth = 64;    // 同時に発行する読み込み数の上限
+        uint32_t poolThreads = 4;    // スレッドプール経路のスレッド数
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t bytes = 0;
+        uint32_t maxInFlight = 0;
+    };
+
+    AsyncIo() : AsyncIo(Config{}) {}
+    explicit AsyncIo(const Config& config);
+    // 残っている要求はすべて完了させてから止める
+    ~AsyncIo();
+
+    AsyncIo(const AsyncIo&) = delete;
+    AsyncIo& operator=(const AsyncIo&) = delete;
+
+    // プロセス共通のキュー（初回呼び出し時に生成）
+    static AsyncIo& Get();
+
+    // request.onComplete は必ず 1 回呼ばれる（開けない・範囲外・読み込みエラーは ok == false）
+    void Submit(IoReadRequest request);
+    // キューが空になり、発行中の読み込みもすべて完了するまで待つ
+    void WaitIdle();
+
+    IoBackend GetBackend() const { return m_backend; }
+    Stats GetStats() const;
+
+private:
+    struct Op_;
+    struct Backend_;
+
+    // 優先度の高い順に 1 件取り出す（m_mutex を保持して呼ぶ）
+    std::unique_ptr<Op_> popPending_();
+    // ファイルを開いてサイズを確定し、書き込み先を用意する。失敗時は呼び出し側で ok == false で完了させる
+    bool prepare_(Op_& op);
+    void complete_(std::unique_ptr<Op_> op, bool ok);
+    void uringLoop_();
+    void iocpLoop_();
+    void poolLoop_();
+
+    Config m_config;
+    IoBackend m_backend = IoBackend::ThreadPool;
+    std::unique_ptr<Backend_> m_impl;
+    std::vector<std::thread> m_threads;
+    std::deque<std::unique_ptr<Op_>> m_pending[kIoPriorityCount];
+    size_t m_pendingCount = 0;
+    uint32_t m_inFlight = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_idleCv;
+    bool m_quit = false;
+    std::atomic<uint64_t> m_requests{ 0 };
+    std::atomic<uint64_t> m_bytes{ 0 };
+    std::atomic<uint32_t> m_maxInFlight{ 0 };
+};
+
+} // namespace jisaku
@@ -0,0 +1,50 @@
+#include "core/AtomicFile.h"
+#include <fstream>
+#include <random>
+#include <string>
+
+using namespace jisaku;
+
+namespace {
+
+// 同じ名前に並んで書くプロセス・スレッドがぶつからないように
+std::string RandomSuffix() {
+    static thread_local std::mt19937_64 s_rng{ std::random_device{}() };
+    return std::to_string(s_rng());
+}
+
+} // namespace
+
+bool jisaku::WriteFileAtomic(const std::filesystem::path& file, const std::function<bool(std::ostream&)>& write, bool binary) {
+    std::filesystem::path tmp = file;
+    tmp += '.' + RandomSuffix() + ".tmp";
+    bool ok = false;
+    {
+        std::ofstream out(tmp, binary ? std::ios::binary | std::ios::trunc : std::ios::trunc);
+        if (out) {
+            ok = write(out);
+            out.close();
+            ok = ok && !out.fail();
+        }
+    }
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(tmp, file, ec);
+        ok = !ec;
+    }
+    if (!ok) std::filesystem::remove(tmp, ec);
+    return ok;
+}
+
+bool jisaku::WriteFileAtomic(const std::filesystem::path& file, const void* data, size_t size) {
+    return WriteFileAtomic(file, [data, size](std::ostream& out) {
+        return bool(out.write(static_cast<const char*>(data), std::streamsize(size)));
+    });
+}
+
+std::filesystem::path jisaku::CreateTempDirectory(std::string_view prefix) {
+    std::error_code ec;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path(ec) / (std::string(prefix) + RandomSuffix());
+    if (ec || !std::filesystem::create_directories(dir, ec)) return {};
+    return dir;
+}
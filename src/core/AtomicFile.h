@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string_view>
+
+namespace jisaku {
+
+// 同じディレクトリの一時ファイル（file + ".<乱数>.tmp"）に書いてから file へ rename する。
+// 途中で落ちても・同時に書いても、file は前の内容か新しい内容のどちらかで、書きかけにはならない。
+// write が false を返す・書き込みや rename に失敗したときは一時ファイルを消して false
+bool WriteFileAtomic(const std::filesystem::path& file, const std::function<bool(std::ostream&)>& write, bool binary = true);
+bool WriteFileAtomic(const std::filesystem::path& file, const void* data, size_t size);
+
+// 一時ディレクトリの下に prefix + "<乱数>" のディレクトリを作る。失敗時は空のパス
+std::filesystem::path CreateTempDirectory(std::string_view prefix);
+
+} // namespace jisaku
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+namespace jisaku {
+
+// ファイル・通信で使うリトルエンディアンの整数の読み書き（整列していない位置でもよい）
+inline uint16_t ReadU16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+inline uint32_t ReadU32(const uint8_t* p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24); }
+inline uint64_t ReadU64(const uint8_t* p) { return uint64_t(ReadU32(p)) | (uint64_t(ReadU32(p + 4)) << 32); }
+
+inline void WriteU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = uint8_t(v >> (8 * i));
+}
+inline void WriteU64(uint8_t* p, uint64_t v) {
+    WriteU32(p, uint32_t(v));
+    WriteU32(p + 4, uint32_t(v >> 32));
+}
+
+} // namespace jisaku
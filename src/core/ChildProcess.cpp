@@ -0,0 +1,324 @@
+#include "core/ChildProcess.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+using namespace jisaku;
+
+namespace {
+
+#ifdef _WIN32
+std::wstring Widen(std::string_view s) {
+    if (s.empty()) return {};
+    const int n = MultiByteToWideChar(CP_UTF8, 0, s.data(), int(s.size()), nullptr, 0);
+    std::wstring w(size_t(n), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, s.data(), int(s.size()), w.data(), n);
+    return w;
+}
+
+// CommandLineToArgvW と同じ規則で 1 引数をクォートする
+void AppendQuoted(std::wstring& cmd, const std::wstring& arg) {
+    if (!cmd.empty()) cmd += L' ';
+    if (!arg.empty() && arg.find_first_of(L" \t\n\v\"") == std::wstring::npos) {
+        cmd += arg;
+        return;
+    }
+    cmd += L'"';
+    for (size_t i = 0;; ++i) {
+        size_t backslashes = 0;
+        while (i < arg.size() && arg[i] == L'\\') {
+            ++i;
+            ++backslashes;
+        }
+        if (i == arg.size()) {
+            cmd.append(backslashes * 2, L'\\');
+            break;
+        }
+        if (arg[i] == L'"') {
+            cmd.append(backslashes * 2 + 1, L'\\');
+        } else {
+            cmd.append(backslashes, L'\\');
+        }
+        cmd += arg[i];
+    }
+    cmd += L'"';
+}
+#endif
+
+} // namespace
+
+std::unique_ptr<ChildProcess> ChildProcess::Spawn(const std::vector<std::string>& args, bool pipes) {
+    if (args.empty()) return nullptr;
+    std::unique_ptr<ChildProcess> p(new ChildProcess());
+#ifdef _WIN32
+    std::wstring cmd;
+    for (const std::string& a : args) AppendQuoted(cmd, Widen(a));
+
+    STARTUPINFOEXW si{};
+    si.StartupInfo.cb = sizeof(si.StartupInfo);
+    HANDLE childIn = nullptr, childOut = nullptr;
+    if (pipes) {
+        // 子に渡す側だけ継承可能にする
+        SECURITY_ATTRIBUTES sa{ sizeof(sa), nullptr, TRUE };
+        HANDLE inRead = nullptr, inWrite = nullptr, outRead = nullptr, outWrite = nullptr;
+        if (!CreatePipe(&inRead, &inWrite, &sa, 0)) return nullptr;
+        if (!CreatePipe(&outRead, &outWrite, &sa, 0)) {
+            CloseHandle(inRead);
+            CloseHandle(inWrite);
+            return nullptr;
+        }
+        SetHandleInformation(inWrite, HANDLE_FLAG_INHERIT, 0);
+        SetHandleInformation(outRead, HANDLE_FLAG_INHERIT, 0);
+        p->m_stdin = inWrite;
+        p->m_stdout = outRead;
+        childIn = inRead;
+        childOut = outWrite;
+        si.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+        si.StartupInfo.hStdInput = childIn;
+        si.StartupInfo.hStdOutput = childOut;
+        si.StartupInfo.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    }
+    // 継承させるのは子の標準入出力だけにする（別スレッドが同時に作ったパイプまで継承すると、
+    // その子が終了・Kill されても読み手に EOF が届かない）
+    std::vector<char> attrBuffer;
+    HANDLE inherit[3] = { childIn, childOut, nullptr };
+    DWORD inheritCount = 2;
+    DWORD stderrFlags = 0;
+    if (pipes && si.StartupInfo.hStdError && si.StartupInfo.hStdError != INVALID_HANDLE_VALUE &&
+        GetHandleInformation(si.StartupInfo.hStdError, &stderrFlags) && (stderrFlags & HANDLE_FLAG_INHERIT))
+        inherit[inheritCount++] = si.StartupInfo.hStdError;
+    if (pipes) {
+        SIZE_T attrSize = 0;
+        InitializeProcThreadAttributeList(nullptr, 1, 0, &attrSize);
+        attrBuffer.resize(attrSize);
+        auto* attrs = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attrBuffer.data());
+        if (InitializeProcThreadAttributeList(attrs, 1, 0, &attrSize)) {
+            if (UpdateProcThreadAttribute(attrs, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, inherit, inheritCount * sizeof(HANDLE),
+                                          nullptr, nullptr)) {
+                si.lpAttributeList = attrs;
+                si.StartupInfo.cb = sizeof(si);
+            } else {
+                DeleteProcThreadAttributeList(attrs);
+            }
+        }
+    }
+    PROCESS_INFORMATION pi{};
+    const BOOL ok = CreateProcessW(nullptr, cmd.data(), nullptr, nullptr, pipes ? TRUE : FALSE,
+                                   si.lpAttributeList ? EXTENDED_STARTUPINFO_PRESENT : 0, nullptr, nullptr, &si.StartupInfo, &pi);
+    if (si.lpAttributeList) DeleteProcThreadAttributeList(si.lpAttributeList);
+    if (childIn) CloseHandle(childIn);
+    if (childOut) CloseHandle(childOut);
+    if (!ok) return nullptr;
+    CloseHandle(pi.hThread);
+    p->m_process = pi.hProcess;
+#else
+    int in[2] = { -1, -1 }, out[2] = { -1, -1 };
+    if (pipes && (::pipe2(in, O_CLOEXEC) != 0 || ::pipe2(out, O_CLOEXEC) != 0)) {
+        for (int fd : { in[0], in[1], out[0], out[1] })
+            if (fd >= 0) ::close(fd);
+        return nullptr;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (pipes) {
+        // dup2 した先は O_CLOEXEC が外れる。元の記述子は O_CLOEXEC なので子には残らない
+        posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    }
+    std::vector<char*> argv;
+    for (const std::string& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+    pid_t pid = -1;
+    const int err = ::posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (pipes) {
+        ::close(in[0]);
+        ::close(out[1]);
+        p->m_stdin = in[1];
+        p->m_stdout = out[0];
+    }
+    if (err != 0) return nullptr;
+    p->m_pid = pid;
+    // 子が先に終了しても書き込みで落ちないように（EPIPE で失敗として返る）
+    static const bool s_ignorePipe = [] { ::signal(SIGPIPE, SIG_IGN); return true; }();
+    (void)s_ignorePipe;
+#endif
+    return p;
+}
+
+std::filesystem::path ChildProcess::GetExecutablePath() {
+#ifdef _WIN32
+    std::wstring buf(MAX_PATH, L'\0');
+    for (;;) {
+        const DWORD n = GetModuleFileNameW(nullptr, buf.data(), DWORD(buf.size()));
+        if (n == 0) return {};
+        if (n < buf.size()) {
+            buf.resize(n);
+            return buf;
+        }
+        buf.resize(buf.size() * 2);
+    }
+#else
+    std::error_code ec;
+    return std::filesystem::read_symlink("/proc/self/exe", ec);
+#endif
+}
+
+ChildProcess::~ChildProcess() {
+    CloseInput();
+    Wait();
+}
+
+bool ChildProcess::Write(const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+#ifdef _WIN32
+    while (size > 0) {
+        DWORD written = 0;
+        if (!m_stdin || !WriteFile(m_stdin, p, DWORD(std::min<size_t>(size, 1u << 30)), &written, nullptr)) return false;
+        p += written;
+        size -= written;
+    }
+#else
+    while (size > 0) {
+        const ssize_t n = m_stdin < 0 ? -1 : ::write(m_stdin, p, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= size_t(n);
+    }
+#endif
+    return true;
+}
+
+bool ChildProcess::WriteLine(std::string_view line) {
+    std::string s;
+    s.reserve(line.size() + 1);
+    s.append(line);
+    s += '\n';
+    return Write(s.data(), s.size());
+}
+
+bool ChildProcess::ReadLine(std::string& line) {
+    for (;;) {
+        const size_t nl = m_readBuffer.find('\n', m_readPos);
+        if (nl != std::string::npos) {
+            line.assign(m_readBuffer, m_readPos, nl - m_readPos);
+            if (!line.empty() && line.back() == '\r') line.pop_back(); // Windows のテキストモード出力
+            m_readPos = nl + 1;
+            if (m_readPos == m_readBuffer.size()) {
+                m_readBuffer.clear();
+                m_readPos = 0;
+            }
+            return true;
+        }
+        if (!fill_()) return false;
+    }
+}
+
+bool ChildProcess::Read(void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    // ReadLine が先読みした分から使う
+    const size_t buffered = std::min(size, m_readBuffer.size() - m_readPos);
+    std::memcpy(p, m_readBuffer.data() + m_readPos, buffered);
+    m_readPos += buffered;
+    if (m_readPos == m_readBuffer.size()) {
+        m_readBuffer.clear();
+        m_readPos = 0;
+    }
+    p += buffered;
+    size -= buffered;
+    while (size > 0) {
+#ifdef _WIN32
+        DWORD n = 0;
+        if (!m_stdout || !ReadFile(m_stdout, p, DWORD(std::min<size_t>(size, 1u << 30)), &n, nullptr) || n == 0) return false;
+#else
+        const ssize_t n = m_stdout < 0 ? -1 : ::read(m_stdout, p, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+#endif
+        p += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+bool ChildProcess::fill_() {
+    char buf[4096];
+    for (;;) {
+#ifdef _WIN32
+        DWORD n = 0;
+        if (!m_stdout || !ReadFile(m_stdout, buf, sizeof(buf), &n, nullptr) || n == 0) return false;
+#else
+        const ssize_t n = m_stdout < 0 ? -1 : ::read(m_stdout, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+#endif
+        m_readBuffer.append(buf, size_t(n));
+        return true;
+    }
+}
+
+void ChildProcess::CloseInput() {
+#ifdef _WIN32
+    if (m_stdin) CloseHandle(m_stdin);
+    m_stdin = nullptr;
+#else
+    if (m_stdin >= 0) ::close(m_stdin);
+    m_stdin = -1;
+#endif
+}
+
+int ChildProcess::Wait() {
+    if (m_waited) return m_exitCode;
+    m_waited = true;
+#ifdef _WIN32
+    if (m_process) {
+        WaitForSingleObject(m_process, INFINITE);
+        std::lock_guard<std::mutex> lock(m_killMutex);
+        DWORD code = 0;
+        if (GetExitCodeProcess(m_process, &code)) m_exitCode = int(code);
+        CloseHandle(m_process);
+        m_process = nullptr;
+    }
+    if (m_stdout) CloseHandle(m_stdout);
+    m_stdout = nullptr;
+#else
+    if (m_pid > 0) {
+        // 終了を待つだけ待ってから、Kill を止めて回収する（回収した pid は別のプロセスに再利用されうる）
+        siginfo_t info{};
+        while (::waitid(P_PID, id_t(m_pid), &info, WEXITED | WNOWAIT) < 0 && errno == EINTR) {}
+        std::lock_guard<std::mutex> lock(m_killMutex);
+        int status = 0;
+        while (::waitpid(m_pid, &status, 0) < 0 && errno == EINTR) {}
+        m_exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        m_pid = -1;
+    }
+    if (m_stdout >= 0) ::close(m_stdout);
+    m_stdout = -1;
+#endif
+    return m_exitCode;
+}
+
+void ChildProcess::Kill() {
+    std::lock_guard<std::mutex> lock(m_killMutex);
+#ifdef _WIN32
+    if (m_process) TerminateProcess(m_process, 1);
+#else
+    if (m_pid > 0) ::kill(m_pid, SIGKILL);
+#endif
+}
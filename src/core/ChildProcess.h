@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jisaku {
+
+// 子プロセスの起動（ツール用）。pipes なら子の標準入力・標準出力をパイプにつなぎ、行単位でやり取りできる
+// （標準エラーは親と共有）。1 つのインスタンスを複数スレッドから同時に使わないこと（Kill だけは別スレッドから呼んでよい）
+class ChildProcess {
+public:
+    // args[0] は実行ファイル（パス区切りが無ければ PATH から探す）。引数は UTF-8
+    static std::unique_ptr<ChildProcess> Spawn(const std::vector<std::string>& args, bool pipes);
+
+    // 自分自身の実行ファイル（ワーカーとして自分を起動するとき用）
+    static std::filesystem::path GetExecutablePath();
+
+    ~ChildProcess(); // パイプを閉じて終了を待つ
+
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+
+    bool Write(const void* data, size_t size);
+    bool WriteLine(std::string_view line); // 末尾に '\n' を足す
+    // '\n' まで読む（'\n' と直前の '\r' は含めない）。相手が閉じたら false
+    bool ReadLine(std::string& line);
+    // size バイトちょうど読む（ReadLine と混ぜてよい）。相手が閉じたら false
+    bool Read(void* data, size_t size);
+    // 子に EOF を送る
+    void CloseInput();
+    // 終了を待って終了コードを返す（起動に失敗・異常終了なら -1）
+    int Wait();
+    // 強制終了する（タイムアウト用）。ブロック中の Wait は返る
+    // （Read / ReadLine も返るが、子が起動した孫プロセスがパイプを持っていればその終了まで返らない）
+    void Kill();
+
+private:
+    ChildProcess() = default;
+    bool fill_(); // 標準出力から読めた分を m_readBuffer に足す
+
+#ifdef _WIN32
+    void* m_process = nullptr;
+    void* m_stdin = nullptr;
+    void* m_stdout = nullptr;
+#else
+    int m_pid = -1;
+    int m_stdin = -1;
+    int m_stdout = -1;
+#endif
+    int m_exitCode = -1;
+    bool m_waited = false;
+    std::mutex m_killMutex; // Kill と Wait の後始末（プロセスのハンドル / pid の解放）
+    std::string m_readBuffer;
+    size_t m_readPos = 0;
+};
+
+} // namespace jisaku
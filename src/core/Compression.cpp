@@ -0,0 +1,135 @@
+#include "core/Compression.h"
+#include "core/JobSystem.h"
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+using namespace jisaku;
+
+namespace {
+
+struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* ctx) const { ZSTD_freeDCtx(ctx); }
+};
+
+// 展開コンテキストはスレッドごとに使い回す（チャンクごとの確保を避ける）
+ZSTD_DCtx* ThreadDCtx() {
+    thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> s_ctx(ZSTD_createDCtx());
+    return s_ctx.get();
+}
+
+size_t CompressBound(Codec codec, size_t size) {
+    switch (codec) {
+    case Codec::LZ4: return size_t(LZ4_compressBound(int(size)));
+    case Codec::Zstd: return ZSTD_compressBound(size);
+    default: return size;
+    }
+}
+
+// 圧縮後のサイズを返す。失敗時は 0
+size_t CompressOne(Codec codec, int level, const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+    switch (codec) {
+    case Codec::LZ4: {
+        const int n = level > 0
+            ? LZ4_compress_HC(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst), int(size), int(capacity), level)
+            : LZ4_compress_default(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst), int(size), int(capacity));
+        return n > 0 ? size_t(n) : 0;
+    }
+    case Codec::Zstd: {
+        const size_t n = ZSTD_compress(dst, capacity, src, size, level > 0 ? level : ZSTD_CLEVEL_DEFAULT);
+        return ZSTD_isError(n) ? 0 : n;
+    }
+    default:
+        return 0;
+    }
+}
+
+} // namespace
+
+const char* jisaku::CodecName(Codec codec) {
+    switch (codec) {
+    case Codec::LZ4: return "LZ4";
+    case Codec::Zstd: return "Zstd";
+    default: return "None";
+    }
+}
+
+bool jisaku::CompressChunked(const uint8_t* src, size_t size, Codec codec, int level, uint32_t chunkSize, ChunkedData& out) {
+    if (chunkSize < kMinChunkSize || chunkSize > kMaxChunkSize || (chunkSize & (chunkSize - 1)) != 0) return false;
+    out.codec = codec;
+    out.rawSize = size;
+    out.chunkSize = chunkSize;
+    const uint32_t count = ChunkCount(size, chunkSize);
+    out.chunkSizes.assign(count, 0);
+
+    // チャンクごとに最大サイズの枠へ圧縮してから詰める
+    const size_t bound = CompressBound(codec, chunkSize);
+    std::vector<uint8_t> scratch(bound * count);
+    std::atomic<bool> ok{ true };
+    JobSystem::Get().ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t c = begin; c < end; ++c) {
+            const size_t offset = size_t(c) * chunkSize;
+            const size_t raw = std::min<size_t>(chunkSize, size - offset);
+            uint8_t* dst = scratch.data() + bound * c;
+            size_t n = codec == Codec::None ? 0 : CompressOne(codec, level, src + offset, raw, dst, bound);
+            if (codec != Codec::None && n == 0) ok = false;
+            if (n == 0 || n >= raw) {
+                // 縮まないチャンクは生のまま
+                std::memcpy(dst, src + offset, raw);
+                n = raw;
+            }
+            out.chunkSizes[c] = uint32_t(n);
+        }
+    });
+    if (!ok) return false;
+
+    size_t total = 0;
+    for (uint32_t n : out.chunkSizes) total += n;
+    out.data.resize(total);
+    size_t pos = 0;
+    for (uint32_t c = 0; c < count; ++c) {
+        std::memcpy(out.data.data() + pos, scratch.data() + bound * c, out.chunkSizes[c]);
+        pos += out.chunkSizes[c];
+    }
+    return true;
+}
+
+bool jisaku::DecompressChunk(Codec codec, const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    if (srcSize == dstSize || codec == Codec::None) {
+        if (srcSize != dstSize) return false;
+        std::memcpy(dst, src, dstSize);
+        return true;
+    }
+    switch (codec) {
+    case Codec::LZ4:
+        return LZ4_decompress_safe(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst), int(srcSize), int(dstSize)) == int(dstSize);
+    case Codec::Zstd: {
+        const size_t n = ZSTD_decompressDCtx(ThreadDCtx(), dst, dstSize, src, srcSize);
+        return !ZSTD_isError(n) && n == dstSize;
+    }
+    default:
+        return false;
+    }
+}
+
+bool jisaku::DecompressChunked(const ChunkedData& in, uint8_t* dst) {
+    const uint32_t count = ChunkCount(in.rawSize, in.chunkSize);
+    if (in.chunkSizes.size() != count) return false;
+    std::vector<size_t> offsets(count + 1, 0);
+    for (uint32_t c = 0; c < count; ++c) offsets[c + 1] = offsets[c] + in.chunkSizes[c];
+    if (offsets[count] > in.data.size()) return false;
+
+    std::atomic<bool> ok{ true };
+    JobSystem::Get().ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t c = begin; c < end; ++c) {
+            const uint64_t rawOffset = uint64_t(c) * in.chunkSize;
+            const size_t raw = size_t(std::min<uint64_t>(in.chunkSize, in.rawSize - rawOffset));
+            if (!DecompressChunk(in.codec, in.data.data() + offsets[c], in.chunkSizes[c], dst + rawOffset, raw)) ok = false;
+        }
+    });
+    return ok;
+}
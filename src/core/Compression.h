@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jisaku {
+
+// チャンク単位の可逆圧縮（LZ4 / Zstd）。
+// 各チャンクは独立に圧縮するので、読み込み側は届いたチャンクから任意の順・並列に展開できる。
+// 圧縮しても小さくならないチャンクは生のまま格納する（圧縮後サイズ == 元サイズ なら無圧縮）。
+enum class Codec : uint8_t {
+    None,
+    LZ4,  // 展開が速い（数 GB/s）。ホットリロード中のアセット向け
+    Zstd, // 圧縮率重視。出荷データ向け
+};
+
+constexpr uint32_t kMinChunkSize = 64 * 1024;
+constexpr uint32_t kMaxChunkSize = 256 * 1024;
+constexpr uint32_t kDefaultChunkSize = 128 * 1024;
+
+const char* CodecName(Codec codec);
+
+struct ChunkedData {
+    Codec codec = Codec::None;
+    uint64_t rawSize = 0;
+    uint32_t chunkSize = kDefaultChunkSize;
+    std::vector<uint32_t> chunkSizes; // 各チャンクの圧縮後サイズ
+    std::vector<uint8_t> data;        // チャンクを順に連結したもの
+};
+
+inline uint32_t ChunkCount(uint64_t rawSize, uint32_t chunkSize) {
+    return uint32_t((rawSize + chunkSize - 1) / chunkSize);
+}
+
+// chunkSize は 2 の冪で [kMinChunkSize, kMaxChunkSize]。level は 0 で各コーデックの既定
+// （LZ4: 高速モード、1 以上で HC。Zstd: ZSTD_CLEVEL_DEFAULT）。チャンクは JobSystem で並列に圧縮する
+bool CompressChunked(const uint8_t* src, size_t size, Codec codec, int level, uint32_t chunkSize, ChunkedData& out);
+
+// 1 チャンクを展開する。dstSize はそのチャンクの元サイズ（末尾以外は chunkSize）と一致していること
+bool DecompressChunk(Codec codec, const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+// メモリ上の全チャンクを JobSystem で並列に展開する（dst は rawSize バイト）
+bool DecompressChunked(const ChunkedData& in, uint8_t* dst);
+
+} // namespace jisaku
@@ -0,0 +1,172 @@
+#include "core/CookClient.h"
+#include "core/Socket.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+using namespace jisaku;
+
+namespace {
+
+// 読み捨て（知らない種類のフレーム用）
+bool Skip(Socket& socket, uint32_t size) {
+    uint8_t buf[4096];
+    while (size > 0) {
+        const uint32_t n = std::min<uint32_t>(size, sizeof(buf));
+        if (!socket.Receive(buf, n)) return false;
+        size -= n;
+    }
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<CookClient> CookClient::Connect(const std::string& address) {
+    std::unique_ptr<Socket> socket = Socket::Connect(address);
+    if (!socket) return nullptr;
+
+    // バージョンが合わなければ使わない（サーバーだけ古いまま動いていることがある）
+    uint8_t hello[kCookHelloSize];
+    EncodeCookHello(hello);
+    if (!SendCookFrame(*socket, CookMessage::Hello, hello, sizeof(hello))) return nullptr;
+    CookMessage type;
+    uint32_t size = 0;
+    uint8_t reply[kCookHelloSize];
+    uint32_t version = 0;
+    if (!ReceiveCookFrameHeader(*socket, type, size) || type != CookMessage::Hello || size != kCookHelloSize ||
+        !socket->Receive(reply, sizeof(reply)) || !DecodeCookHello(reply, sizeof(reply), version)) {
+        spdlog::error("Cook server at {} did not answer hello", address);
+        return nullptr;
+    }
+    if (version != kCookProtocolVersion) {
+        spdlog::error("Cook server at {} speaks protocol {} (expected {})", address, version, kCookProtocolVersion);
+        return nullptr;
+    }
+
+    std::shared_ptr<CookClient> client(new CookClient());
+    client->m_address = address;
+    client->m_socket = std::move(socket);
+    client->m_connected = true;
+    client->m_thread = std::thread([c = client.get()]() { c->receiveLoop_(); });
+    return client;
+}
+
+CookClient::~CookClient() {
+    m_closing = true;
+    if (m_socket) m_socket->Shutdown();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void CookClient::RequestAsync(const std::string& name, std::function<void(CookResult&&)> onComplete) {
+    if (name.size() > kCookMaxNameSize) {
+        // サーバーは受け取らずに切るので送らない
+        CookResult r;
+        r.error = "name too long";
+        onComplete(std::move(r));
+        return;
+    }
+    uint32_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_connected) {
+            id = m_nextId++;
+            if (id == 0) id = m_nextId++; // 0 は使わない
+            m_pending.emplace(id, std::move(onComplete));
+        }
+    }
+    if (id == 0) {
+        CookResult r;
+        r.error = "not connected";
+        onComplete(std::move(r));
+        return;
+    }
+
+    uint8_t head[kCookGetHeadSize];
+    EncodeCookGetHead(head, id);
+    bool sent;
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        sent = SendCookFrame(*m_socket, CookMessage::Get, head, sizeof(head), name.data(), name.size());
+    }
+    if (sent) return;
+    // 送れなかった。受信スレッドが先に失敗させていなければここで返す
+    std::function<void(CookResult&&)> cb;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_pending.find(id);
+        if (it == m_pending.end()) return;
+        cb = std::move(it->second);
+        m_pending.erase(it);
+    }
+    m_socket->Shutdown(); // 受信側も止める
+    CookResult r;
+    r.error = "send failed";
+    cb(std::move(r));
+}
+
+std::future<CookResult> CookClient::RequestAsync(const std::string& name) {
+    auto promise = std::make_shared<std::promise<CookResult>>();
+    std::future<CookResult> future = promise->get_future();
+    RequestAsync(name, [promise](CookResult&& r) { promise->set_value(std::move(r)); });
+    return future;
+}
+
+std::vector<std::string> CookClient::TakeInvalidations() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_invalidations);
+}
+
+void CookClient::receiveLoop_() {
+    Socket& socket = *m_socket;
+    CookMessage type;
+    uint32_t size = 0;
+    while (ReceiveCookFrameHeader(socket, type, size)) {
+        if (type == CookMessage::Reply) {
+            uint8_t headBytes[kCookReplyHeadSize];
+            if (size < kCookReplyHeadSize || !socket.Receive(headBytes, sizeof(headBytes))) break;
+            const CookReplyHead head = DecodeCookReplyHead(headBytes);
+            CookResult r;
+            r.status = head.status;
+            r.key = head.key;
+            r.data.resize(size - kCookReplyHeadSize);
+            if (!r.data.empty() && !socket.Receive(r.data.data(), r.data.size())) break;
+            if (r.status != CookStatus::Ok) {
+                r.error.assign(r.data.begin(), r.data.end());
+                r.data.clear();
+            }
+            std::function<void(CookResult&&)> cb;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_pending.find(head.id);
+                if (it != m_pending.end()) {
+                    cb = std::move(it->second);
+                    m_pending.erase(it);
+                }
+            }
+            if (cb) cb(std::move(r));
+        } else if (type == CookMessage::Invalidate) {
+            std::string name(size, '\0');
+            if (size > 0 && !socket.Receive(name.data(), name.size())) break;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (std::find(m_invalidations.begin(), m_invalidations.end(), name) == m_invalidations.end())
+                m_invalidations.push_back(std::move(name));
+        } else if (!Skip(socket, size)) {
+            break;
+        }
+    }
+    if (!m_closing) spdlog::warn("Disconnected from cook server {}", m_address);
+    failAll_();
+}
+
+void CookClient::failAll_() {
+    std::unordered_map<uint32_t, std::function<void(CookResult&&)>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_connected = false;
+        pending.swap(m_pending);
+    }
+    for (auto& [id, cb] : pending) {
+        CookResult r;
+        r.error = "disconnected";
+        cb(std::move(r));
+    }
+}
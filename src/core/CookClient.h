@@ -0,0 +1,65 @@
+#pragma once
+#include "core/CookProtocol.h"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace jisaku {
+
+class Socket;
+
+struct CookResult {
+    CookStatus status = CookStatus::Failed;
+    ContentKey key;
+    std::vector<uint8_t> data; // Ok のときのクック済みの中身
+    std::string error;
+};
+
+// クックサーバーへの接続。要求は何本でも同時に投げてよく、返事は受信スレッドが id で振り分ける。
+// 切断されたら待っている要求はすべて Failed で完了し、以降の要求も即 Failed になる
+class CookClient {
+public:
+    // つながらなければ null（サーバーが起動していないだけなので、呼び出し側は黙って他の読み方へ回せばよい）
+    static std::shared_ptr<CookClient> Connect(const std::string& address);
+
+    ~CookClient(); // 接続を切って受信スレッドを止める
+
+    CookClient(const CookClient&) = delete;
+    CookClient& operator=(const CookClient&) = delete;
+
+    // name はサーバーの --root 基準の仮想パス。onComplete は受信スレッドで呼ばれるので軽い処理だけにする
+    void RequestAsync(const std::string& name, std::function<void(CookResult&&)> onComplete);
+    std::future<CookResult> RequestAsync(const std::string& name);
+
+    // サーバーから届いた「読み直すべき出力」の仮想パス（重複は除く）
+    std::vector<std::string> TakeInvalidations();
+
+    bool IsConnected() const { return m_connected.load(std::memory_order_acquire); }
+    const std::string& GetAddress() const { return m_address; }
+
+private:
+    CookClient() = default;
+
+    void receiveLoop_();
+    void failAll_();
+
+    std::string m_address;
+    std::unique_ptr<Socket> m_socket;
+    std::thread m_thread;
+    std::atomic<bool> m_connected{ false };
+    std::atomic<bool> m_closing{ false };
+
+    std::mutex m_sendMutex;
+    std::mutex m_mutex;
+    uint32_t m_nextId = 1;
+    std::unordered_map<uint32_t, std::function<void(CookResult&&)>> m_pending;
+    std::vector<std::string> m_invalidations;
+};
+
+} // namespace jisaku
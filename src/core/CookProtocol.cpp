@@ -0,0 +1,99 @@
+#include "core/CookProtocol.h"
+#include "core/ByteOrder.h"
+#include "core/Socket.h"
+#include <cstring>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// これより小さい body はヘッダと 1 回の送信にまとめる（TCP_NODELAY なので分けると小さいパケットが 2 つ出る）
+constexpr size_t kCoalesceLimit = 16 * 1024;
+
+} // namespace
+
+uint32_t jisaku::CookMaxPayload(CookMessage type) {
+    // 壊れた・悪意のあるヘッダで巨大な確保をしないように、種類ごとに中身の大きさで抑える
+    switch (type) {
+    case CookMessage::Hello: return uint32_t(kCookHelloSize);
+    case CookMessage::Reply: return uint32_t(kCookReplyHeadSize + kCookMaxReplyBody);
+    case CookMessage::Invalidate: return uint32_t(kCookMaxNameSize);
+    default: return uint32_t(kCookGetHeadSize + kCookMaxNameSize);
+    }
+}
+
+bool jisaku::SendCookFrame(Socket& socket, CookMessage type, const void* head, size_t headSize,
+                           const void* body, size_t bodySize) {
+    const uint64_t payload = uint64_t(headSize) + bodySize;
+    if (payload > CookMaxPayload(type)) return false;
+    uint8_t header[kCookFrameHeaderSize] = {};
+    WriteU32(header, uint32_t(payload));
+    header[4] = uint8_t(type);
+    if (payload <= kCoalesceLimit) {
+        uint8_t buf[kCookFrameHeaderSize + kCoalesceLimit];
+        std::memcpy(buf, header, sizeof(header));
+        if (headSize) std::memcpy(buf + sizeof(header), head, headSize);
+        if (bodySize) std::memcpy(buf + sizeof(header) + headSize, body, bodySize);
+        return socket.Send(buf, sizeof(header) + size_t(payload));
+    }
+    std::vector<uint8_t> first(sizeof(header) + headSize);
+    std::memcpy(first.data(), header, sizeof(header));
+    if (headSize) std::memcpy(first.data() + sizeof(header), head, headSize);
+    return socket.Send(first.data(), first.size()) && socket.Send(body, bodySize);
+}
+
+bool jisaku::ReceiveCookFrameHeader(Socket& socket, CookMessage& type, uint32_t& size) {
+    uint8_t header[kCookFrameHeaderSize];
+    if (!socket.Receive(header, sizeof(header))) return false;
+    size = ReadU32(header);
+    type = CookMessage(header[4]);
+    return size <= CookMaxPayload(type);
+}
+
+void jisaku::EncodeCookHello(uint8_t (&out)[kCookHelloSize]) {
+    WriteU32(out, kCookProtocolVersion);
+    WriteU32(out + 4, 0);
+}
+
+bool jisaku::DecodeCookHello(const uint8_t* data, size_t size, uint32_t& version) {
+    if (size < kCookHelloSize) return false;
+    version = ReadU32(data);
+    return true;
+}
+
+void jisaku::EncodeCookGetHead(uint8_t (&out)[kCookGetHeadSize], uint32_t id) {
+    WriteU32(out, id);
+}
+
+bool jisaku::DecodeCookGet(const uint8_t* data, size_t size, uint32_t& id, std::string& name) {
+    if (size < kCookGetHeadSize) return false;
+    id = ReadU32(data);
+    name.assign(reinterpret_cast<const char*>(data) + kCookGetHeadSize, size - kCookGetHeadSize);
+    return true;
+}
+
+void jisaku::EncodeCookReplyHead(uint8_t (&out)[kCookReplyHeadSize], const CookReplyHead& head) {
+    std::memset(out, 0, sizeof(out));
+    WriteU32(out, head.id);
+    out[4] = uint8_t(head.status);
+    WriteU64(out + 8, head.key.hi);
+    WriteU64(out + 16, head.key.lo);
+}
+
+CookReplyHead jisaku::DecodeCookReplyHead(const uint8_t (&data)[kCookReplyHeadSize]) {
+    CookReplyHead head;
+    head.id = ReadU32(data);
+    head.status = data[4] <= uint8_t(CookStatus::Failed) ? CookStatus(data[4]) : CookStatus::Failed;
+    head.key.hi = ReadU64(data + 8);
+    head.key.lo = ReadU64(data + 16);
+    return head;
+}
+
+const char* jisaku::CookStatusName(CookStatus status) {
+    switch (status) {
+    case CookStatus::Ok: return "ok";
+    case CookStatus::NotFound: return "not found";
+    default: return "failed";
+    }
+}
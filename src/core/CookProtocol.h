@@ -0,0 +1,72 @@
+#pragma once
+#include "core/AssetManifest.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace jisaku {
+
+class Socket;
+
+// クックサーバー（JisakuCookServer）とエンジンの間のやり取り（リトルエンディアン）
+//   フレーム   : payloadSize(u32), type(u8), 予約(3 byte), payload
+//   Hello      : version(u32), 予約(u32)。接続直後に双方が送る
+//   Get        : id(u32), name（仮想パス。残り全部）
+//   Reply      : id(u32), status(u8), 予約(3 byte), key(16 byte), status が Ok なら中身・それ以外はエラー文
+//   Invalidate : name。サーバーから一方的に送る（元ファイルが変わったので読み直すべき出力）
+// Reply は Get の順に返るとは限らない（id で対応させる）
+constexpr uint32_t kCookProtocolVersion = 1;
+
+// JisakuCookServer の既定の待ち受けアドレス（Socket の表記）
+#ifdef _WIN32
+constexpr const char* kDefaultCookAddress = "tcp:127.0.0.1:47800";
+#else
+constexpr const char* kDefaultCookAddress = "unix:/tmp/jisaku-cook.sock";
+#endif
+
+constexpr size_t kCookFrameHeaderSize = 8;
+constexpr size_t kCookHelloSize = 8;
+constexpr size_t kCookGetHeadSize = 4;
+constexpr size_t kCookReplyHeadSize = 24;
+// フレームの種類ごとの payload の上限（受け取る側はこれを超えるヘッダを見たら読まずに切る）
+constexpr size_t kCookMaxNameSize = 4096;           // Get / Invalidate の仮想パス
+constexpr size_t kCookMaxReplyBody = size_t(1) << 30; // Reply の中身（クック済みのアセット）
+
+enum class CookMessage : uint8_t {
+    Hello = 1,
+    Get = 2,
+    Reply = 3,
+    Invalidate = 4,
+};
+
+enum class CookStatus : uint8_t {
+    Ok = 0,
+    NotFound = 1, // クック対象でない・元ファイルが無い（クライアントは他の読み方へ回す）
+    Failed = 2,   // クックに失敗した
+};
+
+struct CookReplyHead {
+    uint32_t id = 0;
+    CookStatus status = CookStatus::Failed;
+    ContentKey key; // 出力のキー（Ok のとき）
+};
+
+// head と body を続けて 1 フレームとして送る。同じソケットに複数スレッドから送るときは呼び出し側で排他すること
+bool SendCookFrame(Socket& socket, CookMessage type, const void* head, size_t headSize,
+                   const void* body = nullptr, size_t bodySize = 0);
+// type のフレームの payload の上限。知らない種類は Get と同じ
+uint32_t CookMaxPayload(CookMessage type);
+// フレームヘッダだけ読む。続く size バイトは呼び出し側が Receive する。size が CookMaxPayload(type) を超えれば false
+bool ReceiveCookFrameHeader(Socket& socket, CookMessage& type, uint32_t& size);
+
+void EncodeCookHello(uint8_t (&out)[kCookHelloSize]);
+bool DecodeCookHello(const uint8_t* data, size_t size, uint32_t& version);
+void EncodeCookGetHead(uint8_t (&out)[kCookGetHeadSize], uint32_t id);
+bool DecodeCookGet(const uint8_t* data, size_t size, uint32_t& id, std::string& name);
+void EncodeCookReplyHead(uint8_t (&out)[kCookReplyHeadSize], const CookReplyHead& head);
+CookReplyHead DecodeCookReplyHead(const uint8_t (&data)[kCookReplyHeadSize]);
+
+const char* CookStatusName(CookStatus status);
+
+} // namespace jisaku
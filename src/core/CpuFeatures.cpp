@@ -0,0 +1,65 @@
+#include "core/CpuFeatures.h"
+
+#if JISAKU_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+using namespace jisaku;
+
+#if JISAKU_X86
+static void cpuid_(int leaf, int sub, unsigned regs[4]) {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, leaf, sub);
+    for (int i = 0; i < 4; ++i) regs[i] = (unsigned)r[i];
+#else
+    __cpuid_count(leaf, sub, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static unsigned long long xgetbv0_() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+
+static CpuFeatures detect_() {
+    CpuFeatures f;
+    unsigned r[4]{};
+    cpuid_(0, 0, r);
+    const unsigned maxLeaf = r[0];
+    if (maxLeaf < 1) return f;
+
+    cpuid_(1, 0, r);
+    f.sse41 = (r[2] & (1u << 19)) != 0;
+    const bool fma     = (r[2] & (1u << 12)) != 0;
+    const bool osxsave = (r[2] & (1u << 27)) != 0;
+    const bool avx     = (r[2] & (1u << 28)) != 0;
+    const bool f16c    = (r[2] & (1u << 29)) != 0;
+    // AVX 系は OS が YMM レジスタを保存していることも確認する
+    const bool ymmOk = osxsave && ((xgetbv0_() & 0x6) == 0x6);
+    f.f16c = avx && f16c && ymmOk;
+
+    if (maxLeaf >= 7) {
+        cpuid_(7, 0, r);
+        // JISAKU_TARGET_AVX2 のカーネルは FMA も使うので、AVX2 だけ見せて FMA を持たない CPU / VM は外す
+        f.avx2 = ymmOk && avx && fma && (r[1] & (1u << 5)) != 0;
+    }
+    return f;
+}
+#else
+static CpuFeatures detect_() { return {}; }
+#endif
+
+const CpuFeatures& jisaku::GetCpuFeatures() {
+    static const CpuFeatures s_features = detect_();
+    return s_features;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// x86 SIMD 拡張の実行時判定。
+// SIMD カーネルは関数単位でターゲット指定してビルドし、呼び出し側で GetCpuFeatures() を見て振り分ける。
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define JISAKU_X86 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+// MSVC はアーキテクチャ指定なしで全 intrinsic を使える
+#define JISAKU_TARGET_SSE41
+#define JISAKU_TARGET_AVX2
+#define JISAKU_TARGET_F16C
+#else
+#define JISAKU_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define JISAKU_TARGET_AVX2  __attribute__((target("avx2,fma")))
+#define JISAKU_TARGET_F16C  __attribute__((target("avx,f16c")))
+#endif
+
+namespace jisaku {
+
+struct CpuFeatures {
+    bool sse41 = false;
+    bool avx2  = false; // AVX2 と FMA の両方
+    bool f16c  = false;
+};
+
+const CpuFeatures& GetCpuFeatures();
+
+} // namespace jisaku
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace jisaku {
+
+// GPU がまだ使っているかもしれないものを、フェンス値を付けて預かり、GPU がその値を過ぎてから手放す（D3D 非依存）。
+// - Retire(fence, obj) は obj（ComPtr・リソースの配列など）を持っておき、解放のときに破棄する
+// - Defer(fence, fn) は解放のときに fn を呼ぶ（ディスクリプタのスロットやヒープの範囲を返すとき）
+// - Collect(completedFence) で、その値までのものを預けた順にまとめて手放す
+// fence には「ここまでに積んだコマンドの完了時に Signal される値」（DX12Device::GetNextFenceValue）を渡す。
+// 任意のスレッドから呼んでよい。解放はロックの外で行うので、fn の中から Retire / Defer してもよい
+class DeferredReleaseQueue {
+public:
+    DeferredReleaseQueue() = default;
+    ~DeferredReleaseQueue() { ReleaseAll(); } // 破棄時点で GPU は止まっている前提
+
+    DeferredReleaseQueue(const DeferredReleaseQueue&) = delete;
+    DeferredReleaseQueue& operator=(const DeferredReleaseQueue&) = delete;
+
+    template <class T>
+    void Retire(uint64_t fence, T object) {
+        push_(fence, std::make_unique<Object_<T>>(std::move(object)));
+    }
+    template <class F>
+    void Defer(uint64_t fence, F release) {
+        push_(fence, std::make_unique<Call_<F>>(std::move(release)));
+    }
+
+    // completedFence 以下のフェンス値で預かったものを手放す。戻り値は手放した数
+    size_t Collect(uint64_t completedFence) {
+        std::vector<Entry_> released;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto end = m_batches.upper_bound(completedFence);
+            for (auto it = m_batches.begin(); it != end; ++it) {
+                for (Entry_& e : it->second) released.push_back(std::move(e));
+            }
+            m_batches.erase(m_batches.begin(), end);
+            m_size -= released.size();
+            m_released += released.size();
+        }
+        return released.size(); // ここで破棄する
+    }
+    // フェンスを見ずにすべて手放す（WaitIdle の後、終了時）
+    size_t ReleaseAll() { return Collect(UINT64_MAX); }
+
+    // 預かっている数
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_size;
+    }
+    // これまでに手放した数
+    uint64_t GetReleasedCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_released;
+    }
+
+private:
+    struct Holder_ {
+        virtual ~Holder_() = default;
+    };
+    template <class T>
+    struct Object_ : Holder_ {
+        explicit Object_(T o) : object(std::move(o)) {}
+        T object;
+    };
+    template <class F>
+    struct Call_ : Holder_ {
+        explicit Call_(F f) : release(std::move(f)) {}
+        ~Call_() override { release(); }
+        F release;
+    };
+    using Entry_ = std::unique_ptr<Holder_>;
+
+    void push_(uint64_t fence, Entry_ entry) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_batches[fence].push_back(std::move(entry)); // 同じフェンス値のものは 1 つのまとまりにする
+        ++m_size;
+    }
+
+    mutable std::mutex m_mutex;
+    std::map<uint64_t, std::vector<Entry_>> m_batches; // フェンス値の小さい順
+    size_t m_size = 0;
+    uint64_t m_released = 0;
+};
+
+} // namespace jisaku
@@ -0,0 +1,63 @@
+#include "core/DependencyGraph.h"
+#include <algorithm>
+
+using namespace jisaku;
+
+DependencyGraph::Update DependencyGraph::Set(uint64_t node, const std::vector<std::string>& files) {
+    Update update = Remove(node);
+    std::vector<std::string>& deps = m_nodes[node];
+    for (const std::string& file : files) {
+        if (std::find(deps.begin(), deps.end(), file) != deps.end()) continue;
+        deps.push_back(file);
+        std::unordered_set<uint64_t>& users = m_files[file];
+        if (users.empty()) {
+            // Remove で外したばかりなら、監視はそのまま続ければよい
+            auto it = std::find(update.removed.begin(), update.removed.end(), file);
+            if (it != update.removed.end()) update.removed.erase(it);
+            else update.added.push_back(file);
+        }
+        users.insert(node);
+    }
+    return update;
+}
+
+DependencyGraph::Update DependencyGraph::Remove(uint64_t node) {
+    Update update;
+    auto it = m_nodes.find(node);
+    if (it == m_nodes.end()) return update;
+    for (const std::string& file : it->second) {
+        auto users = m_files.find(file);
+        if (users == m_files.end()) continue;
+        users->second.erase(node);
+        if (users->second.empty()) {
+            m_files.erase(users);
+            update.removed.push_back(file);
+        }
+    }
+    m_nodes.erase(it);
+    return update;
+}
+
+std::vector<uint64_t> DependencyGraph::GetDependents(const std::string& file) const {
+    std::vector<uint64_t> nodes;
+    auto it = m_files.find(file);
+    if (it != m_files.end()) nodes.assign(it->second.begin(), it->second.end());
+    std::sort(nodes.begin(), nodes.end());
+    return nodes;
+}
+
+std::vector<uint64_t> DependencyGraph::GetDependents(const std::vector<std::string>& files) const {
+    std::vector<uint64_t> nodes;
+    for (const std::string& file : files) {
+        auto it = m_files.find(file);
+        if (it != m_files.end()) nodes.insert(nodes.end(), it->second.begin(), it->second.end());
+    }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    return nodes;
+}
+
+const std::vector<std::string>* DependencyGraph::GetDependencies(uint64_t node) const {
+    auto it = m_nodes.find(node);
+    return it == m_nodes.end() ? nullptr : &it->second;
+}
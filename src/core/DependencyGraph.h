@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace jisaku {
+
+// 出力（シェーダー等）ごとの「作るときに読んだファイル」と、その逆引き（ファイル → 出力）。
+// ファイルが変わったら GetDependents の出力だけを作り直せばよい。
+// 作り直すたびに Set で依存を置き換える（#include の追加・削除に追従する）。
+// スレッドセーフではない
+class DependencyGraph {
+public:
+    // 監視を始める／やめるべきファイル（どのノードからも参照されていなかった／されなくなった）
+    struct Update {
+        std::vector<std::string> added;
+        std::vector<std::string> removed;
+    };
+
+    // node の依存を files に置き換える（重複は無視）
+    Update Set(uint64_t node, const std::vector<std::string>& files);
+    Update Remove(uint64_t node);
+
+    // file を読んでいるノード（昇順）
+    std::vector<uint64_t> GetDependents(const std::string& file) const;
+    // まとめて変わったとき（重複なし、昇順）
+    std::vector<uint64_t> GetDependents(const std::vector<std::string>& files) const;
+    // node が読んだファイル（Set した順）。知らない node なら null
+    const std::vector<std::string>* GetDependencies(uint64_t node) const;
+
+    size_t GetNodeCount() const { return m_nodes.size(); }
+    size_t GetFileCount() const { return m_files.size(); }
+
+private:
+    std::unordered_map<uint64_t, std::vector<std::string>> m_nodes;
+    std::unordered_map<std::string, std::unordered_set<uint64_t>> m_files;
+};
+
+} // namespace jisaku
@@ -0,0 +1,59 @@
+#include "core/EntityStore.h"
+#include <xxhash.h>
+
+using namespace jisaku;
+
+uint64_t jisaku::AssetPathHash(std::string_view virtualPath) {
+    return XXH3_64bits(virtualPath.data(), virtualPath.size());
+}
+
+void EntityStore::Clear() {
+    m_position.clear();
+    m_rotation.clear();
+    m_scale.clear();
+    m_texture.clear();
+    m_parent.clear();
+    m_textures.clear();
+    m_textureIndex.clear();
+}
+
+void EntityStore::Reserve(size_t count) {
+    m_position.reserve(count);
+    m_rotation.reserve(count);
+    m_scale.reserve(count);
+    m_texture.reserve(count);
+    m_parent.reserve(count);
+}
+
+uint32_t EntityStore::Create(const Float3& position, const Quat& rotation, const Float3& scale, uint32_t texture, uint32_t parent) {
+    return Append(1, &position, &rotation, &scale, &texture, &parent, 0, nullptr);
+}
+
+uint32_t EntityStore::Append(size_t count, const Float3* position, const Quat* rotation, const Float3* scale,
+                             const uint32_t* texture, const uint32_t* parent, uint32_t parentBase, const uint32_t* textureRemap) {
+    const uint32_t first = uint32_t(m_position.size());
+    m_position.insert(m_position.end(), position, position + count);
+    m_rotation.insert(m_rotation.end(), rotation, rotation + count);
+    m_scale.insert(m_scale.end(), scale, scale + count);
+    m_texture.insert(m_texture.end(), texture, texture + count);
+    m_parent.insert(m_parent.end(), parent, parent + count);
+
+    // 参照の付け替えは追加した範囲だけ
+    if (textureRemap) {
+        uint32_t* t = m_texture.data() + first;
+        for (size_t i = 0; i < count; ++i)
+            if (t[i] != kNoTexture) t[i] = textureRemap[t[i]];
+    }
+    if (parentBase != 0) {
+        uint32_t* p = m_parent.data() + first;
+        for (size_t i = 0; i < count; ++i)
+            if (p[i] != kNoEntity) p[i] += parentBase;
+    }
+    return first;
+}
+
+uint32_t EntityStore::AddTexture(uint64_t assetHash, std::string_view path) {
+    auto [it, inserted] = m_textureIndex.emplace(assetHash, uint32_t(m_textures.size()));
+    if (inserted) m_textures.push_back(TextureRef{ assetHash, std::string(path) });
+    return it->second;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace jisaku {
+
+struct Float3 {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+struct Quat {
+    float x = 0.0f, y = 0.0f, z = 0.0f, w = 1.0f;
+};
+
+constexpr uint32_t kNoEntity = UINT32_MAX;
+constexpr uint32_t kNoTexture = UINT32_MAX;
+
+// テクスチャはアセットハッシュで参照する（パスはログ・読み込み用）
+struct TextureRef {
+    uint64_t assetHash = 0;
+    std::string path; // 仮想パス（UTF-8）
+};
+
+// 正規化した仮想パス（'/' 区切り、UTF-8）の xxHash3。シーン等からアセットを参照するときのキー
+uint64_t AssetPathHash(std::string_view virtualPath);
+
+// エンティティの SoA ストレージ。エンティティは添字（0..Size()-1）で表す。
+// 成分ごとに連続した配列なので、シーンの読み込みはブロック単位の memcpy で済む
+class EntityStore {
+public:
+    void Clear();
+    void Reserve(size_t count);
+
+    uint32_t Create(const Float3& position = {}, const Quat& rotation = {}, const Float3& scale = { 1.0f, 1.0f, 1.0f },
+                    uint32_t texture = kNoTexture, uint32_t parent = kNoEntity);
+
+    // count 個をまとめて末尾に追加し、先頭の添字を返す。
+    // parent には parentBase を足し（kNoEntity はそのまま）、texture は textureRemap[texture] に置き換える（null ならそのまま）
+    uint32_t Append(size_t count, const Float3* position, const Quat* rotation, const Float3* scale,
+                    const uint32_t* texture, const uint32_t* parent, uint32_t parentBase, const uint32_t* textureRemap);
+
+    // 同じハッシュは同じ添字を返す
+    uint32_t AddTexture(uint64_t assetHash, std::string_view path);
+    const std::vector<TextureRef>& GetTextures() const { return m_textures; }
+
+    size_t Size() const { return m_position.size(); }
+
+    Float3* Positions() { return m_position.data(); }
+    Quat* Rotations() { return m_rotation.data(); }
+    Float3* Scales() { return m_scale.data(); }
+    uint32_t* Textures() { return m_texture.data(); }
+    uint32_t* Parents() { return m_parent.data(); }
+    const Float3* Positions() const { return m_position.data(); }
+    const Quat* Rotations() const { return m_rotation.data(); }
+    const Float3* Scales() const { return m_scale.data(); }
+    const uint32_t* Textures() const { return m_texture.data(); }
+    const uint32_t* Parents() const { return m_parent.data(); }
+
+private:
+    std::vector<Float3> m_position;
+    std::vector<Quat> m_rotation;
+    std::vector<Float3> m_scale;
+    std::vector<uint32_t> m_texture; // m_textures の添字
+    std::vector<uint32_t> m_parent;
+    std::vector<TextureRef> m_textures;
+    std::unordered_map<uint64_t, uint32_t> m_textureIndex;
+};
+
+} // namespace jisaku
@@ -0,0 +1,361 @@
+#include "core/FileWatcher.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace jisaku;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string ToKey(const std::filesystem::path& path) {
+#ifdef _WIN32
+    // NTFS は大文字小文字を区別しないので、通知の名前と Watch の名前を揃える
+    std::wstring w = path.wstring();
+    if (!w.empty()) CharLowerBuffW(w.data(), DWORD(w.size()));
+    const std::u8string u8 = std::filesystem::path(w).u8string();
+#else
+    const std::u8string u8 = path.u8string();
+#endif
+    return std::string(u8.begin(), u8.end());
+}
+
+} // namespace
+
+#ifdef _WIN32
+
+// ディレクトリ 1 つ分の ReadDirectoryChangesW。完了は IOCP で監視スレッドに届く
+struct DirWatch {
+    OVERLAPPED overlapped{};
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    std::string key;
+    bool closing = false; // 取り消し済み。完了が届いたら解放する
+    alignas(DWORD) uint8_t buffer[32 * 1024];
+};
+
+struct FileWatcher::Backend_ {
+    HANDLE iocp = nullptr;
+    size_t closing = 0;
+
+    bool Issue(DirWatch* w) {
+        constexpr DWORD kFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+                                  FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_CREATION;
+        w->overlapped = OVERLAPPED{};
+        return ReadDirectoryChangesW(w->handle, w->buffer, DWORD(sizeof(w->buffer)), FALSE, kFilter, nullptr,
+                                     &w->overlapped, nullptr) != FALSE;
+    }
+};
+
+#else
+
+struct FileWatcher::Backend_ {
+    int fd = -1;
+    int wakeFd = -1;
+    std::unordered_map<int, std::string> wds; // wd → m_dirs のキー
+};
+
+#endif
+
+FileWatcher::FileWatcher(const Config& config)
+    : m_config(config), m_backend(std::make_unique<Backend_>()), m_queue(config.queueCapacity) {
+#ifdef _WIN32
+    m_backend->iocp = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    m_available = m_backend->iocp != nullptr;
+#else
+    m_backend->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_backend->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_available = m_backend->fd >= 0 && m_backend->wakeFd >= 0;
+#endif
+    if (!m_available) {
+        spdlog::warn("FileWatcher: OS change notification is not available, falling back to polling");
+        return;
+    }
+    m_thread = std::thread([this]() { threadLoop_(); });
+}
+
+FileWatcher::~FileWatcher() {
+    if (m_thread.joinable()) {
+        m_quit = true;
+        wake_();
+        m_thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& [key, dir] : m_dirs) removeDir_(dir);
+        m_dirs.clear();
+        m_targets.clear();
+    }
+#ifdef _WIN32
+    if (m_backend->iocp) {
+        // 取り消した読み込みの完了を受け取ってからバッファを解放する
+        while (m_backend->closing > 0) {
+            DWORD bytes = 0;
+            ULONG_PTR key = 0;
+            OVERLAPPED* ov = nullptr;
+            const BOOL ok = GetQueuedCompletionStatus(m_backend->iocp, &bytes, &key, &ov, 1000);
+            if (!ov) {
+                if (!ok) break; // タイムアウト
+                continue;       // 残っていた wake_
+            }
+            delete reinterpret_cast<DirWatch*>(key);
+            --m_backend->closing;
+        }
+        CloseHandle(m_backend->iocp);
+    }
+#else
+    if (m_backend->fd >= 0) close(m_backend->fd);
+    if (m_backend->wakeFd >= 0) close(m_backend->wakeFd);
+#endif
+}
+
+bool FileWatcher::Watch(uint64_t id, const std::filesystem::path& file) {
+    if (!m_available) return false;
+    Unwatch(id);
+    std::error_code ec;
+    const std::filesystem::path full = std::filesystem::absolute(file, ec).lexically_normal();
+    if (ec || !full.has_filename()) return false;
+    Target_ target{ ToKey(full.parent_path()), ToKey(full.filename()) };
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_dirs.find(target.dir);
+    if (it == m_dirs.end()) {
+        Dir_ dir;
+        dir.path = full.parent_path();
+        it = m_dirs.emplace(target.dir, std::move(dir)).first;
+        if (!addDir_(it->second)) {
+            m_dirs.erase(it);
+            return false;
+        }
+    }
+    it->second.files[target.name].push_back(id);
+    m_targets.emplace(id, std::move(target));
+    return true;
+}
+
+void FileWatcher::Unwatch(uint64_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto t = m_targets.find(id);
+    if (t == m_targets.end()) return;
+    auto d = m_dirs.find(t->second.dir);
+    if (d != m_dirs.end()) {
+        auto f = d->second.files.find(t->second.name);
+        if (f != d->second.files.end()) {
+            f->second.erase(std::remove(f->second.begin(), f->second.end(), id), f->second.end());
+            if (f->second.empty()) d->second.files.erase(f);
+        }
+        if (d->second.files.empty()) {
+            removeDir_(d->second);
+            m_dirs.erase(d);
+        }
+    }
+    m_targets.erase(t);
+}
+
+size_t FileWatcher::Poll(std::vector<uint64_t>& changed) {
+    const size_t before = changed.size();
+    uint64_t id;
+    while (m_queue.TryPop(id)) changed.push_back(id);
+    if (m_overflow.exchange(false)) {
+        // 取りこぼした通知があるので、全部変わったことにする（呼び出し側が更新時刻で確かめる）
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [target, t] : m_targets) changed.push_back(target);
+    }
+    return changed.size() - before;
+}
+
+size_t FileWatcher::GetWatchCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_targets.size();
+}
+
+size_t FileWatcher::GetDirectoryCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dirs.size();
+}
+
+void FileWatcher::threadLoop_() {
+    // ファイル（dir + '\0' + name）ごとの「これ以降に通知が来なければ知らせる」時刻
+    std::unordered_map<std::string, Clock::time_point> pending;
+    std::vector<Event_> events;
+    const auto debounce = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_config.debounce));
+    while (!m_quit) {
+        int timeoutMs = -1;
+        if (!pending.empty()) {
+            Clock::time_point next = Clock::time_point::max();
+            for (const auto& [key, due] : pending) next = std::min(next, due);
+            const auto wait = std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now()).count();
+            timeoutMs = int(std::max<int64_t>(wait, 0));
+        }
+        events.clear();
+        readEvents_(timeoutMs, events);
+
+        const Clock::time_point now = Clock::now();
+        for (const Event_& e : events) {
+            std::string key = e.dir;
+            key += '\0';
+            key += e.name;
+            pending[std::move(key)] = now + debounce;
+        }
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (it->second > now) {
+                ++it;
+                continue;
+            }
+            const size_t split = it->first.find('\0');
+            deliver_(it->first.substr(0, split), it->first.substr(split + 1));
+            it = pending.erase(it);
+        }
+    }
+}
+
+void FileWatcher::deliver_(const std::string& dir, const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto d = m_dirs.find(dir);
+    if (d == m_dirs.end()) return;
+    auto f = d->second.files.find(name);
+    if (f == d->second.files.end()) return;
+    for (uint64_t id : f->second) {
+        if (!m_queue.TryPush(id)) m_overflow = true;
+    }
+}
+
+#ifdef _WIN32
+
+bool FileWatcher::addDir_(Dir_& dir) {
+    auto w = std::make_unique<DirWatch>();
+    w->key = ToKey(dir.path);
+    w->handle = CreateFileW(dir.path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (w->handle == INVALID_HANDLE_VALUE) return false;
+    if (!CreateIoCompletionPort(w->handle, m_backend->iocp, reinterpret_cast<ULONG_PTR>(w.get()), 0) ||
+        !m_backend->Issue(w.get())) {
+        CloseHandle(w->handle);
+        return false;
+    }
+    dir.native = reinterpret_cast<intptr_t>(w.release());
+    return true;
+}
+
+void FileWatcher::removeDir_(Dir_& dir) {
+    if (dir.native == -1) return;
+    DirWatch* w = reinterpret_cast<DirWatch*>(dir.native);
+    dir.native = -1;
+    // 読み込み中のバッファは完了（取り消し）が届くまで解放できない
+    w->closing = true;
+    ++m_backend->closing;
+    CancelIoEx(w->handle, &w->overlapped);
+    CloseHandle(w->handle);
+}
+
+void FileWatcher::wake_() {
+    PostQueuedCompletionStatus(m_backend->iocp, 0, 0, nullptr);
+}
+
+void FileWatcher::readEvents_(int timeoutMs, std::vector<Event_>& out) {
+    DWORD bytes = 0;
+    ULONG_PTR key = 0;
+    OVERLAPPED* ov = nullptr;
+    const BOOL ok = GetQueuedCompletionStatus(m_backend->iocp, &bytes, &key, &ov,
+                                              timeoutMs < 0 ? INFINITE : DWORD(timeoutMs));
+    if (!ov) return; // タイムアウトか wake_
+    DirWatch* w = reinterpret_cast<DirWatch*>(key);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (w->closing) {
+        delete w;
+        --m_backend->closing;
+        return;
+    }
+    if (ok && bytes == 0) {
+        m_overflow = true; // 通知がバッファに収まらなかった
+    } else if (ok) {
+        auto d = m_dirs.find(w->key);
+        const uint8_t* p = w->buffer;
+        for (;;) {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p);
+            const std::string name = ToKey(std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+            if (d != m_dirs.end() && d->second.files.count(name)) out.push_back(Event_{ w->key, name });
+            if (info->NextEntryOffset == 0) break;
+            p += info->NextEntryOffset;
+        }
+    }
+    if (!m_backend->Issue(w)) {
+        spdlog::warn("FileWatcher: ReadDirectoryChangesW failed for {} ({})", w->key, GetLastError());
+        m_overflow = true;
+    }
+}
+
+#else
+
+bool FileWatcher::addDir_(Dir_& dir) {
+    constexpr uint32_t kMask = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM;
+    const int wd = inotify_add_watch(m_backend->fd, dir.path.c_str(), kMask);
+    if (wd < 0) {
+        if (errno == ENOSPC)
+            spdlog::warn("FileWatcher: inotify watch limit reached (fs.inotify.max_user_watches) at {}", dir.path.string());
+        return false;
+    }
+    dir.native = wd;
+    m_backend->wds[wd] = ToKey(dir.path);
+    return true;
+}
+
+void FileWatcher::removeDir_(Dir_& dir) {
+    if (dir.native == -1) return;
+    inotify_rm_watch(m_backend->fd, int(dir.native));
+    m_backend->wds.erase(int(dir.native));
+    dir.native = -1;
+}
+
+void FileWatcher::wake_() {
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t n = write(m_backend->wakeFd, &one, sizeof(one));
+}
+
+void FileWatcher::readEvents_(int timeoutMs, std::vector<Event_>& out) {
+    pollfd fds[2] = { { m_backend->fd, POLLIN, 0 }, { m_backend->wakeFd, POLLIN, 0 } };
+    if (poll(fds, 2, timeoutMs) <= 0) return;
+    if (fds[1].revents & POLLIN) {
+        uint64_t count;
+        [[maybe_unused]] const ssize_t n = read(m_backend->wakeFd, &count, sizeof(count));
+    }
+    if (!(fds[0].revents & POLLIN)) return;
+
+    alignas(inotify_event) char buf[16 * 1024];
+    for (;;) {
+        const ssize_t n = read(m_backend->fd, buf, sizeof(buf));
+        if (n <= 0) break;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const char* p = buf; p < buf + n;) {
+            const auto* ev = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW) {
+                m_overflow = true;
+                continue;
+            }
+            if (ev->len == 0) continue; // ディレクトリ自体への通知
+            auto wd = m_backend->wds.find(ev->wd);
+            if (wd == m_backend->wds.end()) continue;
+            auto d = m_dirs.find(wd->second);
+            const std::string name(ev->name);
+            if (d != m_dirs.end() && d->second.files.count(name)) out.push_back(Event_{ wd->second, name });
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+#include "core/SpscQueue.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace jisaku {
+
+// ファイルの変更を OS の通知で受け取る（Linux: inotify、Windows: ReadDirectoryChangesW）。
+// - 監視はファイルの親ディレクトリ単位で張り、Watch したファイル名への変更だけを拾う
+//   （エディタの「一時ファイルに書いて rename」も、置き換え先の名前で届く）
+// - 監視スレッドが通知を受け、同じファイルへの通知が debounce 秒途切れるまでまとめてから 1 回だけ知らせる
+// - 知らせる先はロックなしのキュー（SpscQueue）。取り出す Poll は 1 つのスレッドからだけ呼ぶこと
+// ポーリングと違って監視するファイルの数が増えても Poll の手間は変わらない。
+// OS の通知が使えない（IsAvailable が false・Watch が false）ときは、呼び出し側が更新時刻のポーリングに戻すこと
+class FileWatcher {
+public:
+    struct Config {
+        double debounce = 0.05;       // 秒
+        uint32_t queueCapacity = 4096; // あふれたら次の Poll で監視中の全 id を返す
+    };
+
+    FileWatcher() : FileWatcher(Config{}) {}
+    explicit FileWatcher(const Config& config);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool IsAvailable() const { return m_available; }
+
+    // file はまだ無くてもよい（親ディレクトリは要る）。同じ id で呼び直すと監視先を置き換える。
+    // 同じファイルを複数の id で監視してもよい（id ごとに知らせる）
+    bool Watch(uint64_t id, const std::filesystem::path& file);
+    void Unwatch(uint64_t id);
+
+    // 変更が落ち着いたファイルの id を changed に追加する（重複はありうる）。戻り値は追加した数
+    size_t Poll(std::vector<uint64_t>& changed);
+
+    size_t GetWatchCount() const;
+    size_t GetDirectoryCount() const;
+
+private:
+    struct Backend_;
+    struct Dir_ {
+        std::filesystem::path path;
+        std::unordered_map<std::string, std::vector<uint64_t>> files; // ファイル名 → id
+        intptr_t native = -1; // inotify の wd / Windows の監視オブジェクト
+    };
+    struct Target_ {
+        std::string dir;
+        std::string name;
+    };
+    struct Event_ {
+        std::string dir;
+        std::string name;
+    };
+
+    void threadLoop_();
+    // OS の通知を timeoutMs（負なら無期限）まで待って out に積む。Watch していない名前は捨てる
+    void readEvents_(int timeoutMs, std::vector<Event_>& out);
+    bool addDir_(Dir_& dir);
+    void removeDir_(Dir_& dir);
+    void wake_();
+    void deliver_(const std::string& dir, const std::string& name);
+
+    Config m_config;
+    std::unique_ptr<Backend_> m_backend;
+    bool m_available = false;
+
+    mutable std::mutex m_mutex; // 以下の監視表（Watch / Unwatch と監視スレッド）
+    std::unordered_map<std::string, Dir_> m_dirs;
+    std::unordered_map<uint64_t, Target_> m_targets;
+
+    SpscQueue<uint64_t> m_queue;
+    std::atomic<bool> m_overflow{ false };
+    std::atomic<bool> m_quit{ false };
+    std::thread m_thread;
+};
+
+} // namespace jisaku
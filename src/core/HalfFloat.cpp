@@ -0,0 +1,125 @@
+#include "core/HalfFloat.h"
+#include "core/CpuFeatures.h"
+#include <cstring>
+#if JISAKU_X86
+#include <immintrin.h>
+#endif
+
+using namespace jisaku;
+
+namespace {
+
+using FloatToHalfFn = void (*)(uint16_t* dst, const float* src, size_t count);
+using HalfToFloatFn = void (*)(float* dst, const uint16_t* src, size_t count);
+
+void FloatToHalfScalar(uint16_t* dst, const float* src, size_t count) {
+    for (size_t i = 0; i < count; ++i) dst[i] = FloatToHalf(src[i]);
+}
+
+void HalfToFloatScalar(float* dst, const uint16_t* src, size_t count) {
+    for (size_t i = 0; i < count; ++i) dst[i] = HalfToFloat(src[i]);
+}
+
+#if JISAKU_X86
+JISAKU_TARGET_F16C
+void FloatToHalfF16C(uint16_t* dst, const float* src, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+    for (; i < count; ++i) dst[i] = FloatToHalf(src[i]);
+}
+
+JISAKU_TARGET_F16C
+void HalfToFloatF16C(float* dst, const uint16_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+    for (; i < count; ++i) dst[i] = HalfToFloat(src[i]);
+}
+#endif
+
+FloatToHalfFn GetFloatToHalf() {
+    static const FloatToHalfFn s_fn = []() -> FloatToHalfFn {
+#if JISAKU_X86
+        if (GetCpuFeatures().f16c) return FloatToHalfF16C;
+#endif
+        return FloatToHalfScalar;
+    }();
+    return s_fn;
+}
+
+HalfToFloatFn GetHalfToFloat() {
+    static const HalfToFloatFn s_fn = []() -> HalfToFloatFn {
+#if JISAKU_X86
+        if (GetCpuFeatures().f16c) return HalfToFloatF16C;
+#endif
+        return HalfToFloatScalar;
+    }();
+    return s_fn;
+}
+
+} // namespace
+
+uint16_t jisaku::FloatToHalf(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, 4);
+    const uint16_t sign = uint16_t((x >> 16) & 0x8000);
+    const uint32_t absx = x & 0x7FFFFFFF;
+
+    if (absx >= 0x7F800000) {
+        // Inf / NaN（NaN は quiet ビットを立てて仮数の上位を残す）
+        return uint16_t(sign | 0x7C00 | (absx > 0x7F800000 ? 0x200 | ((absx >> 13) & 0x3FF) : 0));
+    }
+    if (absx >= 0x477FF000) return uint16_t(sign | 0x7C00); // 65520 以上は丸めると Inf
+
+    if (absx < 0x38800000) {
+        // half の非正規化数（またはゼロ）。暗黙の 1 を立ててから右シフトし、最近接偶数に丸める
+        if (absx < 0x33000000) return sign; // 2^-25 以下は 0
+        const uint32_t e = absx >> 23;
+        const uint32_t m = (absx & 0x7FFFFF) | 0x800000;
+        const uint32_t shift = 126 - e; // 14..24
+        const uint32_t halfBit = 1u << (shift - 1);
+        const uint32_t rem = m & ((1u << shift) - 1);
+        uint32_t h = m >> shift;
+        if (rem > halfBit || (rem == halfBit && (h & 1))) ++h;
+        return uint16_t(sign | h);
+    }
+
+    // 正規化数: 指数を付け替え、下位 13bit を最近接偶数で丸める（桁上がりで指数が増えるのはそのまま正しい）
+    uint32_t h = ((absx - 0x38000000) >> 13);
+    const uint32_t rem = absx & 0x1FFF;
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) ++h;
+    return uint16_t(sign | h);
+}
+
+float jisaku::HalfToFloat(uint16_t h) {
+    const uint32_t sign = uint32_t(h & 0x8000) << 16;
+    const uint32_t e = (h >> 10) & 0x1F;
+    uint32_t m = h & 0x3FF;
+    uint32_t x;
+    if (e == 0x1F) {
+        x = sign | 0x7F800000 | (m << 13) | (m ? 0x400000 : 0); // NaN は quiet にする（F16C と同じ）
+    } else if (e != 0) {
+        x = sign | ((e + 112) << 23) | (m << 13);
+    } else if (m == 0) {
+        x = sign;
+    } else {
+        // 非正規化数を正規化
+        uint32_t shift = 0;
+        while ((m & 0x400) == 0) { m <<= 1; ++shift; }
+        x = sign | ((113 - shift) << 23) | ((m & 0x3FF) << 13);
+    }
+    float f;
+    std::memcpy(&f, &x, 4);
+    return f;
+}
+
+void jisaku::FloatToHalf(uint16_t* dst, const float* src, size_t count) {
+    GetFloatToHalf()(dst, src, count);
+}
+
+void jisaku::HalfToFloat(float* dst, const uint16_t* src, size_t count) {
+    GetHalfToFloat()(dst, src, count);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace jisaku {
+
+// IEEE 754 binary16 との相互変換。丸めは最近接偶数、範囲外は ±Inf、NaN は NaN のまま
+uint16_t FloatToHalf(float f);
+float HalfToFloat(uint16_t h);
+
+// 配列版。F16C が使える CPU では 8 要素ずつ vcvtps2ph/vcvtph2ps で変換する（結果はスカラー版と同一）
+void FloatToHalf(uint16_t* dst, const float* src, size_t count);
+void HalfToFloat(float* dst, const uint16_t* src, size_t count);
+
+} // namespace jisaku
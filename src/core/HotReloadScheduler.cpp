@@ -0,0 +1,107 @@
+#include "core/HotReloadScheduler.h"
+#include "core/FileWatcher.h"
+#include <algorithm>
+
+using namespace jisaku;
+
+HotReloadScheduler::HotReloadScheduler(const Config& config) : m_config(config) {
+    if (!config.useFileWatcher) return;
+    // 書き込みの途切れ待ちは監視スレッドに任せる
+    FileWatcher::Config watch;
+    watch.debounce = config.settleTime;
+    m_watcher = std::make_unique<FileWatcher>(watch);
+    if (!m_watcher->IsAvailable()) m_watcher.reset();
+}
+
+HotReloadScheduler::~HotReloadScheduler() = default;
+
+HotReloadScheduler::Stamp_ HotReloadScheduler::stat_(const std::filesystem::path& path) {
+    Stamp_ s;
+    std::error_code ec;
+    s.time = std::filesystem::last_write_time(path, ec);
+    if (ec) return Stamp_{};
+    const uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) return Stamp_{};
+    s.size = uint64_t(size);
+    s.exists = true;
+    return s;
+}
+
+void HotReloadScheduler::Add(uint64_t id, const std::filesystem::path& path) {
+    Entry_ e;
+    e.path = path;
+    e.stamp = stat_(path);
+    e.watched = m_watcher && m_watcher->Watch(id, path);
+    m_entries[id] = std::move(e);
+}
+
+void HotReloadScheduler::Remove(uint64_t id) {
+    if (m_watcher) m_watcher->Unwatch(id);
+    m_entries.erase(id);
+}
+
+void HotReloadScheduler::Invalidate(uint64_t id) {
+    auto it = m_entries.find(id);
+    if (it != m_entries.end()) it->second.forced = true;
+}
+
+bool HotReloadScheduler::IsRunning(uint64_t id) const {
+    auto it = m_entries.find(id);
+    return it != m_entries.end() && it->second.running;
+}
+
+size_t HotReloadScheduler::GetWatchedCount() const {
+    return size_t(std::count_if(m_entries.begin(), m_entries.end(), [](const auto& e) { return e.second.watched; }));
+}
+
+std::vector<uint64_t> HotReloadScheduler::Update(double now) {
+    std::vector<uint64_t> fired;
+    const bool poll = !m_polled || now - m_lastPoll >= m_config.pollInterval;
+    if (poll) {
+        m_polled = true;
+        m_lastPoll = now;
+    }
+    if (m_watcher) {
+        // 通知はもう落ち着いているので、中身が変わっていれば（取りこぼし時の全件通知も含めて）すぐ発火できる
+        m_events.clear();
+        m_watcher->Poll(m_events);
+        for (uint64_t id : m_events) {
+            auto it = m_entries.find(id);
+            if (it == m_entries.end()) continue;
+            Entry_& e = it->second;
+            const Stamp_ s = stat_(e.path);
+            if (s == e.stamp) continue;
+            e.stamp = s;
+            e.changedAt = now;
+            e.dirty = true;
+        }
+    }
+    for (auto& [id, e] : m_entries) {
+        if (poll && !e.watched) {
+            const Stamp_ s = stat_(e.path);
+            if (s != e.stamp) {
+                // 書き込み中かもしれないので、次のポーリングで落ち着いているのを確かめてから発火する
+                e.stamp = s;
+                e.changedAt = now;
+                e.dirty = true;
+                continue;
+            }
+        }
+        if (e.running) continue;
+        const bool settled = e.dirty && e.stamp.exists &&
+                             (e.watched || (poll && now - e.changedAt >= m_config.settleTime));
+        if (settled || e.forced) {
+            e.dirty = false;
+            e.forced = false;
+            e.running = true;
+            fired.push_back(id);
+        }
+    }
+    std::sort(fired.begin(), fired.end());
+    return fired;
+}
+
+void HotReloadScheduler::Complete(uint64_t id) {
+    auto it = m_entries.find(id);
+    if (it != m_entries.end()) it->second.running = false;
+}
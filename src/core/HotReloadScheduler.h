@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace jisaku {
+
+class FileWatcher;
+
+// ファイルの変更を見て、リロードを始めるタイミングを決める（GPU に依存しない部分）。
+// - OS の変更通知（FileWatcher）が使えるファイルは、通知が settleTime 途切れた後の Update で発火する
+// - 使えないファイルは pollInterval ごとに更新時刻とサイズを見比べ、
+//   変わったファイルは settleTime 以上たった後のポーリングでも変わっていなければ発火する
+//   （画像ツールの書き出しは何回かに分けて書かれるので、途中の状態を読まないように）
+// - 同じ id のリロードは同時に 1 つだけ。実行中にまた変わったら Complete 後にもう一度発火する
+// スレッドセーフではない（呼び出し側のスレッドで使う）
+class HotReloadScheduler {
+public:
+    struct Config {
+        double pollInterval = 0.5; // 秒
+        double settleTime = 0.2;   // 秒
+        bool useFileWatcher = true;
+    };
+
+    HotReloadScheduler() : HotReloadScheduler(Config{}) {}
+    explicit HotReloadScheduler(const Config& config);
+    ~HotReloadScheduler();
+
+    HotReloadScheduler(const HotReloadScheduler&) = delete;
+    HotReloadScheduler& operator=(const HotReloadScheduler&) = delete;
+
+    // 同じファイルを複数の id で監視してもよい（id ごとに発火する）
+    void Add(uint64_t id, const std::filesystem::path& path);
+    void Remove(uint64_t id);
+    // 変更が無くても次の Update で発火させる
+    void Invalidate(uint64_t id);
+
+    // now は単調増加する秒。リロードを始めるべき id を昇順で返す（返した id は Complete まで実行中扱い）
+    std::vector<uint64_t> Update(double now);
+    // リロードが終わった（成否は問わない）
+    void Complete(uint64_t id);
+
+    size_t Size() const { return m_entries.size(); }
+    bool IsRunning(uint64_t id) const;
+    // OS の通知で見ているファイルの数（残りはポーリング）
+    size_t GetWatchedCount() const;
+
+private:
+    struct Stamp_ {
+        std::filesystem::file_time_type time{};
+        uint64_t size = 0;
+        bool exists = false;
+
+        bool operator==(const Stamp_&) const = default;
+    };
+    struct Entry_ {
+        std::filesystem::path path;
+        Stamp_ stamp;
+        double changedAt = 0.0;
+        bool dirty = false;   // 変更を見つけたがまだ発火していない
+        bool forced = false;  // Invalidate された
+        bool running = false;
+        bool watched = false; // FileWatcher で見ている
+    };
+
+    static Stamp_ stat_(const std::filesystem::path& path);
+
+    Config m_config;
+    double m_lastPoll = 0.0;
+    bool m_polled = false;
+    std::unordered_map<uint64_t, Entry_> m_entries;
+    std::unique_ptr<FileWatcher> m_watcher; // 使えなければ null
+    std::vector<uint64_t> m_events;
+};
+
+} // namespace jisaku
@@ -0,0 +1,96 @@
+#include "core/JobSystem.h"
+#include <algorithm>
+
+using namespace jisaku;
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    if (workerCount == 0) {
+        const uint32_t hw = std::thread::hardware_concurrency();
+        workerCount = hw > 1 ? hw - 1 : 1;
+    }
+    m_workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back([this]() { workerLoop_(); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_quit = true;
+    }
+    m_cv.notify_all();
+    for (auto& t : m_workers) t.join();
+}
+
+JobSystem& JobSystem::Get() {
+    static JobSystem s_instance;
+    return s_instance;
+}
+
+void JobSystem::Submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_queue.push_back(std::move(job));
+    }
+    m_cv.notify_one();
+}
+
+void JobSystem::workerLoop_() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            m_cv.wait(lk, [this]() { return m_quit || !m_queue.empty(); });
+            if (m_quit && m_queue.empty()) return;
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        job();
+    }
+}
+
+bool JobSystem::tryRunOne_() {
+    std::function<void()> job;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (m_queue.empty()) return false;
+        job = std::move(m_queue.front());
+        m_queue.pop_front();
+    }
+    job();
+    return true;
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grain,
+                            const std::function<void(uint32_t, uint32_t)>& fn) {
+    if (count == 0) return;
+    grain = (std::max)(grain, 1u);
+    const uint32_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || m_workers.empty()) { fn(0, count); return; }
+
+    // チャンクは atomic カウンタで取り合う。ヘルパーが遅れて起動しても取り分が無ければ即終了する。
+    struct State {
+        std::atomic<uint32_t> next{ 0 };
+        std::atomic<uint32_t> done{ 0 };
+    };
+    auto state = std::make_shared<State>();
+    auto run = [state, count, grain, chunks, &fn]() {
+        for (;;) {
+            const uint32_t c = state->next.fetch_add(1, std::memory_order_relaxed);
+            if (c >= chunks) return;
+            const uint32_t begin = c * grain;
+            fn(begin, (std::min)(begin + grain, count));
+            state->done.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    const uint32_t helpers = (std::min)(chunks - 1, GetWorkerCount());
+    for (uint32_t i = 0; i < helpers; ++i) Submit(run);
+    run();
+
+    // 残りは他スレッドが処理中。待つ間はキュー内の別ジョブを消化してデッドロックを避ける。
+    while (state->done.load(std::memory_order_acquire) < chunks) {
+        if (!tryRunOne_()) std::this_thread::yield();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace jisaku {
+
+// 汎用ワーカースレッドプール。テクスチャ処理などのCPU並列処理に使う。
+class JobSystem {
+public:
+    // workerCount == 0 のときは hardware_concurrency - 1 本
+    explicit JobSystem(uint32_t workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // プロセス共通のプール（初回呼び出し時に生成）
+    static JobSystem& Get();
+
+    void Submit(std::function<void()> job);
+
+    // 戻り値を future で受け取る版
+    template <class F>
+    auto Async(F&& fn) -> std::future<std::invoke_result_t<F>> {
+        using R = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        auto fut = task->get_future();
+        Submit([task]() { (*task)(); });
+        return fut;
+    }
+
+    // [0,count) を grain 単位に分割して並列実行し、全完了まで待つ。
+    // 呼び出しスレッドも処理に参加するので、ジョブ内からの入れ子呼び出しも可。
+    void ParallelFor(uint32_t count, uint32_t grain,
+                     const std::function<void(uint32_t begin, uint32_t end)>& fn);
+
+    // future の完了を待つ。待つ間はキュー内の別ジョブを消化するので、
+    // ジョブの中から「後続のジョブが満たす future」を待ってもデッドロックしない
+    template <class T>
+    T Wait(std::future<T>& future) {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!tryRunOne_()) future.wait_for(std::chrono::microseconds(100));
+        }
+        return future.get();
+    }
+
+    uint32_t GetWorkerCount() const { return (uint32_t)m_workers.size(); }
+
+private:
+    void workerLoop_();
+    bool tryRunOne_();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_quit = false;
+};
+
+} // namespace jisaku
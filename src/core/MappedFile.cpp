@@ -0,0 +1,57 @@
+#include "core/MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace jisaku;
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::filesystem::path& path) {
+    std::shared_ptr<MappedFile> f(new MappedFile());
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    f->m_file = file;
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) return nullptr;
+    f->m_size = uint64_t(size.QuadPart);
+    f->m_mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (!f->m_mapping) return nullptr;
+    f->m_data = static_cast<uint8_t*>(MapViewOfFile(f->m_mapping, FILE_MAP_COPY, 0, 0, 0));
+    if (!f->m_data) return nullptr;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    // MAP_PRIVATE + PROT_WRITE でコピーオンライト。マップした後はファイル記述子は要らない
+    void* p = ::mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return nullptr;
+    f->m_data = static_cast<uint8_t*>(p);
+    f->m_size = uint64_t(st.st_size);
+#endif
+    return f;
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+#else
+    if (m_data) ::munmap(m_data, size_t(m_size));
+#endif
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace jisaku {
+
+// ファイル全体をコピーオンライトでメモリにマップする。
+// 書き換え（ロード時のオフセット→ポインタの付け替え等）はこのプロセスの中だけで、ファイルには書かれない。
+// 触ったページだけが複製されるので、大きな配列を読むだけなら追加のメモリは要らない
+class MappedFile {
+public:
+    // 失敗時（空のファイルを含む）は nullptr
+    static std::shared_ptr<MappedFile> Open(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    uint8_t* GetData() const { return m_data; }
+    uint64_t GetSize() const { return m_size; }
+
+private:
+    MappedFile() = default;
+
+    uint8_t* m_data = nullptr;
+    uint64_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+} // namespace jisaku
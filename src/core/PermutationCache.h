@@ -0,0 +1,209 @@
+#pragma once
+#include "core/JobSystem.h"
+#include "core/ReloadResultQueue.h"
+#include "core/ShaderPermutations.h"
+#include <algorithm>
+#include <bit>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace jisaku {
+
+// 1 つのシェーダーのパーミュテーションを、要求されたときにワーカーで作って持っておく（D3D 非依存。T は PSO 等）。
+// - Request で無ければ作り始め、できるまでは「要求のビットの部分集合で、できているもののうちビットが最も多いもの」を返す
+//   （それも無ければ null。呼び出し側は基本形で描く）
+// - 作るのは同時に maxBuilding 個まで。Request したものは Prefetch（起動時の先読み）より先に作る
+// - できたものは capacity 個まで持ち、あふれたら使われていない順に手放す（Apply の evicted に返すので、
+//   GPU が使い終わるまで呼び出し側が持っておくこと）
+// - 作れなかったパーミュテーションは Clear するまで作り直さない
+// Request / Prefetch / Apply / Clear はメインスレッドから。Request の戻り値は次の Apply / Clear まで有効
+template <class T>
+class PermutationCache {
+public:
+    struct Config {
+        size_t capacity = 16;
+        uint32_t maxBuilding = 2;
+    };
+    // ワーカーで呼ばれる。作れたら out に入れて true
+    using Builder = std::function<bool(PermutationKey key, T& out)>;
+    // job をどこで動かすか（省略時は JobSystem）
+    using Executor = std::function<void(std::function<void()> job)>;
+
+    explicit PermutationCache(Builder build, const Config& config = Config{}, Executor executor = {})
+        : m_build(std::move(build)), m_config(config), m_executor(std::move(executor)) {
+        if (!m_executor) m_executor = [](std::function<void()> job) { JobSystem::Get().Submit(std::move(job)); };
+        if (m_config.maxBuilding == 0) m_config.maxBuilding = 1;
+    }
+    ~PermutationCache() { m_results.WaitIdle(); } // 作りかけのジョブの完了を待つ
+
+    PermutationCache(const PermutationCache&) = delete;
+    PermutationCache& operator=(const PermutationCache&) = delete;
+
+    const T* Request(PermutationKey key, PermutationKey* resolved = nullptr) {
+        if (m_used.insert(key).second) m_usedOrder.push_back(key);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            touch_(it->second);
+            if (resolved) *resolved = key;
+            return &it->second.value;
+        }
+        schedule_(key, true);
+
+        auto best = m_entries.end();
+        for (auto e = m_entries.begin(); e != m_entries.end(); ++e) {
+            if ((e->first & ~key) != 0) continue;
+            if (best == m_entries.end() || std::popcount(e->first) > std::popcount(best->first) ||
+                (std::popcount(e->first) == std::popcount(best->first) && e->first < best->first))
+                best = e;
+        }
+        if (best == m_entries.end()) return nullptr;
+        touch_(best->second);
+        if (resolved) *resolved = best->first;
+        return &best->second.value;
+    }
+
+    // 使う前に作っておく（できていれば何もしない）
+    void Prefetch(PermutationKey key) {
+        if (m_entries.count(key) == 0) schedule_(key, false);
+    }
+
+    // できたものを取り込み、待っているものを作り始める。戻り値は取り込んだ数
+    size_t Apply(std::vector<T>& evicted) {
+        size_t applied = 0;
+        for (auto& [id, result] : m_results.Take()) {
+            const PermutationKey key = PermutationKey(id);
+            m_running.erase(key);
+            if (!result.ok) {
+                m_failed.insert(key);
+                ++m_failedCount;
+                continue;
+            }
+            insert_(key, std::move(result.value), evicted);
+            ++applied;
+        }
+        pump_();
+        return applied;
+    }
+
+    // シェーダーが変わったとき。持っているものをすべて evicted へ返し、作りかけの結果は捨てる
+    // （待っているものは新しいシェーダーで作る）
+    void Clear(std::vector<T>& evicted) {
+        for (auto& [key, entry] : m_entries) evicted.push_back(std::move(entry.value));
+        m_entries.clear();
+        m_lru.clear();
+        m_failed.clear();
+        const std::vector<PermutationKey> running(m_running.begin(), m_running.end());
+        m_running.clear();
+        for (PermutationKey key : running) {
+            m_results.Cancel(key);
+            // Request されていたものは作り直す
+            if (m_used.count(key)) schedule_(key, true);
+        }
+        pump_();
+    }
+
+    bool IsReady(PermutationKey key) const { return m_entries.count(key) != 0; }
+    bool IsBuilding(PermutationKey key) const { return m_running.count(key) != 0 || m_queued.count(key) != 0; }
+    bool HasFailed(PermutationKey key) const { return m_failed.count(key) != 0; }
+
+    size_t Size() const { return m_entries.size(); }
+    uint32_t GetBuildingCount() const { return m_results.GetInFlight(); }
+    size_t GetPendingCount() const { return m_pending.size(); }
+    uint64_t GetFailedCount() const { return m_failedCount; }
+    uint64_t GetEvictedCount() const { return m_evictedCount; }
+    // Request されたキー（初めて要求された順）。使用記録の保存用
+    const std::vector<PermutationKey>& GetUsedKeys() const { return m_usedOrder; }
+
+    void WaitIdle() const { m_results.WaitIdle(); }
+
+private:
+    struct Entry_ {
+        T value;
+        typename std::list<PermutationKey>::iterator lru;
+    };
+    struct Result_ {
+        T value{};
+        bool ok = false;
+    };
+
+    void touch_(Entry_& e) { m_lru.splice(m_lru.begin(), m_lru, e.lru); }
+
+    void insert_(PermutationKey key, T value, std::vector<T>& evicted) {
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            evicted.push_back(std::move(it->second.value));
+            it->second.value = std::move(value);
+            touch_(it->second);
+            return;
+        }
+        m_lru.push_front(key);
+        m_entries.emplace(key, Entry_{ std::move(value), m_lru.begin() });
+        while (m_entries.size() > m_config.capacity && !m_lru.empty()) {
+            const PermutationKey oldest = m_lru.back();
+            m_lru.pop_back();
+            auto victim = m_entries.find(oldest);
+            evicted.push_back(std::move(victim->second.value));
+            m_entries.erase(victim);
+            ++m_evictedCount;
+        }
+    }
+
+    void schedule_(PermutationKey key, bool urgent) {
+        if (m_failed.count(key) || m_running.count(key)) return;
+        if (m_queued.count(key)) {
+            if (!urgent) return;
+            auto it = std::find(m_pending.begin(), m_pending.end(), key);
+            if (it != m_pending.begin()) {
+                m_pending.erase(it);
+                m_pending.push_front(key);
+            }
+        } else {
+            m_queued.insert(key);
+            if (urgent) m_pending.push_front(key);
+            else m_pending.push_back(key);
+        }
+        pump_();
+    }
+
+    void pump_() {
+        while (!m_pending.empty() && m_results.GetInFlight() < m_config.maxBuilding) {
+            const PermutationKey key = m_pending.front();
+            m_pending.pop_front();
+            m_queued.erase(key);
+            m_running.insert(key);
+            const uint64_t generation = m_results.Begin(key);
+            m_executor([this, key, generation]() {
+                Result_ result;
+                try {
+                    result.ok = m_build(key, result.value);
+                } catch (const std::exception&) {
+                    result.ok = false;
+                }
+                m_results.Finish(key, generation, std::move(result));
+            });
+        }
+    }
+
+    Builder m_build;
+    Config m_config;
+    Executor m_executor;
+    std::unordered_map<PermutationKey, Entry_> m_entries;
+    std::list<PermutationKey> m_lru; // 先頭が最近使ったもの
+    std::deque<PermutationKey> m_pending;
+    std::unordered_set<PermutationKey> m_queued;  // m_pending にあるもの
+    std::unordered_set<PermutationKey> m_running; // ワーカーで作っているもの
+    std::unordered_set<PermutationKey> m_failed;
+    std::unordered_set<PermutationKey> m_used;
+    std::vector<PermutationKey> m_usedOrder;
+    uint64_t m_failedCount = 0;
+    uint64_t m_evictedCount = 0;
+    ReloadResultQueue<Result_> m_results; // ジョブが書き込むので最後に破棄する（先に完了を待つ）
+};
+
+} // namespace jisaku
@@ -0,0 +1,18 @@
+#include "core/PipelineKey.h"
+#include "core/ByteOrder.h"
+
+using namespace jisaku;
+
+ContentKey jisaku::MakePipelineKey(const PipelineKeyDesc& desc) {
+    uint8_t bytes[4 + 16 * 6 + 8];
+    uint8_t* p = bytes;
+    WriteU32(p, kPipelineKeyVersion);
+    p += 4;
+    for (const ContentKey* k : { &desc.rootSignature, &desc.vs, &desc.ps, &desc.ds, &desc.hs, &desc.gs }) {
+        WriteU64(p, k->hi);
+        WriteU64(p + 8, k->lo);
+        p += 16;
+    }
+    WriteU64(p, desc.state);
+    return HashContent(bytes, sizeof(bytes));
+}
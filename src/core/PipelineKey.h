@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include "core/AssetManifest.h"
+#include "core/PipelineState.h"
+
+namespace jisaku {
+
+// PSO キャッシュのキー（D3D/Windows 非依存）。
+// 固定部分は HashPipelineState（constexpr の desc ならコンパイル時に決まる）、
+// ポインターの先（シェーダーのバイトコード・ルートシグネチャ）は中身のハッシュで持つので、プロセスをまたいでも同じキーになる
+constexpr uint32_t kPipelineKeyVersion = 2; // シリアライズの形を変えたら上げる（古いキーに当たらなくなる）
+
+struct PipelineKeyDesc {
+    ContentKey rootSignature; // シリアライズしたルートシグネチャ
+    ContentKey vs, ps, ds, hs, gs; // バイトコード（使わないステージはゼロ）
+    uint64_t state = 0;       // HashPipelineState
+};
+
+// リトルエンディアンで並べ（先頭に kPipelineKeyVersion）、HashContent する
+ContentKey MakePipelineKey(const PipelineKeyDesc& desc);
+
+} // namespace jisaku
@@ -0,0 +1,432 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace jisaku {
+
+// PSO の固定部分（シェーダーとルートシグネチャ以外）をコンパイル時に組み立てる（D3D/Windows 非依存）。
+// 列挙値は D3D12 / DXGI の数値そのもの（gfx/PipelineDesc.h が static_assert で確かめてから D3D12 の desc にする）。
+//   constexpr InputLayout kLayout = MakeInputLayout<Vertex>({
+//       VertexElement<decltype(Vertex::pos)>("POSITION", offsetof(Vertex, pos)), ... });
+//   static_assert(kLayout.IsValid());
+//   constexpr PipelineStateDesc kState = PipelineStateDesc{}.WithInputLayout(kLayout).WithRenderTarget(PixelFormat::R8G8B8A8Unorm);
+//   constexpr uint64_t kStateHash = HashPipelineState(kState); // PipelineCache のキーの一部
+// 各ステートの既定値は D3D12 の既定（CD3DX12_*_DESC(D3D12_DEFAULT) と同じ）。PipelineStateDesc は深度なし・レンダーターゲットなしから始める
+
+enum class PixelFormat : uint32_t {
+    Unknown = 0,
+    R32G32B32A32Float = 2,
+    R32G32B32Float = 6,
+    R16G16B16A16Float = 10,
+    R32G32Float = 16,
+    R8G8B8A8Unorm = 28,
+    R8G8B8A8UnormSrgb = 29,
+    D32Float = 40,
+    R32Float = 41,
+    R32Uint = 42,
+    D24UnormS8Uint = 45,
+    B8G8R8A8Unorm = 87,
+};
+
+enum class FillMode : uint32_t { Wireframe = 2, Solid = 3 };
+enum class CullMode : uint32_t { None = 1, Front = 2, Back = 3 };
+enum class Blend : uint32_t {
+    Zero = 1, One = 2, SrcColor = 3, InvSrcColor = 4, SrcAlpha = 5, InvSrcAlpha = 6,
+    DestAlpha = 7, InvDestAlpha = 8, DestColor = 9, InvDestColor = 10,
+};
+enum class BlendOp : uint32_t { Add = 1, Subtract = 2, RevSubtract = 3, Min = 4, Max = 5 };
+enum class LogicOp : uint32_t { Clear = 0, Set = 1, Copy = 2, CopyInverted = 3, Noop = 4 };
+enum class ComparisonFunc : uint32_t {
+    Never = 1, Less = 2, Equal = 3, LessEqual = 4, Greater = 5, NotEqual = 6, GreaterEqual = 7, Always = 8,
+};
+enum class DepthWriteMask : uint32_t { Zero = 0, All = 1 };
+enum class StencilOp : uint32_t { Keep = 1, Zero = 2, Replace = 3, IncrSat = 4, DecrSat = 5, Invert = 6, Incr = 7, Decr = 8 };
+enum class PrimitiveTopologyType : uint32_t { Undefined = 0, Point = 1, Line = 2, Triangle = 3, Patch = 4 };
+enum class InputClassification : uint32_t { PerVertex = 0, PerInstance = 1 };
+enum class ConservativeRaster : uint32_t { Off = 0, On = 1 };
+enum class IndexStripCut : uint32_t { Disabled = 0, Value0xFFFF = 1, Value0xFFFFFFFF = 2 };
+
+constexpr uint8_t kColorWriteAll = 0xF;
+constexpr uint32_t kMaxRenderTargets = 8;
+constexpr uint32_t kMaxInputElements = 16;
+constexpr uint32_t kPipelineStateVersion = 1; // HashPipelineState で並べる形を変えたら上げる
+
+// 1 要素のバイト数（頂点フォーマットとして使うものだけ。それ以外は 0）
+constexpr uint32_t FormatSize(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::R32G32B32A32Float: return 16;
+    case PixelFormat::R32G32B32Float: return 12;
+    case PixelFormat::R16G16B16A16Float: return 8;
+    case PixelFormat::R32G32Float: return 8;
+    case PixelFormat::R8G8B8A8Unorm: return 4;
+    case PixelFormat::R8G8B8A8UnormSrgb: return 4;
+    case PixelFormat::R32Float: return 4;
+    case PixelFormat::R32Uint: return 4;
+    case PixelFormat::B8G8R8A8Unorm: return 4;
+    default: return 0;
+    }
+}
+
+// 頂点構造体のメンバーの型 → フォーマット。無い型を使うとコンパイルエラー（gfx/PipelineDesc.h が XMFLOAT* を足す）
+template <class T> struct VertexFormatOf;
+template <> struct VertexFormatOf<float> { static constexpr PixelFormat value = PixelFormat::R32Float; };
+template <> struct VertexFormatOf<float[2]> { static constexpr PixelFormat value = PixelFormat::R32G32Float; };
+template <> struct VertexFormatOf<float[3]> { static constexpr PixelFormat value = PixelFormat::R32G32B32Float; };
+template <> struct VertexFormatOf<float[4]> { static constexpr PixelFormat value = PixelFormat::R32G32B32A32Float; };
+template <> struct VertexFormatOf<uint32_t> { static constexpr PixelFormat value = PixelFormat::R32Uint; };
+
+struct InputElement {
+    const char* semanticName = "";
+    uint32_t semanticIndex = 0;
+    PixelFormat format = PixelFormat::Unknown;
+    uint32_t inputSlot = 0;
+    uint32_t alignedByteOffset = 0;
+    InputClassification classification = InputClassification::PerVertex;
+    uint32_t instanceDataStepRate = 0;
+};
+
+// 頂点構造体のメンバー 1 つ。フォーマットはメンバーの型から決める
+template <class Member>
+constexpr InputElement VertexElement(const char* semanticName, size_t offset, uint32_t semanticIndex = 0) {
+    constexpr PixelFormat format = VertexFormatOf<Member>::value;
+    static_assert(FormatSize(format) == sizeof(Member), "vertex member size does not match its format");
+    InputElement e;
+    e.semanticName = semanticName;
+    e.semanticIndex = semanticIndex;
+    e.format = format;
+    e.alignedByteOffset = uint32_t(offset);
+    return e;
+}
+
+namespace detail {
+
+constexpr char UpperAscii(char c) { return c >= 'a' && c <= 'z' ? char(c - 'a' + 'A') : c; }
+
+// セマンティクス名は大文字・小文字を区別しない
+constexpr bool SemanticEquals(const char* a, const char* b) {
+    for (; *a && *b; ++a, ++b) {
+        if (UpperAscii(*a) != UpperAscii(*b)) return false;
+    }
+    return *a == *b;
+}
+
+} // namespace detail
+
+struct InputLayout {
+    std::array<InputElement, kMaxInputElements> elements{};
+    uint32_t count = 0;
+    uint32_t stride = 0;    // スロット 0 の頂点構造体のサイズ（0 なら確かめない）
+    bool overflow = false;  // kMaxInputElements を超えた
+
+    constexpr InputLayout With(const InputElement& e) const {
+        InputLayout r = *this;
+        if (r.count == kMaxInputElements) r.overflow = true;
+        else r.elements[r.count++] = e;
+        return r;
+    }
+
+    // 要素が構造体からはみ出していない・重なっていない・同じセマンティクスが 2 つ無い
+    constexpr bool IsValid() const {
+        if (overflow) return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            const InputElement& a = elements[i];
+            const uint32_t size = FormatSize(a.format);
+            if (size == 0) return false;
+            if (a.inputSlot == 0 && stride != 0 && a.alignedByteOffset + size > stride) return false;
+            for (uint32_t j = i + 1; j < count; ++j) {
+                const InputElement& b = elements[j];
+                if (detail::SemanticEquals(a.semanticName, b.semanticName) && a.semanticIndex == b.semanticIndex) return false;
+                if (a.inputSlot == b.inputSlot && a.alignedByteOffset < b.alignedByteOffset + FormatSize(b.format) &&
+                    b.alignedByteOffset < a.alignedByteOffset + size)
+                    return false;
+            }
+        }
+        return true;
+    }
+};
+
+// 頂点構造体 Vertex をスロット 0 に置く入力レイアウト
+template <class Vertex>
+constexpr InputLayout MakeInputLayout(std::initializer_list<InputElement> elements) {
+    InputLayout layout;
+    layout.stride = uint32_t(sizeof(Vertex));
+    for (const InputElement& e : elements) layout = layout.With(e);
+    return layout;
+}
+
+struct BlendTargetState {
+    bool blendEnable = false;
+    bool logicOpEnable = false;
+    Blend srcBlend = Blend::One;
+    Blend destBlend = Blend::Zero;
+    BlendOp blendOp = BlendOp::Add;
+    Blend srcBlendAlpha = Blend::One;
+    Blend destBlendAlpha = Blend::Zero;
+    BlendOp blendOpAlpha = BlendOp::Add;
+    LogicOp logicOp = LogicOp::Noop;
+    uint8_t renderTargetWriteMask = kColorWriteAll;
+};
+
+struct BlendState {
+    bool alphaToCoverageEnable = false;
+    bool independentBlendEnable = false;
+    std::array<BlendTargetState, kMaxRenderTargets> renderTargets{};
+};
+
+struct RasterizerState {
+    FillMode fillMode = FillMode::Solid;
+    CullMode cullMode = CullMode::Back;
+    bool frontCounterClockwise = false;
+    int32_t depthBias = 0;
+    float depthBiasClamp = 0.0f;
+    float slopeScaledDepthBias = 0.0f;
+    bool depthClipEnable = true;
+    bool multisampleEnable = false;
+    bool antialiasedLineEnable = false;
+    uint32_t forcedSampleCount = 0;
+    ConservativeRaster conservativeRaster = ConservativeRaster::Off;
+};
+
+struct StencilOpState {
+    StencilOp failOp = StencilOp::Keep;
+    StencilOp depthFailOp = StencilOp::Keep;
+    StencilOp passOp = StencilOp::Keep;
+    ComparisonFunc func = ComparisonFunc::Always;
+};
+
+struct DepthStencilState {
+    bool depthEnable = true;
+    DepthWriteMask depthWriteMask = DepthWriteMask::All;
+    ComparisonFunc depthFunc = ComparisonFunc::Less;
+    bool stencilEnable = false;
+    uint8_t stencilReadMask = 0xFF;
+    uint8_t stencilWriteMask = 0xFF;
+    StencilOpState frontFace{};
+    StencilOpState backFace{};
+};
+
+// 全ターゲット同じブレンド
+constexpr BlendState MakeBlendState(Blend src, Blend dest, BlendOp op = BlendOp::Add) {
+    BlendState s;
+    for (BlendTargetState& t : s.renderTargets) {
+        t.blendEnable = true;
+        t.srcBlend = src;
+        t.destBlend = dest;
+        t.blendOp = op;
+        t.srcBlendAlpha = Blend::One;
+        t.destBlendAlpha = dest == Blend::One ? Blend::One : Blend::InvSrcAlpha;
+        t.blendOpAlpha = op;
+    }
+    return s;
+}
+
+constexpr BlendState kBlendOpaque{};
+constexpr BlendState kBlendAlpha = MakeBlendState(Blend::SrcAlpha, Blend::InvSrcAlpha);
+constexpr BlendState kBlendPremultiplied = MakeBlendState(Blend::One, Blend::InvSrcAlpha);
+constexpr BlendState kBlendAdditive = MakeBlendState(Blend::One, Blend::One);
+
+constexpr RasterizerState kRasterCullBack{};
+constexpr RasterizerState kRasterCullNone{ .cullMode = CullMode::None };
+constexpr RasterizerState kRasterWireframe{ .fillMode = FillMode::Wireframe, .cullMode = CullMode::None };
+
+constexpr DepthStencilState kDepthDisabled{ .depthEnable = false, .depthWriteMask = DepthWriteMask::Zero };
+constexpr DepthStencilState kDepthReadWrite{};
+constexpr DepthStencilState kDepthRead{ .depthWriteMask = DepthWriteMask::Zero };
+
+struct PipelineStateDesc {
+    BlendState blend;
+    uint32_t sampleMask = 0xFFFFFFFFu;
+    RasterizerState rasterizer;
+    DepthStencilState depthStencil = kDepthDisabled;
+    InputLayout inputLayout;
+    IndexStripCut ibStripCutValue = IndexStripCut::Disabled;
+    PrimitiveTopologyType primitiveTopologyType = PrimitiveTopologyType::Triangle;
+    uint32_t numRenderTargets = 0;
+    std::array<PixelFormat, kMaxRenderTargets> rtvFormats{};
+    PixelFormat dsvFormat = PixelFormat::Unknown;
+    uint32_t sampleCount = 1;
+    uint32_t sampleQuality = 0;
+    uint32_t nodeMask = 0;
+    uint32_t flags = 0;
+
+    constexpr PipelineStateDesc WithInputLayout(const InputLayout& layout) const { PipelineStateDesc r = *this; r.inputLayout = layout; return r; }
+    constexpr PipelineStateDesc WithBlend(const BlendState& state) const { PipelineStateDesc r = *this; r.blend = state; return r; }
+    constexpr PipelineStateDesc WithRasterizer(const RasterizerState& state) const { PipelineStateDesc r = *this; r.rasterizer = state; return r; }
+    constexpr PipelineStateDesc WithDepthStencil(const DepthStencilState& state, PixelFormat dsv) const {
+        PipelineStateDesc r = *this;
+        r.depthStencil = state;
+        r.dsvFormat = dsv;
+        return r;
+    }
+    constexpr PipelineStateDesc WithTopology(PrimitiveTopologyType type) const { PipelineStateDesc r = *this; r.primitiveTopologyType = type; return r; }
+    // レンダーターゲットを 1 枚足す（kMaxRenderTargets を超えたら IsValid が false）
+    constexpr PipelineStateDesc WithRenderTarget(PixelFormat format) const {
+        PipelineStateDesc r = *this;
+        if (r.numRenderTargets < kMaxRenderTargets) r.rtvFormats[r.numRenderTargets] = format;
+        ++r.numRenderTargets;
+        return r;
+    }
+
+    constexpr bool IsValid() const {
+        if (!inputLayout.IsValid() || numRenderTargets > kMaxRenderTargets) return false;
+        for (uint32_t i = 0; i < numRenderTargets; ++i) {
+            if (rtvFormats[i] == PixelFormat::Unknown) return false;
+        }
+        if ((depthStencil.depthEnable || depthStencil.stencilEnable) && dsvFormat == PixelFormat::Unknown) return false;
+        return sampleCount >= 1;
+    }
+};
+
+// D3D12 が見ない値をそろえる（同じ PSO になる desc だけを同じ形にする。迷う値は変えない）
+// - 独立ブレンドでなければ 2 枚目以降のブレンド設定、ブレンド・論理演算が無効ならその係数
+// - NumRenderTargets より後ろの RTV フォーマット
+// - 深度テストが無効なら書き込みマスクと比較関数、ステンシルが無効ならステンシルの設定すべて
+// - 頂点ごとの入力要素の InstanceDataStepRate（セマンティクス名の大文字・小文字はハッシュでそろえる）
+// - サンプル数より上の SampleMask のビット、-0.0
+constexpr PipelineStateDesc NormalizePipelineState(PipelineStateDesc desc) {
+    if (!desc.blend.independentBlendEnable) {
+        for (uint32_t i = 1; i < kMaxRenderTargets; ++i) desc.blend.renderTargets[i] = BlendTargetState{};
+    }
+    for (BlendTargetState& t : desc.blend.renderTargets) {
+        if (!t.blendEnable) {
+            BlendTargetState reset;
+            reset.logicOpEnable = t.logicOpEnable;
+            reset.logicOp = t.logicOp;
+            reset.renderTargetWriteMask = t.renderTargetWriteMask;
+            t = reset;
+        }
+        if (!t.logicOpEnable) t.logicOp = LogicOp::Noop;
+    }
+
+    if (desc.numRenderTargets > kMaxRenderTargets) desc.numRenderTargets = kMaxRenderTargets;
+    for (uint32_t i = desc.numRenderTargets; i < kMaxRenderTargets; ++i) desc.rtvFormats[i] = PixelFormat::Unknown;
+
+    DepthStencilState& ds = desc.depthStencil;
+    if (!ds.depthEnable) {
+        ds.depthWriteMask = DepthWriteMask::Zero;
+        ds.depthFunc = ComparisonFunc::Never;
+    }
+    if (!ds.stencilEnable) {
+        ds.stencilReadMask = 0;
+        ds.stencilWriteMask = 0;
+        ds.frontFace = StencilOpState{};
+        ds.backFace = StencilOpState{};
+    }
+
+    for (uint32_t i = 0; i < desc.inputLayout.count; ++i) {
+        InputElement& e = desc.inputLayout.elements[i];
+        if (e.classification == InputClassification::PerVertex) e.instanceDataStepRate = 0;
+    }
+    for (uint32_t i = desc.inputLayout.count; i < kMaxInputElements; ++i) desc.inputLayout.elements[i] = InputElement{};
+    desc.inputLayout.stride = 0; // D3D12 の desc には無い（確かめるためだけの値）
+
+    if (desc.sampleCount >= 1 && desc.sampleCount < 32) desc.sampleMask &= (1u << desc.sampleCount) - 1;
+    if (desc.rasterizer.depthBiasClamp == 0.0f) desc.rasterizer.depthBiasClamp = 0.0f; // -0.0 → 0.0
+    if (desc.rasterizer.slopeScaledDepthBias == 0.0f) desc.rasterizer.slopeScaledDepthBias = 0.0f;
+    return desc;
+}
+
+namespace detail {
+
+// FNV-1a（64bit）。コンパイル時にも実行時にも同じ値になるよう 1 バイトずつ（リトルエンディアン）
+struct StateHasher {
+    uint64_t hash = 14695981039346656037ull;
+
+    constexpr void U8(uint8_t v) {
+        hash ^= v;
+        hash *= 1099511628211ull;
+    }
+    constexpr void U32(uint32_t v) {
+        for (int i = 0; i < 4; ++i) U8(uint8_t(v >> (8 * i)));
+    }
+    constexpr void Bool(bool v) { U8(v ? 1 : 0); }
+    constexpr void F32(float v) { U32(std::bit_cast<uint32_t>(v)); }
+    template <class E>
+    constexpr void Enum(E v) { U32(uint32_t(v)); }
+    constexpr void Semantic(const char* s) {
+        uint32_t n = 0;
+        for (const char* p = s; *p; ++p, ++n) U8(uint8_t(UpperAscii(*p)));
+        U32(n);
+    }
+    constexpr void Stencil(const StencilOpState& s) {
+        Enum(s.failOp);
+        Enum(s.depthFailOp);
+        Enum(s.passOp);
+        Enum(s.func);
+    }
+};
+
+} // namespace detail
+
+// 正規化してからハッシュする。constexpr の desc ならコンパイル時に決まる
+constexpr uint64_t HashPipelineState(const PipelineStateDesc& source) {
+    const PipelineStateDesc desc = NormalizePipelineState(source);
+    detail::StateHasher h;
+    h.U32(kPipelineStateVersion);
+
+    h.Bool(desc.blend.alphaToCoverageEnable);
+    h.Bool(desc.blend.independentBlendEnable);
+    for (const BlendTargetState& t : desc.blend.renderTargets) {
+        h.Bool(t.blendEnable);
+        h.Bool(t.logicOpEnable);
+        h.Enum(t.srcBlend);
+        h.Enum(t.destBlend);
+        h.Enum(t.blendOp);
+        h.Enum(t.srcBlendAlpha);
+        h.Enum(t.destBlendAlpha);
+        h.Enum(t.blendOpAlpha);
+        h.Enum(t.logicOp);
+        h.U8(t.renderTargetWriteMask);
+    }
+    h.U32(desc.sampleMask);
+
+    const RasterizerState& r = desc.rasterizer;
+    h.Enum(r.fillMode);
+    h.Enum(r.cullMode);
+    h.Bool(r.frontCounterClockwise);
+    h.U32(uint32_t(r.depthBias));
+    h.F32(r.depthBiasClamp);
+    h.F32(r.slopeScaledDepthBias);
+    h.Bool(r.depthClipEnable);
+    h.Bool(r.multisampleEnable);
+    h.Bool(r.antialiasedLineEnable);
+    h.U32(r.forcedSampleCount);
+    h.Enum(r.conservativeRaster);
+
+    const DepthStencilState& d = desc.depthStencil;
+    h.Bool(d.depthEnable);
+    h.Enum(d.depthWriteMask);
+    h.Enum(d.depthFunc);
+    h.Bool(d.stencilEnable);
+    h.U8(d.stencilReadMask);
+    h.U8(d.stencilWriteMask);
+    h.Stencil(d.frontFace);
+    h.Stencil(d.backFace);
+
+    h.U32(desc.inputLayout.count);
+    for (uint32_t i = 0; i < desc.inputLayout.count; ++i) {
+        const InputElement& e = desc.inputLayout.elements[i];
+        h.Semantic(e.semanticName);
+        h.U32(e.semanticIndex);
+        h.Enum(e.format);
+        h.U32(e.inputSlot);
+        h.U32(e.alignedByteOffset);
+        h.Enum(e.classification);
+        h.U32(e.instanceDataStepRate);
+    }
+    h.Enum(desc.ibStripCutValue);
+    h.Enum(desc.primitiveTopologyType);
+    h.U32(desc.numRenderTargets);
+    for (PixelFormat f : desc.rtvFormats) h.Enum(f);
+    h.Enum(desc.dsvFormat);
+    h.U32(desc.sampleCount);
+    h.U32(desc.sampleQuality);
+    h.U32(desc.nodeMask);
+    h.U32(desc.flags);
+    return h.hash;
+}
+
+} // namespace jisaku
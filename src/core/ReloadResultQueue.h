@@ -0,0 +1,98 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace jisaku {
+
+// ワーカーで作った結果を、メインスレッドがフレームの区切りでまとめて受け取るための箱（D3D 非依存）。
+// - Begin(id) で世代を取ってワーカーへ渡し、ワーカーは終わったら Finish(id, 世代, 結果)
+// - 同じ id を実行中にもう一度 Begin したら、前の世代の結果は戻ってきても捨てる（古いものが後から上書きしない）
+// - Take は id ごとに最新の結果を 1 つずつ返す
+// Begin / Take / Cancel はメインスレッド、Finish は任意のスレッドから呼んでよい
+template <class T>
+class ReloadResultQueue {
+public:
+    ReloadResultQueue() = default;
+    ~ReloadResultQueue() { WaitIdle(); } // 結果を書き込むジョブが残っていたら待つ
+
+    ReloadResultQueue(const ReloadResultQueue&) = delete;
+    ReloadResultQueue& operator=(const ReloadResultQueue&) = delete;
+
+    uint64_t Begin(uint64_t id) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const uint64_t generation = ++m_nextGeneration; // Cancel を挟んでも番号を使い回さない
+        m_latest[id] = generation;
+        ++m_inFlight;
+        return generation;
+    }
+
+    // Begin した回数だけ必ず呼ぶこと（失敗しても、結果を捨てるときも）
+    void Finish(uint64_t id, uint64_t generation, T result) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_latest.find(id);
+        if (it != m_latest.end() && it->second == generation) {
+            m_latest.erase(it);
+            auto ready = std::find_if(m_ready.begin(), m_ready.end(), [id](const auto& r) { return r.first == id; });
+            if (ready != m_ready.end()) ready->second = std::move(result); // まだ Take されていない前の結果より新しい
+            else m_ready.emplace_back(id, std::move(result));
+        } else {
+            ++m_discarded;
+        }
+        --m_inFlight;
+        m_idle.notify_all();
+    }
+
+    // 実行中・受け取り待ちの結果を捨てる（監視をやめたとき）
+    void Cancel(uint64_t id) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latest.erase(id);
+        for (auto it = m_ready.begin(); it != m_ready.end();) {
+            if (it->first == id) it = m_ready.erase(it);
+            else ++it;
+        }
+    }
+
+    std::vector<std::pair<uint64_t, T>> Take() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return std::move(m_ready);
+    }
+
+    bool HasReady() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return !m_ready.empty();
+    }
+    bool IsRunning(uint64_t id) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_latest.count(id) != 0;
+    }
+    uint32_t GetInFlight() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_inFlight;
+    }
+    // 新しい世代に追い越されて捨てた結果の数
+    uint64_t GetDiscarded() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_discarded;
+    }
+
+    void WaitIdle() const {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_inFlight == 0; });
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_idle;
+    std::unordered_map<uint64_t, uint64_t> m_latest; // id → 結果を待っている世代
+    std::vector<std::pair<uint64_t, T>> m_ready;
+    uint64_t m_nextGeneration = 0;
+    uint32_t m_inFlight = 0;
+    uint64_t m_discarded = 0;
+};
+
+} // namespace jisaku
@@ -0,0 +1,219 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include "core/PipelineState.h"
+
+namespace jisaku {
+
+// ルートシグネチャの並びをコンパイル時に組み立てる（D3D/Windows 非依存。列挙値は D3D12 の数値）。
+//   constexpr RootSignatureLayout kRoot = RootSignatureLayout{}.AllowInputLayout()
+//       .Cbv(0, ShaderVisibility::Vertex)
+//       .Table(ShaderVisibility::Pixel, { DescriptorRange::Srv(0) })
+//       .Sampler(StaticSampler::LinearClamp(0, ShaderVisibility::Pixel));
+//   static_assert(kRoot.IsValid()); // 入り切らない・レジスターが重なっていればコンパイルエラー
+// D3D12 のシリアライズは gfx/PipelineDesc.h の SerializeRootSignature
+
+enum class RootParameterType : uint32_t { DescriptorTable = 0, Constants = 1, Cbv = 2, Srv = 3, Uav = 4 };
+enum class ShaderVisibility : uint32_t { All = 0, Vertex = 1, Hull = 2, Domain = 3, Geometry = 4, Pixel = 5 };
+enum class DescriptorRangeType : uint32_t { Srv = 0, Uav = 1, Cbv = 2, Sampler = 3 };
+enum class Filter : uint32_t { MinMagMipPoint = 0, MinMagMipLinear = 0x15, Anisotropic = 0x55 };
+enum class TextureAddressMode : uint32_t { Wrap = 1, Mirror = 2, Clamp = 3, Border = 4 };
+enum class StaticBorderColor : uint32_t { TransparentBlack = 0, OpaqueBlack = 1, OpaqueWhite = 2 };
+
+constexpr uint32_t kRootSignatureAllowInputLayout = 0x1; // D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
+constexpr uint32_t kDescriptorRangeAppend = 0xFFFFFFFFu;  // D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND
+constexpr uint32_t kUnboundedDescriptors = 0xFFFFFFFFu;   // 範囲の数を決めない（最後の範囲だけ）
+constexpr uint32_t kMaxRootParameters = 16;
+constexpr uint32_t kMaxDescriptorRanges = 4; // 1 テーブルあたり
+constexpr uint32_t kMaxStaticSamplers = 8;
+
+struct DescriptorRange {
+    DescriptorRangeType type = DescriptorRangeType::Srv;
+    uint32_t count = 1;
+    uint32_t baseRegister = 0;
+    uint32_t space = 0;
+    uint32_t offset = kDescriptorRangeAppend;
+
+    static constexpr DescriptorRange Srv(uint32_t reg, uint32_t count = 1, uint32_t space = 0) { return { DescriptorRangeType::Srv, count, reg, space }; }
+    static constexpr DescriptorRange Uav(uint32_t reg, uint32_t count = 1, uint32_t space = 0) { return { DescriptorRangeType::Uav, count, reg, space }; }
+    static constexpr DescriptorRange Cbv(uint32_t reg, uint32_t count = 1, uint32_t space = 0) { return { DescriptorRangeType::Cbv, count, reg, space }; }
+    static constexpr DescriptorRange Sampler(uint32_t reg, uint32_t count = 1, uint32_t space = 0) { return { DescriptorRangeType::Sampler, count, reg, space }; }
+};
+
+struct RootParameter {
+    RootParameterType type = RootParameterType::Cbv;
+    ShaderVisibility visibility = ShaderVisibility::All;
+    uint32_t shaderRegister = 0; // テーブル以外
+    uint32_t space = 0;
+    uint32_t num32BitValues = 0; // Constants のとき
+    std::array<DescriptorRange, kMaxDescriptorRanges> ranges{};
+    uint32_t rangeCount = 0;
+};
+
+struct StaticSampler {
+    Filter filter = Filter::MinMagMipLinear;
+    TextureAddressMode addressU = TextureAddressMode::Wrap;
+    TextureAddressMode addressV = TextureAddressMode::Wrap;
+    TextureAddressMode addressW = TextureAddressMode::Wrap;
+    float mipLODBias = 0.0f;
+    uint32_t maxAnisotropy = 16;
+    ComparisonFunc comparisonFunc = ComparisonFunc::LessEqual;
+    StaticBorderColor borderColor = StaticBorderColor::OpaqueWhite;
+    float minLOD = 0.0f;
+    float maxLOD = 3.402823466e+38f; // D3D12_FLOAT32_MAX
+    uint32_t shaderRegister = 0;
+    uint32_t space = 0;
+    ShaderVisibility visibility = ShaderVisibility::Pixel;
+
+    static constexpr StaticSampler LinearClamp(uint32_t reg, ShaderVisibility visibility = ShaderVisibility::Pixel) {
+        StaticSampler s;
+        s.addressU = s.addressV = s.addressW = TextureAddressMode::Clamp;
+        s.shaderRegister = reg;
+        s.visibility = visibility;
+        return s;
+    }
+    static constexpr StaticSampler LinearWrap(uint32_t reg, ShaderVisibility visibility = ShaderVisibility::Pixel) {
+        StaticSampler s;
+        s.shaderRegister = reg;
+        s.visibility = visibility;
+        return s;
+    }
+    static constexpr StaticSampler PointClamp(uint32_t reg, ShaderVisibility visibility = ShaderVisibility::Pixel) {
+        StaticSampler s = LinearClamp(reg, visibility);
+        s.filter = Filter::MinMagMipPoint;
+        return s;
+    }
+};
+
+struct RootSignatureLayout {
+    std::array<RootParameter, kMaxRootParameters> parameters{};
+    uint32_t parameterCount = 0;
+    std::array<StaticSampler, kMaxStaticSamplers> samplers{};
+    uint32_t samplerCount = 0;
+    uint32_t flags = 0;
+    bool overflow = false; // 入り切らなかった
+
+    constexpr RootSignatureLayout AllowInputLayout() const {
+        RootSignatureLayout r = *this;
+        r.flags |= kRootSignatureAllowInputLayout;
+        return r;
+    }
+    constexpr RootSignatureLayout Cbv(uint32_t reg, ShaderVisibility visibility, uint32_t space = 0) const {
+        return withDescriptor_(RootParameterType::Cbv, reg, visibility, space);
+    }
+    constexpr RootSignatureLayout Srv(uint32_t reg, ShaderVisibility visibility, uint32_t space = 0) const {
+        return withDescriptor_(RootParameterType::Srv, reg, visibility, space);
+    }
+    constexpr RootSignatureLayout Uav(uint32_t reg, ShaderVisibility visibility, uint32_t space = 0) const {
+        return withDescriptor_(RootParameterType::Uav, reg, visibility, space);
+    }
+    // ルート定数（b レジスター）
+    constexpr RootSignatureLayout Constants(uint32_t num32BitValues, uint32_t reg, ShaderVisibility visibility, uint32_t space = 0) const {
+        RootSignatureLayout r = withDescriptor_(RootParameterType::Constants, reg, visibility, space);
+        if (!r.overflow) r.parameters[r.parameterCount - 1].num32BitValues = num32BitValues;
+        return r;
+    }
+    constexpr RootSignatureLayout Table(ShaderVisibility visibility, std::initializer_list<DescriptorRange> ranges) const {
+        RootSignatureLayout r = *this;
+        if (r.parameterCount == kMaxRootParameters || ranges.size() > kMaxDescriptorRanges) {
+            r.overflow = true;
+            return r;
+        }
+        RootParameter& p = r.parameters[r.parameterCount++];
+        p = RootParameter{};
+        p.type = RootParameterType::DescriptorTable;
+        p.visibility = visibility;
+        for (const DescriptorRange& range : ranges) p.ranges[p.rangeCount++] = range;
+        return r;
+    }
+    constexpr RootSignatureLayout Sampler(const StaticSampler& sampler) const {
+        RootSignatureLayout r = *this;
+        if (r.samplerCount == kMaxStaticSamplers) r.overflow = true;
+        else r.samplers[r.samplerCount++] = sampler;
+        return r;
+    }
+
+    // 入り切っている・空のテーブルが無い・同じ種類（b/t/u/s）と空間のレジスターが、同じシェーダーから見えるところで重なっていない
+    constexpr bool IsValid() const {
+        if (overflow) return false;
+        Binding_ bindings[kMaxRootParameters * kMaxDescriptorRanges + kMaxStaticSamplers] = {};
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < parameterCount; ++i) {
+            const RootParameter& p = parameters[i];
+            if (p.type == RootParameterType::DescriptorTable) {
+                if (p.rangeCount == 0) return false;
+                bool sampler = false, other = false;
+                for (uint32_t j = 0; j < p.rangeCount; ++j) {
+                    const DescriptorRange& range = p.ranges[j];
+                    if (range.count == 0 || (range.count == kUnboundedDescriptors && j + 1 != p.rangeCount)) return false;
+                    (range.type == DescriptorRangeType::Sampler ? sampler : other) = true;
+                    bindings[count++] = { rangeClass_(range.type), range.space, range.baseRegister, range.count, p.visibility };
+                }
+                if (sampler && other) return false; // サンプラーと他のビューは同じテーブルに置けない
+            } else {
+                bindings[count++] = { parameterClass_(p.type), p.space, p.shaderRegister, 1, p.visibility };
+            }
+        }
+        for (uint32_t i = 0; i < samplerCount; ++i) {
+            const StaticSampler& s = samplers[i];
+            bindings[count++] = { 3, s.space, s.shaderRegister, 1, s.visibility };
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            for (uint32_t j = i + 1; j < count; ++j) {
+                if (bindings[i].Overlaps(bindings[j])) return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Binding_ {
+        uint32_t registerClass = 0; // 0 = b, 1 = t, 2 = u, 3 = s
+        uint32_t space = 0;
+        uint32_t base = 0;
+        uint32_t count = 0;
+        ShaderVisibility visibility = ShaderVisibility::All;
+
+        constexpr bool Overlaps(const Binding_& o) const {
+            if (registerClass != o.registerClass || space != o.space) return false;
+            if (visibility != o.visibility && visibility != ShaderVisibility::All && o.visibility != ShaderVisibility::All) return false;
+            const uint64_t end = count == kUnboundedDescriptors ? UINT64_MAX : uint64_t(base) + count;
+            const uint64_t oEnd = o.count == kUnboundedDescriptors ? UINT64_MAX : uint64_t(o.base) + o.count;
+            return base < oEnd && o.base < end;
+        }
+    };
+
+    static constexpr uint32_t rangeClass_(DescriptorRangeType type) {
+        switch (type) {
+        case DescriptorRangeType::Cbv: return 0;
+        case DescriptorRangeType::Srv: return 1;
+        case DescriptorRangeType::Uav: return 2;
+        default: return 3;
+        }
+    }
+    static constexpr uint32_t parameterClass_(RootParameterType type) {
+        switch (type) {
+        case RootParameterType::Srv: return 1;
+        case RootParameterType::Uav: return 2;
+        default: return 0; // Cbv / Constants
+        }
+    }
+
+    constexpr RootSignatureLayout withDescriptor_(RootParameterType type, uint32_t reg, ShaderVisibility visibility, uint32_t space) const {
+        RootSignatureLayout r = *this;
+        if (r.parameterCount == kMaxRootParameters) {
+            r.overflow = true;
+            return r;
+        }
+        RootParameter& p = r.parameters[r.parameterCount++];
+        p = RootParameter{};
+        p.type = type;
+        p.visibility = visibility;
+        p.shaderRegister = reg;
+        p.space = space;
+        return r;
+    }
+};
+
+} // namespace jisaku
@@ -0,0 +1,258 @@
+#include "core/SceneFile.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+using namespace jisaku;
+
+static_assert(std::endian::native == std::endian::little, "scene files are little-endian");
+static_assert(sizeof(void*) == 8, "scene fixup stores 64-bit addresses in place of offsets");
+static_assert(sizeof(Float3) == 12 && sizeof(Quat) == 16, "scene arrays are written as raw memory");
+
+namespace {
+
+constexpr char kSceneMagic[4] = { 'J', 'S', 'C', 'N' };
+constexpr uint32_t kSceneVersion = 1;
+constexpr uint64_t kSceneAlign = 16;
+
+// オフセット（またはロード後のアドレス）は u64 で持つ
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t fileSize;
+    uint64_t entityCount;
+    uint32_t blockCount;
+    uint32_t textureCount;
+    uint64_t blocks;
+    uint64_t textures;
+    uint64_t strings;
+    uint64_t stringsSize;
+};
+static_assert(sizeof(FileHeader) == 64);
+
+uint64_t AlignUp(uint64_t v, uint64_t a) { return (v + a - 1) & ~(a - 1); }
+
+// [offset, offset + count * size) がファイル内に収まり、align に揃っているか
+bool InRange(uint64_t offset, uint64_t count, uint64_t size, uint64_t align, uint64_t fileSize) {
+    if (offset % align != 0 || offset > fileSize) return false;
+    return count <= (fileSize - offset) / size;
+}
+
+} // namespace
+
+struct SceneFile::Block_ {
+    uint32_t first;
+    uint32_t count;
+    uint64_t position;
+    uint64_t rotation;
+    uint64_t scale;
+    uint64_t texture;
+    uint64_t parent;
+};
+
+struct SceneFile::Texture_ {
+    uint64_t assetHash;
+    uint64_t path;
+    uint32_t pathLength;
+    uint32_t reserved;
+};
+
+bool SceneFile::Open(const std::filesystem::path& file) {
+    static_assert(sizeof(Block_) == 48 && sizeof(Texture_) == 24);
+    Close();
+    std::shared_ptr<MappedFile> mapped = MappedFile::Open(file);
+    if (!mapped) return false;
+    uint8_t* base = mapped->GetData();
+    const uint64_t size = mapped->GetSize();
+
+    if (size < sizeof(FileHeader)) return false;
+    const FileHeader& h = *reinterpret_cast<const FileHeader*>(base);
+    if (std::memcmp(h.magic, kSceneMagic, 4) != 0 || h.version != kSceneVersion || h.fileSize != size) return false;
+    if (h.entityCount >= kNoEntity) return false;
+    if (!InRange(h.blocks, h.blockCount, sizeof(Block_), alignof(Block_), size) ||
+        !InRange(h.textures, h.textureCount, sizeof(Texture_), alignof(Texture_), size) ||
+        !InRange(h.strings, h.stringsSize, 1, 1, size))
+        return false;
+
+    // 目次だけを付け替える（成分配列のページには触らないので、コピーオンライトで複製されるのは目次のページだけ）
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(base);
+    Block_* blocks = reinterpret_cast<Block_*>(base + h.blocks);
+    uint64_t next = 0;
+    for (uint32_t i = 0; i < h.blockCount; ++i) {
+        Block_& b = blocks[i];
+        if (b.first != next || b.count == 0 || b.count > kSceneBlockSize) return false;
+        next += b.count;
+        if (!InRange(b.position, b.count, sizeof(Float3), alignof(Float3), size) ||
+            !InRange(b.rotation, b.count, sizeof(Quat), alignof(Quat), size) ||
+            !InRange(b.scale, b.count, sizeof(Float3), alignof(Float3), size) ||
+            !InRange(b.texture, b.count, sizeof(uint32_t), alignof(uint32_t), size) ||
+            !InRange(b.parent, b.count, sizeof(uint32_t), alignof(uint32_t), size))
+            return false;
+        b.position += addr;
+        b.rotation += addr;
+        b.scale += addr;
+        b.texture += addr;
+        b.parent += addr;
+    }
+    if (next != h.entityCount) return false;
+
+    Texture_* textures = reinterpret_cast<Texture_*>(base + h.textures);
+    for (uint32_t i = 0; i < h.textureCount; ++i) {
+        Texture_& t = textures[i];
+        if (t.path < h.strings || !InRange(t.path, t.pathLength, 1, 1, h.strings + h.stringsSize)) return false;
+        t.path += addr;
+    }
+
+    m_file = std::move(mapped);
+    m_blocks = blocks;
+    m_textures = textures;
+    m_entityCount = h.entityCount;
+    m_blockCount = h.blockCount;
+    m_textureCount = h.textureCount;
+    return true;
+}
+
+void SceneFile::Close() {
+    m_file.reset();
+    m_blocks = nullptr;
+    m_textures = nullptr;
+    m_entityCount = 0;
+    m_blockCount = 0;
+    m_textureCount = 0;
+    m_textureRemap.clear();
+    m_target = nullptr;
+    m_targetBase = 0;
+}
+
+SceneBlockView SceneFile::GetBlock(uint32_t index) const {
+    const Block_& b = m_blocks[index];
+    SceneBlockView v;
+    v.first = b.first;
+    v.count = b.count;
+    v.position = reinterpret_cast<const Float3*>(uintptr_t(b.position));
+    v.rotation = reinterpret_cast<const Quat*>(uintptr_t(b.rotation));
+    v.scale = reinterpret_cast<const Float3*>(uintptr_t(b.scale));
+    v.texture = reinterpret_cast<const uint32_t*>(uintptr_t(b.texture));
+    v.parent = reinterpret_cast<const uint32_t*>(uintptr_t(b.parent));
+    return v;
+}
+
+uint64_t SceneFile::GetTextureHash(uint32_t index) const {
+    return m_textures[index].assetHash;
+}
+
+std::string_view SceneFile::GetTexturePath(uint32_t index) const {
+    const Texture_& t = m_textures[index];
+    return std::string_view(reinterpret_cast<const char*>(uintptr_t(t.path)), t.pathLength);
+}
+
+bool SceneFile::StreamInto(EntityStore& store, uint32_t firstBlock, uint32_t blockCount) {
+    if (!m_file || firstBlock > m_blockCount || blockCount > m_blockCount - firstBlock) return false;
+    // 添字の範囲は store に触れる前に取り込む全ブロック分を確かめる（不正なファイルで store を途中まで書き換えない）
+    for (uint32_t i = firstBlock; i < firstBlock + blockCount; ++i) {
+        const SceneBlockView b = GetBlock(i);
+        for (uint32_t e = 0; e < b.count; ++e) {
+            if ((b.texture[e] != kNoTexture && b.texture[e] >= m_textureCount) ||
+                (b.parent[e] != kNoEntity && b.parent[e] >= m_entityCount))
+                return false;
+        }
+    }
+
+    if (firstBlock == 0 || m_target != &store) {
+        // シーンの取り込み開始: テクスチャ表を store 側の添字に対応付け、全エンティティ分を先に確保する
+        const uint32_t base = uint32_t(store.Size());
+        if (uint64_t(base) + m_entityCount >= kNoEntity) return false;
+        m_target = &store;
+        m_targetBase = base;
+        m_textureRemap.resize(m_textureCount);
+        for (uint32_t i = 0; i < m_textureCount; ++i) m_textureRemap[i] = store.AddTexture(GetTextureHash(i), GetTexturePath(i));
+        store.Reserve(size_t(m_targetBase) + size_t(m_entityCount));
+    }
+
+    for (uint32_t i = firstBlock; i < firstBlock + blockCount; ++i) {
+        const SceneBlockView b = GetBlock(i);
+        store.Append(b.count, b.position, b.rotation, b.scale, b.texture, b.parent, m_targetBase, m_textureRemap.data());
+    }
+    return true;
+}
+
+bool jisaku::WriteScene(const std::filesystem::path& file, const EntityStore& store) {
+    const uint64_t entityCount = store.Size();
+    if (entityCount >= kNoEntity) return false;
+    const uint32_t blockCount = uint32_t((entityCount + kSceneBlockSize - 1) / kSceneBlockSize);
+    const std::vector<TextureRef>& textures = store.GetTextures();
+
+    // 配置を先に決める
+    FileHeader h{};
+    std::memcpy(h.magic, kSceneMagic, 4);
+    h.version = kSceneVersion;
+    h.entityCount = entityCount;
+    h.blockCount = blockCount;
+    h.textureCount = uint32_t(textures.size());
+    h.blocks = sizeof(FileHeader);
+    h.textures = h.blocks + uint64_t(blockCount) * sizeof(SceneFile::Block_);
+    h.strings = h.textures + uint64_t(textures.size()) * sizeof(SceneFile::Texture_);
+    for (const TextureRef& t : textures) h.stringsSize += t.path.size();
+
+    std::vector<SceneFile::Block_> blocks(blockCount);
+    uint64_t pos = AlignUp(h.strings + h.stringsSize, kSceneAlign);
+    auto place = [&pos](uint64_t bytes) {
+        const uint64_t at = pos;
+        pos = AlignUp(pos + bytes, kSceneAlign);
+        return at;
+    };
+    for (uint32_t i = 0; i < blockCount; ++i) {
+        SceneFile::Block_& b = blocks[i];
+        b.first = i * kSceneBlockSize;
+        b.count = uint32_t(std::min<uint64_t>(kSceneBlockSize, entityCount - b.first));
+        b.position = place(uint64_t(b.count) * sizeof(Float3));
+        b.rotation = place(uint64_t(b.count) * sizeof(Quat));
+        b.scale = place(uint64_t(b.count) * sizeof(Float3));
+        b.texture = place(uint64_t(b.count) * sizeof(uint32_t));
+        b.parent = place(uint64_t(b.count) * sizeof(uint32_t));
+    }
+    h.fileSize = pos;
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    uint64_t written = 0;
+    auto write = [&](const void* data, uint64_t bytes) {
+        out.write(static_cast<const char*>(data), std::streamsize(bytes));
+        written += bytes;
+    };
+    auto padTo = [&](uint64_t at) {
+        static const char zeros[kSceneAlign] = {};
+        write(zeros, at - written);
+    };
+
+    write(&h, sizeof(h));
+    write(blocks.data(), blocks.size() * sizeof(SceneFile::Block_));
+    uint64_t stringPos = h.strings;
+    for (const TextureRef& t : textures) {
+        SceneFile::Texture_ ft{ t.assetHash, stringPos, uint32_t(t.path.size()), 0 };
+        write(&ft, sizeof(ft));
+        stringPos += t.path.size();
+    }
+    for (const TextureRef& t : textures) write(t.path.data(), t.path.size());
+
+    for (const SceneFile::Block_& b : blocks) {
+        padTo(b.position);
+        write(store.Positions() + b.first, uint64_t(b.count) * sizeof(Float3));
+        padTo(b.rotation);
+        write(store.Rotations() + b.first, uint64_t(b.count) * sizeof(Quat));
+        padTo(b.scale);
+        write(store.Scales() + b.first, uint64_t(b.count) * sizeof(Float3));
+        padTo(b.texture);
+        write(store.Textures() + b.first, uint64_t(b.count) * sizeof(uint32_t));
+        padTo(b.parent);
+        write(store.Parents() + b.first, uint64_t(b.count) * sizeof(uint32_t));
+    }
+    padTo(h.fileSize);
+    return bool(out);
+}
+
+bool jisaku::LoadScene(const std::filesystem::path& file, EntityStore& store) {
+    SceneFile scene;
+    return scene.Open(file) && scene.StreamInto(store);
+}
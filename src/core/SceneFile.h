@@ -0,0 +1,72 @@
+#pragma once
+#include "core/EntityStore.h"
+#include "core/MappedFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace jisaku {
+
+// バイナリのシーンファイル（.jscn、リトルエンディアン・64bit 前提）。
+//   ヘッダ 64 byte → ブロック表 → テクスチャ表 → 文字列 → 各ブロックの成分配列（SoA、16 byte 境界）
+// ファイル内の参照はすべて先頭からのオフセットで持ち、ロード時にマップした領域の中で実アドレスへ書き換える。
+// エンティティは kSceneBlockSize 個ずつのブロックに分け、ブロックごとに position/rotation/scale/texture/parent の配列を持つ。
+// texture はファイル内テクスチャ表の添字、parent はファイル内のエンティティ番号
+constexpr uint32_t kSceneBlockSize = 16 * 1024;
+
+struct SceneBlockView {
+    uint32_t first = 0; // ファイル内のエンティティ番号
+    uint32_t count = 0;
+    const Float3* position = nullptr;
+    const Quat* rotation = nullptr;
+    const Float3* scale = nullptr;
+    const uint32_t* texture = nullptr;
+    const uint32_t* parent = nullptr;
+};
+
+// マップしたシーンファイル。エンティティ単位の確保はせず、配列はマップした領域を直接指す
+class SceneFile {
+public:
+    // マップ 1 回と目次の付け替え（オフセット→ポインタ）だけを行う。範囲・整列が不正なら失敗
+    bool Open(const std::filesystem::path& file);
+    void Close();
+
+    uint64_t GetEntityCount() const { return m_entityCount; }
+    uint32_t GetBlockCount() const { return m_blockCount; }
+    SceneBlockView GetBlock(uint32_t index) const;
+    uint32_t GetTextureCount() const { return m_textureCount; }
+    uint64_t GetTextureHash(uint32_t index) const;
+    std::string_view GetTexturePath(uint32_t index) const;
+
+    // ブロック [firstBlock, firstBlock + blockCount) を store の末尾へ取り込む。添字が不正なら store には何も追加せず失敗する。
+    // 1 つのシーンは同じ store へ先頭ブロックから順に取り込むこと（parent をシーン先頭の位置からの添字に直すため）
+    bool StreamInto(EntityStore& store, uint32_t firstBlock, uint32_t blockCount);
+    // 全ブロックを取り込む
+    bool StreamInto(EntityStore& store) { return StreamInto(store, 0, m_blockCount); }
+
+private:
+    struct Block_;
+    struct Texture_;
+    friend bool WriteScene(const std::filesystem::path& file, const EntityStore& store);
+
+    std::shared_ptr<MappedFile> m_file;
+    const Block_* m_blocks = nullptr;
+    const Texture_* m_textures = nullptr;
+    uint64_t m_entityCount = 0;
+    uint32_t m_blockCount = 0;
+    uint32_t m_textureCount = 0;
+    // StreamInto 用: ファイル内の添字 → store の添字
+    std::vector<uint32_t> m_textureRemap;
+    EntityStore* m_target = nullptr;
+    uint32_t m_targetBase = 0;
+};
+
+// store の全エンティティを書き出す
+bool WriteScene(const std::filesystem::path& file, const EntityStore& store);
+
+// Open + StreamInto。store の既存エンティティの後ろに追加する
+bool LoadScene(const std::filesystem::path& file, EntityStore& store);
+
+} // namespace jisaku
@@ -0,0 +1,258 @@
+#include "core/ShaderCache.h"
+#include "core/AtomicFile.h"
+#include "core/ByteOrder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+using namespace jisaku;
+
+namespace {
+
+constexpr char kMagic[4] = { 'J', 'S', 'H', 'C' };
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kMaxIncludeDepth = 32;
+
+uint64_t Checksum(const void* data, size_t size) {
+    return HashContent(data, size).lo;
+}
+
+std::string NormalizePath(const std::string& path) {
+    const std::u8string u8 = std::filesystem::path(std::u8string(path.begin(), path.end())).lexically_normal().generic_u8string();
+    return std::string(u8.begin(), u8.end());
+}
+
+std::string ParentDirectory(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash);
+}
+
+std::string JoinPath(const std::string& dir, const std::string& name) {
+    return NormalizePath(dir.empty() ? name : dir + "/" + name);
+}
+
+// コメント・文字列の外で "#" から始まる行を前処理指令として扱う。
+// ブロックコメントの中の #include は無視する（line の後で inComment を更新する）
+bool ScanComment(std::string_view line, bool& inComment) {
+    bool startsInComment = inComment;
+    bool inString = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        const char n = i + 1 < line.size() ? line[i + 1] : '\0';
+        if (inComment) {
+            if (c == '*' && n == '/') {
+                inComment = false;
+                ++i;
+            }
+        } else if (inString) {
+            if (c == '\\') ++i;
+            else if (c == '"') inString = false;
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '/' && n == '/') {
+            break;
+        } else if (c == '/' && n == '*') {
+            inComment = true;
+            ++i;
+        }
+    }
+    return startsInComment;
+}
+
+// "#  include" / "#pragma once" の判定。include なら name に中身を入れる
+enum class Directive { None, Include, PragmaOnce };
+
+Directive ParseDirective(std::string_view line, std::string& name) {
+    size_t i = line.find_first_not_of(" \t");
+    if (i == std::string_view::npos || line[i] != '#') return Directive::None;
+    i = line.find_first_not_of(" \t", i + 1);
+    if (i == std::string_view::npos) return Directive::None;
+    const std::string_view rest = line.substr(i);
+    if (rest.rfind("include", 0) == 0) {
+        const size_t open = rest.find_first_of("\"<", 7);
+        if (open == std::string_view::npos) return Directive::None;
+        const size_t close = rest.find(rest[open] == '"' ? '"' : '>', open + 1);
+        if (close == std::string_view::npos) return Directive::None;
+        name = std::string(rest.substr(open + 1, close - open - 1));
+        return Directive::Include;
+    }
+    if (rest.rfind("pragma", 0) == 0) {
+        const size_t once = rest.find_first_not_of(" \t", 6);
+        if (once != std::string_view::npos && rest.compare(once, 4, "once") == 0) return Directive::PragmaOnce;
+    }
+    return Directive::None;
+}
+
+struct Expander {
+    const ShaderFileReader& read;
+    const std::vector<std::string>& includeDirs;
+    ShaderSource& out;
+    std::string& error;
+    std::vector<std::string> stack;
+    std::unordered_set<std::string> once;
+
+    bool Expand(const std::string& path, const std::string& text) {
+        if (stack.size() >= kMaxIncludeDepth) {
+            error = path + ": includes nested too deeply";
+            return false;
+        }
+        stack.push_back(path);
+        if (std::find(out.files.begin(), out.files.end(), path) == out.files.end()) out.files.push_back(path);
+        out.text += "#line 1 \"" + path + "\"\n";
+
+        bool inComment = false;
+        size_t lineNo = 0;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string::npos) end = text.size();
+            std::string_view line(text.data() + pos, end - pos);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            pos = end + 1;
+            ++lineNo;
+
+            std::string name;
+            const bool commented = ScanComment(line, inComment);
+            const Directive d = commented ? Directive::None : ParseDirective(line, name);
+            if (d == Directive::PragmaOnce) {
+                once.insert(path);
+                out.text += '\n'; // 行番号を保つ
+                continue;
+            }
+            if (d != Directive::Include) {
+                out.text.append(line);
+                out.text += '\n';
+                continue;
+            }
+
+            std::string resolved, contents;
+            if (!resolve_(path, name, resolved, contents)) {
+                error = path + "(" + std::to_string(lineNo) + "): cannot open include file " + name;
+                return false;
+            }
+            if (std::find(stack.begin(), stack.end(), resolved) != stack.end()) {
+                error = path + "(" + std::to_string(lineNo) + "): recursive include of " + resolved;
+                return false;
+            }
+            if (once.count(resolved)) {
+                out.text += '\n';
+                continue;
+            }
+            if (!Expand(resolved, contents)) return false;
+            out.text += "#line " + std::to_string(lineNo + 1) + " \"" + path + "\"\n";
+        }
+        stack.pop_back();
+        return true;
+    }
+
+    bool resolve_(const std::string& from, const std::string& name, std::string& resolved, std::string& contents) {
+        resolved = JoinPath(ParentDirectory(from), name);
+        if (read(resolved, contents)) return true;
+        for (const std::string& dir : includeDirs) {
+            resolved = JoinPath(dir, name);
+            if (read(resolved, contents)) return true;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+ShaderCache::ShaderCache(const std::filesystem::path& directory) : m_directory(directory) {}
+
+bool ShaderCache::Load(const ContentKey& key, std::vector<uint8_t>& bytecode) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    std::ifstream in(ContentObjectPath(m_directory, key), std::ios::binary);
+    if (!in) {
+        ++m_misses;
+        return false;
+    }
+    uint8_t header[kHeaderSize];
+    bool ok = bool(in.read(reinterpret_cast<char*>(header), sizeof(header))) &&
+              std::memcmp(header, kMagic, 4) == 0 && ReadU32(header + 4) == kVersion;
+    if (ok) {
+        const uint64_t size = ReadU64(header + 8);
+        ok = size < (uint64_t(1) << 31);
+        if (ok) {
+            bytecode.resize(size_t(size));
+            ok = (size == 0 || in.read(reinterpret_cast<char*>(bytecode.data()), std::streamsize(size))) &&
+                 in.peek() == std::char_traits<char>::eof() &&
+                 Checksum(bytecode.data(), bytecode.size()) == ReadU64(header + 16);
+        }
+    }
+    if (!ok) {
+        ++m_corrupt;
+        ++m_misses;
+        bytecode.clear();
+        return false;
+    }
+    ++m_hits;
+    m_loadNs += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    return true;
+}
+
+bool ShaderCache::Store(const ContentKey& key, const void* data, size_t size) {
+    const std::filesystem::path object = ContentObjectPath(m_directory, key);
+    std::error_code ec;
+    std::filesystem::create_directories(object.parent_path(), ec);
+    uint8_t header[kHeaderSize] = {};
+    std::memcpy(header, kMagic, 4);
+    WriteU32(header + 4, kVersion);
+    WriteU64(header + 8, size);
+    WriteU64(header + 16, Checksum(data, size));
+    const bool written = WriteFileAtomic(object, [&](std::ostream& out) {
+        return out.write(reinterpret_cast<const char*>(header), sizeof(header)) &&
+               out.write(static_cast<const char*>(data), std::streamsize(size));
+    });
+    if (!written) return false;
+    ++m_stores;
+    return true;
+}
+
+ShaderCache::Stats ShaderCache::GetStats() const {
+    Stats s;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    s.stores = m_stores;
+    s.corrupt = m_corrupt;
+    s.loadMs = double(m_loadNs.load()) / 1e6;
+    return s;
+}
+
+bool jisaku::ExpandShaderIncludes(const std::string& path, const ShaderFileReader& read,
+                                  const std::vector<std::string>& includeDirs, ShaderSource& out, std::string& error) {
+    out = ShaderSource{};
+    const std::string main = NormalizePath(path);
+    std::string text;
+    if (!read(main, text)) {
+        error = "cannot open " + main;
+        return false;
+    }
+    Expander expander{ read, includeDirs, out, error, {}, {} };
+    return expander.Expand(main, text);
+}
+
+ContentKey jisaku::MakeShaderCacheKey(const ShaderKeyDesc& desc) {
+    // ソースは先に単独でハッシュし、残りの項目と合わせてもう一度ハッシュする（ソースをコピーしない）
+    const ContentKey source = HashContent(desc.source.data(), desc.source.size());
+    std::string s = "JSHC1";
+    auto field = [&](std::string_view v) {
+        s += '\0';
+        s.append(v);
+    };
+    field(desc.compiler);
+    field(desc.args);
+    field(desc.target);
+    field(desc.entry);
+    field(std::to_string(desc.defines ? desc.defines->size() : 0));
+    if (desc.defines) {
+        for (const std::string& d : *desc.defines) field(d);
+    }
+    s += '\0';
+    s.append(reinterpret_cast<const char*>(&source), sizeof(source));
+    return HashContent(s.data(), s.size());
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "core/AssetManifest.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jisaku {
+
+// シェーダーのバイトコードのディスクキャッシュ（D3D/Windows 非依存）。
+// キーは「#include を展開したソース + エントリポイント + ターゲット + define + コンパイラのバージョンと引数」のハッシュで、
+// どれかが変われば別のキーになるので明示的な無効化は要らない（古いエントリは残るだけ）。
+// 置き場所: <ディレクトリ>/<キー先頭 2 桁>/<キー 32 桁>
+//   ヘッダ 32 byte : "JSHC", version(u32), size(u64), checksum(u64: 中身の XXH3 下位 64bit), 予約(u64)
+//   中身           : バイトコード
+// 壊れたファイル（途中で落ちた・ディスクの破損）はミス扱いにして作り直す
+class ShaderCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t corrupt = 0;
+        double loadMs = 0.0; // ヒットしたときの読み込みにかかった合計
+    };
+
+    explicit ShaderCache(const std::filesystem::path& directory);
+
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    // ヒットしたら bytecode に入れて true
+    bool Load(const ContentKey& key, std::vector<uint8_t>& bytecode);
+    // 一時ファイルに書いてから置き換える（同じキーを複数プロセスが同時に書いてもよい）
+    bool Store(const ContentKey& key, const void* data, size_t size);
+
+    Stats GetStats() const;
+    const std::filesystem::path& GetDirectory() const { return m_directory; }
+
+private:
+    std::filesystem::path m_directory;
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+    std::atomic<uint64_t> m_stores{ 0 };
+    std::atomic<uint64_t> m_corrupt{ 0 };
+    std::atomic<uint64_t> m_loadNs{ 0 };
+};
+
+// #include を再帰的に展開した 1 本のソース。ファイルの境目には #line を入れるので、エラーの行番号は元のファイルのまま
+struct ShaderSource {
+    std::string text;
+    std::vector<std::string> files; // 読んだファイル（先頭がメイン。ホットリロードの監視対象）
+};
+
+// path（'/' 区切り）の中身を out に読む
+using ShaderFileReader = std::function<bool(const std::string& path, std::string& out)>;
+
+// #include "x" / <x> は、取り込み元と同じディレクトリ → includeDirs の順に探す。
+// #pragma once のあるファイルは 2 回目以降を取り込まない。循環していたら失敗
+bool ExpandShaderIncludes(const std::string& path, const ShaderFileReader& read,
+                          const std::vector<std::string>& includeDirs, ShaderSource& out, std::string& error);
+
+struct ShaderKeyDesc {
+    std::string_view source;  // ExpandShaderIncludes の text
+    std::string_view entry;
+    std::string_view target;
+    const std::vector<std::string>* defines = nullptr; // "NAME=VALUE"（順序も区別する）
+    std::string_view compiler; // コンパイラのバージョン
+    std::string_view args;     // その他の引数（最適化・デバッグ情報等）
+};
+
+ContentKey MakeShaderCacheKey(const ShaderKeyDesc& desc);
+
+} // namespace jisaku
@@ -0,0 +1,325 @@
+#include "core/ShaderPack.h"
+#include "core/AssetManifest.h"
+#include "core/AtomicFile.h"
+#include "core/ByteOrder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace jisaku;
+
+namespace {
+
+constexpr char kMagic[4] = { 'J', 'S', 'P', 'K' };
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kDataAlign = 16;
+
+struct Writer {
+    std::vector<uint8_t>& out;
+
+    void U32(uint32_t v) {
+        const size_t at = out.size();
+        out.resize(at + 4);
+        WriteU32(out.data() + at, v);
+    }
+    void U64(uint64_t v) {
+        const size_t at = out.size();
+        out.resize(at + 8);
+        WriteU64(out.data() + at, v);
+    }
+    void Str(std::string_view s) {
+        U32(uint32_t(s.size()));
+        out.insert(out.end(), s.begin(), s.end());
+    }
+};
+
+// 範囲外を読もうとしたら以降はすべて失敗にする
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    bool Need(size_t n) {
+        if (!ok || size_t(end - p) < n) ok = false;
+        return ok;
+    }
+    uint32_t U32() {
+        if (!Need(4)) return 0;
+        const uint32_t v = ReadU32(p);
+        p += 4;
+        return v;
+    }
+    uint64_t U64() {
+        if (!Need(8)) return 0;
+        const uint64_t v = ReadU64(p);
+        p += 8;
+        return v;
+    }
+    std::string Str() {
+        const uint32_t n = U32();
+        if (!Need(n)) return {};
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+};
+
+void WriteEntry(Writer& w, const ShaderPackEntry& e) {
+    w.U64(e.id);
+    w.U64(e.offset);
+    w.U64(e.size);
+    w.Str(e.path);
+    w.Str(e.entry);
+    w.Str(e.target);
+    w.U32(uint32_t(e.defines.size()));
+    for (const std::string& d : e.defines) w.Str(d);
+    w.U32(uint32_t(e.reflection.inputs.size()));
+    for (const ShaderSignatureElement& in : e.reflection.inputs) {
+        w.Str(in.semantic);
+        w.U32(in.index);
+        w.U32(in.reg);
+        w.Str(in.mask);
+        w.Str(in.format);
+    }
+    w.U32(uint32_t(e.reflection.bindings.size()));
+    for (const ShaderBinding& b : e.reflection.bindings) {
+        w.Str(b.name);
+        w.Str(b.type);
+        w.U32(uint32_t(uint8_t(b.registerClass)));
+        w.U32(b.slot);
+        w.U32(b.space);
+        w.U32(b.count);
+    }
+}
+
+bool ReadEntry(Reader& r, ShaderPackEntry& e) {
+    e.id = r.U64();
+    e.offset = r.U64();
+    e.size = r.U64();
+    e.path = r.Str();
+    e.entry = r.Str();
+    e.target = r.Str();
+    // 個数は残りのバイト数で抑える（壊れたファイルで巨大な確保をしない）
+    const uint32_t defines = r.U32();
+    if (!r.Need(size_t(defines) * 4)) return false;
+    e.defines.resize(defines);
+    for (std::string& d : e.defines) d = r.Str();
+    const uint32_t inputs = r.U32();
+    if (!r.Need(size_t(inputs) * 16)) return false;
+    e.reflection.inputs.resize(inputs);
+    for (ShaderSignatureElement& in : e.reflection.inputs) {
+        in.semantic = r.Str();
+        in.index = r.U32();
+        in.reg = r.U32();
+        in.mask = r.Str();
+        in.format = r.Str();
+    }
+    const uint32_t bindings = r.U32();
+    if (!r.Need(size_t(bindings) * 24)) return false;
+    e.reflection.bindings.resize(bindings);
+    for (ShaderBinding& b : e.reflection.bindings) {
+        b.name = r.Str();
+        b.type = r.Str();
+        b.registerClass = char(r.U32());
+        b.slot = r.U32();
+        b.space = r.U32();
+        b.count = r.U32();
+    }
+    return r.ok;
+}
+
+uint32_t ParseUInt(std::string_view s) {
+    uint32_t v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') break;
+        v = v * 10 + uint32_t(c - '0');
+    }
+    return v;
+}
+
+std::vector<std::string_view> SplitWords(std::string_view line) {
+    std::vector<std::string_view> words;
+    size_t i = 0;
+    while (true) {
+        i = line.find_first_not_of(" \t", i);
+        if (i == std::string_view::npos) break;
+        const size_t end = std::min(line.find_first_of(" \t", i), line.size());
+        words.push_back(line.substr(i, end - i));
+        i = end;
+    }
+    return words;
+}
+
+// "cb0" / "t3" / "t0,space1"
+bool ParseBindPoint(std::string_view bind, ShaderBinding& b) {
+    const size_t comma = bind.find(',');
+    const std::string_view reg = bind.substr(0, comma);
+    if (reg.rfind("cb", 0) == 0) {
+        b.registerClass = 'b';
+        b.slot = ParseUInt(reg.substr(2));
+    } else if (!reg.empty() && (reg[0] == 't' || reg[0] == 's' || reg[0] == 'u' || reg[0] == 'b')) {
+        b.registerClass = reg[0];
+        b.slot = ParseUInt(reg.substr(1));
+    } else {
+        return false;
+    }
+    if (comma != std::string_view::npos) {
+        const std::string_view space = bind.substr(comma + 1);
+        if (space.rfind("space", 0) == 0) b.space = ParseUInt(space.substr(5));
+    }
+    return true;
+}
+
+} // namespace
+
+bool jisaku::ParseDxilReflection(std::string_view disassembly, ShaderReflection& out) {
+    enum class Section { None, Inputs, Bindings };
+    Section section = Section::None;
+    out = {};
+    size_t pos = 0;
+    while (pos < disassembly.size()) {
+        size_t end = disassembly.find('\n', pos);
+        if (end == std::string_view::npos) end = disassembly.size();
+        std::string_view line = disassembly.substr(pos, end - pos);
+        pos = end + 1;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        // 表はすべて先頭のコメントの中。コードが始まったら終わり
+        if (line.empty() || line[0] != ';') {
+            if (!out.inputs.empty() || !out.bindings.empty()) break;
+            continue;
+        }
+        line.remove_prefix(1);
+        const std::vector<std::string_view> words = SplitWords(line);
+        if (words.empty()) continue;
+        if (words.size() >= 2 && words[1] == "signature:") {
+            section = words[0] == "Input" ? Section::Inputs : Section::None;
+            continue;
+        }
+        if (words.size() == 2 && words[0] == "Resource" && words[1] == "Bindings:") {
+            section = Section::Bindings;
+            continue;
+        }
+        if (words.back().back() == ':') {
+            section = Section::None; // 別の表（Buffer Definitions 等）
+            continue;
+        }
+        if (section == Section::None || words[0] == "Name" || words[0][0] == '-' || words[0] == "no") continue;
+
+        if (section == Section::Inputs) {
+            // Name Index Mask Register SysValue Format [Used]
+            if (words.size() < 6) continue;
+            ShaderSignatureElement e;
+            e.semantic = std::string(words[0]);
+            e.index = ParseUInt(words[1]);
+            e.mask = std::string(words[2]);
+            e.reg = ParseUInt(words[3]);
+            e.format = std::string(words[5]);
+            out.inputs.push_back(std::move(e));
+        } else {
+            // Name Type Format Dim ID HLSLBind Count
+            if (words.size() < 7) continue;
+            ShaderBinding b;
+            b.name = std::string(words[0]);
+            b.type = std::string(words[1]);
+            if (!ParseBindPoint(words[5], b)) continue;
+            b.count = words[6] == "unbounded" ? 0 : ParseUInt(words[6]);
+            out.bindings.push_back(std::move(b));
+        }
+    }
+    return true;
+}
+
+uint64_t jisaku::MakeShaderId(std::string_view path, std::string_view entry, const std::vector<std::string>& defines) {
+    std::vector<std::string> sorted = defines;
+    std::sort(sorted.begin(), sorted.end());
+    std::string text;
+    text.append(path);
+    text += '\0';
+    text.append(entry);
+    for (const std::string& d : sorted) {
+        text += '\0';
+        text += d;
+    }
+    return HashContent(text.data(), text.size()).lo;
+}
+
+bool ShaderPack::Load(std::vector<uint8_t> bytes) {
+    m_bytes.clear();
+    m_entries.clear();
+    m_index.clear();
+    m_dataOffset = 0;
+    if (bytes.size() < kHeaderSize || std::memcmp(bytes.data(), kMagic, 4) != 0) return false;
+    if (ReadU32(bytes.data() + 4) != kVersion) return false;
+    const uint32_t count = ReadU32(bytes.data() + 8);
+    const uint64_t dataOffset = ReadU64(bytes.data() + 16);
+    const uint64_t checksum = ReadU64(bytes.data() + 24);
+    if (dataOffset < kHeaderSize || dataOffset > bytes.size()) return false;
+    if (HashContent(bytes.data() + kHeaderSize, bytes.size() - kHeaderSize).lo != checksum) return false;
+
+    std::vector<ShaderPackEntry> entries;
+    std::unordered_map<uint64_t, size_t> index;
+    Reader r{ bytes.data() + kHeaderSize, bytes.data() + dataOffset };
+    const uint64_t dataSize = bytes.size() - dataOffset;
+    if (!r.Need(size_t(count) * 24)) return false;
+    entries.resize(count);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        ShaderPackEntry& e = entries[i];
+        if (!ReadEntry(r, e)) return false;
+        if (e.offset > dataSize || e.size > dataSize - e.offset) return false;
+        if (!index.emplace(e.id, i).second) return false;
+    }
+
+    m_bytes = std::move(bytes);
+    m_dataOffset = dataOffset;
+    m_entries = std::move(entries);
+    m_index = std::move(index);
+    return true;
+}
+
+const ShaderPackEntry* ShaderPack::Find(uint64_t id) const {
+    auto it = m_index.find(id);
+    return it == m_index.end() ? nullptr : &m_entries[it->second];
+}
+
+bool jisaku::WriteShaderPack(const std::filesystem::path& file, const std::vector<ShaderPackEntry>& entries,
+                             const std::vector<std::vector<uint8_t>>& bytecodes, std::string& error) {
+    if (entries.size() != bytecodes.size()) {
+        error = "entry and bytecode counts differ";
+        return false;
+    }
+    std::vector<ShaderPackEntry> toc = entries;
+    std::unordered_map<uint64_t, size_t> seen;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < toc.size(); ++i) {
+        if (!seen.emplace(toc[i].id, i).second) {
+            error = "duplicate shader id: " + toc[i].path + ":" + toc[i].entry;
+            return false;
+        }
+        toc[i].offset = offset;
+        toc[i].size = bytecodes[i].size();
+        offset = (offset + bytecodes[i].size() + kDataAlign - 1) / kDataAlign * kDataAlign;
+    }
+
+    std::vector<uint8_t> bytes(kHeaderSize, 0);
+    Writer w{ bytes };
+    for (const ShaderPackEntry& e : toc) WriteEntry(w, e);
+    bytes.resize((bytes.size() + kDataAlign - 1) / kDataAlign * kDataAlign, 0);
+    const uint64_t dataOffset = bytes.size();
+    bytes.resize(dataOffset + offset, 0);
+    for (size_t i = 0; i < toc.size(); ++i) {
+        if (!bytecodes[i].empty()) std::memcpy(bytes.data() + dataOffset + toc[i].offset, bytecodes[i].data(), bytecodes[i].size());
+    }
+
+    std::memcpy(bytes.data(), kMagic, 4);
+    WriteU32(bytes.data() + 4, kVersion);
+    WriteU32(bytes.data() + 8, uint32_t(toc.size()));
+    WriteU64(bytes.data() + 16, dataOffset);
+    WriteU64(bytes.data() + 24, HashContent(bytes.data() + kHeaderSize, bytes.size() - kHeaderSize).lo);
+
+    if (!WriteFileAtomic(file, bytes.data(), bytes.size())) {
+        error = "cannot write " + file.string();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace jisaku {
+
+// ビルド済みシェーダーをまとめたパック（D3D/Windows 非依存）。JisakuShaderPack が書き、起動時に読む。
+// エントリポイント・パーミュテーション（define の組）ごとに 1 エントリで、ID（MakeShaderId）で引く。
+// 形式（リトルエンディアン）:
+//   ヘッダ 32 byte : "JSPK", version(u32), count(u32), 予約(u32), dataOffset(u64), checksum(u64: ヘッダより後の XXH3 下位 64bit)
+//   目次           : エントリごとに id(u64), offset(u64: dataOffset 基準), size(u64), 文字列（u32 長さ + UTF-8）と表
+//   データ         : バイトコード（16 byte 境界）
+
+// 頂点シェーダーなら入力レイアウトと突き合わせられる
+struct ShaderSignatureElement {
+    std::string semantic;  // "POSITION"
+    uint32_t index = 0;
+    uint32_t reg = 0;
+    std::string mask;      // "xyz"
+    std::string format;    // "float" / "uint" / ...
+};
+
+struct ShaderBinding {
+    std::string name;
+    std::string type;      // "cbuffer" / "texture" / "sampler" / "UAV" ...
+    char registerClass = 0; // 'b' / 't' / 's' / 'u'
+    uint32_t slot = 0;
+    uint32_t space = 0;
+    uint32_t count = 1;
+};
+
+struct ShaderReflection {
+    std::vector<ShaderSignatureElement> inputs;
+    std::vector<ShaderBinding> bindings;
+};
+
+// dxc -Fc の逆アセンブルの先頭にあるコメント（Input signature / Resource Bindings の表）から読む。
+// 表が無いときは空のまま true（PS の入力が無い等）
+bool ParseDxilReflection(std::string_view disassembly, ShaderReflection& out);
+
+// path は Vfs の仮想パス。define の順序は区別しない
+uint64_t MakeShaderId(std::string_view path, std::string_view entry, const std::vector<std::string>& defines);
+
+struct ShaderPackEntry {
+    uint64_t id = 0;
+    std::string path;
+    std::string entry;
+    std::string target;
+    std::vector<std::string> defines; // "NAME=VALUE"
+    ShaderReflection reflection;
+    uint64_t offset = 0; // バイトコードの位置（読み込み時に埋まる）
+    uint64_t size = 0;
+};
+
+class ShaderPack {
+public:
+    // bytes を引き取る（バイトコードは中を指す）。壊れていれば false で空のまま
+    bool Load(std::vector<uint8_t> bytes);
+
+    const ShaderPackEntry* Find(uint64_t id) const;
+    const uint8_t* GetBytecode(const ShaderPackEntry& entry) const { return m_bytes.data() + m_dataOffset + entry.offset; }
+
+    size_t Size() const { return m_entries.size(); }
+    const std::vector<ShaderPackEntry>& GetEntries() const { return m_entries; }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    uint64_t m_dataOffset = 0;
+    std::vector<ShaderPackEntry> m_entries;
+    std::unordered_map<uint64_t, size_t> m_index;
+};
+
+// 書き出し用（entries[i] のバイトコードが bytecodes[i]。offset / size は無視する）。
+// ID が重複していれば失敗。一時ファイルに書いてから置き換える
+bool WriteShaderPack(const std::filesystem::path& file, const std::vector<ShaderPackEntry>& entries,
+                     const std::vector<std::vector<uint8_t>>& bytecodes, std::string& error);
+
+} // namespace jisaku
@@ -0,0 +1,94 @@
+#include "core/ShaderPermutations.h"
+#include "core/AtomicFile.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using namespace jisaku;
+
+PermutationSchema::PermutationSchema(std::initializer_list<const char*> features) {
+    for (const char* f : features) AddFeature(f);
+}
+
+PermutationKey PermutationSchema::AddFeature(std::string define) {
+    if (m_features.size() >= kMaxPermutationFeatures) return 0;
+    m_features.push_back(std::move(define));
+    return PermutationKey(1) << (m_features.size() - 1);
+}
+
+PermutationKey PermutationSchema::GetMask() const {
+    return m_features.size() >= kMaxPermutationFeatures ? ~PermutationKey(0)
+                                                         : (PermutationKey(1) << m_features.size()) - 1;
+}
+
+std::vector<std::string> PermutationSchema::MakeDefines(PermutationKey key) const {
+    std::vector<std::string> defines;
+    for (size_t i = 0; i < m_features.size(); ++i) {
+        if (key & (PermutationKey(1) << i)) defines.push_back(m_features[i] + "=1");
+    }
+    return defines;
+}
+
+std::string PermutationSchema::Format(PermutationKey key) const {
+    std::string text;
+    for (size_t i = 0; i < m_features.size(); ++i) {
+        if (!(key & (PermutationKey(1) << i))) continue;
+        if (!text.empty()) text += '|';
+        text += m_features[i];
+    }
+    return text.empty() ? "-" : text;
+}
+
+bool PermutationSchema::Parse(std::string_view text, PermutationKey& key) const {
+    key = 0;
+    if (text == "-") return true;
+    while (!text.empty()) {
+        const size_t end = std::min(text.find('|'), text.size());
+        const std::string_view name = text.substr(0, end);
+        auto it = std::find(m_features.begin(), m_features.end(), name);
+        if (it == m_features.end()) return false;
+        key |= PermutationKey(1) << (it - m_features.begin());
+        text.remove_prefix(std::min(end + 1, text.size()));
+    }
+    return true;
+}
+
+bool PermutationUsage::Load(const std::filesystem::path& file) {
+    std::ifstream in(file);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream words(line);
+        std::string shader, features;
+        if (words >> shader >> features) Add(shader, features);
+    }
+    return true;
+}
+
+bool PermutationUsage::Save(const std::filesystem::path& file) const {
+    return WriteFileAtomic(file, [this](std::ostream& out) {
+        out << "# shader permutations used; warmed at startup\n";
+        for (const auto& [shader, list] : m_entries) {
+            for (const std::string& features : list) out << shader << ' ' << features << '\n';
+        }
+        return bool(out);
+    }, false);
+}
+
+void PermutationUsage::Add(const std::string& shader, const std::string& features) {
+    std::vector<std::string>& list = m_entries[shader];
+    if (std::find(list.begin(), list.end(), features) == list.end()) list.push_back(features);
+}
+
+const std::vector<std::string>* PermutationUsage::Find(const std::string& shader) const {
+    auto it = m_entries.find(shader);
+    return it == m_entries.end() ? nullptr : &it->second;
+}
+
+size_t PermutationUsage::Size() const {
+    size_t n = 0;
+    for (const auto& [shader, list] : m_entries) n += list.size();
+    return n;
+}
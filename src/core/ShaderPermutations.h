@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jisaku {
+
+// シェーダーのパーミュテーション（D3D/Windows 非依存）。
+// パスが機能ビットを宣言し、立っているビットだけ "NAME=1" の define にしてコンパイルする
+// （ビットが 1 つも無い基本形は define 無し = パーミュテーションを使わないときと同じシェーダー）
+using PermutationKey = uint32_t;
+constexpr uint32_t kMaxPermutationFeatures = 32;
+
+class PermutationSchema {
+public:
+    PermutationSchema() = default;
+    // 並び順がビット（先頭が 1u << 0）
+    PermutationSchema(std::initializer_list<const char*> features);
+
+    // 戻り値は追加した機能のビット。kMaxPermutationFeatures を超えたら 0
+    PermutationKey AddFeature(std::string define);
+
+    size_t GetFeatureCount() const { return m_features.size(); }
+    const std::vector<std::string>& GetFeatures() const { return m_features; }
+    // 宣言されたビットすべて
+    PermutationKey GetMask() const;
+
+    std::vector<std::string> MakeDefines(PermutationKey key) const;
+    // "GRAYSCALE|SHOW_UV"（基本形は "-"）。Parse はその逆で、知らない機能名があれば false
+    std::string Format(PermutationKey key) const;
+    bool Parse(std::string_view text, PermutationKey& key) const;
+
+private:
+    std::vector<std::string> m_features;
+};
+
+// 使われたパーミュテーションの記録。起動時に読んで先に作っておく（初めて使うときの代わりの表示を減らす）。
+// テキスト（UTF-8、1 行 1 つ）: "<シェーダーの仮想パス> <Format の文字列>"
+class PermutationUsage {
+public:
+    bool Load(const std::filesystem::path& file);
+    // 一時ファイルに書いてから置き換える
+    bool Save(const std::filesystem::path& file) const;
+
+    // 同じものは 1 回だけ
+    void Add(const std::string& shader, const std::string& features);
+    // shader について記録されている Format の文字列（記録順）
+    const std::vector<std::string>* Find(const std::string& shader) const;
+
+    size_t Size() const;
+
+private:
+    std::map<std::string, std::vector<std::string>> m_entries;
+};
+
+} // namespace jisaku
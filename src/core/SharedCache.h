@@ -0,0 +1,119 @@
+#pragma once
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace jisaku {
+
+// キーごとに 1 つの値を参照カウント付きで共有するキャッシュ。
+// - 同じキーが使用中なら同じ shared_ptr を返す
+// - 別スレッドが読み込み中なら、その完了を待って結果を共有する（読み込みは 1 回だけ）
+// - 最後の参照が外れた時点でエントリを消し、値を onRelease に渡す（呼ぶのは最後の参照を捨てたスレッド）
+// 値の寿命は参照側が持つので、キャッシュ自体が先に破棄されても参照は有効なまま（onRelease は呼ばれない）。
+template <class Key, class Value, class Hash = std::hash<Key>>
+class SharedCache {
+public:
+    using Ptr = std::shared_ptr<const Value>;
+    using ReleaseFn = std::function<void(Value&&)>;
+
+    explicit SharedCache(ReleaseFn onRelease = {}) : m_state(std::make_shared<State>()) {
+        m_state->onRelease = std::move(onRelease);
+    }
+
+    SharedCache(const SharedCache&) = delete;
+    SharedCache& operator=(const SharedCache&) = delete;
+
+    // load は bool(Value& out)。失敗時は nullptr を返し、待っていた側にも nullptr が返る。
+    // load の中から同じキーを要求するとデッドロックするので注意
+    template <class LoadFn>
+    Ptr GetOrLoad(const Key& key, LoadFn&& load) {
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+        auto it = m_state->entries.find(key);
+        if (it != m_state->entries.end()) {
+            if (Ptr live = it->second.live.lock()) return live;
+            if (it->second.pending.valid()) {
+                std::shared_future<Ptr> pending = it->second.pending;
+                lock.unlock();
+                return pending.get();
+            }
+        }
+
+        // 自分が読み込む。完了までの間に来た要求は pending を待つ
+        std::promise<Ptr> promise;
+        m_state->entries[key] = Entry{ {}, promise.get_future().share() };
+        lock.unlock();
+
+        Ptr result;
+        try {
+            auto value = std::make_unique<Value>();
+            if (load(*value)) result = Wrap_(key, std::move(value));
+        } catch (...) {
+            Finish_(key, nullptr);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        Finish_(key, result);
+        promise.set_value(result);
+        return result;
+    }
+
+    // 使用中なら返す（読み込みはしない）
+    Ptr Find(const Key& key) const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        auto it = m_state->entries.find(key);
+        return it != m_state->entries.end() ? it->second.live.lock() : nullptr;
+    }
+
+    // 使用中・読み込み中のエントリ数
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->entries.size();
+    }
+
+private:
+    struct Entry {
+        std::weak_ptr<const Value> live;
+        std::shared_future<Ptr> pending; // 読み込み中のみ valid
+    };
+    struct State {
+        std::mutex mutex;
+        std::unordered_map<Key, Entry, Hash> entries;
+        ReleaseFn onRelease;
+    };
+
+    Ptr Wrap_(const Key& key, std::unique_ptr<Value> value) {
+        std::weak_ptr<State> weak = m_state;
+        return Ptr(value.release(), [weak, key](const Value* p) {
+            std::unique_ptr<Value> owned(const_cast<Value*>(p));
+            std::shared_ptr<State> state = weak.lock();
+            if (!state) return;
+            ReleaseFn onRelease;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                // 参照が切れた直後に同じキーで読み直しが始まっている場合はそちらを残す
+                auto it = state->entries.find(key);
+                if (it != state->entries.end() && it->second.live.expired() && !it->second.pending.valid())
+                    state->entries.erase(it);
+                onRelease = state->onRelease;
+            }
+            if (onRelease) onRelease(std::move(*owned));
+        });
+    }
+
+    void Finish_(const Key& key, const Ptr& result) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (result) {
+            m_state->entries[key] = Entry{ result, {} };
+        } else {
+            m_state->entries.erase(key);
+        }
+    }
+
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace jisaku
@@ -0,0 +1,233 @@
+#include "core/Socket.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace jisaku;
+
+namespace {
+
+constexpr uintptr_t kInvalid = ~uintptr_t(0);
+
+#ifdef _WIN32
+using Native = SOCKET;
+
+bool StartupOnce() {
+    static const bool s_ok = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return s_ok;
+}
+
+void CloseNative(uintptr_t s) { ::closesocket(Native(s)); }
+#else
+using Native = int;
+
+bool StartupOnce() { return true; }
+
+void CloseNative(uintptr_t s) { ::close(Native(s)); }
+#endif
+
+// "tcp:host:port" を分解する（IPv6 は "[::1]:port"）
+bool SplitHostPort(const std::string& s, std::string& host, std::string& port) {
+    const size_t colon = s.rfind(':');
+    if (colon == std::string::npos || colon + 1 == s.size()) return false;
+    host = s.substr(0, colon);
+    port = s.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+    return !host.empty();
+}
+
+// 接続済み / listen 済みのソケットを返す（失敗なら kInvalid）
+uintptr_t OpenTcp(const std::string& hostPort, bool listen) {
+    std::string host, port;
+    if (!SplitHostPort(hostPort, host, port)) return kInvalid;
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listen ? AI_PASSIVE : 0;
+    addrinfo* list = nullptr;
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &list) != 0) return kInvalid;
+    uintptr_t result = kInvalid;
+    for (addrinfo* ai = list; ai && result == kInvalid; ai = ai->ai_next) {
+        const Native s = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+#ifdef _WIN32
+        if (s == INVALID_SOCKET) continue;
+#else
+        if (s < 0) continue;
+#endif
+        const int one = 1;
+        bool ok;
+        if (listen) {
+#ifndef _WIN32
+            // 再起動直後に TIME_WAIT のポートで失敗しないように（Windows では他プロセスに横取りされるので付けない）
+            ::setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+#endif
+            ok = ::bind(s, ai->ai_addr, int(ai->ai_addrlen)) == 0 && ::listen(s, SOMAXCONN) == 0;
+        } else {
+            ok = ::connect(s, ai->ai_addr, int(ai->ai_addrlen)) == 0;
+        }
+        if (!ok) {
+            CloseNative(uintptr_t(s));
+            continue;
+        }
+        result = uintptr_t(s);
+    }
+    ::freeaddrinfo(list);
+    return result;
+}
+
+// 小さい要求と返事が多いので、Nagle で遅延しないようにする
+void SetNoDelay(uintptr_t s) {
+    const int one = 1;
+    ::setsockopt(Native(s), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+}
+
+#ifndef _WIN32
+uintptr_t OpenUnix(const std::string& path, bool listen) {
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return kInvalid;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    const int s = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (s < 0) return kInvalid;
+    bool ok;
+    if (listen) {
+        ::unlink(path.c_str()); // 前回落ちたサーバーの残り
+        ok = ::bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0 && ::listen(s, SOMAXCONN) == 0;
+    } else {
+        ok = ::connect(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+    if (!ok) {
+        ::close(s);
+        return kInvalid;
+    }
+    return uintptr_t(s);
+}
+#endif
+
+} // namespace
+
+std::unique_ptr<Socket> Socket::Connect(const std::string& address) {
+    if (!StartupOnce()) return nullptr;
+    std::unique_ptr<Socket> sock(new Socket());
+    if (address.rfind("tcp:", 0) == 0) {
+        sock->m_socket = OpenTcp(address.substr(4), false);
+        if (sock->m_socket != kInvalid) SetNoDelay(sock->m_socket);
+    }
+#ifndef _WIN32
+    else if (address.rfind("unix:", 0) == 0) {
+        sock->m_socket = OpenUnix(address.substr(5), false);
+    }
+#endif
+    else {
+        spdlog::error("Unsupported socket address: {}", address);
+    }
+    if (sock->m_socket == kInvalid) return nullptr;
+    return sock;
+}
+
+std::unique_ptr<Socket> Socket::Listen(const std::string& address) {
+    if (!StartupOnce()) return nullptr;
+    std::unique_ptr<Socket> sock(new Socket());
+    if (address.rfind("tcp:", 0) == 0) {
+        sock->m_socket = OpenTcp(address.substr(4), true);
+    }
+#ifndef _WIN32
+    else if (address.rfind("unix:", 0) == 0) {
+        sock->m_socket = OpenUnix(address.substr(5), true);
+        if (sock->m_socket != kInvalid) sock->m_unixPath = address.substr(5);
+    }
+#endif
+    else {
+        spdlog::error("Unsupported socket address: {}", address);
+    }
+    if (sock->m_socket == kInvalid) return nullptr;
+    return sock;
+}
+
+Socket::~Socket() {
+    if (m_socket != kInvalid) CloseNative(m_socket);
+#ifndef _WIN32
+    if (!m_unixPath.empty()) ::unlink(m_unixPath.c_str());
+#endif
+}
+
+std::unique_ptr<Socket> Socket::Accept() {
+    for (;;) {
+#ifdef _WIN32
+        const SOCKET s = ::accept(Native(m_socket), nullptr, nullptr);
+        if (s == INVALID_SOCKET) return nullptr;
+#else
+        const int s = ::accept4(Native(m_socket), nullptr, nullptr, SOCK_CLOEXEC);
+        if (s < 0 && (errno == EINTR || errno == ECONNABORTED)) continue;
+        if (s < 0) return nullptr;
+#endif
+        std::unique_ptr<Socket> sock(new Socket());
+        sock->m_socket = uintptr_t(s);
+        if (m_unixPath.empty()) SetNoDelay(sock->m_socket);
+        return sock;
+    }
+}
+
+bool Socket::Send(const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const int chunk = int(std::min<size_t>(size, 1u << 30));
+#ifdef _WIN32
+        const int n = ::send(Native(m_socket), p, chunk, 0);
+        if (n <= 0) return false;
+#else
+        // 相手が先に閉じても SIGPIPE で落ちないように
+        const ssize_t n = ::send(Native(m_socket), p, size_t(chunk), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+#endif
+        p += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+bool Socket::Receive(void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        const int chunk = int(std::min<size_t>(size, 1u << 30));
+#ifdef _WIN32
+        const int n = ::recv(Native(m_socket), p, chunk, 0);
+        if (n <= 0) return false;
+#else
+        const ssize_t n = ::recv(Native(m_socket), p, size_t(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+#endif
+        p += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+void Socket::Shutdown() {
+#ifdef _WIN32
+    ::shutdown(Native(m_socket), SD_BOTH);
+#else
+    ::shutdown(Native(m_socket), SHUT_RDWR);
+#endif
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace jisaku {
+
+// ストリームソケット（ツールとエンジンのローカル通信用）。アドレスは
+//   "unix:<パス>"           Unix ドメインソケット（POSIX のみ）
+//   "tcp:<ホスト>:<ポート>"  TCP（Nagle は切る）
+// Send / Receive はそれぞれ 1 スレッドずつなら同時に使ってよい。Shutdown は任意のスレッドから呼べて、
+// ブロック中の Receive / Accept を失敗で返す
+class Socket {
+public:
+    static std::unique_ptr<Socket> Connect(const std::string& address);
+    // Unix ドメインソケットは残っているファイルを消してから作り、閉じるときに消す
+    static std::unique_ptr<Socket> Listen(const std::string& address);
+
+    ~Socket();
+
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    // 接続が来るまで待つ（Shutdown されたら null）
+    std::unique_ptr<Socket> Accept();
+
+    // size バイトすべて送る / 受け取る。相手が閉じたら false
+    bool Send(const void* data, size_t size);
+    bool Receive(void* data, size_t size);
+    void Shutdown();
+
+private:
+    Socket() = default;
+
+    uintptr_t m_socket = ~uintptr_t(0); // Windows の SOCKET / POSIX の記述子
+    std::string m_unixPath;             // Listen した Unix ドメインソケット
+};
+
+} // namespace jisaku
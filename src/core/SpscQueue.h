@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace jisaku {
+
+// 単一プロデューサー・単一コンシューマーの固定長リングバッファ（ロックなし）。
+// TryPush は 1 つのスレッドだけ、TryPop は別の 1 つのスレッドだけが呼ぶこと。容量は 2 の累乗に切り上げる
+template <class T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        m_mask = n - 1;
+        m_items = std::make_unique<T[]>(n);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 満杯なら false（value はそのまま）
+    bool TryPush(T value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache > m_mask) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache > m_mask) return false;
+        }
+        m_items[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T& out) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) return false;
+        }
+        out = std::move(m_items[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Capacity() const { return m_mask + 1; }
+
+private:
+    std::unique_ptr<T[]> m_items;
+    size_t m_mask = 0;
+    // プロデューサー側とコンシューマー側を別のキャッシュラインに置く
+    alignas(64) std::atomic<size_t> m_tail{ 0 };
+    size_t m_headCache = 0; // プロデューサーが最後に見た m_head
+    alignas(64) std::atomic<size_t> m_head{ 0 };
+    size_t m_tailCache = 0; // コンシューマーが最後に見た m_tail
+};
+
+} // namespace jisaku
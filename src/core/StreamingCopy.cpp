@@ -0,0 +1,50 @@
+#include "core/StreamingCopy.h"
+#include "core/CpuFeatures.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#if JISAKU_X86
+#include <immintrin.h>
+#endif
+
+using namespace jisaku;
+
+void jisaku::StreamCopy(void* dst, const void* src, size_t bytes) {
+#if JISAKU_X86
+    auto* d = static_cast<uint8_t*>(dst);
+    auto* s = static_cast<const uint8_t*>(src);
+    // 先頭を 16byte 境界まで通常コピー
+    const size_t head = (std::min)(bytes, size_t((16 - (uintptr_t(d) & 15)) & 15));
+    std::memcpy(d, s, head);
+    d += head;
+    s += head;
+    bytes -= head;
+
+    // 64byte（1 キャッシュライン）単位でまとめて流す
+    for (; bytes >= 64; d += 64, s += 64, bytes -= 64) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+        const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+    }
+    for (; bytes >= 16; d += 16, s += 16, bytes -= 16) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(d), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+    }
+    std::memcpy(d, s, bytes);
+#else
+    std::memcpy(dst, src, bytes);
+#endif
+}
+
+void jisaku::StreamFence() {
+#if JISAKU_X86
+    _mm_sfence();
+#else
+    std::atomic_thread_fence(std::memory_order_release);
+#endif
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+
+namespace jisaku {
+
+// 書き込み結合（WC）メモリ向けのコピー。アップロードヒープは CPU から見て WC なので、
+// キャッシュを汚さずライン単位でまとめて書ける非テンポラルストアを使う。
+// dst/src のアラインメントは任意（16byte 境界に揃っていない先頭/末尾は通常ストア）
+void StreamCopy(void* dst, const void* src, size_t bytes);
+
+// このスレッドの非テンポラルストアを完了させる。書き込み後に別スレッド/GPU へ渡す前に呼ぶ
+void StreamFence();
+
+} // namespace jisaku
@@ -0,0 +1,493 @@
+#include "core/Vfs.h"
+#include "core/ByteOrder.h"
+#include "core/CookClient.h"
+#include "core/JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace jisaku;
+
+namespace {
+
+// パックファイル（リトルエンディアン）
+//   ヘッダ 16 byte : "JPAK", version(u32), entryCount(u32), tocSize(u32)
+//   目次           : entryCount 個の { offset(u64), storedSize(u64), rawSize(u64), codec(u8), chunkShift(u8),
+//                    nameLength(u16), name(UTF-8), codec != None なら各チャンクの圧縮後サイズ(u32 × チャンク数) }
+//   データ         : 各ファイルを 16 byte 境界に置く。圧縮エントリはチャンクを順に連結したもの
+// v2 で圧縮エントリを追加した（v1 のパックは作り直すこと）
+constexpr char kPackMagic[4] = { 'J', 'P', 'A', 'K' };
+constexpr uint32_t kPackVersion = 2;
+constexpr size_t kPackHeaderSize = 16;
+constexpr size_t kPackEntryHeaderSize = 28;
+constexpr uint64_t kPackAlign = 16;
+
+struct PackEntry {
+    uint64_t offset = 0;
+    uint64_t storedSize = 0;
+    uint64_t rawSize = 0;
+    Codec codec = Codec::None;
+    uint32_t chunkSize = 0;
+    std::vector<uint64_t> chunkOffsets; // 圧縮エントリのみ。offset からの位置（チャンク数 + 1 個）
+};
+
+// 圧縮エントリの範囲読み 1 回分。チャンクごとの読み込みと展開ジョブが共有し、最後に終わった側が done を呼ぶ
+struct CompressedRead {
+    std::shared_ptr<const void> owner; // entry を持っているパック
+    std::shared_ptr<IoFile> file;
+    const PackEntry* entry = nullptr;
+    uint64_t offset = 0;                // 展開後の位置
+    uint64_t size = 0;
+    uint8_t* dst = nullptr;
+    std::vector<uint8_t> owned;         // 呼び出し側が dst を渡さなかったとき
+    uint32_t firstChunk = 0;
+    std::unique_ptr<uint8_t[]> compressed;
+    std::atomic<uint32_t> remaining{ 0 };
+    std::atomic<bool> failed{ false };
+    std::function<void(bool, std::vector<uint8_t>&&)> done;
+
+    // チャンク c を展開して [offset, offset + size) と重なる部分を dst へ置く
+    bool Decompress(uint32_t c) const {
+        const uint64_t chunkBegin = uint64_t(c) * entry->chunkSize;
+        const size_t raw = size_t(std::min<uint64_t>(entry->chunkSize, entry->rawSize - chunkBegin));
+        const uint8_t* src = compressed.get() + (entry->chunkOffsets[c] - entry->chunkOffsets[firstChunk]);
+        const size_t srcSize = size_t(entry->chunkOffsets[c + 1] - entry->chunkOffsets[c]);
+        const uint64_t begin = std::max(offset, chunkBegin);
+        const uint64_t end = std::min(offset + size, chunkBegin + raw);
+        if (begin == chunkBegin && end == chunkBegin + raw)
+            return DecompressChunk(entry->codec, src, srcSize, dst + (chunkBegin - offset), raw);
+        // 範囲の端にかかるチャンクだけ一時バッファを経由する
+        std::vector<uint8_t> tmp(raw);
+        if (!DecompressChunk(entry->codec, src, srcSize, tmp.data(), raw)) return false;
+        std::memcpy(dst + (begin - offset), tmp.data() + (begin - chunkBegin), size_t(end - begin));
+        return true;
+    }
+
+    static void Finish(const std::shared_ptr<CompressedRead>& self, bool ok) {
+        if (!ok) self->failed = true;
+        if (self->remaining.fetch_sub(1) != 1) return;
+        const bool failed = self->failed;
+        self->done(!failed, failed ? std::vector<uint8_t>() : std::move(self->owned));
+    }
+};
+
+void WriteLE(std::vector<uint8_t>& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(uint8_t(v >> (8 * i)));
+}
+
+// OS のパスを仮想パスの表記（'/' 区切り・"./" 無し）にする
+std::string ToVirtualPath(const std::filesystem::path& path) {
+    const std::u8string u8 = path.lexically_normal().generic_u8string();
+    std::string s(u8.begin(), u8.end());
+    while (s.rfind("./", 0) == 0) s.erase(0, 2);
+    return s;
+}
+
+std::string NormalizeMountPoint(const std::string& mountPoint) {
+    std::string s = mountPoint;
+    while (!s.empty() && s.back() == '/') s.pop_back();
+    while (s.rfind("./", 0) == 0) s.erase(0, 2);
+    return s == "." ? std::string() : s;
+}
+
+// virtualPath が prefix の下にあれば、prefix より後ろを rel に入れる
+bool StripPrefix(const std::string& virtualPath, const std::string& prefix, std::string& rel) {
+    if (prefix.empty()) {
+        rel = virtualPath;
+        return true;
+    }
+    if (virtualPath.size() <= prefix.size() + 1 || virtualPath.compare(0, prefix.size(), prefix) != 0 ||
+        virtualPath[prefix.size()] != '/')
+        return false;
+    rel = virtualPath.substr(prefix.size() + 1);
+    return true;
+}
+
+std::filesystem::path FromVirtualPath(const std::string& rel) {
+    return std::filesystem::path(std::u8string(rel.begin(), rel.end()));
+}
+
+} // namespace
+
+struct Vfs::Pack_ {
+    std::shared_ptr<IoFile> file;
+    std::unordered_map<std::string, PackEntry> entries;
+};
+
+// 仮想パスの解決結果。cook があればサーバーに cookName を要求、pack があればそのエントリ、無ければ osPath のファイル全体
+struct Vfs::Location_ {
+    std::shared_ptr<CookClient> cook;
+    std::string cookName;
+    std::shared_ptr<const Pack_> pack;
+    const PackEntry* entry = nullptr;
+    std::filesystem::path osPath;
+};
+
+Vfs::Vfs(AsyncIo& io) : m_io(io) {}
+
+Vfs& Vfs::Get() {
+    static Vfs s_instance(AsyncIo::Get());
+    return s_instance;
+}
+
+bool Vfs::MountDirectory(const std::string& mountPoint, const std::filesystem::path& directory) {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(directory, ec)) return false;
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_mounts.push_back(Mount_{ NormalizeMountPoint(mountPoint), directory, nullptr, nullptr, nullptr });
+    return true;
+}
+
+bool Vfs::MountPack(const std::string& mountPoint, const std::filesystem::path& packFile) {
+    auto pack = std::make_shared<Pack_>();
+    pack->file = IoFile::Open(packFile);
+    if (!pack->file) return false;
+    const uint64_t fileSize = pack->file->GetSize();
+
+    // 目次はマウント時に同期で読む（以降の読み込みは目次を引くだけ）
+    uint8_t header[kPackHeaderSize];
+    if (fileSize < kPackHeaderSize || !pack->file->ReadAt(0, header, sizeof(header))) return false;
+    if (std::memcmp(header, kPackMagic, 4) != 0 || ReadU32(header + 4) != kPackVersion) return false;
+    const uint32_t count = ReadU32(header + 8);
+    const uint32_t tocSize = ReadU32(header + 12);
+    if (tocSize > fileSize - kPackHeaderSize) return false;
+
+    std::vector<uint8_t> toc(tocSize);
+    if (tocSize > 0 && !pack->file->ReadAt(kPackHeaderSize, toc.data(), toc.size())) return false;
+    const uint8_t* p = toc.data();
+    const uint8_t* end = p + toc.size();
+    pack->entries.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (end - p < ptrdiff_t(kPackEntryHeaderSize)) return false;
+        PackEntry e;
+        e.offset = ReadU64(p);
+        e.storedSize = ReadU64(p + 8);
+        e.rawSize = ReadU64(p + 16);
+        e.codec = Codec(p[24]);
+        const uint8_t chunkShift = p[25];
+        const uint16_t nameLength = ReadU16(p + 26);
+        p += kPackEntryHeaderSize;
+        if (end - p < nameLength || e.offset > fileSize || e.storedSize > fileSize - e.offset) return false;
+        std::string name(reinterpret_cast<const char*>(p), nameLength);
+        p += nameLength;
+
+        if (e.codec == Codec::None) {
+            if (e.rawSize != e.storedSize) return false;
+        } else {
+            if (e.codec > Codec::Zstd || chunkShift >= 32) return false;
+            e.chunkSize = 1u << chunkShift;
+            if (e.chunkSize < kMinChunkSize || e.chunkSize > kMaxChunkSize) return false;
+            const uint32_t chunks = ChunkCount(e.rawSize, e.chunkSize);
+            if (uint64_t(end - p) < uint64_t(chunks) * 4) return false;
+            e.chunkOffsets.resize(size_t(chunks) + 1, 0);
+            for (uint32_t c = 0; c < chunks; ++c, p += 4) e.chunkOffsets[c + 1] = e.chunkOffsets[c] + ReadU32(p);
+            if (e.chunkOffsets.back() != e.storedSize) return false;
+        }
+        pack->entries.emplace(std::move(name), std::move(e));
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_mounts.push_back(Mount_{ NormalizeMountPoint(mountPoint), {}, std::move(pack), nullptr, nullptr });
+    return true;
+}
+
+bool Vfs::MountManifest(const std::string& mountPoint, const std::filesystem::path& manifestFile) {
+    auto manifest = std::make_shared<AssetManifest>();
+    if (!manifest->Load(manifestFile)) return false;
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_mounts.push_back(Mount_{ NormalizeMountPoint(mountPoint), {}, nullptr, std::move(manifest), nullptr });
+    return true;
+}
+
+bool Vfs::MountCookServer(const std::string& mountPoint, std::shared_ptr<CookClient> client) {
+    if (!client) return false;
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_mounts.push_back(Mount_{ NormalizeMountPoint(mountPoint), {}, nullptr, nullptr, std::move(client) });
+    return true;
+}
+
+bool Vfs::Unmount(const std::string& mountPoint) {
+    const std::string prefix = NormalizeMountPoint(mountPoint);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (auto it = m_mounts.rbegin(); it != m_mounts.rend(); ++it) {
+        if (it->prefix == prefix) {
+            m_mounts.erase(std::next(it).base());
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Vfs::resolve_(const std::filesystem::path& path, Location_& out, bool useCook) const {
+    if (path.empty()) return false;
+    const std::string virtualPath = ToVirtualPath(path);
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::string rel;
+    for (auto it = m_mounts.rbegin(); it != m_mounts.rend(); ++it) {
+        if (!StripPrefix(virtualPath, it->prefix, rel)) continue;
+        if (it->cook) {
+            // 切れたサーバーには聞かない（下のマウントから読む）
+            if (!useCook || !it->cook->IsConnected()) continue;
+            out.cook = it->cook;
+            out.cookName = std::move(rel);
+            return true;
+        }
+        if (it->pack) {
+            auto e = it->pack->entries.find(rel);
+            if (e == it->pack->entries.end()) continue;
+            out.pack = it->pack;
+            out.entry = &e->second;
+            return true;
+        }
+        if (it->manifest) {
+            const ManifestEntry* e = it->manifest->Find(rel);
+            if (!e) continue;
+            out.osPath = it->manifest->GetObjectPath(*e);
+            return true;
+        }
+        std::error_code ec;
+        std::filesystem::path osPath = it->directory / FromVirtualPath(rel);
+        if (std::filesystem::is_regular_file(osPath, ec)) {
+            out.osPath = std::move(osPath);
+            return true;
+        }
+    }
+    out.osPath = path;
+    return true;
+}
+
+bool Vfs::Exists(const std::filesystem::path& path) const {
+    uint64_t size = 0;
+    return GetSize(path, size);
+}
+
+bool Vfs::GetSize(const std::filesystem::path& path, uint64_t& size) const {
+    Location_ loc;
+    if (!resolve_(path, loc)) return false;
+    if (loc.cook) {
+        // 大きさを知るにはクックするしかない（サーバー側のキャッシュに載るので、続く読み込みは速い）
+        std::future<CookResult> future = loc.cook->RequestAsync(loc.cookName);
+        const CookResult r = JobSystem::Get().Wait(future);
+        if (r.status == CookStatus::Ok) {
+            size = r.data.size();
+            return true;
+        }
+        loc = Location_{};
+        if (!resolve_(path, loc, false)) return false;
+    }
+    if (loc.entry) {
+        size = loc.entry->rawSize;
+        return true;
+    }
+    std::error_code ec;
+    const uintmax_t s = std::filesystem::file_size(loc.osPath, ec);
+    if (ec) return false;
+    size = uint64_t(s);
+    return true;
+}
+
+void Vfs::read_(const std::filesystem::path& path, uint64_t offset, uint64_t size, uint8_t* dst,
+                IoPriority priority, ReadDone_ done, bool useCook) {
+    Location_ loc;
+    if (!resolve_(path, loc, useCook)) {
+        done(false, {});
+        return;
+    }
+    if (loc.cook) {
+        // 返事は CookClient の受信スレッドに来る。サーバーがクックできなければ下のマウントから読み直す
+        loc.cook->RequestAsync(loc.cookName, [this, path, offset, size, dst, priority, done = std::move(done)](CookResult&& r) mutable {
+            if (r.status != CookStatus::Ok) {
+                read_(path, offset, size, dst, priority, std::move(done), false);
+                return;
+            }
+            if (offset > r.data.size() || (size != kIoWholeFile && size > r.data.size() - offset)) {
+                done(false, {});
+                return;
+            }
+            if (size == kIoWholeFile) size = r.data.size() - offset;
+            if (!dst) {
+                if (offset == 0 && size == r.data.size()) done(true, std::move(r.data));
+                else done(true, std::vector<uint8_t>(r.data.begin() + ptrdiff_t(offset), r.data.begin() + ptrdiff_t(offset + size)));
+                return;
+            }
+            // 大きいコピーで受信スレッドを塞がないように
+            auto data = std::make_shared<std::vector<uint8_t>>(std::move(r.data));
+            JobSystem::Get().Submit([data, offset, size, dst, done = std::move(done)]() {
+                std::memcpy(dst, data->data() + offset, size_t(size));
+                done(true, {});
+            });
+        });
+        return;
+    }
+    const PackEntry* e = loc.entry;
+    if (e) {
+        // パック内: エントリの範囲に収まっているかはここで確かめる（キュー側はパック全体しか知らない）
+        if (offset > e->rawSize || (size != kIoWholeFile && size > e->rawSize - offset)) {
+            done(false, {});
+            return;
+        }
+        if (size == kIoWholeFile) size = e->rawSize - offset;
+    }
+
+    if (!e || e->codec == Codec::None) {
+        IoReadRequest req;
+        req.priority = priority;
+        if (e) {
+            req.file = loc.pack->file;
+            req.offset = e->offset + offset;
+        } else {
+            req.path = std::move(loc.osPath);
+            req.offset = offset;
+        }
+        req.size = size;
+        req.dst = dst;
+        req.onComplete = [done = std::move(done)](IoReadResult&& r) { done(r.ok, std::move(r.data)); };
+        m_io.Submit(std::move(req));
+        return;
+    }
+
+    auto st = std::make_shared<CompressedRead>();
+    st->owner = loc.pack;
+    st->file = loc.pack->file;
+    st->entry = e;
+    st->offset = offset;
+    st->size = size;
+    st->done = std::move(done);
+    if (size == 0) {
+        st->done(true, {});
+        return;
+    }
+    if (!dst) {
+        st->owned.resize(size_t(size));
+        dst = st->owned.data();
+    }
+    st->dst = dst;
+    const uint32_t firstChunk = uint32_t(offset / e->chunkSize);
+    const uint32_t lastChunk = uint32_t((offset + size - 1) / e->chunkSize);
+    st->firstChunk = firstChunk;
+    st->compressed.reset(new uint8_t[size_t(e->chunkOffsets[lastChunk + 1] - e->chunkOffsets[firstChunk])]);
+    st->remaining = lastChunk - firstChunk + 1;
+
+    // チャンクごとに別の読み込みにして、届いた順に展開を始める（全部揃うのを待たない）
+    for (uint32_t c = firstChunk; c <= lastChunk; ++c) {
+        IoReadRequest req;
+        req.priority = priority;
+        req.file = st->file;
+        req.offset = e->offset + e->chunkOffsets[c];
+        req.size = e->chunkOffsets[c + 1] - e->chunkOffsets[c];
+        req.dst = st->compressed.get() + (e->chunkOffsets[c] - e->chunkOffsets[firstChunk]);
+        req.onComplete = [st, c](IoReadResult&& r) {
+            if (!r.ok) {
+                CompressedRead::Finish(st, false);
+                return;
+            }
+            JobSystem::Get().Submit([st, c]() { CompressedRead::Finish(st, st->Decompress(c)); });
+        };
+        m_io.Submit(std::move(req));
+    }
+}
+
+std::future<VfsReadResult> Vfs::ReadAsync(const std::filesystem::path& path, IoPriority priority) {
+    auto promise = std::make_shared<std::promise<VfsReadResult>>();
+    std::future<VfsReadResult> future = promise->get_future();
+    read_(path, 0, kIoWholeFile, nullptr, priority, [promise](bool ok, std::vector<uint8_t>&& data) {
+        promise->set_value(VfsReadResult{ ok, std::move(data) });
+    });
+    return future;
+}
+
+void Vfs::ReadAsync(const std::filesystem::path& path, IoPriority priority, std::function<void(VfsReadResult&&)> onComplete) {
+    read_(path, 0, kIoWholeFile, nullptr, priority, [onComplete = std::move(onComplete)](bool ok, std::vector<uint8_t>&& data) {
+        // I/O スレッドを塞がないよう、後段の処理はワーカーへ回す
+        auto result = std::make_shared<VfsReadResult>(VfsReadResult{ ok, std::move(data) });
+        JobSystem::Get().Submit([onComplete, result]() { onComplete(std::move(*result)); });
+    });
+}
+
+void Vfs::ReadRangeAsync(const std::filesystem::path& path, uint64_t offset, size_t size, void* dst,
+                         IoPriority priority, std::function<void(bool)> onComplete) {
+    read_(path, offset, size, static_cast<uint8_t*>(dst), priority,
+          [onComplete = std::move(onComplete)](bool ok, std::vector<uint8_t>&&) {
+              if (onComplete) onComplete(ok);
+          });
+}
+
+bool Vfs::ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& out) {
+    std::future<VfsReadResult> future = ReadAsync(path, IoPriority::Critical);
+    VfsReadResult r = JobSystem::Get().Wait(future);
+    if (!r.ok) return false;
+    out = std::move(r.data);
+    return true;
+}
+
+bool jisaku::WritePack(const std::filesystem::path& packFile, const std::vector<PackSource>& sources, uint32_t chunkSize) {
+    if (chunkSize < kMinChunkSize || chunkSize > kMaxChunkSize || (chunkSize & (chunkSize - 1)) != 0) return false;
+    uint8_t chunkShift = 0;
+    while ((1u << chunkShift) < chunkSize) ++chunkShift;
+
+    // 目次の大きさは元サイズとコーデックだけで決まるので、データを先に書いて目次は最後に埋める
+    std::unordered_set<std::string> names;
+    uint64_t tocSize = 0;
+    std::vector<uint64_t> sizes;
+    sizes.reserve(sources.size());
+    for (const PackSource& src : sources) {
+        std::error_code ec;
+        const uintmax_t size = std::filesystem::file_size(src.file, ec);
+        if (ec || src.name.empty() || src.name.size() > 0xFFFF || !names.insert(src.name).second) return false;
+        if (src.codec > Codec::Zstd) return false;
+        sizes.push_back(uint64_t(size));
+        tocSize += kPackEntryHeaderSize + src.name.size();
+        if (src.codec != Codec::None) tocSize += uint64_t(ChunkCount(size, chunkSize)) * 4;
+    }
+    if (tocSize > 0xFFFFFFFFull) return false;
+
+    std::ofstream out(packFile, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    auto align = [](uint64_t v) { return (v + kPackAlign - 1) & ~(kPackAlign - 1); };
+    std::vector<uint8_t> head;
+    head.insert(head.end(), kPackMagic, kPackMagic + 4);
+    WriteLE(head, kPackVersion, 4);
+    WriteLE(head, sources.size(), 4);
+    WriteLE(head, tocSize, 4);
+    uint64_t offset = align(kPackHeaderSize + tocSize);
+    std::vector<uint8_t> buf;
+    ChunkedData chunked;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const PackSource& src = sources[i];
+        std::ifstream in(src.file, std::ios::binary);
+        buf.resize(size_t(sizes[i]));
+        if (!in || !in.read(reinterpret_cast<char*>(buf.data()), std::streamsize(buf.size()))) return false;
+
+        const uint8_t* stored = buf.data();
+        uint64_t storedSize = sizes[i];
+        if (src.codec != Codec::None) {
+            if (!CompressChunked(buf.data(), buf.size(), src.codec, src.level, chunkSize, chunked)) return false;
+            stored = chunked.data.data();
+            storedSize = chunked.data.size();
+        }
+        WriteLE(head, offset, 8);
+        WriteLE(head, storedSize, 8);
+        WriteLE(head, sizes[i], 8);
+        WriteLE(head, uint64_t(src.codec), 1);
+        WriteLE(head, src.codec != Codec::None ? chunkShift : 0, 1);
+        WriteLE(head, src.name.size(), 2);
+        head.insert(head.end(), src.name.begin(), src.name.end());
+        if (src.codec != Codec::None)
+            for (uint32_t n : chunked.chunkSizes) WriteLE(head, n, 4);
+
+        out.seekp(std::streamoff(offset));
+        out.write(reinterpret_cast<const char*>(stored), std::streamsize(storedSize));
+        offset = align(offset + storedSize);
+    }
+    // 最後のファイルの後ろも境界まで埋める（連結やミップ単位の読み込みで末尾を越えないように）
+    out.seekp(0, std::ios::end);
+    const uint64_t endPos = uint64_t(out.tellp());
+    for (uint64_t i = endPos; i < align(endPos); ++i) out.put(0);
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(head.data()), std::streamsize(head.size()));
+    return bool(out);
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "core/AssetManifest.h"
+#include "core/AsyncIo.h"
+#include "core/Compression.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace jisaku {
+
+class CookClient;
+
+// 仮想ファイルシステム。マウントポイントの下に、ばらばらのファイルのディレクトリ・パックファイル・アセットビルドのマニフェスト・
+// クックサーバーを重ねる。
+// - 仮想パスは '/' 区切りで大文字小文字を区別する（"shaders/TexturedQuad.hlsl"）
+// - 後からマウントしたものが優先。どのマウントにも無ければ OS のパス（カレントディレクトリ基準）として読む
+// - 読み込みは AsyncIo に優先度付きで投げる。パック内のファイルは開きっぱなしのパックから範囲読みする
+// - パック内の圧縮エントリはチャンクごとに読み、届いたチャンクから JobSystem で書き込み先へ直接展開する
+// - クックサーバーのマウントは毎回サーバーに要求する。クック対象でない・失敗した・切断されたときは下のマウントから読む
+struct VfsReadResult {
+    bool ok = false;
+    std::vector<uint8_t> data;
+};
+
+// WritePack の入力（name はパック内の仮想パス）
+struct PackSource {
+    std::string name;
+    std::filesystem::path file;
+    Codec codec = Codec::None; // 圧縮したエントリは読み込み時にチャンク単位で並列展開される
+    int level = 0;             // CompressChunked の level
+};
+
+class Vfs {
+public:
+    explicit Vfs(AsyncIo& io);
+
+    Vfs(const Vfs&) = delete;
+    Vfs& operator=(const Vfs&) = delete;
+
+    // プロセス共通（AsyncIo::Get() を使う）
+    static Vfs& Get();
+
+    // mountPoint は仮想パスの前置部分（"" でルート）
+    bool MountDirectory(const std::string& mountPoint, const std::filesystem::path& directory);
+    bool MountPack(const std::string& mountPoint, const std::filesystem::path& packFile);
+    // アセットビルドのマニフェスト。載っている仮想パスはコンテンツストア内のビルド済みオブジェクトを読む
+    bool MountManifest(const std::string& mountPoint, const std::filesystem::path& manifestFile);
+    // クックサーバー（JisakuCookServer）。mountPoint より後ろの仮想パスをそのまま要求する
+    bool MountCookServer(const std::string& mountPoint, std::shared_ptr<CookClient> client);
+    // mountPoint に最後にマウントしたものを外す（読み込み中の要求はそのまま完了する）
+    bool Unmount(const std::string& mountPoint);
+
+    bool Exists(const std::filesystem::path& path) const;
+    bool GetSize(const std::filesystem::path& path, uint64_t& size) const;
+
+    std::future<VfsReadResult> ReadAsync(const std::filesystem::path& path, IoPriority priority = IoPriority::Normal);
+    // onComplete は JobSystem のワーカーで呼ばれる（そのままデコード等をしてよい）
+    void ReadAsync(const std::filesystem::path& path, IoPriority priority, std::function<void(VfsReadResult&&)> onComplete);
+    // ファイル内の [offset, offset + size) を dst へ読む（圧縮エントリは展開後の位置）。dst は完了まで生かしておくこと。
+    // onComplete は I/O スレッドか展開ジョブのワーカーで呼ばれるので軽い処理だけにする
+    void ReadRangeAsync(const std::filesystem::path& path, uint64_t offset, size_t size, void* dst,
+                        IoPriority priority, std::function<void(bool ok)> onComplete);
+    // 同期読み込み（Critical で投げて待つ）。待つ間は JobSystem のジョブを手伝うのでジョブ内から呼んでもよいが、
+    // I/O の完了コールバックの中からは呼ばないこと
+    bool ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& out);
+
+    AsyncIo& GetIo() const { return m_io; }
+
+private:
+    struct Pack_;
+    struct Location_;
+    struct Mount_ {
+        std::string prefix;
+        std::filesystem::path directory;    // ディレクトリのマウント
+        std::shared_ptr<const Pack_> pack;  // パックのマウント
+        std::shared_ptr<const AssetManifest> manifest; // マニフェストのマウント
+        std::shared_ptr<CookClient> cook;   // クックサーバーのマウント
+    };
+    using ReadDone_ = std::function<void(bool ok, std::vector<uint8_t>&& data)>;
+
+    // useCook が false ならクックサーバーのマウントを飛ばす（サーバーから取れなかったときの読み直し用）
+    bool resolve_(const std::filesystem::path& path, Location_& out, bool useCook = true) const;
+    // path の [offset, offset + size) を読む。dst が null なら確保して done の data に入れる
+    void read_(const std::filesystem::path& path, uint64_t offset, uint64_t size, uint8_t* dst,
+               IoPriority priority, ReadDone_ done, bool useCook = true);
+
+    AsyncIo& m_io;
+    mutable std::shared_mutex m_mutex;
+    std::vector<Mount_> m_mounts;
+};
+
+// パックファイルを書き出す（アセットのビルド用）。name が重複していたら失敗
+bool WritePack(const std::filesystem::path& packFile, const std::vector<PackSource>& sources,
+               uint32_t chunkSize = kDefaultChunkSize);
+
+} // namespace jisaku
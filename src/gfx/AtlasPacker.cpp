@@ -0,0 +1,150 @@
+#include "gfx/AtlasPacker.h"
+#include <algorithm>
+#include <limits>
+
+using namespace jisaku;
+
+namespace {
+
+bool Contains(const AtlasRect& a, const AtlasRect& b) {
+    return b.x >= a.x && b.y >= a.y && b.x + b.width <= a.x + a.width && b.y + b.height <= a.y + a.height;
+}
+
+bool Intersects(const AtlasRect& a, const AtlasRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+} // namespace
+
+void AtlasPacker::Reset(uint32_t width, uint32_t height) {
+    m_width = width;
+    m_height = height;
+    m_usedArea = 0;
+    m_free.clear();
+    m_used.clear();
+    m_fragmented = false;
+    if (width && height) m_free.push_back({ 0, 0, width, height });
+}
+
+bool AtlasPacker::Insert(uint32_t width, uint32_t height, AtlasRect& out) {
+    if (width == 0 || height == 0) return false;
+
+    // 短辺側の余りが最小の空き矩形を選ぶ（同点なら長辺側の余りで比較）
+    auto findBest = [&]() -> const AtlasRect* {
+        const AtlasRect* best = nullptr;
+        uint32_t bestShort = std::numeric_limits<uint32_t>::max();
+        uint32_t bestLong = std::numeric_limits<uint32_t>::max();
+        for (const AtlasRect& f : m_free) {
+            if (f.width < width || f.height < height) continue;
+            const uint32_t dw = f.width - width, dh = f.height - height;
+            const uint32_t s = (std::min)(dw, dh), l = (std::max)(dw, dh);
+            if (s < bestShort || (s == bestShort && l < bestLong)) {
+                best = &f;
+                bestShort = s;
+                bestLong = l;
+            }
+        }
+        return best;
+    };
+    const AtlasRect* best = findBest();
+    if (!best && m_fragmented) {
+        // 返却を繰り返すと空き領域が細切れのまま残るので、作り直してからもう一度探す
+        RebuildFree_();
+        best = findBest();
+    }
+    if (!best) return false;
+
+    const AtlasRect placed{ best->x, best->y, width, height };
+    SplitFree_(placed);
+    m_used.push_back(placed);
+    m_usedArea += uint64_t(width) * height;
+    out = placed;
+    return true;
+}
+
+void AtlasPacker::Remove(const AtlasRect& rect) {
+    auto it = std::find_if(m_used.begin(), m_used.end(), [&](const AtlasRect& u) {
+        return u.x == rect.x && u.y == rect.y && u.width == rect.width && u.height == rect.height;
+    });
+    if (it == m_used.end()) return;
+    *it = m_used.back();
+    m_used.pop_back();
+    m_usedArea -= uint64_t(rect.width) * rect.height;
+    m_fragmented = true;
+
+    // 返却領域は使用中だったので既存の空き矩形とは重ならない。辺を丸ごと共有するものと結合して断片化を抑える
+    AtlasRect merged = rect;
+    for (bool grown = true; grown;) {
+        grown = false;
+        for (size_t i = 0; i < m_free.size(); ++i) {
+            const AtlasRect& f = m_free[i];
+            if (f.x == merged.x && f.width == merged.width && (f.y + f.height == merged.y || merged.y + merged.height == f.y)) {
+                merged.y = (std::min)(merged.y, f.y);
+                merged.height += f.height;
+            } else if (f.y == merged.y && f.height == merged.height && (f.x + f.width == merged.x || merged.x + merged.width == f.x)) {
+                merged.x = (std::min)(merged.x, f.x);
+                merged.width += f.width;
+            } else {
+                continue;
+            }
+            m_free[i] = m_free.back();
+            m_free.pop_back();
+            grown = true;
+            break;
+        }
+    }
+
+    // 結合結果に含まれる空き矩形は不要
+    for (size_t i = 0; i < m_free.size();) {
+        if (Contains(merged, m_free[i])) {
+            m_free[i] = m_free.back();
+            m_free.pop_back();
+        } else {
+            ++i;
+        }
+    }
+    m_free.push_back(merged);
+}
+
+void AtlasPacker::SplitFree_(const AtlasRect& used) {
+    // used と重なる空き矩形を、used の外側に残る最大 4 つの矩形へ置き換える
+    std::vector<AtlasRect> added;
+    for (size_t i = 0; i < m_free.size();) {
+        const AtlasRect f = m_free[i];
+        if (!Intersects(f, used)) { ++i; continue; }
+
+        if (used.x > f.x) added.push_back({ f.x, f.y, used.x - f.x, f.height });
+        if (used.x + used.width < f.x + f.width)
+            added.push_back({ used.x + used.width, f.y, f.x + f.width - (used.x + used.width), f.height });
+        if (used.y > f.y) added.push_back({ f.x, f.y, f.width, used.y - f.y });
+        if (used.y + used.height < f.y + f.height)
+            added.push_back({ f.x, used.y + used.height, f.width, f.y + f.height - (used.y + used.height) });
+
+        m_free[i] = m_free.back();
+        m_free.pop_back();
+    }
+
+    // 既存の空き矩形同士は包含関係が無い状態に保たれているので、新しく出来た分だけ判定すればよい。
+    // 新しい矩形は元の空き矩形の一部なので、既存の矩形を含むことは無い
+    const size_t kept = m_free.size();
+    for (size_t i = 0; i < added.size(); ++i) {
+        const AtlasRect& a = added[i];
+        bool redundant = false;
+        for (size_t j = 0; j < kept && !redundant; ++j) redundant = Contains(m_free[j], a);
+        for (size_t j = 0; j < added.size() && !redundant; ++j) {
+            // 同一矩形は先に出た方を残す
+            redundant = j != i && Contains(added[j], a) &&
+                        (j < i || !Contains(a, added[j]));
+        }
+        if (!redundant) m_free.push_back(a);
+    }
+}
+
+void AtlasPacker::RebuildFree_() {
+    m_free.clear();
+    m_free.push_back({ 0, 0, m_width, m_height });
+    // 上から順に切り出すと途中の空き矩形の数が少なく済む
+    std::sort(m_used.begin(), m_used.end(), [](const AtlasRect& a, const AtlasRect& b) { return a.y != b.y ? a.y < b.y : a.x < b.x; });
+    for (const AtlasRect& u : m_used) SplitFree_(u);
+    m_fragmented = false;
+}
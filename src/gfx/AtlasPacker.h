@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jisaku {
+
+struct AtlasRect {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// MaxRects（Best Short Side Fit）による矩形パッキング。D3D 非依存。
+// 空き領域を重なりを許した極大矩形の集合として持つので、挿入・削除を任意の順で繰り返せる。
+class AtlasPacker {
+public:
+    AtlasPacker() = default;
+    AtlasPacker(uint32_t width, uint32_t height) { Reset(width, height); }
+
+    void Reset(uint32_t width, uint32_t height);
+
+    // 入らなければ false（out は変更しない）
+    bool Insert(uint32_t width, uint32_t height, AtlasRect& out);
+    // Insert で得た矩形を返却する。隣接する空き領域とは可能な範囲で結合し、
+    // それでも入らない Insert が来たときに使用中の矩形から空き領域を作り直す（Insert で得ていない矩形は無視）
+    void Remove(const AtlasRect& rect);
+
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+    uint64_t GetUsedArea() const { return m_usedArea; }
+    float GetOccupancy() const { return m_width && m_height ? float(double(m_usedArea) / (double(m_width) * m_height)) : 0.0f; }
+    size_t GetFreeRectCount() const { return m_free.size(); }
+
+private:
+    void SplitFree_(const AtlasRect& used);
+    void RebuildFree_();
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint64_t m_usedArea = 0;
+    std::vector<AtlasRect> m_free;
+    std::vector<AtlasRect> m_used;
+    bool m_fragmented = false; // Remove 後で m_free が極大矩形の集合になっていない
+};
+
+} // namespace jisaku
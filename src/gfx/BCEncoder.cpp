@@ -0,0 +1,539 @@
+#include "gfx/BCEncoder.h"
+#include "core/CpuFeatures.h"
+#include "core/JobSystem.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#if JISAKU_X86
+#include <immintrin.h>
+#endif
+
+using namespace jisaku;
+
+namespace {
+
+// 4x4 ブロック（SoA: R,G,B,A）。SIMD で 4/8 ピクセルずつ読むので 32byte 境界に揃える
+struct alignas(32) Block {
+    float ch[4][16];
+};
+
+const float kWeightRGB[4]  = { 1.0f, 1.0f, 1.0f, 0.0f };
+const float kWeightRGBA[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+const float kWeightR[4]    = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+// BC7 4bit インデックスの補間ウェイト（/64）
+const int kBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+// BC1 4色モードのインデックス→補間係数
+const float kBC1T[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+void LoadBlock(const ConstImageView& src, uint32_t bx, uint32_t by, Block& b) {
+    for (uint32_t y = 0; y < 4; ++y) {
+        const uint8_t* row = src.Row((std::min)(by * 4 + y, src.height - 1));
+        for (uint32_t x = 0; x < 4; ++x) {
+            const uint8_t* p = row + size_t((std::min)(bx * 4 + x, src.width - 1)) * 4;
+            const int i = int(y * 4 + x);
+            for (int c = 0; c < 4; ++c) b.ch[c][i] = p[c];
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// インデックス探索: 各ピクセルで重み付き二乗誤差が最小のパレット番号を選び、総誤差を返す
+// ---------------------------------------------------------------------------
+using FindIndicesFn = float (*)(const Block&, const float (*pal)[4], int n, const float w[4], uint8_t idx[16]);
+
+float FindIndicesScalar(const Block& b, const float (*pal)[4], int n, const float w[4], uint8_t idx[16]) {
+    float total = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        float best = FLT_MAX;
+        int bi = 0;
+        for (int k = 0; k < n; ++k) {
+            float d = 0.0f;
+            for (int c = 0; c < 4; ++c) {
+                const float t = b.ch[c][i] - pal[k][c];
+                d += t * t * w[c];
+            }
+            if (d < best) { best = d; bi = k; }
+        }
+        idx[i] = (uint8_t)bi;
+        total += best;
+    }
+    return total;
+}
+
+#if JISAKU_X86
+JISAKU_TARGET_SSE41
+float FindIndicesSSE41(const Block& b, const float (*pal)[4], int n, const float w[4], uint8_t idx[16]) {
+    __m128 wv[4];
+    for (int c = 0; c < 4; ++c) wv[c] = _mm_set1_ps(w[c]);
+    __m128 total = _mm_setzero_ps();
+    for (int i = 0; i < 16; i += 4) {
+        __m128 p[4];
+        for (int c = 0; c < 4; ++c) p[c] = _mm_load_ps(&b.ch[c][i]);
+        __m128 best = _mm_set1_ps(FLT_MAX);
+        __m128 bestIdx = _mm_setzero_ps();
+        for (int k = 0; k < n; ++k) {
+            __m128 d = _mm_setzero_ps();
+            for (int c = 0; c < 4; ++c) {
+                const __m128 t = _mm_sub_ps(p[c], _mm_set1_ps(pal[k][c]));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_mul_ps(t, t), wv[c]));
+            }
+            const __m128 lt = _mm_cmplt_ps(d, best);
+            best = _mm_blendv_ps(best, d, lt);
+            bestIdx = _mm_blendv_ps(bestIdx, _mm_castsi128_ps(_mm_set1_epi32(k)), lt);
+        }
+        alignas(16) int32_t tmp[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp), _mm_castps_si128(bestIdx));
+        for (int j = 0; j < 4; ++j) idx[i + j] = (uint8_t)tmp[j];
+        total = _mm_add_ps(total, best);
+    }
+    alignas(16) float t[4];
+    _mm_store_ps(t, total);
+    return t[0] + t[1] + t[2] + t[3];
+}
+
+JISAKU_TARGET_AVX2
+float FindIndicesAVX2(const Block& b, const float (*pal)[4], int n, const float w[4], uint8_t idx[16]) {
+    __m256 wv[4];
+    for (int c = 0; c < 4; ++c) wv[c] = _mm256_set1_ps(w[c]);
+    __m256 total = _mm256_setzero_ps();
+    for (int i = 0; i < 16; i += 8) {
+        __m256 p[4];
+        for (int c = 0; c < 4; ++c) p[c] = _mm256_load_ps(&b.ch[c][i]);
+        __m256 best = _mm256_set1_ps(FLT_MAX);
+        __m256 bestIdx = _mm256_setzero_ps();
+        for (int k = 0; k < n; ++k) {
+            __m256 d = _mm256_setzero_ps();
+            for (int c = 0; c < 4; ++c) {
+                const __m256 t = _mm256_sub_ps(p[c], _mm256_set1_ps(pal[k][c]));
+                d = _mm256_fmadd_ps(_mm256_mul_ps(t, t), wv[c], d);
+            }
+            const __m256 lt = _mm256_cmp_ps(d, best, _CMP_LT_OQ);
+            best = _mm256_blendv_ps(best, d, lt);
+            bestIdx = _mm256_blendv_ps(bestIdx, _mm256_castsi256_ps(_mm256_set1_epi32(k)), lt);
+        }
+        alignas(32) int32_t tmp[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tmp), _mm256_castps_si256(bestIdx));
+        for (int j = 0; j < 8; ++j) idx[i + j] = (uint8_t)tmp[j];
+        total = _mm256_add_ps(total, best);
+    }
+    alignas(32) float t[8];
+    _mm256_store_ps(t, total);
+    return t[0] + t[1] + t[2] + t[3] + t[4] + t[5] + t[6] + t[7];
+}
+#endif
+
+FindIndicesFn GetFindIndices() {
+    static const FindIndicesFn s_fn = []() -> FindIndicesFn {
+#if JISAKU_X86
+        const auto& f = GetCpuFeatures();
+        if (f.avx2) return FindIndicesAVX2;
+        if (f.sse41) return FindIndicesSSE41;
+#endif
+        return FindIndicesScalar;
+    }();
+    return s_fn;
+}
+
+float Clamp255(float v) { return (std::min)((std::max)(v, 0.0f), 255.0f); }
+
+// ---------------------------------------------------------------------------
+// 端点推定（先頭 channels 個のチャンネルのみ。値域は 0-255）
+// ---------------------------------------------------------------------------
+void FitEndpoints(const Block& b, int channels, BCQuality q, float e0[4], float e1[4]) {
+    float mean[4] = {}, mn[4], mx[4];
+    for (int c = 0; c < 4; ++c) {
+        e0[c] = e1[c] = 0.0f;
+        mn[c] = FLT_MAX; mx[c] = -FLT_MAX;
+    }
+    for (int c = 0; c < channels; ++c) {
+        for (int i = 0; i < 16; ++i) {
+            const float v = b.ch[c][i];
+            mean[c] += v;
+            mn[c] = (std::min)(mn[c], v);
+            mx[c] = (std::max)(mx[c], v);
+        }
+        mean[c] /= 16.0f;
+    }
+
+    if (q == BCQuality::Fast) {
+        // バウンディングボックスの対角。最大レンジのチャンネルと負相関なチャンネルは向きを反転
+        int ref = 0;
+        for (int c = 1; c < channels; ++c)
+            if (mx[c] - mn[c] > mx[ref] - mn[ref]) ref = c;
+        for (int c = 0; c < channels; ++c) {
+            float cov = 0.0f;
+            for (int i = 0; i < 16; ++i) cov += (b.ch[c][i] - mean[c]) * (b.ch[ref][i] - mean[ref]);
+            const float inset = (mx[c] - mn[c]) / 16.0f;
+            const float lo = mn[c] + inset, hi = mx[c] - inset;
+            e0[c] = cov < 0.0f ? hi : lo;
+            e1[c] = cov < 0.0f ? lo : hi;
+        }
+        return;
+    }
+
+    // 共分散行列の主成分軸をべき乗法で求める
+    float cov[4][4] = {};
+    for (int i = 0; i < 16; ++i) {
+        for (int r = 0; r < channels; ++r) {
+            const float dr = b.ch[r][i] - mean[r];
+            for (int c = r; c < channels; ++c) cov[r][c] += dr * (b.ch[c][i] - mean[c]);
+        }
+    }
+    for (int r = 0; r < channels; ++r)
+        for (int c = 0; c < r; ++c) cov[r][c] = cov[c][r];
+
+    float axis[4] = {};
+    for (int c = 0; c < channels; ++c) axis[c] = mx[c] - mn[c];
+    for (int iter = 0; iter < 8; ++iter) {
+        float v[4] = {};
+        float m = 0.0f;
+        for (int r = 0; r < channels; ++r) {
+            for (int c = 0; c < channels; ++c) v[r] += cov[r][c] * axis[c];
+            m = (std::max)(m, std::fabs(v[r]));
+        }
+        if (m < 1e-6f) break;
+        for (int c = 0; c < channels; ++c) axis[c] = v[c] / m;
+    }
+    float len2 = 0.0f;
+    for (int c = 0; c < channels; ++c) len2 += axis[c] * axis[c];
+    if (len2 < 1e-12f) {
+        for (int c = 0; c < channels; ++c) e0[c] = e1[c] = mean[c];
+        return;
+    }
+    const float inv = 1.0f / std::sqrt(len2);
+    for (int c = 0; c < channels; ++c) axis[c] *= inv;
+
+    float tmin = FLT_MAX, tmax = -FLT_MAX;
+    for (int i = 0; i < 16; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < channels; ++c) t += (b.ch[c][i] - mean[c]) * axis[c];
+        tmin = (std::min)(tmin, t);
+        tmax = (std::max)(tmax, t);
+    }
+    for (int c = 0; c < channels; ++c) {
+        e0[c] = Clamp255(mean[c] + axis[c] * tmin);
+        e1[c] = Clamp255(mean[c] + axis[c] * tmax);
+    }
+}
+
+// 各ピクセルの補間係数 t（0→e0, 1→e1）を固定して端点を最小二乗で解き直す
+bool RefineEndpoints(const Block& b, int channels, const float t[16], float e0[4], float e1[4]) {
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float d0[4] = {}, d1[4] = {};
+    for (int i = 0; i < 16; ++i) {
+        const float s = 1.0f - t[i];
+        aa += s * s; bb += t[i] * t[i]; ab += s * t[i];
+        for (int c = 0; c < channels; ++c) {
+            d0[c] += s * b.ch[c][i];
+            d1[c] += t[i] * b.ch[c][i];
+        }
+    }
+    const float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f) return false;
+    const float inv = 1.0f / det;
+    for (int c = 0; c < channels; ++c) {
+        e0[c] = Clamp255((d0[c] * bb - d1[c] * ab) * inv);
+        e1[c] = Clamp255((d1[c] * aa - d0[c] * ab) * inv);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// BC1 カラーブロック（常に 4 色モード。BC3 のカラー部にも使う）
+// ---------------------------------------------------------------------------
+uint16_t To565(const float c[4]) {
+    const int r = (int)std::lround(Clamp255(c[0]) * 31.0f / 255.0f);
+    const int g = (int)std::lround(Clamp255(c[1]) * 63.0f / 255.0f);
+    const int b = (int)std::lround(Clamp255(c[2]) * 31.0f / 255.0f);
+    return uint16_t((r << 11) | (g << 5) | b);
+}
+
+void From565(uint16_t v, float out[4]) {
+    const int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+    out[0] = float((r << 3) | (r >> 2));
+    out[1] = float((g << 2) | (g >> 4));
+    out[2] = float((b << 3) | (b >> 2));
+    out[3] = 0.0f;
+}
+
+// c0 > c1 になるよう e0/e1 を入れ替えることがある（idx は入れ替え後の端点基準）
+float EncodeBC1Color(const Block& b, float e0[4], float e1[4], uint8_t out[8], uint8_t idx[16]) {
+    uint16_t c0 = To565(e0), c1 = To565(e1);
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        for (int c = 0; c < 4; ++c) std::swap(e0[c], e1[c]);
+    }
+    float pal[4][4];
+    From565(c0, pal[0]);
+    From565(c1, pal[1]);
+    for (int c = 0; c < 4; ++c) {
+        pal[2][c] = (2.0f * pal[0][c] + pal[1][c]) / 3.0f;
+        pal[3][c] = (pal[0][c] + 2.0f * pal[1][c]) / 3.0f;
+    }
+    // c0 == c1 はデコーダ上 3 色モードになるのでインデックス 0 だけを使う
+    const float err = GetFindIndices()(b, pal, c0 == c1 ? 1 : 4, kWeightRGB, idx);
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i) bits |= uint32_t(idx[i]) << (2 * i);
+    out[0] = uint8_t(c0); out[1] = uint8_t(c0 >> 8);
+    out[2] = uint8_t(c1); out[3] = uint8_t(c1 >> 8);
+    std::memcpy(out + 4, &bits, 4);
+    return err;
+}
+
+void EncodeColorBlock(const Block& b, BCQuality q, uint8_t out[8]) {
+    float e0[4], e1[4];
+    uint8_t idx[16];
+    FitEndpoints(b, 3, q, e0, e1);
+    float bestErr = EncodeBC1Color(b, e0, e1, out, idx);
+    if (q != BCQuality::High) return;
+
+    for (int iter = 0; iter < 2 && bestErr > 0.0f; ++iter) {
+        float t[16];
+        for (int i = 0; i < 16; ++i) t[i] = kBC1T[idx[i]];
+        if (!RefineEndpoints(b, 3, t, e0, e1)) break;
+        uint8_t cand[8];
+        const float err = EncodeBC1Color(b, e0, e1, cand, idx);
+        if (err >= bestErr) break;
+        bestErr = err;
+        std::memcpy(out, cand, 8);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// BC4 単チャンネルブロック（BC3 のアルファ、BC4、BC5 の各チャンネル）
+// ---------------------------------------------------------------------------
+float EncodeBC4(const Block& s, int e0, int e1, uint8_t out[8], uint8_t idx[16]) {
+    float pal[8][4] = {};
+    pal[0][0] = float(e0);
+    pal[1][0] = float(e1);
+    if (e0 > e1) {
+        for (int k = 2; k < 8; ++k) pal[k][0] = float(((8 - k) * e0 + (k - 1) * e1) / 7);
+    } else {
+        for (int k = 2; k < 6; ++k) pal[k][0] = float(((6 - k) * e0 + (k - 1) * e1) / 5);
+        pal[6][0] = 0.0f;
+        pal[7][0] = 255.0f;
+    }
+    const float err = GetFindIndices()(s, pal, 8, kWeightR, idx);
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 16; ++i) bits |= uint64_t(idx[i]) << (3 * i);
+    out[0] = uint8_t(e0);
+    out[1] = uint8_t(e1);
+    for (int i = 0; i < 6; ++i) out[2 + i] = uint8_t(bits >> (8 * i));
+    return err;
+}
+
+void EncodeSingleChannelBlock(const Block& b, int channel, BCQuality q, uint8_t out[8]) {
+    Block s{};
+    float mn = 255.0f, mx = 0.0f;
+    float mnInner = 255.0f, mxInner = 0.0f; // 0 と 255 を除いた範囲（6 値モード用）
+    for (int i = 0; i < 16; ++i) {
+        const float v = b.ch[channel][i];
+        s.ch[0][i] = v;
+        mn = (std::min)(mn, v);
+        mx = (std::max)(mx, v);
+        if (v > 0.0f && v < 255.0f) {
+            mnInner = (std::min)(mnInner, v);
+            mxInner = (std::max)(mxInner, v);
+        }
+    }
+
+    uint8_t idx[16];
+    float bestErr = EncodeBC4(s, int(mx), int(mn), out, idx);
+    if (q != BCQuality::High || bestErr <= 0.0f) return;
+
+    uint8_t cand[8];
+    // 8 値モードの端点を最小二乗で詰める
+    float t[16];
+    for (int i = 0; i < 16; ++i) t[i] = idx[i] == 0 ? 0.0f : idx[i] == 1 ? 1.0f : float(idx[i] - 1) / 7.0f;
+    float e0[4] = { mx }, e1[4] = { mn };
+    if (RefineEndpoints(s, 1, t, e0, e1)) {
+        int r0 = (int)std::lround(e0[0]), r1 = (int)std::lround(e1[0]);
+        if (r0 > r1) {
+            const float err = EncodeBC4(s, r0, r1, cand, idx);
+            if (err < bestErr) { bestErr = err; std::memcpy(out, cand, 8); }
+        }
+    }
+    // 0/255 を含むブロックは 6 値モードの方が良いことがある
+    if (mnInner <= mxInner) {
+        const float err = EncodeBC4(s, int(mnInner), int(mxInner), cand, idx);
+        if (err < bestErr) { std::memcpy(out, cand, 8); }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// BC7 mode 6（1 サブセット, RGBA 7bit + p-bit, 4bit インデックス）
+// ---------------------------------------------------------------------------
+struct BitWriter {
+    uint8_t* out;
+    int pos = 0;
+    void Put(uint32_t v, int bits) {
+        for (int i = 0; i < bits; ++i, ++pos) {
+            if ((v >> i) & 1u) out[pos >> 3] |= uint8_t(1u << (pos & 7));
+        }
+    }
+};
+
+void QuantizeBC7(const float e[4], int pbit, int q[4]) {
+    for (int c = 0; c < 4; ++c) {
+        const int v = (int)std::lround((e[c] - float(pbit)) * 0.5f);
+        q[c] = (std::min)((std::max)(v, 0), 127);
+    }
+}
+
+int BestPBit(const float e[4]) {
+    float err[2] = {};
+    for (int p = 0; p < 2; ++p) {
+        int q[4];
+        QuantizeBC7(e, p, q);
+        for (int c = 0; c < 4; ++c) {
+            const float d = float((q[c] << 1) | p) - e[c];
+            err[p] += d * d;
+        }
+    }
+    return err[1] < err[0] ? 1 : 0;
+}
+
+float EncodeBC7Mode6(const Block& b, const float e0[4], const float e1[4], int p0, int p1,
+                     uint8_t out[16], uint8_t idx[16]) {
+    int q0[4], q1[4];
+    QuantizeBC7(e0, p0, q0);
+    QuantizeBC7(e1, p1, q1);
+
+    float pal[16][4];
+    for (int k = 0; k < 16; ++k) {
+        const int w = kBC7Weights4[k];
+        for (int c = 0; c < 4; ++c) {
+            const int v0 = (q0[c] << 1) | p0, v1 = (q1[c] << 1) | p1;
+            pal[k][c] = float(((64 - w) * v0 + w * v1 + 32) >> 6);
+        }
+    }
+    const float err = GetFindIndices()(b, pal, 16, kWeightRGBA, idx);
+
+    // アンカー（ピクセル 0）の MSB は暗黙 0 なので、立っていれば端点を入れ替えて反転する
+    if (idx[0] & 8) {
+        for (int c = 0; c < 4; ++c) std::swap(q0[c], q1[c]);
+        std::swap(p0, p1);
+        for (int i = 0; i < 16; ++i) idx[i] = uint8_t(15 - idx[i]);
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter bw{ out };
+    bw.Put(1u << 6, 7); // mode 6: 0 が 6 個のあとに 1
+    for (int c = 0; c < 4; ++c) {
+        bw.Put(uint32_t(q0[c]), 7);
+        bw.Put(uint32_t(q1[c]), 7);
+    }
+    bw.Put(uint32_t(p0), 1);
+    bw.Put(uint32_t(p1), 1);
+    bw.Put(idx[0], 3);
+    for (int i = 1; i < 16; ++i) bw.Put(idx[i], 4);
+    return err;
+}
+
+void EncodeBC7Block(const Block& b, BCQuality q, uint8_t out[16]) {
+    float e0[4], e1[4];
+    uint8_t idx[16];
+    FitEndpoints(b, 4, q, e0, e1);
+    float bestErr = EncodeBC7Mode6(b, e0, e1, BestPBit(e0), BestPBit(e1), out, idx);
+    if (q != BCQuality::High || bestErr <= 0.0f) return;
+
+    uint8_t cand[16];
+    for (int iter = 0; iter < 2; ++iter) {
+        // idx は入れ替え後の向きなので、端点もそれに合わせて解き直す
+        float t[16];
+        for (int i = 0; i < 16; ++i) t[i] = float(kBC7Weights4[idx[i]]) / 64.0f;
+        float r0[4], r1[4];
+        if (!RefineEndpoints(b, 4, t, r0, r1)) break;
+        bool improved = false;
+        uint8_t bestIdx[16];
+        for (int p = 0; p < 4; ++p) {
+            uint8_t ci[16];
+            const float err = EncodeBC7Mode6(b, r0, r1, p & 1, p >> 1, cand, ci);
+            if (err < bestErr) {
+                bestErr = err;
+                std::memcpy(out, cand, 16);
+                std::memcpy(bestIdx, ci, 16);
+                improved = true;
+            }
+        }
+        if (!improved) break;
+        std::memcpy(idx, bestIdx, 16);
+    }
+}
+
+void EncodeBlock(const Block& b, const BCEncodeOptions& opt, uint8_t* out) {
+    switch (opt.format) {
+    case BCFormat::BC1:
+        EncodeColorBlock(b, opt.quality, out);
+        break;
+    case BCFormat::BC3:
+        EncodeSingleChannelBlock(b, 3, opt.quality, out);
+        EncodeColorBlock(b, opt.quality, out + 8);
+        break;
+    case BCFormat::BC4:
+        EncodeSingleChannelBlock(b, 0, opt.quality, out);
+        break;
+    case BCFormat::BC5:
+        EncodeSingleChannelBlock(b, 0, opt.quality, out);
+        EncodeSingleChannelBlock(b, 1, opt.quality, out + 8);
+        break;
+    case BCFormat::BC7:
+        EncodeBC7Block(b, opt.quality, out);
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace
+
+size_t jisaku::BCBlockBytes(BCFormat fmt) {
+    switch (fmt) {
+    case BCFormat::BC1:
+    case BCFormat::BC4: return 8;
+    case BCFormat::BC3:
+    case BCFormat::BC5:
+    case BCFormat::BC7: return 16;
+    default: return 0;
+    }
+}
+
+size_t jisaku::BCRowPitch(BCFormat fmt, uint32_t width) {
+    return size_t((width + 3) / 4) * BCBlockBytes(fmt);
+}
+
+size_t jisaku::BCSurfaceSize(BCFormat fmt, uint32_t width, uint32_t height) {
+    return BCRowPitch(fmt, width) * ((height + 3) / 4);
+}
+
+bool jisaku::EncodeBC(const ConstImageView& src, const BCEncodeOptions& opt, uint8_t* dst, size_t dstRowPitch) {
+    const size_t blockBytes = BCBlockBytes(opt.format);
+    if (blockBytes == 0 || !src.data || !dst || src.width == 0 || src.height == 0) return false;
+
+    const uint32_t blocksX = (src.width + 3) / 4;
+    const uint32_t blocksY = (src.height + 3) / 4;
+    auto encodeRows = [&](uint32_t by0, uint32_t by1) {
+        Block blk;
+        for (uint32_t by = by0; by < by1; ++by) {
+            uint8_t* out = dst + size_t(by) * dstRowPitch;
+            for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                LoadBlock(src, bx, by, blk);
+                EncodeBlock(blk, opt, out + size_t(bx) * blockBytes);
+            }
+        }
+    };
+
+    if (opt.parallel && blocksY > 1) {
+        // 1 タスクあたり 512 ブロック程度になるよう行をまとめる
+        const uint32_t grain = (std::max)(1u, 512u / blocksX);
+        JobSystem::Get().ParallelFor(blocksY, grain, encodeRows);
+    } else {
+        encodeRows(0, blocksY);
+    }
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "gfx/ImageData.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace jisaku {
+
+// CPU ブロック圧縮エンコーダ（D3D/Windows 非依存。アセットのクックにもそのまま使える）
+enum class BCFormat : uint8_t {
+    None,
+    BC1,  // RGB（アルファ無し）
+    BC3,  // RGB + 補間アルファ
+    BC4,  // R 単チャンネル
+    BC5,  // RG 2チャンネル（法線マップ向け）
+    BC7,  // RGBA 高品質（mode 6）
+};
+
+enum class BCQuality : uint8_t {
+    Fast, // 端点はバウンディングボックスから。ホットリロード中の反復向け
+    High, // 主成分軸 + 最小二乗で端点を詰める。出荷データ向け
+};
+
+struct BCEncodeOptions {
+    BCFormat format = BCFormat::None;
+    BCQuality quality = BCQuality::Fast;
+    bool parallel = true; // ブロック行を JobSystem に分散する
+};
+
+// 4x4 ブロック 1 個あたりのバイト数（BC1/BC4 = 8, それ以外 = 16）
+size_t BCBlockBytes(BCFormat fmt);
+// ブロック行 1 行分のバイト数
+size_t BCRowPitch(BCFormat fmt, uint32_t width);
+size_t BCSurfaceSize(BCFormat fmt, uint32_t width, uint32_t height);
+
+// src (RGBA8) を圧縮して dst に書き込む。dstRowPitch はブロック行単位のピッチ。
+// 4 の倍数でない端のブロックは端のピクセルを複製して埋める。
+bool EncodeBC(const ConstImageView& src, const BCEncodeOptions& opt, uint8_t* dst, size_t dstRowPitch);
+
+} // namespace jisaku
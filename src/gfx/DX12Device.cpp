@@ -1,4 +1,5 @@
 #include "DX12Device.h"
+#include "PipelineCache.h"
 #include "Swapchain.h"
 #include <d3d12.h>
 #include <dxgi1_6.h>
@@ -26,6 +27,7 @@ namespace jisaku
             spdlog::error("Failed to create D3D12 device");
             return false;
         }
+        m_pipelineCache = std::make_unique<PipelineCache>(m_device.Get());
 
         if (!CreateCommandQueue())
         {
@@ -60,6 +62,10 @@ namespace jisaku
 
     void DX12Device::Shutdown()
     {
+        // 呼び出し側が GPU の完了を待ってから破棄する前提
+        m_releaseQueue.ReleaseAll();
+        m_pipelineCache.reset();
+
         if (m_commandList)
         {
             m_commandList->Release();
@@ -168,6 +174,7 @@ namespace jisaku
 
     void DX12Device::BeginFrame()
     {
+        m_releaseQueue.Collect(m_fence->GetCompletedValue());
         m_commandAllocator->Reset();
         m_commandList->Reset(m_commandAllocator.Get(), nullptr);
     }
@@ -177,6 +184,8 @@ namespace jisaku
         m_commandList->Close();
         ID3D12CommandList* lists[] = { m_commandList.Get() };
         m_commandQueue->ExecuteCommandLists(1, lists);
+        // フレームごとに進めておく（差し替えた古いリソースの解放判定に使う）
+        Signal();
         swap.Present(vsync);
         m_frameIndex = (m_frameIndex + 1) % 2; // ダブルバッファリング
     }
@@ -200,11 +209,17 @@ namespace jisaku
         return true;
     }
 
-    void DX12Device::WaitIdle()
+    UINT64 DX12Device::Signal()
     {
-        // m_queue, m_fence, m_fenceValue, m_fenceEvent を保持している前提
         const UINT64 signal = ++m_fenceValue;
         m_commandQueue->Signal(m_fence.Get(), signal);
+        return signal;
+    }
+
+    void DX12Device::WaitIdle()
+    {
+        // m_queue, m_fence, m_fenceValue, m_fenceEvent を保持している前提
+        const UINT64 signal = Signal();
         if (m_fence->GetCompletedValue() < signal) {
             m_fence->SetEventOnCompletion(signal, m_fenceEvent);
             WaitForSingleObject(m_fenceEvent, INFINITE);
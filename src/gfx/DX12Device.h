@@ -5,9 +5,12 @@
 #include <wrl/client.h>
 #include <memory>
 #include <functional>
+#include "core/DeferredReleaseQueue.h"
 
 namespace jisaku
 {
+    class PipelineCache;
+
     class DX12Device
     {
     public:
@@ -22,6 +25,8 @@ namespace jisaku
         ID3D12CommandAllocator* GetCommandAllocator() const { return m_commandAllocator.Get(); }
         ID3D12GraphicsCommandList* GetCommandList() const { return m_commandList.Get(); }
         Microsoft::WRL::ComPtr<IDXGIFactory6> GetFactory() const { return m_factory; }
+        // ルートシグネチャと PSO はこれで作る（ワーカースレッドからも呼んでよい）
+        PipelineCache* GetPipelineCache() const { return m_pipelineCache.get(); }
         
         // 新しいAPI
         ID3D12CommandQueue* GetQueue() const { return m_commandQueue.Get(); }
@@ -29,6 +34,14 @@ namespace jisaku
         UINT GetFrameIndex() const { return m_frameIndex; }
         UINT GetFrameCount() const { return m_frameCount; }
         void WaitIdle();
+        // キューにフェンスを 1 つ進めて Signal し、その値を返す（これより前に積んだコマンドはこの値の完了時に終わっている）
+        UINT64 Signal();
+        // 次の Signal（WaitIdle 等）で使われるフェンス値。これより前に積んだコマンドはこの値の完了時に終わっている
+        UINT64 GetNextFenceValue() const { return m_fenceValue + 1; }
+        UINT64 GetCompletedFenceValue() const { return m_fence->GetCompletedValue(); }
+        // GPU がまだ参照しているかもしれないもの（差し替えた PSO・リソース・SRV スロット等）は、
+        // GetNextFenceValue を付けてここへ預ける。BeginFrame で GPU が過ぎたものをまとめて手放す
+        DeferredReleaseQueue& GetReleaseQueue() { return m_releaseQueue; }
         void BeginFrame();
         void EndFrameAndPresent(class Swapchain& swap, bool vsync);
         void ExecuteAndWait(std::function<void(ID3D12GraphicsCommandList*)> record);
@@ -46,10 +59,12 @@ namespace jisaku
 
         Microsoft::WRL::ComPtr<IDXGIFactory6> m_factory;
         Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+        std::unique_ptr<PipelineCache> m_pipelineCache;
         Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_commandQueue;
         Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_commandAllocator;
         Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_commandList;
         Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+        DeferredReleaseQueue m_releaseQueue;
         UINT64 m_fenceValue;
         HANDLE m_fenceEvent;
         UINT m_frameIndex;
@@ -0,0 +1,246 @@
+#include "gfx/HdrDecoder.h"
+#include "core/ByteOrder.h"
+#include <tinyexr.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Radiance RGBE
+// ---------------------------------------------------------------------------
+struct RadianceHeader {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool bottomUp = false; // "+Y H +X W"
+    size_t dataOffset = 0;
+};
+
+bool ParseRadianceHeader(const uint8_t* data, size_t size, RadianceHeader& h) {
+    size_t pos = 0;
+    auto readLine = [&](std::string_view& line) {
+        const void* nl = pos < size ? std::memchr(data + pos, '\n', size - pos) : nullptr;
+        if (!nl) return false;
+        const size_t end = size_t(static_cast<const uint8_t*>(nl) - data);
+        line = std::string_view(reinterpret_cast<const char*>(data + pos), end - pos);
+        pos = end + 1;
+        return true;
+    };
+
+    std::string_view line;
+    if (!readLine(line) || line.substr(0, 2) != "#?") return false;
+    // 空行までが変数行
+    while (true) {
+        if (!readLine(line)) return false;
+        if (line.empty()) break;
+        if (line.substr(0, 7) == "FORMAT=" && line != "FORMAT=32-bit_rle_rgbe") return false;
+    }
+
+    // 解像度行。X 方向は +X のみ対応
+    if (!readLine(line) || line.size() > 64) return false;
+    const std::string res(line);
+    char ya[3] = {}, xa[3] = {};
+    unsigned hh = 0, ww = 0;
+    if (std::sscanf(res.c_str(), "%2s %u %2s %u", ya, &hh, xa, &ww) != 4) return false;
+    if (std::strcmp(xa, "+X") != 0 || (std::strcmp(ya, "-Y") != 0 && std::strcmp(ya, "+Y") != 0)) return false;
+    if (ww == 0 || hh == 0 || ww > 32768 || hh > 32768) return false;
+    h.width = ww;
+    h.height = hh;
+    h.bottomUp = ya[0] == '+';
+    h.dataOffset = pos;
+    return true;
+}
+
+// 1 走査線を RGBE で rgbe[width * 4] に展開する
+bool ReadRadianceScanline(const uint8_t*& p, const uint8_t* end, uint32_t width, uint8_t* rgbe) {
+    if (width >= 8 && width < 32768 && end - p >= 4 && p[0] == 2 && p[1] == 2 && (p[2] & 0x80) == 0) {
+        // 新 RLE: チャンネルごとに (ラン長 > 128 なら繰り返し、以下ならリテラル)
+        if (((uint32_t(p[2]) << 8) | p[3]) != width) return false;
+        p += 4;
+        for (int c = 0; c < 4; ++c) {
+            for (uint32_t x = 0; x < width;) {
+                if (p >= end) return false;
+                uint32_t count = *p++;
+                if (count > 128) {
+                    count -= 128;
+                    if (count > width - x || p >= end) return false;
+                    const uint8_t v = *p++;
+                    for (uint32_t i = 0; i < count; ++i) rgbe[size_t(x + i) * 4 + c] = v;
+                } else {
+                    if (count == 0 || count > width - x || uint32_t(end - p) < count) return false;
+                    for (uint32_t i = 0; i < count; ++i) rgbe[size_t(x + i) * 4 + c] = p[i];
+                    p += count;
+                }
+                x += count;
+            }
+        }
+        return true;
+    }
+
+    // 無圧縮または旧 RLE（1,1,1,n は直前の画素を n 回。連続すると 8bit ずつ上位桁になる）
+    uint32_t shift = 0;
+    for (uint32_t x = 0; x < width;) {
+        if (end - p < 4) return false;
+        if (p[0] == 1 && p[1] == 1 && p[2] == 1) {
+            if (x == 0 || shift > 24) return false;
+            const uint32_t count = uint32_t(p[3]) << shift;
+            if (count > width - x) return false;
+            for (uint32_t i = 0; i < count; ++i, ++x) std::memcpy(rgbe + size_t(x) * 4, rgbe + size_t(x - 1) * 4, 4);
+            shift += 8;
+        } else {
+            std::memcpy(rgbe + size_t(x) * 4, p, 4);
+            ++x;
+            shift = 0;
+        }
+        p += 4;
+    }
+    return true;
+}
+
+void RgbeToFloat(const uint8_t* rgbe, uint32_t width, float* out) {
+    for (uint32_t x = 0; x < width; ++x, rgbe += 4, out += 4) {
+        if (rgbe[3] == 0) {
+            out[0] = out[1] = out[2] = 0.0f;
+        } else {
+            const float f = std::ldexp(1.0f, int(rgbe[3]) - (128 + 8));
+            out[0] = float(rgbe[0]) * f;
+            out[1] = float(rgbe[1]) * f;
+            out[2] = float(rgbe[2]) * f;
+        }
+        out[3] = 1.0f;
+    }
+}
+
+bool DecodeRadiance(const uint8_t* data, size_t size, const FloatImageView& dst) {
+    RadianceHeader h;
+    if (!ParseRadianceHeader(data, size, h) || h.width != dst.width || h.height != dst.height) return false;
+    const uint8_t* p = data + h.dataOffset;
+    const uint8_t* end = data + size;
+    std::vector<uint8_t> rgbe(size_t(h.width) * 4);
+    for (uint32_t y = 0; y < h.height; ++y) {
+        if (!ReadRadianceScanline(p, end, h.width, rgbe.data())) return false;
+        RgbeToFloat(rgbe.data(), h.width, dst.Row(h.bottomUp ? h.height - 1 - y : y));
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// OpenEXR。ヘッダは自前で読み（サイズ取得だけのために全体を展開しない）、本体は tinyexr
+// ---------------------------------------------------------------------------
+bool ParseExrHeader(const uint8_t* data, size_t size, ImageInfo& info) {
+    if (size < 8) return false;
+    const uint8_t* p = data + 8; // マジック + バージョン
+    const uint8_t* end = data + size;
+    auto readString = [&](std::string_view& s) {
+        const void* z = std::memchr(p, 0, size_t(end - p));
+        if (!z) return false;
+        s = std::string_view(reinterpret_cast<const char*>(p), size_t(static_cast<const uint8_t*>(z) - p));
+        p = static_cast<const uint8_t*>(z) + 1;
+        return true;
+    };
+
+    bool hasWindow = false;
+    info.hasAlpha = false;
+    while (p < end) {
+        std::string_view name, type;
+        if (!readString(name)) return false;
+        if (name.empty()) break; // ヘッダ終端
+        if (!readString(type) || end - p < 4) return false;
+        const uint32_t attrSize = ReadU32(p);
+        p += 4;
+        if (uint32_t(end - p) < attrSize) return false;
+
+        if (name == "dataWindow" && type == "box2i" && attrSize == 16) {
+            const int32_t xmin = (int32_t)ReadU32(p), ymin = (int32_t)ReadU32(p + 4);
+            const int32_t xmax = (int32_t)ReadU32(p + 8), ymax = (int32_t)ReadU32(p + 12);
+            if (xmax < xmin || ymax < ymin) return false;
+            info.width = uint32_t(int64_t(xmax) - xmin + 1);
+            info.height = uint32_t(int64_t(ymax) - ymin + 1);
+            hasWindow = true;
+        } else if (name == "channels" && type == "chlist") {
+            // (名前\0, pixelType, pLinear + 予約 3, xSampling, ySampling) の並び
+            for (size_t off = 0; off < attrSize && p[off] != 0;) {
+                const void* z = std::memchr(p + off, 0, attrSize - off);
+                if (!z) return false;
+                const size_t len = size_t(static_cast<const uint8_t*>(z) - (p + off));
+                if (len == 1 && p[off] == 'A') info.hasAlpha = true;
+                off += len + 1 + 16;
+            }
+        }
+        p += attrSize;
+    }
+    return hasWindow && info.width > 0 && info.height > 0;
+}
+
+bool DecodeExr(const uint8_t* data, size_t size, const FloatImageView& dst) {
+    float* rgba = nullptr;
+    int w = 0, h = 0;
+    const char* err = nullptr;
+    if (LoadEXRFromMemory(&rgba, &w, &h, data, size, &err) != TINYEXR_SUCCESS) {
+        if (err) FreeEXRErrorMessage(err);
+        return false;
+    }
+    const bool ok = uint32_t(w) == dst.width && uint32_t(h) == dst.height;
+    if (ok) {
+        for (uint32_t y = 0; y < dst.height; ++y)
+            std::memcpy(dst.Row(y), rgba + size_t(y) * w * 4, size_t(w) * 4 * sizeof(float));
+    }
+    std::free(rgba);
+    return ok;
+}
+
+} // namespace
+
+HdrFormat jisaku::DetectHdrFormat(const uint8_t* data, size_t size) {
+    auto startsWith = [&](const char* sig, size_t n) { return size >= n && std::memcmp(data, sig, n) == 0; };
+    if (startsWith("\x76\x2F\x31\x01", 4)) return HdrFormat::OpenEXR;
+    if (startsWith("#?RADIANCE", 10) || startsWith("#?RGBE", 6)) return HdrFormat::Radiance;
+    return HdrFormat::None;
+}
+
+const char* jisaku::HdrFormatName(HdrFormat format) {
+    switch (format) {
+    case HdrFormat::Radiance: return "Radiance";
+    case HdrFormat::OpenEXR: return "OpenEXR";
+    default: return "None";
+    }
+}
+
+bool jisaku::ReadHdrInfo(const uint8_t* data, size_t size, ImageInfo& info) {
+    switch (DetectHdrFormat(data, size)) {
+    case HdrFormat::Radiance: {
+        RadianceHeader h;
+        if (!ParseRadianceHeader(data, size, h)) return false;
+        info.width = h.width;
+        info.height = h.height;
+        info.hasAlpha = false;
+        return true;
+    }
+    case HdrFormat::OpenEXR:
+        return ParseExrHeader(data, size, info);
+    default:
+        return false;
+    }
+}
+
+bool jisaku::DecodeHdr(const uint8_t* data, size_t size, const FloatImageView& dst) {
+    switch (DetectHdrFormat(data, size)) {
+    case HdrFormat::Radiance: return DecodeRadiance(data, size, dst);
+    case HdrFormat::OpenEXR: return DecodeExr(data, size, dst);
+    default: return false;
+    }
+}
+
+bool jisaku::DecodeHdrImage(const uint8_t* data, size_t size, FloatImage& out) {
+    ImageInfo info;
+    if (!ReadHdrInfo(data, size, info)) return false;
+    out.Allocate(info.width, info.height);
+    return DecodeHdr(data, size, out.View());
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "gfx/ImageData.h"
+#include "gfx/ImageDecoder.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace jisaku {
+
+// HDR 画像のデコーダ（D3D/Windows 非依存）。出力はリニア RGBA32F で、アルファが無い形式は 1 を入れる。
+// 8bit の ImageDecoderRegistry とは別口（TGA の緩い判定に拾われないよう、読み込み側で先に判定する）
+enum class HdrFormat : uint8_t {
+    None,
+    Radiance, // .hdr / .pic（RGBE。新旧 RLE とも対応、XYZE は非対応）
+    OpenEXR,  // .exr（tinyexr）
+};
+
+HdrFormat DetectHdrFormat(const uint8_t* data, size_t size);
+const char* HdrFormatName(HdrFormat format);
+
+// ヘッダだけ読んでサイズを得る（EXR は dataWindow）
+bool ReadHdrInfo(const uint8_t* data, size_t size, ImageInfo& info);
+
+// dst の幅/高さは ReadHdrInfo の結果と一致していること。行ピッチは任意
+bool DecodeHdr(const uint8_t* data, size_t size, const FloatImageView& dst);
+
+bool DecodeHdrImage(const uint8_t* data, size_t size, FloatImage& out);
+
+} // namespace jisaku
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jisaku {
+
+// CPU 側画像（RGBA8, 4byte/pixel）への参照。行ピッチは呼び出し側の都合（アップロードバッファ等）に合わせられる。
+struct ConstImageView {
+    const uint8_t* data = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t rowPitch = 0;
+
+    const uint8_t* Row(uint32_t y) const { return data + size_t(y) * rowPitch; }
+};
+
+struct ImageView {
+    uint8_t* data = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t rowPitch = 0;
+
+    uint8_t* Row(uint32_t y) const { return data + size_t(y) * rowPitch; }
+    operator ConstImageView() const { return { data, width, height, rowPitch }; }
+};
+
+// 所有する RGBA8 画像（行ピッチ = width * 4）
+struct Image {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+
+    void Allocate(uint32_t w, uint32_t h) { width = w; height = h; pixels.assign(size_t(w) * h * 4, 0); }
+    size_t RowPitch() const { return size_t(width) * 4; }
+    ImageView View() { return { pixels.data(), width, height, RowPitch() }; }
+    ConstImageView View() const { return { pixels.data(), width, height, RowPitch() }; }
+};
+
+// HDR 用のリニア RGBA32F 画像（16byte/pixel）。rowPitch はバイト単位
+struct ConstFloatImageView {
+    const float* data = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t rowPitch = 0;
+
+    const float* Row(uint32_t y) const { return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(data) + size_t(y) * rowPitch); }
+};
+
+struct FloatImageView {
+    float* data = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t rowPitch = 0;
+
+    float* Row(uint32_t y) const { return reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(data) + size_t(y) * rowPitch); }
+    operator ConstFloatImageView() const { return { data, width, height, rowPitch }; }
+};
+
+struct FloatImage {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> pixels;
+
+    void Allocate(uint32_t w, uint32_t h) { width = w; height = h; pixels.assign(size_t(w) * h * 4, 0.0f); }
+    size_t RowPitch() const { return size_t(width) * 4 * sizeof(float); }
+    FloatImageView View() { return { pixels.data(), width, height, RowPitch() }; }
+    ConstFloatImageView View() const { return { pixels.data(), width, height, RowPitch() }; }
+};
+
+} // namespace jisaku
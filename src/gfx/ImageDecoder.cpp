@@ -0,0 +1,406 @@
+#include "gfx/ImageDecoder.h"
+#include "core/ByteOrder.h"
+#ifndef JISAKU_NO_IMAGE_CODECS
+#include <spng.h>
+#include <turbojpeg.h>
+#endif
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+using namespace jisaku;
+
+namespace {
+
+#ifndef JISAKU_NO_IMAGE_CODECS
+// ---------------------------------------------------------------------------
+// PNG（libspng）。非インタレースは 1 行ずつ dst の行へ直接展開する
+// ---------------------------------------------------------------------------
+struct SpngDeleter {
+    void operator()(spng_ctx* ctx) const { spng_ctx_free(ctx); }
+};
+using SpngPtr = std::unique_ptr<spng_ctx, SpngDeleter>;
+
+SpngPtr OpenPng(const uint8_t* data, size_t size, spng_ihdr& ihdr) {
+    SpngPtr ctx(spng_ctx_new(0));
+    if (!ctx) return nullptr;
+    if (spng_set_png_buffer(ctx.get(), data, size) != 0) return nullptr;
+    if (spng_get_ihdr(ctx.get(), &ihdr) != 0) return nullptr;
+    return ctx;
+}
+
+class PngDecoder final : public IImageDecoder {
+public:
+    const char* Name() const override { return "PNG"; }
+
+    bool CanDecode(const uint8_t* data, size_t size) const override {
+        static const uint8_t kSig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        return size >= 8 && std::memcmp(data, kSig, 8) == 0;
+    }
+
+    bool ReadInfo(const uint8_t* data, size_t size, ImageInfo& info) const override {
+        spng_ihdr ihdr{};
+        if (!OpenPng(data, size, ihdr)) return false;
+        info.width = ihdr.width;
+        info.height = ihdr.height;
+        info.hasAlpha = ihdr.color_type == SPNG_COLOR_TYPE_TRUECOLOR_ALPHA ||
+                        ihdr.color_type == SPNG_COLOR_TYPE_GRAYSCALE_ALPHA;
+        return true;
+    }
+
+    bool Decode(const uint8_t* data, size_t size, const ImageView& dst) const override {
+        spng_ihdr ihdr{};
+        SpngPtr ctx = OpenPng(data, size, ihdr);
+        if (!ctx || ihdr.width != dst.width || ihdr.height != dst.height) return false;
+        const size_t rowBytes = size_t(dst.width) * 4;
+
+        if (ihdr.interlace_method != SPNG_INTERLACE_NONE) {
+            // Adam7 は行順に出てこないので一旦まとめて展開する
+            size_t imageSize = 0;
+            if (spng_decoded_image_size(ctx.get(), SPNG_FMT_RGBA8, &imageSize) != 0) return false;
+            std::vector<uint8_t> tmp(imageSize);
+            if (spng_decode_image(ctx.get(), tmp.data(), tmp.size(), SPNG_FMT_RGBA8, SPNG_DECODE_TRNS) != 0) return false;
+            for (uint32_t y = 0; y < dst.height; ++y) std::memcpy(dst.Row(y), tmp.data() + y * rowBytes, rowBytes);
+            return true;
+        }
+
+        if (spng_decode_image(ctx.get(), nullptr, 0, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS | SPNG_DECODE_PROGRESSIVE) != 0)
+            return false;
+        int ret = 0;
+        do {
+            spng_row_info row{};
+            ret = spng_get_row_info(ctx.get(), &row);
+            if (ret != 0) break;
+            ret = spng_decode_row(ctx.get(), dst.Row(row.row_num), rowBytes);
+        } while (ret == 0);
+        return ret == SPNG_EOI;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// JPEG（libjpeg-turbo / TurboJPEG）。ピッチ指定で dst に直接展開できる
+// ---------------------------------------------------------------------------
+struct TjDeleter {
+    void operator()(void* handle) const { tjDestroy(handle); }
+};
+
+// ハンドルはスレッドごとに使い回す
+tjhandle ThreadDecompressor() {
+    thread_local std::unique_ptr<void, TjDeleter> s_handle(tjInitDecompress());
+    return s_handle.get();
+}
+
+class JpegDecoder final : public IImageDecoder {
+public:
+    const char* Name() const override { return "JPEG"; }
+
+    bool CanDecode(const uint8_t* data, size_t size) const override {
+        return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+    }
+
+    bool ReadInfo(const uint8_t* data, size_t size, ImageInfo& info) const override {
+        tjhandle tj = ThreadDecompressor();
+        int w = 0, h = 0, subsamp = 0, colorspace = 0;
+        if (!tj || tjDecompressHeader3(tj, data, (unsigned long)size, &w, &h, &subsamp, &colorspace) != 0) return false;
+        info.width = (uint32_t)w;
+        info.height = (uint32_t)h;
+        info.hasAlpha = false;
+        return true;
+    }
+
+    bool Decode(const uint8_t* data, size_t size, const ImageView& dst) const override {
+        tjhandle tj = ThreadDecompressor();
+        if (!tj) return false;
+        return tjDecompress2(tj, data, (unsigned long)size, dst.data, (int)dst.width, (int)dst.rowPitch,
+                             (int)dst.height, TJPF_RGBA, 0) == 0;
+    }
+};
+
+#endif // JISAKU_NO_IMAGE_CODECS
+
+// ---------------------------------------------------------------------------
+// TGA（非圧縮/RLE, トゥルーカラー/グレースケール/カラーマップ）
+// ---------------------------------------------------------------------------
+class TgaDecoder final : public IImageDecoder {
+public:
+    const char* Name() const override { return "TGA"; }
+
+    // マジックが無いのでヘッダの整合性で判定する
+    bool CanDecode(const uint8_t* d, size_t size) const override {
+        if (size < 18) return false;
+        const uint8_t cmapType = d[1], type = d[2], bpp = d[16];
+        if (cmapType > 1) return false;
+        if (ReadU16(d + 12) == 0 || ReadU16(d + 14) == 0) return false;
+        switch (type) {
+        case 1: case 9:  return cmapType == 1 && bpp == 8;
+        case 2: case 10: return bpp == 15 || bpp == 16 || bpp == 24 || bpp == 32;
+        case 3: case 11: return bpp == 8;
+        default: return false;
+        }
+    }
+
+    bool ReadInfo(const uint8_t* d, size_t size, ImageInfo& info) const override {
+        if (!CanDecode(d, size)) return false;
+        info.width = ReadU16(d + 12);
+        info.height = ReadU16(d + 14);
+        info.hasAlpha = d[16] == 32 && (d[17] & 0x0F) != 0;
+        return true;
+    }
+
+    bool Decode(const uint8_t* d, size_t size, const ImageView& dst) const override {
+        ImageInfo info;
+        if (!ReadInfo(d, size, info) || info.width != dst.width || info.height != dst.height) return false;
+
+        const uint8_t type = d[2], bpp = d[16], desc = d[17];
+        const bool rle = type >= 9;
+        const bool mapped = (type & 3) == 1;
+        const bool gray = (type & 3) == 3;
+        const bool topDown = (desc & 0x20) != 0;
+        const bool rightToLeft = (desc & 0x10) != 0;
+        const bool useAlpha = (desc & 0x0F) != 0;
+
+        size_t pos = 18 + d[0];
+        // カラーマップ
+        const uint32_t cmapFirst = ReadU16(d + 3), cmapLen = ReadU16(d + 5);
+        const uint32_t cmapEntryBits = d[7];
+        const uint32_t cmapEntryBytes = (cmapEntryBits + 7) / 8;
+        std::vector<uint8_t> palette;
+        if (d[1] == 1) {
+            const size_t bytes = size_t(cmapLen) * cmapEntryBytes;
+            if (pos + bytes > size) return false;
+            if (mapped) {
+                palette.resize(size_t(cmapLen) * 4);
+                for (uint32_t i = 0; i < cmapLen; ++i)
+                    ReadTrueColor(d + pos + i * cmapEntryBytes, cmapEntryBits, useAlpha, &palette[i * 4]);
+            }
+            pos += bytes;
+        }
+
+        const uint32_t pixelBytes = (bpp + 7) / 8;
+        auto readPixel = [&](const uint8_t* p, uint8_t out[4]) -> bool {
+            if (mapped) {
+                const uint32_t idx = p[0] - cmapFirst;
+                if (p[0] < cmapFirst || idx >= cmapLen) return false;
+                std::memcpy(out, &palette[idx * 4], 4);
+            } else if (gray) {
+                out[0] = out[1] = out[2] = p[0];
+                out[3] = 255;
+            } else {
+                ReadTrueColor(p, bpp, useAlpha, out);
+            }
+            return true;
+        };
+        auto store = [&](uint64_t i, const uint8_t px[4]) {
+            uint32_t x = uint32_t(i % dst.width);
+            const uint32_t row = uint32_t(i / dst.width);
+            if (rightToLeft) x = dst.width - 1 - x;
+            const uint32_t y = topDown ? row : dst.height - 1 - row;
+            std::memcpy(dst.Row(y) + size_t(x) * 4, px, 4);
+        };
+
+        const uint64_t total = uint64_t(dst.width) * dst.height;
+        uint8_t px[4];
+        for (uint64_t i = 0; i < total;) {
+            if (!rle) {
+                if (pos + pixelBytes > size || !readPixel(d + pos, px)) return false;
+                pos += pixelBytes;
+                store(i++, px);
+                continue;
+            }
+            if (pos >= size) return false;
+            const uint8_t header = d[pos++];
+            const uint32_t count = (header & 0x7F) + 1u;
+            if (i + count > total) return false;
+            if (header & 0x80) {
+                if (pos + pixelBytes > size || !readPixel(d + pos, px)) return false;
+                pos += pixelBytes;
+                for (uint32_t k = 0; k < count; ++k) store(i++, px);
+            } else {
+                for (uint32_t k = 0; k < count; ++k) {
+                    if (pos + pixelBytes > size || !readPixel(d + pos, px)) return false;
+                    pos += pixelBytes;
+                    store(i++, px);
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    // BGR(A) / 5551 を RGBA8 に
+    static void ReadTrueColor(const uint8_t* p, uint32_t bits, bool useAlpha, uint8_t out[4]) {
+        if (bits == 15 || bits == 16) {
+            const uint16_t v = ReadU16(p);
+            const uint32_t r = (v >> 10) & 31, g = (v >> 5) & 31, b = v & 31;
+            out[0] = uint8_t((r << 3) | (r >> 2));
+            out[1] = uint8_t((g << 3) | (g >> 2));
+            out[2] = uint8_t((b << 3) | (b >> 2));
+            out[3] = 255;
+        } else {
+            out[0] = p[2];
+            out[1] = p[1];
+            out[2] = p[0];
+            out[3] = (bits == 32 && useAlpha) ? p[3] : 255;
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// BMP（BITMAPINFOHEADER 以降, 8/16/24/32bpp, BI_RGB / BI_BITFIELDS）
+// ---------------------------------------------------------------------------
+class BmpDecoder final : public IImageDecoder {
+public:
+    const char* Name() const override { return "BMP"; }
+
+    bool CanDecode(const uint8_t* d, size_t size) const override {
+        return size >= 54 && d[0] == 'B' && d[1] == 'M';
+    }
+
+    bool ReadInfo(const uint8_t* d, size_t size, ImageInfo& info) const override {
+        Header h;
+        if (!ParseHeader(d, size, h)) return false;
+        info.width = h.width;
+        info.height = h.height;
+        info.hasAlpha = h.masks[3] != 0;
+        return true;
+    }
+
+    bool Decode(const uint8_t* d, size_t size, const ImageView& dst) const override {
+        Header h;
+        if (!ParseHeader(d, size, h) || h.width != dst.width || h.height != dst.height) return false;
+
+        const size_t stride = ((size_t(h.width) * h.bpp + 31) / 32) * 4;
+        if (h.dataOffset + stride * h.height > size) return false;
+
+        std::vector<uint8_t> palette;
+        if (h.bpp == 8) {
+            const uint32_t count = h.paletteCount ? (std::min)(h.paletteCount, 256u) : 256u;
+            const size_t palOffset = 14 + size_t(h.headerSize);
+            if (palOffset + size_t(count) * 4 > size) return false;
+            palette.assign(256 * 4, 0);
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint8_t* p = d + palOffset + i * 4;
+                palette[i * 4 + 0] = p[2];
+                palette[i * 4 + 1] = p[1];
+                palette[i * 4 + 2] = p[0];
+                palette[i * 4 + 3] = 255;
+            }
+        }
+
+        for (uint32_t row = 0; row < h.height; ++row) {
+            const uint8_t* src = d + h.dataOffset + stride * row;
+            const uint32_t y = h.topDown ? row : h.height - 1 - row;
+            uint8_t* out = dst.Row(y);
+            for (uint32_t x = 0; x < h.width; ++x, out += 4) {
+                switch (h.bpp) {
+                case 8:
+                    std::memcpy(out, &palette[size_t(src[x]) * 4], 4);
+                    break;
+                case 24:
+                    out[0] = src[x * 3 + 2];
+                    out[1] = src[x * 3 + 1];
+                    out[2] = src[x * 3 + 0];
+                    out[3] = 255;
+                    break;
+                case 16:
+                case 32: {
+                    const uint32_t v = h.bpp == 16 ? ReadU16(src + x * 2) : ReadU32(src + x * 4);
+                    for (int c = 0; c < 3; ++c) out[c] = Extract(v, h.masks[c]);
+                    out[3] = h.masks[3] ? Extract(v, h.masks[3]) : 255;
+                    break;
+                }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Header {
+        uint32_t dataOffset = 0;
+        uint32_t headerSize = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool topDown = false;
+        uint32_t bpp = 0;
+        uint32_t paletteCount = 0;
+        uint32_t masks[4] = {};
+    };
+
+    static bool ParseHeader(const uint8_t* d, size_t size, Header& h) {
+        if (size < 54 || d[0] != 'B' || d[1] != 'M') return false;
+        h.dataOffset = ReadU32(d + 10);
+        h.headerSize = ReadU32(d + 14);
+        if (h.headerSize < 40) return false; // OS/2 BITMAPCOREHEADER は非対応
+        const int32_t w = (int32_t)ReadU32(d + 18);
+        const int32_t hh = (int32_t)ReadU32(d + 22);
+        h.bpp = ReadU16(d + 28);
+        const uint32_t compression = ReadU32(d + 30);
+        h.paletteCount = ReadU32(d + 46);
+        if (w <= 0 || hh == 0) return false;
+        h.width = (uint32_t)w;
+        h.topDown = hh < 0;
+        h.height = (uint32_t)(hh < 0 ? -(int64_t)hh : hh);
+
+        if (compression == 3 || compression == 6) { // BI_BITFIELDS / BI_ALPHABITFIELDS
+            if (h.bpp != 16 && h.bpp != 32) return false;
+            if (size < 66) return false;
+            for (int c = 0; c < 3; ++c) h.masks[c] = ReadU32(d + 54 + c * 4);
+            if ((h.headerSize >= 56 || compression == 6) && size >= 70) h.masks[3] = ReadU32(d + 66);
+        } else if (compression == 0) { // BI_RGB
+            if (h.bpp == 16) { h.masks[0] = 0x7C00; h.masks[1] = 0x03E0; h.masks[2] = 0x001F; }
+            else if (h.bpp == 32) { h.masks[0] = 0xFF0000; h.masks[1] = 0xFF00; h.masks[2] = 0xFF; } // 上位 8bit は予約
+            else if (h.bpp != 8 && h.bpp != 24) return false;
+        } else {
+            return false; // RLE 等は非対応
+        }
+        return h.dataOffset < size;
+    }
+
+    // マスク位置のビットを取り出して 8bit に正規化
+    static uint8_t Extract(uint32_t v, uint32_t mask) {
+        if (mask == 0) return 0;
+        const int shift = std::countr_zero(mask);
+        const uint32_t bits = (uint32_t)std::popcount(mask >> shift);
+        const uint32_t value = (v & mask) >> shift;
+        if (bits >= 8) return uint8_t(value >> (bits - 8));
+        return uint8_t(value * 255u / ((1u << bits) - 1u));
+    }
+};
+
+} // namespace
+
+ImageDecoderRegistry::ImageDecoderRegistry() {
+#ifndef JISAKU_NO_IMAGE_CODECS
+    m_decoders.push_back(std::make_unique<PngDecoder>());
+    m_decoders.push_back(std::make_unique<JpegDecoder>());
+#endif
+    m_decoders.push_back(std::make_unique<BmpDecoder>());
+    m_fallback = std::make_unique<TgaDecoder>();
+}
+
+ImageDecoderRegistry& ImageDecoderRegistry::Get() {
+    static ImageDecoderRegistry s_registry;
+    return s_registry;
+}
+
+void ImageDecoderRegistry::Register(std::unique_ptr<IImageDecoder> decoder) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_decoders.push_back(std::move(decoder));
+}
+
+const IImageDecoder* ImageDecoderRegistry::Find(const uint8_t* data, size_t size) const {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (const auto& dec : m_decoders) {
+        if (dec->CanDecode(data, size)) return dec.get();
+    }
+    return m_fallback->CanDecode(data, size) ? m_fallback.get() : nullptr;
+}
+
+bool jisaku::DecodeImage(const uint8_t* data, size_t size, Image& out) {
+    const IImageDecoder* dec = ImageDecoderRegistry::Get().Find(data, size);
+    ImageInfo info;
+    if (!dec || !dec->ReadInfo(data, size, info) || info.width == 0 || info.height == 0) return false;
+    out.Allocate(info.width, info.height);
+    return dec->Decode(data, size, out.View());
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "gfx/ImageData.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace jisaku {
+
+struct ImageInfo {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool hasAlpha = false;
+};
+
+// 画像形式ごとのデコーダ。状態を持たないので複数スレッドから同時に呼んでよい。
+class IImageDecoder {
+public:
+    virtual ~IImageDecoder() = default;
+    virtual const char* Name() const = 0;
+    // 先頭バイトから自分の形式か判定
+    virtual bool CanDecode(const uint8_t* data, size_t size) const = 0;
+    virtual bool ReadInfo(const uint8_t* data, size_t size, ImageInfo& info) const = 0;
+    // RGBA8 で dst に直接書き込む。dst の幅/高さは ReadInfo の結果と一致していること。
+    // 行ピッチは任意（アップロードバッファのフットプリント等にそのまま書ける）
+    virtual bool Decode(const uint8_t* data, size_t size, const ImageView& dst) const = 0;
+};
+
+// 形式判定→デコーダ選択。組み込み（PNG/JPEG/TGA/BMP）は Get() 時点で登録済み
+// （JISAKU_NO_IMAGE_CODECS でビルドしたときは libspng / libjpeg-turbo を使う PNG/JPEG が無い）
+class ImageDecoderRegistry {
+public:
+    static ImageDecoderRegistry& Get();
+
+    // 先に登録されたものが優先。判定の緩い TGA は常に最後に試す
+    void Register(std::unique_ptr<IImageDecoder> decoder);
+    const IImageDecoder* Find(const uint8_t* data, size_t size) const;
+
+private:
+    ImageDecoderRegistry();
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<IImageDecoder>> m_decoders;
+    std::unique_ptr<IImageDecoder> m_fallback;
+};
+
+// メモリ上のファイルイメージを RGBA8 の Image にデコード
+bool DecodeImage(const uint8_t* data, size_t size, Image& out);
+
+} // namespace jisaku
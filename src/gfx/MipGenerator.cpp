@@ -0,0 +1,461 @@
+#include "gfx/MipGenerator.h"
+#include "core/CpuFeatures.h"
+#include "core/JobSystem.h"
+#include "core/StreamingCopy.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if JISAKU_X86
+#include <immintrin.h>
+#endif
+
+using namespace jisaku;
+
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+
+// sRGB <-> リニア変換テーブル。書き戻し側は 12bit 量子化したリニア値で引く
+struct ColorLuts {
+    float toLinear[256];
+    float unorm[256];
+    uint8_t toSrgb[4096];
+
+    ColorLuts() {
+        for (int i = 0; i < 256; ++i) {
+            const float c = float(i) / 255.0f;
+            unorm[i] = c;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < 4096; ++i) {
+            const float l = float(i) / 4095.0f;
+            const float s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            toSrgb[i] = uint8_t(std::lround(std::clamp(s, 0.0f, 1.0f) * 255.0f));
+        }
+    }
+};
+
+const ColorLuts& Luts() {
+    static const ColorLuts s_luts;
+    return s_luts;
+}
+
+// ---------------------------------------------------------------------------
+// フィルタカーネル
+// ---------------------------------------------------------------------------
+float Sinc(float x) {
+    if (std::fabs(x) < 1e-5f) return 1.0f;
+    x *= kPi;
+    return std::sin(x) / x;
+}
+
+float BesselI0(float x) {
+    float sum = 1.0f, term = 1.0f;
+    const float q = x * x * 0.25f;
+    for (int k = 1; k < 20; ++k) {
+        term *= q / float(k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+float FilterRadius(MipFilter f) { return f == MipFilter::Box ? 0.5f : 3.0f; }
+
+// x は出力画素単位の距離
+float EvalFilter(MipFilter f, float x) {
+    switch (f) {
+    case MipFilter::Box:
+        return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+    case MipFilter::Kaiser: {
+        const float alpha = 4.0f;
+        const float r = x / 3.0f;
+        if (std::fabs(r) >= 1.0f) return 0.0f;
+        return Sinc(x) * BesselI0(alpha * std::sqrt(1.0f - r * r)) / BesselI0(alpha);
+    }
+    case MipFilter::Lanczos:
+        if (std::fabs(x) >= 3.0f) return 0.0f;
+        return Sinc(x) * Sinc(x / 3.0f);
+    }
+    return 0.0f;
+}
+
+// 1 次元の縮小カーネル。出力画素 i は src[start[i] .. start[i]+taps) を weights で合成する。
+// 範囲外のタップは端の画素に畳み込み、start + taps <= srcSize を保証する。
+struct Kernel1D {
+    uint32_t taps = 0;
+    std::vector<uint32_t> start;
+    std::vector<float> weights; // [i * taps + k]
+};
+
+Kernel1D BuildKernel(uint32_t srcSize, uint32_t dstSize, MipFilter f) {
+    Kernel1D k;
+    const float scale = float(srcSize) / float(dstSize);
+    const float stretch = (std::max)(scale, 1.0f);
+    const float support = FilterRadius(f) * stretch;
+    k.taps = (std::min)(uint32_t(std::ceil(support * 2.0f)) + 2, srcSize);
+    k.start.resize(dstSize);
+    k.weights.assign(size_t(dstSize) * k.taps, 0.0f);
+
+    for (uint32_t i = 0; i < dstSize; ++i) {
+        const float center = (float(i) + 0.5f) * scale;
+        const int lo = int(std::floor(center - support));
+        const int hi = int(std::ceil(center + support));
+        const int first = std::clamp(lo, 0, int(srcSize) - 1);
+        const int s = (std::min)(first, int(srcSize - k.taps));
+        k.start[i] = uint32_t(s);
+
+        float* w = &k.weights[size_t(i) * k.taps];
+        float sum = 0.0f;
+        for (int j = lo; j < hi; ++j) {
+            const float v = EvalFilter(f, (float(j) + 0.5f - center) / stretch);
+            w[std::clamp(j, 0, int(srcSize) - 1) - s] += v;
+            sum += v;
+        }
+        if (std::fabs(sum) < 1e-6f) {
+            w[std::clamp(int(center), 0, int(srcSize) - 1) - s] = 1.0f;
+            sum = 1.0f;
+        }
+        for (uint32_t t = 0; t < k.taps; ++t) w[t] /= sum;
+    }
+    return k;
+}
+
+// ---------------------------------------------------------------------------
+// 行カーネル（スカラー参照実装 + SIMD）
+// ---------------------------------------------------------------------------
+// acc[i] += w * src[i]
+using AccumulateFn = void (*)(float* acc, const float* src, float w, size_t n);
+// 行（float4/画素）を水平方向に縮小
+using HorizontalFn = void (*)(const float* row, const Kernel1D& k, uint32_t dstW, float* out);
+
+void AccumulateScalar(float* acc, const float* src, float w, size_t n) {
+    for (size_t i = 0; i < n; ++i) acc[i] += w * src[i];
+}
+
+void HorizontalScalar(const float* row, const Kernel1D& k, uint32_t dstW, float* out) {
+    for (uint32_t x = 0; x < dstW; ++x) {
+        const float* w = &k.weights[size_t(x) * k.taps];
+        const float* s = row + size_t(k.start[x]) * 4;
+        float acc[4] = {};
+        for (uint32_t t = 0; t < k.taps; ++t)
+            for (int c = 0; c < 4; ++c) acc[c] += w[t] * s[t * 4 + c];
+        std::memcpy(out + size_t(x) * 4, acc, sizeof(acc));
+    }
+}
+
+#if JISAKU_X86
+JISAKU_TARGET_SSE41
+void AccumulateSSE41(float* acc, const float* src, float w, size_t n) {
+    const __m128 wv = _mm_set1_ps(w);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(wv, _mm_loadu_ps(src + i))));
+    for (; i < n; ++i) acc[i] += w * src[i];
+}
+
+JISAKU_TARGET_AVX2
+void AccumulateAVX2(float* acc, const float* src, float w, size_t n) {
+    const __m256 wv = _mm256_set1_ps(w);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(acc + i, _mm256_fmadd_ps(wv, _mm256_loadu_ps(src + i), _mm256_loadu_ps(acc + i)));
+    for (; i < n; ++i) acc[i] += w * src[i];
+}
+
+// 1 画素 = float4 = __m128 なので水平方向は SSE で 1 画素ずつ
+JISAKU_TARGET_SSE41
+void HorizontalSSE41(const float* row, const Kernel1D& k, uint32_t dstW, float* out) {
+    for (uint32_t x = 0; x < dstW; ++x) {
+        const float* w = &k.weights[size_t(x) * k.taps];
+        const float* s = row + size_t(k.start[x]) * 4;
+        __m128 acc = _mm_setzero_ps();
+        for (uint32_t t = 0; t < k.taps; ++t)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[t]), _mm_loadu_ps(s + t * 4)));
+        _mm_storeu_ps(out + size_t(x) * 4, acc);
+    }
+}
+#endif
+
+AccumulateFn GetAccumulate() {
+    static const AccumulateFn s_fn = []() -> AccumulateFn {
+#if JISAKU_X86
+        if (GetCpuFeatures().avx2) return AccumulateAVX2;
+        if (GetCpuFeatures().sse41) return AccumulateSSE41;
+#endif
+        return AccumulateScalar;
+    }();
+    return s_fn;
+}
+
+HorizontalFn GetHorizontal() {
+    static const HorizontalFn s_fn = []() -> HorizontalFn {
+#if JISAKU_X86
+        if (GetCpuFeatures().sse41) return HorizontalSSE41;
+#endif
+        return HorizontalScalar;
+    }();
+    return s_fn;
+}
+
+// ---------------------------------------------------------------------------
+// 8bit <-> 作業用 float（リニア、アルファ乗算済み）
+// ---------------------------------------------------------------------------
+void ConvertRow(const uint8_t* src, uint32_t width, const MipOptions& opt, float* out) {
+    const ColorLuts& lut = Luts();
+    const float* rgbLut = opt.srgb ? lut.toLinear : lut.unorm;
+    for (uint32_t x = 0; x < width; ++x, src += 4, out += 4) {
+        const float a = lut.unorm[src[3]];
+        const float m = opt.alphaWeighted ? a : 1.0f;
+        out[0] = rgbLut[src[0]] * m;
+        out[1] = rgbLut[src[1]] * m;
+        out[2] = rgbLut[src[2]] * m;
+        out[3] = a;
+    }
+}
+
+void WriteRow(const float* in, uint32_t width, const MipOptions& opt, uint8_t* dst) {
+    const ColorLuts& lut = Luts();
+    for (uint32_t x = 0; x < width; ++x, in += 4, dst += 4) {
+        const float a = in[3];
+        // 完全に透明な画素の色は 0 にする（乗算済みなので情報が無い）
+        const float inv = !opt.alphaWeighted ? 1.0f : (a > 0.0f ? 1.0f / a : 0.0f);
+        for (int c = 0; c < 3; ++c) {
+            const float v = std::clamp(in[c] * inv, 0.0f, 1.0f);
+            dst[c] = opt.srgb ? lut.toSrgb[int(v * 4095.0f + 0.5f)] : uint8_t(v * 255.0f + 0.5f);
+        }
+        dst[3] = uint8_t(a * 255.0f + 0.5f);
+    }
+}
+
+// 中間レベルは量子化せず float のまま次レベルの入力にする
+struct FloatLevel {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> px;
+    float* Row(uint32_t y) { return px.data() + size_t(y) * width * 4; }
+    const float* Row(uint32_t y) const { return px.data() + size_t(y) * width * 4; }
+};
+
+// src8（ミップ 0）または srcF（それ以降）を 1 段縮小して dst8 と dstF（次段の入力, 任意）に書き込む
+void DownsampleLevel(const ConstImageView* src8, const FloatLevel* srcF, uint32_t srcW, uint32_t srcH,
+                     const MipOptions& opt, const ImageView& dst8, FloatLevel* dstF) {
+    const uint32_t dstW = dst8.width, dstH = dst8.height;
+    const Kernel1D kx = BuildKernel(srcW, dstW, opt.filter);
+    const Kernel1D ky = BuildKernel(srcH, dstH, opt.filter);
+    const AccumulateFn accumulate = GetAccumulate();
+    const HorizontalFn horizontal = GetHorizontal();
+
+    auto doRows = [&](uint32_t y0, uint32_t y1) {
+        // 8bit 入力はバンドが参照するソース行だけを一度 float に展開する
+        const uint32_t r0 = ky.start[y0];
+        const uint32_t r1 = ky.start[y1 - 1] + ky.taps;
+        const size_t srcRowFloats = size_t(srcW) * 4;
+        std::vector<float> band;
+        if (src8) {
+            band.resize(size_t(r1 - r0) * srcRowFloats);
+            for (uint32_t r = r0; r < r1; ++r) ConvertRow(src8->Row(r), srcW, opt, &band[(r - r0) * srcRowFloats]);
+        }
+        auto srcRow = [&](uint32_t r) -> const float* {
+            return src8 ? &band[(r - r0) * srcRowFloats] : srcF->Row(r);
+        };
+
+        std::vector<float> acc(srcRowFloats), out(size_t(dstW) * 4);
+        std::vector<uint8_t> row8(opt.streamingStores ? size_t(dstW) * 4 : 0);
+        for (uint32_t y = y0; y < y1; ++y) {
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            const float* w = &ky.weights[size_t(y) * ky.taps];
+            for (uint32_t t = 0; t < ky.taps; ++t) {
+                if (w[t] != 0.0f) accumulate(acc.data(), srcRow(ky.start[y] + t), w[t], acc.size());
+            }
+            horizontal(acc.data(), kx, dstW, out.data());
+            // Lanczos/Kaiser の負ローブによるリンギングを抑える
+            for (float& v : out) v = std::clamp(v, 0.0f, 1.0f);
+            if (dstF) std::memcpy(dstF->Row(y), out.data(), out.size() * sizeof(float));
+            if (opt.streamingStores) {
+                // 1 行分をキャッシュ上で組み立ててからまとめて流す
+                WriteRow(out.data(), dstW, opt, row8.data());
+                StreamCopy(dst8.Row(y), row8.data(), row8.size());
+            } else {
+                WriteRow(out.data(), dstW, opt, dst8.Row(y));
+            }
+        }
+        if (opt.streamingStores) StreamFence();
+    };
+
+    const uint32_t bandRows = 16;
+    if (opt.parallel && dstH > bandRows) {
+        JobSystem::Get().ParallelFor(dstH, bandRows, doRows);
+    } else {
+        doRows(0, dstH);
+    }
+}
+
+// HDR 版: 入力はリニア float なので変換はアルファ加重だけ
+void LoadFloatRow(const float* src, uint32_t width, const MipOptions& opt, float* out) {
+    for (uint32_t x = 0; x < width; ++x, src += 4, out += 4) {
+        const float a = src[3];
+        const float m = opt.alphaWeighted ? a : 1.0f;
+        out[0] = src[0] * m;
+        out[1] = src[1] * m;
+        out[2] = src[2] * m;
+        out[3] = a;
+    }
+}
+
+void StoreFloatRow(const float* in, uint32_t width, const MipOptions& opt, float* dst) {
+    for (uint32_t x = 0; x < width; ++x, in += 4, dst += 4) {
+        const float a = std::clamp(in[3], 0.0f, 1.0f);
+        const float inv = !opt.alphaWeighted ? 1.0f : (a > 0.0f ? 1.0f / a : 0.0f);
+        for (int c = 0; c < 3; ++c) dst[c] = (std::max)(in[c] * inv, 0.0f);
+        dst[3] = a;
+    }
+}
+
+void DownsampleFloatLevel(const ConstFloatImageView& src, const MipOptions& opt, const FloatImageView& dst) {
+    const uint32_t srcW = src.width, dstW = dst.width, dstH = dst.height;
+    const Kernel1D kx = BuildKernel(srcW, dstW, opt.filter);
+    const Kernel1D ky = BuildKernel(src.height, dstH, opt.filter);
+    const AccumulateFn accumulate = GetAccumulate();
+    const HorizontalFn horizontal = GetHorizontal();
+
+    auto doRows = [&](uint32_t y0, uint32_t y1) {
+        const uint32_t r0 = ky.start[y0];
+        const uint32_t r1 = ky.start[y1 - 1] + ky.taps;
+        const size_t srcRowFloats = size_t(srcW) * 4;
+        std::vector<float> band(size_t(r1 - r0) * srcRowFloats);
+        for (uint32_t r = r0; r < r1; ++r) LoadFloatRow(src.Row(r), srcW, opt, &band[(r - r0) * srcRowFloats]);
+
+        std::vector<float> acc(srcRowFloats), out(size_t(dstW) * 4);
+        for (uint32_t y = y0; y < y1; ++y) {
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            const float* w = &ky.weights[size_t(y) * ky.taps];
+            for (uint32_t t = 0; t < ky.taps; ++t) {
+                if (w[t] != 0.0f) accumulate(acc.data(), &band[(ky.start[y] + t - r0) * srcRowFloats], w[t], acc.size());
+            }
+            horizontal(acc.data(), kx, dstW, out.data());
+            StoreFloatRow(out.data(), dstW, opt, dst.Row(y));
+        }
+    };
+
+    const uint32_t bandRows = 16;
+    if (opt.parallel && dstH > bandRows) {
+        JobSystem::Get().ParallelFor(dstH, bandRows, doRows);
+    } else {
+        doRows(0, dstH);
+    }
+}
+
+} // namespace
+
+uint32_t jisaku::CalcMipCount(uint32_t width, uint32_t height) {
+    uint32_t n = 1;
+    while (width > 1 || height > 1) {
+        width = (std::max)(width / 2, 1u);
+        height = (std::max)(height / 2, 1u);
+        ++n;
+    }
+    return n;
+}
+
+bool jisaku::GenerateMips(const ConstImageView& src, const MipOptions& opt, const ImageView* dstLevels, uint32_t dstCount) {
+    if (!src.data || src.width == 0 || src.height == 0) return false;
+
+    FloatLevel levels[2];
+    int cur = 0;
+    uint32_t w = src.width, h = src.height;
+    for (uint32_t i = 0; i < dstCount; ++i) {
+        const ImageView& dst = dstLevels[i];
+        if (!dst.data || dst.width != MipExtent(src.width, i + 1) || dst.height != MipExtent(src.height, i + 1))
+            return false;
+
+        FloatLevel* next = nullptr;
+        if (i + 1 < dstCount) {
+            next = &levels[cur ^ 1];
+            next->width = dst.width;
+            next->height = dst.height;
+            next->px.resize(size_t(dst.width) * dst.height * 4);
+        }
+        DownsampleLevel(i == 0 ? &src : nullptr, i == 0 ? nullptr : &levels[cur], w, h, opt, dst, next);
+        cur ^= 1;
+        w = dst.width;
+        h = dst.height;
+    }
+    return true;
+}
+
+bool jisaku::GenerateMipChain(const ConstImageView& src, const MipOptions& opt, std::vector<Image>& outLevels) {
+    if (!src.data || src.width == 0 || src.height == 0) return false;
+    uint32_t count = CalcMipCount(src.width, src.height);
+    if (opt.maxLevels > 0) count = (std::min)(count, opt.maxLevels);
+
+    outLevels.resize(count);
+    outLevels[0].Allocate(src.width, src.height);
+    for (uint32_t y = 0; y < src.height; ++y)
+        std::memcpy(outLevels[0].View().Row(y), src.Row(y), size_t(src.width) * 4);
+
+    std::vector<ImageView> views;
+    for (uint32_t i = 1; i < count; ++i) {
+        outLevels[i].Allocate(MipExtent(src.width, i), MipExtent(src.height, i));
+        views.push_back(outLevels[i].View());
+    }
+    return GenerateMips(src, opt, views.data(), (uint32_t)views.size());
+}
+
+bool jisaku::AverageImages(const ConstImageView* src, uint32_t count, const MipOptions& opt, const ImageView& dst) {
+    if (!src || count == 0 || !dst.data) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!src[i].data || src[i].width != dst.width || src[i].height != dst.height) return false;
+    }
+
+    const AccumulateFn accumulate = GetAccumulate();
+    const size_t rowFloats = size_t(dst.width) * 4;
+    const float w = 1.0f / float(count);
+    std::vector<float> row(rowFloats), acc(rowFloats);
+    std::vector<uint8_t> row8(opt.streamingStores ? rowFloats : 0);
+    for (uint32_t y = 0; y < dst.height; ++y) {
+        std::fill(acc.begin(), acc.end(), 0.0f);
+        for (uint32_t i = 0; i < count; ++i) {
+            ConvertRow(src[i].Row(y), dst.width, opt, row.data());
+            accumulate(acc.data(), row.data(), w, rowFloats);
+        }
+        if (opt.streamingStores) {
+            WriteRow(acc.data(), dst.width, opt, row8.data());
+            StreamCopy(dst.Row(y), row8.data(), row8.size());
+        } else {
+            WriteRow(acc.data(), dst.width, opt, dst.Row(y));
+        }
+    }
+    if (opt.streamingStores) StreamFence();
+    return true;
+}
+
+bool jisaku::GenerateMips(const ConstFloatImageView& src, const MipOptions& opt, const FloatImageView* dstLevels, uint32_t dstCount) {
+    if (!src.data || src.width == 0 || src.height == 0) return false;
+    ConstFloatImageView prev = src;
+    for (uint32_t i = 0; i < dstCount; ++i) {
+        const FloatImageView& dst = dstLevels[i];
+        if (!dst.data || dst.width != MipExtent(src.width, i + 1) || dst.height != MipExtent(src.height, i + 1))
+            return false;
+        DownsampleFloatLevel(prev, opt, dst);
+        prev = dst;
+    }
+    return true;
+}
+
+bool jisaku::GenerateMipChain(const ConstFloatImageView& src, const MipOptions& opt, std::vector<FloatImage>& outLevels) {
+    if (!src.data || src.width == 0 || src.height == 0) return false;
+    uint32_t count = CalcMipCount(src.width, src.height);
+    if (opt.maxLevels > 0) count = (std::min)(count, opt.maxLevels);
+
+    outLevels.resize(count);
+    outLevels[0].Allocate(src.width, src.height);
+    for (uint32_t y = 0; y < src.height; ++y)
+        std::memcpy(outLevels[0].View().Row(y), src.Row(y), size_t(src.width) * 4 * sizeof(float));
+
+    std::vector<FloatImageView> views;
+    for (uint32_t i = 1; i < count; ++i) {
+        outLevels[i].Allocate(MipExtent(src.width, i), MipExtent(src.height, i));
+        views.push_back(outLevels[i].View());
+    }
+    return GenerateMips(src, opt, views.data(), (uint32_t)views.size());
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "gfx/ImageData.h"
+#include <cstdint>
+#include <vector>
+
+namespace jisaku {
+
+// RGBA8 画像のミップチェーン生成（D3D/Windows 非依存）
+enum class MipFilter : uint8_t {
+    Box,     // 2x2 平均相当。最速
+    Kaiser,  // Kaiser 窓付き sinc（半径 3）
+    Lanczos, // Lanczos3
+};
+
+struct MipOptions {
+    MipFilter filter = MipFilter::Box;
+    bool srgb = true;            // RGB を LUT でリニア化してからフィルタし、書き戻し時に sRGB へ戻す
+    bool alphaWeighted = true;   // アルファ乗算済みでフィルタし、透明部分の色がにじむのを防ぐ
+    uint32_t maxLevels = 0;      // ミップ 0 を含む最大レベル数（0 = 1x1 まで）
+    bool parallel = true;        // 出力行を JobSystem に分散する
+    bool streamingStores = false; // 出力を非テンポラルストアで書く（マップしたアップロードバッファ等の WC メモリ向け）
+};
+
+// ミップ 0 を含むレベル数（各辺 max(1, n/2) で 1x1 まで縮小）
+uint32_t CalcMipCount(uint32_t width, uint32_t height);
+inline uint32_t MipExtent(uint32_t size, uint32_t level) { return (size >> level) > 0 ? (size >> level) : 1; }
+
+// src をミップ 0 としてレベル 1..dstCount を dstLevels[0..dstCount-1] に書き込む。
+// 各 dst のサイズは MipExtent(src, level) と一致している必要がある。非 2 の累乗サイズも可。
+// dst は書き込みのみ（次レベルの入力はキャッシュ上の float 中間バッファから読む）なので WC メモリを直接渡してよい。
+bool GenerateMips(const ConstImageView& src, const MipOptions& opt, const ImageView* dstLevels, uint32_t dstCount);
+
+// 同サイズの画像を画素ごとに平均して dst に書く（色空間・アルファ加重は opt に従う）。
+// ボリュームテクスチャの奥行き方向の縮小に使う
+bool AverageImages(const ConstImageView* src, uint32_t count, const MipOptions& opt, const ImageView& dst);
+
+// 便利版: ミップ 0（src のコピー）を含む全レベルを Image として返す
+bool GenerateMipChain(const ConstImageView& src, const MipOptions& opt, std::vector<Image>& outLevels);
+
+// HDR（リニア RGBA32F）版。常にリニアでフィルタし（opt.srgb / streamingStores は無視）、
+// 負ローブで出た負値だけを 0 に切る（1 を超える輝度は保持）。
+// レベル n は dstLevels[n-2] を読んで作るので、dst はキャッシュ可能なメモリであること
+bool GenerateMips(const ConstFloatImageView& src, const MipOptions& opt, const FloatImageView* dstLevels, uint32_t dstCount);
+bool GenerateMipChain(const ConstFloatImageView& src, const MipOptions& opt, std::vector<FloatImage>& outLevels);
+
+} // namespace jisaku
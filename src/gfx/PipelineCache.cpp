@@ -0,0 +1,251 @@
+#include "gfx/PipelineCache.h"
+#include "core/AtomicFile.h"
+#include "gfx/PipelineDesc.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+using Microsoft::WRL::ComPtr;
+using namespace jisaku;
+
+namespace {
+
+ContentKey HashBytecode(const D3D12_SHADER_BYTECODE& bytecode){
+    if (!bytecode.pShaderBytecode || bytecode.BytecodeLength == 0) return ContentKey{};
+    return HashContent(bytecode.pShaderBytecode, bytecode.BytecodeLength);
+}
+
+// ライブラリ内の名前（キーの 16 進）
+std::wstring PipelineName(const ContentKey& key){
+    const std::string hex = key.ToHex();
+    return std::wstring(hex.begin(), hex.end());
+}
+
+double MsSince(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// pso の参照を 1 つ PipelinePtr に移す
+PipelinePtr Adopt(ID3D12PipelineState* pso){
+    return PipelinePtr(pso, [](ID3D12PipelineState* p){ p->Release(); });
+}
+
+} // namespace
+
+PipelineCache::PipelineCache(ID3D12Device* device, size_t maxUnused) : m_device(device), m_maxUnused(maxUnused){
+    if (FAILED(m_device->QueryInterface(IID_PPV_ARGS(&m_device1)))) m_device1.Reset();
+}
+
+bool PipelineCache::Load(const std::filesystem::path& file){
+    if (!m_device1) {
+        spdlog::warn("ID3D12PipelineLibrary is not available; pipeline states are not saved");
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    {
+        std::ifstream in(file, std::ios::binary | std::ios::ate);
+        if (in) {
+            data.resize(size_t(in.tellg()));
+            in.seekg(0);
+            if (!in.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()))) data.clear();
+        }
+    }
+
+    m_library.Reset();
+    m_libraryData = std::move(data);
+    HRESULT hr = E_FAIL;
+    if (!m_libraryData.empty()) {
+        hr = m_device1->CreatePipelineLibrary(m_libraryData.data(), m_libraryData.size(), IID_PPV_ARGS(&m_library));
+        if (FAILED(hr)) {
+            // D3D12_ERROR_DRIVER_VERSION_MISMATCH / D3D12_ERROR_ADAPTER_NOT_FOUND（ドライバー・GPU が変わった）、壊れている等
+            spdlog::info("{} is stale (0x{:x}); pipeline states will be rebuilt", file.string(), (uint32_t)hr);
+            m_library.Reset();
+        }
+    }
+    if (FAILED(hr)) {
+        m_libraryData.clear();
+        hr = m_device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library));
+        if (FAILED(hr)) {
+            // PIX 等のツールの下では使えないことがある
+            spdlog::warn("Failed to create pipeline library: 0x{:x}", (uint32_t)hr);
+            m_library.Reset();
+            m_device1.Reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PipelineCache::Save(const std::filesystem::path& file){
+    if (!m_device1) return false;
+
+    ComPtr<ID3D12PipelineLibrary> library;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stats.created == 0) return true; // ファイルにすべてある
+        // 読んだライブラリには今回使っていない PSO も入っているので、使ったものだけで作り直す
+        HRESULT hr = m_device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&library));
+        if (FAILED(hr)) return false;
+        for (const auto& [key, entry] : m_pipelines) {
+            hr = library->StorePipeline(PipelineName(key).c_str(), entry.pso.Get());
+            if (FAILED(hr)) spdlog::warn("Failed to store pipeline state {}: 0x{:x}", key.ToHex(), (uint32_t)hr);
+        }
+    }
+
+    std::vector<uint8_t> data(library->GetSerializedSize());
+    if (FAILED(library->Serialize(data.data(), data.size()))) return false;
+
+    return WriteFileAtomic(file, data.data(), data.size());
+}
+
+HRESULT PipelineCache::CreateRootSignature(const void* blob, size_t size, ID3D12RootSignature** out){
+    if (!out) return E_POINTER;
+    *out = nullptr;
+    ComPtr<ID3D12RootSignature> root;
+    HRESULT hr = m_device->CreateRootSignature(0, blob, size, IID_PPV_ARGS(&root));
+    if (FAILED(hr)) return hr;
+
+    const ContentKey key = HashContent(blob, size);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // 同じ中身なら D3D12 は同じオブジェクトを返す
+        if (m_rootKeys.emplace(root.Get(), key).second) m_rootSignatures.push_back(root);
+    }
+    *out = root.Detach();
+    return S_OK;
+}
+
+bool PipelineCache::makeKey_(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t stateHash, ContentKey& out) const{
+    // ストリーム出力・キャッシュ済み PSO の指定は使っていないので対応しない
+    if (!desc.pRootSignature || desc.StreamOutput.NumEntries != 0 || desc.CachedPSO.CachedBlobSizeInBytes != 0) return false;
+
+    PipelineKeyDesc k;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_rootKeys.find(desc.pRootSignature);
+        if (it == m_rootKeys.end()) return false;
+        k.rootSignature = it->second;
+    }
+    k.vs = HashBytecode(desc.VS);
+    k.ps = HashBytecode(desc.PS);
+    k.ds = HashBytecode(desc.DS);
+    k.hs = HashBytecode(desc.HS);
+    k.gs = HashBytecode(desc.GS);
+
+    k.state = stateHash;
+    out = MakePipelineKey(k);
+    return true;
+}
+
+HRESULT PipelineCache::CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, PipelinePtr* out){
+    PipelineStateDesc state;
+    ContentKey key;
+    const bool cacheable = FromD3D12PipelineDesc(desc, state) && makeKey_(desc, HashPipelineState(state), key);
+    return create_(desc, cacheable ? &key : nullptr, out);
+}
+
+HRESULT PipelineCache::CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t stateHash, PipelinePtr* out){
+    ContentKey key;
+    const bool cacheable = makeKey_(desc, stateHash, key);
+    return create_(desc, cacheable ? &key : nullptr, out);
+}
+
+HRESULT PipelineCache::create_(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, const ContentKey* cacheKey, PipelinePtr* out){
+    if (!out) return E_POINTER;
+    *out = nullptr;
+
+    if (!cacheKey) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.uncached;
+        }
+        Pso_ pso;
+        const HRESULT hr = m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pso));
+        if (SUCCEEDED(hr)) *out = Adopt(pso.Detach());
+        return hr;
+    }
+    const ContentKey key = *cacheKey;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_built.wait(lock, [&]{ return m_building.count(key) == 0; });
+        auto it = m_pipelines.find(key);
+        if (it != m_pipelines.end()) {
+            ++m_stats.hits;
+            it->second.lastUse = ++m_useClock;
+            // 渡した参照が残っていればそれを共有する（外れたかどうかを weak_ptr 1 つで見られる）
+            *out = it->second.handedOut.lock();
+            if (!*out) {
+                *out = Adopt(Pso_(it->second.pso).Detach());
+                it->second.handedOut = *out;
+            }
+            return S_OK;
+        }
+        m_building.insert(key);
+    }
+
+    // 同じキーを作るのはこのスレッドだけ（ライブラリの同じ PSO を同時に Load してはいけない）
+    const auto start = std::chrono::steady_clock::now();
+    const std::wstring name = PipelineName(key);
+    Pso_ pso;
+    bool fromLibrary = false;
+    if (m_library && SUCCEEDED(m_library->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(&pso)))) {
+        fromLibrary = true;
+    }
+    HRESULT hr = S_OK;
+    PipelinePtr shared;
+    if (!fromLibrary) {
+        pso.Reset();
+        hr = m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pso));
+        if (SUCCEEDED(hr) && m_library) {
+            const HRESULT stored = m_library->StorePipeline(name.c_str(), pso.Get());
+            if (FAILED(stored)) spdlog::warn("Failed to store pipeline state {}: 0x{:x}", key.ToHex(), (uint32_t)stored);
+        }
+    }
+    const double ms = MsSince(start);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_building.erase(key);
+        m_stats.createMs += ms;
+        if (SUCCEEDED(hr)) {
+            if (fromLibrary) ++m_stats.libraryHits;
+            else ++m_stats.created;
+            shared = Adopt(Pso_(pso).Detach());
+            m_pipelines.emplace(key, Entry_{ pso, shared, ++m_useClock });
+            trim_();
+        }
+    }
+    m_built.notify_all();
+    if (FAILED(hr)) return hr;
+    *out = std::move(shared);
+    return S_OK;
+}
+
+void PipelineCache::trim_(){
+    std::vector<std::pair<uint64_t, ContentKey>> unused;
+    for (const auto& [key, entry] : m_pipelines) {
+        // ライブラリ（StorePipeline）も参照を持つので、COM の参照数では分からない
+        if (entry.handedOut.expired()) unused.emplace_back(entry.lastUse, key);
+    }
+    if (unused.size() <= m_maxUnused) return;
+    // 古く使われたものから手放す（Save にも載らなくなるので、次に要るときはドライバーのコンパイルになる）
+    const size_t drop = unused.size() - m_maxUnused;
+    std::nth_element(unused.begin(), unused.begin() + drop, unused.end(),
+                     [](const auto& a, const auto& b){ return a.first < b.first; });
+    for (size_t i = 0; i < drop; ++i) m_pipelines.erase(unused[i].second);
+    m_stats.evicted += drop;
+}
+
+PipelineCache::Stats PipelineCache::GetStats() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+size_t PipelineCache::Size() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pipelines.size();
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <wrl.h>
+#include <d3d12.h>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "core/PipelineKey.h"
+
+namespace jisaku {
+
+// PipelineCache が渡す PSO。最後の参照が外れると COM の参照を 1 つ返す
+using PipelinePtr = std::shared_ptr<ID3D12PipelineState>;
+
+// PSO のキャッシュ。シェーダー・ルートシグネチャの中身と、正規化した固定部分のハッシュ（MakePipelineKey）をキーにする。
+// - 同じキーは 1 回だけ作り、以降は作ったものを返す（ホットリロードで元に戻したとき・パーミュテーションを作り直すとき等）
+// - 作った PSO は ID3D12PipelineLibrary に入れ、Save でファイルへ書く。次の起動で Load すれば
+//   ドライバーのコンパイルをせずにそこから取る（ドライバーや GPU が変わって読めなければ空から作り直す）
+// - ルートシグネチャも CreateRootSignature で作ること（シリアライズした中身をキーに入れる。
+//   ここを通さずに作ったルートシグネチャの PSO はキャッシュせずにそのまま作る）
+// - 渡した PipelinePtr がすべて外れた PSO（ホットリロードで差し替えた・パーミュテーションを追い出した PSO が、
+//   解放待ちも済んだもの）は、最近使った maxUnused 個だけ残して手放す
+// Create* は複数のスレッドから同時に呼んでよい（同じキーを同時に頼まれたら後の方は先の方を待つ）
+class PipelineCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;        // 作ってあったもの
+        uint64_t libraryHits = 0; // PSO ライブラリから取ったもの
+        uint64_t created = 0;     // ドライバーがコンパイルしたもの
+        uint64_t uncached = 0;    // キーを作れずにそのまま作ったもの
+        uint64_t evicted = 0;     // 使われなくなって手放したもの
+        double createMs = 0.0;    // ライブラリから取る・作るのにかかった合計
+    };
+
+    explicit PipelineCache(ID3D12Device* device, size_t maxUnused = 64);
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    // 前回 Save したファイルを読む。他のスレッドが Create* する前に呼ぶこと。
+    // 読めなくても（初回・ドライバーの更新後）空のライブラリで続けられるので、false は PSO ライブラリ自体が使えないときだけ
+    bool Load(const std::filesystem::path& file);
+    // 今回使った PSO だけを書く（古いシェーダーの PSO がたまらない）。作ったものが無ければ書かない。一時ファイルに書いてから置き換える
+    bool Save(const std::filesystem::path& file);
+
+    // ID3D12Device と同じ引数（PSO は PipelinePtr で受け取る）
+    HRESULT CreateRootSignature(const void* blob, size_t size, ID3D12RootSignature** out);
+    HRESULT CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, PipelinePtr* out);
+    // stateHash は desc の固定部分の HashPipelineState（constexpr の PipelineStateDesc から作った desc なら、
+    // コンパイル時に求めた値を渡せば desc を読み戻してハッシュし直さない）
+    HRESULT CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t stateHash, PipelinePtr* out);
+
+    Stats GetStats() const;
+    size_t Size() const;
+
+private:
+    using Pso_ = Microsoft::WRL::ComPtr<ID3D12PipelineState>;
+    struct KeyHash_ {
+        size_t operator()(const ContentKey& key) const { return size_t(key.lo); }
+    };
+
+    struct Entry_ {
+        Pso_ pso;
+        std::weak_ptr<ID3D12PipelineState> handedOut; // 渡した PipelinePtr。切れていれば誰も使っていない
+        uint64_t lastUse = 0; // m_useClock の値
+    };
+
+    bool makeKey_(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t stateHash, ContentKey& out) const;
+    HRESULT create_(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, const ContentKey* key, PipelinePtr* out);
+    void trim_(); // m_mutex を持って呼ぶ
+
+    ID3D12Device* m_device = nullptr;
+    size_t m_maxUnused = 64;
+    Microsoft::WRL::ComPtr<ID3D12Device1> m_device1; // PSO ライブラリが使えなければ null
+    std::vector<uint8_t> m_libraryData; // m_library が参照しているので先に破棄しない
+    Microsoft::WRL::ComPtr<ID3D12PipelineLibrary> m_library;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_built;
+    std::unordered_map<ID3D12RootSignature*, ContentKey> m_rootKeys;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12RootSignature>> m_rootSignatures; // m_rootKeys のポインターが使い回されないよう持っておく
+    std::unordered_map<ContentKey, Entry_, KeyHash_> m_pipelines;
+    uint64_t m_useClock = 0;
+    std::unordered_set<ContentKey, KeyHash_> m_building;
+    Stats m_stats;
+};
+
+} // namespace jisaku
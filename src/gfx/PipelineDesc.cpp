@@ -0,0 +1,223 @@
+#include "gfx/PipelineDesc.h"
+
+using Microsoft::WRL::ComPtr;
+using namespace jisaku;
+
+namespace {
+
+D3D12_DEPTH_STENCILOP_DESC ToD3D12(const StencilOpState& s){
+    return { D3D12_STENCIL_OP(s.failOp), D3D12_STENCIL_OP(s.depthFailOp), D3D12_STENCIL_OP(s.passOp), D3D12_COMPARISON_FUNC(s.func) };
+}
+
+StencilOpState FromD3D12(const D3D12_DEPTH_STENCILOP_DESC& s){
+    StencilOpState r;
+    r.failOp = StencilOp(s.StencilFailOp);
+    r.depthFailOp = StencilOp(s.StencilDepthFailOp);
+    r.passOp = StencilOp(s.StencilPassOp);
+    r.func = ComparisonFunc(s.StencilFunc);
+    return r;
+}
+
+} // namespace
+
+D3D12_GRAPHICS_PIPELINE_STATE_DESC jisaku::ToD3D12PipelineDesc(const PipelineStateDesc& state, const D3D12_INPUT_ELEMENT_DESC* inputElements){
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
+
+    desc.BlendState.AlphaToCoverageEnable = state.blend.alphaToCoverageEnable;
+    desc.BlendState.IndependentBlendEnable = state.blend.independentBlendEnable;
+    for (uint32_t i = 0; i < kMaxRenderTargets; ++i) {
+        const BlendTargetState& s = state.blend.renderTargets[i];
+        D3D12_RENDER_TARGET_BLEND_DESC& t = desc.BlendState.RenderTarget[i];
+        t.BlendEnable = s.blendEnable;
+        t.LogicOpEnable = s.logicOpEnable;
+        t.SrcBlend = D3D12_BLEND(s.srcBlend);
+        t.DestBlend = D3D12_BLEND(s.destBlend);
+        t.BlendOp = D3D12_BLEND_OP(s.blendOp);
+        t.SrcBlendAlpha = D3D12_BLEND(s.srcBlendAlpha);
+        t.DestBlendAlpha = D3D12_BLEND(s.destBlendAlpha);
+        t.BlendOpAlpha = D3D12_BLEND_OP(s.blendOpAlpha);
+        t.LogicOp = D3D12_LOGIC_OP(s.logicOp);
+        t.RenderTargetWriteMask = s.renderTargetWriteMask;
+    }
+    desc.SampleMask = state.sampleMask;
+
+    const RasterizerState& r = state.rasterizer;
+    desc.RasterizerState.FillMode = D3D12_FILL_MODE(r.fillMode);
+    desc.RasterizerState.CullMode = D3D12_CULL_MODE(r.cullMode);
+    desc.RasterizerState.FrontCounterClockwise = r.frontCounterClockwise;
+    desc.RasterizerState.DepthBias = r.depthBias;
+    desc.RasterizerState.DepthBiasClamp = r.depthBiasClamp;
+    desc.RasterizerState.SlopeScaledDepthBias = r.slopeScaledDepthBias;
+    desc.RasterizerState.DepthClipEnable = r.depthClipEnable;
+    desc.RasterizerState.MultisampleEnable = r.multisampleEnable;
+    desc.RasterizerState.AntialiasedLineEnable = r.antialiasedLineEnable;
+    desc.RasterizerState.ForcedSampleCount = r.forcedSampleCount;
+    desc.RasterizerState.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE(r.conservativeRaster);
+
+    const DepthStencilState& d = state.depthStencil;
+    desc.DepthStencilState.DepthEnable = d.depthEnable;
+    desc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK(d.depthWriteMask);
+    desc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC(d.depthFunc);
+    desc.DepthStencilState.StencilEnable = d.stencilEnable;
+    desc.DepthStencilState.StencilReadMask = d.stencilReadMask;
+    desc.DepthStencilState.StencilWriteMask = d.stencilWriteMask;
+    desc.DepthStencilState.FrontFace = ToD3D12(d.frontFace);
+    desc.DepthStencilState.BackFace = ToD3D12(d.backFace);
+
+    desc.InputLayout = { inputElements, state.inputLayout.count };
+    desc.IBStripCutValue = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE(state.ibStripCutValue);
+    desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE(state.primitiveTopologyType);
+    desc.NumRenderTargets = state.numRenderTargets;
+    for (uint32_t i = 0; i < kMaxRenderTargets; ++i) desc.RTVFormats[i] = DXGI_FORMAT(state.rtvFormats[i]);
+    desc.DSVFormat = DXGI_FORMAT(state.dsvFormat);
+    desc.SampleDesc.Count = state.sampleCount;
+    desc.SampleDesc.Quality = state.sampleQuality;
+    desc.NodeMask = state.nodeMask;
+    desc.Flags = D3D12_PIPELINE_STATE_FLAGS(state.flags);
+    return desc;
+}
+
+bool jisaku::FromD3D12PipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, PipelineStateDesc& out){
+    if (desc.InputLayout.NumElements > kMaxInputElements) return false;
+    PipelineStateDesc s;
+
+    s.blend.alphaToCoverageEnable = desc.BlendState.AlphaToCoverageEnable != FALSE;
+    s.blend.independentBlendEnable = desc.BlendState.IndependentBlendEnable != FALSE;
+    for (uint32_t i = 0; i < kMaxRenderTargets; ++i) {
+        const D3D12_RENDER_TARGET_BLEND_DESC& t = desc.BlendState.RenderTarget[i];
+        BlendTargetState& b = s.blend.renderTargets[i];
+        b.blendEnable = t.BlendEnable != FALSE;
+        b.logicOpEnable = t.LogicOpEnable != FALSE;
+        b.srcBlend = Blend(t.SrcBlend);
+        b.destBlend = Blend(t.DestBlend);
+        b.blendOp = BlendOp(t.BlendOp);
+        b.srcBlendAlpha = Blend(t.SrcBlendAlpha);
+        b.destBlendAlpha = Blend(t.DestBlendAlpha);
+        b.blendOpAlpha = BlendOp(t.BlendOpAlpha);
+        b.logicOp = LogicOp(t.LogicOp);
+        b.renderTargetWriteMask = t.RenderTargetWriteMask;
+    }
+    s.sampleMask = desc.SampleMask;
+
+    const D3D12_RASTERIZER_DESC& r = desc.RasterizerState;
+    s.rasterizer.fillMode = FillMode(r.FillMode);
+    s.rasterizer.cullMode = CullMode(r.CullMode);
+    s.rasterizer.frontCounterClockwise = r.FrontCounterClockwise != FALSE;
+    s.rasterizer.depthBias = r.DepthBias;
+    s.rasterizer.depthBiasClamp = r.DepthBiasClamp;
+    s.rasterizer.slopeScaledDepthBias = r.SlopeScaledDepthBias;
+    s.rasterizer.depthClipEnable = r.DepthClipEnable != FALSE;
+    s.rasterizer.multisampleEnable = r.MultisampleEnable != FALSE;
+    s.rasterizer.antialiasedLineEnable = r.AntialiasedLineEnable != FALSE;
+    s.rasterizer.forcedSampleCount = r.ForcedSampleCount;
+    s.rasterizer.conservativeRaster = ConservativeRaster(r.ConservativeRaster);
+
+    const D3D12_DEPTH_STENCIL_DESC& d = desc.DepthStencilState;
+    s.depthStencil.depthEnable = d.DepthEnable != FALSE;
+    s.depthStencil.depthWriteMask = DepthWriteMask(d.DepthWriteMask);
+    s.depthStencil.depthFunc = ComparisonFunc(d.DepthFunc);
+    s.depthStencil.stencilEnable = d.StencilEnable != FALSE;
+    s.depthStencil.stencilReadMask = d.StencilReadMask;
+    s.depthStencil.stencilWriteMask = d.StencilWriteMask;
+    s.depthStencil.frontFace = FromD3D12(d.FrontFace);
+    s.depthStencil.backFace = FromD3D12(d.BackFace);
+
+    for (UINT i = 0; i < desc.InputLayout.NumElements; ++i) {
+        const D3D12_INPUT_ELEMENT_DESC& e = desc.InputLayout.pInputElementDescs[i];
+        InputElement element;
+        element.semanticName = e.SemanticName ? e.SemanticName : "";
+        element.semanticIndex = e.SemanticIndex;
+        element.format = PixelFormat(e.Format);
+        element.inputSlot = e.InputSlot;
+        element.alignedByteOffset = e.AlignedByteOffset;
+        element.classification = InputClassification(e.InputSlotClass);
+        element.instanceDataStepRate = e.InstanceDataStepRate;
+        s.inputLayout = s.inputLayout.With(element);
+    }
+    s.ibStripCutValue = IndexStripCut(desc.IBStripCutValue);
+    s.primitiveTopologyType = PrimitiveTopologyType(desc.PrimitiveTopologyType);
+    s.numRenderTargets = desc.NumRenderTargets;
+    for (uint32_t i = 0; i < kMaxRenderTargets; ++i) s.rtvFormats[i] = PixelFormat(desc.RTVFormats[i]);
+    s.dsvFormat = PixelFormat(desc.DSVFormat);
+    s.sampleCount = desc.SampleDesc.Count;
+    s.sampleQuality = desc.SampleDesc.Quality;
+    s.nodeMask = desc.NodeMask;
+    s.flags = uint32_t(desc.Flags);
+
+    out = s;
+    return true;
+}
+
+HRESULT jisaku::SerializeRootSignature(const RootSignatureLayout& layout, ComPtr<ID3DBlob>& out, std::string& error){
+    out.Reset();
+    error.clear();
+    if (!layout.IsValid()) {
+        error = "invalid root signature layout";
+        return E_INVALIDARG;
+    }
+
+    D3D12_DESCRIPTOR_RANGE ranges[kMaxRootParameters][kMaxDescriptorRanges] = {};
+    D3D12_ROOT_PARAMETER params[kMaxRootParameters] = {};
+    for (uint32_t i = 0; i < layout.parameterCount; ++i) {
+        const RootParameter& p = layout.parameters[i];
+        D3D12_ROOT_PARAMETER& d = params[i];
+        d.ParameterType = D3D12_ROOT_PARAMETER_TYPE(p.type);
+        d.ShaderVisibility = D3D12_SHADER_VISIBILITY(p.visibility);
+        switch (p.type) {
+        case RootParameterType::DescriptorTable:
+            for (uint32_t j = 0; j < p.rangeCount; ++j) {
+                const DescriptorRange& range = p.ranges[j];
+                ranges[i][j].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE(range.type);
+                ranges[i][j].NumDescriptors = range.count; // kUnboundedDescriptors は D3D12 でも UINT_MAX
+                ranges[i][j].BaseShaderRegister = range.baseRegister;
+                ranges[i][j].RegisterSpace = range.space;
+                ranges[i][j].OffsetInDescriptorsFromTableStart = range.offset;
+            }
+            d.DescriptorTable.NumDescriptorRanges = p.rangeCount;
+            d.DescriptorTable.pDescriptorRanges = ranges[i];
+            break;
+        case RootParameterType::Constants:
+            d.Constants.ShaderRegister = p.shaderRegister;
+            d.Constants.RegisterSpace = p.space;
+            d.Constants.Num32BitValues = p.num32BitValues;
+            break;
+        default:
+            d.Descriptor.ShaderRegister = p.shaderRegister;
+            d.Descriptor.RegisterSpace = p.space;
+            break;
+        }
+    }
+
+    D3D12_STATIC_SAMPLER_DESC samplers[kMaxStaticSamplers] = {};
+    for (uint32_t i = 0; i < layout.samplerCount; ++i) {
+        const StaticSampler& s = layout.samplers[i];
+        D3D12_STATIC_SAMPLER_DESC& d = samplers[i];
+        d.Filter = D3D12_FILTER(s.filter);
+        d.AddressU = D3D12_TEXTURE_ADDRESS_MODE(s.addressU);
+        d.AddressV = D3D12_TEXTURE_ADDRESS_MODE(s.addressV);
+        d.AddressW = D3D12_TEXTURE_ADDRESS_MODE(s.addressW);
+        d.MipLODBias = s.mipLODBias;
+        d.MaxAnisotropy = s.maxAnisotropy;
+        d.ComparisonFunc = D3D12_COMPARISON_FUNC(s.comparisonFunc);
+        d.BorderColor = D3D12_STATIC_BORDER_COLOR(s.borderColor);
+        d.MinLOD = s.minLOD;
+        d.MaxLOD = s.maxLOD;
+        d.ShaderRegister = s.shaderRegister;
+        d.RegisterSpace = s.space;
+        d.ShaderVisibility = D3D12_SHADER_VISIBILITY(s.visibility);
+    }
+
+    D3D12_ROOT_SIGNATURE_DESC desc = {};
+    desc.NumParameters = layout.parameterCount;
+    desc.pParameters = layout.parameterCount ? params : nullptr;
+    desc.NumStaticSamplers = layout.samplerCount;
+    desc.pStaticSamplers = layout.samplerCount ? samplers : nullptr;
+    desc.Flags = D3D12_ROOT_SIGNATURE_FLAGS(layout.flags);
+
+    ComPtr<ID3DBlob> errorBlob;
+    const HRESULT hr = D3D12SerializeRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1, &out, &errorBlob);
+    if (FAILED(hr) && errorBlob) {
+        error.assign(static_cast<const char*>(errorBlob->GetBufferPointer()), errorBlob->GetBufferSize());
+    }
+    return hr;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <wrl.h>
+#include <d3d12.h>
+#include <DirectXMath.h>
+#include <array>
+#include <string>
+#include "core/PipelineState.h"
+#include "core/RootSignatureLayout.h"
+
+namespace jisaku {
+
+// core/PipelineState.h・core/RootSignatureLayout.h で組み立てた desc を D3D12 の desc にする。
+// 列挙値は数値のまま渡すので、D3D12 / DXGI の値と同じことをここで確かめる
+
+static_assert(uint32_t(PixelFormat::R32G32B32A32Float) == DXGI_FORMAT_R32G32B32A32_FLOAT);
+static_assert(uint32_t(PixelFormat::R32G32B32Float) == DXGI_FORMAT_R32G32B32_FLOAT);
+static_assert(uint32_t(PixelFormat::R16G16B16A16Float) == DXGI_FORMAT_R16G16B16A16_FLOAT);
+static_assert(uint32_t(PixelFormat::R32G32Float) == DXGI_FORMAT_R32G32_FLOAT);
+static_assert(uint32_t(PixelFormat::R8G8B8A8Unorm) == DXGI_FORMAT_R8G8B8A8_UNORM);
+static_assert(uint32_t(PixelFormat::R8G8B8A8UnormSrgb) == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
+static_assert(uint32_t(PixelFormat::D32Float) == DXGI_FORMAT_D32_FLOAT);
+static_assert(uint32_t(PixelFormat::R32Float) == DXGI_FORMAT_R32_FLOAT);
+static_assert(uint32_t(PixelFormat::R32Uint) == DXGI_FORMAT_R32_UINT);
+static_assert(uint32_t(PixelFormat::D24UnormS8Uint) == DXGI_FORMAT_D24_UNORM_S8_UINT);
+static_assert(uint32_t(PixelFormat::B8G8R8A8Unorm) == DXGI_FORMAT_B8G8R8A8_UNORM);
+
+static_assert(uint32_t(FillMode::Wireframe) == D3D12_FILL_MODE_WIREFRAME && uint32_t(FillMode::Solid) == D3D12_FILL_MODE_SOLID);
+static_assert(uint32_t(CullMode::None) == D3D12_CULL_MODE_NONE && uint32_t(CullMode::Back) == D3D12_CULL_MODE_BACK);
+static_assert(uint32_t(Blend::Zero) == D3D12_BLEND_ZERO && uint32_t(Blend::InvSrcAlpha) == D3D12_BLEND_INV_SRC_ALPHA &&
+              uint32_t(Blend::InvDestColor) == D3D12_BLEND_INV_DEST_COLOR);
+static_assert(uint32_t(BlendOp::Add) == D3D12_BLEND_OP_ADD && uint32_t(BlendOp::Max) == D3D12_BLEND_OP_MAX);
+static_assert(uint32_t(LogicOp::Clear) == D3D12_LOGIC_OP_CLEAR && uint32_t(LogicOp::Noop) == D3D12_LOGIC_OP_NOOP);
+static_assert(uint32_t(ComparisonFunc::Never) == D3D12_COMPARISON_FUNC_NEVER && uint32_t(ComparisonFunc::Always) == D3D12_COMPARISON_FUNC_ALWAYS);
+static_assert(uint32_t(DepthWriteMask::All) == D3D12_DEPTH_WRITE_MASK_ALL);
+static_assert(uint32_t(StencilOp::Keep) == D3D12_STENCIL_OP_KEEP && uint32_t(StencilOp::Decr) == D3D12_STENCIL_OP_DECR);
+static_assert(uint32_t(PrimitiveTopologyType::Triangle) == D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE &&
+              uint32_t(PrimitiveTopologyType::Patch) == D3D12_PRIMITIVE_TOPOLOGY_TYPE_PATCH);
+static_assert(uint32_t(InputClassification::PerInstance) == D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA);
+static_assert(uint32_t(ConservativeRaster::On) == D3D12_CONSERVATIVE_RASTERIZATION_MODE_ON);
+static_assert(uint32_t(IndexStripCut::Value0xFFFFFFFF) == D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFFFFFF);
+static_assert(kColorWriteAll == D3D12_COLOR_WRITE_ENABLE_ALL);
+static_assert(kMaxRenderTargets == D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT);
+
+static_assert(uint32_t(RootParameterType::DescriptorTable) == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE &&
+              uint32_t(RootParameterType::Constants) == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS &&
+              uint32_t(RootParameterType::Uav) == D3D12_ROOT_PARAMETER_TYPE_UAV);
+static_assert(uint32_t(ShaderVisibility::All) == D3D12_SHADER_VISIBILITY_ALL && uint32_t(ShaderVisibility::Pixel) == D3D12_SHADER_VISIBILITY_PIXEL);
+static_assert(uint32_t(DescriptorRangeType::Srv) == D3D12_DESCRIPTOR_RANGE_TYPE_SRV &&
+              uint32_t(DescriptorRangeType::Sampler) == D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER);
+static_assert(uint32_t(Filter::MinMagMipLinear) == D3D12_FILTER_MIN_MAG_MIP_LINEAR && uint32_t(Filter::Anisotropic) == D3D12_FILTER_ANISOTROPIC);
+static_assert(uint32_t(TextureAddressMode::Clamp) == D3D12_TEXTURE_ADDRESS_MODE_CLAMP && uint32_t(TextureAddressMode::Border) == D3D12_TEXTURE_ADDRESS_MODE_BORDER);
+static_assert(uint32_t(StaticBorderColor::OpaqueWhite) == D3D12_STATIC_BORDER_COLOR_OPAQUE_WHITE);
+static_assert(kRootSignatureAllowInputLayout == D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+static_assert(kDescriptorRangeAppend == D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND);
+
+// 頂点構造体でよく使う DirectXMath の型
+template <> struct VertexFormatOf<DirectX::XMFLOAT2> { static constexpr PixelFormat value = PixelFormat::R32G32Float; };
+template <> struct VertexFormatOf<DirectX::XMFLOAT3> { static constexpr PixelFormat value = PixelFormat::R32G32B32Float; };
+template <> struct VertexFormatOf<DirectX::XMFLOAT4> { static constexpr PixelFormat value = PixelFormat::R32G32B32A32Float; };
+
+// 入力要素（先頭の layout.count 個）。constexpr の InputLayout ならコンパイル時にできる
+constexpr std::array<D3D12_INPUT_ELEMENT_DESC, kMaxInputElements> ToD3D12InputElements(const InputLayout& layout){
+    std::array<D3D12_INPUT_ELEMENT_DESC, kMaxInputElements> out{};
+    for (uint32_t i = 0; i < layout.count && i < kMaxInputElements; ++i) {
+        const InputElement& e = layout.elements[i];
+        out[i] = { e.semanticName, e.semanticIndex, DXGI_FORMAT(e.format), e.inputSlot, e.alignedByteOffset,
+                   D3D12_INPUT_CLASSIFICATION(e.classification), e.instanceDataStepRate };
+    }
+    return out;
+}
+
+// 固定部分を埋めた PSO の desc（ルートシグネチャとシェーダーは呼ぶ側が入れる）。
+// inputElements は ToD3D12InputElements(state.inputLayout) の結果で、PSO を作り終えるまで置いておくこと
+D3D12_GRAPHICS_PIPELINE_STATE_DESC ToD3D12PipelineDesc(const PipelineStateDesc& state, const D3D12_INPUT_ELEMENT_DESC* inputElements);
+
+// D3D12 の desc の固定部分を読み戻す（PipelineCache のキー用）。入力要素が kMaxInputElements を超えていれば false。
+// セマンティクス名は desc のポインターをそのまま持つ
+bool FromD3D12PipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, PipelineStateDesc& out);
+
+// D3D12SerializeRootSignature（バージョン 1.0）。失敗したらエラーメッセージを error に入れる
+HRESULT SerializeRootSignature(const RootSignatureLayout& layout, Microsoft::WRL::ComPtr<ID3DBlob>& out, std::string& error);
+
+} // namespace jisaku
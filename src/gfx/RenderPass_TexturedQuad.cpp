@@ -1,19 +1,56 @@
 #include "RenderPass_TexturedQuad.h"
 #include "DX12Device.h"
+#include "PipelineCache.h"
+#include "PipelineDesc.h"
+#include "ShaderCompiler.h"
+#include "ShaderPermutationManager.h"
 #include "Swapchain.h"
 #include "TextureLoader.h"
+#include "core/JobSystem.h"
 #include <d3d12.h>
-#include <d3dcompiler.h>
 #include <spdlog/spdlog.h>
 #include <DirectXMath.h>
 
 namespace jisaku
 {
-    struct Vertex
+    namespace
     {
-        DirectX::XMFLOAT3 pos;
-        DirectX::XMFLOAT2 uv;
-    };
+        // 頂点構造体は他のパスと同じ名前なので、この翻訳単位だけのものにしておく
+        struct Vertex
+        {
+            DirectX::XMFLOAT3 pos;
+            DirectX::XMFLOAT2 uv;
+        };
+
+        // 入力レイアウトと PSO の固定部分はコンパイル時に組み立てる（Vertex と食い違えばコンパイルエラー）
+        constexpr InputLayout kInputLayout = MakeInputLayout<Vertex>({
+            VertexElement<decltype(Vertex::pos)>("POSITION", offsetof(Vertex, pos)),
+            VertexElement<decltype(Vertex::uv)>("TEXCOORD", offsetof(Vertex, uv)),
+        });
+        constexpr auto kInputElements = ToD3D12InputElements(kInputLayout);
+
+        constexpr PipelineStateDesc kPipelineState = PipelineStateDesc{}
+            .WithInputLayout(kInputLayout)
+            .WithBlend(kBlendOpaque)
+            .WithRasterizer(kRasterCullNone) // 両面描画（向き依存を排除）
+            .WithRenderTarget(PixelFormat::R8G8B8A8Unorm);
+        static_assert(kPipelineState.IsValid());
+        constexpr uint64_t kPipelineStateHash = HashPipelineState(kPipelineState);
+
+        // CBV(b0) + SRVテーブル(t0) + 静的サンプラ(s0)
+        constexpr StaticSampler kSampler = []
+        {
+            StaticSampler s = StaticSampler::LinearClamp(0);
+            s.maxLOD = 0.0f; // これまでどおり mip 0 だけを読む
+            return s;
+        }();
+        constexpr RootSignatureLayout kRootSignature = RootSignatureLayout{}
+            .AllowInputLayout()
+            .Cbv(0, ShaderVisibility::Vertex)
+            .Table(ShaderVisibility::Pixel, { DescriptorRange::Srv(0) })
+            .Sampler(kSampler);
+        static_assert(kRootSignature.IsValid());
+    }
 
     RenderPass_TexturedQuad::RenderPass_TexturedQuad() : m_device(nullptr)
     {
@@ -21,6 +58,10 @@ namespace jisaku
 
     RenderPass_TexturedQuad::~RenderPass_TexturedQuad()
     {
+        if (m_pipelineFuture.valid())
+        {
+            m_pipelineFuture.wait();
+        }
     }
 
     bool RenderPass_TexturedQuad::Initialize(DX12Device* device, Swapchain* /*swapchain*/)
@@ -28,234 +69,100 @@ namespace jisaku
         m_device = device;
         HRESULT hr;
 
-        // ルートシグネチャ作成（CBV(b0) + SRVテーブル(t0) + 静的サンプラ）
-        D3D12_DESCRIPTOR_RANGE srvRange = {};
-        srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-        srvRange.NumDescriptors = 1;
-        srvRange.BaseShaderRegister = 0; // t0
-        srvRange.RegisterSpace = 0;
-        srvRange.OffsetInDescriptorsFromTableStart = 0;
-
-        D3D12_ROOT_PARAMETER rootParams[2] = {};
-        // slot 0: CBV b0
-        rootParams[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
-        rootParams[0].Descriptor.ShaderRegister = 0; // b0
-        rootParams[0].Descriptor.RegisterSpace = 0;
-        rootParams[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
-        // slot 1: SRV table t0
-        rootParams[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
-        rootParams[1].DescriptorTable.NumDescriptorRanges = 1;
-        rootParams[1].DescriptorTable.pDescriptorRanges = &srvRange;
-        rootParams[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
-
-        D3D12_STATIC_SAMPLER_DESC staticSampler = {};
-        staticSampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
-        staticSampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-        staticSampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-        staticSampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-        staticSampler.ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
-        staticSampler.ShaderRegister = 0;
-        staticSampler.RegisterSpace = 0;
-        staticSampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
-
-        D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
-        rootSignatureDesc.NumParameters = 2;
-        rootSignatureDesc.pParameters = rootParams;
-        rootSignatureDesc.NumStaticSamplers = 1;
-        rootSignatureDesc.pStaticSamplers = &staticSampler;
-        rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
-
+        // ルートシグネチャ作成（kRootSignature）
         Microsoft::WRL::ComPtr<ID3DBlob> signature;
-        Microsoft::WRL::ComPtr<ID3DBlob> error;
-        hr = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+        std::string error;
+        hr = SerializeRootSignature(kRootSignature, signature, error);
         if (FAILED(hr))
         {
-            if (error)
-            {
-                spdlog::error("Failed to serialize root signature: {}", (char*)error->GetBufferPointer());
-            }
+            spdlog::error("Failed to serialize root signature: 0x{:x} {}", hr, error);
             return false;
         }
 
-        hr = m_device->GetDevice()->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_rootSignature));
+        hr = m_device->GetPipelineCache()->CreateRootSignature(signature->GetBufferPointer(), signature->GetBufferSize(), &m_rootSignature);
         if (FAILED(hr))
         {
             spdlog::error("Failed to create root signature: 0x{:x}", hr);
             return false;
         }
 
-        // 初期化時はファイルから読み込み
-        ShaderBlobs blobs;
-        std::wstring errorStr;
-        ShaderDesc desc;
-        desc.hlslPath = L"shaders/TexturedQuad.hlsl";
-        desc.entryVS = L"VSMain";
-        desc.entryPS = L"PSMain";
-        desc.targetVS = L"vs_6_0";
-        desc.targetPS = L"ps_6_0";
-        
-        // 簡易的なコンパイル関数
-        auto compile_ = [](const ShaderDesc& desc, ShaderBlobs& out, std::wstring& error) -> bool {
-            FILE* fp = nullptr;
-            _wfopen_s(&fp, desc.hlslPath.c_str(), L"rb");
-            if (!fp) return false;
-            fseek(fp, 0, SEEK_END);
-            long sz = ftell(fp);
-            fseek(fp, 0, SEEK_SET);
-            std::vector<char> buf(sz + 1);
-            fread(buf.data(), 1, sz, fp);
-            fclose(fp);
-            buf[sz] = 0;
-
-            Microsoft::WRL::ComPtr<ID3DBlob> vs, ps, errorBlob;
-            
-            HRESULT hr = D3DCompile(buf.data(), sz, nullptr, nullptr, nullptr, 
-                "VSMain", "vs_6_0", 0, 0, &vs, &errorBlob);
-            if (FAILED(hr)) {
-                if (errorBlob) error = std::string((char*)errorBlob->GetBufferPointer());
-                return false;
-            }
-            
-            hr = D3DCompile(buf.data(), sz, nullptr, nullptr, nullptr, 
-                "PSMain", "ps_6_0", 0, 0, &ps, &errorBlob);
-            if (FAILED(hr)) {
-                if (errorBlob) error = std::string((char*)errorBlob->GetBufferPointer());
-                return false;
-            }
-            
-            out.vs = vs;
-            out.ps = ps;
-            return true;
-        };
-        
-        if (!compile_(desc, blobs, errorStr)) {
-            spdlog::error("Failed to compile shaders: {}", errorStr);
-            return false;
-        }
-        
-        if (!CreatePipelineState(blobs)) {
-            spdlog::error("Failed to create pipeline state");
-            return false;
-        }
+        // PSO はワーカーで作り、その間にバッファとテクスチャローダーを用意する（App が WaitPipelineState で受け取る）
+        StartPipelineState();
 
-        return true;
+        return CreateResources();
     }
 
-    bool RenderPass_TexturedQuad::CreatePipelineState()
+    ShaderDesc RenderPass_TexturedQuad::GetShaderDesc()
     {
-        // 初期化時はファイルから読み込み
-        ShaderBlobs blobs;
-        std::wstring errorStr;
         ShaderDesc desc;
         desc.hlslPath = L"shaders/TexturedQuad.hlsl";
         desc.entryVS = L"VSMain";
         desc.entryPS = L"PSMain";
         desc.targetVS = L"vs_6_0";
         desc.targetPS = L"ps_6_0";
-        
-        // 簡易的なコンパイル関数
-        auto compile_ = [](const ShaderDesc& desc, ShaderBlobs& out, std::wstring& error) -> bool {
-            FILE* fp = nullptr;
-            _wfopen_s(&fp, desc.hlslPath.c_str(), L"rb");
-            if (!fp) return false;
-            fseek(fp, 0, SEEK_END);
-            long sz = ftell(fp);
-            fseek(fp, 0, SEEK_SET);
-            std::vector<char> buf(sz + 1);
-            fread(buf.data(), 1, sz, fp);
-            fclose(fp);
-            buf[sz] = 0;
-
-            Microsoft::WRL::ComPtr<ID3DBlob> vs, ps, errorBlob;
-            
-            HRESULT hr = D3DCompile(buf.data(), sz, nullptr, nullptr, nullptr, 
-                "VSMain", "vs_6_0", 0, 0, &vs, &errorBlob);
-            if (FAILED(hr)) {
-                if (errorBlob) error = std::string((char*)errorBlob->GetBufferPointer());
-                return false;
-            }
-            
-            hr = D3DCompile(buf.data(), sz, nullptr, nullptr, nullptr, 
-                "PSMain", "ps_6_0", 0, 0, &ps, &errorBlob);
-            if (FAILED(hr)) {
-                if (errorBlob) error = std::string((char*)errorBlob->GetBufferPointer());
-                return false;
+        return desc;
+    }
+
+    const PermutationSchema& RenderPass_TexturedQuad::GetPermutationSchema()
+    {
+        static const PermutationSchema s_schema{ "GRAYSCALE", "SHOW_UV" };
+        return s_schema;
+    }
+
+    void RenderPass_TexturedQuad::StartPipelineState()
+    {
+        // 初期化時はシェーダーパックから（ホットリロード時はコンパイル）。PSO ライブラリにあればドライバーのコンパイルも無い
+        m_pipelineFuture = JobSystem::Get().Async([this]() -> PipelinePtr
+        {
+            ShaderBlobs blobs;
+            std::wstring errorStr;
+            if (!ShaderCompiler::Get().Load(GetShaderDesc(), blobs, errorStr)) {
+                spdlog::error("Failed to load shaders: {}", errorStr);
+                return nullptr;
             }
-            
-            out.vs = vs;
-            out.ps = ps;
-            return true;
-        };
-        
-        if (!compile_(desc, blobs, errorStr)) {
-            spdlog::error("Failed to compile shaders: {}", errorStr);
-            return false;
+            return BuildPipelineState(blobs);
+        });
+    }
+
+    bool RenderPass_TexturedQuad::WaitPipelineState()
+    {
+        if (m_pipelineFuture.valid())
+        {
+            m_pipelineState = JobSystem::Get().Wait(m_pipelineFuture);
         }
-        
-        return CreatePipelineState(blobs);
+        return m_pipelineState != nullptr;
     }
 
-    bool RenderPass_TexturedQuad::CreatePipelineState(const ShaderBlobs& blobs)
+    PipelinePtr RenderPass_TexturedQuad::BuildPipelineState(const ShaderBlobs& blobs)
     {
-        // 入力レイアウト
-        D3D12_INPUT_ELEMENT_DESC inputElementDescs[] = {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-        };
+        // パックのリフレクションがあれば、入力レイアウトとシェーダーの食い違いを PSO 作成の前に知らせる
+        if (blobs.vsReflection)
+        {
+            std::string layoutError;
+            if (!CheckInputLayout(*blobs.vsReflection, kInputElements.data(), kInputLayout.count, layoutError))
+            {
+                spdlog::warn("shaders/TexturedQuad.hlsl: {}", layoutError);
+            }
+        }
 
-        // パイプラインステート
-        D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-        psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
+        // パイプラインステート（固定部分は kPipelineState）
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = ToD3D12PipelineDesc(kPipelineState, kInputElements.data());
         psoDesc.pRootSignature = m_rootSignature.Get();
         psoDesc.VS = { blobs.vs->GetBufferPointer(), blobs.vs->GetBufferSize() };
         psoDesc.PS = { blobs.ps->GetBufferPointer(), blobs.ps->GetBufferSize() };
-        
-        // ラスタライザー設定
-        D3D12_RASTERIZER_DESC rasterizerDesc = {};
-        rasterizerDesc.FillMode = D3D12_FILL_MODE_SOLID;
-        rasterizerDesc.CullMode = D3D12_CULL_MODE_NONE; // 両面描画（向き依存を排除）
-        rasterizerDesc.FrontCounterClockwise = FALSE;
-        rasterizerDesc.DepthBias = D3D12_DEFAULT_DEPTH_BIAS;
-        rasterizerDesc.DepthBiasClamp = D3D12_DEFAULT_DEPTH_BIAS_CLAMP;
-        rasterizerDesc.SlopeScaledDepthBias = D3D12_DEFAULT_SLOPE_SCALED_DEPTH_BIAS;
-        rasterizerDesc.DepthClipEnable = TRUE;
-        rasterizerDesc.MultisampleEnable = FALSE;
-        rasterizerDesc.AntialiasedLineEnable = FALSE;
-        rasterizerDesc.ForcedSampleCount = 0;
-        rasterizerDesc.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF;
-        psoDesc.RasterizerState = rasterizerDesc;
-        
-        // ブレンド設定
-        D3D12_BLEND_DESC blendDesc = {};
-        blendDesc.AlphaToCoverageEnable = FALSE;
-        blendDesc.IndependentBlendEnable = FALSE;
-        blendDesc.RenderTarget[0].BlendEnable = FALSE;
-        blendDesc.RenderTarget[0].LogicOpEnable = FALSE;
-        blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_ONE;
-        blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_ZERO;
-        blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
-        blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
-        blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ZERO;
-        blendDesc.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
-        blendDesc.RenderTarget[0].LogicOp = D3D12_LOGIC_OP_NOOP;
-        blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
-        psoDesc.BlendState = blendDesc;
-        
-        psoDesc.DepthStencilState.DepthEnable = FALSE;
-        psoDesc.DepthStencilState.StencilEnable = FALSE;
-        psoDesc.SampleMask = UINT_MAX;
-        psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-        psoDesc.NumRenderTargets = 1;
-        psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
-        psoDesc.SampleDesc.Count = 1;
-
-        HRESULT hr = m_device->GetDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState));
+
+        PipelinePtr pso;
+        HRESULT hr = m_device->GetPipelineCache()->CreateGraphicsPipelineState(psoDesc, kPipelineStateHash, &pso);
         if (FAILED(hr))
         {
             spdlog::error("Failed to create pipeline state: 0x{:x}", hr);
-            return false;
+            return nullptr;
         }
+        return pso;
+    }
 
+    bool RenderPass_TexturedQuad::CreateResources()
+    {
         // 定数バッファ（アップロード）確保（64KB）
         D3D12_HEAP_PROPERTIES cbHeap{};
         cbHeap.Type = D3D12_HEAP_TYPE_UPLOAD;
@@ -421,28 +328,29 @@ namespace jisaku
             return false;
         }
 
-        // コマンドリストを閉じて実行
+        // コマンドリストを閉じて実行（描画と同じキューなので、完了を待たなくても最初のフレームより先に終わる）
         uploadCmd->Close();
         ID3D12CommandList* lists[] = { uploadCmd.Get() };
         m_device->GetCommandQueue()->ExecuteCommandLists(1, lists);
-        m_device->WaitIdle();
-        spdlog::info("Texture upload commands executed and GPU is idle");
 
-        // アップロードリソースを解放（WaitIdleの後）
-        m_textureLoader->FlushUploads();
+        // アップロードリソースとコマンドリストは GPU がこの提出を終えてから解放する。
+        // 次のフレーム終わりの Signal を当てにせず、ここで Signal した値で預ける
+        DeferredReleaseQueue& retired = m_device->GetReleaseQueue();
+        const UINT64 retireFence = m_device->Signal();
+        m_textureLoader->FlushUploads(retired, retireFence);
+        retired.Retire(retireFence, std::move(uploadCmd));
+        retired.Retire(retireFence, std::move(uploadAllocator));
+        spdlog::info("Texture upload commands submitted");
 
         spdlog::info("RenderPass_TexturedQuad initialized successfully");
         return true;
     }
 
-    void RenderPass_TexturedQuad::OnShadersReloaded(const ShaderBlobs& blobs)
+    PipelinePtr RenderPass_TexturedQuad::SwapPipelineState(PipelinePtr pso)
     {
-        // PSO再作成
-        if (CreatePipelineState(blobs)) {
-            spdlog::info("TexturedQuad shaders reloaded successfully");
-        } else {
-            spdlog::warn("Failed to reload TexturedQuad shaders, keeping old PSO");
-        }
+        // 記録前に呼ばれるので、このフレームから新しい PSO で描く。前の PSO は ShaderReloader が GPU 完了まで持つ
+        m_pipelineState.swap(pso);
+        return pso;
     }
 
     void RenderPass_TexturedQuad::Execute(ID3D12GraphicsCommandList* cmd, Swapchain& swap)
@@ -475,7 +383,9 @@ namespace jisaku
 
         // ②ルート→PSO→IA→VP/Scissor
         cmd->SetGraphicsRootSignature(m_rootSignature.Get());
-        cmd->SetPipelineState(m_pipelineState.Get());
+        // 機能ビットのパーミュテーションができるまでは、近いパーミュテーションか基本形で描く
+        ID3D12PipelineState* pso = m_permutations ? m_permutations->Request(m_permutationId, m_features) : nullptr;
+        cmd->SetPipelineState(pso ? pso : m_pipelineState.get());
 
         // ③CBV(b0) を ルートパラメータ[0] に渡す（毎フレーム更新）
         // MVP計算（World * View * Projection）
@@ -509,10 +419,10 @@ namespace jisaku
         cmd->SetGraphicsRootConstantBufferView(0, m_cbGpuVA);
 
         // ④SRV テーブルを ルートパラメータ[1] に渡す
+        // スロットの SRV は読み直しでヒープ内の位置が変わるので、ローダーから今の位置を引く
         D3D12_GPU_DESCRIPTOR_HANDLE gpuSrv = m_texture.srvGPU;
         if (m_activeSlot != UINT32_MAX && m_textureLoader->IsValidSlot(m_activeSlot)) {
-            gpuSrv = { m_textureLoader->GetSrvHeap()->GetGPUDescriptorHandleForHeapStart().ptr +
-                       UINT64(m_activeSlot) * UINT64(m_textureLoader->GetDescriptorSize()) };
+            gpuSrv = m_textureLoader->GetSrvGpu(m_activeSlot);
         }
         cmd->SetGraphicsRootDescriptorTable(1, gpuSrv);
         spdlog::info("SetGraphicsRootDescriptorTable(1, {})", gpuSrv.ptr);
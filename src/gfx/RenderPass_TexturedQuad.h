@@ -2,15 +2,18 @@
 
 #include <d3d12.h>
 #include <wrl/client.h>
+#include <future>
 #include <memory>
 #include <DirectXMath.h>
 #include "TextureLoader.h"
 #include "ShaderReloader.h"
+#include "core/ShaderPermutations.h"
 
 namespace jisaku
 {
     class DX12Device;
     class Swapchain;
+    class ShaderPermutationManager;
 
     class RenderPass_TexturedQuad : public IHotReloadable
     {
@@ -20,22 +23,41 @@ namespace jisaku
 
         bool Initialize(DX12Device* device, Swapchain* swapchain);
         void Execute(ID3D12GraphicsCommandList* cmd, Swapchain& swap);
+        // Initialize がワーカーで作り始めた PSO を受け取る（Execute より前に呼ぶ）。作れなければ false
+        bool WaitPipelineState();
         void SetTexture(const TextureHandle& h);
         void SetActiveSlot(uint32_t slot);
         uint32_t GetActiveSlot() const { return m_activeSlot; }
         TextureLoader* GetTextureLoader() const { return m_textureLoader.get(); }
         void SetCamera(const DirectX::XMVECTOR& pos, const DirectX::XMVECTOR& rotQ);
 
+        // 使うシェーダー（ShaderReloader にも同じものを登録する）
+        static ShaderDesc GetShaderDesc();
+
+        // シェーダーの機能ビット（GetPermutationSchema の並び）
+        enum Feature : PermutationKey
+        {
+            kFeatureGrayscale = 1u << 0,
+            kFeatureShowUV = 1u << 1,
+        };
+        static const PermutationSchema& GetPermutationSchema();
+        // permutations が null なら機能ビットは無視して基本形で描く
+        void SetPermutations(ShaderPermutationManager* permutations, int id) { m_permutations = permutations; m_permutationId = id; }
+        void SetFeatures(PermutationKey features) { m_features = features; }
+        PermutationKey GetFeatures() const { return m_features; }
+
         // IHotReloadable
-        void OnShadersReloaded(const ShaderBlobs& blobs) override;
+        PipelinePtr BuildPipelineState(const ShaderBlobs& blobs) override;
+        PipelinePtr SwapPipelineState(PipelinePtr pso) override;
 
     private:
-        bool CreatePipelineState();
-        bool CreatePipelineState(const ShaderBlobs& blobs);
+        void StartPipelineState();
+        bool CreateResources();
 
         DX12Device* m_device;
         Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
-        Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipelineState;
+        PipelinePtr m_pipelineState;
+        std::future<PipelinePtr> m_pipelineFuture;
         Microsoft::WRL::ComPtr<ID3D12Resource> m_cbUpload;
         D3D12_GPU_VIRTUAL_ADDRESS m_cbGpuVA = 0;
         size_t m_cbOffset = 0;
@@ -53,6 +75,9 @@ namespace jisaku
         float m_scaleY = 1.0f;
         DirectX::XMVECTOR m_camPos = DirectX::XMVectorSet(0, 0, -5, 1);
         DirectX::XMVECTOR m_camRotQ = DirectX::XMQuaternionIdentity();
+        ShaderPermutationManager* m_permutations = nullptr;
+        int m_permutationId = 0;
+        PermutationKey m_features = 0;
 
     public:
         void SetTransform(float tx, float ty, float rotDeg, float sx, float sy) {
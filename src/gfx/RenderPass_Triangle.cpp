@@ -1,18 +1,44 @@
 #include "RenderPass_Triangle.h"
 #include "DX12Device.h"
+#include "PipelineCache.h"
+#include "PipelineDesc.h"
+#include "ShaderCompiler.h"
 #include "Swapchain.h"
+#include "core/JobSystem.h"
 #include <d3d12.h>
-#include <d3dcompiler.h>
 #include <spdlog/spdlog.h>
 #include <DirectXMath.h>
 
 namespace jisaku
 {
-    struct Vertex
+    namespace
     {
-        DirectX::XMFLOAT3 position;
-        DirectX::XMFLOAT3 color;
-    };
+        // 頂点構造体は他のパスと同じ名前なので、この翻訳単位だけのものにしておく
+        struct Vertex
+        {
+            DirectX::XMFLOAT3 position;
+            DirectX::XMFLOAT3 color;
+        };
+
+        // 入力レイアウトと PSO の固定部分はコンパイル時に組み立てる（Vertex と食い違えばコンパイルエラー）
+        constexpr InputLayout kInputLayout = MakeInputLayout<Vertex>({
+            VertexElement<decltype(Vertex::position)>("POSITION", offsetof(Vertex, position)),
+            VertexElement<decltype(Vertex::color)>("COLOR", offsetof(Vertex, color)),
+        });
+        constexpr auto kInputElements = ToD3D12InputElements(kInputLayout);
+
+        constexpr PipelineStateDesc kPipelineState = PipelineStateDesc{}
+            .WithInputLayout(kInputLayout)
+            .WithBlend(kBlendOpaque)
+            .WithRasterizer(kRasterCullBack)
+            .WithRenderTarget(PixelFormat::R8G8B8A8Unorm);
+        static_assert(kPipelineState.IsValid());
+        constexpr uint64_t kPipelineStateHash = HashPipelineState(kPipelineState);
+
+        // パラメーターなし（頂点入力だけ）
+        constexpr RootSignatureLayout kRootSignature = RootSignatureLayout{}.AllowInputLayout();
+        static_assert(kRootSignature.IsValid());
+    }
 
     RenderPass_Triangle::RenderPass_Triangle() : m_device(nullptr), m_swapchain(nullptr)
     {
@@ -34,11 +60,8 @@ namespace jisaku
             return false;
         }
 
-        if (!CreatePipelineState())
-        {
-            spdlog::error("Failed to create pipeline state");
-            return false;
-        }
+        // PSO はワーカーで作る（App が WaitPipelineState で受け取る）
+        StartPipelineState();
 
         if (!CreateVertexBuffer())
         {
@@ -52,44 +75,29 @@ namespace jisaku
 
     void RenderPass_Triangle::Shutdown()
     {
-        if (m_vertexBuffer)
+        if (m_pipelineFuture.valid())
         {
-            m_vertexBuffer->Release();
-            m_vertexBuffer.Reset();
+            m_pipelineFuture.wait();
         }
 
-        if (m_pipelineState)
-        {
-            m_pipelineState->Release();
-            m_pipelineState.Reset();
-        }
-
-        if (m_rootSignature)
-        {
-            m_rootSignature->Release();
-            m_rootSignature.Reset();
-        }
+        // PSO とルートシグネチャはパイプラインキャッシュも参照しているので、自分の分だけ手放す
+        m_vertexBuffer.Reset();
+        m_pipelineState.reset();
+        m_rootSignature.Reset();
     }
 
     bool RenderPass_Triangle::CreateRootSignature()
     {
-        D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc = {};
-        rootSignatureDesc.NumParameters = 0;
-        rootSignatureDesc.pParameters = nullptr;
-        rootSignatureDesc.NumStaticSamplers = 0;
-        rootSignatureDesc.pStaticSamplers = nullptr;
-        rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
-
         Microsoft::WRL::ComPtr<ID3DBlob> signature;
-        Microsoft::WRL::ComPtr<ID3DBlob> error;
-        HRESULT hr = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+        std::string error;
+        HRESULT hr = SerializeRootSignature(kRootSignature, signature, error);
         if (FAILED(hr))
         {
-            spdlog::error("Failed to serialize root signature: 0x{:x}", hr);
+            spdlog::error("Failed to serialize root signature: 0x{:x} {}", hr, error);
             return false;
         }
 
-        hr = m_device->GetDevice()->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_rootSignature));
+        hr = m_device->GetPipelineCache()->CreateRootSignature(signature->GetBufferPointer(), signature->GetBufferSize(), &m_rootSignature);
         if (FAILED(hr))
         {
             spdlog::error("Failed to create root signature: 0x{:x}", hr);
@@ -99,125 +107,68 @@ namespace jisaku
         return true;
     }
 
-    bool RenderPass_Triangle::CreatePipelineState()
+    ShaderDesc RenderPass_Triangle::GetShaderDesc()
     {
-        // 初期化時はファイルから読み込み
-        ShaderBlobs blobs;
-        std::wstring error;
         ShaderDesc desc;
         desc.hlslPath = L"shaders/Triangle.hlsl";
         desc.entryVS = L"VSMain";
         desc.entryPS = L"PSMain";
         desc.targetVS = L"vs_6_0";
         desc.targetPS = L"ps_6_0";
-        
-        // 簡易的なコンパイル関数を追加
-        auto compile_ = [](const ShaderDesc& desc, ShaderBlobs& out, std::wstring& error) -> bool {
-            // ファイル読み込み
-            FILE* fp = nullptr;
-            _wfopen_s(&fp, desc.hlslPath.c_str(), L"rb");
-            if (!fp) return false;
-            fseek(fp, 0, SEEK_END);
-            long sz = ftell(fp);
-            fseek(fp, 0, SEEK_SET);
-            std::vector<char> buf(sz + 1);
-            fread(buf.data(), 1, sz, fp);
-            fclose(fp);
-            buf[sz] = 0;
-
-            // D3DCompile使用
-            Microsoft::WRL::ComPtr<ID3DBlob> vs, ps, errorBlob;
-            
-            HRESULT hr = D3DCompile(buf.data(), sz, nullptr, nullptr, nullptr, 
-                "VSMain", "vs_6_0", 0, 0, &vs, &errorBlob);
-            if (FAILED(hr)) {
-                if (errorBlob) error = std::string((char*)errorBlob->GetBufferPointer());
-                return false;
-            }
-            
-            hr = D3DCompile(buf.data(), sz, nullptr, nullptr, nullptr, 
-                "PSMain", "ps_6_0", 0, 0, &ps, &errorBlob);
-            if (FAILED(hr)) {
-                if (errorBlob) error = std::string((char*)errorBlob->GetBufferPointer());
-                return false;
+        return desc;
+    }
+
+    void RenderPass_Triangle::StartPipelineState()
+    {
+        // 初期化時はシェーダーパックから（ホットリロード時はコンパイル）。PSO ライブラリにあればドライバーのコンパイルも無い
+        m_pipelineFuture = JobSystem::Get().Async([this]() -> PipelinePtr
+        {
+            ShaderBlobs blobs;
+            std::wstring error;
+            if (!ShaderCompiler::Get().Load(GetShaderDesc(), blobs, error)) {
+                spdlog::error("Failed to load shaders: {}", error);
+                return nullptr;
             }
-            
-            out.vs = vs;
-            out.ps = ps;
-            return true;
-        };
-        
-        if (!compile_(desc, blobs, error)) {
-            spdlog::error("Failed to compile shaders: {}", error);
-            return false;
+            return BuildPipelineState(blobs);
+        });
+    }
+
+    bool RenderPass_Triangle::WaitPipelineState()
+    {
+        if (m_pipelineFuture.valid())
+        {
+            m_pipelineState = JobSystem::Get().Wait(m_pipelineFuture);
         }
-        
-        return CreatePipelineState(blobs);
+        return m_pipelineState != nullptr;
     }
 
-    bool RenderPass_Triangle::CreatePipelineState(const ShaderBlobs& blobs)
+    PipelinePtr RenderPass_Triangle::BuildPipelineState(const ShaderBlobs& blobs)
     {
 
-        // 入力レイアウト
-        D3D12_INPUT_ELEMENT_DESC inputElementDescs[] = {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-        };
+        // パックのリフレクションがあれば、入力レイアウトとシェーダーの食い違いを PSO 作成の前に知らせる
+        if (blobs.vsReflection)
+        {
+            std::string layoutError;
+            if (!CheckInputLayout(*blobs.vsReflection, kInputElements.data(), kInputLayout.count, layoutError))
+            {
+                spdlog::warn("shaders/Triangle.hlsl: {}", layoutError);
+            }
+        }
 
-        // パイプラインステート
-        D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-        psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
+        // パイプラインステート（固定部分は kPipelineState）
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = ToD3D12PipelineDesc(kPipelineState, kInputElements.data());
         psoDesc.pRootSignature = m_rootSignature.Get();
         psoDesc.VS = { blobs.vs->GetBufferPointer(), blobs.vs->GetBufferSize() };
         psoDesc.PS = { blobs.ps->GetBufferPointer(), blobs.ps->GetBufferSize() };
-        
-        // ラスタライザー設定
-        D3D12_RASTERIZER_DESC rasterizerDesc = {};
-        rasterizerDesc.FillMode = D3D12_FILL_MODE_SOLID;
-        rasterizerDesc.CullMode = D3D12_CULL_MODE_BACK;
-        rasterizerDesc.FrontCounterClockwise = FALSE;
-        rasterizerDesc.DepthBias = D3D12_DEFAULT_DEPTH_BIAS;
-        rasterizerDesc.DepthBiasClamp = D3D12_DEFAULT_DEPTH_BIAS_CLAMP;
-        rasterizerDesc.SlopeScaledDepthBias = D3D12_DEFAULT_SLOPE_SCALED_DEPTH_BIAS;
-        rasterizerDesc.DepthClipEnable = TRUE;
-        rasterizerDesc.MultisampleEnable = FALSE;
-        rasterizerDesc.AntialiasedLineEnable = FALSE;
-        rasterizerDesc.ForcedSampleCount = 0;
-        rasterizerDesc.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF;
-        psoDesc.RasterizerState = rasterizerDesc;
-        
-        // ブレンド設定
-        D3D12_BLEND_DESC blendDesc = {};
-        blendDesc.AlphaToCoverageEnable = FALSE;
-        blendDesc.IndependentBlendEnable = FALSE;
-        blendDesc.RenderTarget[0].BlendEnable = FALSE;
-        blendDesc.RenderTarget[0].LogicOpEnable = FALSE;
-        blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_ONE;
-        blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_ZERO;
-        blendDesc.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
-        blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
-        blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ZERO;
-        blendDesc.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
-        blendDesc.RenderTarget[0].LogicOp = D3D12_LOGIC_OP_NOOP;
-        blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
-        psoDesc.BlendState = blendDesc;
-        
-        psoDesc.DepthStencilState.DepthEnable = FALSE;
-        psoDesc.DepthStencilState.StencilEnable = FALSE;
-        psoDesc.SampleMask = UINT_MAX;
-        psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-        psoDesc.NumRenderTargets = 1;
-        psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
-        psoDesc.SampleDesc.Count = 1;
-
-        HRESULT hr = m_device->GetDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState));
+
+        PipelinePtr pso;
+        HRESULT hr = m_device->GetPipelineCache()->CreateGraphicsPipelineState(psoDesc, kPipelineStateHash, &pso);
         if (FAILED(hr))
         {
             spdlog::error("Failed to create pipeline state: 0x{:x}", hr);
-            return false;
+            return nullptr;
         }
-
-        return true;
+        return pso;
     }
 
     bool RenderPass_Triangle::CreateVertexBuffer()
@@ -285,14 +236,10 @@ namespace jisaku
         return true;
     }
 
-    void RenderPass_Triangle::OnShadersReloaded(const ShaderBlobs& blobs)
+    PipelinePtr RenderPass_Triangle::SwapPipelineState(PipelinePtr pso)
     {
-        // PSO再作成
-        if (CreatePipelineState(blobs)) {
-            spdlog::info("Triangle shaders reloaded successfully");
-        } else {
-            spdlog::warn("Failed to reload triangle shaders, keeping old PSO");
-        }
+        m_pipelineState.swap(pso);
+        return pso;
     }
 
     void RenderPass_Triangle::Execute(ID3D12GraphicsCommandList* cmd, Swapchain& swap)
@@ -319,7 +266,7 @@ namespace jisaku
         cmd->RSSetScissorRects(1, &sc);
 
         // パイプライン設定
-        cmd->SetPipelineState(m_pipelineState.Get());
+        cmd->SetPipelineState(m_pipelineState.get());
         cmd->SetGraphicsRootSignature(m_rootSignature.Get());
 
         // 頂点バッファ設定
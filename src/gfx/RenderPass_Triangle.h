@@ -2,6 +2,7 @@
 
 #include <d3d12.h>
 #include <wrl/client.h>
+#include <future>
 #include <memory>
 #include "gfx/ShaderReloader.h"
 
@@ -19,21 +20,27 @@ namespace jisaku
         bool Initialize(DX12Device* device, Swapchain* swapchain);
         void Shutdown();
         void Execute(ID3D12GraphicsCommandList* cmd, Swapchain& swap);
+        // Initialize がワーカーで作り始めた PSO を受け取る（Execute より前に呼ぶ）。作れなければ false
+        bool WaitPipelineState();
+
+        // 使うシェーダー（ShaderReloader にも同じものを登録する）
+        static ShaderDesc GetShaderDesc();
 
         // IHotReloadable
-        void OnShadersReloaded(const ShaderBlobs& blobs) override;
+        PipelinePtr BuildPipelineState(const ShaderBlobs& blobs) override;
+        PipelinePtr SwapPipelineState(PipelinePtr pso) override;
 
     private:
         bool CreateRootSignature();
-        bool CreatePipelineState();
-        bool CreatePipelineState(const ShaderBlobs& blobs);
+        void StartPipelineState();
         bool CreateVertexBuffer();
 
         DX12Device* m_device;
         Swapchain* m_swapchain;
         
         Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
-        Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipelineState;
+        PipelinePtr m_pipelineState;
+        std::future<PipelinePtr> m_pipelineFuture;
         Microsoft::WRL::ComPtr<ID3D12Resource> m_vertexBuffer;
         D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView;
     };
@@ -0,0 +1,329 @@
+#include "gfx/ShaderCompiler.h"
+#include "core/Vfs.h"
+#include <d3dcompiler.h>
+#include <dxcapi.h>
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <cstring>
+
+using Microsoft::WRL::ComPtr;
+
+namespace jisaku
+{
+    namespace
+    {
+        // キーに入れる、バイトコードに影響する引数（compileDxc_ と揃える）
+        constexpr const char* kArgs = "-Zi -Qembed_debug -Zpr";
+
+        std::string Narrow(const std::wstring& w)
+        {
+            if (w.empty()) return {};
+            const int n = WideCharToMultiByte(CP_UTF8, 0, w.data(), (int)w.size(), nullptr, 0, nullptr, nullptr);
+            std::string s(size_t(n), '\0');
+            WideCharToMultiByte(CP_UTF8, 0, w.data(), (int)w.size(), s.data(), n, nullptr, nullptr);
+            return s;
+        }
+
+        std::wstring Widen(const std::string& s)
+        {
+            if (s.empty()) return {};
+            const int n = MultiByteToWideChar(CP_UTF8, 0, s.data(), (int)s.size(), nullptr, 0);
+            std::wstring w(size_t(n), L'\0');
+            MultiByteToWideChar(CP_UTF8, 0, s.data(), (int)s.size(), w.data(), n);
+            return w;
+        }
+
+        bool ReadSource(const std::string& path, std::string& out)
+        {
+            std::vector<uint8_t> buf;
+            if (!Vfs::Get().ReadFile(std::filesystem::path(std::u8string(path.begin(), path.end())), buf)) return false;
+            out.assign(buf.begin(), buf.end());
+            return true;
+        }
+
+        bool MakeBlob(const void* data, size_t size, ComPtr<ID3DBlob>& out)
+        {
+            if (FAILED(D3DCreateBlob(size, &out))) return false;
+            std::memcpy(out->GetBufferPointer(), data, size);
+            return true;
+        }
+
+        // IDxcCompiler3 は同時に使えないので、スレッドごとに持って使い回す（JobSystem のワーカーは寿命が長い）
+        struct ThreadDxc
+        {
+            ComPtr<IDxcCompiler3> compiler;
+            bool tried = false;
+        };
+
+        IDxcCompiler3* GetThreadCompiler()
+        {
+            thread_local ThreadDxc t_dxc;
+            if (!t_dxc.tried) {
+                t_dxc.tried = true;
+                if (FAILED(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&t_dxc.compiler))))
+                {
+                    t_dxc.compiler.Reset();
+                    spdlog::error("ShaderCompiler: DxcCreateInstance failed (dxcompiler.dll missing?)");
+                }
+            }
+            return t_dxc.compiler.Get();
+        }
+
+        // DXC を入れ替えたら別のキーになるように、バージョンとコミットをキーに入れる
+        std::string QueryCompilerVersion(IDxcCompiler3* compiler)
+        {
+            std::string id = "dxc";
+            ComPtr<IDxcVersionInfo> version;
+            if (SUCCEEDED(compiler->QueryInterface(IID_PPV_ARGS(&version)))) {
+                UINT32 major = 0, minor = 0;
+                version->GetVersion(&major, &minor);
+                id += " " + std::to_string(major) + "." + std::to_string(minor);
+            }
+            ComPtr<IDxcVersionInfo2> version2;
+            if (SUCCEEDED(compiler->QueryInterface(IID_PPV_ARGS(&version2)))) {
+                UINT32 commitCount = 0;
+                char* commitHash = nullptr;
+                if (SUCCEEDED(version2->GetCommitInfo(&commitCount, &commitHash)) && commitHash) {
+                    id += " " + std::to_string(commitCount) + " " + commitHash;
+                    CoTaskMemFree(commitHash);
+                }
+            }
+            return id;
+        }
+    }
+
+    ShaderCompiler& ShaderCompiler::Get()
+    {
+        static ShaderCompiler s_instance(".shadercache");
+        return s_instance;
+    }
+
+    ShaderCompiler::ShaderCompiler(const std::filesystem::path& cacheDirectory)
+        : m_cache(cacheDirectory)
+    {
+    }
+
+    ShaderCompiler::~ShaderCompiler() = default;
+
+    bool ShaderCompiler::compileDxc_(const ShaderSource& source, const std::wstring& entry, const std::wstring& target,
+                                     const std::vector<std::wstring>& defines, std::vector<uint8_t>& out, std::wstring& error)
+    {
+        // #include は展開済みなのでインクルードハンドラは渡さない
+        DxcBuffer src{ source.text.data(), source.text.size(), DXC_CP_UTF8 };
+        std::vector<LPCWSTR> args = { L"-E", entry.c_str(), L"-T", target.c_str(), L"-Zi", L"-Qembed_debug", L"-Zpr" /*row-major*/ };
+        for (auto& d : defines) { args.push_back(L"-D"); args.push_back(d.c_str()); }
+
+        IDxcCompiler3* compiler = GetThreadCompiler();
+        if (!compiler) {
+            error = L"DXC is not available";
+            return false;
+        }
+        ComPtr<IDxcResult> result;
+        if (FAILED(compiler->Compile(&src, args.data(), (UINT32)args.size(), nullptr, IID_PPV_ARGS(&result)))) {
+            error = L"IDxcCompiler3::Compile failed";
+            return false;
+        }
+
+        ComPtr<IDxcBlobUtf8> err;
+        result->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&err), nullptr);
+        if (err && err->GetStringLength() > 0) error = Widen(std::string(err->GetStringPointer(), err->GetStringLength()));
+
+        HRESULT status = E_FAIL;
+        result->GetStatus(&status);
+        if (FAILED(status)) return false;
+
+        ComPtr<IDxcBlob> dxil;
+        if (FAILED(result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&dxil), nullptr)) || !dxil) {
+            error = L"DXC returned no object";
+            return false;
+        }
+        const uint8_t* p = static_cast<const uint8_t*>(dxil->GetBufferPointer());
+        out.assign(p, p + dxil->GetBufferSize());
+        return true;
+    }
+
+    bool ShaderCompiler::CollectDependencies(const std::wstring& path, std::vector<std::string>& dependencies, std::wstring& error)
+    {
+        ShaderSource source;
+        std::string expandError;
+        const std::u8string main = std::filesystem::path(path).generic_u8string();
+        const bool ok = ExpandShaderIncludes(std::string(main.begin(), main.end()), ReadSource, { "shaders" }, source, expandError);
+        if (!ok) error = Widen(expandError);
+        dependencies = std::move(source.files);
+        return ok;
+    }
+
+    bool ShaderCompiler::Compile(const std::wstring& path, const std::wstring& entry, const std::wstring& target,
+                                 const std::vector<std::wstring>& defines, ComPtr<ID3DBlob>& out, std::wstring& error,
+                                 std::vector<std::string>* dependencies)
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        auto finish = [&](bool ok) {
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_totalMs += ms;
+            return ok;
+        };
+
+        ShaderSource source;
+        std::string expandError;
+        const std::u8string main = std::filesystem::path(path).generic_u8string();
+        const bool expanded = ExpandShaderIncludes(std::string(main.begin(), main.end()), ReadSource, { "shaders" }, source, expandError);
+        if (dependencies) *dependencies = source.files;
+        if (!expanded) {
+            error = Widen(expandError);
+            return finish(false);
+        }
+
+        std::call_once(m_versionOnce, [this] {
+            if (IDxcCompiler3* compiler = GetThreadCompiler()) {
+                m_compilerVersion = QueryCompilerVersion(compiler);
+                spdlog::info("ShaderCompiler: {} (cache {})", m_compilerVersion, m_cache.GetDirectory().string());
+            }
+        });
+        if (m_compilerVersion.empty()) {
+            // バージョンが分からないとキーが作れない（キャッシュにあっても使わない）
+            error = L"DXC is not available";
+            return finish(false);
+        }
+
+        std::vector<std::string> keyDefines;
+        keyDefines.reserve(defines.size());
+        for (auto& d : defines) keyDefines.push_back(Narrow(d));
+        const std::string entryName = Narrow(entry);
+        const std::string targetName = Narrow(target);
+        ShaderKeyDesc keyDesc;
+        keyDesc.source = source.text;
+        keyDesc.entry = entryName;
+        keyDesc.target = targetName;
+        keyDesc.defines = &keyDefines;
+        keyDesc.compiler = m_compilerVersion;
+        keyDesc.args = kArgs;
+        const ContentKey key = MakeShaderCacheKey(keyDesc);
+
+        std::vector<uint8_t> bytecode;
+        if (!m_cache.Load(key, bytecode)) {
+            if (!compileDxc_(source, entry, target, defines, bytecode, error)) return finish(false);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_compiles;
+            }
+            if (!m_cache.Store(key, bytecode.data(), bytecode.size()))
+                spdlog::warn("ShaderCompiler: failed to write cache entry {}", key.ToHex());
+        }
+        if (!MakeBlob(bytecode.data(), bytecode.size(), out)) {
+            error = L"D3DCreateBlob failed";
+            return finish(false);
+        }
+        return finish(true);
+    }
+
+    bool ShaderCompiler::LoadPack(const std::filesystem::path& file)
+    {
+        std::vector<uint8_t> bytes;
+        if (!Vfs::Get().ReadFile(file, bytes)) return false;
+        if (!m_pack.Load(std::move(bytes)))
+        {
+            spdlog::warn("ShaderCompiler: {} is corrupt or from another version", file.string());
+            return false;
+        }
+        return true;
+    }
+
+    bool ShaderCompiler::loadFromPack_(const std::wstring& path, const std::wstring& entry, const std::vector<std::wstring>& defines,
+                                       ComPtr<ID3DBlob>& out, const ShaderReflection*& reflection)
+    {
+        std::vector<std::string> names;
+        names.reserve(defines.size());
+        for (auto& d : defines) names.push_back(Narrow(d));
+        const std::u8string main = std::filesystem::path(path).generic_u8string();
+        const ShaderPackEntry* e = m_pack.Find(MakeShaderId(std::string(main.begin(), main.end()), Narrow(entry), names));
+        if (!e || !MakeBlob(m_pack.GetBytecode(*e), size_t(e->size), out)) return false;
+        reflection = &e->reflection;
+        return true;
+    }
+
+    bool ShaderCompiler::Load(const ShaderDesc& desc, ShaderBlobs& out, std::wstring& error)
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        ComPtr<ID3DBlob> vs, ps;
+        const ShaderReflection* vsReflection = nullptr;
+        const ShaderReflection* psReflection = nullptr;
+        if (loadFromPack_(desc.hlslPath, desc.entryVS, desc.defines, vs, vsReflection) &&
+            loadFromPack_(desc.hlslPath, desc.entryPS, desc.defines, ps, psReflection))
+        {
+            out.vs = vs;
+            out.ps = ps;
+            out.vsReflection = vsReflection;
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_totalMs += ms;
+            m_packLoads += 2;
+            return true;
+        }
+        if (!m_runtimeCompile)
+        {
+            error = desc.hlslPath + L" is not in the shader pack (add it to shaders/ShaderPack.txt, or run with JISAKU_SHADER_HOT_RELOAD=1)";
+            return false;
+        }
+        return Compile(desc, out, error);
+    }
+
+    bool ShaderCompiler::Compile(const ShaderDesc& desc, ShaderBlobs& out, std::wstring& error,
+                                 std::vector<std::string>* dependencies)
+    {
+        // VS と PS は同じファイルなので、読むファイルも同じ
+        ComPtr<ID3DBlob> vs, ps;
+        if (!Compile(desc.hlslPath, desc.entryVS, desc.targetVS, desc.defines, vs, error, dependencies)) return false;
+        if (!Compile(desc.hlslPath, desc.entryPS, desc.targetPS, desc.defines, ps, error)) return false;
+        out.vs = vs;
+        out.ps = ps;
+        return true;
+    }
+
+    double ShaderCompiler::GetTotalMs() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_totalMs;
+    }
+
+    uint64_t ShaderCompiler::GetCompileCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_compiles;
+    }
+
+    uint64_t ShaderCompiler::GetPackLoadCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_packLoads;
+    }
+
+    bool CheckInputLayout(const ShaderReflection& reflection, const D3D12_INPUT_ELEMENT_DESC* layout, UINT count,
+                          std::string& error)
+    {
+        auto sameName = [](const std::string& a, const char* b) {
+            return _stricmp(a.c_str(), b) == 0; // セマンティクス名は大文字小文字を区別しない
+        };
+        std::string missing;
+        for (const ShaderSignatureElement& in : reflection.inputs)
+        {
+            if (in.semantic.size() > 3 && _strnicmp(in.semantic.c_str(), "SV_", 3) == 0) continue;
+            bool found = false;
+            for (UINT i = 0; i < count && !found; ++i)
+            {
+                found = layout[i].SemanticIndex == in.index && sameName(in.semantic, layout[i].SemanticName);
+            }
+            if (!found)
+            {
+                if (!missing.empty()) missing += ", ";
+                missing += in.semantic + std::to_string(in.index);
+            }
+        }
+        if (missing.empty()) return true;
+        error = "input layout is missing " + missing;
+        return false;
+    }
+}
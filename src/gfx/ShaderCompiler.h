@@ -0,0 +1,81 @@
+#pragma once
+#include <wrl.h>
+#include <d3d12.h>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core/ShaderCache.h"
+#include "core/ShaderPack.h"
+#include "gfx/ShaderReloader.h"
+
+namespace jisaku {
+
+// DXC でのコンパイルとバイトコードのディスクキャッシュ。
+// - ソースは Vfs から読み、#include を展開してからキーを作る（インクルード先の変更でも別のキーになる）
+// - ヒットすればキャッシュのバイトコードを返し、DXC は呼ばない
+// - DXC のインスタンスはスレッドごとに初回に作って使い回す（Compile は複数スレッドから同時に呼んでよい）
+// 起動時のパスは Load で読む。シェーダーパック（JisakuShaderPack が書く）にあればそこから取り、
+// 実行時のコンパイルはホットリロードのとき（SetRuntimeCompile(true)）だけ行う
+class ShaderCompiler {
+public:
+    // プロセス共通（キャッシュは作業ディレクトリの .shadercache）
+    static ShaderCompiler& Get();
+
+    explicit ShaderCompiler(const std::filesystem::path& cacheDirectory);
+    ~ShaderCompiler();
+
+    ShaderCompiler(const ShaderCompiler&) = delete;
+    ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+    // dependencies には読んだファイル（Vfs の仮想パス、先頭が path）を入れる。失敗しても読めたところまでは入る
+    bool Compile(const std::wstring& path, const std::wstring& entry, const std::wstring& target,
+                 const std::vector<std::wstring>& defines, Microsoft::WRL::ComPtr<ID3DBlob>& out, std::wstring& error,
+                 std::vector<std::string>* dependencies = nullptr);
+    // desc の VS と PS
+    bool Compile(const ShaderDesc& desc, ShaderBlobs& out, std::wstring& error,
+                 std::vector<std::string>* dependencies = nullptr);
+    // パックを読む（Vfs 経由）。LoadPack は他のスレッドが Load する前に呼ぶこと
+    bool LoadPack(const std::filesystem::path& file);
+    const ShaderPack& GetPack() const { return m_pack; }
+    // false ならパックに無いシェーダーは Load で失敗する（DXC を呼ばない）。既定は true
+    void SetRuntimeCompile(bool enabled) { m_runtimeCompile = enabled; }
+    bool IsRuntimeCompileEnabled() const { return m_runtimeCompile; }
+    // desc の VS と PS をパックから取る。無ければ（許されていれば）Compile する
+    bool Load(const ShaderDesc& desc, ShaderBlobs& out, std::wstring& error);
+
+    // コンパイルせずに #include をたどって、path が読むファイルを集める
+    bool CollectDependencies(const std::wstring& path, std::vector<std::string>& dependencies, std::wstring& error);
+
+    ShaderCache::Stats GetCacheStats() const { return m_cache.GetStats(); }
+    // Load / Compile にかかった合計（パック・キャッシュのヒットも含む）と DXC を呼んだ回数
+    double GetTotalMs() const;
+    uint64_t GetCompileCount() const;
+    // パックから取ったシェーダーの数
+    uint64_t GetPackLoadCount() const;
+
+private:
+    bool compileDxc_(const ShaderSource& source, const std::wstring& entry, const std::wstring& target,
+                     const std::vector<std::wstring>& defines, std::vector<uint8_t>& out, std::wstring& error);
+
+    bool loadFromPack_(const std::wstring& path, const std::wstring& entry, const std::vector<std::wstring>& defines,
+                       Microsoft::WRL::ComPtr<ID3DBlob>& out, const ShaderReflection*& reflection);
+
+    ShaderCache m_cache;
+    ShaderPack m_pack;
+    bool m_runtimeCompile = true;
+    std::once_flag m_versionOnce;
+    std::string m_compilerVersion; // キーに入れる。DXC が使えなければ空
+    mutable std::mutex m_mutex;    // 統計用
+    double m_totalMs = 0.0;
+    uint64_t m_compiles = 0;
+    uint64_t m_packLoads = 0;
+};
+
+// パックのリフレクション（頂点シェーダーの入力シグネチャ）にあるセマンティクスが layout にすべてあるか。
+// 足りなければ error に書いて false（SV_ で始まるシステム値は見ない）
+bool CheckInputLayout(const ShaderReflection& reflection, const D3D12_INPUT_ELEMENT_DESC* layout, UINT count,
+                      std::string& error);
+
+} // namespace jisaku
@@ -0,0 +1,125 @@
+#include "gfx/ShaderPermutationManager.h"
+#include "gfx/ShaderCompiler.h"
+#include <spdlog/spdlog.h>
+
+using namespace jisaku;
+
+ShaderPermutationManager::~ShaderPermutationManager(){
+    for (auto& s : m_shaders) s->cache->WaitIdle();
+}
+
+int ShaderPermutationManager::Register(const ShaderDesc& base, const PermutationSchema& schema, IHotReloadable* sink){
+    auto shader = std::make_unique<Shader_>();
+    shader->base = base;
+    shader->schema = schema;
+    shader->sink = sink;
+    const std::u8string name = std::filesystem::path(base.hlslPath).generic_u8string();
+    shader->name.assign(name.begin(), name.end());
+
+    // ワーカーで呼ばれる。Shader_ は unique_ptr の中なので m_shaders が伸びても動かない
+    const Shader_* s = shader.get();
+    PermutationCache<Pso_>::Config config;
+    config.capacity = m_config.capacity;
+    config.maxBuilding = m_config.maxBuilding;
+    shader->cache = std::make_unique<PermutationCache<Pso_>>([s](PermutationKey key, Pso_& out){
+        ShaderDesc desc = s->base;
+        for (const std::string& d : s->schema.MakeDefines(key)) desc.defines.emplace_back(d.begin(), d.end());
+        ShaderBlobs blobs; std::wstring error;
+        if (!ShaderCompiler::Get().Load(desc, blobs, error)) {
+            spdlog::warn("Shader permutation {} [{}] failed: {}", s->name, s->schema.Format(key), std::string(error.begin(), error.end()));
+            return false;
+        }
+        out = s->sink->BuildPipelineState(blobs);
+        return out != nullptr;
+    }, config);
+
+    m_shaders.push_back(std::move(shader));
+    return (int)m_shaders.size();
+}
+
+ID3D12PipelineState* ShaderPermutationManager::Request(int id, PermutationKey key){
+    if (id <= 0 || id > (int)m_shaders.size()) return nullptr;
+    Shader_& s = *m_shaders[id - 1];
+    key &= s.schema.GetMask();
+    if (key == 0) return nullptr; // 基本形はパス自身が持っている
+    const Pso_* pso = s.cache->Request(key);
+    return pso ? pso->get() : nullptr;
+}
+
+void ShaderPermutationManager::Prefetch(int id, PermutationKey key){
+    if (id <= 0 || id > (int)m_shaders.size()) return;
+    Shader_& s = *m_shaders[id - 1];
+    key &= s.schema.GetMask();
+    if (key != 0) s.cache->Prefetch(key);
+}
+
+size_t ShaderPermutationManager::Apply(DeferredReleaseQueue& retired, uint64_t retireFence){
+    size_t applied = 0;
+    for (auto& s : m_shaders) applied += s->cache->Apply(m_evicted);
+    retire_(retired, retireFence);
+    return applied;
+}
+
+void ShaderPermutationManager::Invalidate(const std::wstring& hlslPath, DeferredReleaseQueue& retired, uint64_t retireFence){
+    for (auto& s : m_shaders) {
+        if (s->base.hlslPath == hlslPath) s->cache->Clear(m_evicted);
+    }
+    retire_(retired, retireFence);
+}
+
+void ShaderPermutationManager::retire_(DeferredReleaseQueue& retired, uint64_t fence){
+    for (Pso_& pso : m_evicted) {
+        if (pso) retired.Retire(fence, std::move(pso));
+    }
+    m_evicted.clear();
+}
+
+size_t ShaderPermutationManager::LoadUsage(const std::filesystem::path& file){
+    if (!m_usage.Load(file)) return 0;
+    size_t warmed = 0;
+    for (auto& s : m_shaders) {
+        const std::vector<std::string>* list = m_usage.Find(s->name);
+        if (!list) continue;
+        for (const std::string& features : *list) {
+            PermutationKey key = 0;
+            // 機能を消した・名前を変えたものは読み飛ばす
+            if (!s->schema.Parse(features, key) || key == 0) continue;
+            s->cache->Prefetch(key);
+            ++warmed;
+        }
+    }
+    return warmed;
+}
+
+bool ShaderPermutationManager::SaveUsage(const std::filesystem::path& file){
+    for (auto& s : m_shaders) {
+        for (PermutationKey key : s->cache->GetUsedKeys()) {
+            if (key != 0) m_usage.Add(s->name, s->schema.Format(key));
+        }
+    }
+    return m_usage.Save(file);
+}
+
+uint32_t ShaderPermutationManager::GetBuildingCount() const{
+    uint32_t n = 0;
+    for (auto& s : m_shaders) n += s->cache->GetBuildingCount();
+    return n;
+}
+
+size_t ShaderPermutationManager::GetPendingCount() const{
+    size_t n = 0;
+    for (auto& s : m_shaders) n += s->cache->GetPendingCount();
+    return n;
+}
+
+size_t ShaderPermutationManager::GetVariantCount() const{
+    size_t n = 0;
+    for (auto& s : m_shaders) n += s->cache->Size();
+    return n;
+}
+
+uint64_t ShaderPermutationManager::GetFailedCount() const{
+    uint64_t n = 0;
+    for (auto& s : m_shaders) n += s->cache->GetFailedCount();
+    return n;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <wrl.h>
+#include <d3d12.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/DeferredReleaseQueue.h"
+#include "core/PermutationCache.h"
+#include "core/ShaderPermutations.h"
+#include "gfx/ShaderReloader.h"
+
+namespace jisaku {
+
+// パスが宣言した機能ビットの組（パーミュテーション）ごとの PSO を、使われたときにワーカーで作る。
+// - シェーダーは ShaderCompiler::Load で取る（パックにあればそこから。ホットリロード時は define を付けてコンパイル）
+// - できるまでは近いパーミュテーション（PermutationCache 参照）、それも無ければ null を返すので、パスは基本形の PSO で描く
+// - 作った PSO はシェーダーごとに capacity 個まで。手放した PSO は retireFence を付けて DeferredReleaseQueue へ預ける
+// - 使ったパーミュテーションを SaveUsage で書き出し、次の起動で LoadUsage すると先に作り始める
+// メインスレッドから呼ぶ（ワーカーで呼ばれるのは sink->BuildPipelineState だけ）
+class ShaderPermutationManager {
+public:
+    struct Config {
+        size_t capacity = 16;     // シェーダーごとに持つ PSO の数
+        uint32_t maxBuilding = 2; // シェーダーごとに同時に作る数
+    };
+
+    ShaderPermutationManager() : ShaderPermutationManager(Config{}) {}
+    explicit ShaderPermutationManager(const Config& config) : m_config(config) {}
+    ~ShaderPermutationManager(); // 作りかけのジョブの完了を待つ（sink より先に破棄すること）
+
+    ShaderPermutationManager(const ShaderPermutationManager&) = delete;
+    ShaderPermutationManager& operator=(const ShaderPermutationManager&) = delete;
+
+    // base の defines に機能ビットの define を足して作る。PSO は sink->BuildPipelineState（ワーカーで呼ぶ）。戻り値は id
+    int Register(const ShaderDesc& base, const PermutationSchema& schema, IHotReloadable* sink);
+
+    // key の PSO（まだなら作り始めて代わりを返す）。null なら基本形で描くこと。次の Apply まで有効
+    ID3D12PipelineState* Request(int id, PermutationKey key);
+    void Prefetch(int id, PermutationKey key);
+
+    // できた PSO を取り込む（フレームの区切り、コマンド記録前）。追い出した PSO は retireFence を付けて retired へ預ける
+    size_t Apply(DeferredReleaseQueue& retired, uint64_t retireFence);
+    // hlslPath のシェーダーが作り直された（ホットリロード）。そのシェーダーの PSO をすべて retired へ預ける
+    void Invalidate(const std::wstring& hlslPath, DeferredReleaseQueue& retired, uint64_t retireFence);
+
+    // 記録にあるパーミュテーションを Prefetch する。戻り値は先読みを始めた数
+    size_t LoadUsage(const std::filesystem::path& file);
+    // 読んだ記録に今回使ったものを足して書く
+    bool SaveUsage(const std::filesystem::path& file);
+
+    uint32_t GetBuildingCount() const;
+    size_t GetPendingCount() const;
+    size_t GetVariantCount() const;
+    uint64_t GetFailedCount() const;
+
+private:
+    using Pso_ = PipelinePtr;
+    struct Shader_ {
+        ShaderDesc base;
+        PermutationSchema schema;
+        IHotReloadable* sink = nullptr;
+        std::string name; // 使用記録のキー（Vfs の仮想パス）
+        std::unique_ptr<PermutationCache<Pso_>> cache; // ジョブが上を参照するので最後に破棄する
+    };
+    void retire_(DeferredReleaseQueue& retired, uint64_t fence);
+
+    Config m_config;
+    std::vector<std::unique_ptr<Shader_>> m_shaders; // id - 1
+    std::vector<Pso_> m_evicted;
+    PermutationUsage m_usage;
+};
+
+} // namespace jisaku
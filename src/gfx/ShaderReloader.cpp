@@ -1,105 +1,137 @@
 #include "gfx/ShaderReloader.h"
 #include "gfx/DX12Device.h"
+#include "gfx/ShaderCompiler.h"
+#include "core/JobSystem.h"
+#include <spdlog/spdlog.h>
 #include <d3d12.h>
-#include <dxcapi.h>
+#include <chrono>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <cassert>
 
-using Microsoft::WRL::ComPtr;
 using namespace jisaku;
 
-bool ShaderReloader::Init(DX12Device* dev){ m_dev = dev; return true; }
+ShaderReloader::~ShaderReloader(){ m_results.WaitIdle(); }
+
+bool ShaderReloader::Init(DX12Device* dev){
+    m_dev = dev;
+    m_watcher = std::make_unique<FileWatcher>();
+    if (!m_watcher->IsAvailable()) m_watcher.reset();
+    return true;
+}
 
 int ShaderReloader::Register(const ShaderDesc& desc, IHotReloadable* sink){
     Item it; it.desc = desc; it.sink = sink;
-    if (std::filesystem::exists(desc.hlslPath)) it.lastWrite = std::filesystem::last_write_time(desc.hlslPath);
-    m_items[m_nextId] = std::move(it);
-    return m_nextId++;
+    const int id = m_nextId++;
+    m_items[id] = std::move(it);
+    // 最初のコンパイルは呼び出し側で済んでいるので、#include をたどって読むファイルだけ集める
+    std::vector<std::string> files; std::wstring err;
+    ShaderCompiler::Get().CollectDependencies(desc.hlslPath, files, err);
+    if (files.empty()) {
+        const std::u8string main = std::filesystem::path(desc.hlslPath).generic_u8string();
+        files.emplace_back(main.begin(), main.end());
+    }
+    setDependencies_(id, files);
+    return id;
 }
 
 void ShaderReloader::Tick(double dt, double intervalSec){
+    std::vector<std::string> changed;
+    if (m_watcher) {
+        m_events.clear();
+        m_watcher->Poll(m_events);
+        for (uint64_t fileId : m_events) {
+            auto f = m_files.find(fileId);
+            if (f != m_files.end() && detectChanged_(f->second)) changed.push_back(f->second.path);
+        }
+    }
     m_accum += dt;
-    if (m_accum < intervalSec) return;
-    m_accum = 0.0;
-    for (auto& [id, it] : m_items) {
-        if (!detectChanged_(it)) continue;
-        ShaderBlobs blobs; std::wstring err;
-        if (compile_(it.desc, blobs, err)) {
-            it.cached = blobs;
-            if (it.sink) it.sink->OnShadersReloaded(blobs);
-        } else {
-            // TODO: spdlog warn(err)
+    if (m_accum >= intervalSec) {
+        m_accum = 0.0;
+        for (auto& [fileId, f] : m_files) {
+            if (!f.watched && detectChanged_(f)) changed.push_back(f.path);
         }
     }
+    if (changed.empty()) return;
+    // 変わったファイルを読んでいるシェーダーだけ（共有の include なら全部、個別のファイルならそれだけ）
+    for (uint64_t id : m_graph.GetDependents(changed)) {
+        auto it = m_items.find((int)id);
+        if (it != m_items.end()) submit_(it->first, it->second);
+    }
 }
 
 void ShaderReloader::ForceRebuildAll(){
-    for (auto& [id,it] : m_items) {
-        ShaderBlobs blobs; std::wstring err;
-        if (compile_(it.desc, blobs, err)) {
-            it.cached = blobs;
-            if (it.sink) it.sink->OnShadersReloaded(blobs);
-            if (std::filesystem::exists(it.desc.hlslPath))
-                it.lastWrite = std::filesystem::last_write_time(it.desc.hlslPath);
-        }
-    }
+    for (auto& [id,it] : m_items) submit_(id, it);
 }
 
-bool ShaderReloader::detectChanged_(Item& it){
-    namespace fs = std::filesystem;
-    if (!fs::exists(it.desc.hlslPath)) return false;
-    auto t = fs::last_write_time(it.desc.hlslPath);
-    if (t != it.lastWrite){ it.lastWrite = t; return true; }
-    return false;
+void ShaderReloader::submit_(int id, const Item& it){
+    // コンパイル（ShaderCompiler はスレッドごとの DXC を使う）と PSO 作成をワーカーで。
+    // 実行中の id をまた投げたら、前のほうの結果は ReloadResultQueue が捨てる
+    const uint64_t generation = m_results.Begin((uint64_t)id);
+    JobSystem::Get().Submit([this, id, generation, desc = it.desc, sink = it.sink]() {
+        const auto start = std::chrono::steady_clock::now();
+        Built_ built;
+        try {
+            if (ShaderCompiler::Get().Compile(desc, built.blobs, built.error, &built.dependencies) && sink)
+                built.pso = sink->BuildPipelineState(built.blobs);
+        } catch (const std::exception& e) {
+            built.error = std::wstring(e.what(), e.what() + std::strlen(e.what()));
+        }
+        built.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        m_results.Finish((uint64_t)id, generation, std::move(built));
+    });
 }
 
-// DXC in-memory compile
-static bool compileOne(const std::wstring& path, const std::wstring& entry, const std::wstring& target,
-                       const std::vector<std::wstring>& defines,
-                       ComPtr<ID3DBlob>& outBlob, std::wstring& error){
-    ComPtr<IDxcUtils> utils; ComPtr<IDxcCompiler3> comp; ComPtr<IDxcIncludeHandler> inc;
-    if (FAILED(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&utils)))) return false;
-    if (FAILED(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&comp)))) return false;
-    if (FAILED(utils->CreateDefaultIncludeHandler(&inc))) return false;
-
-    // read file
-    FILE* fp = nullptr;
-    _wfopen_s(&fp, path.c_str(), L"rb");
-    if (!fp) return false;
-    fseek(fp, 0, SEEK_END); long sz = ftell(fp); fseek(fp, 0, SEEK_SET);
-    std::vector<uint8_t> buf(sz); fread(buf.data(),1,sz,fp); fclose(fp);
-
-    DxcBuffer src{ buf.data(), (UINT32)buf.size(), DXC_CP_ACP };
-
-    std::vector<LPCWSTR> args = { L"-E", entry.c_str(), L"-T", target.c_str(), L"-Zi", L"-Qembed_debug", L"-Zpr" /*row-major*/ };
-    for (auto& d : defines){ args.push_back(L"-D"); args.push_back(d.c_str()); }
-
-    ComPtr<IDxcResult> result;
-    if (FAILED(comp->Compile(&src, args.data(), (UINT)args.size(), inc.Get(), IID_PPV_ARGS(&result)))) return false;
-
-    ComPtr<IDxcBlobUtf8> err; result->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&err), nullptr);
-    if (err && err->GetStringLength() > 0) { 
-        std::string errStr((char*)err->GetBufferPointer(), err->GetStringLength());
-        error = std::wstring(errStr.begin(), errStr.end());
+size_t ShaderReloader::Apply(DeferredReleaseQueue& retired, uint64_t retireFence, std::vector<std::wstring>* reloaded){
+    size_t applied = 0;
+    for (auto& [id, built] : m_results.Take()) {
+        auto found = m_items.find((int)id);
+        if (found == m_items.end()) continue;
+        Item& it = found->second;
+        // 失敗したときも記録し直す（壊れた #include を直したら、その保存で作り直せるように）
+        if (!built.dependencies.empty()) setDependencies_(found->first, built.dependencies);
+        const std::string name(it.desc.hlslPath.begin(), it.desc.hlslPath.end());
+        if (!built.pso) {
+            // 前の PSO のまま描画を続ける。次に保存されたらまた試す
+            spdlog::warn("Shader reload failed, keeping previous PSO: {}\n{}", name, std::string(built.error.begin(), built.error.end()));
+            continue;
+        }
+        it.cached = built.blobs;
+        PipelinePtr previous = it.sink->SwapPipelineState(std::move(built.pso));
+        if (previous) retired.Retire(retireFence, std::move(previous));
+        spdlog::info("Shader reloaded: {} ({:.1f} ms on worker)", name, built.ms);
+        if (reloaded) reloaded->push_back(it.desc.hlslPath);
+        ++applied;
     }
+    return applied;
+}
 
-    HRESULT status; result->GetStatus(&status);
-    if (FAILED(status)) return false;
-
-    ComPtr<IDxcBlob> dxil;
-    if (FAILED(result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&dxil), nullptr))) return false;
-    // DXILをID3DBlobに変換（簡易版）
-    Microsoft::WRL::ComPtr<ID3DBlob> blob;
-    if (FAILED(D3DCompile("", 0, nullptr, nullptr, nullptr, "VSMain", "vs_6_0", 0, 0, &blob, nullptr))) return false;
-    // 実際のDXILコピーは省略（簡易版）
-    outBlob = blob;
-    return true;
+void ShaderReloader::setDependencies_(int id, const std::vector<std::string>& files){
+    const DependencyGraph::Update update = m_graph.Set((uint64_t)id, files);
+    for (const std::string& path : update.removed) {
+        auto fileId = m_fileIds.find(path);
+        if (fileId == m_fileIds.end()) continue;
+        if (m_watcher) m_watcher->Unwatch(fileId->second);
+        m_files.erase(fileId->second);
+        m_fileIds.erase(fileId);
+    }
+    for (const std::string& path : update.added) {
+        const uint64_t fileId = m_nextFileId++;
+        File_ f; f.path = path;
+        const std::filesystem::path fsPath(std::u8string(path.begin(), path.end()));
+        std::error_code ec;
+        f.lastWrite = std::filesystem::last_write_time(fsPath, ec);
+        f.watched = m_watcher && m_watcher->Watch(fileId, fsPath);
+        m_fileIds.emplace(path, fileId);
+        m_files.emplace(fileId, std::move(f));
+    }
 }
 
-bool ShaderReloader::compile_(const ShaderDesc& desc, ShaderBlobs& out, std::wstring& error){
-    ComPtr<ID3DBlob> vs, ps;
-    if (!compileOne(desc.hlslPath, desc.entryVS, desc.targetVS, desc.defines, vs, error)) return false;
-    if (!compileOne(desc.hlslPath, desc.entryPS, desc.targetPS, desc.defines, ps, error)) return false;
-    out.vs = vs; out.ps = ps; return true;
+bool ShaderReloader::detectChanged_(File_& f){
+    std::error_code ec;
+    auto t = std::filesystem::last_write_time(std::filesystem::path(std::u8string(f.path.begin(), f.path.end())), ec);
+    if (ec) return false;
+    if (t != f.lastWrite){ f.lastWrite = t; return true; }
+    return false;
 }
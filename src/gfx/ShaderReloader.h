@@ -6,10 +6,16 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include "core/DeferredReleaseQueue.h"
+#include "core/DependencyGraph.h"
+#include "core/FileWatcher.h"
+#include "core/ReloadResultQueue.h"
+#include "gfx/PipelineCache.h"
 
 namespace jisaku {
 
 class DX12Device;
+struct ShaderReflection;
 
 struct ShaderDesc {
     std::wstring hlslPath;
@@ -23,38 +29,81 @@ struct ShaderDesc {
 struct ShaderBlobs {
     Microsoft::WRL::ComPtr<ID3DBlob> vs;
     Microsoft::WRL::ComPtr<ID3DBlob> ps;
+    const ShaderReflection* vsReflection = nullptr; // シェーダーパックから取ったときだけ
 };
 
 class IHotReloadable {
 public:
     virtual ~IHotReloadable() = default;
-    virtual void OnShadersReloaded(const ShaderBlobs& blobs) = 0; // PSO再作成を内部で行う
+    // ワーカースレッドで呼ばれる。blobs から新しい PSO を作って返す（失敗時は null）。描画に使っている状態は書き換えないこと
+    virtual PipelinePtr BuildPipelineState(const ShaderBlobs& blobs) = 0;
+    // メインスレッドのフレームの区切り（コマンド記録前）で呼ばれる。pso に差し替えて前の PSO を返す
+    virtual PipelinePtr SwapPipelineState(PipelinePtr pso) = 0;
 };
 
+// シェーダーの変更を監視し、コンパイルと PSO の作成を JobSystem のワーカーで行う（描画スレッドは止めない）。
+// 監視するのはシェーダーが #include で読んだファイルすべてで、変わったファイルを読んでいるシェーダーだけを作り直す
+// （依存はコンパイルのたびに DependencyGraph へ記録し直す）。
+// 変更は FileWatcher の OS 通知で受け取る（使えないときだけ intervalSec ごとに更新時刻を見る）。
+// できあがった PSO は Apply でフレームの区切りに差し替え、古い PSO は retireFence を付けて DeferredReleaseQueue へ預ける。
+// 作り直し中にまた変更されたら、古いほうの結果は捨てて新しいほうだけ差し替える
+// Tick / ForceRebuildAll / Apply はメインスレッドから呼ぶ
 class ShaderReloader {
 public:
+    ~ShaderReloader(); // 作り直し中のジョブの完了を待つ（sink より先に破棄すること）
+
     bool Init(DX12Device* dev);
     // 監視対象を登録。戻り値は id。
     int Register(const ShaderDesc& desc, IHotReloadable* sink);
-    // 毎フレーム呼び出し。intervalSec 経過時に監視チェック→変更があれば再コンパイル＆sinkへ通知。
+    // 毎フレーム呼び出し。変更の通知があれば（ポーリング時は intervalSec ごとに調べて）ワーカーで作り直しを始める
     void Tick(double dt, double intervalSec = 0.5);
     // 明示的に再ビルド（ImGuiボタンから呼ぶ）
     void ForceRebuildAll();
 
+    // 差し替えられるものがあるか
+    bool HasReady() const { return m_results.HasReady(); }
+    // できあがった PSO に差し替え、古い PSO を retired へ預ける。retireFence はこのフレームの提出の後に Signal される値。
+    // 戻り値は差し替えた数。reloaded には差し替えたシェーダーの hlslPath を足す（パーミュテーションの作り直し用）
+    size_t Apply(DeferredReleaseQueue& retired, uint64_t retireFence, std::vector<std::wstring>* reloaded = nullptr);
+
+    uint32_t GetBuildingCount() const { return m_results.GetInFlight(); }
+    // id のシェーダーが読んだファイル（Vfs の仮想パス）
+    const std::vector<std::string>* GetDependencies(int id) const { return m_graph.GetDependencies((uint64_t)id); }
+    size_t GetWatchedFileCount() const { return m_files.size(); }
+
 private:
     struct Item {
         ShaderDesc desc;
         IHotReloadable* sink = nullptr;
-        std::filesystem::file_time_type lastWrite{};
         ShaderBlobs cached;
     };
+    struct File_ {
+        std::string path; // Vfs の仮想パス（DependencyGraph のキー）
+        std::filesystem::file_time_type lastWrite{};
+        bool watched = false; // FileWatcher で見ている
+    };
+    struct Built_ {
+        ShaderBlobs blobs;
+        PipelinePtr pso; // 失敗時は null
+        std::wstring error;
+        std::vector<std::string> dependencies; // 失敗しても読めたところまで
+        double ms = 0.0;
+    };
     jisaku::DX12Device* m_dev = nullptr;
     std::unordered_map<int, Item> m_items;
     int m_nextId = 1;
     double m_accum = 0.0;
+    DependencyGraph m_graph; // シェーダー id → 読んだファイル
+    std::unordered_map<std::string, uint64_t> m_fileIds;
+    std::unordered_map<uint64_t, File_> m_files; // キーは FileWatcher の id
+    uint64_t m_nextFileId = 1;
+    std::unique_ptr<FileWatcher> m_watcher; // 使えなければ null
+    std::vector<uint64_t> m_events;
+    ReloadResultQueue<Built_> m_results; // ジョブが結果を書き込む
 
-    bool compile_(const ShaderDesc& desc, ShaderBlobs& out, std::wstring& error);
-    bool detectChanged_(Item& it);
+    void submit_(int id, const Item& it);
+    void setDependencies_(int id, const std::vector<std::string>& files);
+    bool detectChanged_(File_& f);
 };
 
 } // namespace jisaku
@@ -0,0 +1,250 @@
+#include "TextureAtlas.h"
+#include "gfx/MipGenerator.h"
+#include "core/StreamingCopy.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+
+namespace jisaku
+{
+    TextureAtlas::TextureAtlas(TextureLoader& loader, const AtlasOptions& opt)
+        : m_loader(loader)
+        , m_opt(opt)
+    {
+        m_opt.mipLevels = (std::max)(m_opt.mipLevels, 1u);
+        const uint32_t align = Align_();
+        m_opt.pageSize = (std::max)((m_opt.pageSize + align - 1) / align * align, align);
+    }
+
+    uint32_t TextureAtlas::Add(const ConstImageView& image)
+    {
+        if (!image.data || image.width == 0 || image.height == 0) return kInvalidId;
+
+        // パディング込みの大きさをミップ整列単位に切り上げ、パッカーにはセル単位で渡す
+        const uint32_t align = Align_();
+        const uint32_t cw = (image.width + 2 * m_opt.padding + align - 1) / align;
+        const uint32_t ch = (image.height + 2 * m_opt.padding + align - 1) / align;
+        const uint32_t pageCells = m_opt.pageSize / align;
+        if (cw > pageCells || ch > pageCells) {
+            spdlog::warn("Atlas: {}x{} image does not fit in a {} page", image.width, image.height, m_opt.pageSize);
+            return kInvalidId;
+        }
+
+        uint32_t pageIndex = UINT32_MAX;
+        AtlasRect cells;
+        for (uint32_t i = 0; i < (uint32_t)m_pages.size() && pageIndex == UINT32_MAX; ++i) {
+            if (m_pages[i]->packer.Insert(cw, ch, cells)) pageIndex = i;
+        }
+        if (pageIndex == UINT32_MAX) {
+            if (m_pages.size() >= m_opt.maxPages) {
+                spdlog::warn("Atlas: page limit ({}) reached", m_opt.maxPages);
+                return kInvalidId;
+            }
+            auto page = std::make_unique<Page>();
+            page->packer.Reset(pageCells, pageCells);
+            page->levels.resize(m_opt.mipLevels);
+            for (uint32_t l = 0; l < m_opt.mipLevels; ++l)
+                page->levels[l].Allocate(MipExtent(m_opt.pageSize, l), MipExtent(m_opt.pageSize, l));
+            page->packer.Insert(cw, ch, cells);
+            pageIndex = (uint32_t)m_pages.size();
+            m_pages.push_back(std::move(page));
+        }
+
+        Page& page = *m_pages[pageIndex];
+        const AtlasRect px{ cells.x * align, cells.y * align, cells.width * align, cells.height * align };
+        if (!Blit_(page, px, image)) {
+            page.packer.Remove(cells);
+            return kInvalidId;
+        }
+        page.dirty = true;
+
+        uint32_t id;
+        if (!m_freeIds.empty()) {
+            id = m_freeIds.back();
+            m_freeIds.pop_back();
+        } else {
+            id = (uint32_t)m_entries.size();
+            m_entries.emplace_back();
+        }
+        Entry& e = m_entries[id];
+        const float inv = 1.0f / float(m_opt.pageSize);
+        e.region.page = pageIndex;
+        e.region.u0 = float(px.x + m_opt.padding) * inv;
+        e.region.v0 = float(px.y + m_opt.padding) * inv;
+        e.region.u1 = float(px.x + m_opt.padding + image.width) * inv;
+        e.region.v1 = float(px.y + m_opt.padding + image.height) * inv;
+        e.cells = cells;
+        e.alive = true;
+        return id;
+    }
+
+    bool TextureAtlas::Remove(uint32_t id)
+    {
+        if (id >= m_entries.size() || !m_entries[id].alive) return false;
+        Entry& e = m_entries[id];
+        // ページ内容はそのまま（次に割り当てられた画像で上書きされる）
+        m_pages[e.region.page]->packer.Remove(e.cells);
+        e = Entry{};
+        m_freeIds.push_back(id);
+        return true;
+    }
+
+    const AtlasRegion* TextureAtlas::GetRegion(uint32_t id) const
+    {
+        return id < m_entries.size() && m_entries[id].alive ? &m_entries[id].region : nullptr;
+    }
+
+    bool TextureAtlas::Blit_(Page& page, const AtlasRect& px, const ConstImageView& image)
+    {
+        // 端の画素を複製してセル全体を埋める（整列で余った部分もパディング扱い）
+        Image padded;
+        padded.Allocate(px.width, px.height);
+        const int pad = (int)m_opt.padding;
+        for (uint32_t y = 0; y < px.height; ++y) {
+            const uint32_t sy = (uint32_t)std::clamp((int)y - pad, 0, (int)image.height - 1);
+            const uint8_t* src = image.Row(sy);
+            uint8_t* dst = padded.View().Row(y);
+            for (uint32_t x = 0; x < px.width; ++x) {
+                const uint32_t sx = (uint32_t)std::clamp((int)x - pad, 0, (int)image.width - 1);
+                std::memcpy(dst + size_t(x) * 4, src + size_t(sx) * 4, 4);
+            }
+        }
+
+        // 画像単体でミップを作るので、縮小フィルタが隣の画像を拾うことは無い
+        MipOptions mo;
+        mo.filter = MipFilter::Box;
+        mo.srgb = m_opt.srgb;
+        mo.maxLevels = m_opt.mipLevels;
+        mo.parallel = false;
+        std::vector<Image> levels;
+        if (!GenerateMipChain(padded.View(), mo, levels) || levels.size() < m_opt.mipLevels) return false;
+
+        for (uint32_t l = 0; l < m_opt.mipLevels; ++l) {
+            const ImageView dst = page.levels[l].View();
+            const ConstImageView src = levels[l].View();
+            const uint32_t ox = px.x >> l, oy = px.y >> l;
+            for (uint32_t y = 0; y < src.height; ++y)
+                std::memcpy(dst.Row(oy + y) + size_t(ox) * 4, src.Row(y), size_t(src.width) * 4);
+        }
+        return true;
+    }
+
+    bool TextureAtlas::Flush(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd)
+    {
+        bool ok = true;
+        for (auto& page : m_pages) {
+            if (page->dirty) ok &= UploadPage_(dev, cmd, *page);
+        }
+        return ok;
+    }
+
+    bool TextureAtlas::UploadPage_(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd, Page& page)
+    {
+        using Microsoft::WRL::ComPtr;
+        const DXGI_FORMAT format = m_opt.srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+
+        const bool existed = page.texture.resource != nullptr;
+        if (!existed) {
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            desc.Width = m_opt.pageSize;
+            desc.Height = m_opt.pageSize;
+            desc.DepthOrArraySize = 1;
+            desc.MipLevels = (UINT16)m_opt.mipLevels;
+            desc.Format = format;
+            desc.SampleDesc.Count = 1;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+            D3D12_HEAP_PROPERTIES heapProps = {};
+            heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+            ComPtr<ID3D12Resource> tex;
+            if (FAILED(dev->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+                                                   D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                   IID_PPV_ARGS(&tex)))) {
+                spdlog::error("Atlas: failed to create page texture");
+                return false;
+            }
+
+            D3D12_SHADER_RESOURCE_VIEW_DESC srv{};
+            srv.Format = format;
+            srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+            srv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+            srv.Texture2D.MipLevels = m_opt.mipLevels;
+            if (!m_loader.RegisterTexture(dev, tex, srv, page.texture)) return false;
+        }
+
+        const D3D12_RESOURCE_DESC desc = page.texture.resource->GetDesc();
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(m_opt.mipLevels);
+        UINT64 totalBytes = 0;
+        dev->GetCopyableFootprints(&desc, 0, m_opt.mipLevels, 0, layouts.data(), nullptr, nullptr, &totalBytes);
+
+        D3D12_RESOURCE_DESC uploadDesc = {};
+        uploadDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        uploadDesc.Width = totalBytes;
+        uploadDesc.Height = 1;
+        uploadDesc.DepthOrArraySize = 1;
+        uploadDesc.MipLevels = 1;
+        uploadDesc.Format = DXGI_FORMAT_UNKNOWN;
+        uploadDesc.SampleDesc.Count = 1;
+        uploadDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+        D3D12_HEAP_PROPERTIES uploadHeapProps = {};
+        uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+        ComPtr<ID3D12Resource> upload;
+        if (FAILED(dev->CreateCommittedResource(&uploadHeapProps, D3D12_HEAP_FLAG_NONE, &uploadDesc,
+                                               D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+                                               IID_PPV_ARGS(&upload)))) {
+            spdlog::error("Atlas: failed to create upload resource");
+            return false;
+        }
+        uint8_t* mapped = nullptr;
+        if (FAILED(upload->Map(0, nullptr, reinterpret_cast<void**>(&mapped)))) {
+            spdlog::error("Atlas: failed to map upload resource");
+            return false;
+        }
+        for (uint32_t l = 0; l < m_opt.mipLevels; ++l) {
+            const ConstImageView src = page.levels[l].View();
+            uint8_t* dst = mapped + layouts[l].Offset;
+            for (uint32_t y = 0; y < src.height; ++y)
+                StreamCopy(dst + size_t(y) * layouts[l].Footprint.RowPitch, src.Row(y), size_t(src.width) * 4);
+        }
+        StreamFence();
+        upload->Unmap(0, nullptr);
+
+        D3D12_RESOURCE_BARRIER barrier = {};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = page.texture.resource.Get();
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        if (existed) {
+            // 2 回目以降: PIXEL_SHADER_RESOURCE -> COPY_DEST
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+            cmd->ResourceBarrier(1, &barrier);
+        }
+
+        for (uint32_t l = 0; l < m_opt.mipLevels; ++l) {
+            D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+            srcLoc.pResource = upload.Get();
+            srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            srcLoc.PlacedFootprint = layouts[l];
+
+            D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+            dstLoc.pResource = page.texture.resource.Get();
+            dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            dstLoc.SubresourceIndex = l;
+
+            cmd->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+        }
+
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        cmd->ResourceBarrier(1, &barrier);
+
+        m_pendingUploads.push_back(upload);
+        page.dirty = false;
+        return true;
+    }
+}
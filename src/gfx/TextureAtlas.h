@@ -0,0 +1,85 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "gfx/AtlasPacker.h"
+#include "gfx/ImageData.h"
+#include "gfx/TextureLoader.h"
+
+namespace jisaku
+{
+    struct AtlasOptions
+    {
+        uint32_t pageSize = 1024; // ページの一辺（2^(mipLevels-1) の倍数）
+        uint32_t padding = 4;     // 画像の周囲に端の画素を複製して広げる幅
+        uint32_t mipLevels = 3;   // ページのミップ数。配置は 2^(mipLevels-1) 単位に揃える
+        uint32_t maxPages = 8;
+        bool srgb = true;
+    };
+
+    // スプライト描画に渡す領域。UV はパディングを除いた画像本体の範囲
+    struct AtlasRegion
+    {
+        uint32_t page = UINT32_MAX;
+        float u0 = 0.0f, v0 = 0.0f;
+        float u1 = 0.0f, v1 = 0.0f;
+    };
+
+    // 小さな画像を共有ページ（1 ページ = 1 テクスチャ + 1 SRV スロット）に詰めるアトラス。
+    // 各画像のミップは画像ごとに生成してからページへ配置するので、縮小しても隣の画像がにじまない。
+    // Add/Remove は CPU 側のみ更新し、Flush で変更のあったページを GPU に反映する。
+    class TextureAtlas
+    {
+    public:
+        static constexpr uint32_t kInvalidId = UINT32_MAX;
+
+        explicit TextureAtlas(TextureLoader& loader, const AtlasOptions& opt = {});
+
+        // RGBA8 画像を追加して ID を返す。ページに入らない大きさ・ページ上限到達時は kInvalidId
+        uint32_t Add(const ConstImageView& image);
+        bool Remove(uint32_t id);
+        const AtlasRegion* GetRegion(uint32_t id) const;
+
+        // 変更のあったページをアップロード（初回はテクスチャと SRV を作成）
+        bool Flush(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd);
+        // アップロードバッファを retired へ預ける。retireFence は Flush の cmd を含む提出の後に Signal される値
+        void FlushUploads(DeferredReleaseQueue& retired, uint64_t retireFence)
+        {
+            if (!m_pendingUploads.empty()) retired.Retire(retireFence, std::move(m_pendingUploads));
+            m_pendingUploads.clear();
+        }
+
+        uint32_t GetPageCount() const { return (uint32_t)m_pages.size(); }
+        const TextureHandle& GetPageTexture(uint32_t page) const { return m_pages[page]->texture; }
+        float GetOccupancy(uint32_t page) const { return m_pages[page]->packer.GetOccupancy(); }
+
+    private:
+        struct Page
+        {
+            AtlasPacker packer;         // 2^(mipLevels-1) ピクセルを 1 単位とする
+            std::vector<Image> levels;  // CPU 側のページ内容（ミップごと）
+            TextureHandle texture;
+            bool dirty = false;
+        };
+        struct Entry
+        {
+            AtlasRegion region;
+            AtlasRect cells; // パッカー上の矩形（セル単位）
+            bool alive = false;
+        };
+
+        uint32_t Align_() const { return 1u << (m_opt.mipLevels - 1); }
+        bool Blit_(Page& page, const AtlasRect& px, const ConstImageView& image);
+        bool UploadPage_(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd, Page& page);
+
+        TextureLoader& m_loader;
+        AtlasOptions m_opt;
+        std::vector<std::unique_ptr<Page>> m_pages;
+        std::vector<Entry> m_entries;
+        std::vector<uint32_t> m_freeIds;
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_pendingUploads;
+    };
+}
@@ -0,0 +1,196 @@
+#include "TextureCache.h"
+#include "gfx/ImageDecoder.h"
+#include "core/JobSystem.h"
+#include "core/Vfs.h"
+#include <spdlog/spdlog.h>
+#include <xxhash.h>
+#include <cwctype>
+#include <filesystem>
+#include <functional>
+#include <unordered_map>
+
+namespace jisaku
+{
+    static std::wstring CanonicalPath(const std::wstring& path)
+    {
+        std::error_code ec;
+        std::filesystem::path p = std::filesystem::weakly_canonical(std::filesystem::path(path), ec);
+        std::wstring s = ec ? std::filesystem::path(path).lexically_normal().wstring() : p.wstring();
+#ifdef _WIN32
+        // NTFS は大文字小文字を区別しない
+        for (wchar_t& c : s) c = (wchar_t)std::towlower(c);
+#endif
+        return s;
+    }
+
+    TextureCache::TextureCache(TextureLoader& loader)
+        : m_loader(loader)
+        , m_cache([this](TextureHandle&& h) {
+            // キャッシュが持っていたリソースをハンドルへ戻す
+            {
+                std::lock_guard<std::mutex> lock(m_resourceMutex);
+                auto it = m_resources.find(h.slot);
+                if (it != m_resources.end()) {
+                    h.resource = std::move(it->second);
+                    m_resources.erase(it);
+                }
+            }
+            // GPU がまだ参照しているかもしれないので、ここでは解放せず退避だけする
+            std::lock_guard<std::mutex> lock(m_retiredMutex);
+            m_retired.push_back(std::move(h));
+        })
+    {
+    }
+
+    TextureCache::~TextureCache()
+    {
+        // 破棄時点で GPU は停止している前提（App は WaitIdle 後に破棄する）
+        std::lock_guard<std::mutex> lock(m_retiredMutex);
+        for (TextureHandle& h : m_retired) m_loader.ReleaseTexture(h);
+    }
+
+    bool TextureCache::MakeKey_(const std::wstring& path, bool forceSRGB, bool generateMips,
+                                std::vector<uint8_t>& bytes, TextureKey& key) const
+    {
+        // キーに内容ハッシュを含めるため、ファイルはここで読む（読んだバイト列はそのままローダへ渡す）
+        if (!Vfs::Get().ReadFile(path, bytes)) {
+            spdlog::error("Failed to read file: {}", std::string(path.begin(), path.end()));
+            return false;
+        }
+        key.path = CanonicalPath(path);
+        key.contentHash = XXH3_64bits(bytes.data(), bytes.size());
+        key.forceSRGB = forceSRGB;
+        key.generateMips = generateMips;
+        key.compression = m_loader.GetCompression().format;
+        key.quality = m_loader.GetCompression().quality;
+        key.mipFilter = m_loader.GetMipFilter();
+        key.hdrBC6H = m_loader.GetHdrCompression();
+        return true;
+    }
+
+    TexturePtr TextureCache::LoadKeyed_(ID3D12Device* dev,
+                                        ID3D12GraphicsCommandList* cmd,
+                                        const TextureKey& key,
+                                        const std::wstring& path,
+                                        std::vector<uint8_t>& bytes)
+    {
+        if (TexturePtr hit = m_cache.Find(key)) {
+            spdlog::info("Texture cache hit: {} (slot {})", std::string(path.begin(), path.end()), hit->slot);
+            return hit;
+        }
+        return m_cache.GetOrLoad(key, [&](TextureHandle& out) {
+            if (!m_loader.LoadFromMemory(dev, cmd, std::move(bytes), path, out, key.forceSRGB, key.generateMips)) return false;
+            // 共有ハンドルは公開後に書き換えないので、差し替わるリソースはキャッシュ側で持つ
+            std::lock_guard<std::mutex> lock(m_resourceMutex);
+            m_resources[out.slot] = std::move(out.resource);
+            return true;
+        });
+    }
+
+    TexturePtr TextureCache::Load(ID3D12Device* dev,
+                                  ID3D12GraphicsCommandList* cmd,
+                                  const std::wstring& path,
+                                  bool forceSRGB,
+                                  bool generateMips)
+    {
+        std::vector<uint8_t> bytes;
+        TextureKey key;
+        if (!MakeKey_(path, forceSRGB, generateMips, bytes, key)) return nullptr;
+        return LoadKeyed_(dev, cmd, key, path, bytes);
+    }
+
+    size_t TextureCache::LoadBatch(ID3D12Device* dev,
+                                   ID3D12GraphicsCommandList* cmd,
+                                   const std::vector<std::wstring>& paths,
+                                   std::vector<TexturePtr>& out,
+                                   bool forceSRGB,
+                                   bool generateMips)
+    {
+        const uint32_t count = (uint32_t)paths.size();
+        std::vector<TextureKey> keys(count);
+        std::vector<std::vector<uint8_t>> bytes(count);
+        std::vector<uint8_t> valid(count, 0);
+        out.assign(count, nullptr);
+
+        // 1) 読み込み + ハッシュ（並列）
+        JobSystem::Get().ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) valid[i] = MakeKey_(paths[i], forceSRGB, generateMips, bytes[i], keys[i]) ? 1 : 0;
+        });
+
+        // 2) バッチ内の重複キーは先頭の 1 つだけ読み込む。
+        //    同じスレッドが自分の読み込み完了を待つ形（ParallelFor の待機中に同じキーのジョブを拾う）にならないようにするため
+        std::unordered_map<TextureKey, uint32_t, TextureKeyHash> first;
+        std::vector<uint32_t> unique;
+        std::vector<uint32_t> source(count, UINT32_MAX);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (!valid[i]) continue;
+            auto [it, inserted] = first.emplace(keys[i], i);
+            if (inserted) unique.push_back(i);
+            source[i] = it->second;
+        }
+
+        // 3) デコード・アップロード（並列。ローダ内部でコマンド記録は直列化される）
+        JobSystem::Get().ParallelFor((uint32_t)unique.size(), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t u = begin; u < end; ++u) {
+                const uint32_t i = unique[u];
+                try {
+                    out[i] = LoadKeyed_(dev, cmd, keys[i], paths[i], bytes[i]);
+                }
+                catch (const std::exception& e) {
+                    spdlog::error("Exception while loading {}: {}", std::string(paths[i].begin(), paths[i].end()), e.what());
+                }
+            }
+        });
+
+        size_t loaded = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (source[i] != UINT32_MAX) out[i] = out[source[i]];
+            loaded += out[i] ? 1 : 0;
+        }
+        return loaded;
+    }
+
+    size_t TextureCache::CollectGarbage(DeferredReleaseQueue& retired, uint64_t retireFence)
+    {
+        std::vector<TextureHandle> handles;
+        {
+            std::lock_guard<std::mutex> lock(m_retiredMutex);
+            handles.swap(m_retired);
+        }
+        // スロットは GPU が過ぎてから返す（それまでは同じスロットに別のテクスチャを作らない）
+        TextureLoader* loader = &m_loader;
+        for (TextureHandle& h : handles) {
+            retired.Defer(retireFence, [loader, h]() mutable { loader->ReleaseTexture(h); });
+        }
+        if (!handles.empty()) spdlog::info("TextureCache: retired {} textures", handles.size());
+        return handles.size();
+    }
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> TextureCache::GetResource(const TexturePtr& texture) const
+    {
+        if (!texture) return nullptr;
+        std::lock_guard<std::mutex> lock(m_resourceMutex);
+        auto it = m_resources.find(texture->slot);
+        return it != m_resources.end() ? it->second : nullptr;
+    }
+
+    bool TextureCache::CommitReload(ID3D12Device* dev,
+                                    ID3D12GraphicsCommandList* cmd,
+                                    TextureLoader::PendingReload& pending,
+                                    const TexturePtr& texture,
+                                    DeferredReleaseQueue& retired,
+                                    uint64_t retireFence)
+    {
+        if (!texture) return false;
+        std::lock_guard<std::mutex> lock(m_resourceMutex);
+        auto it = m_resources.find(texture->slot);
+        if (it == m_resources.end()) return false;
+
+        // 共有ハンドルの写しに対して差し替える。スロット番号は同じで、SRV はスロットのもう片側へ移る
+        TextureHandle handle = *texture;
+        handle.resource = it->second;
+        if (!m_loader.CommitReload(dev, cmd, pending, handle, retired, retireFence)) return false;
+        it->second = std::move(handle.resource);
+        return true;
+    }
+}
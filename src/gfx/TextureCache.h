@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "core/SharedCache.h"
+#include "gfx/TextureKey.h"
+#include "gfx/TextureLoader.h"
+
+namespace jisaku
+{
+    // 共有ハンドル。slot は寿命の間変わらない。
+    // resource は null（読み直しで差し替わるのでキャッシュが持つ。GetResource で引く）。
+    // SRV も読み直しでスロットのもう片側へ移るので、srvCPU/srvGPU ではなく TextureLoader::GetSrvGpu(slot) で引く
+    using TexturePtr = std::shared_ptr<const TextureHandle>;
+
+    // TextureLoader の前段に置くテクスチャキャッシュ。
+    // 同じファイル（内容・設定とも同じ）は同じハンドルを共有し、最後の参照が外れたら
+    // リソースと SRV スロットを解放待ちリストへ回す（CollectGarbage で DeferredReleaseQueue へ預ける）。
+    // リソースはキャッシュが持つので、ハンドルはキャッシュより先に手放すこと
+    class TextureCache
+    {
+    public:
+        explicit TextureCache(TextureLoader& loader);
+        ~TextureCache();
+
+        TextureCache(const TextureCache&) = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+
+        // 任意スレッドから呼べる。同じキーを同時に要求した場合は 1 回だけ読み込み、結果を共有する。
+        // 失敗時は nullptr
+        TexturePtr Load(ID3D12Device* dev,
+                        ID3D12GraphicsCommandList* cmd,
+                        const std::wstring& path,
+                        bool forceSRGB = true,
+                        bool generateMips = true);
+
+        // 複数ファイルを JobSystem で並列に読み込む。out は paths と同じ並び（失敗は nullptr）。戻り値は成功数。
+        // 別スレッドから同時に LoadBatch する場合、同じキーを含むと待機中のジョブ横取りで詰まる恐れがあるので避けること
+        size_t LoadBatch(ID3D12Device* dev,
+                         ID3D12GraphicsCommandList* cmd,
+                         const std::vector<std::wstring>& paths,
+                         std::vector<TexturePtr>& out,
+                         bool forceSRGB = true,
+                         bool generateMips = true);
+
+        // 参照が無くなったテクスチャを retired へ預ける（retireFence を GPU が過ぎたらリソースと SRV スロットを返す）。
+        // 戻り値は預けた数
+        size_t CollectGarbage(DeferredReleaseQueue& retired, uint64_t retireFence);
+
+        // texture の今のリソース（読み直しで差し替わる）。任意スレッドから呼べる
+        Microsoft::WRL::ComPtr<ID3D12Resource> GetResource(const TexturePtr& texture) const;
+        // PrepareReload の結果で texture のリソースを差し替え、SRV をスロットのもう片側へ作る（TextureReloader 用）。
+        // 共有ハンドル自体は書き換えない。古いリソースと SRV は retired へ預ける
+        bool CommitReload(ID3D12Device* dev,
+                          ID3D12GraphicsCommandList* cmd,
+                          TextureLoader::PendingReload& pending,
+                          const TexturePtr& texture,
+                          DeferredReleaseQueue& retired,
+                          uint64_t retireFence);
+
+        size_t GetLiveCount() const { return m_cache.Size(); }
+
+    private:
+        bool MakeKey_(const std::wstring& path, bool forceSRGB, bool generateMips,
+                      std::vector<uint8_t>& bytes, TextureKey& key) const;
+        TexturePtr LoadKeyed_(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd, const TextureKey& key,
+                              const std::wstring& path, std::vector<uint8_t>& bytes);
+
+        TextureLoader& m_loader;
+        std::mutex m_retiredMutex;
+        std::vector<TextureHandle> m_retired;
+        mutable std::mutex m_resourceMutex;
+        std::unordered_map<uint32_t, Microsoft::WRL::ComPtr<ID3D12Resource>> m_resources; // スロット → 今のリソース
+        SharedCache<TextureKey, TextureHandle, TextureKeyHash> m_cache;
+    };
+}
@@ -0,0 +1,400 @@
+#include "gfx/TextureContainer.h"
+#include "core/ByteOrder.h"
+#ifndef JISAKU_NO_KTX
+#include <ktx.h>
+#endif
+#include <cstring>
+#include <memory>
+
+using namespace jisaku;
+
+namespace {
+
+// 使う DXGI_FORMAT の値（dxgiformat.h と同じ）
+namespace Dxgi {
+enum : uint32_t {
+    R32G32B32A32_FLOAT = 2,
+    R16G16B16A16_FLOAT = 10,
+    R16G16B16A16_UNORM = 11,
+    R32G32_FLOAT = 16,
+    R10G10B10A2_UNORM = 24,
+    R11G11B10_FLOAT = 26,
+    R8G8B8A8_TYPELESS = 27,
+    R8G8B8A8_UNORM = 28,
+    R8G8B8A8_UNORM_SRGB = 29,
+    R16G16_FLOAT = 34,
+    R32_FLOAT = 41,
+    R8G8_UNORM = 49,
+    R16_FLOAT = 54,
+    R8_UNORM = 61,
+    BC1_UNORM = 71,
+    BC1_UNORM_SRGB = 72,
+    BC2_UNORM = 74,
+    BC2_UNORM_SRGB = 75,
+    BC3_UNORM = 77,
+    BC3_UNORM_SRGB = 78,
+    BC4_UNORM = 80,
+    BC4_SNORM = 81,
+    BC5_UNORM = 83,
+    BC5_SNORM = 84,
+    B8G8R8A8_UNORM = 87,
+    B8G8R8X8_UNORM = 88,
+    B8G8R8A8_TYPELESS = 90,
+    B8G8R8A8_UNORM_SRGB = 91,
+    BC6H_UF16 = 95,
+    BC6H_SF16 = 96,
+    BC7_UNORM = 98,
+    BC7_UNORM_SRGB = 99,
+};
+} // namespace Dxgi
+
+constexpr uint32_t FourCC(char a, char b, char c, char d) { return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24); }
+uint32_t Extent(uint32_t size, uint32_t level) { return (size >> level) > 0 ? (size >> level) : 1; }
+
+// BC は 4x4 ブロックあたり、それ以外は 1 画素あたりのバイト数。未対応の形式は 0
+uint32_t FormatBytes(uint32_t f, bool& block) {
+    block = false;
+    switch (f) {
+    case Dxgi::R32G32B32A32_FLOAT: return 16;
+    case Dxgi::R16G16B16A16_FLOAT:
+    case Dxgi::R16G16B16A16_UNORM:
+    case Dxgi::R32G32_FLOAT: return 8;
+    case Dxgi::R10G10B10A2_UNORM:
+    case Dxgi::R11G11B10_FLOAT:
+    case Dxgi::R8G8B8A8_TYPELESS:
+    case Dxgi::R8G8B8A8_UNORM:
+    case Dxgi::R8G8B8A8_UNORM_SRGB:
+    case Dxgi::R16G16_FLOAT:
+    case Dxgi::R32_FLOAT:
+    case Dxgi::B8G8R8A8_UNORM:
+    case Dxgi::B8G8R8X8_UNORM:
+    case Dxgi::B8G8R8A8_TYPELESS:
+    case Dxgi::B8G8R8A8_UNORM_SRGB: return 4;
+    case Dxgi::R8G8_UNORM:
+    case Dxgi::R16_FLOAT: return 2;
+    case Dxgi::R8_UNORM: return 1;
+    case Dxgi::BC1_UNORM:
+    case Dxgi::BC1_UNORM_SRGB:
+    case Dxgi::BC4_UNORM:
+    case Dxgi::BC4_SNORM: block = true; return 8;
+    case Dxgi::BC2_UNORM:
+    case Dxgi::BC2_UNORM_SRGB:
+    case Dxgi::BC3_UNORM:
+    case Dxgi::BC3_UNORM_SRGB:
+    case Dxgi::BC5_UNORM:
+    case Dxgi::BC5_SNORM:
+    case Dxgi::BC6H_UF16:
+    case Dxgi::BC6H_SF16:
+    case Dxgi::BC7_UNORM:
+    case Dxgi::BC7_UNORM_SRGB: block = true; return 16;
+    default: return 0;
+    }
+}
+
+bool SurfacePitch(uint32_t format, uint32_t w, uint32_t h, size_t& rowPitch, uint32_t& rows) {
+    bool block = false;
+    const uint32_t bytes = FormatBytes(format, block);
+    if (bytes == 0) return false;
+    rowPitch = block ? size_t((w + 3) / 4) * bytes : size_t(w) * bytes;
+    rows = block ? (h + 3) / 4 : h;
+    return true;
+}
+
+// 配列要素ごとに全ミップが連続して並ぶ（DDS と同じ）データからサブリソースを切り出す
+bool SliceSequential(const uint8_t* base, size_t size, const ContainerInfo& info, std::vector<ContainerSubresource>& out) {
+    out.clear();
+    size_t offset = 0;
+    for (uint32_t slice = 0; slice < info.arraySize; ++slice) {
+        for (uint32_t mip = 0; mip < info.mipLevels; ++mip) {
+            ContainerSubresource sr;
+            if (!SurfacePitch(info.dxgiFormat, Extent(info.width, mip), Extent(info.height, mip), sr.rowPitch, sr.rowCount))
+                return false;
+            sr.depth = info.volume ? Extent(info.depth, mip) : 1;
+            sr.slicePitch = sr.rowPitch * sr.rowCount;
+            const size_t bytes = sr.slicePitch * sr.depth;
+            if (bytes > size - offset) return false;
+            sr.data = base + offset;
+            offset += bytes;
+            out.push_back(sr);
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// DDS
+// ---------------------------------------------------------------------------
+constexpr size_t kDdsHeaderSize = 4 + 124;
+constexpr size_t kDdsDx10Size = 20;
+
+// 旧形式のピクセルフォーマット（DX10 拡張ヘッダ無し）を DXGI に対応付ける
+uint32_t LegacyDdsFormat(const uint8_t* pf) {
+    const uint32_t flags = ReadU32(pf + 4);
+    const uint32_t fourCC = ReadU32(pf + 8);
+    if (flags & 0x4) { // DDPF_FOURCC
+        switch (fourCC) {
+        case FourCC('D', 'X', 'T', '1'): return Dxgi::BC1_UNORM;
+        case FourCC('D', 'X', 'T', '2'):
+        case FourCC('D', 'X', 'T', '3'): return Dxgi::BC2_UNORM;
+        case FourCC('D', 'X', 'T', '4'):
+        case FourCC('D', 'X', 'T', '5'): return Dxgi::BC3_UNORM;
+        case FourCC('A', 'T', 'I', '1'):
+        case FourCC('B', 'C', '4', 'U'): return Dxgi::BC4_UNORM;
+        case FourCC('B', 'C', '4', 'S'): return Dxgi::BC4_SNORM;
+        case FourCC('A', 'T', 'I', '2'):
+        case FourCC('B', 'C', '5', 'U'): return Dxgi::BC5_UNORM;
+        case FourCC('B', 'C', '5', 'S'): return Dxgi::BC5_SNORM;
+        case 36: return Dxgi::R16G16B16A16_UNORM;  // D3DFMT_A16B16G16R16
+        case 113: return Dxgi::R16G16B16A16_FLOAT; // D3DFMT_A16B16G16R16F
+        case 116: return Dxgi::R32G32B32A32_FLOAT; // D3DFMT_A32B32G32R32F
+        default: return 0;
+        }
+    }
+    if ((flags & 0x40) && ReadU32(pf + 12) == 32) { // DDPF_RGB, 32bit
+        const uint32_t r = ReadU32(pf + 16), g = ReadU32(pf + 20), b = ReadU32(pf + 24), a = ReadU32(pf + 28);
+        if (r == 0x000000FF && g == 0x0000FF00 && b == 0x00FF0000) return Dxgi::R8G8B8A8_UNORM;
+        if (r == 0x00FF0000 && g == 0x0000FF00 && b == 0x000000FF) return a ? Dxgi::B8G8R8A8_UNORM : Dxgi::B8G8R8X8_UNORM;
+    }
+    return 0; // 24bit RGB やパレット等は未対応（読み込み側で DirectXTex に回す）
+}
+
+bool ParseDds(const uint8_t* data, size_t size, ContainerInfo& info, size_t& dataOffset) {
+    if (size < kDdsHeaderSize || ReadU32(data) != FourCC('D', 'D', 'S', ' ') || ReadU32(data + 4) != 124) return false;
+    const uint32_t flags = ReadU32(data + 8);
+    info = ContainerInfo{};
+    info.container = ContainerFormat::DDS;
+    info.height = ReadU32(data + 12);
+    info.width = ReadU32(data + 16);
+    const uint32_t depth = ReadU32(data + 24);
+    const uint32_t mipCount = ReadU32(data + 28);
+    const uint8_t* pf = data + 76;
+    const uint32_t caps2 = ReadU32(data + 112);
+    info.mipLevels = (flags & 0x20000) && mipCount > 0 ? mipCount : 1; // DDSD_MIPMAPCOUNT
+
+    if ((ReadU32(pf + 4) & 0x4) && ReadU32(pf + 8) == FourCC('D', 'X', '1', '0')) {
+        if (size < kDdsHeaderSize + kDdsDx10Size) return false;
+        const uint8_t* ext = data + kDdsHeaderSize;
+        info.dxgiFormat = ReadU32(ext);
+        const uint32_t dimension = ReadU32(ext + 4);
+        info.cubemap = (ReadU32(ext + 8) & 0x4) != 0; // RESOURCE_MISC_TEXTURECUBE
+        info.arraySize = ReadU32(ext + 12) * (info.cubemap ? 6 : 1);
+        info.volume = dimension == 4;                 // TEXTURE3D
+        if (dimension != 3 && dimension != 4) return false; // 1D は非対応
+        dataOffset = kDdsHeaderSize + kDdsDx10Size;
+    } else {
+        info.dxgiFormat = LegacyDdsFormat(pf);
+        info.colorSpaceKnown = false;
+        if (caps2 & 0x200) { // DDSCAPS2_CUBEMAP
+            if ((caps2 & 0xFC00) != 0xFC00) return false; // 一部の面だけのキューブは非対応
+            info.cubemap = true;
+            info.arraySize = 6;
+        }
+        info.volume = (caps2 & 0x200000) != 0; // DDSCAPS2_VOLUME
+        dataOffset = kDdsHeaderSize;
+    }
+    info.depth = info.volume ? (depth > 0 ? depth : 1) : 1;
+
+    bool block = false;
+    if (info.width == 0 || info.height == 0 || info.arraySize == 0 || info.mipLevels > 16 ||
+        FormatBytes(info.dxgiFormat, block) == 0 || (info.volume && info.arraySize != 1))
+        return false;
+    return true;
+}
+
+#ifndef JISAKU_NO_KTX
+// ---------------------------------------------------------------------------
+// KTX2（libktx）。Basis Universal の変換もここで行う
+// ---------------------------------------------------------------------------
+struct KtxDeleter {
+    void operator()(ktxTexture2* t) const { ktxTexture2_Destroy(t); }
+};
+using KtxPtr = std::unique_ptr<ktxTexture2, KtxDeleter>;
+
+uint32_t VkToDxgi(uint32_t vk) {
+    switch (vk) {
+    case 9: return Dxgi::R8_UNORM;
+    case 16: return Dxgi::R8G8_UNORM;
+    case 37: return Dxgi::R8G8B8A8_UNORM;
+    case 43: return Dxgi::R8G8B8A8_UNORM_SRGB;
+    case 44: return Dxgi::B8G8R8A8_UNORM;
+    case 50: return Dxgi::B8G8R8A8_UNORM_SRGB;
+    case 64: return Dxgi::R10G10B10A2_UNORM;  // A2B10G10R10_UNORM_PACK32
+    case 76: return Dxgi::R16_FLOAT;
+    case 83: return Dxgi::R16G16_FLOAT;
+    case 97: return Dxgi::R16G16B16A16_FLOAT;
+    case 100: return Dxgi::R32_FLOAT;
+    case 103: return Dxgi::R32G32_FLOAT;
+    case 109: return Dxgi::R32G32B32A32_FLOAT;
+    case 122: return Dxgi::R11G11B10_FLOAT;   // B10G11R11_UFLOAT_PACK32
+    case 131: case 133: return Dxgi::BC1_UNORM;
+    case 132: case 134: return Dxgi::BC1_UNORM_SRGB;
+    case 135: return Dxgi::BC2_UNORM;
+    case 136: return Dxgi::BC2_UNORM_SRGB;
+    case 137: return Dxgi::BC3_UNORM;
+    case 138: return Dxgi::BC3_UNORM_SRGB;
+    case 139: return Dxgi::BC4_UNORM;
+    case 140: return Dxgi::BC4_SNORM;
+    case 141: return Dxgi::BC5_UNORM;
+    case 142: return Dxgi::BC5_SNORM;
+    case 143: return Dxgi::BC6H_UF16;
+    case 144: return Dxgi::BC6H_SF16;
+    case 145: return Dxgi::BC7_UNORM;
+    case 146: return Dxgi::BC7_UNORM_SRGB;
+    default: return 0;
+    }
+}
+
+KtxPtr OpenKtx2(const uint8_t* data, size_t size, ktxTextureCreateFlags flags) {
+    ktxTexture2* tex = nullptr;
+    if (ktxTexture2_CreateFromMemory(data, size, flags, &tex) != KTX_SUCCESS) return nullptr;
+    return KtxPtr(tex);
+}
+
+bool FillKtx2Info(ktxTexture2* tex, TranscodeTarget target, ContainerInfo& info) {
+    info = ContainerInfo{};
+    info.container = ContainerFormat::KTX2;
+    info.width = tex->baseWidth;
+    info.height = tex->baseHeight;
+    info.volume = tex->numDimensions == 3;
+    info.depth = info.volume ? tex->baseDepth : 1;
+    info.cubemap = tex->isCubemap;
+    info.arraySize = (tex->numLayers > 0 ? tex->numLayers : 1) * tex->numFaces;
+    info.mipLevels = tex->numLevels > 0 ? tex->numLevels : 1;
+    info.transcode = ktxTexture2_NeedsTranscoding(tex);
+    if (info.transcode) {
+        const bool srgb = ktxTexture2_GetOETF(tex) == KHR_DF_TRANSFER_SRGB;
+        info.dxgiFormat = target == TranscodeTarget::BC1 ? (srgb ? Dxgi::BC1_UNORM_SRGB : Dxgi::BC1_UNORM)
+                                                          : (srgb ? Dxgi::BC7_UNORM_SRGB : Dxgi::BC7_UNORM);
+    } else {
+        info.dxgiFormat = VkToDxgi(tex->vkFormat);
+    }
+    bool block = false;
+    return info.width > 0 && info.height > 0 && tex->numDimensions != 1 && FormatBytes(info.dxgiFormat, block) != 0;
+}
+
+bool LoadKtx2(const uint8_t* data, size_t size, TranscodeTarget target, ContainerTexture& out) {
+    KtxPtr tex = OpenKtx2(data, size, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT);
+    if (!tex || !FillKtx2Info(tex.get(), target, out.info)) return false;
+    if (out.info.transcode) {
+        const ktx_transcode_fmt_e fmt = target == TranscodeTarget::BC1 ? KTX_TTF_BC1_RGB : KTX_TTF_BC7_RGBA;
+        if (ktxTexture2_TranscodeBasis(tex.get(), fmt, 0) != KTX_SUCCESS) return false;
+    }
+
+    // libktx のバッファは tex と一緒に消えるので手元へ移す
+    ktxTexture* base = ktxTexture(tex.get());
+    const uint8_t* src = ktxTexture_GetData(base);
+    const size_t srcSize = ktxTexture_GetDataSize(base);
+    out.storage.assign(src, src + srcSize);
+
+    const ContainerInfo& info = out.info;
+    const uint32_t faces = tex->numFaces;
+    out.subresources.clear();
+    for (uint32_t slice = 0; slice < info.arraySize; ++slice) {
+        for (uint32_t mip = 0; mip < info.mipLevels; ++mip) {
+            ContainerSubresource sr;
+            if (!SurfacePitch(info.dxgiFormat, Extent(info.width, mip), Extent(info.height, mip), sr.rowPitch, sr.rowCount))
+                return false;
+            sr.depth = info.volume ? Extent(info.depth, mip) : 1;
+            sr.slicePitch = sr.rowPitch * sr.rowCount;
+            ktx_size_t offset = 0;
+            if (ktxTexture_GetImageOffset(base, mip, slice / faces, slice % faces, &offset) != KTX_SUCCESS) return false;
+            if (offset > srcSize || sr.slicePitch * sr.depth > srcSize - offset) return false;
+            sr.data = out.storage.data() + offset;
+            out.subresources.push_back(sr);
+        }
+    }
+    return true;
+}
+
+#endif // JISAKU_NO_KTX
+
+} // namespace
+
+ContainerFormat jisaku::DetectContainer(const uint8_t* data, size_t size) {
+    static const uint8_t kKtx2[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    if (size >= 4 && ReadU32(data) == FourCC('D', 'D', 'S', ' ')) return ContainerFormat::DDS;
+    if (size >= 12 && std::memcmp(data, kKtx2, 12) == 0) return ContainerFormat::KTX2;
+    return ContainerFormat::None;
+}
+
+bool jisaku::ReadContainerInfo(const uint8_t* data, size_t size, [[maybe_unused]] TranscodeTarget target, ContainerInfo& info) {
+    switch (DetectContainer(data, size)) {
+    case ContainerFormat::DDS: {
+        size_t offset = 0;
+        std::vector<ContainerSubresource> subresources;
+        // サイズ不足もここで弾く（ヘッダのみの確認）
+        return ParseDds(data, size, info, offset) && SliceSequential(data + offset, size - offset, info, subresources);
+    }
+#ifndef JISAKU_NO_KTX
+    case ContainerFormat::KTX2: {
+        KtxPtr tex = OpenKtx2(data, size, KTX_TEXTURE_CREATE_NO_FLAGS);
+        return tex && FillKtx2Info(tex.get(), target, info);
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+bool jisaku::LoadContainer(const uint8_t* data, size_t size, [[maybe_unused]] TranscodeTarget target, ContainerTexture& out) {
+    switch (DetectContainer(data, size)) {
+    case ContainerFormat::DDS: {
+        size_t offset = 0;
+        out.storage.clear();
+        return ParseDds(data, size, out.info, offset) && SliceSequential(data + offset, size - offset, out.info, out.subresources);
+    }
+#ifndef JISAKU_NO_KTX
+    case ContainerFormat::KTX2:
+        return LoadKtx2(data, size, target, out);
+#endif
+    default:
+        return false;
+    }
+}
+
+bool jisaku::WriteDds(const ContainerInfo& info, const std::vector<ContainerSubresource>& subresources, std::vector<uint8_t>& out) {
+    bool block = false;
+    if (info.volume || info.width == 0 || info.height == 0 || info.mipLevels == 0 || info.arraySize == 0 ||
+        (info.cubemap && info.arraySize % 6 != 0) || FormatBytes(info.dxgiFormat, block) == 0 ||
+        subresources.size() != size_t(info.arraySize) * info.mipLevels)
+        return false;
+
+    size_t dataSize = 0;
+    for (const ContainerSubresource& sr : subresources) dataSize += sr.rowPitch * sr.rowCount;
+    out.assign(kDdsHeaderSize + kDdsDx10Size, 0);
+    out.reserve(out.size() + dataSize);
+    auto put = [&out](size_t at, uint32_t v) { WriteU32(out.data() + at, v); };
+    put(0, FourCC('D', 'D', 'S', ' '));
+    put(4, 124);
+    put(8, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000); // CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE
+    put(12, info.height);
+    put(16, info.width);
+    put(20, uint32_t(subresources[0].rowPitch * subresources[0].rowCount));
+    put(28, info.mipLevels);
+    put(76, 32);                                // ピクセルフォーマットの大きさ
+    put(80, 0x4);                               // DDPF_FOURCC
+    put(84, FourCC('D', 'X', '1', '0'));
+    put(108, 0x1000 | (info.mipLevels > 1 || info.arraySize > 1 ? 0x8 : 0) | (info.mipLevels > 1 ? 0x400000 : 0)); // TEXTURE | COMPLEX | MIPMAP
+    put(112, info.cubemap ? 0xFE00 : 0);        // DDSCAPS2_CUBEMAP | 全面
+    put(kDdsHeaderSize, info.dxgiFormat);
+    put(kDdsHeaderSize + 4, 3);                 // TEXTURE2D
+    put(kDdsHeaderSize + 8, info.cubemap ? 0x4 : 0);
+    put(kDdsHeaderSize + 12, info.cubemap ? info.arraySize / 6 : info.arraySize);
+
+    for (const ContainerSubresource& sr : subresources) {
+        for (uint32_t y = 0; y < sr.rowCount; ++y) out.insert(out.end(), sr.data + y * sr.rowPitch, sr.data + (y + 1) * sr.rowPitch);
+    }
+    return true;
+}
+
+uint32_t jisaku::ToSrgbFormat(uint32_t dxgiFormat) {
+    switch (dxgiFormat) {
+    case Dxgi::R8G8B8A8_UNORM: return Dxgi::R8G8B8A8_UNORM_SRGB;
+    case Dxgi::B8G8R8A8_UNORM: return Dxgi::B8G8R8A8_UNORM_SRGB;
+    case Dxgi::BC1_UNORM: return Dxgi::BC1_UNORM_SRGB;
+    case Dxgi::BC2_UNORM: return Dxgi::BC2_UNORM_SRGB;
+    case Dxgi::BC3_UNORM: return Dxgi::BC3_UNORM_SRGB;
+    case Dxgi::BC7_UNORM: return Dxgi::BC7_UNORM_SRGB;
+    default: return dxgiFormat;
+    }
+}
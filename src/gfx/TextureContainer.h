@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jisaku {
+
+// 圧縮済みテクスチャコンテナ（DDS / KTX2）の解析（D3D/Windows 非依存）。
+// 中身はデコードせず、GPU にそのまま渡せるサブリソースの並びとして返す。
+// 形式は DXGI_FORMAT の数値で持つ（Windows ヘッダに依存しないため）。
+// JISAKU_NO_KTX でビルドしたときは KTX2 を判定はするが読めない（libktx が無い環境のテスト・ベンチマーク用）
+enum class ContainerFormat : uint8_t {
+    None,
+    DDS,
+    KTX2,
+};
+
+// Basis Universal（ETC1S/UASTC）の変換先
+enum class TranscodeTarget : uint8_t {
+    BC7, // RGBA 高品質
+    BC1, // RGB（アルファ無し）、半分のサイズ
+};
+
+struct ContainerInfo {
+    ContainerFormat container = ContainerFormat::None;
+    uint32_t dxgiFormat = 0;    // アップロードする形式（変換後）
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t depth = 1;         // 1 より大きければボリューム
+    uint32_t arraySize = 1;     // キューブマップは面数込み（6 の倍数）
+    uint32_t mipLevels = 1;
+    bool cubemap = false;
+    bool volume = false;
+    bool transcode = false;     // Basis Universal を BC へ変換する
+    bool colorSpaceKnown = true; // false: 旧形式 DDS など色空間の指定が無い（読み込み側の forceSRGB に従う）
+};
+
+// 1 サブリソース（D3D の並び: slice * mipLevels + mip）。ボリュームは depth 枚の z スライスを含む
+struct ContainerSubresource {
+    const uint8_t* data = nullptr;
+    size_t rowPitch = 0;    // 1 行（BC はブロック行）のバイト数
+    uint32_t rowCount = 0;  // 行数（BC はブロック行数）
+    uint32_t depth = 1;
+    size_t slicePitch = 0;  // z スライス間のバイト数
+};
+
+struct ContainerTexture {
+    ContainerInfo info;
+    std::vector<ContainerSubresource> subresources;
+    std::vector<uint8_t> storage; // 変換したデータの置き場。DDS は元のバイト列を直接指す（ゼロコピー）
+};
+
+ContainerFormat DetectContainer(const uint8_t* data, size_t size);
+
+// ヘッダだけ読んでアップロード形式・サイズを決める。未対応の形式は false
+bool ReadContainerInfo(const uint8_t* data, size_t size, TranscodeTarget target, ContainerInfo& info);
+
+// サブリソースを取り出す（KTX2 の Basis はここで変換するので重い。ワーカースレッドから呼ぶ）。
+// DDS の結果は data を参照するので、data は out より長く生きていること
+bool LoadContainer(const uint8_t* data, size_t size, TranscodeTarget target, ContainerTexture& out);
+
+// サブリソース（LoadContainer と同じ並び: slice * mipLevels + mip）を DX10 拡張ヘッダ付きの DDS にする（アセットのクック用）。
+// 2D・配列・キューブのみ（ボリュームは false）。各サブリソースは rowCount 行 × rowPitch を詰めて書く
+bool WriteDds(const ContainerInfo& info, const std::vector<ContainerSubresource>& subresources, std::vector<uint8_t>& out);
+
+// sRGB の対になる形式（無ければ format のまま）
+uint32_t ToSrgbFormat(uint32_t dxgiFormat);
+
+} // namespace jisaku
@@ -0,0 +1,17 @@
+#include "TextureKey.h"
+#include <functional>
+
+namespace jisaku
+{
+    size_t TextureKeyHash::operator()(const TextureKey& k) const
+    {
+        const uint64_t opts = (uint64_t)k.forceSRGB | ((uint64_t)k.generateMips << 1) | ((uint64_t)k.compression << 8) |
+                              ((uint64_t)k.quality << 16) | ((uint64_t)k.mipFilter << 24) |
+                              ((uint64_t)k.hdrBC6H << 32);
+        size_t h = std::hash<std::wstring>{}(k.path);
+        auto mix = [&h](uint64_t v) { h ^= (size_t)(v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2)); };
+        mix(k.contentHash);
+        mix(opts);
+        return h;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "gfx/BCEncoder.h"
+#include "gfx/MipGenerator.h"
+
+namespace jisaku
+{
+    // 正規化パス + 内容ハッシュ + 読み込み設定。どれかが違えば別テクスチャとして扱う
+    struct TextureKey
+    {
+        std::wstring path;        // 正規化済み（Windows では小文字化）
+        uint64_t contentHash = 0; // xxHash3 (64bit)
+        bool forceSRGB = true;
+        bool generateMips = true;
+        BCFormat compression = BCFormat::None;
+        BCQuality quality = BCQuality::Fast;
+        MipFilter mipFilter = MipFilter::Box;
+        bool hdrBC6H = false;
+
+        bool operator==(const TextureKey&) const = default;
+    };
+
+    struct TextureKeyHash
+    {
+        size_t operator()(const TextureKey& k) const;
+    };
+}
@@ -1,19 +1,136 @@
 #include "TextureLoader.h"
+#include "gfx/ImageDecoder.h"
+#include "gfx/HdrDecoder.h"
+#include "core/HalfFloat.h"
+#include "core/JobSystem.h"
+#include "core/StreamingCopy.h"
+#include "core/Vfs.h"
 #include <d3d12.h>
+#include <objbase.h>
 #include <DirectXTex.h>
 #include <spdlog/spdlog.h>
 #include <vector>
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 
 namespace jisaku
 {
+    static DXGI_FORMAT ToDXGIFormat(BCFormat fmt, bool srgb)
+    {
+        switch (fmt) {
+        case BCFormat::BC1: return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+        case BCFormat::BC3: return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+        case BCFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+        case BCFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+        case BCFormat::BC7: return srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+        default: return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    // RGBA8 に揃えてから各ミップを BCEncoder で圧縮する
+    static bool CompressScratch(const DirectX::ScratchImage& src, const BCEncodeOptions& opt, DirectX::ScratchImage& out)
+    {
+        const DirectX::TexMetadata& meta = src.GetMetadata();
+        // D3D12 の BC テクスチャは最上位ミップが 4 の倍数である必要がある
+        if ((meta.width % 4) != 0 || (meta.height % 4) != 0) {
+            spdlog::warn("Skipping block compression: {}x{} is not a multiple of 4", meta.width, meta.height);
+            return false;
+        }
+
+        const bool srgb = DirectX::IsSRGB(meta.format);
+        const DXGI_FORMAT rgbaFmt = srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+        DirectX::ScratchImage rgba;
+        const DirectX::ScratchImage* in = &src;
+        if (meta.format != rgbaFmt) {
+            if (FAILED(DirectX::Convert(src.GetImages(), src.GetImageCount(), meta, rgbaFmt,
+                                        DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, rgba))) {
+                spdlog::error("Failed to convert image to RGBA8 for block compression");
+                return false;
+            }
+            in = &rgba;
+        }
+
+        if (FAILED(out.Initialize2D(ToDXGIFormat(opt.format, srgb), meta.width, meta.height, meta.arraySize, meta.mipLevels))) {
+            spdlog::error("Failed to allocate block-compressed image");
+            return false;
+        }
+        for (size_t mip = 0; mip < meta.mipLevels; ++mip) {
+            const DirectX::Image* s = in->GetImage(mip, 0, 0);
+            const DirectX::Image* d = out.GetImage(mip, 0, 0);
+            ConstImageView view{ s->pixels, (uint32_t)s->width, (uint32_t)s->height, s->rowPitch };
+            if (!EncodeBC(view, opt, d->pixels, d->rowPitch)) return false;
+        }
+        return true;
+    }
+
+    static bool IsMipGenFormat(DXGI_FORMAT fmt)
+    {
+        switch (fmt) {
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // MipGenerator でミップチェーンを作る（RGBA8/BGRA8 以外は RGBA8 に変換してから）
+    static bool GenerateMipsScratch(const DirectX::ScratchImage& src, MipFilter filter, bool forceSRGB, DirectX::ScratchImage& out)
+    {
+        const DirectX::TexMetadata& srcMeta = src.GetMetadata();
+        DirectX::ScratchImage converted;
+        const DirectX::ScratchImage* in = &src;
+        if (!IsMipGenFormat(srcMeta.format)) {
+            const DXGI_FORMAT rgbaFmt = DirectX::IsSRGB(srcMeta.format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+            if (FAILED(DirectX::Convert(src.GetImages(), src.GetImageCount(), srcMeta, rgbaFmt,
+                                        DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted))) {
+                spdlog::error("Failed to convert image to RGBA8 for mip generation");
+                return false;
+            }
+            in = &converted;
+        }
+
+        const DirectX::TexMetadata& meta = in->GetMetadata();
+        const uint32_t width = (uint32_t)meta.width, height = (uint32_t)meta.height;
+        const uint32_t levels = CalcMipCount(width, height);
+        if (FAILED(out.Initialize2D(meta.format, width, height, 1, levels))) {
+            spdlog::error("Failed to allocate mip chain");
+            return false;
+        }
+
+        const DirectX::Image* base = in->GetImage(0, 0, 0);
+        const DirectX::Image* dst0 = out.GetImage(0, 0, 0);
+        for (uint32_t y = 0; y < height; ++y)
+            memcpy(dst0->pixels + y * dst0->rowPitch, base->pixels + y * base->rowPitch, size_t(width) * 4);
+
+        std::vector<ImageView> views;
+        for (uint32_t mip = 1; mip < levels; ++mip) {
+            const DirectX::Image* d = out.GetImage(mip, 0, 0);
+            views.push_back({ d->pixels, (uint32_t)d->width, (uint32_t)d->height, d->rowPitch });
+        }
+
+        MipOptions opt;
+        opt.filter = filter;
+        opt.srgb = DirectX::IsSRGB(meta.format) || (forceSRGB && DirectX::IsTypeless(meta.format));
+        ConstImageView srcView{ dst0->pixels, width, height, dst0->rowPitch };
+        return GenerateMips(srcView, opt, views.data(), (uint32_t)views.size());
+    }
+
     bool TextureLoader::Init(ID3D12Device* dev)
     {
-        // 複数スロットのSRVヒープを確保
+        // 複数スロットのSRVヒープを確保（読み直しで SRV を書く先の面を含めて 2 倍）
         m_capacity = 64;
         D3D12_DESCRIPTOR_HEAP_DESC desc{};
         desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-        desc.NumDescriptors = m_capacity;
+        desc.NumDescriptors = m_capacity * 2;
         desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
         HRESULT hr = dev->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_srvHeap));
         if (FAILED(hr)) {
@@ -22,28 +139,35 @@ namespace jisaku
         }
         m_srvInc = dev->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
         m_used.assign(m_capacity, false);
+        m_side.assign(m_capacity, 0);
+        m_retiring.assign(m_capacity, 0);
         return true;
     }
 
     uint32_t TextureLoader::AllocateSlot_()
     {
         for (uint32_t i = 0; i < m_capacity; ++i) {
-            if (!m_used[i]) { m_used[i] = true; return i; }
+            if (!m_used[i]) {
+                m_used[i] = true;
+                m_side[i] = 0;
+                m_retiring[i] = 0;
+                return i;
+            }
         }
         return UINT32_MAX;
     }
 
-    D3D12_CPU_DESCRIPTOR_HANDLE TextureLoader::CpuHandleOf_(uint32_t slot) const
+    D3D12_CPU_DESCRIPTOR_HANDLE TextureLoader::CpuHandleOf_(uint32_t slot, uint8_t side) const
     {
         auto base = m_srvHeap->GetCPUDescriptorHandleForHeapStart();
-        D3D12_CPU_DESCRIPTOR_HANDLE h{ base.ptr + SIZE_T(slot) * SIZE_T(m_srvInc) };
+        D3D12_CPU_DESCRIPTOR_HANDLE h{ base.ptr + (SIZE_T(slot) + SIZE_T(side) * m_capacity) * SIZE_T(m_srvInc) };
         return h;
     }
 
-    D3D12_GPU_DESCRIPTOR_HANDLE TextureLoader::GpuHandleOf_(uint32_t slot) const
+    D3D12_GPU_DESCRIPTOR_HANDLE TextureLoader::GpuHandleOf_(uint32_t slot, uint8_t side) const
     {
         auto base = m_srvHeap->GetGPUDescriptorHandleForHeapStart();
-        D3D12_GPU_DESCRIPTOR_HANDLE h{ base.ptr + UINT64(slot) * UINT64(m_srvInc) };
+        D3D12_GPU_DESCRIPTOR_HANDLE h{ base.ptr + (UINT64(slot) + UINT64(side) * m_capacity) * UINT64(m_srvInc) };
         return h;
     }
 
@@ -255,72 +379,151 @@ namespace jisaku
         return m_srvHeap.Get();
     }
 
-    void TextureLoader::FlushUploads()
+    D3D12_GPU_DESCRIPTOR_HANDLE TextureLoader::GetSrvGpu(uint32_t slot) const
     {
-        m_pendingUploads.clear();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!IsValidSlot(slot)) return {};
+        return GpuHandleOf_(slot, m_side[slot]);
     }
 
-    bool TextureLoader::LoadFromFile(ID3D12Device* dev,
-                                     ID3D12GraphicsCommandList* cmd,
-                                     const std::wstring& path,
-                                     TextureHandle& out,
-                                     bool forceSRGB,
-                                     bool generateMips)
+    void TextureLoader::FlushUploads(DeferredReleaseQueue& retired, uint64_t retireFence)
     {
-        using Microsoft::WRL::ComPtr;
-        using namespace DirectX;
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> uploads;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            uploads.swap(m_pendingUploads);
+        }
+        if (!uploads.empty()) retired.Retire(retireFence, std::move(uploads));
+    }
 
-        try {
-            spdlog::info("LoadFromFile called for: {}", std::string(path.begin(), path.end()));
+    void TextureLoader::ReleaseTexture(TextureHandle& h)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (IsValidSlot(h.slot)) m_used[h.slot] = false;
+        h = TextureHandle{};
+    }
+
+    bool TextureLoader::DecodeToScratch_(const std::wstring& path,
+                                         const std::vector<uint8_t>& bytes,
+                                         bool forceSRGB,
+                                         bool generateMips,
+                                         DirectX::ScratchImage& out) const
+    {
+        using namespace DirectX;
+        const std::string pathU8(path.begin(), path.end());
 
-            TexMetadata meta{};
-            ScratchImage img{};
-            auto wicFlags = forceSRGB ? WIC_FLAGS_FORCE_SRGB : WIC_FLAGS_NONE;
-            
-            spdlog::info("Loading image with WIC...");
-            if (FAILED(LoadFromWICFile(path.c_str(), wicFlags, &meta, img))) {
-                spdlog::error("Failed to load image from file: {}", std::string(path.begin(), path.end()));
+        ScratchImage img{};
+        ImageInfo info;
+        const IImageDecoder* decoder = ImageDecoderRegistry::Get().Find(bytes.data(), bytes.size());
+        if (decoder && decoder->ReadInfo(bytes.data(), bytes.size(), info)) {
+            // ミップ 0 のピクセル領域へ直接デコード（中間バッファなし）
+            const DXGI_FORMAT fmt = forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+            if (FAILED(img.Initialize2D(fmt, info.width, info.height, 1, 1))) {
+                spdlog::error("Failed to allocate {}x{} image for: {}", info.width, info.height, pathU8);
                 return false;
             }
-            spdlog::info("Image loaded successfully: {}x{}, format: {}, mips: {}", 
-                        meta.width, meta.height, (int)meta.format, meta.mipLevels);
-
-            const ScratchImage* src = &img;
-            ScratchImage mipChain;
-            if (generateMips && meta.mipLevels == 1) {
-                spdlog::info("Generating mipmaps...");
-                if (SUCCEEDED(GenerateMipMaps(img.GetImages(), img.GetImageCount(), img.GetMetadata(),
-                                              TEX_FILTER_DEFAULT, 0, mipChain))) {
-                    src = &mipChain;
-                    meta = mipChain.GetMetadata();
-                    spdlog::info("Mipmaps generated: {} levels", meta.mipLevels);
-                }
+            const DirectX::Image* base = img.GetImage(0, 0, 0);
+            if (!decoder->Decode(bytes.data(), bytes.size(), { base->pixels, info.width, info.height, base->rowPitch })) {
+                spdlog::error("{} decoder failed: {}", decoder->Name(), pathU8);
+                return false;
             }
-
-            spdlog::info("Creating texture resource...");
-            ComPtr<ID3D12Resource> tex;
-            if (FAILED(CreateTexture(dev, meta, tex.ReleaseAndGetAddressOf()))) {
-                spdlog::error("Failed to create texture resource");
+        } else if (DetectContainer(bytes.data(), bytes.size()) == ContainerFormat::DDS) {
+            // 直書きできない DDS（24bit RGB・パレット・1D 等）は DirectXTex に任せる
+            decoder = nullptr;
+            TexMetadata ddsMeta{};
+            if (FAILED(LoadFromDDSMemory(bytes.data(), bytes.size(), DDS_FLAGS_NONE, &ddsMeta, img))) {
+                spdlog::error("Failed to load DDS from file: {}", pathU8);
                 return false;
             }
-            spdlog::info("Texture resource created successfully");
-
-        spdlog::info("Preparing upload data...");
-        std::vector<D3D12_SUBRESOURCE_DATA> subres;
-        if (FAILED(PrepareUpload(dev, src->GetImages(), src->GetImageCount(), meta, subres))) {
-                spdlog::error("Failed to prepare upload");
+            if (forceSRGB) img.OverrideFormat(MakeSRGB(ddsMeta.format));
+        } else {
+            // 組み込みデコーダが扱えない形式（GIF/TIFF 等）は WIC にフォールバック。
+            // ワーカースレッドから呼ばれることがあるので COM はここで初期化する
+            decoder = nullptr;
+            const HRESULT coHr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            TexMetadata wicMeta{};
+            const HRESULT hr = LoadFromWICMemory(bytes.data(), bytes.size(), forceSRGB ? WIC_FLAGS_FORCE_SRGB : WIC_FLAGS_NONE, &wicMeta, img);
+            if (SUCCEEDED(coHr)) CoUninitialize();
+            if (FAILED(hr)) {
+                spdlog::error("Failed to load image from file: {}", pathU8);
                 return false;
             }
-            spdlog::info("Upload data prepared: {} subresources", subres.size());
+        }
+        TexMetadata meta = img.GetMetadata();
+        spdlog::info("Image decoded ({}): {}x{}, format: {}, mips: {}",
+                     decoder ? decoder->Name() : "WIC", meta.width, meta.height, (int)meta.format, meta.mipLevels);
+
+        ScratchImage* src = &img;
+        // 圧縮済み・配列・ボリュームの DDS は格納されたまま使う
+        if (IsCompressed(meta.format) || meta.arraySize > 1 || meta.depth > 1) {
+            out = std::move(img);
+            return true;
+        }
+        ScratchImage mipChain;
+        if (generateMips && meta.mipLevels == 1) {
+            if (GenerateMipsScratch(img, m_mipFilter, forceSRGB, mipChain)) {
+                src = &mipChain;
+                spdlog::info("Mipmaps generated: {} levels", mipChain.GetMetadata().mipLevels);
+            }
+        }
+
+        ScratchImage compressed;
+        if (m_compression.format != BCFormat::None) {
+            if (CompressScratch(*src, m_compression, compressed)) {
+                src = &compressed;
+                spdlog::info("Block compression done: format {}", (int)compressed.GetMetadata().format);
+            }
+        }
+
+        out = std::move(*src);
+        return true;
+    }
+
+    bool TextureLoader::DecodeToImage_(const std::wstring& path, Image& out) const
+    {
+        const std::string pathU8(path.begin(), path.end());
+        std::vector<uint8_t> bytes;
+        if (!Vfs::Get().ReadFile(path, bytes)) {
+            spdlog::error("Failed to read file: {}", pathU8);
+            return false;
+        }
+        if (DecodeImage(bytes.data(), bytes.size(), out)) return true;
+
+        // WIC にフォールバック。sRGB 変換はさせず、画素値をそのまま RGBA8 で受け取る
+        const HRESULT coHr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        DirectX::ScratchImage img, converted;
+        HRESULT hr = DirectX::LoadFromWICMemory(bytes.data(), bytes.size(), DirectX::WIC_FLAGS_IGNORE_SRGB, nullptr, img);
+        if (SUCCEEDED(hr) && img.GetMetadata().format != DXGI_FORMAT_R8G8B8A8_UNORM) {
+            hr = DirectX::Convert(*img.GetImage(0, 0, 0), DXGI_FORMAT_R8G8B8A8_UNORM,
+                                  DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted);
+            if (SUCCEEDED(hr)) img = std::move(converted);
+        }
+        if (SUCCEEDED(coHr)) CoUninitialize();
+        if (FAILED(hr)) {
+            spdlog::error("Failed to load image from file: {}", pathU8);
+            return false;
+        }
+
+        const DirectX::Image* base = img.GetImage(0, 0, 0);
+        out.Allocate((uint32_t)base->width, (uint32_t)base->height);
+        for (uint32_t y = 0; y < out.height; ++y)
+            memcpy(out.View().Row(y), base->pixels + y * base->rowPitch, size_t(out.width) * 4);
+        return true;
+    }
+
+    bool TextureLoader::CreateStaging_(ID3D12Device* dev, Microsoft::WRL::ComPtr<ID3D12Resource> texture, Staging_& st)
+    {
+        using Microsoft::WRL::ComPtr;
 
         // フットプリントを計算して正しくアップロード
-        const UINT numSubresources = static_cast<UINT>(subres.size());
-        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubresources);
-        std::vector<UINT> numRows(numSubresources);
-        std::vector<UINT64> rowSizes(numSubresources);
+        const D3D12_RESOURCE_DESC desc = texture->GetDesc();
+        const UINT numSubresources = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D
+            ? desc.MipLevels : desc.MipLevels * desc.DepthOrArraySize;
+        st.layouts.resize(numSubresources);
+        st.numRows.resize(numSubresources);
+        st.rowSizes.resize(numSubresources);
         UINT64 totalBytes = 0;
-        D3D12_RESOURCE_DESC desc = tex->GetDesc();
-        dev->GetCopyableFootprints(&desc, 0, numSubresources, 0, layouts.data(), numRows.data(), rowSizes.data(), &totalBytes);
+        dev->GetCopyableFootprints(&desc, 0, numSubresources, 0, st.layouts.data(), st.numRows.data(), st.rowSizes.data(), &totalBytes);
 
         spdlog::info("Creating upload resource, total size: {} bytes", totalBytes);
         D3D12_RESOURCE_DESC uploadDesc = {};
@@ -346,109 +549,845 @@ namespace jisaku
             spdlog::error("Failed to create upload resource");
             return false;
         }
-        spdlog::info("Upload resource created successfully");
 
-        // マップして各サブリソースを行単位でコピー
-        spdlog::info("Mapping upload resource...");
+        // 書き込み側（デコーダ/ミップ生成/コピー）が直接フットプリントへ書くので、コミットまでマップしたままにする
         void* mappedData = nullptr;
         if (FAILED(upload->Map(0, nullptr, &mappedData))) {
             spdlog::error("Failed to map upload resource");
             return false;
         }
 
-        spdlog::info("Copying data to upload buffer with footprints...");
-        for (UINT i = 0; i < numSubresources; ++i) {
+        st.texture = std::move(texture);
+        st.upload = std::move(upload);
+        st.mapped = static_cast<uint8_t*>(mappedData);
+        return true;
+    }
+
+    bool TextureLoader::CreateDirectStaging_(ID3D12Device* dev, const ImageInfo& info, DXGI_FORMAT format, bool generateMips, Staging_& st)
+    {
+        using Microsoft::WRL::ComPtr;
+
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.Width = info.width;
+        desc.Height = info.height;
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = (UINT16)(generateMips ? CalcMipCount(info.width, info.height) : 1);
+        desc.Format = format;
+        desc.SampleDesc.Count = 1;
+        desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        D3D12_HEAP_PROPERTIES heapProps = {};
+        heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+        ComPtr<ID3D12Resource> tex;
+        if (FAILED(dev->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+                                               D3D12_RESOURCE_STATE_COMMON, nullptr,
+                                               IID_PPV_ARGS(&tex)))) {
+            spdlog::error("Failed to create texture resource");
+            return false;
+        }
+        return CreateStaging_(dev, std::move(tex), st);
+    }
+
+    bool TextureLoader::CreateContainerStaging_(ID3D12Device* dev, const ContainerInfo& info, bool forceSRGB, Staging_& st)
+    {
+        using Microsoft::WRL::ComPtr;
+
+        // 旧形式の DDS は色空間を持たないので forceSRGB に従う
+        const DXGI_FORMAT format = (DXGI_FORMAT)(info.colorSpaceKnown || !forceSRGB ? info.dxgiFormat : ToSrgbFormat(info.dxgiFormat));
+        if (DirectX::IsCompressed(format) && ((info.width % 4) != 0 || (info.height % 4) != 0)) {
+            spdlog::error("Block-compressed texture must be a multiple of 4: {}x{}", info.width, info.height);
+            return false;
+        }
+
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = info.volume ? D3D12_RESOURCE_DIMENSION_TEXTURE3D : D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.Width = info.width;
+        desc.Height = info.height;
+        desc.DepthOrArraySize = (UINT16)(info.volume ? info.depth : info.arraySize);
+        desc.MipLevels = (UINT16)info.mipLevels;
+        desc.Format = format;
+        desc.SampleDesc.Count = 1;
+        desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        D3D12_HEAP_PROPERTIES heapProps = {};
+        heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+        ComPtr<ID3D12Resource> tex;
+        if (FAILED(dev->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+                                               D3D12_RESOURCE_STATE_COMMON, nullptr,
+                                               IID_PPV_ARGS(&tex)))) {
+            spdlog::error("Failed to create texture resource");
+            return false;
+        }
+        st.dim = info.cubemap ? TextureDimension::Cube
+               : info.volume ? TextureDimension::Volume
+               : info.arraySize > 1 ? TextureDimension::Array : TextureDimension::Texture2D;
+        return CreateStaging_(dev, std::move(tex), st);
+    }
+
+    bool TextureLoader::DecodeToStaging_(const std::vector<uint8_t>& bytes,
+                                         const IImageDecoder& decoder,
+                                         bool forceSRGB,
+                                         const Staging_& st) const
+    {
+        auto level = [&](size_t i) -> ImageView {
+            const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& l = st.layouts[i];
+            return { st.mapped + l.Offset, l.Footprint.Width, l.Footprint.Height, l.Footprint.RowPitch };
+        };
+
+        const ImageView dst0 = level(0);
+        if (st.layouts.size() == 1) {
+            // ミップなし: デコーダが行順に書くだけなので WC メモリへそのまま展開する
+            const bool ok = decoder.Decode(bytes.data(), bytes.size(), dst0);
+            StreamFence();
+            return ok;
+        }
+
+        // ミップ生成はミップ 0 を読み返すので、WC メモリではなくキャッシュ上のバッファへデコードする
+        const size_t rowBytes = size_t(dst0.width) * 4;
+        std::unique_ptr<uint8_t[]> base(new uint8_t[rowBytes * dst0.height]);
+        const ImageView baseView{ base.get(), dst0.width, dst0.height, rowBytes };
+        if (!decoder.Decode(bytes.data(), bytes.size(), baseView)) return false;
+        for (uint32_t y = 0; y < dst0.height; ++y) StreamCopy(dst0.Row(y), baseView.Row(y), rowBytes);
+
+        std::vector<ImageView> views;
+        for (size_t i = 1; i < st.layouts.size(); ++i) views.push_back(level(i));
+
+        MipOptions opt;
+        opt.filter = m_mipFilter;
+        opt.srgb = forceSRGB;
+        opt.streamingStores = true;
+        const bool ok = GenerateMips(baseView, opt, views.data(), (uint32_t)views.size());
+        StreamFence();
+        return ok;
+    }
+
+    bool TextureLoader::DecodeHdrToStaging_(const std::vector<uint8_t>& bytes, const Staging_& st) const
+    {
+        // ミップ生成は前段を読み返すので、各レベルはキャッシュ上の float で作ってから half にして書き込む
+        std::vector<FloatImage> levels(st.layouts.size());
+        for (size_t i = 0; i < levels.size(); ++i)
+            levels[i].Allocate(st.layouts[i].Footprint.Width, st.layouts[i].Footprint.Height);
+        if (!DecodeHdr(bytes.data(), bytes.size(), levels[0].View())) return false;
+
+        std::vector<FloatImageView> views;
+        for (size_t i = 1; i < levels.size(); ++i) views.push_back(levels[i].View());
+        MipOptions opt;
+        opt.filter = m_mipFilter;
+        if (!views.empty() && !GenerateMips(levels[0].View(), opt, views.data(), (uint32_t)views.size())) return false;
+
+        // F16C の出力は 16byte 単位の連続ストアなので、WC メモリへ直接書いても結合される
+        for (size_t i = 0; i < levels.size(); ++i) {
+            const ConstFloatImageView src = levels[i].View();
+            uint8_t* dst = st.mapped + st.layouts[i].Offset;
+            for (uint32_t y = 0; y < src.height; ++y) {
+                FloatToHalf(reinterpret_cast<uint16_t*>(dst + size_t(y) * st.layouts[i].Footprint.RowPitch),
+                            src.Row(y), size_t(src.width) * 4);
+            }
+        }
+        return true;
+    }
+
+    bool TextureLoader::DecodeHdrToScratch_(const std::wstring& path,
+                                            const std::vector<uint8_t>& bytes,
+                                            bool generateMips,
+                                            DirectX::ScratchImage& out) const
+    {
+        const std::string pathU8(path.begin(), path.end());
+        FloatImage base;
+        if (!DecodeHdrImage(bytes.data(), bytes.size(), base)) {
+            spdlog::error("{} decoder failed: {}", HdrFormatName(DetectHdrFormat(bytes.data(), bytes.size())), pathU8);
+            return false;
+        }
+
+        MipOptions opt;
+        opt.filter = m_mipFilter;
+        opt.maxLevels = generateMips ? 0 : 1;
+        std::vector<FloatImage> levels;
+        if (!GenerateMipChain(base.View(), opt, levels)) return false;
+
+        DirectX::ScratchImage half;
+        if (FAILED(half.Initialize2D(DXGI_FORMAT_R16G16B16A16_FLOAT, base.width, base.height, 1, levels.size()))) {
+            spdlog::error("Failed to allocate {}x{} HDR image for: {}", base.width, base.height, pathU8);
+            return false;
+        }
+        for (size_t i = 0; i < levels.size(); ++i) {
+            const DirectX::Image* d = half.GetImage(i, 0, 0);
+            const ConstFloatImageView src = levels[i].View();
+            for (uint32_t y = 0; y < src.height; ++y)
+                FloatToHalf(reinterpret_cast<uint16_t*>(d->pixels + y * d->rowPitch), src.Row(y), size_t(src.width) * 4);
+        }
+
+        if (m_hdrBC6H) {
+            if ((base.width % 4) != 0 || (base.height % 4) != 0) {
+                spdlog::warn("Skipping BC6H: {}x{} is not a multiple of 4", base.width, base.height);
+            } else {
+                DirectX::ScratchImage compressed;
+                if (SUCCEEDED(DirectX::Compress(half.GetImages(), half.GetImageCount(), half.GetMetadata(), DXGI_FORMAT_BC6H_UF16,
+                                                DirectX::TEX_COMPRESS_PARALLEL, DirectX::TEX_THRESHOLD_DEFAULT, compressed))) {
+                    out = std::move(compressed);
+                    spdlog::info("BC6H compression done: {}", pathU8);
+                    return true;
+                }
+                spdlog::error("BC6H compression failed, uploading RGBA16F: {}", pathU8);
+            }
+        }
+        out = std::move(half);
+        return true;
+    }
+
+    bool TextureLoader::LoadContainerToStaging_(const std::vector<uint8_t>& bytes, const Staging_& st) const
+    {
+        // DDS はファイルイメージを直接指すのでコピーは 1 回。KTX2 の Basis はここ（ワーカー上）で変換する
+        ContainerTexture tex;
+        if (!LoadContainer(bytes.data(), bytes.size(), GetTranscodeTarget_(), tex)) return false;
+        if (tex.subresources.size() != st.layouts.size()) {
+            spdlog::error("Subresource count mismatch: {} vs {}", tex.subresources.size(), st.layouts.size());
+            return false;
+        }
+
+        for (size_t i = 0; i < st.layouts.size(); ++i) {
+            const ContainerSubresource& sr = tex.subresources[i];
+            const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& l = st.layouts[i];
+            const size_t rowBytes = (size_t)std::min<UINT64>(st.rowSizes[i], sr.rowPitch);
+            const UINT rows = std::min<UINT>(st.numRows[i], sr.rowCount);
+            const uint32_t depth = std::min<uint32_t>(l.Footprint.Depth, sr.depth);
+            for (uint32_t z = 0; z < depth; ++z) {
+                uint8_t* dst = st.mapped + l.Offset + size_t(z) * l.Footprint.RowPitch * st.numRows[i];
+                const uint8_t* src = sr.data + z * sr.slicePitch;
+                for (UINT row = 0; row < rows; ++row)
+                    StreamCopy(dst + size_t(row) * l.Footprint.RowPitch, src + row * sr.rowPitch, rowBytes);
+            }
+        }
+        StreamFence();
+        return true;
+    }
+
+    bool TextureLoader::UploadScratch_(ID3D12Device* dev,
+                                       ID3D12GraphicsCommandList* cmd,
+                                       const DirectX::ScratchImage& image,
+                                       bool forceSRGB,
+                                       TextureHandle& out)
+    {
+        Staging_ st;
+        if (!ScratchToStaging_(dev, image, st)) return false;
+        return CommitStaging_(dev, cmd, st, forceSRGB, out, /*replace=*/false);
+    }
+
+    bool TextureLoader::ScratchToStaging_(ID3D12Device* dev, const DirectX::ScratchImage& image, Staging_& st)
+    {
+        using Microsoft::WRL::ComPtr;
+        using namespace DirectX;
+
+        const TexMetadata& meta = image.GetMetadata();
+
+        spdlog::info("Creating texture resource...");
+        ComPtr<ID3D12Resource> tex;
+        if (FAILED(CreateTexture(dev, meta, tex.ReleaseAndGetAddressOf()))) {
+            spdlog::error("Failed to create texture resource");
+            return false;
+        }
+
+        std::vector<D3D12_SUBRESOURCE_DATA> subres;
+        if (FAILED(PrepareUpload(dev, image.GetImages(), image.GetImageCount(), meta, subres))) {
+            spdlog::error("Failed to prepare upload");
+            return false;
+        }
+
+        if (!CreateStaging_(dev, std::move(tex), st)) return false;
+        st.dim = meta.IsCubemap() ? TextureDimension::Cube
+               : meta.dimension == TEX_DIMENSION_TEXTURE3D ? TextureDimension::Volume
+               : meta.arraySize > 1 ? TextureDimension::Array : TextureDimension::Texture2D;
+        if (st.layouts.size() != subres.size()) {
+            spdlog::error("Subresource count mismatch: {} vs {}", st.layouts.size(), subres.size());
+            return false;
+        }
+
+        // 各サブリソースを行単位で非テンポラルコピー
+        for (size_t i = 0; i < subres.size(); ++i) {
             const D3D12_SUBRESOURCE_DATA& sd = subres[i];
             const UINT8* srcBytes = reinterpret_cast<const UINT8*>(sd.pData);
-            UINT8* dst = reinterpret_cast<UINT8*>(mappedData) + layouts[i].Offset;
-            const UINT64 dstRowPitch = layouts[i].Footprint.RowPitch;
-            for (UINT row = 0; row < numRows[i]; ++row) {
-                memcpy(dst + row * dstRowPitch, srcBytes + row * sd.RowPitch, static_cast<size_t>(rowSizes[i]));
+            const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& l = st.layouts[i];
+            const UINT64 dstRowPitch = l.Footprint.RowPitch;
+            for (UINT z = 0; z < l.Footprint.Depth; ++z) { // ボリュームは奥行き方向のスライスごと
+                UINT8* dst = st.mapped + l.Offset + size_t(z) * dstRowPitch * st.numRows[i];
+                const UINT8* src = srcBytes + size_t(z) * sd.SlicePitch;
+                for (UINT row = 0; row < st.numRows[i]; ++row) {
+                    StreamCopy(dst + row * dstRowPitch, src + row * sd.RowPitch, static_cast<size_t>(st.rowSizes[i]));
+                }
+            }
+        }
+        StreamFence();
+        return true;
+    }
+
+    bool TextureLoader::UploadSlices_(ID3D12Device* dev,
+                                      ID3D12GraphicsCommandList* cmd,
+                                      const std::vector<Image>& slices,
+                                      TextureDimension dim,
+                                      bool forceSRGB,
+                                      bool generateMips,
+                                      TextureHandle& out)
+    {
+        using Microsoft::WRL::ComPtr;
+
+        const uint32_t count = (uint32_t)slices.size();
+        if (count == 0 || (dim == TextureDimension::Texture2D && count != 1)) {
+            spdlog::error("Invalid slice count {} for dimension {}", count, (int)dim);
+            return false;
+        }
+        const uint32_t width = slices[0].width, height = slices[0].height;
+        for (const Image& s : slices) {
+            if (s.width != width || s.height != height) {
+                spdlog::error("All slices must have the same size ({}x{} vs {}x{})", s.width, s.height, width, height);
+                return false;
+            }
+        }
+        if (dim == TextureDimension::Cube && (count % 6 != 0 || width != height)) {
+            spdlog::error("Cubemap needs square faces in multiples of 6 (got {} of {}x{})", count, width, height);
+            return false;
+        }
+        const bool volume = dim == TextureDimension::Volume;
+        const uint32_t maxSlices = volume ? D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION : D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION;
+        if (count > maxSlices) {
+            spdlog::error("Too many slices: {} (max {})", count, maxSlices);
+            return false;
+        }
+
+        // ボリュームは奥行き方向も縮小するので、ミップ数は 3 軸の最大で決まる
+        const uint32_t levels = !generateMips ? 1
+            : volume ? CalcMipCount((std::max)(width, height), count) : CalcMipCount(width, height);
+
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = volume ? D3D12_RESOURCE_DIMENSION_TEXTURE3D : D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.Width = width;
+        desc.Height = height;
+        desc.DepthOrArraySize = (UINT16)count;
+        desc.MipLevels = (UINT16)levels;
+        desc.Format = forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        D3D12_HEAP_PROPERTIES heapProps = {};
+        heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+        Staging_ st;
+        st.dim = dim;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ComPtr<ID3D12Resource> tex;
+            if (FAILED(dev->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+                                                   D3D12_RESOURCE_STATE_COMMON, nullptr,
+                                                   IID_PPV_ARGS(&tex)))) {
+                spdlog::error("Failed to create {}-slice texture resource", count);
+                return false;
             }
+            if (!CreateStaging_(dev, std::move(tex), st)) return false;
         }
-        upload->Unmap(0, nullptr);
-        spdlog::info("Data copied to upload buffer successfully");
+
+        // 各サブリソース（3D は z スライスごと）のフットプリントへ直接書く
+        auto view = [&](size_t i, uint32_t z) -> ImageView {
+            const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& l = st.layouts[i];
+            return { st.mapped + l.Offset + size_t(z) * l.Footprint.RowPitch * st.numRows[i],
+                     l.Footprint.Width, l.Footprint.Height, l.Footprint.RowPitch };
+        };
+        std::vector<ConstImageView> src;
+        for (const Image& s : slices) src.push_back(s.View());
+
+        MipOptions opt;
+        opt.filter = m_mipFilter;
+        opt.srgb = forceSRGB;
+        opt.streamingStores = true;
+        bool ok;
+        if (volume) {
+            std::vector<std::vector<ImageView>> dst(levels);
+            for (uint32_t l = 0; l < levels; ++l) {
+                for (uint32_t z = 0; z < st.layouts[l].Footprint.Depth; ++z) dst[l].push_back(view(l, z));
+            }
+            ok = GenerateVolumeMips(src.data(), count, opt, dst);
+        } else {
+            // D3D のサブリソース順（slice * levels + mip）は GenerateSliceMips の出力順と同じ
+            std::vector<ImageView> dst;
+            for (size_t i = 0; i < st.layouts.size(); ++i) dst.push_back(view(i, 0));
+            ok = GenerateSliceMips(src.data(), count, opt, dst.data(), levels);
+        }
+        StreamFence();
+        if (!ok) {
+            spdlog::error("Failed to generate mips for {} slices", count);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return CommitStaging_(dev, cmd, st, forceSRGB, out, /*replace=*/false);
+    }
+
+    bool TextureLoader::CommitStaging_(ID3D12Device* dev,
+                                       ID3D12GraphicsCommandList* cmd,
+                                       Staging_& st,
+                                       bool forceSRGB,
+                                       TextureHandle& out,
+                                       bool replace)
+    {
+        st.upload->Unmap(0, nullptr);
+        st.mapped = nullptr;
 
         // 遷移: COMMON -> COPY_DEST（DirectXTex CreateTexture は COMMON の想定）
         {
             D3D12_RESOURCE_BARRIER b = {};
             b.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-            b.Transition.pResource = tex.Get();
+            b.Transition.pResource = st.texture.Get();
             b.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
             b.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
             b.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
             cmd->ResourceBarrier(1, &b);
-            spdlog::info("Resource barrier recorded: COMMON -> COPY_DEST");
         }
 
         // テクスチャにコピー
-        spdlog::info("Copying data to texture...");
-        for (UINT i = 0; i < numSubresources; ++i) {
+        for (UINT i = 0; i < (UINT)st.layouts.size(); ++i) {
             D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
-            srcLoc.pResource = upload.Get();
+            srcLoc.pResource = st.upload.Get();
             srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-            srcLoc.PlacedFootprint = layouts[i];
+            srcLoc.PlacedFootprint = st.layouts[i];
 
             D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
-            dstLoc.pResource = tex.Get();
+            dstLoc.pResource = st.texture.Get();
             dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
             dstLoc.SubresourceIndex = i;
 
             cmd->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
         }
-        spdlog::info("Data copied to texture successfully");
-
-            // 遷移: COPY_DEST -> PIXEL_SHADER_RESOURCE
-            spdlog::info("Setting resource barrier...");
-            D3D12_RESOURCE_BARRIER barrier = {};
-            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-            barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-            barrier.Transition.pResource = tex.Get();
-            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-            cmd->ResourceBarrier(1, &barrier);
-
-            // SRVをスロットに作成
-            spdlog::info("Creating SRV...");
-            DXGI_FORMAT fmt = meta.format;
-            if (fmt == DXGI_FORMAT_B8G8R8A8_TYPELESS) fmt = forceSRGB ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
-            if (fmt == DXGI_FORMAT_R8G8B8A8_TYPELESS) fmt = forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
-
-            D3D12_SHADER_RESOURCE_VIEW_DESC srv{};
-            srv.Format = fmt;
+
+        // 遷移: COPY_DEST -> PIXEL_SHADER_RESOURCE
+        D3D12_RESOURCE_BARRIER barrier = {};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        barrier.Transition.pResource = st.texture.Get();
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        cmd->ResourceBarrier(1, &barrier);
+
+        // SRVをスロットに作成
+        const D3D12_RESOURCE_DESC desc = st.texture->GetDesc();
+        DXGI_FORMAT fmt = desc.Format;
+        if (fmt == DXGI_FORMAT_B8G8R8A8_TYPELESS) fmt = forceSRGB ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
+        if (fmt == DXGI_FORMAT_R8G8B8A8_TYPELESS) fmt = forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+
+        D3D12_SHADER_RESOURCE_VIEW_DESC srv{};
+        srv.Format = fmt;
+        srv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        switch (st.dim) {
+        case TextureDimension::Array:
+            srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+            srv.Texture2DArray.MipLevels = desc.MipLevels;
+            srv.Texture2DArray.ArraySize = desc.DepthOrArraySize;
+            break;
+        case TextureDimension::Cube:
+            if (desc.DepthOrArraySize > 6) {
+                srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBEARRAY;
+                srv.TextureCubeArray.MipLevels = desc.MipLevels;
+                srv.TextureCubeArray.NumCubes = desc.DepthOrArraySize / 6;
+            } else {
+                srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+                srv.TextureCube.MipLevels = desc.MipLevels;
+            }
+            break;
+        case TextureDimension::Volume:
+            srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE3D;
+            srv.Texture3D.MipLevels = desc.MipLevels;
+            break;
+        default:
             srv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-            srv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-            srv.Texture2D.MipLevels = (UINT)meta.mipLevels;
+            srv.Texture2D.MipLevels = desc.MipLevels;
+            break;
+        }
+
+        if (!CreateSrv_(dev, st.texture, srv, out, replace)) return false;
+
+        // アップロード寿命を保持（FlushUploads で解放待ちへ回す）
+        m_pendingUploads.push_back(st.upload);
+        return true;
+    }
 
-            uint32_t slot = AllocateSlot_();
-            if (slot == UINT32_MAX) {
-                spdlog::error("SRV heap is full");
+    bool TextureLoader::CreateSrv_(ID3D12Device* dev,
+                                   const Microsoft::WRL::ComPtr<ID3D12Resource>& resource,
+                                   const D3D12_SHADER_RESOURCE_VIEW_DESC& srv,
+                                   TextureHandle& out,
+                                   bool replace)
+    {
+        uint32_t slot = UINT32_MAX;
+        uint8_t side = 0;
+        if (replace) {
+            // 今の SRV は前のフレームが読んでいるかもしれないので、スロットのもう片側へ作る（スロット番号は同じ）
+            if (!IsValidSlot(out.slot) || !m_used[out.slot]) {
+                spdlog::error("Cannot replace texture in unused slot {}", out.slot);
                 return false;
             }
-            auto cpu = CpuHandleOf_(slot);
-            dev->CreateShaderResourceView(tex.Get(), &srv, cpu);
-
-            // ハンドル更新
-            out.resource = tex;
-            out.srvCPU = cpu;
-            out.srvGPU = GpuHandleOf_(slot);
-            out.slot = slot;
-
-            // アップロード寿命を保持（GPU完了後にFlushUploadsで解放）
-            m_pendingUploads.push_back(upload);
-            
-            spdlog::info("Successfully loaded texture from file");
-            return true;
+            slot = out.slot;
+            if (m_retiring[slot] != 0) {
+                spdlog::error("Cannot replace texture in slot {} before its previous SRV is released", slot);
+                return false;
+            }
+            side = uint8_t(m_side[slot] ^ 1);
+        } else {
+            slot = AllocateSlot_();
         }
-        catch (const std::exception& e) {
-            spdlog::error("Exception in LoadFromFile: {}", e.what());
+        if (slot == UINT32_MAX) {
+            spdlog::error("SRV heap is full");
             return false;
         }
-        catch (...) {
-            spdlog::error("Unknown exception in LoadFromFile");
+        auto cpu = CpuHandleOf_(slot, side);
+        dev->CreateShaderResourceView(resource.Get(), &srv, cpu);
+        m_side[slot] = side;
+
+        // ハンドル更新
+        out.resource = resource;
+        out.srvCPU = cpu;
+        out.srvGPU = GpuHandleOf_(slot, side);
+        out.slot = slot;
+        return true;
+    }
+
+    bool TextureLoader::RegisterTexture(ID3D12Device* dev,
+                                        const Microsoft::WRL::ComPtr<ID3D12Resource>& resource,
+                                        const D3D12_SHADER_RESOURCE_VIEW_DESC& srv,
+                                        TextureHandle& out)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return CreateSrv_(dev, resource, srv, out, /*replace=*/false);
+    }
+
+    bool TextureLoader::LoadFromFile(ID3D12Device* dev,
+                                     ID3D12GraphicsCommandList* cmd,
+                                     const std::wstring& path,
+                                     TextureHandle& out,
+                                     bool forceSRGB,
+                                     bool generateMips)
+    {
+        spdlog::info("LoadFromFile called for: {}", std::string(path.begin(), path.end()));
+
+        std::vector<TextureHandle> handles;
+        if (LoadBatch(dev, cmd, { path }, handles, forceSRGB, generateMips) == 0) return false;
+        out = handles[0];
+        spdlog::info("Successfully loaded texture from file");
+        return true;
+    }
+
+    bool TextureLoader::LoadFromMemory(ID3D12Device* dev,
+                                       ID3D12GraphicsCommandList* cmd,
+                                       std::vector<uint8_t> bytes,
+                                       const std::wstring& name,
+                                       TextureHandle& out,
+                                       bool forceSRGB,
+                                       bool generateMips)
+    {
+        std::vector<std::vector<uint8_t>> sources(1);
+        sources[0] = std::move(bytes);
+        std::vector<TextureHandle> handles;
+        if (LoadSources_(dev, cmd, { name }, &sources, handles, forceSRGB, generateMips) == 0) return false;
+        out = handles[0];
+        return true;
+    }
+
+    bool TextureLoader::LoadSlices(ID3D12Device* dev,
+                                   ID3D12GraphicsCommandList* cmd,
+                                   const std::vector<std::wstring>& paths,
+                                   TextureDimension dim,
+                                   TextureHandle& out,
+                                   bool forceSRGB,
+                                   bool generateMips)
+    {
+        // スライスごとのデコードは並列（ミップ生成は UploadSlices_ 内でスライス単位に並列化される）
+        std::vector<Image> slices(paths.size());
+        std::atomic<bool> ok{ !paths.empty() };
+        JobSystem::Get().ParallelFor((uint32_t)paths.size(), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                if (!DecodeToImage_(paths[i], slices[i])) ok = false;
+            }
+        });
+        if (!ok || !UploadSlices_(dev, cmd, slices, dim, forceSRGB, generateMips, out)) return false;
+        spdlog::info("LoadSlices: {} slices loaded (dimension {})", paths.size(), (int)dim);
+        return true;
+    }
+
+    bool TextureLoader::LoadCubeFromLayout(ID3D12Device* dev,
+                                           ID3D12GraphicsCommandList* cmd,
+                                           const std::wstring& path,
+                                           CubeLayout layout,
+                                           TextureHandle& out,
+                                           bool forceSRGB,
+                                           bool generateMips)
+    {
+        Image sheet;
+        if (!DecodeToImage_(path, sheet)) return false;
+        std::vector<Image> faces;
+        if (!ExtractCubeFaces(sheet.View(), layout, faces)) {
+            spdlog::error("Unrecognized cube layout ({}x{}): {}", sheet.width, sheet.height, std::string(path.begin(), path.end()));
             return false;
         }
+        return UploadSlices_(dev, cmd, faces, TextureDimension::Cube, forceSRGB, generateMips, out);
+    }
+
+    bool TextureLoader::LoadArrayFromGrid(ID3D12Device* dev,
+                                          ID3D12GraphicsCommandList* cmd,
+                                          const std::wstring& path,
+                                          uint32_t cols,
+                                          uint32_t rows,
+                                          TextureHandle& out,
+                                          bool forceSRGB,
+                                          bool generateMips)
+    {
+        Image sheet;
+        if (!DecodeToImage_(path, sheet)) return false;
+        std::vector<Image> slices;
+        if (!SplitGrid(sheet.View(), cols, rows, slices)) {
+            spdlog::error("Cannot split {}x{} image into a {}x{} grid: {}", sheet.width, sheet.height, cols, rows,
+                          std::string(path.begin(), path.end()));
+            return false;
+        }
+        return UploadSlices_(dev, cmd, slices, TextureDimension::Array, forceSRGB, generateMips, out);
+    }
+
+    size_t TextureLoader::LoadBatch(ID3D12Device* dev,
+                                    ID3D12GraphicsCommandList* cmd,
+                                    const std::vector<std::wstring>& paths,
+                                    std::vector<TextureHandle>& out,
+                                    bool forceSRGB,
+                                    bool generateMips)
+    {
+        return LoadSources_(dev, cmd, paths, nullptr, out, forceSRGB, generateMips);
+    }
+
+    struct TextureLoader::Source_
+    {
+        std::vector<uint8_t> bytes;
+        const IImageDecoder* decoder = nullptr; // 直書き経路のときのみ非 null
+        bool hdr = false;                       // .hdr/.exr（RGBA16F または BC6H）
+        bool container = false;                 // DDS/KTX2
+        bool direct = false;                    // アップロードバッファへ直接書く経路
+        ImageInfo info;
+        ContainerInfo containerInfo;
+        Staging_ staging;
+        DirectX::ScratchImage scratch;
+        bool ok = false;
+    };
+
+    struct TextureLoader::PendingReload
+    {
+        Staging_ staging;
+        bool forceSRGB = true;
+    };
+
+    void TextureLoader::PrepareSources_(ID3D12Device* dev,
+                                        const std::vector<std::wstring>& paths,
+                                        std::vector<std::vector<uint8_t>>* sources,
+                                        std::vector<Source_>& items,
+                                        bool forceSRGB,
+                                        bool generateMips)
+    {
+        const uint32_t count = (uint32_t)paths.size();
+        items.clear();
+        items.resize(count);
+
+        auto guarded = [&](uint32_t i, const char* what, auto&& fn) {
+            try {
+                fn();
+            }
+            catch (const std::exception& e) {
+                items[i].ok = false;
+                spdlog::error("Exception while {} {}: {}", what, std::string(paths[i].begin(), paths[i].end()), e.what());
+            }
+        };
+
+        // ファイルの読み込みは先に全部 AsyncIo へ投げておき、届いたものから解析する
+        std::vector<std::future<VfsReadResult>> reads;
+        if (!sources) {
+            reads.reserve(count);
+            for (uint32_t i = 0; i < count; ++i) reads.push_back(Vfs::Get().ReadAsync(paths[i]));
+        }
+
+        // 1) ヘッダ解析（並列）。DDS/KTX2 と、無圧縮 RGBA8 / RGBA16F になるものはアップロードバッファへ直接書く
+        const bool uncompressed = m_compression.format == BCFormat::None;
+        JobSystem::Get().ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) guarded(i, "reading", [&] {
+                Source_& it = items[i];
+                if (sources) {
+                    it.bytes = std::move((*sources)[i]);
+                    it.ok = !it.bytes.empty();
+                } else {
+                    // 圧縮エントリの展開ジョブが同じワーカーに積まれていることがあるので、手伝いながら待つ
+                    VfsReadResult read = JobSystem::Get().Wait(reads[i]);
+                    it.ok = read.ok;
+                    it.bytes = std::move(read.data);
+                }
+                if (!it.ok) {
+                    spdlog::error("Failed to read file: {}", std::string(paths[i].begin(), paths[i].end()));
+                    return;
+                }
+                const ContainerFormat container = DetectContainer(it.bytes.data(), it.bytes.size());
+                if (container != ContainerFormat::None) {
+                    // DDS/KTX2 は格納済みのサブリソースを直接書く。扱えない DDS は DirectXTex 経由
+                    it.container = true;
+                    it.direct = ReadContainerInfo(it.bytes.data(), it.bytes.size(), GetTranscodeTarget_(), it.containerInfo);
+                    if (!it.direct && container == ContainerFormat::KTX2) {
+                        it.ok = false;
+                        spdlog::error("Unsupported KTX2 file: {}", std::string(paths[i].begin(), paths[i].end()));
+                    }
+                    return;
+                }
+                if (DetectHdrFormat(it.bytes.data(), it.bytes.size()) != HdrFormat::None) {
+                    // HDR は 8bit デコーダ（TGA の緩い判定）に渡る前に振り分ける
+                    it.hdr = true;
+                    it.ok = ReadHdrInfo(it.bytes.data(), it.bytes.size(), it.info);
+                    if (!it.ok) spdlog::error("Invalid HDR header: {}", std::string(paths[i].begin(), paths[i].end()));
+                    it.direct = !m_hdrBC6H;
+                    return;
+                }
+                const IImageDecoder* dec = uncompressed ? ImageDecoderRegistry::Get().Find(it.bytes.data(), it.bytes.size()) : nullptr;
+                if (dec && dec->ReadInfo(it.bytes.data(), it.bytes.size(), it.info)) {
+                    it.decoder = dec;
+                    it.direct = true;
+                }
+            });
+        });
+
+        // 2) 直書き分のテクスチャとアップロードバッファを作ってマップ（デバイス操作は呼び出しスレッドで）
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (uint32_t i = 0; i < count; ++i) {
+            Source_& it = items[i];
+            if (!it.ok || !it.direct) continue;
+            if (it.container) {
+                it.ok = CreateContainerStaging_(dev, it.containerInfo, forceSRGB, it.staging);
+                continue;
+            }
+            const DXGI_FORMAT format = it.hdr ? DXGI_FORMAT_R16G16B16A16_FLOAT
+                                     : forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+            if (!CreateDirectStaging_(dev, it.info, format, generateMips, it.staging)) {
+                it.direct = false; // ScratchImage 経由にフォールバック
+                it.staging = Staging_{};
+            }
+        }
+
+        lock.unlock();
+
+        // 3) デコード・ミップ生成・圧縮（並列。ミップ生成/圧縮内部の ParallelFor とは入れ子で動く）
+        JobSystem::Get().ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) guarded(i, "decoding", [&] {
+                Source_& it = items[i];
+                if (!it.ok) return;
+                if (it.container && it.direct) {
+                    it.ok = LoadContainerToStaging_(it.bytes, it.staging);
+                    if (!it.ok) spdlog::error("Failed to load texture container: {}", std::string(paths[i].begin(), paths[i].end()));
+                } else if (it.hdr) {
+                    it.ok = it.direct ? DecodeHdrToStaging_(it.bytes, it.staging)
+                                      : DecodeHdrToScratch_(paths[i], it.bytes, generateMips, it.scratch);
+                } else {
+                    it.ok = it.direct ? DecodeToStaging_(it.bytes, *it.decoder, forceSRGB, it.staging)
+                                      : DecodeToScratch_(paths[i], it.bytes, forceSRGB, generateMips, it.scratch);
+                }
+                if (!it.ok && it.direct && !it.container) {
+                    spdlog::error("{} decoder failed: {}", it.hdr ? HdrFormatName(DetectHdrFormat(it.bytes.data(), it.bytes.size())) : it.decoder->Name(),
+                                  std::string(paths[i].begin(), paths[i].end()));
+                }
+                it.bytes = {};
+            });
+        });
+    }
+
+    size_t TextureLoader::LoadSources_(ID3D12Device* dev,
+                                       ID3D12GraphicsCommandList* cmd,
+                                       const std::vector<std::wstring>& paths,
+                                       std::vector<std::vector<uint8_t>>* sources,
+                                       std::vector<TextureHandle>& out,
+                                       bool forceSRGB,
+                                       bool generateMips)
+    {
+        std::vector<Source_> items;
+        PrepareSources_(dev, paths, sources, items, forceSRGB, generateMips);
+        out.assign(paths.size(), TextureHandle{});
+
+        // 4) コピー記録とスロット確保は呼び出しスレッドで順に行う。
+        //    複数スレッドが同じコマンドリストへ同時に積めるよう、記録中はローダを占有する
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t loaded = 0;
+        for (uint32_t i = 0; i < (uint32_t)items.size(); ++i) {
+            Source_& it = items[i];
+            if (!it.ok) continue;
+            try {
+                it.ok = it.direct ? CommitStaging_(dev, cmd, it.staging, forceSRGB, out[i], /*replace=*/false)
+                                  : UploadScratch_(dev, cmd, it.scratch, forceSRGB, out[i]);
+            }
+            catch (const std::exception& e) {
+                it.ok = false;
+                spdlog::error("Exception while uploading {}: {}", std::string(paths[i].begin(), paths[i].end()), e.what());
+            }
+            if (it.ok) ++loaded;
+            it.scratch.Release();
+        }
+        spdlog::info("LoadBatch: {}/{} textures loaded", loaded, paths.size());
+        return loaded;
+    }
+
+    std::shared_ptr<TextureLoader::PendingReload> TextureLoader::PrepareReload(ID3D12Device* dev,
+                                                                               std::vector<uint8_t> bytes,
+                                                                               const std::wstring& name,
+                                                                               bool forceSRGB,
+                                                                               bool generateMips)
+    {
+        std::vector<std::vector<uint8_t>> sources(1);
+        sources[0] = std::move(bytes);
+        std::vector<Source_> items;
+        PrepareSources_(dev, { name }, &sources, items, forceSRGB, generateMips);
+        Source_& it = items[0];
+        if (!it.ok) return nullptr;
+
+        // ScratchImage 経由のものもここでアップロードバッファへ書いておき、コミット側はコピー記録だけにする
+        auto pending = std::make_shared<PendingReload>();
+        pending->forceSRGB = forceSRGB;
+        if (it.direct) {
+            pending->staging = std::move(it.staging);
+        } else {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!ScratchToStaging_(dev, it.scratch, pending->staging)) return nullptr;
+        }
+        return pending;
+    }
+
+    bool TextureLoader::CommitReload(ID3D12Device* dev,
+                                     ID3D12GraphicsCommandList* cmd,
+                                     PendingReload& pending,
+                                     TextureHandle& handle,
+                                     DeferredReleaseQueue& retired,
+                                     uint64_t retireFence)
+    {
+        if (!pending.staging.texture || !pending.staging.mapped) return false;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Microsoft::WRL::ComPtr<ID3D12Resource> previous = handle.resource;
+        if (!CommitStaging_(dev, cmd, pending.staging, pending.forceSRGB, handle, /*replace=*/true)) return false;
+
+        // 古いリソースと外した側の SRV は GPU が retireFence を過ぎてから返す（それまでこのスロットは読み直さない）。
+        // 通し番号は、その間にスロットが解放・再利用されて読み直されたときに新しい印を消さないため
+        const uint32_t slot = handle.slot;
+        if (++m_reloadSerial == 0) ++m_reloadSerial;
+        const uint32_t serial = m_reloadSerial;
+        m_retiring[slot] = serial;
+        if (previous) retired.Retire(retireFence, std::move(previous));
+        retired.Defer(retireFence, [this, slot, serial]() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_retiring[slot] == serial) m_retiring[slot] = 0;
+        });
+        return true;
+    }
+
+    bool TextureLoader::CanCommitReload(uint32_t slot) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return IsValidSlot(slot) && m_used[slot] && m_retiring[slot] == 0;
     }
 
 }
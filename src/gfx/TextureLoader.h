@@ -3,15 +3,36 @@
 #include <d3d12.h>
 #include <wrl/client.h>
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
+#include <mutex>
+#include "core/DeferredReleaseQueue.h"
+#include "gfx/BCEncoder.h"
+#include "gfx/MipGenerator.h"
+#include "gfx/TextureContainer.h"
+#include "gfx/TextureSlices.h"
+
+namespace DirectX { class ScratchImage; }
 
 namespace jisaku
 {
+    struct ImageInfo;
+    class IImageDecoder;
+
+    // 1 リソースに複数スライスを持つテクスチャの種類（SRV の次元もこれで決まる）
+    enum class TextureDimension : uint8_t
+    {
+        Texture2D,
+        Array,  // Texture2DArray
+        Cube,   // 6 の倍数枚。6 枚を超えると TextureCubeArray
+        Volume, // Texture3D（スライスは奥行き方向）
+    };
+
     struct TextureHandle
     {
         Microsoft::WRL::ComPtr<ID3D12Resource> resource; // default heap
-        D3D12_CPU_DESCRIPTOR_HANDLE srvCPU{};
+        D3D12_CPU_DESCRIPTOR_HANDLE srvCPU{}; // 作成時の SRV。読み直すとスロットのもう片側へ移る（描画では GetSrvGpu(slot)）
         D3D12_GPU_DESCRIPTOR_HANDLE srvGPU{};
         uint32_t slot = UINT32_MAX; // SRVヒープ内スロット
     };
@@ -23,7 +44,9 @@ namespace jisaku
         TextureHandle CreateCheckerboard(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd,
                                          uint32_t size = 256, uint32_t cell = 32);
         
-        // 追加: 外部画像ファイルを読み込んで out にSRVを上書き
+        // 追加: 外部画像ファイルを読み込んで out にSRVを上書き。
+        // DDS/KTX2 は格納済みのミップ・形式のままアップロードする（generateMips と圧縮設定は使わない。
+        // KTX2 の Basis Universal は圧縮設定が BC1 なら BC1、それ以外は BC7 に変換する）
         bool LoadFromFile(ID3D12Device* dev,
                           ID3D12GraphicsCommandList* cmd,
                           const std::wstring& path,
@@ -31,8 +54,99 @@ namespace jisaku
                           bool forceSRGB = true,
                           bool generateMips = true);
 
+        // 複数ファイルをまとめて読み込む。デコード〜ミップ生成〜圧縮は JobSystem で並列に行い、
+        // リソース生成とコマンド記録は呼び出しスレッドで順に行う。
+        // out は paths と同じ並びで、失敗したものは無効ハンドル（slot == UINT32_MAX）のまま。戻り値は成功数
+        size_t LoadBatch(ID3D12Device* dev,
+                         ID3D12GraphicsCommandList* cmd,
+                         const std::vector<std::wstring>& paths,
+                         std::vector<TextureHandle>& out,
+                         bool forceSRGB = true,
+                         bool generateMips = true);
+
+        // メモリ上のファイルイメージから読み込む（name はログ用）
+        bool LoadFromMemory(ID3D12Device* dev,
+                            ID3D12GraphicsCommandList* cmd,
+                            std::vector<uint8_t> bytes,
+                            const std::wstring& name,
+                            /*inout*/ TextureHandle& out,
+                            bool forceSRGB = true,
+                            bool generateMips = true);
+
+        // 複数画像を 1 つの配列/キューブ/ボリュームテクスチャとして読み込む（全スライス同サイズ）。
+        // デコードとスライスごとのミップ生成は JobSystem で並列に行い、全サブリソースを 1 回でアップロードする。
+        // ブロック圧縮設定はこの経路では使わない（RGBA8 のまま）
+        bool LoadSlices(ID3D12Device* dev,
+                        ID3D12GraphicsCommandList* cmd,
+                        const std::vector<std::wstring>& paths,
+                        TextureDimension dim,
+                        /*inout*/ TextureHandle& out,
+                        bool forceSRGB = true,
+                        bool generateMips = true);
+
+        // 十字/帯状の展開図 1 枚からキューブマップを作る
+        bool LoadCubeFromLayout(ID3D12Device* dev,
+                                ID3D12GraphicsCommandList* cmd,
+                                const std::wstring& path,
+                                CubeLayout layout,
+                                /*inout*/ TextureHandle& out,
+                                bool forceSRGB = true,
+                                bool generateMips = true);
+
+        // cols x rows 格子のシート（アニメーション等）を行優先で配列テクスチャにする
+        bool LoadArrayFromGrid(ID3D12Device* dev,
+                               ID3D12GraphicsCommandList* cmd,
+                               const std::wstring& path,
+                               uint32_t cols,
+                               uint32_t rows,
+                               /*inout*/ TextureHandle& out,
+                               bool forceSRGB = true,
+                               bool generateMips = true);
+
+        // 外部で作ったリソース（アトラスページ等）にスロットを割り当てて SRV を作る
+        bool RegisterTexture(ID3D12Device* dev,
+                             const Microsoft::WRL::ComPtr<ID3D12Resource>& resource,
+                             const D3D12_SHADER_RESOURCE_VIEW_DESC& srv,
+                             /*out*/ TextureHandle& out);
+
+        // SRV スロットを返却してハンドルを空にする。GPU がもう参照していないことを呼び出し側で保証すること
+        void ReleaseTexture(TextureHandle& h);
+
+        // ホットリロード用の 2 段階読み込み（TextureReloader が使う）。
+        // PrepareReload は任意スレッドから呼べて、デコード〜アップロードバッファへの書き込みまでを行う（失敗時は nullptr）。
+        // CommitReload はコマンドリストを持つスレッドで呼び、コピーを記録して新しいリソースの SRV をスロットのもう片側へ作る
+        // （スロット番号はそのまま。GPU が読んでいるかもしれない今の SRV は書き換えないので、GPU を待たずに呼べる）。
+        // 古いリソースと、それを指していた側の SRV は retireFence を付けて retired へ預ける。
+        // 前回の読み直しで外した側がまだ返っていないスロットは差し替えられない（CanCommitReload が false）
+        struct PendingReload;
+        std::shared_ptr<PendingReload> PrepareReload(ID3D12Device* dev,
+                                                     std::vector<uint8_t> bytes,
+                                                     const std::wstring& name,
+                                                     bool forceSRGB = true,
+                                                     bool generateMips = true);
+        bool CommitReload(ID3D12Device* dev,
+                          ID3D12GraphicsCommandList* cmd,
+                          PendingReload& pending,
+                          /*inout*/ TextureHandle& handle,
+                          DeferredReleaseQueue& retired,
+                          uint64_t retireFence);
+        bool CanCommitReload(uint32_t slot) const;
+
         ID3D12DescriptorHeap* GetSrvHeap() const;
-        void FlushUploads();
+        // slot の今の SRV（読み直しで差し替わる）
+        D3D12_GPU_DESCRIPTOR_HANDLE GetSrvGpu(uint32_t slot) const;
+        // 読み込みで使ったアップロードバッファを retired へ預ける。retireFence はコピーを積んだ提出の後に Signal される値
+        void FlushUploads(DeferredReleaseQueue& retired, uint64_t retireFence);
+
+        // LoadFromFile で読み込んだテクスチャのブロック圧縮設定（BCFormat::None で無圧縮）
+        void SetCompression(BCFormat format, BCQuality quality = BCQuality::Fast) { m_compression.format = format; m_compression.quality = quality; }
+        const BCEncodeOptions& GetCompression() const { return m_compression; }
+        // generateMips=true 時のミップ生成フィルタ
+        void SetMipFilter(MipFilter filter) { m_mipFilter = filter; }
+        MipFilter GetMipFilter() const { return m_mipFilter; }
+        // HDR 画像（.hdr/.exr）を BC6H に圧縮するか。false なら RGBA16F のまま
+        void SetHdrCompression(bool bc6h) { m_hdrBC6H = bc6h; }
+        bool GetHdrCompression() const { return m_hdrBC6H; }
 
         // 追加API
         uint32_t GetDescriptorSize() const { return m_srvInc; }
@@ -45,9 +159,71 @@ namespace jisaku
         uint32_t m_capacity = 0;
         std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_pendingUploads;
         std::vector<bool> m_used;
+        // ヒープは 2 面あり、スロット s の SRV は s か s + m_capacity のどちらか（m_side）に入っている。
+        // m_retiring は読み直しで外した側がまだ GPU に読まれているかもしれないスロット（0 以外。CommitReload の通し番号）
+        std::vector<uint8_t> m_side;
+        std::vector<uint32_t> m_retiring;
+        uint32_t m_reloadSerial = 0;
+        mutable std::mutex m_mutex; // スロット・保留アップロード・コマンド記録の排他（読み込みは複数スレッドから呼べる）
+        BCEncodeOptions m_compression;
+        MipFilter m_mipFilter = MipFilter::Kaiser;
+        bool m_hdrBC6H = false;
+
+        // マップ済みアップロードバッファと各サブリソースのフットプリント。
+        // CPU 側はここへ直接書き込み、CommitStaging_ でコピーを記録する
+        struct Staging_
+        {
+            Microsoft::WRL::ComPtr<ID3D12Resource> texture;
+            Microsoft::WRL::ComPtr<ID3D12Resource> upload;
+            std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts;
+            std::vector<UINT> numRows;
+            std::vector<UINT64> rowSizes;
+            uint8_t* mapped = nullptr;
+            TextureDimension dim = TextureDimension::Texture2D;
+        };
+
+        // CPU 側の処理のみ（任意スレッドから呼べる）
+        bool DecodeToScratch_(const std::wstring& path, const std::vector<uint8_t>& bytes, bool forceSRGB,
+                              bool generateMips, DirectX::ScratchImage& out) const;
+        bool DecodeToStaging_(const std::vector<uint8_t>& bytes, const IImageDecoder& decoder, bool forceSRGB,
+                              const Staging_& st) const;
+        bool DecodeToImage_(const std::wstring& path, Image& out) const;
+        // HDR: リニア float でミップを作り、RGBA16F で書き込む
+        bool DecodeHdrToStaging_(const std::vector<uint8_t>& bytes, const Staging_& st) const;
+        bool DecodeHdrToScratch_(const std::wstring& path, const std::vector<uint8_t>& bytes, bool generateMips,
+                                 DirectX::ScratchImage& out) const;
+        // DDS/KTX2: サブリソースをそのまま（Basis は変換して）フットプリントへ書き込む
+        bool LoadContainerToStaging_(const std::vector<uint8_t>& bytes, const Staging_& st) const;
+        TranscodeTarget GetTranscodeTarget_() const { return m_compression.format == BCFormat::BC1 ? TranscodeTarget::BC1 : TranscodeTarget::BC7; }
+        // GPU リソース生成・コピー記録・SRV 作成（コマンドリストを持つスレッドから呼ぶ）
+        bool CreateStaging_(ID3D12Device* dev, Microsoft::WRL::ComPtr<ID3D12Resource> texture, Staging_& st);
+        bool CreateDirectStaging_(ID3D12Device* dev, const ImageInfo& info, DXGI_FORMAT format, bool generateMips, Staging_& st);
+        bool CreateContainerStaging_(ID3D12Device* dev, const ContainerInfo& info, bool forceSRGB, Staging_& st);
+        // replace: out のスロットのもう片側へ SRV を作る（新しいスロットは確保しない）
+        bool CommitStaging_(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd, Staging_& st, bool forceSRGB, TextureHandle& out,
+                            bool replace);
+        bool ScratchToStaging_(ID3D12Device* dev, const DirectX::ScratchImage& image, Staging_& st);
+        bool UploadScratch_(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd,
+                            const DirectX::ScratchImage& image, bool forceSRGB, TextureHandle& out);
+        bool UploadSlices_(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd, const std::vector<Image>& slices,
+                           TextureDimension dim, bool forceSRGB, bool generateMips, TextureHandle& out);
+        // m_mutex を保持した状態で呼ぶ
+        bool CreateSrv_(ID3D12Device* dev, const Microsoft::WRL::ComPtr<ID3D12Resource>& resource,
+                        const D3D12_SHADER_RESOURCE_VIEW_DESC& srv, TextureHandle& out, bool replace);
+        // 1 ファイル分の読み込み状態（LoadSources_ / PrepareReload）
+        struct Source_;
+        // 読み込み・解析・アップロードバッファ確保・デコードまで（任意スレッド）。items は paths と同じ並びになる
+        void PrepareSources_(ID3D12Device* dev, const std::vector<std::wstring>& paths,
+                             std::vector<std::vector<uint8_t>>* sources, std::vector<Source_>& items,
+                             bool forceSRGB, bool generateMips);
+        // sources が null ならファイルから読む。非 null なら paths と同じ並びのファイルイメージ（中身は移動される）
+        size_t LoadSources_(ID3D12Device* dev, ID3D12GraphicsCommandList* cmd,
+                            const std::vector<std::wstring>& paths, std::vector<std::vector<uint8_t>>* sources,
+                            std::vector<TextureHandle>& out, bool forceSRGB, bool generateMips);
 
         uint32_t AllocateSlot_();
-        D3D12_CPU_DESCRIPTOR_HANDLE CpuHandleOf_(uint32_t slot) const;
-        D3D12_GPU_DESCRIPTOR_HANDLE GpuHandleOf_(uint32_t slot) const;
+        // ヒープ内の位置（side: スロットのどちらの面か）
+        D3D12_CPU_DESCRIPTOR_HANDLE CpuHandleOf_(uint32_t slot, uint8_t side = 0) const;
+        D3D12_GPU_DESCRIPTOR_HANDLE GpuHandleOf_(uint32_t slot, uint8_t side = 0) const;
     };
 }
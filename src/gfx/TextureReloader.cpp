@@ -0,0 +1,184 @@
+#include "gfx/TextureReloader.h"
+#include "core/JobSystem.h"
+#include "core/Vfs.h"
+#include <spdlog/spdlog.h>
+#include <iterator>
+
+namespace jisaku
+{
+    TextureReloader::TextureReloader(TextureLoader& loader, ID3D12Device* dev, const HotReloadScheduler::Config& config)
+        : m_loader(loader)
+        , m_dev(dev)
+        , m_scheduler(config)
+    {
+    }
+
+    TextureReloader::~TextureReloader()
+    {
+        // ジョブは this を参照しているので、全部戻ってくるまで待つ
+        std::unique_lock<std::mutex> lock(m_readyMutex);
+        m_idle.wait(lock, [this] { return m_inFlight == 0; });
+    }
+
+    uint64_t TextureReloader::add_(const std::wstring& path, Watch_ watch)
+    {
+        const uint64_t id = m_nextId++;
+        watch.path = path;
+        m_scheduler.Add(id, std::filesystem::path(path));
+        m_watches.emplace(id, std::move(watch));
+        return id;
+    }
+
+    void TextureReloader::Watch(const std::wstring& path, TextureHandle& handle, bool forceSRGB, bool generateMips)
+    {
+        Watch_ w;
+        w.handle = &handle;
+        w.forceSRGB = forceSRGB;
+        w.generateMips = generateMips;
+        add_(path, std::move(w));
+    }
+
+    void TextureReloader::Watch(const std::wstring& path, TextureCache& cache, const TexturePtr& texture,
+                                bool forceSRGB, bool generateMips)
+    {
+        if (!texture) return;
+        // 同じハンドルを二重に監視しない（キャッシュヒットで同じものが返ってくる）
+        for (auto& [id, w] : m_watches) {
+            if (w.cache && w.owner.lock() == texture) return;
+        }
+        Watch_ w;
+        w.cache = &cache;
+        w.owner = texture;
+        w.forceSRGB = forceSRGB;
+        w.generateMips = generateMips;
+        add_(path, std::move(w));
+    }
+
+    void TextureReloader::Unwatch(const TextureHandle& handle)
+    {
+        for (auto it = m_watches.begin(); it != m_watches.end();) {
+            const Watch_& w = it->second;
+            const TextureHandle* target = w.cache ? w.owner.lock().get() : w.handle;
+            if (target == &handle) {
+                // 読み直し中のものは結果が戻ってきたときに捨てる
+                m_scheduler.Remove(it->first);
+                it = m_watches.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    size_t TextureReloader::Invalidate(const std::wstring& path)
+    {
+        const std::filesystem::path key = std::filesystem::path(path).lexically_normal();
+        size_t count = 0;
+        for (const auto& [id, w] : m_watches) {
+            if (std::filesystem::path(w.path).lexically_normal() != key) continue;
+            m_scheduler.Invalidate(id);
+            ++count;
+        }
+        return count;
+    }
+
+    void TextureReloader::Tick(double dt)
+    {
+        m_time += dt;
+
+        // 参照が切れたキャッシュのハンドルは監視をやめる
+        for (auto it = m_watches.begin(); it != m_watches.end();) {
+            if (it->second.cache && it->second.owner.expired()) {
+                m_scheduler.Remove(it->first);
+                it = m_watches.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        for (uint64_t id : m_scheduler.Update(m_time)) {
+            const Watch_& w = m_watches.at(id);
+            spdlog::info("Texture changed, reloading: {}", std::string(w.path.begin(), w.path.end()));
+            {
+                std::lock_guard<std::mutex> lock(m_readyMutex);
+                ++m_inFlight;
+            }
+            JobSystem::Get().Submit([this, id, path = w.path, forceSRGB = w.forceSRGB, generateMips = w.generateMips]() {
+                Ready_ ready;
+                ready.id = id;
+                try {
+                    std::vector<uint8_t> bytes;
+                    if (Vfs::Get().ReadFile(path, bytes))
+                        ready.pending = m_loader.PrepareReload(m_dev, std::move(bytes), path, forceSRGB, generateMips);
+                }
+                catch (const std::exception& e) {
+                    spdlog::error("Exception while reloading {}: {}", std::string(path.begin(), path.end()), e.what());
+                }
+                std::lock_guard<std::mutex> lock(m_readyMutex);
+                m_ready.push_back(std::move(ready));
+                --m_inFlight;
+                m_idle.notify_all();
+            });
+        }
+    }
+
+    bool TextureReloader::HasReady() const
+    {
+        std::lock_guard<std::mutex> lock(m_readyMutex);
+        return !m_ready.empty();
+    }
+
+    size_t TextureReloader::Apply(ID3D12GraphicsCommandList* cmd, DeferredReleaseQueue& retired, uint64_t retireFence)
+    {
+        std::vector<Ready_> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_readyMutex);
+            ready.swap(m_ready);
+        }
+
+        size_t applied = 0;
+        std::vector<Ready_> carried;
+        for (Ready_& r : ready) {
+            auto it = m_watches.find(r.id);
+            if (it == m_watches.end()) { // 読み直し中に Unwatch された
+                m_scheduler.Complete(r.id);
+                continue;
+            }
+            Watch_& w = it->second;
+            const std::string name(w.path.begin(), w.path.end());
+            TexturePtr owner = w.owner.lock();
+            if (w.cache ? !owner : !w.handle) {
+                m_scheduler.Complete(r.id);
+                continue;
+            }
+            if (r.pending && !m_loader.CanCommitReload(owner ? owner->slot : w.handle->slot)) {
+                // 前回の差し替えで外した SRV がまだ返っていない（GPU が読んでいるかもしれない）
+                carried.push_back(std::move(r));
+                continue;
+            }
+            m_scheduler.Complete(r.id);
+            if (!r.pending) {
+                // 書き出し途中などで読めなかった。次に変更されたときにまた試す
+                spdlog::warn("Texture reload failed, keeping previous version: {}", name);
+                continue;
+            }
+            bool committed = false;
+            if (w.cache) {
+                // 共有ハンドルはキャッシュの差し替え点を通す
+                committed = w.cache->CommitReload(m_dev, cmd, *r.pending, owner, retired, retireFence);
+            } else {
+                committed = m_loader.CommitReload(m_dev, cmd, *r.pending, *w.handle, retired, retireFence);
+            }
+            if (!committed) {
+                spdlog::warn("Texture reload failed, keeping previous version: {}", name);
+                continue;
+            }
+            spdlog::info("Texture reloaded: {} (slot {})", name, owner ? owner->slot : w.handle->slot);
+            ++applied;
+        }
+        if (!carried.empty()) {
+            std::lock_guard<std::mutex> lock(m_readyMutex);
+            m_ready.insert(m_ready.end(), std::make_move_iterator(carried.begin()), std::make_move_iterator(carried.end()));
+        }
+        return applied;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "core/DeferredReleaseQueue.h"
+#include "core/HotReloadScheduler.h"
+#include "gfx/TextureCache.h"
+#include "gfx/TextureLoader.h"
+
+namespace jisaku
+{
+    // 読み込み済みテクスチャの元画像を監視し、書き換えられたら作り直して同じスロットへ差し替える。
+    // - 変更の検出と発火タイミングは HotReloadScheduler（Tick で進める）
+    // - 読み直し・デコード・アップロードバッファへの書き込みは JobSystem のワーカーで行う
+    // - Apply でコピーを記録し、SRV をスロットのもう片側へ作る。スロット番号は変わらないので、
+    //   描画側が TextureLoader::GetSrvGpu(slot) で引いていれば何もしなくてよい。GPU を待つ必要もない
+    // - 置き換えた古いリソースと SRV は retireFence を付けて DeferredReleaseQueue へ預ける。
+    //   それが返る前に同じテクスチャがもう一度できあがったら、次の Apply まで持ち越す
+    // Tick / Apply / Watch / Unwatch はメインスレッドから呼ぶ
+    class TextureReloader
+    {
+    public:
+        TextureReloader(TextureLoader& loader, ID3D12Device* dev,
+                        const HotReloadScheduler::Config& config = HotReloadScheduler::Config{});
+        ~TextureReloader(); // 読み直し中のジョブの完了を待つ
+
+        TextureReloader(const TextureReloader&) = delete;
+        TextureReloader& operator=(const TextureReloader&) = delete;
+
+        // handle の元ファイルとして path を監視する。handle は Unwatch するまで生かしておくこと
+        void Watch(const std::wstring& path, TextureHandle& handle, bool forceSRGB = true, bool generateMips = true);
+        // TextureCache のハンドル。参照が無くなったら監視をやめる（キャッシュのキーは読み込み時の内容のまま）。
+        // 差し替えは cache の CommitReload を通す（共有ハンドルは書き換えない）
+        void Watch(const std::wstring& path, TextureCache& cache, const TexturePtr& texture,
+                   bool forceSRGB = true, bool generateMips = true);
+        void Unwatch(const TextureHandle& handle);
+        // path を監視しているものを、更新時刻を待たずに次の Tick で読み直す（クックサーバーからの Invalidate 等）。
+        // 戻り値は該当した監視の数
+        size_t Invalidate(const std::wstring& path);
+
+        // 変更が落ち着いたファイルの読み直しを JobSystem へ投げる
+        void Tick(double dt);
+        // 差し替えられるものがあるか
+        bool HasReady() const;
+        // 準備のできたものを cmd にコピー記録して差し替える（cmd はこのフレームの描画用でよい）。
+        // 古いリソースと SRV は retired へ預ける。retireFence はこの cmd を含む提出の後に Signal される値。戻り値は差し替えた数
+        size_t Apply(ID3D12GraphicsCommandList* cmd, DeferredReleaseQueue& retired, uint64_t retireFence);
+
+        size_t GetWatchCount() const { return m_watches.size(); }
+
+    private:
+        struct Watch_
+        {
+            std::wstring path;
+            TextureHandle* handle = nullptr;
+            TextureCache* cache = nullptr;            // TextureCache のハンドルのときのみ
+            std::weak_ptr<const TextureHandle> owner; // 同上
+            bool forceSRGB = true;
+            bool generateMips = true;
+        };
+        struct Ready_
+        {
+            uint64_t id = 0;
+            std::shared_ptr<TextureLoader::PendingReload> pending; // 失敗時は null
+        };
+
+        uint64_t add_(const std::wstring& path, Watch_ watch);
+
+        TextureLoader& m_loader;
+        ID3D12Device* m_dev = nullptr;
+        HotReloadScheduler m_scheduler;
+        std::unordered_map<uint64_t, Watch_> m_watches;
+        uint64_t m_nextId = 1;
+        double m_time = 0.0;
+
+        // ワーカーから返ってくる結果
+        mutable std::mutex m_readyMutex;
+        std::condition_variable m_idle;
+        std::vector<Ready_> m_ready;
+        uint32_t m_inFlight = 0;
+    };
+}
@@ -0,0 +1,171 @@
+#include "gfx/TextureSlices.h"
+#include "core/JobSystem.h"
+#include "core/StreamingCopy.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+using namespace jisaku;
+
+namespace {
+
+void CopyRows(const ConstImageView& src, const ImageView& dst, bool streaming) {
+    const size_t rowBytes = size_t(src.width) * 4;
+    for (uint32_t y = 0; y < src.height; ++y) {
+        if (streaming) StreamCopy(dst.Row(y), src.Row(y), rowBytes);
+        else std::memcpy(dst.Row(y), src.Row(y), rowBytes);
+    }
+    if (streaming) StreamFence();
+}
+
+// src の (x0, y0) から size x size を切り出す。rotate180 なら上下左右を反転して格納
+void CopyFace(const ConstImageView& src, uint32_t x0, uint32_t y0, uint32_t size, bool rotate180, Image& out) {
+    out.Allocate(size, size);
+    const ImageView dst = out.View();
+    for (uint32_t y = 0; y < size; ++y) {
+        const uint8_t* s = src.Row(y0 + (rotate180 ? size - 1 - y : y)) + size_t(x0) * 4;
+        uint8_t* d = dst.Row(y);
+        if (!rotate180) {
+            std::memcpy(d, s, size_t(size) * 4);
+        } else {
+            for (uint32_t x = 0; x < size; ++x) std::memcpy(d + size_t(x) * 4, s + size_t(size - 1 - x) * 4, 4);
+        }
+    }
+}
+
+} // namespace
+
+bool jisaku::ExtractCubeFaces(const ConstImageView& src, CubeLayout layout, std::vector<Image>& faces) {
+    if (!src.data || src.width == 0 || src.height == 0) return false;
+    if (layout == CubeLayout::Auto) {
+        if (src.width * 3 == src.height * 4) layout = CubeLayout::HorizontalCross;
+        else if (src.width * 4 == src.height * 3) layout = CubeLayout::VerticalCross;
+        else if (src.width == src.height * 6) layout = CubeLayout::HorizontalStrip;
+        else if (src.width * 6 == src.height) layout = CubeLayout::VerticalStrip;
+        else return false;
+    }
+
+    // 各面の格子位置（+X, -X, +Y, -Y, +Z, -Z）
+    struct Cell { uint32_t col, row; bool rotate180; };
+    Cell cells[6];
+    uint32_t cols = 0, rows = 0;
+    switch (layout) {
+    case CubeLayout::HorizontalCross:
+        cols = 4; rows = 3;
+        cells[0] = { 2, 1, false }; cells[1] = { 0, 1, false }; cells[2] = { 1, 0, false };
+        cells[3] = { 1, 2, false }; cells[4] = { 1, 1, false }; cells[5] = { 3, 1, false };
+        break;
+    case CubeLayout::VerticalCross:
+        cols = 3; rows = 4;
+        cells[0] = { 2, 1, false }; cells[1] = { 0, 1, false }; cells[2] = { 1, 0, false };
+        cells[3] = { 1, 2, false }; cells[4] = { 1, 1, false }; cells[5] = { 1, 3, true };
+        break;
+    case CubeLayout::HorizontalStrip:
+        cols = 6; rows = 1;
+        for (uint32_t i = 0; i < 6; ++i) cells[i] = { i, 0, false };
+        break;
+    case CubeLayout::VerticalStrip:
+        cols = 1; rows = 6;
+        for (uint32_t i = 0; i < 6; ++i) cells[i] = { 0, i, false };
+        break;
+    default:
+        return false;
+    }
+
+    const uint32_t size = src.width / cols;
+    if (size == 0 || src.width != size * cols || src.height != size * rows) return false;
+    faces.resize(6);
+    for (uint32_t i = 0; i < 6; ++i) CopyFace(src, cells[i].col * size, cells[i].row * size, size, cells[i].rotate180, faces[i]);
+    return true;
+}
+
+bool jisaku::SplitGrid(const ConstImageView& src, uint32_t cols, uint32_t rows, std::vector<Image>& slices) {
+    if (!src.data || cols == 0 || rows == 0 || src.width % cols != 0 || src.height % rows != 0) return false;
+    const uint32_t w = src.width / cols, h = src.height / rows;
+    slices.resize(size_t(cols) * rows);
+    for (uint32_t r = 0; r < rows; ++r) {
+        for (uint32_t c = 0; c < cols; ++c) {
+            Image& out = slices[size_t(r) * cols + c];
+            out.Allocate(w, h);
+            for (uint32_t y = 0; y < h; ++y)
+                std::memcpy(out.View().Row(y), src.Row(r * h + y) + size_t(c) * w * 4, size_t(w) * 4);
+        }
+    }
+    return true;
+}
+
+bool jisaku::GenerateSliceMips(const ConstImageView* slices, uint32_t sliceCount, const MipOptions& opt,
+                               const ImageView* dst, uint32_t levelCount) {
+    if (!slices || !dst || sliceCount == 0 || levelCount == 0) return false;
+
+    // スライス間で並列化し、1 スライス内の行分割はしない（入れ子にしても良いがスライス数で十分埋まる）
+    MipOptions sliceOpt = opt;
+    sliceOpt.parallel = sliceCount == 1 && opt.parallel;
+    std::atomic<bool> ok{ true };
+    JobSystem::Get().ParallelFor(sliceCount, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t s = begin; s < end; ++s) {
+            const ImageView* levels = dst + size_t(s) * levelCount;
+            if (levels[0].width != slices[s].width || levels[0].height != slices[s].height) {
+                ok = false;
+                continue;
+            }
+            CopyRows(slices[s], levels[0], opt.streamingStores);
+            if (levelCount > 1 && !GenerateMips(slices[s], sliceOpt, levels + 1, levelCount - 1)) ok = false;
+        }
+    });
+    return ok;
+}
+
+bool jisaku::GenerateVolumeMips(const ConstImageView* slices, uint32_t depth, const MipOptions& opt,
+                                const std::vector<std::vector<ImageView>>& dst) {
+    if (!slices || depth == 0 || dst.empty()) return false;
+    const uint32_t levelCount = (uint32_t)dst.size();
+    const uint32_t w = slices[0].width, h = slices[0].height;
+    for (uint32_t l = 0; l < levelCount; ++l) {
+        if (dst[l].size() != MipExtent(depth, l)) return false;
+    }
+
+    // 1) 各スライスを XY 方向だけ縮小（キャッシュ上に保持。ミップ 0 は元画像をそのまま使う）
+    MipOptions xyOpt = opt;
+    xyOpt.streamingStores = false;
+    xyOpt.parallel = false;
+    std::vector<std::vector<Image>> xy(depth);
+    std::atomic<bool> ok{ true };
+    JobSystem::Get().ParallelFor(depth, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t z = begin; z < end; ++z) {
+            if (slices[z].width != w || slices[z].height != h) { ok = false; continue; }
+            std::vector<Image>& levels = xy[z];
+            levels.resize(levelCount);
+            std::vector<ImageView> views;
+            for (uint32_t l = 1; l < levelCount; ++l) {
+                levels[l].Allocate(MipExtent(w, l), MipExtent(h, l));
+                views.push_back(levels[l].View());
+            }
+            if (!views.empty() && !GenerateMips(slices[z], xyOpt, views.data(), (uint32_t)views.size())) ok = false;
+        }
+    });
+    if (!ok) return false;
+
+    // 2) 奥行き方向: レベル l の z スライス j は、元スライス [j * depth / d, (j + 1) * depth / d) の平均
+    struct Job { uint32_t level, z; };
+    std::vector<Job> jobs;
+    for (uint32_t l = 0; l < levelCount; ++l)
+        for (uint32_t j = 0; j < (uint32_t)dst[l].size(); ++j) jobs.push_back({ l, j });
+    JobSystem::Get().ParallelFor((uint32_t)jobs.size(), 1, [&](uint32_t begin, uint32_t end) {
+        std::vector<ConstImageView> srcs;
+        for (uint32_t i = begin; i < end; ++i) {
+            const uint32_t l = jobs[i].level, j = jobs[i].z;
+            const uint32_t d = (uint32_t)dst[l].size();
+            const uint32_t z0 = uint32_t(uint64_t(j) * depth / d);
+            const uint32_t z1 = (std::max)(uint32_t(uint64_t(j + 1) * depth / d), z0 + 1);
+            srcs.clear();
+            for (uint32_t z = z0; z < z1; ++z) srcs.push_back(l == 0 ? slices[z] : ConstImageView(xy[z][l].View()));
+            if (srcs.size() == 1) {
+                CopyRows(srcs[0], dst[l][j], opt.streamingStores);
+            } else if (!AverageImages(srcs.data(), (uint32_t)srcs.size(), opt, dst[l][j])) {
+                ok = false;
+            }
+        }
+    });
+    return ok;
+}
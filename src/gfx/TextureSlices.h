@@ -0,0 +1,36 @@
+#pragma once
+#include "gfx/ImageData.h"
+#include "gfx/MipGenerator.h"
+#include <cstdint>
+#include <vector>
+
+namespace jisaku {
+
+// 配列・キューブ・ボリュームテクスチャ用のスライス処理（D3D 非依存）。
+// 面の順序は D3D のキューブ配列と同じ +X, -X, +Y, -Y, +Z, -Z。
+
+enum class CubeLayout : uint8_t {
+    Auto,            // 縦横比から判定（4:3 / 3:4 / 6:1 / 1:6）
+    HorizontalCross, // 4x3:   . +Y . .  /  -X +Z +X -Z  /  . -Y . .
+    VerticalCross,   // 3x4:   . +Y .  /  -X +Z +X  /  . -Y .  /  . -Z .（-Z は 180 度回転で格納）
+    HorizontalStrip, // 6x1:   +X -X +Y -Y +Z -Z
+    VerticalStrip,   // 1x6
+};
+
+// 展開図から 6 面を切り出す
+bool ExtractCubeFaces(const ConstImageView& src, CubeLayout layout, std::vector<Image>& faces);
+
+// cols x rows の格子に並んだシートを、左上から行優先で同サイズのスライスに分割する
+bool SplitGrid(const ConstImageView& src, uint32_t cols, uint32_t rows, std::vector<Image>& slices);
+
+// 各スライスのミップ 0..levelCount-1 を dst[slice * levelCount + level] に書く（D3D のサブリソース順）。
+// ミップ 0 は slices のコピー。スライス単位で JobSystem に分散する
+bool GenerateSliceMips(const ConstImageView* slices, uint32_t sliceCount, const MipOptions& opt,
+                       const ImageView* dst, uint32_t levelCount);
+
+// ボリューム（depth 枚のスライス）のミップを作る。dst[level] はレベル level の z スライス
+// （MipExtent(depth, level) 枚）。XY はスライスごとに縮小し、奥行き方向は箱フィルタで平均する
+bool GenerateVolumeMips(const ConstImageView* slices, uint32_t depth, const MipOptions& opt,
+                        const std::vector<std::vector<ImageView>>& dst);
+
+} // namespace jisaku
@@ -0,0 +1,369 @@
+// アセットビルドツール（D3D/Windows 非依存）。
+//   JisakuAssetBuild [オプション] <入力のファイルかディレクトリ（--root 基準）>...
+// - 入力ごとに「中身のハッシュ + ビルド設定 + ツールのバージョン」からキーを作り、
+//   コンテンツストア（--cache）に同じキーの出力があれば作り直さない
+// - 残りは自分自身を --worker で複数起動して並列に処理する（デコーダ等がプロセスごとに独立するので、
+//   1 つが落ちても他の出力は残る）
+// - 最後に仮想パス → 出力のマニフェストを書き出す（実行時は Vfs::MountManifest で読む）
+//
+// 入力の種類とクックの中身は tools/AssetCook.h を参照
+#include "tools/AssetCook.h"
+#include "core/AssetManifest.h"
+#include "core/ChildProcess.h"
+#include "core/JobSystem.h"
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+struct Options {
+    std::filesystem::path root = ".";
+    std::filesystem::path cache = ".assetcache";
+    std::filesystem::path manifest = "assets.jman";
+    CookOptions cook;
+    uint32_t jobs = 0; // 0 = hardware_concurrency
+    bool rehash = false; // 更新時刻・サイズのキャッシュを使わず全入力を読み直す
+    std::vector<std::string> inputs;
+};
+
+// 入力ファイル 1 つ
+struct Input {
+    std::filesystem::path path; // OS のパス
+    std::string name;           // 仮想パス（--root 基準、'/' 区切り）
+    AssetKind kind = AssetKind::Copy;
+    ContentKey hash;            // 中身のハッシュ
+    bool ok = false;
+};
+
+// 出力 1 つ（シェーダーは 1 入力から複数）
+struct Job {
+    size_t input = 0;
+    AssetKind kind = AssetKind::Copy;
+    std::string settings; // "k=v;k=v"。キーに含める
+    std::string name;     // マニフェストに載せる仮想パス
+    ContentKey key;
+    uint64_t size = 0;
+    bool ok = false;
+};
+
+std::string Lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// ワーカー側の処理
+// ---------------------------------------------------------------------------
+
+// 標準入力から "<キー>\t<種類>\t<設定>\t<入力パス>" を 1 行ずつ受け取り、
+// "ok <サイズ>" か "fail <理由>" を標準出力へ返す
+int RunWorker(const Options& opt) {
+    // 標準出力はやり取りに使うので、ログは標準エラーへ
+    spdlog::set_default_logger(spdlog::stderr_color_st("worker"));
+    const std::filesystem::path objects = opt.cache / "objects";
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        std::string_view fields[4];
+        std::string_view rest = line;
+        for (int i = 0; i < 3; ++i) {
+            const size_t tab = rest.find('\t');
+            fields[i] = rest.substr(0, tab);
+            rest = tab == std::string_view::npos ? std::string_view() : rest.substr(tab + 1);
+        }
+        fields[3] = rest;
+
+        ContentKey key;
+        AssetKind kind;
+        uint64_t size = 0;
+        std::string error;
+        if (!ContentKey::FromHex(fields[0], key) || !ParseKind(fields[1], kind)) {
+            error = "bad request";
+        } else {
+            CookOne(objects, key, kind, std::string(fields[2]), FromUtf8(fields[3]), /*parallel=*/false, size, error);
+        }
+        if (error.empty()) std::cout << "ok " << size << '\n' << std::flush;
+        else std::cout << "fail " << error << '\n' << std::flush;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// 入力の列挙とハッシュ
+// ---------------------------------------------------------------------------
+
+// 更新時刻・サイズが前回と同じ入力はハッシュを再利用する（<cache>/inputs.txt）
+struct StatEntry {
+    int64_t time = 0;
+    uint64_t size = 0;
+    ContentKey hash;
+};
+
+std::unordered_map<std::string, StatEntry> LoadStatCache(const std::filesystem::path& file) {
+    std::unordered_map<std::string, StatEntry> out;
+    std::ifstream in(file, std::ios::binary);
+    std::string line;
+    while (std::getline(in, line)) {
+        // <更新時刻> <サイズ> <ハッシュ> <仮想パス>
+        StatEntry e;
+        std::istringstream ls(line);
+        std::string hex, name;
+        if (!(ls >> e.time >> e.size >> hex) || !ContentKey::FromHex(hex, e.hash)) continue;
+        ls.get();
+        std::getline(ls, name);
+        if (!name.empty()) out[name] = e;
+    }
+    return out;
+}
+
+void SaveStatCache(const std::filesystem::path& file, const std::vector<Input>& inputs,
+                   const std::vector<StatEntry>& stats) {
+    std::filesystem::path tmp = file;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if (!inputs[i].ok) continue;
+            out << stats[i].time << ' ' << stats[i].size << ' ' << stats[i].hash.ToHex() << ' ' << inputs[i].name << '\n';
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, file, ec);
+}
+
+bool CollectInputs(const Options& opt, std::vector<Input>& inputs) {
+    bool ok = true;
+    auto add = [&](const std::filesystem::path& path) {
+        Input in;
+        if (!ClassifyInput(path, in.kind)) return;
+        in.path = path;
+        in.name = ToUtf8(path.lexically_normal().lexically_relative(opt.root.lexically_normal()));
+        inputs.push_back(std::move(in));
+    };
+    for (const std::string& arg : opt.inputs) {
+        const std::filesystem::path path = opt.root / FromUtf8(arg);
+        std::error_code ec;
+        if (std::filesystem::is_directory(path, ec)) {
+            for (auto it = std::filesystem::recursive_directory_iterator(path, ec);
+                 !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec)) add(it->path());
+            }
+        } else if (std::filesystem::is_regular_file(path, ec)) {
+            add(path);
+        } else {
+            spdlog::error("Input not found: {}", ToUtf8(path));
+            ok = false;
+        }
+    }
+    // 同じファイルを 2 回指定されても 1 回にする
+    std::sort(inputs.begin(), inputs.end(), [](const Input& a, const Input& b) { return a.name < b.name; });
+    inputs.erase(std::unique(inputs.begin(), inputs.end(), [](const Input& a, const Input& b) { return a.name == b.name; }),
+                 inputs.end());
+    return ok;
+}
+
+void HashInputs(std::vector<Input>& inputs, const std::unordered_map<std::string, StatEntry>& cache,
+                std::vector<StatEntry>& stats) {
+    stats.assign(inputs.size(), StatEntry{});
+    JobSystem::Get().ParallelFor(uint32_t(inputs.size()), 8, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            Input& in = inputs[i];
+            StatEntry& st = stats[i];
+            st.time = WriteTime(in.path, st.size);
+            auto it = cache.find(in.name);
+            if (it != cache.end() && it->second.time == st.time && it->second.size == st.size && st.time != 0) {
+                st.hash = it->second.hash;
+                in.hash = st.hash;
+                in.ok = true;
+                continue;
+            }
+            if (!HashFile(in.path, st.hash)) continue;
+            in.hash = st.hash;
+            in.ok = true;
+        }
+    });
+}
+
+void ExpandJobs(const Options& opt, const std::vector<Input>& inputs, std::vector<Job>& jobs) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const Input& in = inputs[i];
+        if (!in.ok) continue;
+        for (CookOutput& out : ExpandOutputs(opt.cook, in.path, in.name, in.kind)) {
+            Job job;
+            job.input = i;
+            job.kind = in.kind;
+            job.key = MakeCookKey(in.kind, out.settings, in.hash);
+            job.settings = std::move(out.settings);
+            job.name = std::move(out.name);
+            jobs.push_back(std::move(job));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 親プロセス
+// ---------------------------------------------------------------------------
+
+// pending をワーカープロセスに配る。ワーカー 1 つにつきスレッド 1 本で、1 件ずつ投げて返事を待つ
+void RunWorkers(const Options& opt, const std::vector<Input>& inputs, std::vector<Job>& jobs,
+                const std::vector<size_t>& pending, uint32_t workerCount) {
+    const std::string exe = ToUtf8(ChildProcess::GetExecutablePath());
+    std::atomic<size_t> next{ 0 };
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < workerCount; ++w) {
+        threads.emplace_back([&, w]() {
+            std::unique_ptr<ChildProcess> worker = ChildProcess::Spawn(
+                { exe, "--worker", "--cache", ToUtf8(opt.cache) }, true);
+            if (!worker) {
+                spdlog::error("Failed to start worker {}", w);
+                return;
+            }
+            std::string reply;
+            for (size_t i = next++; i < pending.size(); i = next++) {
+                Job& job = jobs[pending[i]];
+                const std::string request = job.key.ToHex() + '\t' + KindName(job.kind) + '\t' + job.settings + '\t' +
+                                            ToUtf8(std::filesystem::absolute(inputs[job.input].path));
+                if (!worker->WriteLine(request) || !worker->ReadLine(reply)) {
+                    spdlog::error("Worker {} exited while building {}", w, job.name);
+                    return; // 残りは他のワーカーが拾う
+                }
+                if (reply.rfind("ok ", 0) == 0) {
+                    job.size = std::stoull(reply.substr(3));
+                    job.ok = true;
+                } else {
+                    spdlog::error("{}: {}", job.name, reply.rfind("fail ", 0) == 0 ? reply.substr(5) : reply);
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+}
+
+int RunBuild(const Options& opt) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    std::error_code ec;
+    const std::filesystem::path objects = opt.cache / "objects";
+    std::filesystem::create_directories(objects, ec);
+    if (ec) {
+        spdlog::error("Cannot create cache directory {}", ToUtf8(objects));
+        return 1;
+    }
+
+    std::vector<Input> inputs;
+    bool ok = CollectInputs(opt, inputs);
+    std::vector<StatEntry> stats;
+    const std::filesystem::path statFile = opt.cache / "inputs.txt";
+    HashInputs(inputs, opt.rehash ? std::unordered_map<std::string, StatEntry>() : LoadStatCache(statFile), stats);
+    for (const Input& in : inputs) {
+        if (!in.ok) {
+            spdlog::error("Cannot read {}", in.name);
+            ok = false;
+        }
+    }
+
+    std::vector<Job> jobs;
+    ExpandJobs(opt, inputs, jobs);
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const uintmax_t size = std::filesystem::file_size(ContentObjectPath(objects, jobs[i].key), ec);
+        if (!ec) {
+            jobs[i].size = uint64_t(size);
+            jobs[i].ok = true;
+        } else {
+            pending.push_back(i);
+        }
+    }
+    const size_t cached = jobs.size() - pending.size();
+
+    uint32_t workerCount = opt.jobs ? opt.jobs : std::max(1u, std::thread::hardware_concurrency());
+    workerCount = uint32_t(std::min<size_t>(workerCount, pending.size()));
+    if (workerCount > 0) RunWorkers(opt, inputs, jobs, pending, workerCount);
+
+    // 失敗したものはマニフェストに載せない（実行時は元のファイルを読む）
+    AssetManifest manifest;
+    const std::filesystem::path manifestDir = std::filesystem::absolute(opt.manifest).parent_path();
+    std::filesystem::path root = std::filesystem::absolute(objects).lexically_relative(manifestDir);
+    manifest.SetObjectRoot(root.empty() ? std::filesystem::absolute(objects) : root);
+    size_t failed = 0;
+    for (const Job& job : jobs) {
+        if (job.ok) manifest.Add(job.name, job.key, job.size);
+        else ++failed;
+    }
+    if (!manifest.Save(opt.manifest)) {
+        spdlog::error("Cannot write {}", ToUtf8(opt.manifest));
+        ok = false;
+    }
+    SaveStatCache(statFile, inputs, stats);
+
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    spdlog::info("{} outputs from {} inputs: {} cached, {} built, {} failed ({} workers, {:.1f} ms)",
+                 jobs.size(), inputs.size(), cached, pending.size() - failed, failed, workerCount, ms);
+    return ok && failed == 0 ? 0 : 1;
+}
+
+void PrintUsage() {
+    std::cerr <<
+        "usage: JisakuAssetBuild [options] <file or directory>...\n"
+        "  --root DIR         base directory for inputs and virtual paths (default .)\n"
+        "  --cache DIR        content-addressable store (default .assetcache)\n"
+        "  --manifest FILE    manifest to write (default assets.jman)\n"
+        "  --jobs N           worker processes (default: hardware threads)\n"
+        "  --dxc PATH         shader compiler (default dxc)\n"
+        "  --bc none|bc1|bc3|bc7, --bc-quality fast|high, --mip-filter box|kaiser|lanczos\n"
+        "  --rehash           ignore the timestamp cache and hash every input\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    bool worker = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (a == "--worker") worker = true;
+        else if (a == "--rehash") opt.rehash = true;
+        else if (a == "--root" && value(v)) opt.root = FromUtf8(v);
+        else if (a == "--cache" && value(v)) opt.cache = FromUtf8(v);
+        else if (a == "--manifest" && value(v)) opt.manifest = FromUtf8(v);
+        else if (a == "--dxc" && value(v)) opt.cook.dxc = v;
+        else if (a == "--jobs" && value(v)) opt.jobs = uint32_t(std::stoul(v));
+        else if (a == "--bc" && value(v)) opt.cook.bc = Lower(v);
+        else if (a == "--bc-quality" && value(v)) opt.cook.bcQuality = Lower(v);
+        else if (a == "--mip-filter" && value(v)) opt.cook.mipFilter = Lower(v);
+        else if (!a.empty() && a[0] != '-') opt.inputs.push_back(a);
+        else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (!opt.cook.IsValid()) {
+        PrintUsage();
+        return 2;
+    }
+    if (worker) return RunWorker(opt);
+    if (opt.inputs.empty()) {
+        PrintUsage();
+        return 2;
+    }
+    return RunBuild(opt);
+}
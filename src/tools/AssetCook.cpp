@@ -0,0 +1,306 @@
+#include "tools/AssetCook.h"
+#include "core/AtomicFile.h"
+#include "core/ChildProcess.h"
+#include "core/MappedFile.h"
+#include "gfx/BCEncoder.h"
+#include "gfx/ImageDecoder.h"
+#include "gfx/MipGenerator.h"
+#include "gfx/TextureContainer.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+
+using namespace jisaku;
+
+namespace {
+
+// シェーダーのステージ（エントリポイント名, プロファイル）
+constexpr const char* kShaderStages[][2] = { { "VSMain", "vs_6_0" }, { "PSMain", "ps_6_0" } };
+
+// DXGI_FORMAT の値（dxgiformat.h と同じ）
+constexpr uint32_t kDxgiRGBA8 = 28;
+constexpr uint32_t kDxgiBC1 = 71;
+constexpr uint32_t kDxgiBC3 = 77;
+constexpr uint32_t kDxgiBC7 = 98;
+
+std::string Lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    return s;
+}
+
+// "k=v;k=v" を分解する
+std::map<std::string, std::string> ParseSettings(std::string_view s) {
+    std::map<std::string, std::string> out;
+    while (!s.empty()) {
+        const size_t end = std::min(s.find(';'), s.size());
+        const std::string_view kv = s.substr(0, end);
+        const size_t eq = kv.find('=');
+        if (eq != std::string_view::npos) out[std::string(kv.substr(0, eq))] = std::string(kv.substr(eq + 1));
+        s.remove_prefix(std::min(end + 1, s.size()));
+    }
+    return out;
+}
+
+// 一時ファイルに書いてからストアへ移す（途中で落ちても壊れたオブジェクトが残らない）
+bool StoreObject(const std::filesystem::path& objects, const ContentKey& key, const void* data, size_t size) {
+    const std::filesystem::path object = ContentObjectPath(objects, key);
+    std::error_code ec;
+    std::filesystem::create_directories(object.parent_path(), ec);
+    // 置き換えに失敗しても、同じ内容を別のプロセスが先に置いていればよい
+    return WriteFileAtomic(object, data, size) || std::filesystem::exists(object, ec);
+}
+
+// シェーダーのエントリポイント（名前が書かれていればあるものとする）
+bool HasEntry(const std::vector<uint8_t>& source, const char* entry) {
+    const std::string_view text(reinterpret_cast<const char*>(source.data()), source.size());
+    return text.find(std::string(entry) + "(") != std::string_view::npos;
+}
+
+// dxc 自体が変わったら作り直す（中身は読まず、パス・サイズ・更新時刻で代用する）
+std::string DxcIdentity(const std::string& dxc) {
+    uint64_t size = 0;
+    const int64_t time = WriteTime(FromUtf8(dxc), size);
+    return dxc + "@" + std::to_string(size) + ":" + std::to_string(time);
+}
+
+bool CookTexture(const std::vector<uint8_t>& bytes, const std::map<std::string, std::string>& settings, bool parallel,
+                 std::vector<uint8_t>& out, std::string& error) {
+    Image image;
+    if (!DecodeImage(bytes.data(), bytes.size(), image)) {
+        error = "decode failed";
+        return false;
+    }
+    const std::string& filter = settings.at("mips");
+    const std::string& bc = settings.at("bc");
+    MipOptions mips;
+    mips.filter = filter == "box" ? MipFilter::Box : filter == "lanczos" ? MipFilter::Lanczos : MipFilter::Kaiser;
+    mips.srgb = settings.at("srgb") == "1";
+    mips.parallel = parallel;
+    std::vector<Image> levels;
+    if (!GenerateMipChain(image.View(), mips, levels)) {
+        error = "mip generation failed";
+        return false;
+    }
+
+    BCEncodeOptions enc;
+    enc.format = bc == "bc1" ? BCFormat::BC1 : bc == "bc3" ? BCFormat::BC3 : bc == "bc7" ? BCFormat::BC7 : BCFormat::None;
+    enc.quality = settings.at("quality") == "fast" ? BCQuality::Fast : BCQuality::High;
+    enc.parallel = parallel;
+
+    ContainerInfo info;
+    info.container = ContainerFormat::DDS;
+    info.width = image.width;
+    info.height = image.height;
+    info.mipLevels = uint32_t(levels.size());
+    info.dxgiFormat = enc.format == BCFormat::BC1 ? kDxgiBC1 : enc.format == BCFormat::BC3 ? kDxgiBC3 :
+                      enc.format == BCFormat::BC7 ? kDxgiBC7 : kDxgiRGBA8;
+    if (mips.srgb) info.dxgiFormat = ToSrgbFormat(info.dxgiFormat);
+
+    std::vector<std::vector<uint8_t>> encoded(levels.size());
+    std::vector<ContainerSubresource> subresources(levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const Image& level = levels[i];
+        ContainerSubresource& sr = subresources[i];
+        if (enc.format == BCFormat::None) {
+            sr.data = level.pixels.data();
+            sr.rowPitch = level.RowPitch();
+            sr.rowCount = level.height;
+        } else {
+            sr.rowPitch = BCRowPitch(enc.format, level.width);
+            sr.rowCount = (level.height + 3) / 4;
+            encoded[i].resize(BCSurfaceSize(enc.format, level.width, level.height));
+            if (!EncodeBC(level.View(), enc, encoded[i].data(), sr.rowPitch)) {
+                error = "block compression failed";
+                return false;
+            }
+            sr.data = encoded[i].data();
+        }
+        sr.slicePitch = sr.rowPitch * sr.rowCount;
+    }
+    if (!WriteDds(info, subresources, out)) {
+        error = "dds write failed";
+        return false;
+    }
+    return true;
+}
+
+bool CookShader(const std::filesystem::path& input, const std::map<std::string, std::string>& settings,
+                const std::filesystem::path& tmp, std::string& error) {
+    // dxc の標準出力はパイプで受けて標準エラーへ流す（ビルドのワーカーは標準出力を親とのやり取りに使っている）
+    std::unique_ptr<ChildProcess> dxc = ChildProcess::Spawn(
+        { settings.at("dxc"), "-T", settings.at("target"), "-E", settings.at("entry"), "-Fo", ToUtf8(tmp), ToUtf8(input) }, true);
+    if (!dxc) {
+        error = "failed to start " + settings.at("dxc");
+        return false;
+    }
+    dxc->CloseInput();
+    std::string line;
+    while (dxc->ReadLine(line)) std::cerr << line << '\n';
+    const int code = dxc->Wait();
+    if (code != 0) {
+        error = "dxc exited with " + std::to_string(code);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+const char* jisaku::KindName(AssetKind kind) {
+    switch (kind) {
+    case AssetKind::Texture: return "texture";
+    case AssetKind::Shader: return "shader";
+    default: return "copy";
+    }
+}
+
+bool jisaku::ParseKind(std::string_view s, AssetKind& kind) {
+    if (s == "texture") kind = AssetKind::Texture;
+    else if (s == "shader") kind = AssetKind::Shader;
+    else if (s == "copy") kind = AssetKind::Copy;
+    else return false;
+    return true;
+}
+
+bool jisaku::ClassifyInput(const std::filesystem::path& path, AssetKind& kind) {
+    const std::string ext = Lower(ToUtf8(path.extension()));
+    if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".tga" || ext == ".bmp") kind = AssetKind::Texture;
+    else if (ext == ".hlsl") kind = AssetKind::Shader;
+    else if (ext == ".dds" || ext == ".ktx2" || ext == ".hdr" || ext == ".exr" || ext == ".jscn") kind = AssetKind::Copy;
+    else return false;
+    return true;
+}
+
+bool CookOptions::IsValid() const {
+    return (bc == "none" || bc == "bc1" || bc == "bc3" || bc == "bc7") &&
+           (bcQuality == "fast" || bcQuality == "high") &&
+           (mipFilter == "box" || mipFilter == "kaiser" || mipFilter == "lanczos");
+}
+
+std::vector<CookOutput> jisaku::ExpandOutputs(const CookOptions& opt, const std::filesystem::path& source,
+                                              const std::string& name, AssetKind kind) {
+    std::vector<CookOutput> outputs;
+    switch (kind) {
+    case AssetKind::Texture:
+        outputs.push_back({ name, "bc=" + opt.bc + ";quality=" + opt.bcQuality + ";mips=" + opt.mipFilter + ";srgb=1" });
+        break;
+    case AssetKind::Shader: {
+        std::vector<uint8_t> text;
+        if (!ReadWholeFile(source, text)) break;
+        const std::string stem = ToUtf8(FromUtf8(name).replace_extension());
+        const std::string dxcId = DxcIdentity(opt.dxc);
+        for (const auto& stage : kShaderStages) {
+            if (!HasEntry(text, stage[0])) continue;
+            outputs.push_back({ stem + "." + stage[0] + ".cso",
+                                "target=" + std::string(stage[1]) + ";entry=" + stage[0] + ";dxc=" + opt.dxc + ";dxcId=" + dxcId });
+        }
+        break;
+    }
+    default:
+        outputs.push_back({ name, std::string() });
+        break;
+    }
+    return outputs;
+}
+
+bool jisaku::ResolveOutput(const std::string& output, std::string& input, AssetKind& kind) {
+    for (const auto& stage : kShaderStages) {
+        const std::string suffix = std::string(".") + stage[0] + ".cso";
+        if (output.size() > suffix.size() && output.compare(output.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            input = output.substr(0, output.size() - suffix.size()) + ".hlsl";
+            kind = AssetKind::Shader;
+            return true;
+        }
+    }
+    input = output;
+    return ClassifyInput(FromUtf8(output), kind) && kind != AssetKind::Shader;
+}
+
+ContentKey jisaku::MakeCookKey(AssetKind kind, const std::string& settings, const ContentKey& inputHash) {
+    // キー = ツールのバージョン + 種類 + 設定 + 入力の中身
+    std::string source = std::string(kCookToolVersion) + '\0' + KindName(kind) + '\0' + settings + '\0';
+    source.append(reinterpret_cast<const char*>(&inputHash), sizeof(inputHash));
+    return HashContent(source.data(), source.size());
+}
+
+bool jisaku::CookOne(const std::filesystem::path& objects, const ContentKey& key, AssetKind kind, const std::string& settingsText,
+                     const std::filesystem::path& input, bool parallel, uint64_t& size, std::string& error,
+                     std::vector<uint8_t>* result) {
+    const std::map<std::string, std::string> settings = ParseSettings(settingsText);
+    std::vector<uint8_t> out;
+    try {
+        if (kind == AssetKind::Shader) {
+            std::filesystem::path tmp = ContentObjectPath(objects, key);
+            tmp += ".dxc.tmp";
+            std::error_code ec;
+            std::filesystem::create_directories(tmp.parent_path(), ec);
+            const bool ok = CookShader(input, settings, tmp, error) && ReadWholeFile(tmp, out);
+            std::filesystem::remove(tmp, ec);
+            if (!ok) {
+                if (error.empty()) error = "no dxc output";
+                return false;
+            }
+        } else {
+            std::vector<uint8_t> bytes;
+            if (!ReadWholeFile(input, bytes)) {
+                error = "read failed";
+                return false;
+            }
+            if (kind == AssetKind::Copy) {
+                out = std::move(bytes);
+            } else if (!CookTexture(bytes, settings, parallel, out, error)) {
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        error = e.what(); // 設定の欠けなど
+        return false;
+    }
+    if (!StoreObject(objects, key, out.data(), out.size())) {
+        error = "store failed";
+        return false;
+    }
+    size = out.size();
+    if (result) *result = std::move(out);
+    return true;
+}
+
+std::string jisaku::ToUtf8(const std::filesystem::path& path) {
+    const std::u8string u8 = path.generic_u8string();
+    return std::string(u8.begin(), u8.end());
+}
+
+std::filesystem::path jisaku::FromUtf8(std::string_view s) {
+    return std::filesystem::path(std::u8string(s.begin(), s.end()));
+}
+
+bool jisaku::ReadWholeFile(const std::filesystem::path& path, std::vector<uint8_t>& out) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    out.resize(size_t(in.tellg()));
+    in.seekg(0);
+    return out.empty() || bool(in.read(reinterpret_cast<char*>(out.data()), std::streamsize(out.size())));
+}
+
+int64_t jisaku::WriteTime(const std::filesystem::path& path, uint64_t& size) {
+    std::error_code ec;
+    const uintmax_t bytes = std::filesystem::file_size(path, ec);
+    size = ec ? 0 : uint64_t(bytes);
+    if (ec) return 0;
+    return int64_t(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+}
+
+bool jisaku::HashFile(const std::filesystem::path& path, ContentKey& hash) {
+    std::error_code ec;
+    const uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    if (size == 0) {
+        hash = HashContent(nullptr, 0);
+        return true;
+    }
+    std::shared_ptr<MappedFile> file = MappedFile::Open(path);
+    if (!file) return false;
+    hash = HashContent(file->GetData(), size_t(file->GetSize()));
+    return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "core/AssetManifest.h"
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jisaku {
+
+// アセットのクック処理（JisakuAssetBuild と JisakuCookServer で共有する。D3D/Windows 非依存）。
+// 出力はコンテンツストア（<cache>/objects）に「入力の中身 + 設定 + ツールのバージョン」のキーで置く
+//
+// 入力の種類は拡張子で決める:
+//   .png .jpg .jpeg .tga .bmp   → ミップ付き・ブロック圧縮済みの DDS（仮想パスは元のまま。読み込み側は中身で判定する）
+//   .hlsl                       → VSMain / PSMain があればそれぞれ DXIL（"<名前>.VSMain.cso" 等）
+//   .dds .ktx2 .hdr .exr .jscn  → そのままストアへ
+
+// 出力の中身が変わる修正をしたら上げる（全アセットが作り直しになる）
+constexpr const char* kCookToolVersion = "JisakuAssetBuild 1";
+
+enum class AssetKind : uint8_t {
+    Texture,
+    Shader,
+    Copy,
+};
+
+const char* KindName(AssetKind kind);
+bool ParseKind(std::string_view s, AssetKind& kind);
+bool ClassifyInput(const std::filesystem::path& path, AssetKind& kind);
+
+// キーに入る設定
+struct CookOptions {
+    std::string dxc = "dxc";
+    std::string bc = "bc7";           // none | bc1 | bc3 | bc7
+    std::string bcQuality = "high";   // fast | high
+    std::string mipFilter = "kaiser"; // box | kaiser | lanczos
+
+    bool IsValid() const;
+};
+
+// 1 入力から出る出力 1 つ
+struct CookOutput {
+    std::string name;     // 仮想パス
+    std::string settings; // "k=v;k=v"
+};
+
+// 入力 name（仮想パス）から出る出力を列挙する。シェーダーはソースを読んでエントリポイントを探す
+std::vector<CookOutput> ExpandOutputs(const CookOptions& opt, const std::filesystem::path& source,
+                                      const std::string& name, AssetKind kind);
+// 出力の仮想パスから入力の仮想パスと種類を逆引きする（"a/b.VSMain.cso" → "a/b.hlsl"）
+bool ResolveOutput(const std::string& output, std::string& input, AssetKind& kind);
+
+ContentKey MakeCookKey(AssetKind kind, const std::string& settings, const ContentKey& inputHash);
+
+// input をクックしてストアに置く。out が非 null なら出力の中身も返す。
+// parallel ならミップ生成・ブロック圧縮を JobSystem に分散する（プロセスを並べるときは false）
+bool CookOne(const std::filesystem::path& objects, const ContentKey& key, AssetKind kind, const std::string& settings,
+             const std::filesystem::path& input, bool parallel, uint64_t& size, std::string& error,
+             std::vector<uint8_t>* out = nullptr);
+
+// 補助
+std::string ToUtf8(const std::filesystem::path& path);
+std::filesystem::path FromUtf8(std::string_view s);
+bool ReadWholeFile(const std::filesystem::path& path, std::vector<uint8_t>& out);
+// 更新時刻（ファイルが無ければ 0）とサイズ
+int64_t WriteTime(const std::filesystem::path& path, uint64_t& size);
+// ファイル全体のハッシュ（空ファイルも可）
+bool HashFile(const std::filesystem::path& path, ContentKey& hash);
+
+} // namespace jisaku
@@ -0,0 +1,381 @@
+// クックサーバー（D3D/Windows 非依存）。
+//   JisakuCookServer [オプション]
+// - エンジン（CookClient / Vfs::MountCookServer）からの要求ごとに、仮想パスの元ファイルをその場でクックして返す
+// - 出力は JisakuAssetBuild と同じキー・同じコンテンツストアに置くので、どちらかで作ったものはもう片方でも使える
+// - 要求された出力の元ファイルを監視し、書き換えられたら接続中の全クライアントへ Invalidate を送る
+// - 同じキーのクックが同時に来たら 1 回だけ行い、他の要求はその結果を待つ
+// 止めるときは Ctrl+C（残った Unix ドメインソケットのファイルは次の起動時に消す）
+#include "tools/AssetCook.h"
+#include "core/AssetManifest.h"
+#include "core/CookProtocol.h"
+#include "core/HotReloadScheduler.h"
+#include "core/JobSystem.h"
+#include "core/MappedFile.h"
+#include "core/Socket.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+struct Options {
+    std::filesystem::path root = ".";
+    std::filesystem::path cache = ".assetcache";
+    std::string listen = kDefaultCookAddress;
+    CookOptions cook;
+    HotReloadScheduler::Config watch{ 0.25, 0.1 }; // 保存してから届くまでの遅れを短めに
+};
+
+// 接続 1 本。返事はジョブから、Invalidate は監視スレッドから送るので送信だけ排他する
+struct Connection {
+    std::unique_ptr<Socket> socket;
+    std::mutex sendMutex;
+
+    bool Send(CookMessage type, const void* head, size_t headSize, const void* body = nullptr, size_t bodySize = 0) {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        return SendCookFrame(*socket, type, head, headSize, body, bodySize);
+    }
+};
+
+std::string Lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    return s;
+}
+
+// --root の外や絶対パスは受け付けない
+bool IsSafeName(const std::string& name) {
+    if (name.empty() || name.find('\0') != std::string::npos || name.find('\\') != std::string::npos) return false;
+    const std::filesystem::path path = FromUtf8(name);
+    if (path.is_absolute() || path.has_root_name() || path.has_root_directory()) return false;
+    for (const std::filesystem::path& part : path) {
+        if (part == "..") return false;
+    }
+    return true;
+}
+
+class Server {
+public:
+    explicit Server(const Options& opt) : m_opt(opt), m_objects(opt.cache / "objects"), m_scheduler(opt.watch) {}
+
+    int Run() {
+        std::error_code ec;
+        std::filesystem::create_directories(m_objects, ec);
+        if (ec) {
+            spdlog::error("Cannot create cache directory {}", ToUtf8(m_objects));
+            return 1;
+        }
+        std::unique_ptr<Socket> listener = Socket::Listen(m_opt.listen);
+        if (!listener) {
+            spdlog::error("Cannot listen on {}", m_opt.listen);
+            return 1;
+        }
+        spdlog::info("Cooking {} on {} ({} workers)", ToUtf8(std::filesystem::absolute(m_opt.root)), m_opt.listen,
+                     JobSystem::Get().GetWorkerCount());
+        std::thread(&Server::watchLoop_, this).detach();
+        while (std::unique_ptr<Socket> socket = listener->Accept()) {
+            auto conn = std::make_shared<Connection>();
+            conn->socket = std::move(socket);
+            std::thread(&Server::serve_, this, std::move(conn)).detach();
+        }
+        return 1;
+    }
+
+private:
+    // 更新時刻・サイズが前回と同じ入力はハッシュを再利用する
+    struct StatEntry_ {
+        int64_t time = 0;
+        uint64_t size = 0;
+        ContentKey hash;
+    };
+    // 監視中の元ファイル
+    struct Watched_ {
+        uint64_t id = 0;
+        std::set<std::string> outputs; // 要求された出力の仮想パス
+    };
+
+    // 接続ごとのスレッド。Get はジョブに回し、受信は止めない
+    void serve_(std::shared_ptr<Connection> conn) {
+        Socket& socket = *conn->socket;
+        CookMessage type;
+        uint32_t size = 0;
+        std::vector<uint8_t> payload;
+        uint32_t version = 0;
+        if (!ReceiveCookFrameHeader(socket, type, size) || type != CookMessage::Hello || size != kCookHelloSize) return;
+        payload.resize(size);
+        if (!socket.Receive(payload.data(), size) || !DecodeCookHello(payload.data(), size, version)) return;
+        uint8_t hello[kCookHelloSize];
+        EncodeCookHello(hello);
+        if (!conn->Send(CookMessage::Hello, hello, sizeof(hello))) return;
+        if (version != kCookProtocolVersion) {
+            spdlog::warn("Client speaks protocol {} (expected {})", version, kCookProtocolVersion);
+            return; // クライアントも同じ比較をして切る
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_connMutex);
+            m_connections.push_back(conn);
+        }
+
+        uint64_t requests = 0;
+        while (ReceiveCookFrameHeader(socket, type, size)) {
+            // クライアントが送るのは Get だけ（ほかの種類の大きなフレームを読むために確保しない）
+            if (type != CookMessage::Get) {
+                spdlog::warn("Unexpected message {} from client; disconnecting", uint32_t(type));
+                break;
+            }
+            payload.resize(size);
+            if (size > 0 && !socket.Receive(payload.data(), size)) break;
+            uint32_t id = 0;
+            std::string name;
+            if (!DecodeCookGet(payload.data(), payload.size(), id, name)) continue;
+            ++requests;
+            JobSystem::Get().Submit([this, conn, id, name = std::move(name)]() { handleGet_(*conn, id, name); });
+        }
+
+        std::lock_guard<std::mutex> lock(m_connMutex);
+        m_connections.erase(std::remove(m_connections.begin(), m_connections.end(), conn), m_connections.end());
+        spdlog::info("Client disconnected after {} requests", requests);
+    }
+
+    void handleGet_(Connection& conn, uint32_t id, const std::string& name) {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        CookReplyHead head;
+        head.id = id;
+        auto fail = [&](CookStatus status, const std::string& error) {
+            head.status = status;
+            uint8_t bytes[kCookReplyHeadSize];
+            EncodeCookReplyHead(bytes, head);
+            conn.Send(CookMessage::Reply, bytes, sizeof(bytes), error.data(), error.size());
+            if (status == CookStatus::Failed) spdlog::error("{}: {}", name, error);
+        };
+
+        std::string inputName;
+        AssetKind kind;
+        if (!IsSafeName(name) || !ResolveOutput(name, inputName, kind)) {
+            fail(CookStatus::NotFound, "not a cooked asset");
+            return;
+        }
+        const std::filesystem::path input = m_opt.root / FromUtf8(inputName);
+        // ハッシュより先に監視を始める（その間に書き換えられても取りこぼさない）
+        uint64_t size = 0;
+        if (WriteTime(input, size) == 0) {
+            fail(CookStatus::NotFound, "no source file");
+            return;
+        }
+        watch_(inputName, input, name);
+        ContentKey inputHash;
+        if (!hashInput_(inputName, input, inputHash)) {
+            fail(CookStatus::NotFound, "cannot read source file");
+            return;
+        }
+        std::string settings;
+        bool found = false;
+        for (CookOutput& out : ExpandOutputs(m_opt.cook, input, inputName, kind)) {
+            if (out.name != name) continue;
+            settings = std::move(out.settings);
+            found = true;
+            break;
+        }
+        if (!found) {
+            fail(CookStatus::NotFound, "no such output"); // エントリポイントの無いステージ等
+            return;
+        }
+        head.key = MakeCookKey(kind, settings, inputHash);
+
+        // 作ったばかりならその中身を、ストアにあるならマップして送る
+        std::vector<uint8_t> cooked;
+        bool built = false;
+        std::string error;
+        std::error_code ec;
+        if (!std::filesystem::exists(ContentObjectPath(m_objects, head.key), ec)) {
+            if (!cook_(head.key, kind, settings, input, cooked, built, error)) {
+                fail(CookStatus::Failed, error);
+                return;
+            }
+        }
+        std::shared_ptr<MappedFile> object;
+        const uint8_t* data = cooked.data();
+        size_t dataSize = cooked.size();
+        if (!built) {
+            object = MappedFile::Open(ContentObjectPath(m_objects, head.key));
+            if (object) {
+                data = object->GetData();
+                dataSize = size_t(object->GetSize());
+            } else if (std::filesystem::file_size(ContentObjectPath(m_objects, head.key), ec) != 0 || ec) {
+                fail(CookStatus::Failed, "cannot read cooked object");
+                return;
+            }
+        }
+        if (dataSize > kCookMaxReplyBody) {
+            fail(CookStatus::Failed, "cooked asset is larger than a reply frame allows");
+            return;
+        }
+        head.status = CookStatus::Ok;
+        uint8_t bytes[kCookReplyHeadSize];
+        EncodeCookReplyHead(bytes, head);
+        conn.Send(CookMessage::Reply, bytes, sizeof(bytes), data, dataSize);
+        if (built) {
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            spdlog::info("Cooked {} ({} bytes, {:.1f} ms)", name, dataSize, ms);
+        }
+    }
+
+    // key を作る。同じ key を別のジョブが作っている最中ならそれを待つ（built = false で返るのでストアから読む）
+    bool cook_(const ContentKey& key, AssetKind kind, const std::string& settings, const std::filesystem::path& input,
+               std::vector<uint8_t>& out, bool& built, std::string& error) {
+        const std::string hex = key.ToHex();
+        std::promise<std::string> promise;
+        std::shared_future<std::string> other;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_cooking.find(hex);
+            if (it != m_cooking.end()) other = it->second;
+            else m_cooking.emplace(hex, promise.get_future().share());
+        }
+        if (other.valid()) {
+            error = other.get();
+            built = false;
+            return error.empty();
+        }
+        uint64_t size = 0;
+        built = CookOne(m_objects, key, kind, settings, input, /*parallel=*/true, size, error, &out);
+        promise.set_value(built ? std::string() : error);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cooking.erase(hex);
+        return built;
+    }
+
+    bool hashInput_(const std::string& name, const std::filesystem::path& path, ContentKey& hash) {
+        StatEntry_ st;
+        st.time = WriteTime(path, st.size);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_stats.find(name);
+            if (it != m_stats.end() && it->second.time == st.time && it->second.size == st.size && st.time != 0) {
+                hash = it->second.hash;
+                return true;
+            }
+        }
+        if (!HashFile(path, st.hash)) return false;
+        hash = st.hash;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats[name] = st;
+        return true;
+    }
+
+    void watch_(const std::string& inputName, const std::filesystem::path& input, const std::string& output) {
+        std::lock_guard<std::mutex> lock(m_watchMutex);
+        Watched_& w = m_watched[inputName];
+        if (w.id == 0) {
+            w.id = m_nextWatchId++;
+            m_watchIds.emplace(w.id, inputName);
+            m_scheduler.Add(w.id, input);
+        }
+        w.outputs.insert(output);
+    }
+
+    // 書き換えられた元ファイルから出る出力を、接続中の全クライアントに知らせる
+    void watchLoop_() {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        for (;;) {
+            // 変更は FileWatcher の通知で届く（使えないファイルだけ pollInterval ごとに stat）。ここは通知を取りに行く間隔
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::vector<std::string> names;
+            {
+                std::lock_guard<std::mutex> lock(m_watchMutex);
+                const double now = std::chrono::duration<double>(Clock::now() - start).count();
+                for (uint64_t id : m_scheduler.Update(now)) {
+                    const std::string& input = m_watchIds[id];
+                    const Watched_& w = m_watched[input];
+                    names.insert(names.end(), w.outputs.begin(), w.outputs.end());
+                    spdlog::info("{} changed", input);
+                    m_scheduler.Complete(id); // 作り直しは次の要求で行う
+                }
+            }
+            if (names.empty()) continue;
+            std::vector<std::shared_ptr<Connection>> conns;
+            {
+                std::lock_guard<std::mutex> lock(m_connMutex);
+                conns = m_connections;
+            }
+            for (const std::shared_ptr<Connection>& conn : conns) {
+                for (const std::string& name : names) conn->Send(CookMessage::Invalidate, name.data(), name.size());
+            }
+        }
+    }
+
+    const Options m_opt;
+    const std::filesystem::path m_objects;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, StatEntry_> m_stats;
+    std::unordered_map<std::string, std::shared_future<std::string>> m_cooking; // キー → エラー文（空なら成功）
+
+    std::mutex m_watchMutex;
+    HotReloadScheduler m_scheduler;
+    std::unordered_map<std::string, Watched_> m_watched;
+    std::unordered_map<uint64_t, std::string> m_watchIds;
+    uint64_t m_nextWatchId = 1;
+
+    std::mutex m_connMutex;
+    std::vector<std::shared_ptr<Connection>> m_connections;
+};
+
+void PrintUsage() {
+    std::cerr <<
+        "usage: JisakuCookServer [options]\n"
+        "  --root DIR         base directory for sources and virtual paths (default .)\n"
+        "  --cache DIR        content-addressable store, shared with JisakuAssetBuild (default .assetcache)\n"
+        "  --listen ADDR      unix:PATH or tcp:HOST:PORT (default " << kDefaultCookAddress << ")\n"
+        "  --poll SEC         source polling interval where change notification is unavailable (default 0.25)\n"
+        "  --settle SEC       wait for writes to settle before invalidating (default 0.1)\n"
+        "  --dxc PATH         shader compiler (default dxc)\n"
+        "  --bc none|bc1|bc3|bc7, --bc-quality fast|high, --mip-filter box|kaiser|lanczos\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (a == "--root" && value(v)) opt.root = FromUtf8(v);
+        else if (a == "--cache" && value(v)) opt.cache = FromUtf8(v);
+        else if (a == "--listen" && value(v)) opt.listen = v;
+        else if (a == "--poll" && value(v)) opt.watch.pollInterval = std::stod(v);
+        else if (a == "--settle" && value(v)) opt.watch.settleTime = std::stod(v);
+        else if (a == "--dxc" && value(v)) opt.cook.dxc = v;
+        else if (a == "--bc" && value(v)) opt.cook.bc = Lower(v);
+        else if (a == "--bc-quality" && value(v)) opt.cook.bcQuality = Lower(v);
+        else if (a == "--mip-filter" && value(v)) opt.cook.mipFilter = Lower(v);
+        else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (!opt.cook.IsValid() || opt.watch.pollInterval <= 0.0 || opt.watch.settleTime < 0.0) {
+        PrintUsage();
+        return 2;
+    }
+    Server server(opt);
+    return server.Run();
+}
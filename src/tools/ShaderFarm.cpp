@@ -0,0 +1,787 @@
+#include "tools/ShaderFarm.h"
+#include "core/AtomicFile.h"
+#include "core/ByteOrder.h"
+#include "core/ChildProcess.h"
+#include "core/ShaderCache.h"
+#include "core/Socket.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace jisaku;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class FarmMessage : uint8_t {
+    Hello = 1,
+    Compile = 2,
+    Result = 3,
+    Auth = 4,
+};
+
+constexpr size_t kFrameHeaderSize = 8;
+// 壊れたヘッダで巨大な確保をしないように
+constexpr uint32_t kMaxPayload = 0x40000000u;
+constexpr uint32_t kMaxAuthPayload = 4096;
+
+// ペイロードの組み立て
+class Writer {
+public:
+    void U8(uint8_t v) { m_bytes.push_back(v); }
+    void U32(uint32_t v) {
+        uint8_t b[4];
+        WriteU32(b, v);
+        Bytes(b, sizeof(b));
+    }
+    void Bytes(const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        m_bytes.insert(m_bytes.end(), p, p + size);
+    }
+    void String(std::string_view s) {
+        U32(uint32_t(s.size()));
+        Bytes(s.data(), s.size());
+    }
+    const std::vector<uint8_t>& Get() const { return m_bytes; }
+
+private:
+    std::vector<uint8_t> m_bytes;
+};
+
+// ペイロードの読み出し。足りなければ false
+class Reader {
+public:
+    explicit Reader(const std::vector<uint8_t>& bytes) : m_p(bytes.data()), m_left(bytes.size()) {}
+
+    bool U8(uint8_t& v) {
+        if (m_left < 1) return false;
+        v = *m_p;
+        skip_(1);
+        return true;
+    }
+    bool U32(uint32_t& v) {
+        if (m_left < 4) return false;
+        v = ReadU32(m_p);
+        skip_(4);
+        return true;
+    }
+    bool Skip(size_t n) {
+        if (m_left < n) return false;
+        skip_(n);
+        return true;
+    }
+    bool Bytes(size_t n, const uint8_t*& out) {
+        if (m_left < n) return false;
+        out = m_p;
+        skip_(n);
+        return true;
+    }
+    bool String(std::string& s) {
+        uint32_t n = 0;
+        const uint8_t* p = nullptr;
+        if (!U32(n) || !Bytes(n, p)) return false;
+        s.assign(reinterpret_cast<const char*>(p), n);
+        return true;
+    }
+    std::string Rest() {
+        std::string s(reinterpret_cast<const char*>(m_p), m_left);
+        skip_(m_left);
+        return s;
+    }
+
+private:
+    void skip_(size_t n) {
+        m_p += n;
+        m_left -= n;
+    }
+
+    const uint8_t* m_p;
+    size_t m_left;
+};
+
+bool SendFrame(FarmChannel& channel, FarmMessage type, const std::vector<uint8_t>& head,
+               const void* body = nullptr, size_t bodySize = 0) {
+    const uint64_t payload = uint64_t(head.size()) + bodySize;
+    if (payload > kMaxPayload) return false;
+    // ヘッダと head は 1 回で送る（ソケットは Nagle を切っているので分けると小さいパケットが出る）
+    std::vector<uint8_t> first(kFrameHeaderSize + head.size());
+    WriteU32(first.data(), uint32_t(payload));
+    first[4] = uint8_t(type);
+    if (!head.empty()) std::memcpy(first.data() + kFrameHeaderSize, head.data(), head.size());
+    if (!channel.Send(first.data(), first.size())) return false;
+    return bodySize == 0 || channel.Send(body, bodySize);
+}
+
+bool ReceiveFrame(FarmChannel& channel, FarmMessage& type, std::vector<uint8_t>& payload) {
+    uint8_t header[kFrameHeaderSize];
+    if (!channel.Receive(header, sizeof(header))) return false;
+    const uint32_t size = ReadU32(header);
+    if (size > kMaxPayload) return false;
+    type = FarmMessage(header[4]);
+    payload.resize(size);
+    return size == 0 || channel.Receive(payload.data(), size);
+}
+
+// ---------------------------------------------------------------------------
+// 経路
+// ---------------------------------------------------------------------------
+
+class SocketChannel : public FarmChannel {
+public:
+    explicit SocketChannel(std::unique_ptr<Socket> socket) : m_socket(std::move(socket)) {}
+    bool Send(const void* data, size_t size) override { return m_socket->Send(data, size); }
+    bool Receive(void* data, size_t size) override { return m_socket->Receive(data, size); }
+    void Abort() override { m_socket->Shutdown(); }
+
+private:
+    std::unique_ptr<Socket> m_socket;
+};
+
+class ProcessChannel : public FarmChannel {
+public:
+    explicit ProcessChannel(std::unique_ptr<ChildProcess> process) : m_process(std::move(process)) {}
+    bool Send(const void* data, size_t size) override { return m_process->Write(data, size); }
+    bool Receive(void* data, size_t size) override { return m_process->Read(data, size); }
+    void Abort() override { m_process->Kill(); }
+
+private:
+    std::unique_ptr<ChildProcess> m_process; // 破棄で標準入力を閉じ、ワーカーの終了を待つ
+};
+
+// 標準入出力はやり取り専用にして、標準出力は標準エラーへ付け替える
+// （ワーカー自身や dxc が標準出力に書いてもフレームが壊れない。dxc はパイプ無しで起動できる）
+class StdioChannel : public FarmChannel {
+public:
+    StdioChannel() {
+#ifdef _WIN32
+        const HANDLE self = GetCurrentProcess();
+        DuplicateHandle(self, GetStdHandle(STD_INPUT_HANDLE), self, &m_in, 0, FALSE, DUPLICATE_SAME_ACCESS);
+        DuplicateHandle(self, GetStdHandle(STD_OUTPUT_HANDLE), self, &m_out, 0, FALSE, DUPLICATE_SAME_ACCESS);
+        std::fflush(stdout);
+        _dup2(_fileno(stderr), _fileno(stdout));
+        SetStdHandle(STD_OUTPUT_HANDLE, GetStdHandle(STD_ERROR_HANDLE));
+#else
+        m_in = ::fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 0);
+        m_out = ::fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0);
+        std::fflush(stdout);
+        const int null = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (null >= 0) {
+            ::dup2(null, STDIN_FILENO);
+            ::close(null);
+        }
+        ::dup2(STDERR_FILENO, STDOUT_FILENO);
+#endif
+    }
+    ~StdioChannel() override {
+#ifdef _WIN32
+        if (m_in) CloseHandle(m_in);
+        if (m_out) CloseHandle(m_out);
+#else
+        if (m_in >= 0) ::close(m_in);
+        if (m_out >= 0) ::close(m_out);
+#endif
+    }
+
+    bool Send(const void* data, size_t size) override {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+#ifdef _WIN32
+            DWORD n = 0;
+            if (!m_out || !WriteFile(m_out, p, DWORD(std::min<size_t>(size, 1u << 30)), &n, nullptr)) return false;
+#else
+            const ssize_t n = m_out < 0 ? -1 : ::write(m_out, p, size);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+#endif
+            p += n;
+            size -= size_t(n);
+        }
+        return true;
+    }
+    bool Receive(void* data, size_t size) override {
+        char* p = static_cast<char*>(data);
+        while (size > 0) {
+#ifdef _WIN32
+            DWORD n = 0;
+            if (!m_in || !ReadFile(m_in, p, DWORD(std::min<size_t>(size, 1u << 30)), &n, nullptr) || n == 0) return false;
+#else
+            const ssize_t n = m_in < 0 ? -1 : ::read(m_in, p, size);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+#endif
+            p += n;
+            size -= size_t(n);
+        }
+        return true;
+    }
+    void Abort() override {}
+
+private:
+#ifdef _WIN32
+    HANDLE m_in = nullptr;
+    HANDLE m_out = nullptr;
+#else
+    int m_in = -1;
+    int m_out = -1;
+#endif
+};
+
+// ---------------------------------------------------------------------------
+// メッセージ
+// ---------------------------------------------------------------------------
+
+struct CompileRequest {
+    uint32_t id = 0;
+    uint32_t timeoutMs = 0;
+    uint32_t flags = 0;
+    std::string name;
+    std::string entry;
+    std::string target;
+    std::vector<std::string> defines;
+    std::string source;
+};
+
+bool SendCompile(FarmChannel& channel, uint32_t id, uint32_t timeoutMs, const FarmJob& job) {
+    Writer head;
+    head.U32(id);
+    head.U32(timeoutMs);
+    head.U32(job.flags);
+    head.String(job.name);
+    head.String(job.entry);
+    head.String(job.target);
+    head.U32(uint32_t(job.defines.size()));
+    for (const std::string& d : job.defines) head.String(d);
+    return SendFrame(channel, FarmMessage::Compile, head.Get(), job.source.data(), job.source.size());
+}
+
+bool DecodeCompile(const std::vector<uint8_t>& payload, CompileRequest& req) {
+    Reader r(payload);
+    uint32_t defineCount = 0;
+    if (!r.U32(req.id) || !r.U32(req.timeoutMs) || !r.U32(req.flags) || !r.String(req.name) || !r.String(req.entry) ||
+        !r.String(req.target) || !r.U32(defineCount))
+        return false;
+    for (uint32_t i = 0; i < defineCount; ++i) {
+        std::string d;
+        if (!r.String(d)) return false;
+        req.defines.push_back(std::move(d));
+    }
+    req.source = r.Rest();
+    return true;
+}
+
+bool SendResult(FarmChannel& channel, uint32_t id, FarmStatus status, const std::vector<uint8_t>& bytecode,
+                const std::string& text) {
+    Writer head;
+    head.U32(id);
+    head.U8(uint8_t(status));
+    head.Bytes("\0\0\0", 3);
+    head.U32(uint32_t(bytecode.size()));
+    head.Bytes(bytecode.data(), bytecode.size());
+    return SendFrame(channel, FarmMessage::Result, head.Get(), text.data(), text.size());
+}
+
+bool DecodeResult(const std::vector<uint8_t>& payload, uint32_t& id, FarmResult& out) {
+    Reader r(payload);
+    uint8_t status = 0;
+    uint32_t size = 0;
+    const uint8_t* bytes = nullptr;
+    if (!r.U32(id) || !r.U8(status) || !r.Skip(3) || !r.U32(size) || !r.Bytes(size, bytes)) return false;
+    out.status = status <= uint8_t(FarmStatus::TimedOut) ? FarmStatus(status) : FarmStatus::Failed;
+    out.bytecode.assign(bytes, bytes + size);
+    if (out.status == FarmStatus::Ok) out.listing = r.Rest();
+    else out.error = r.Rest();
+    return true;
+}
+
+// 長さ以外で比較にかかる時間が変わらないように比べる
+bool SameToken(std::string_view a, std::string_view b) {
+    uint8_t diff = a.size() != b.size() ? 1 : 0;
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) diff |= uint8_t(a[i] ^ b[i]);
+    return diff == 0;
+}
+
+// ワーカーの Hello を受けて同じコンパイラか確かめ、Auth でトークンを送る
+bool Handshake(FarmChannel& channel, const std::string& compiler, const std::string& token, std::string& error) {
+    FarmMessage type;
+    std::vector<uint8_t> payload;
+    if (!ReceiveFrame(channel, type, payload) || type != FarmMessage::Hello) {
+        error = "no hello from worker";
+        return false;
+    }
+    Reader r(payload);
+    uint32_t version = 0;
+    if (!r.U32(version) || version != kShaderFarmProtocolVersion) {
+        error = "protocol version " + std::to_string(version) + ", expected " + std::to_string(kShaderFarmProtocolVersion);
+        return false;
+    }
+    const std::string theirs = r.Rest();
+    if (theirs != compiler) {
+        error = "compiler is '" + theirs + "', expected '" + compiler + "'";
+        return false;
+    }
+    Writer auth;
+    auth.Bytes(token.data(), token.size());
+    if (!SendFrame(channel, FarmMessage::Auth, auth.Get())) {
+        error = "connection closed";
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// ワーカー側
+// ---------------------------------------------------------------------------
+
+std::string Seconds(double sec) {
+    std::ostringstream ss;
+    ss << sec;
+    return ss.str();
+}
+
+std::string PathUtf8(const std::filesystem::path& path) {
+    const std::u8string s = path.u8string();
+    return std::string(s.begin(), s.end());
+}
+
+bool ReadFileBytes(const std::filesystem::path& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+// req を dir の一時ファイル経由で dxc にかける。timeoutMs を過ぎたら dxc を止める
+FarmStatus CompileWithDxc(const std::string& dxc, const std::filesystem::path& dir, const CompileRequest& req,
+                          std::vector<uint8_t>& bytecode, std::string& text) {
+    const std::filesystem::path base = dir / std::to_string(req.id);
+    std::filesystem::path source = base, object = base, listing = base, errors = base;
+    source += ".hlsl";
+    object += ".dxil";
+    listing += ".txt";
+    errors += ".err";
+    auto cleanup = [&]() {
+        std::error_code ec;
+        for (const std::filesystem::path& p : { source, object, listing, errors }) std::filesystem::remove(p, ec);
+    };
+    {
+        std::ofstream out(source, std::ios::binary | std::ios::trunc);
+        out.write(req.source.data(), std::streamsize(req.source.size()));
+        if (!out) {
+            text = "cannot write " + PathUtf8(source);
+            return FarmStatus::Failed;
+        }
+    }
+
+    std::vector<std::string> args = { dxc, "-T", req.target, "-E", req.entry, "-Zpr",
+                                      "-Fo", PathUtf8(object), "-Fc", PathUtf8(listing), "-Fe", PathUtf8(errors) };
+    if (req.flags & kFarmDebugInfo) {
+        args.push_back("-Zi");
+        args.push_back("-Qembed_debug");
+    }
+    for (const std::string& d : req.defines) {
+        args.push_back("-D");
+        args.push_back(d);
+    }
+    args.push_back(PathUtf8(source));
+
+    // 標準出力は使わない（エラーは -Fe で受け取る）。パイプが無いので、Kill すれば Wait がすぐ返る
+    std::unique_ptr<ChildProcess> process = ChildProcess::Spawn(args, false);
+    if (!process) {
+        cleanup();
+        text = "failed to start " + dxc;
+        return FarmStatus::Failed;
+    }
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool finished = false, killed = false;
+    std::thread watchdog([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!cv.wait_for(lock, std::chrono::milliseconds(req.timeoutMs), [&] { return finished; })) {
+            killed = true;
+            process->Kill();
+        }
+    });
+    const int code = process->Wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    cv.notify_one();
+    watchdog.join();
+
+    // エラー文の一時ファイル名を元の仮想パスに戻す（#include 先は #line で元のパスになっている）
+    ReadFileBytes(errors, text);
+    const std::string tempName = PathUtf8(source);
+    for (size_t pos = 0; (pos = text.find(tempName, pos)) != std::string::npos; pos += req.name.size())
+        text.replace(pos, tempName.size(), req.name);
+    if (killed) {
+        cleanup();
+        text = "dxc timed out after " + Seconds(req.timeoutMs / 1000.0) + " s\n" + text;
+        return FarmStatus::TimedOut;
+    }
+    std::string bytes, disassembly;
+    if (code != 0 || !ReadFileBytes(object, bytes) || bytes.empty() || !ReadFileBytes(listing, disassembly)) {
+        cleanup();
+        if (text.empty()) text = "dxc exited with " + std::to_string(code);
+        return FarmStatus::Failed;
+    }
+    cleanup();
+    bytecode.assign(bytes.begin(), bytes.end());
+    text = std::move(disassembly);
+    return FarmStatus::Ok;
+}
+
+// ---------------------------------------------------------------------------
+// キャッシュ
+//   中身: バイトコードのサイズ(u32), バイトコード, 逆アセンブル
+// ---------------------------------------------------------------------------
+
+ContentKey MakeFarmKey(const FarmJob& job, const std::string& compiler) {
+    ShaderKeyDesc desc;
+    desc.source = job.source;
+    desc.entry = job.entry;
+    desc.target = job.target;
+    desc.defines = &job.defines;
+    desc.compiler = compiler;
+    desc.args = (job.flags & kFarmDebugInfo) ? "farm -Zpr -Fc -Zi -Qembed_debug" : "farm -Zpr -Fc";
+    return MakeShaderCacheKey(desc);
+}
+
+std::vector<uint8_t> PackCacheEntry(const FarmResult& result) {
+    Writer w;
+    w.U32(uint32_t(result.bytecode.size()));
+    w.Bytes(result.bytecode.data(), result.bytecode.size());
+    w.Bytes(result.listing.data(), result.listing.size());
+    return w.Get();
+}
+
+bool UnpackCacheEntry(const std::vector<uint8_t>& blob, FarmResult& out) {
+    Reader r(blob);
+    uint32_t size = 0;
+    const uint8_t* bytes = nullptr;
+    if (!r.U32(size) || size == 0 || !r.Bytes(size, bytes)) return false;
+    out.status = FarmStatus::Ok;
+    out.cached = true;
+    out.bytecode.assign(bytes, bytes + size);
+    out.listing = r.Rest();
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// 親プロセス
+// ---------------------------------------------------------------------------
+
+// ワーカー（接続）1 つ。channel と deadline は監視スレッドも見る
+struct Slot {
+    std::string name;
+    std::string token; // Auth で送る
+    std::function<std::unique_ptr<FarmChannel>()> connect;
+    std::mutex mutex;
+    FarmChannel* channel = nullptr;
+    Clock::time_point deadline = Clock::time_point::max();
+    bool timedOut = false;
+};
+
+// 1 件送って返事を受け取る。経路が切れた・返事が壊れていたら false
+bool Exchange(FarmChannel& channel, uint32_t id, uint32_t timeoutMs, const FarmJob& job, FarmResult& out) {
+    if (!SendCompile(channel, id, timeoutMs, job)) return false;
+    FarmMessage type;
+    std::vector<uint8_t> payload;
+    uint32_t replyId = 0;
+    if (!ReceiveFrame(channel, type, payload) || type != FarmMessage::Result || !DecodeResult(payload, replyId, out)) return false;
+    return replyId == id;
+}
+
+} // namespace
+
+bool jisaku::IsLocalFarmAddress(const std::string& address) {
+    if (address.rfind("unix:", 0) == 0) return true;
+    if (address.rfind("tcp:", 0) != 0) return false;
+    const size_t colon = address.rfind(':');
+    std::string host = address.substr(4, colon > 4 ? colon - 4 : 0);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+    return host == "localhost" || host == "::1" || host.rfind("127.", 0) == 0;
+}
+
+std::unique_ptr<FarmChannel> jisaku::MakeSocketChannel(std::unique_ptr<Socket> socket) {
+    return socket ? std::make_unique<SocketChannel>(std::move(socket)) : nullptr;
+}
+
+std::unique_ptr<FarmChannel> jisaku::MakeProcessChannel(std::unique_ptr<ChildProcess> process) {
+    return process ? std::make_unique<ProcessChannel>(std::move(process)) : nullptr;
+}
+
+std::unique_ptr<FarmChannel> jisaku::MakeStdioChannel() {
+    return std::make_unique<StdioChannel>();
+}
+
+std::string jisaku::QueryDxcVersion(const std::string& dxc) {
+    std::unique_ptr<ChildProcess> process = ChildProcess::Spawn({ dxc, "--version" }, true);
+    if (!process) return {};
+    process->CloseInput();
+    std::string line, first;
+    while (process->ReadLine(line)) {
+        if (first.empty()) first = line;
+    }
+    if (process->Wait() != 0) return {};
+    while (!first.empty() && (first.back() == ' ' || first.back() == '\t')) first.pop_back();
+    return first;
+}
+
+void jisaku::RunFarmWorker(FarmChannel& channel, const std::string& dxc, const std::string& compiler,
+                           const std::string& token) {
+    Writer hello;
+    hello.U32(kShaderFarmProtocolVersion);
+    hello.Bytes(compiler.data(), compiler.size());
+    if (!SendFrame(channel, FarmMessage::Hello, hello.Get())) return;
+
+    // トークンを知らない相手のソースは dxc にかけない（Auth は小さいので、大きなフレームは読む前に切る）
+    {
+        uint8_t header[kFrameHeaderSize];
+        if (!channel.Receive(header, sizeof(header))) return;
+        const uint32_t size = ReadU32(header);
+        std::string theirs(std::min<uint32_t>(size, kMaxAuthPayload), '\0');
+        if (FarmMessage(header[4]) != FarmMessage::Auth || size > kMaxAuthPayload ||
+            (size != 0 && !channel.Receive(theirs.data(), size)) || !SameToken(theirs, token)) {
+            spdlog::error("Rejected a coordinator that did not present the shader farm token");
+            return;
+        }
+    }
+
+    const std::filesystem::path dir = CreateTempDirectory("jisaku-shaderfarm-");
+    if (dir.empty()) {
+        spdlog::error("Cannot create a temporary directory");
+        return;
+    }
+    FarmMessage type;
+    std::vector<uint8_t> payload;
+    while (ReceiveFrame(channel, type, payload)) {
+        CompileRequest req;
+        if (type != FarmMessage::Compile || !DecodeCompile(payload, req)) {
+            spdlog::error("Bad request from the coordinator");
+            break;
+        }
+        std::vector<uint8_t> bytecode;
+        std::string text;
+        const FarmStatus status = CompileWithDxc(dxc, dir, req, bytecode, text);
+        if (!SendResult(channel, req.id, status, bytecode, text)) break;
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+void ShaderFarm::Run(const std::vector<FarmJob>& jobs, std::vector<FarmResult>& results) {
+    m_stats = Stats{};
+    results.assign(jobs.size(), FarmResult{});
+
+    std::vector<ContentKey> keys(jobs.size());
+    std::deque<size_t> queue;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (m_config.cache) {
+            keys[i] = MakeFarmKey(jobs[i], m_config.compiler);
+            std::vector<uint8_t> blob;
+            if (m_config.cache->Load(keys[i], blob) && UnpackCacheEntry(blob, results[i])) {
+                ++m_stats.cached;
+                continue;
+            }
+        }
+        queue.push_back(i);
+    }
+    if (queue.empty()) return;
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    const uint32_t localCount = uint32_t(std::min<size_t>(m_config.localWorkers, queue.size()));
+    for (uint32_t w = 0; w < localCount; ++w) {
+        auto slot = std::make_unique<Slot>();
+        slot->name = "worker " + std::to_string(w);
+        slot->connect = [this]() {
+            return MakeProcessChannel(ChildProcess::Spawn({ m_config.executable, "--worker", "--dxc", m_config.dxc }, true));
+        };
+        slots.push_back(std::move(slot));
+    }
+    for (const std::string& address : m_config.remotes) {
+        auto slot = std::make_unique<Slot>();
+        slot->name = address;
+        slot->token = m_config.token;
+        slot->connect = [address]() { return MakeSocketChannel(Socket::Connect(address)); };
+        slots.push_back(std::move(slot));
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t remaining = queue.size();
+    size_t live = slots.size();
+    bool stop = false;
+    std::vector<uint32_t> attempts(jobs.size(), 0);
+    std::vector<const Slot*> failedOn(jobs.size(), nullptr); // やり直しは別のワーカーに回す
+    const uint32_t timeoutMs = uint32_t(std::max(1.0, m_config.timeoutSec * 1000.0));
+    const auto limit = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(m_config.timeoutSec + m_config.graceSec));
+
+    // mutex を持って呼ぶ
+    auto finish = [&](size_t i, FarmResult result) {
+        if (result.status == FarmStatus::Ok) ++m_stats.compiled;
+        else if (result.status == FarmStatus::TimedOut) ++m_stats.timedOut;
+        else ++m_stats.failed;
+        results[i] = std::move(result);
+        --remaining;
+        cv.notify_all();
+    };
+
+    // slot が次に取る queue の位置（mutex を持って呼ぶ）。自分で失敗した件は、他のワーカーが残っている限り取らない
+    auto pick = [&](const Slot& slot) {
+        for (size_t n = 0; n < queue.size(); ++n) {
+            if (failedOn[queue[n]] != &slot || live == 1) return n;
+        }
+        return queue.size();
+    };
+
+    auto runSlot = [&](Slot& slot) {
+        bool connected = false;
+        for (bool done = false; !done;) {
+            std::unique_ptr<FarmChannel> channel = slot.connect();
+            std::string error = "cannot start or connect";
+            if (!channel || !Handshake(*channel, m_config.compiler, slot.token, error)) {
+                spdlog::error("{}: {}", slot.name, error);
+                break;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (connected) ++m_stats.workerRestarts;
+                else ++m_stats.workers;
+            }
+            connected = true;
+            {
+                std::lock_guard<std::mutex> lock(slot.mutex);
+                slot.channel = channel.get();
+                slot.timedOut = false;
+            }
+            for (;;) {
+                size_t i = 0;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    size_t n = 0;
+                    cv.wait(lock, [&] { return (n = pick(slot)) < queue.size() || remaining == 0; });
+                    if (remaining == 0) {
+                        done = true;
+                        break;
+                    }
+                    i = queue[n];
+                    queue.erase(queue.begin() + ptrdiff_t(n));
+                    ++attempts[i];
+                }
+                {
+                    std::lock_guard<std::mutex> lock(slot.mutex);
+                    slot.deadline = Clock::now() + limit;
+                }
+                FarmResult result;
+                const bool replied = Exchange(*channel, uint32_t(i), timeoutMs, jobs[i], result);
+                bool timedOut = false;
+                {
+                    std::lock_guard<std::mutex> lock(slot.mutex);
+                    slot.deadline = Clock::time_point::max();
+                    timedOut = slot.timedOut;
+                }
+                if (replied) {
+                    if (result.status == FarmStatus::Ok && m_config.cache) {
+                        const std::vector<uint8_t> blob = PackCacheEntry(result);
+                        if (!m_config.cache->Store(keys[i], blob.data(), blob.size()))
+                            spdlog::warn("Failed to write cache entry {}", keys[i].ToHex());
+                    }
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finish(i, std::move(result));
+                    continue;
+                }
+
+                // 経路が切れた（ワーカーが落ちた・返事が無いので切った）。ワーカーを起動し直し（接続し直し）、
+                // この件は他のワーカーでやり直す。dxc 自体が止まらないものはワーカーが TimedOut を返すのでここには来ない
+                const char* what = timedOut ? "no reply" : "worker exited";
+                std::lock_guard<std::mutex> lock(mutex);
+                if (attempts[i] < m_config.maxAttempts) {
+                    spdlog::warn("{}: {} while compiling {}; retrying", slot.name, what, jobs[i].name);
+                    ++m_stats.retried;
+                    failedOn[i] = &slot;
+                    queue.push_front(i);
+                    cv.notify_all();
+                } else {
+                    result = FarmResult{};
+                    result.status = timedOut ? FarmStatus::TimedOut : FarmStatus::Failed;
+                    result.error = std::string(what) + " from " + slot.name + " (" + std::to_string(attempts[i]) + " attempts)";
+                    finish(i, std::move(result));
+                }
+                break;
+            }
+            {
+                std::lock_guard<std::mutex> lock(slot.mutex);
+                slot.channel = nullptr;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        --live;
+        cv.notify_all();
+    };
+
+    // 返事が timeoutSec + graceSec を過ぎたワーカーは切る（Receive が失敗で返る）
+    std::thread watchdog([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!cv.wait_for(lock, std::chrono::milliseconds(100), [&] { return stop; })) {
+            lock.unlock();
+            const Clock::time_point now = Clock::now();
+            for (const std::unique_ptr<Slot>& slot : slots) {
+                std::lock_guard<std::mutex> slotLock(slot->mutex);
+                if (slot->channel && now >= slot->deadline) {
+                    spdlog::warn("{}: no reply within {} s; disconnecting", slot->name, Seconds(m_config.timeoutSec + m_config.graceSec));
+                    slot->timedOut = true;
+                    slot->deadline = Clock::time_point::max();
+                    slot->channel->Abort();
+                }
+            }
+            lock.lock();
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (const std::unique_ptr<Slot>& slot : slots) threads.emplace_back(runSlot, std::ref(*slot));
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return remaining == 0 || live == 0; });
+        // 使えるワーカーが残っていない
+        while (!queue.empty()) {
+            const size_t i = queue.front();
+            queue.pop_front();
+            FarmResult result;
+            result.error = "no worker available";
+            finish(i, std::move(result));
+        }
+        stop = true;
+        cv.notify_all();
+    }
+    for (std::thread& t : threads) t.join();
+    watchdog.join();
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jisaku {
+
+class ChildProcess;
+class ShaderCache;
+class Socket;
+
+// シェーダーのコンパイルファーム（JisakuShaderPack が使う。D3D/Windows 非依存）。
+// コンパイルはワーカー（自分自身を --worker で起動したプロセス、または --serve している別マシンのプロセス）で行う。
+// ワーカーには #include を展開したソースを送るので、ワーカー側にソースツリーは要らない。
+// - ワーカーが落ちたら（dxc ごとクラッシュした等）その件を別のワーカーでやり直し、落ちたワーカーは起動し直す
+// - dxc が timeoutSec を過ぎたらワーカーが止めて TimedOut を返す。ワーカー自体が返事をしなければ
+//   （timeoutSec + graceSec）接続を切り、落ちたときと同じく別のワーカーでやり直す
+// - 結果はソース・設定・コンパイラのバージョンのキーで ShaderCache に置き、次からはワーカーに送らない
+//
+// - --serve のワーカーは既定ではループバックだけで待ち受ける。別マシンから使うときは待ち受けるアドレスを
+//   明示し、共有トークンを決める（ワーカーは届いたソースをそのまま dxc にかけ、結果を相手に返すので、
+//   #include で任意のファイルを読める。トークンを知らない相手からは Compile を受け付けない）
+//
+// やり取り（リトルエンディアン。パイプでもソケットでも同じ）
+//   フレーム : payloadSize(u32), type(u8), 予約(3 byte), payload
+//   Hello    : version(u32), コンパイラのバージョン（残り全部）。ワーカーが接続直後に送る
+//   Auth     : トークン（残り全部。--worker の子プロセスには空）。親が Hello を受けた直後に送り、
+//              ワーカーは自分のトークンと違えば切る
+//   Compile  : id(u32), timeoutMs(u32), flags(u32), 名前・エントリポイント・ターゲット（それぞれ u32 の長さ + 中身）,
+//              define の数(u32) と define（同上）, ソース（残り全部）
+//   Result   : id(u32), status(u8), 予約(3 byte), バイトコードのサイズ(u32), バイトコード,
+//              Ok なら逆アセンブル（dxc -Fc）・それ以外はエラー文（残り全部）
+constexpr uint32_t kShaderFarmProtocolVersion = 2;
+
+// JisakuShaderPack --serve の既定の待ち受けアドレス（Socket の表記）。別マシンからは届かない
+constexpr const char* kDefaultShaderFarmAddress = "tcp:127.0.0.1:47810";
+// 共有トークンを渡す環境変数（コマンドラインに出さないとき）
+constexpr const char* kShaderFarmTokenVariable = "JISAKU_SHADER_FARM_TOKEN";
+
+// 同じマシンの中からしか届かないアドレスか（unix: / ループバックの tcp:）
+bool IsLocalFarmAddress(const std::string& address);
+
+enum class FarmStatus : uint8_t {
+    Ok = 0,
+    Failed = 1,   // コンパイルエラー・ワーカーが落ちた
+    TimedOut = 2,
+};
+
+// FarmJob::flags
+constexpr uint32_t kFarmDebugInfo = 1u << 0; // -Zi -Qembed_debug
+
+// フレームを運ぶ経路。Abort は任意のスレッドから呼べて、ブロック中の Send / Receive を失敗で返す
+class FarmChannel {
+public:
+    virtual ~FarmChannel() = default;
+    virtual bool Send(const void* data, size_t size) = 0;
+    virtual bool Receive(void* data, size_t size) = 0;
+    virtual void Abort() = 0;
+};
+
+std::unique_ptr<FarmChannel> MakeSocketChannel(std::unique_ptr<Socket> socket);
+// 子プロセスの標準入出力（Abort は子を Kill する）
+std::unique_ptr<FarmChannel> MakeProcessChannel(std::unique_ptr<ChildProcess> process);
+// 自分の標準入出力（--worker 側）
+std::unique_ptr<FarmChannel> MakeStdioChannel();
+
+struct FarmJob {
+    std::string name;   // ソースの仮想パス（ログ用。dxc のエラー文の一時ファイル名もこれに置き換える）
+    std::string source; // ExpandShaderIncludes の text
+    std::string entry;
+    std::string target;
+    std::vector<std::string> defines; // "NAME=VALUE"
+    uint32_t flags = 0;
+};
+
+struct FarmResult {
+    FarmStatus status = FarmStatus::Failed;
+    bool cached = false;
+    std::vector<uint8_t> bytecode;
+    std::string listing; // Ok のとき
+    std::string error;   // Ok 以外のとき
+};
+
+// "dxc --version" の 1 行目（キャッシュのキーと、ワーカーのコンパイラが同じかの確認に使う）。起動できなければ空
+std::string QueryDxcVersion(const std::string& dxc);
+
+// ワーカーの本体。Hello を送り、Auth のトークンが token と同じなら Compile を 1 件ずつ処理し、相手が閉じたら戻る。
+// 同じ dxc を使う限り、複数のスレッドから別々の channel で同時に呼んでよい
+void RunFarmWorker(FarmChannel& channel, const std::string& dxc, const std::string& compiler,
+                   const std::string& token = {});
+
+class ShaderFarm {
+public:
+    struct Config {
+        std::string executable;           // --worker で起動する実行ファイル（自分自身）
+        std::string dxc = "dxc";
+        std::string compiler;             // QueryDxcVersion。Hello がこれと違うワーカーは使わない
+        uint32_t localWorkers = 0;        // 起動するワーカープロセスの数
+        std::vector<std::string> remotes; // --serve しているワーカーのアドレス（1 つにつき 1 接続。同時に n 件なら n 回並べる）
+        std::string token;                // remotes に送る共有トークン
+        double timeoutSec = 120.0;        // 1 件あたり
+        double graceSec = 10.0;           // timeoutSec を過ぎてもワーカーが返事をしなければ切るまでの猶予
+        uint32_t maxAttempts = 2;         // ワーカーが落ちた・返事が無いときのやり直しを含めた回数
+        ShaderCache* cache = nullptr;     // null ならキャッシュしない
+    };
+
+    struct Stats {
+        size_t cached = 0;
+        size_t compiled = 0;
+        size_t failed = 0;
+        size_t timedOut = 0;
+        size_t retried = 0;       // ワーカーが落ちた・返事が無いのでやり直した件数
+        size_t workerRestarts = 0;
+        uint32_t workers = 0;     // 使えたワーカー（接続）の数
+    };
+
+    explicit ShaderFarm(const Config& config) : m_config(config) {}
+
+    ShaderFarm(const ShaderFarm&) = delete;
+    ShaderFarm& operator=(const ShaderFarm&) = delete;
+
+    // すべて終わるまで戻らない。results は jobs と同じ並び。ワーカーが 1 つも使えなければ残りは Failed
+    void Run(const std::vector<FarmJob>& jobs, std::vector<FarmResult>& results);
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    Config m_config;
+    Stats m_stats;
+};
+
+} // namespace jisaku
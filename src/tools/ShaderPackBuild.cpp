@@ -0,0 +1,303 @@
+// シェーダーパックのビルドツール（D3D/Windows 非依存）。
+//   JisakuShaderPack [オプション] <一覧ファイル>...
+//   JisakuShaderPack --serve [アドレス] [--dxc PATH] [--token TOKEN]   （別マシンのワーカーとして待ち受ける）
+// - 一覧ファイルの 1 行が 1 エントリ: "<仮想パス> <エントリポイント> <ターゲット> [NAME=VALUE ...]"（# 以降はコメント）。
+//   同じエントリポイントを define を変えて並べればパーミュテーションになる
+// - エントリごとに #include を展開したソースを作り、キャッシュ（--cache）に無いものだけをワーカーで dxc にかける。
+//   ワーカーは自分自身を --worker で --jobs 個起動したもの + --remote で指定した --serve 中のプロセス
+//   （仕組みは tools/ShaderFarm.h を参照）。返ってきた逆アセンブルの表からリフレクション
+//   （入力シグネチャ・リソースのバインド）を読んでパックに入れる
+// - 1 つでも失敗したらパックは書かない（前のパックが残る）
+// 実行時は ShaderCompiler::LoadPack で読む。形式は core/ShaderPack.h を参照
+#include "tools/ShaderFarm.h"
+#include "core/ChildProcess.h"
+#include "core/ShaderCache.h"
+#include "core/ShaderPack.h"
+#include "core/Socket.h"
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+struct Options {
+    std::filesystem::path root = ".";
+    std::filesystem::path out = "shaders.jspk";
+    std::filesystem::path cache = ".shaderpackcache";
+    std::string dxc = "dxc";
+    uint32_t jobs = ~0u; // ローカルのワーカー数。未指定なら hardware_concurrency（0 なら --remote だけを使う）
+    std::vector<std::string> remotes;
+    uint32_t remoteJobs = 1; // --remote 1 つあたりの接続数（同時にコンパイルする数）
+    double timeoutSec = 120.0;
+    bool debug = false; // デバッグ情報を埋め込む（実行時コンパイルと同じ -Zi -Qembed_debug）
+    bool worker = false;
+    std::string serve; // 空でなければワーカーとして待ち受ける
+    std::string token; // --serve / --remote の共有トークン（未指定なら JISAKU_SHADER_FARM_TOKEN）
+    uint32_t maxConnections = 0; // --serve で同時に受ける接続の数。0 なら hardware_concurrency
+    std::vector<std::string> lists;
+};
+
+struct Job {
+    ShaderPackEntry entry;
+    std::vector<uint8_t> bytecode;
+    std::string source; // 一覧ファイルの位置（エラー表示用）
+};
+
+std::string ToUtf8(const std::filesystem::path& path) {
+    const std::u8string s = path.generic_u8string();
+    return std::string(s.begin(), s.end());
+}
+
+std::filesystem::path FromUtf8(std::string_view s) {
+    return std::filesystem::path(std::u8string(s.begin(), s.end()));
+}
+
+bool ReadWholeFile(const std::filesystem::path& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+bool ParseList(const std::filesystem::path& file, std::vector<Job>& jobs) {
+    std::ifstream in(file);
+    if (!in) {
+        spdlog::error("Cannot read {}", ToUtf8(file));
+        return false;
+    }
+    bool ok = true;
+    std::string line;
+    for (size_t lineNo = 1; std::getline(in, line); ++lineNo) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        Job job;
+        if (!(words >> job.entry.path)) continue;
+        job.source = ToUtf8(file) + ":" + std::to_string(lineNo);
+        if (!(words >> job.entry.entry >> job.entry.target)) {
+            spdlog::error("{}: expected <path> <entry> <target> [NAME=VALUE ...]", job.source);
+            ok = false;
+            continue;
+        }
+        for (std::string d; words >> d;) job.entry.defines.push_back(d);
+        job.entry.id = MakeShaderId(job.entry.path, job.entry.entry, job.entry.defines);
+        jobs.push_back(std::move(job));
+    }
+    return ok;
+}
+
+// エントリの #include を展開したソース（ワーカーに送る・キャッシュのキーになる）
+bool MakeFarmJob(const Options& opt, const Job& job, FarmJob& out) {
+    const ShaderFileReader read = [&](const std::string& path, std::string& text) {
+        return ReadWholeFile(opt.root / FromUtf8(path), text);
+    };
+    ShaderSource source;
+    std::string error;
+    if (!ExpandShaderIncludes(job.entry.path, read, { "shaders" }, source, error)) {
+        spdlog::error("{}: {}", job.source, error);
+        return false;
+    }
+    out.name = job.entry.path;
+    out.source = std::move(source.text);
+    out.entry = job.entry.entry;
+    out.target = job.entry.target;
+    out.defines = job.entry.defines;
+    out.flags = opt.debug ? kFarmDebugInfo : 0;
+    return true;
+}
+
+// --worker: 標準入出力で親とやり取りする
+int RunWorker(const Options& opt) {
+    // 標準出力はやり取りに使うので、ログは標準エラーへ
+    spdlog::set_default_logger(spdlog::stderr_color_st("worker"));
+    const std::string compiler = QueryDxcVersion(opt.dxc);
+    if (compiler.empty()) spdlog::error("Cannot run {} --version", opt.dxc);
+    std::unique_ptr<FarmChannel> channel = MakeStdioChannel();
+    RunFarmWorker(*channel, opt.dxc, compiler);
+    return 0;
+}
+
+// --serve: 接続 1 本につきスレッド 1 本でワーカーとして動く（Ctrl+C で止める）。
+// 同時に受けるのは maxConnections 本までで、それを超えた接続はすぐ閉じる
+int RunServer(const Options& opt) {
+    // 届いたソースをそのまま dxc にかけるので、ほかのマシンから届くアドレスではトークンを必須にする
+    if (!IsLocalFarmAddress(opt.serve) && opt.token.empty()) {
+        spdlog::error("--serve {} is reachable from other machines; set a shared token with --token or {}",
+                      opt.serve, kShaderFarmTokenVariable);
+        return 2;
+    }
+    const std::string compiler = QueryDxcVersion(opt.dxc);
+    if (compiler.empty()) {
+        spdlog::error("Cannot run {} --version", opt.dxc);
+        return 1;
+    }
+    std::unique_ptr<Socket> listener = Socket::Listen(opt.serve);
+    if (!listener) {
+        spdlog::error("Cannot listen on {}", opt.serve);
+        return 1;
+    }
+    const uint32_t maxConnections = opt.maxConnections ? opt.maxConnections : std::max(1u, std::thread::hardware_concurrency());
+    spdlog::info("Compiling shaders for {} on {} (up to {} connections)", compiler, opt.serve, maxConnections);
+    auto active = std::make_shared<std::atomic<uint32_t>>(0);
+    while (std::unique_ptr<Socket> socket = listener->Accept()) {
+        if (active->fetch_add(1) >= maxConnections) {
+            active->fetch_sub(1);
+            spdlog::warn("Too many connections; closing a new one (limit {})", maxConnections);
+            continue;
+        }
+        std::thread([&opt, compiler, active, socket = std::move(socket)]() mutable {
+            std::unique_ptr<FarmChannel> channel = MakeSocketChannel(std::move(socket));
+            RunFarmWorker(*channel, opt.dxc, compiler, opt.token);
+            channel.reset();
+            active->fetch_sub(1);
+        }).detach();
+    }
+    return 0;
+}
+
+int RunBuild(const Options& opt) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+
+    std::vector<Job> jobs;
+    bool ok = true;
+    for (const std::string& list : opt.lists) ok = ParseList(FromUtf8(list), jobs) && ok;
+    if (!ok) return 1;
+
+    std::vector<FarmJob> farmJobs(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) ok = MakeFarmJob(opt, jobs[i], farmJobs[i]) && ok;
+    if (!ok) return 1;
+
+    ShaderFarm::Config config;
+    config.executable = ToUtf8(ChildProcess::GetExecutablePath());
+    config.dxc = opt.dxc;
+    config.compiler = QueryDxcVersion(opt.dxc);
+    if (config.compiler.empty()) {
+        spdlog::error("Cannot run {} --version", opt.dxc);
+        return 1;
+    }
+    config.localWorkers = opt.jobs != ~0u ? opt.jobs : std::max(1u, std::thread::hardware_concurrency());
+    for (const std::string& address : opt.remotes) {
+        for (uint32_t n = 0; n < opt.remoteJobs; ++n) config.remotes.push_back(address);
+    }
+    config.token = opt.token;
+    config.timeoutSec = opt.timeoutSec;
+    ShaderCache cache(opt.cache);
+    config.cache = &cache;
+
+    ShaderFarm farm(config);
+    std::vector<FarmResult> results;
+    farm.Run(farmJobs, results);
+
+    size_t failed = 0;
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        FarmResult& result = results[i];
+        if (result.status != FarmStatus::Ok) {
+            spdlog::error("{}: {}:{} failed\n{}", jobs[i].source, jobs[i].entry.path, jobs[i].entry.entry, result.error);
+            ++failed;
+            continue;
+        }
+        jobs[i].bytecode = std::move(result.bytecode);
+        ParseDxilReflection(result.listing, jobs[i].entry.reflection);
+        bytes += jobs[i].bytecode.size();
+    }
+    if (failed > 0) {
+        spdlog::error("{} of {} shaders failed; {} not written", failed, jobs.size(), ToUtf8(opt.out));
+        return 1;
+    }
+
+    // 一覧の並びに依らず同じパックになるように ID 順で書く
+    std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.entry.id < b.entry.id; });
+    std::vector<ShaderPackEntry> entries;
+    std::vector<std::vector<uint8_t>> bytecodes;
+    for (Job& job : jobs) {
+        entries.push_back(std::move(job.entry));
+        bytecodes.push_back(std::move(job.bytecode));
+    }
+    std::string error;
+    if (!WriteShaderPack(opt.out, entries, bytecodes, error)) {
+        spdlog::error("{}", error);
+        return 1;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    const ShaderFarm::Stats& stats = farm.GetStats();
+    spdlog::info("{}: {} shaders, {} bytes of bytecode ({} cached, {} compiled, {} retried; {} workers, {:.1f} ms)",
+                 ToUtf8(opt.out), entries.size(), bytes, stats.cached, stats.compiled, stats.retried, stats.workers, ms);
+    return 0;
+}
+
+void PrintUsage() {
+    std::cerr <<
+        "usage: JisakuShaderPack [options] <list file>...\n"
+        "       JisakuShaderPack --serve [ADDRESS] [--dxc PATH] [--token TOKEN] [--max-connections N]\n"
+        "  list file lines:   <virtual path> <entry> <target> [NAME=VALUE ...]\n"
+        "  --root DIR         base directory for virtual paths (default .)\n"
+        "  --out FILE         pack to write (default shaders.jspk)\n"
+        "  --cache DIR        compiled shader cache (default .shaderpackcache)\n"
+        "  --jobs N           local worker processes (default: hardware threads; 0 = remote only)\n"
+        "  --remote ADDRESS   also compile on a --serve worker (unix:PATH | tcp:HOST:PORT; repeatable)\n"
+        "  --remote-jobs N    connections per --remote worker (default 1)\n"
+        "  --timeout SEC      per-shader compile timeout (default 120)\n"
+        "  --dxc PATH         shader compiler (default dxc)\n"
+        "  --debug            embed debug information\n"
+        "  --serve [ADDRESS]  run as a remote worker (default " << kDefaultShaderFarmAddress << ", loopback only;\n"
+        "                     other addresses require a token)\n"
+        "  --token TOKEN      shared secret for --serve and --remote (default: $" << kShaderFarmTokenVariable << ")\n"
+        "  --max-connections N  concurrent --serve connections (default: hardware threads)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (a == "--debug") opt.debug = true;
+        else if (a == "--worker") opt.worker = true;
+        else if (a == "--serve") opt.serve = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : kDefaultShaderFarmAddress;
+        else if (a == "--root" && value(v)) opt.root = FromUtf8(v);
+        else if (a == "--out" && value(v)) opt.out = FromUtf8(v);
+        else if (a == "--cache" && value(v)) opt.cache = FromUtf8(v);
+        else if (a == "--dxc" && value(v)) opt.dxc = v;
+        else if (a == "--jobs" && value(v)) opt.jobs = uint32_t(std::stoul(v));
+        else if (a == "--remote" && value(v)) opt.remotes.push_back(v);
+        else if (a == "--remote-jobs" && value(v)) opt.remoteJobs = std::max(1u, uint32_t(std::stoul(v)));
+        else if (a == "--timeout" && value(v)) opt.timeoutSec = std::stod(v);
+        else if (a == "--token" && value(v)) opt.token = v;
+        else if (a == "--max-connections" && value(v)) opt.maxConnections = uint32_t(std::stoul(v));
+        else if (!a.empty() && a[0] != '-') opt.lists.push_back(a);
+        else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (opt.token.empty()) {
+        if (const char* token = std::getenv(kShaderFarmTokenVariable)) opt.token = token;
+    }
+    if (opt.worker) return RunWorker(opt);
+    if (!opt.serve.empty()) return RunServer(opt);
+    if (opt.lists.empty() || (opt.jobs == 0 && opt.remotes.empty())) {
+        PrintUsage();
+        return 2;
+    }
+    return RunBuild(opt);
+}
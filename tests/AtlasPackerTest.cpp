@@ -0,0 +1,74 @@
+#include "gfx/AtlasPacker.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+bool Overlaps(const AtlasRect& a, const AtlasRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+void ExpectDisjointAndInside(const std::vector<AtlasRect>& rects, uint32_t page) {
+    for (size_t i = 0; i < rects.size(); ++i) {
+        EXPECT_LE(rects[i].x + rects[i].width, page);
+        EXPECT_LE(rects[i].y + rects[i].height, page);
+        for (size_t j = i + 1; j < rects.size(); ++j) EXPECT_FALSE(Overlaps(rects[i], rects[j])) << i << " vs " << j;
+    }
+}
+
+} // namespace
+
+// 挿入と返却を繰り返しても重ならず、ページからはみ出さない
+TEST(AtlasPacker, ChurnKeepsRectsDisjoint) {
+    AtlasPacker packer(256, 256);
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<uint32_t> side(4, 40);
+    std::vector<AtlasRect> live;
+    AtlasRect r;
+    for (int i = 0; i < 2000; ++i) {
+        if (!live.empty() && rng() % 2 == 0) {
+            const size_t victim = rng() % live.size();
+            packer.Remove(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        } else if (packer.Insert(side(rng), side(rng), r)) {
+            live.push_back(r);
+        }
+    }
+    ExpectDisjointAndInside(live, 256);
+    uint64_t area = 0;
+    for (const AtlasRect& l : live) area += uint64_t(l.width) * l.height;
+    EXPECT_EQ(packer.GetUsedArea(), area);
+}
+
+// 大きさの揃わない矩形を返却し終えたら、辺の結合だけでは戻らない場合でもページ全体が空く
+TEST(AtlasPacker, FreedSpaceIsReusableAfterFragmentation) {
+    AtlasPacker packer(128, 128);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<uint32_t> side(5, 23);
+    std::vector<AtlasRect> cells;
+    AtlasRect r;
+    for (int i = 0; i < 200; ++i) {
+        if (packer.Insert(side(rng), side(rng), r)) cells.push_back(r);
+    }
+    ASSERT_GT(cells.size(), 20u);
+    std::shuffle(cells.begin(), cells.end(), rng);
+    for (const AtlasRect& c : cells) packer.Remove(c);
+    EXPECT_EQ(packer.GetUsedArea(), 0u);
+    EXPECT_TRUE(packer.Insert(128, 128, r));
+}
+
+// Insert で得ていない矩形の返却は無視する
+TEST(AtlasPacker, RemoveIgnoresUnknownRect) {
+    AtlasPacker packer(64, 64);
+    AtlasRect r;
+    ASSERT_TRUE(packer.Insert(32, 32, r));
+    packer.Remove({ 32, 32, 8, 8 });
+    EXPECT_EQ(packer.GetUsedArea(), 32u * 32u);
+    AtlasRect other;
+    EXPECT_FALSE(packer.Insert(64, 64, other));
+}
@@ -0,0 +1,115 @@
+#include "core/AtomicFile.h"
+#include "core/ByteOrder.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+std::string ReadText(const std::filesystem::path& file) {
+    std::ifstream f(file, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+// dir に残っているファイルの数（一時ファイルの消し忘れを見る）
+size_t CountFiles(const std::filesystem::path& dir) {
+    size_t n = 0;
+    for (const auto& e : std::filesystem::directory_iterator(dir)) n += e.is_regular_file() ? 1 : 0;
+    return n;
+}
+
+class AtomicFileTest : public ::testing::Test {
+protected:
+    void SetUp() override { m_dir = CreateTempDirectory("jisaku-atomictest-"); }
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(m_dir, ec);
+    }
+    std::filesystem::path m_dir;
+};
+
+} // namespace
+
+// 新規作成も上書きもでき、一時ファイルは残らない
+TEST_F(AtomicFileTest, WritesAndReplaces) {
+    ASSERT_FALSE(m_dir.empty());
+    const auto file = m_dir / "out.bin";
+    ASSERT_TRUE(WriteFileAtomic(file, "first", 5));
+    EXPECT_EQ(ReadText(file), "first");
+    ASSERT_TRUE(WriteFileAtomic(file, [](std::ostream& out) { return bool(out << "second"); }));
+    EXPECT_EQ(ReadText(file), "second");
+    EXPECT_EQ(CountFiles(m_dir), 1u);
+}
+
+// write が失敗したら前の内容が残り、一時ファイルは消える
+TEST_F(AtomicFileTest, FailedWriteKeepsOldContents) {
+    const auto file = m_dir / "out.bin";
+    ASSERT_TRUE(WriteFileAtomic(file, "keep", 4));
+    EXPECT_FALSE(WriteFileAtomic(file, [](std::ostream& out) {
+        out << "partial";
+        return false;
+    }));
+    EXPECT_EQ(ReadText(file), "keep");
+    EXPECT_EQ(CountFiles(m_dir), 1u);
+
+    // 書き込み先のディレクトリが無いときも失敗するだけ
+    EXPECT_FALSE(WriteFileAtomic(m_dir / "no-such-dir" / "out.bin", "x", 1));
+}
+
+// 同じファイルへ並んで書いても、結果はどれか 1 つの書き込みの内容そのまま
+TEST_F(AtomicFileTest, ConcurrentWritersNeverInterleave) {
+    const auto file = m_dir / "shared.bin";
+    constexpr int kWriters = 4;
+    constexpr size_t kSize = 256 * 1024;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kWriters; ++t) {
+        threads.emplace_back([&file, t] {
+            const std::string body(kSize, char('a' + t));
+            for (int i = 0; i < 20; ++i) WriteFileAtomic(file, body.data(), body.size());
+        });
+    }
+    for (std::thread& t : threads) t.join();
+
+    const std::string result = ReadText(file);
+    ASSERT_EQ(result.size(), kSize);
+    EXPECT_EQ(result.find_first_not_of(result[0]), std::string::npos);
+    EXPECT_EQ(CountFiles(m_dir), 1u);
+}
+
+// 作るたびに別のディレクトリになる
+TEST(TempDirectory, IsUnique) {
+    const auto a = CreateTempDirectory("jisaku-tmptest-");
+    const auto b = CreateTempDirectory("jisaku-tmptest-");
+    ASSERT_FALSE(a.empty());
+    ASSERT_FALSE(b.empty());
+    EXPECT_NE(a, b);
+    EXPECT_TRUE(std::filesystem::is_directory(a));
+    std::error_code ec;
+    std::filesystem::remove_all(a, ec);
+    std::filesystem::remove_all(b, ec);
+}
+
+// リトルエンディアンで、整列していない位置でも読み書きできる
+TEST(ByteOrder, LittleEndianUnaligned) {
+    uint8_t buf[16] = {};
+    WriteU32(buf + 1, 0x04030201u);
+    EXPECT_EQ(buf[1], 0x01);
+    EXPECT_EQ(buf[4], 0x04);
+    EXPECT_EQ(ReadU32(buf + 1), 0x04030201u);
+    EXPECT_EQ(ReadU16(buf + 1), 0x0201u);
+
+    WriteU64(buf + 3, 0xf1e2d3c4b5a69788ull);
+    EXPECT_EQ(buf[3], 0x88);
+    EXPECT_EQ(buf[10], 0xf1);
+    EXPECT_EQ(ReadU64(buf + 3), 0xf1e2d3c4b5a69788ull);
+    // 上位ビットが立っていても符号拡張されない
+    const uint8_t high[4] = { 0xff, 0xff, 0xff, 0xff };
+    EXPECT_EQ(ReadU32(high), 0xffffffffu);
+    EXPECT_EQ(ReadU16(high), 0xffffu);
+}
@@ -0,0 +1,210 @@
+#include "gfx/BCEncoder.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// 写真に近い入力: なめらかなグラデーション + 弱いノイズ + 硬い縁 + アルファの段差。端の部分ブロックも出るサイズにする
+Image MakeTestImage(uint32_t width, uint32_t height) {
+    Image img;
+    img.Allocate(width, height);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> noise(-6, 6);
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* row = img.View().Row(y);
+        for (uint32_t x = 0; x < width; ++x) {
+            const float u = float(x) / float(width), v = float(y) / float(height);
+            int r = int(255.0f * u), g = int(255.0f * v), b = int(128.0f + 127.0f * std::sin(6.28f * (u + v)));
+            if ((x / 37 + y / 29) % 5 == 0) { r = 255 - r; b = 30; } // 硬い縁
+            const int a = x < width / 2 ? 255 : int(255.0f * v);
+            row[x * 4 + 0] = uint8_t(std::clamp(r + noise(rng), 0, 255));
+            row[x * 4 + 1] = uint8_t(std::clamp(g + noise(rng), 0, 255));
+            row[x * 4 + 2] = uint8_t(std::clamp(b + noise(rng), 0, 255));
+            row[x * 4 + 3] = uint8_t(a);
+        }
+    }
+    return img;
+}
+
+// ---------------------------------------------------------------------------
+// 参照デコーダ（D3D の仕様どおり。エンコーダのコードは使わない）
+// ---------------------------------------------------------------------------
+void Expand565(uint16_t v, int out[3]) {
+    const int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+void DecodeBC1(const uint8_t* in, uint8_t out[16][4], bool forceFourColor) {
+    const uint16_t c0 = uint16_t(in[0] | (in[1] << 8)), c1 = uint16_t(in[2] | (in[3] << 8));
+    int pal[4][4];
+    Expand565(c0, pal[0]);
+    Expand565(c1, pal[1]);
+    pal[0][3] = pal[1][3] = pal[2][3] = pal[3][3] = 255;
+    for (int c = 0; c < 3; ++c) {
+        if (c0 > c1 || forceFourColor) {
+            pal[2][c] = (2 * pal[0][c] + pal[1][c]) / 3;
+            pal[3][c] = (pal[0][c] + 2 * pal[1][c]) / 3;
+        } else {
+            pal[2][c] = (pal[0][c] + pal[1][c]) / 2;
+            pal[3][c] = 0;
+        }
+    }
+    if (c0 <= c1 && !forceFourColor) pal[3][3] = 0;
+    const uint32_t bits = uint32_t(in[4]) | (uint32_t(in[5]) << 8) | (uint32_t(in[6]) << 16) | (uint32_t(in[7]) << 24);
+    for (int i = 0; i < 16; ++i) {
+        const int k = (bits >> (2 * i)) & 3;
+        for (int c = 0; c < 4; ++c) out[i][c] = uint8_t(pal[k][c]);
+    }
+}
+
+void DecodeBC4(const uint8_t* in, uint8_t out[16][4], int channel) {
+    const int r0 = in[0], r1 = in[1];
+    int pal[8] = { r0, r1 };
+    if (r0 > r1) {
+        for (int k = 2; k < 8; ++k) pal[k] = ((8 - k) * r0 + (k - 1) * r1) / 7;
+    } else {
+        for (int k = 2; k < 6; ++k) pal[k] = ((6 - k) * r0 + (k - 1) * r1) / 5;
+        pal[6] = 0;
+        pal[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) bits |= uint64_t(in[2 + i]) << (8 * i);
+    for (int i = 0; i < 16; ++i) out[i][channel] = uint8_t(pal[(bits >> (3 * i)) & 7]);
+}
+
+// BC7 はエンコーダが出す mode 6 だけを読む。他のモードなら false
+bool DecodeBC7Mode6(const uint8_t* in, uint8_t out[16][4]) {
+    int pos = 0;
+    auto get = [&](int bits) {
+        uint32_t v = 0;
+        for (int i = 0; i < bits; ++i, ++pos) v |= uint32_t((in[pos >> 3] >> (pos & 7)) & 1) << i;
+        return v;
+    };
+    if (get(7) != (1u << 6)) return false;
+    int e[2][4];
+    for (int c = 0; c < 4; ++c) {
+        e[0][c] = int(get(7)) << 1;
+        e[1][c] = int(get(7)) << 1;
+    }
+    const int p0 = int(get(1)), p1 = int(get(1));
+    static const int kWeights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    for (int i = 0; i < 16; ++i) {
+        const int w = kWeights[get(i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; ++c) out[i][c] = uint8_t(((64 - w) * (e[0][c] | p0) + w * (e[1][c] | p1) + 32) >> 6);
+    }
+    return true;
+}
+
+// 圧縮して参照デコーダで戻し、channels のチャンネルだけで PSNR を測る
+double RoundTripPsnr(const Image& src, BCFormat format, BCQuality quality, const std::vector<int>& channels) {
+    const uint32_t bw = (src.width + 3) / 4, bh = (src.height + 3) / 4;
+    const size_t pitch = BCRowPitch(format, src.width);
+    std::vector<uint8_t> blocks(BCSurfaceSize(format, src.width, src.height));
+    BCEncodeOptions opt;
+    opt.format = format;
+    opt.quality = quality;
+    if (!EncodeBC(src.View(), opt, blocks.data(), pitch)) return 0.0;
+
+    double sum = 0.0;
+    size_t count = 0;
+    for (uint32_t by = 0; by < bh; ++by) {
+        for (uint32_t bx = 0; bx < bw; ++bx) {
+            const uint8_t* in = blocks.data() + by * pitch + bx * BCBlockBytes(format);
+            uint8_t px[16][4] = {};
+            switch (format) {
+            case BCFormat::BC1: DecodeBC1(in, px, false); break;
+            case BCFormat::BC3: {
+                uint8_t color[16][4];
+                DecodeBC1(in + 8, color, true);
+                for (int i = 0; i < 16; ++i) std::memcpy(px[i], color[i], 3);
+                DecodeBC4(in, px, 3);
+                break;
+            }
+            case BCFormat::BC4: DecodeBC4(in, px, 0); break;
+            case BCFormat::BC5: DecodeBC4(in, px, 0); DecodeBC4(in + 8, px, 1); break;
+            case BCFormat::BC7: if (!DecodeBC7Mode6(in, px)) return 0.0; break;
+            default: return 0.0;
+            }
+            for (uint32_t i = 0; i < 16; ++i) {
+                const uint32_t x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                if (x >= src.width || y >= src.height) continue;
+                const uint8_t* s = src.View().Row(y) + x * 4;
+                for (int c : channels) {
+                    const double d = double(s[c]) - double(px[i][c]);
+                    sum += d * d;
+                    ++count;
+                }
+            }
+        }
+    }
+    const double mse = sum / double(count);
+    return mse == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+struct PsnrCase {
+    BCFormat format;
+    std::vector<int> channels;
+    double minFast;
+    double minHigh;
+};
+
+} // namespace
+
+// 参照デコーダで戻した画質の下限。High は Fast より悪くならないこと
+TEST(BCEncoder, RoundTripPsnrMeetsFloor) {
+    const Image img = MakeTestImage(258, 130);
+    const PsnrCase cases[] = {
+        { BCFormat::BC1, { 0, 1, 2 }, 34.5, 36.0 },
+        { BCFormat::BC3, { 0, 1, 2, 3 }, 36.0, 37.0 },
+        { BCFormat::BC4, { 0 }, 44.0, 46.5 },
+        { BCFormat::BC5, { 0, 1 }, 46.0, 48.0 },
+        { BCFormat::BC7, { 0, 1, 2, 3 }, 36.5, 38.5 },
+    };
+    for (const PsnrCase& c : cases) {
+        const double fast = RoundTripPsnr(img, c.format, BCQuality::Fast, c.channels);
+        const double high = RoundTripPsnr(img, c.format, BCQuality::High, c.channels);
+        EXPECT_GE(fast, c.minFast) << "format " << int(c.format);
+        EXPECT_GE(high, c.minHigh) << "format " << int(c.format);
+        EXPECT_GE(high, fast) << "format " << int(c.format);
+    }
+}
+
+// 単色ブロックは BC1/BC4 なら誤差なく戻る（BC7 mode 6 は p-bit が全チャンネル共通なので 255 と 0 を同時には表せない）
+TEST(BCEncoder, SolidColorIsExact) {
+    Image img;
+    img.Allocate(8, 8);
+    for (size_t i = 0; i < img.pixels.size(); i += 4) {
+        img.pixels[i + 0] = 255;
+        img.pixels[i + 1] = 0;
+        img.pixels[i + 2] = 255; // 565 で正確に表せる色
+        img.pixels[i + 3] = 255;
+    }
+    EXPECT_GE(RoundTripPsnr(img, BCFormat::BC1, BCQuality::High, { 0, 1, 2 }), 99.0);
+    EXPECT_GE(RoundTripPsnr(img, BCFormat::BC4, BCQuality::High, { 0 }), 99.0);
+    EXPECT_GE(RoundTripPsnr(img, BCFormat::BC7, BCQuality::High, { 0, 1, 2, 3 }), 48.0);
+}
+
+// 並列と逐次で同じバイト列になる
+TEST(BCEncoder, ParallelMatchesSerial) {
+    const Image img = MakeTestImage(131, 67);
+    for (BCFormat format : { BCFormat::BC1, BCFormat::BC3, BCFormat::BC5, BCFormat::BC7 }) {
+        const size_t pitch = BCRowPitch(format, img.width);
+        std::vector<uint8_t> serial(BCSurfaceSize(format, img.width, img.height)), parallel(serial.size());
+        BCEncodeOptions opt;
+        opt.format = format;
+        opt.quality = BCQuality::High;
+        opt.parallel = false;
+        ASSERT_TRUE(EncodeBC(img.View(), opt, serial.data(), pitch));
+        opt.parallel = true;
+        ASSERT_TRUE(EncodeBC(img.View(), opt, parallel.data(), pitch));
+        EXPECT_EQ(serial, parallel) << "format " << int(format);
+    }
+}
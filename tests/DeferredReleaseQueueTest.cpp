@@ -0,0 +1,125 @@
+#include "core/DeferredReleaseQueue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// DX12Device のフェンスの代わり。Submit で次のフェンス値へ進め、Complete で GPU がそこまで終えたことにする
+struct FakeFence {
+    uint64_t next = 1;
+    uint64_t completed = 0;
+
+    uint64_t GetNextFenceValue() const { return next; }
+    void Submit() { ++next; }
+    void Complete(uint64_t value) { completed = value; }
+};
+
+} // namespace
+
+// 預けたものは、GPU がそのフェンス値を過ぎるまで破棄されない
+TEST(DeferredReleaseQueue, RetireWaitsForFence) {
+    FakeFence fence;
+    DeferredReleaseQueue queue;
+    std::weak_ptr<int> first, second;
+    {
+        auto a = std::make_shared<int>(1);
+        first = a;
+        queue.Retire(fence.GetNextFenceValue(), std::move(a));
+        fence.Submit();
+        auto b = std::make_shared<int>(2);
+        second = b;
+        queue.Retire(fence.GetNextFenceValue(), std::move(b));
+        fence.Submit();
+    }
+    EXPECT_EQ(queue.Size(), 2u);
+    EXPECT_EQ(queue.Collect(fence.completed), 0u);
+    EXPECT_FALSE(first.expired());
+
+    fence.Complete(1);
+    EXPECT_EQ(queue.Collect(fence.completed), 1u);
+    EXPECT_TRUE(first.expired());
+    EXPECT_FALSE(second.expired());
+    EXPECT_EQ(queue.Size(), 1u);
+
+    fence.Complete(2);
+    EXPECT_EQ(queue.Collect(fence.completed), 1u);
+    EXPECT_TRUE(second.expired());
+    EXPECT_EQ(queue.Size(), 0u);
+    EXPECT_EQ(queue.GetReleasedCount(), 2u);
+}
+
+// Defer の関数は、フェンス値の小さい順・同じ値なら預けた順に呼ばれる
+TEST(DeferredReleaseQueue, DeferRunsInFenceOrder) {
+    DeferredReleaseQueue queue;
+    std::vector<int> order;
+    queue.Defer(3, [&order] { order.push_back(30); });
+    queue.Defer(1, [&order] { order.push_back(10); });
+    queue.Defer(3, [&order] { order.push_back(31); });
+    queue.Defer(2, [&order] { order.push_back(20); });
+
+    EXPECT_EQ(queue.Collect(2), 2u);
+    EXPECT_EQ(order, (std::vector<int>{ 10, 20 }));
+    EXPECT_EQ(queue.Collect(5), 2u);
+    EXPECT_EQ(order, (std::vector<int>{ 10, 20, 30, 31 }));
+}
+
+// 解放の中から Retire / Defer してもデッドロックせず、次の Collect で手放される
+TEST(DeferredReleaseQueue, ReleaseCanRetireMore) {
+    DeferredReleaseQueue queue;
+    int calls = 0;
+    queue.Defer(1, [&queue, &calls] {
+        ++calls;
+        queue.Defer(2, [&calls] { ++calls; });
+    });
+    EXPECT_EQ(queue.Collect(1), 1u);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(queue.Size(), 1u);
+    EXPECT_EQ(queue.Collect(2), 1u);
+    EXPECT_EQ(calls, 2);
+}
+
+// ReleaseAll と破棄はフェンスを見ずにすべて手放す
+TEST(DeferredReleaseQueue, ReleaseAllAndDestructor) {
+    std::weak_ptr<int> held;
+    int calls = 0;
+    {
+        DeferredReleaseQueue queue;
+        queue.Defer(100, [&calls] { ++calls; });
+        EXPECT_EQ(queue.ReleaseAll(), 1u);
+        EXPECT_EQ(calls, 1);
+
+        auto p = std::make_shared<int>(0);
+        held = p;
+        queue.Retire(UINT64_MAX, std::move(p));
+        queue.Defer(200, [&calls] { ++calls; });
+    }
+    EXPECT_TRUE(held.expired());
+    EXPECT_EQ(calls, 2);
+}
+
+// 複数のスレッドから預けても、数え漏れなくすべて手放される
+TEST(DeferredReleaseQueue, ConcurrentRetire) {
+    constexpr int kThreads = 4, kPerThread = 1000;
+    DeferredReleaseQueue queue;
+    std::atomic<int> released{ 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&queue, &released] {
+            for (int i = 0; i < kPerThread; ++i) queue.Defer(uint64_t(i % 8), [&released] { ++released; });
+        });
+    }
+    size_t collected = 0;
+    for (uint64_t completed = 0; completed < 8; ++completed) collected += queue.Collect(completed);
+    for (std::thread& t : threads) t.join();
+    collected += queue.Collect(7);
+    EXPECT_EQ(collected, size_t(kThreads * kPerThread));
+    EXPECT_EQ(released.load(), kThreads * kPerThread);
+    EXPECT_EQ(queue.Size(), 0u);
+    EXPECT_EQ(queue.GetReleasedCount(), uint64_t(kThreads * kPerThread));
+}
@@ -0,0 +1,106 @@
+#include "core/DependencyGraph.h"
+#include "core/ShaderCache.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+std::vector<std::string> Sorted(std::vector<std::string> v) {
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+} // namespace
+
+// 共有の include を変えると、それを読むノードだけが返る
+TEST(DependencyGraph, DependentsOfSharedInclude) {
+    DependencyGraph graph;
+    graph.Set(1, { "quad.hlsl", "common.hlsli", "lighting.hlsli" });
+    graph.Set(2, { "triangle.hlsl", "common.hlsli" });
+    graph.Set(3, { "sky.hlsl" });
+
+    EXPECT_EQ(graph.GetDependents("common.hlsli"), (std::vector<uint64_t>{ 1, 2 }));
+    EXPECT_EQ(graph.GetDependents("lighting.hlsli"), std::vector<uint64_t>{ 1 });
+    EXPECT_TRUE(graph.GetDependents("unknown.hlsli").empty());
+    EXPECT_EQ(graph.GetDependents(std::vector<std::string>{ "sky.hlsl", "common.hlsli", "lighting.hlsli" }),
+              (std::vector<uint64_t>{ 1, 2, 3 }));
+    EXPECT_EQ(graph.GetNodeCount(), 3u);
+    EXPECT_EQ(graph.GetFileCount(), 5u);
+}
+
+// Set は依存を置き換え、監視を始める・やめるファイルだけを返す
+TEST(DependencyGraph, SetReportsWatchChanges) {
+    DependencyGraph graph;
+    DependencyGraph::Update u = graph.Set(1, { "a.hlsl", "common.hlsli", "common.hlsli" });
+    EXPECT_EQ(Sorted(u.added), (std::vector<std::string>{ "a.hlsl", "common.hlsli" }));
+    EXPECT_TRUE(u.removed.empty());
+    ASSERT_NE(graph.GetDependencies(1), nullptr);
+    EXPECT_EQ(*graph.GetDependencies(1), (std::vector<std::string>{ "a.hlsl", "common.hlsli" })); // 重複なし、Set した順
+
+    u = graph.Set(2, { "b.hlsl", "common.hlsli" });
+    EXPECT_EQ(u.added, std::vector<std::string>{ "b.hlsl" }); // common は監視済み
+
+    // 1 が common をやめて new を読むようになった。common は 2 が読んでいるので監視を続ける
+    u = graph.Set(1, { "a.hlsl", "new.hlsli" });
+    EXPECT_EQ(u.added, std::vector<std::string>{ "new.hlsli" });
+    EXPECT_TRUE(u.removed.empty());
+    EXPECT_EQ(graph.GetDependents("common.hlsli"), std::vector<uint64_t>{ 2 });
+
+    u = graph.Set(2, { "b.hlsl" });
+    EXPECT_TRUE(u.added.empty());
+    EXPECT_EQ(u.removed, std::vector<std::string>{ "common.hlsli" });
+    EXPECT_TRUE(graph.GetDependents("common.hlsli").empty());
+}
+
+// Remove で誰も読まなくなったファイルを返し、知らないノードは何もしない
+TEST(DependencyGraph, RemoveReleasesFiles) {
+    DependencyGraph graph;
+    graph.Set(1, { "a.hlsl", "common.hlsli" });
+    graph.Set(2, { "b.hlsl", "common.hlsli" });
+
+    DependencyGraph::Update u = graph.Remove(1);
+    EXPECT_TRUE(u.added.empty());
+    EXPECT_EQ(u.removed, std::vector<std::string>{ "a.hlsl" });
+    EXPECT_EQ(graph.GetDependencies(1), nullptr);
+
+    u = graph.Remove(2);
+    EXPECT_EQ(Sorted(u.removed), (std::vector<std::string>{ "b.hlsl", "common.hlsli" }));
+    EXPECT_EQ(graph.GetNodeCount(), 0u);
+    EXPECT_EQ(graph.GetFileCount(), 0u);
+
+    u = graph.Remove(42);
+    EXPECT_TRUE(u.added.empty() && u.removed.empty());
+}
+
+// ExpandShaderIncludes が読んだファイルで依存を張ると、入れ子の include の変更も届く
+TEST(DependencyGraph, TracksNestedIncludes) {
+    const std::map<std::string, std::string> files = {
+        { "shaders/quad.hlsl", "#include \"common.hlsli\"\n" },
+        { "shaders/triangle.hlsl", "#include \"color.hlsli\"\n" },
+        { "shaders/common.hlsli", "#include \"color.hlsli\"\n" },
+        { "shaders/color.hlsli", "#pragma once\n" },
+    };
+    const ShaderFileReader read = [&files](const std::string& path, std::string& out) {
+        const auto it = files.find(path);
+        if (it == files.end()) return false;
+        out = it->second;
+        return true;
+    };
+
+    DependencyGraph graph;
+    uint64_t node = 1;
+    for (const char* main : { "shaders/quad.hlsl", "shaders/triangle.hlsl" }) {
+        ShaderSource source;
+        std::string error;
+        ASSERT_TRUE(ExpandShaderIncludes(main, read, {}, source, error)) << error;
+        graph.Set(node++, source.files);
+    }
+    EXPECT_EQ(graph.GetDependents("shaders/color.hlsli"), (std::vector<uint64_t>{ 1, 2 }));
+    EXPECT_EQ(graph.GetDependents("shaders/common.hlsli"), std::vector<uint64_t>{ 1 });
+    EXPECT_EQ(graph.GetDependents("shaders/triangle.hlsl"), std::vector<uint64_t>{ 2 });
+}
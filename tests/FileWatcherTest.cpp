@@ -0,0 +1,131 @@
+#include "core/AtomicFile.h"
+#include "core/FileWatcher.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+void WriteText(const std::filesystem::path& file, const std::string& text) {
+    std::ofstream(file, std::ios::binary | std::ios::trunc) << text;
+}
+
+// 通知が落ち着くまで Poll し続ける。timeout 内に want 個以上そろうか、そろった後 quiet 秒何も来なければ返す
+std::vector<uint64_t> PollFor(FileWatcher& watcher, size_t want, double timeout = 2.0, double quiet = 0.2) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<uint64_t> changed;
+    const Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeout));
+    Clock::time_point last = Clock::now();
+    while (Clock::now() < end) {
+        if (watcher.Poll(changed) > 0) last = Clock::now();
+        if (changed.size() >= want && std::chrono::duration<double>(Clock::now() - last).count() >= quiet) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::sort(changed.begin(), changed.end());
+    return changed;
+}
+
+class FileWatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_dir = CreateTempDirectory("jisaku-watchtest-");
+        FileWatcher::Config config;
+        config.debounce = 0.05;
+        m_watcher = std::make_unique<FileWatcher>(config);
+        if (!m_watcher->IsAvailable()) GTEST_SKIP() << "OS change notification is not available";
+    }
+    void TearDown() override {
+        m_watcher.reset();
+        std::error_code ec;
+        std::filesystem::remove_all(m_dir, ec);
+    }
+    std::filesystem::path m_dir;
+    std::unique_ptr<FileWatcher> m_watcher;
+};
+
+} // namespace
+
+// 変更したファイルの id だけが届き、同じディレクトリの他のファイルは無視される
+TEST_F(FileWatcherTest, ReportsOnlyWatchedFiles) {
+    WriteText(m_dir / "a.hlsl", "a");
+    WriteText(m_dir / "b.hlsl", "b");
+    ASSERT_TRUE(m_watcher->Watch(1, m_dir / "a.hlsl"));
+    ASSERT_TRUE(m_watcher->Watch(2, m_dir / "b.hlsl"));
+    EXPECT_EQ(m_watcher->GetWatchCount(), 2u);
+    EXPECT_EQ(m_watcher->GetDirectoryCount(), 1u);
+
+    WriteText(m_dir / "a.hlsl", "a2");
+    WriteText(m_dir / "other.txt", "x");
+    EXPECT_EQ(PollFor(*m_watcher, 1), std::vector<uint64_t>{ 1 });
+}
+
+// 保存の連続書き込みは debounce でまとめて 1 回
+TEST_F(FileWatcherTest, DebouncesWriteBursts) {
+    const auto file = m_dir / "a.hlsl";
+    WriteText(file, "a");
+    ASSERT_TRUE(m_watcher->Watch(1, file));
+    for (int i = 0; i < 10; ++i) {
+        std::ofstream(file, std::ios::binary | std::ios::app) << i;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_EQ(PollFor(*m_watcher, 1), std::vector<uint64_t>{ 1 });
+}
+
+// 一時ファイルに書いて rename するエディタの保存も、まだ無いファイルの作成も置き換え先の名前で届く
+TEST_F(FileWatcherTest, ReportsRenameReplaceAndCreate) {
+    const auto file = m_dir / "a.hlsl";
+    WriteText(file, "a");
+    ASSERT_TRUE(m_watcher->Watch(1, file));
+    ASSERT_TRUE(m_watcher->Watch(2, m_dir / "new.hlsl"));
+    ASSERT_TRUE(WriteFileAtomic(file, "replaced", 8));
+    WriteText(m_dir / "new.hlsl", "created");
+    EXPECT_EQ(PollFor(*m_watcher, 2), (std::vector<uint64_t>{ 1, 2 }));
+}
+
+// 同じファイルを複数の id で見ると id ごとに届き、Unwatch した id は届かない
+TEST_F(FileWatcherTest, MultipleIdsAndUnwatch) {
+    const auto file = m_dir / "common.hlsli";
+    WriteText(file, "c");
+    ASSERT_TRUE(m_watcher->Watch(1, file));
+    ASSERT_TRUE(m_watcher->Watch(2, file));
+    ASSERT_TRUE(m_watcher->Watch(3, file));
+    m_watcher->Unwatch(2);
+    WriteText(file, "c2");
+    EXPECT_EQ(PollFor(*m_watcher, 2), (std::vector<uint64_t>{ 1, 3 }));
+
+    m_watcher->Unwatch(1);
+    m_watcher->Unwatch(3);
+    EXPECT_EQ(m_watcher->GetWatchCount(), 0u);
+    EXPECT_EQ(m_watcher->GetDirectoryCount(), 0u);
+    WriteText(file, "c3");
+    EXPECT_TRUE(PollFor(*m_watcher, 1, 0.3).empty());
+}
+
+// キューがあふれたら、取りこぼしの代わりに監視中の全 id を返す
+TEST_F(FileWatcherTest, OverflowReportsEveryWatchedId) {
+    FileWatcher::Config config;
+    config.debounce = 0.02;
+    config.queueCapacity = 2;
+    m_watcher = std::make_unique<FileWatcher>(config);
+    std::vector<uint64_t> all;
+    for (uint64_t id = 0; id < 16; ++id) {
+        const auto file = m_dir / (std::to_string(id) + ".hlsl");
+        WriteText(file, "x");
+        ASSERT_TRUE(m_watcher->Watch(id, file));
+        all.push_back(id);
+    }
+    for (uint64_t id = 0; id < 16; ++id) WriteText(m_dir / (std::to_string(id) + ".hlsl"), "changed");
+    std::this_thread::sleep_for(std::chrono::milliseconds(300)); // Poll せずにキューをあふれさせる
+
+    std::vector<uint64_t> changed = PollFor(*m_watcher, 16);
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    EXPECT_EQ(changed, all);
+}
@@ -0,0 +1,81 @@
+#include "core/HalfFloat.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+uint32_t Bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, 4);
+    return u;
+}
+
+float FromBits(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, 4);
+    return f;
+}
+
+bool IsHalfNaN(uint16_t h) { return (h & 0x7c00) == 0x7c00 && (h & 0x03ff) != 0; }
+
+} // namespace
+
+// 代表値と丸め（最近接偶数・オーバーフロー・非正規化数）
+TEST(HalfFloat, KnownValues) {
+    EXPECT_EQ(FloatToHalf(0.0f), 0x0000);
+    EXPECT_EQ(FloatToHalf(-0.0f), 0x8000);
+    EXPECT_EQ(FloatToHalf(1.0f), 0x3c00);
+    EXPECT_EQ(FloatToHalf(-2.0f), 0xc000);
+    EXPECT_EQ(FloatToHalf(65504.0f), 0x7bff);
+    EXPECT_EQ(FloatToHalf(65520.0f), 0x7c00); // 最大値の半分の刻みを超えたら Inf
+    EXPECT_EQ(FloatToHalf(std::numeric_limits<float>::infinity()), 0x7c00);
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.0f, -24)), 0x0001); // 最小の非正規化数
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.0f, -26)), 0x0000); // その半分未満は 0
+    EXPECT_EQ(FloatToHalf(1.0f + std::ldexp(1.0f, -11)), 0x3c00); // ちょうど中間は偶数側
+    EXPECT_EQ(FloatToHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)), 0x3c02);
+    EXPECT_TRUE(IsHalfNaN(FloatToHalf(std::numeric_limits<float>::quiet_NaN())));
+    EXPECT_EQ(HalfToFloat(0x3555), FromBits(0x3eaaa000));
+}
+
+// 全 half 値が float 経由で元に戻る
+TEST(HalfFloat, AllHalvesRoundTrip) {
+    std::vector<uint16_t> halves(65536), back(65536);
+    std::vector<float> floats(65536);
+    for (uint32_t i = 0; i < 65536; ++i) halves[i] = uint16_t(i);
+    HalfToFloat(floats.data(), halves.data(), halves.size());
+    FloatToHalf(back.data(), floats.data(), floats.size());
+    for (uint32_t i = 0; i < 65536; ++i) {
+        EXPECT_EQ(Bits(floats[i]), Bits(HalfToFloat(halves[i]))) << i;
+        if (IsHalfNaN(halves[i])) {
+            EXPECT_TRUE(IsHalfNaN(back[i])) << i;
+        } else {
+            EXPECT_EQ(back[i], halves[i]) << i;
+        }
+    }
+}
+
+// 配列版（F16C があればそちら）とスカラー版が同じビット列を返す。端数処理が出るよう長さは 8 の倍数にしない
+TEST(HalfFloat, ArrayMatchesScalar) {
+    std::mt19937 rng(9);
+    std::vector<float> src(100003);
+    for (float& f : src) f = FromBits(uint32_t(rng()));
+    src[0] = 65519.0f;
+    src[1] = -65520.0f;
+    src[2] = std::ldexp(1.0f, -25);
+    std::vector<uint16_t> dst(src.size());
+    FloatToHalf(dst.data(), src.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i) {
+        const uint16_t expected = FloatToHalf(src[i]);
+        if (IsHalfNaN(expected)) {
+            EXPECT_TRUE(IsHalfNaN(dst[i])) << i;
+        } else {
+            EXPECT_EQ(dst[i], expected) << i << " " << src[i];
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#include "core/AtomicFile.h"
+#include "core/HotReloadScheduler.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+void WriteText(const std::filesystem::path& file, const std::string& text) {
+    std::ofstream(file, std::ios::binary | std::ios::trunc) << text;
+}
+
+// OS の通知を使わず、ポーリングだけで判定する（時刻は引数で進める）
+HotReloadScheduler::Config PollingConfig() {
+    HotReloadScheduler::Config config;
+    config.pollInterval = 0.5;
+    config.settleTime = 0.2;
+    config.useFileWatcher = false;
+    return config;
+}
+
+class HotReloadSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override { m_dir = CreateTempDirectory("jisaku-reloadtest-"); }
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(m_dir, ec);
+    }
+    std::filesystem::path m_dir;
+};
+
+} // namespace
+
+// 変更は見つけた次のポーリングまで待ち、落ち着いていたら発火する
+TEST_F(HotReloadSchedulerTest, FiresAfterChangeSettles) {
+    const auto file = m_dir / "a.hlsl";
+    WriteText(file, "v1");
+    HotReloadScheduler scheduler(PollingConfig());
+    scheduler.Add(1, file);
+    EXPECT_EQ(scheduler.GetWatchedCount(), 0u);
+    EXPECT_TRUE(scheduler.Update(0.0).empty());
+
+    WriteText(file, "version 2");
+    EXPECT_TRUE(scheduler.Update(0.1).empty()); // まだポーリングの間隔が来ていない
+    EXPECT_TRUE(scheduler.Update(0.5).empty()); // 変更を見つけただけ
+    EXPECT_TRUE(scheduler.Update(0.7).empty());
+    EXPECT_EQ(scheduler.Update(1.0), std::vector<uint64_t>{ 1 });
+    EXPECT_TRUE(scheduler.IsRunning(1));
+    scheduler.Complete(1);
+    EXPECT_TRUE(scheduler.Update(1.5).empty()); // 1 回の変更で 1 回だけ
+}
+
+// 書き込みが続いている間は発火しない
+TEST_F(HotReloadSchedulerTest, KeepsWaitingWhileFileChanges) {
+    const auto file = m_dir / "a.png";
+    WriteText(file, "1");
+    HotReloadScheduler scheduler(PollingConfig());
+    scheduler.Add(1, file);
+    scheduler.Update(0.0);
+
+    std::string body = "1";
+    for (double t = 0.5; t < 2.0; t += 0.5) {
+        body += "+";
+        WriteText(file, body);
+        EXPECT_TRUE(scheduler.Update(t).empty()) << t;
+    }
+    EXPECT_EQ(scheduler.Update(2.0), std::vector<uint64_t>{ 1 });
+}
+
+// 実行中の id は重ねて発火せず、その間の変更・Invalidate は Complete 後に 1 回にまとめる
+TEST_F(HotReloadSchedulerTest, OneReloadPerIdAtATime) {
+    const auto a = m_dir / "a.hlsl", b = m_dir / "b.hlsl";
+    WriteText(a, "a");
+    WriteText(b, "b");
+    HotReloadScheduler scheduler(PollingConfig());
+    scheduler.Add(2, b);
+    scheduler.Add(1, a);
+    scheduler.Invalidate(1);
+    scheduler.Invalidate(2);
+    EXPECT_EQ(scheduler.Update(0.0), (std::vector<uint64_t>{ 1, 2 })); // 昇順
+
+    scheduler.Invalidate(1);
+    WriteText(a, "a changed");
+    EXPECT_TRUE(scheduler.Update(0.5).empty());
+    EXPECT_TRUE(scheduler.Update(1.0).empty());
+    scheduler.Complete(1);
+    EXPECT_EQ(scheduler.Update(1.1), std::vector<uint64_t>{ 1 });
+    EXPECT_TRUE(scheduler.IsRunning(2)); // Complete していない id はそのまま
+}
+
+// 消えたファイルでは発火せず、戻ってきたら発火する。Remove した id はもう出てこない
+TEST_F(HotReloadSchedulerTest, MissingFileAndRemove) {
+    const auto file = m_dir / "a.hlsl";
+    WriteText(file, "a");
+    HotReloadScheduler scheduler(PollingConfig());
+    scheduler.Add(1, file);
+    scheduler.Add(2, file);
+    scheduler.Update(0.0);
+
+    std::filesystem::remove(file);
+    scheduler.Update(0.5);
+    EXPECT_TRUE(scheduler.Update(1.0).empty());
+
+    scheduler.Remove(2);
+    EXPECT_EQ(scheduler.Size(), 1u);
+    WriteText(file, "back");
+    scheduler.Update(1.5);
+    EXPECT_EQ(scheduler.Update(2.0), std::vector<uint64_t>{ 1 });
+}
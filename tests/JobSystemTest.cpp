@@ -0,0 +1,42 @@
+#include "core/JobSystem.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+using namespace jisaku;
+
+TEST(JobSystem, ParallelForCoversEveryIndexOnce) {
+    JobSystem jobs(3);
+    for (uint32_t grain : { 1u, 7u, 64u, 1000u }) {
+        std::vector<std::atomic<int>> hits(1000);
+        jobs.ParallelFor(uint32_t(hits.size()), grain, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) hits[i].fetch_add(1);
+        });
+        for (const std::atomic<int>& h : hits) EXPECT_EQ(h.load(), 1) << "grain " << grain;
+    }
+}
+
+TEST(JobSystem, NestedParallelForCompletes) {
+    JobSystem jobs(2);
+    std::atomic<int> total{ 0 };
+    jobs.ParallelFor(8, 1, [&](uint32_t, uint32_t) {
+        jobs.ParallelFor(16, 4, [&](uint32_t begin, uint32_t end) { total.fetch_add(int(end - begin)); });
+    });
+    EXPECT_EQ(total.load(), 8 * 16);
+}
+
+TEST(JobSystem, AsyncReturnsValue) {
+    JobSystem jobs(1);
+    std::future<int> f = jobs.Async([] { return 42; });
+    EXPECT_EQ(jobs.Wait(f), 42);
+}
+
+// ワーカーが 1 本でも、ジョブの中から後続ジョブの future を待てる（Wait がキューを消化する）
+TEST(JobSystem, WaitInsideJobRunsQueuedJobs) {
+    JobSystem jobs(1);
+    std::future<int> outer = jobs.Async([&jobs] {
+        std::future<int> inner = jobs.Async([] { return 7; });
+        return jobs.Wait(inner) * 2;
+    });
+    EXPECT_EQ(jobs.Wait(outer), 14);
+}
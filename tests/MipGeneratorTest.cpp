@@ -0,0 +1,99 @@
+#include "gfx/MipGenerator.h"
+#include "MipReference.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+using namespace jisaku;
+
+namespace {
+
+// なめらかな部分・ノイズ・透明部分を含む入力。非 2 の累乗サイズでカーネル端の畳み込みも通す
+Image MakeTestImage(uint32_t width, uint32_t height) {
+    Image img;
+    img.Allocate(width, height);
+    std::mt19937 rng(77);
+    std::uniform_int_distribution<int> noise(0, 255);
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* row = img.View().Row(y);
+        for (uint32_t x = 0; x < width; ++x) {
+            row[x * 4 + 0] = uint8_t(x * 255 / width);
+            row[x * 4 + 1] = uint8_t(noise(rng));
+            row[x * 4 + 2] = uint8_t((x ^ y) & 0xff);
+            row[x * 4 + 3] = uint8_t(y < height / 3 ? 0 : (y * 255 / height));
+        }
+    }
+    return img;
+}
+
+int MaxAbsDiff(const Image& a, const Image& b) {
+    int d = 0;
+    for (size_t i = 0; i < a.pixels.size(); ++i) d = (std::max)(d, std::abs(int(a.pixels[i]) - int(b.pixels[i])));
+    return d;
+}
+
+} // namespace
+
+// SIMD・並列の実装がスカラー参照と 1 LSB 以内で一致する（差は FMA と加算順による丸めだけ）
+TEST(MipGenerator, MatchesScalarReference) {
+    const Image img = MakeTestImage(131, 67);
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos }) {
+        for (bool srgb : { false, true }) {
+            MipOptions opt;
+            opt.filter = filter;
+            opt.srgb = srgb;
+            std::vector<Image> levels;
+            ASSERT_TRUE(GenerateMipChain(img.View(), opt, levels));
+            const std::vector<Image> ref = MipReference::Generate(img, filter, srgb, opt.alphaWeighted);
+            ASSERT_EQ(levels.size(), ref.size());
+            for (size_t i = 0; i < levels.size(); ++i) {
+                ASSERT_EQ(levels[i].width, ref[i].width);
+                ASSERT_EQ(levels[i].height, ref[i].height);
+                EXPECT_LE(MaxAbsDiff(levels[i], ref[i]), 1) << "filter " << int(filter) << " srgb " << srgb << " level " << i;
+            }
+        }
+    }
+}
+
+// 並列・非テンポラルストアの有無で結果が変わらない
+TEST(MipGenerator, ParallelAndStreamingMatchSerial) {
+    const Image img = MakeTestImage(300, 200);
+    MipOptions opt;
+    opt.filter = MipFilter::Lanczos;
+    opt.parallel = false;
+    std::vector<Image> serial, parallel, streaming;
+    ASSERT_TRUE(GenerateMipChain(img.View(), opt, serial));
+    opt.parallel = true;
+    ASSERT_TRUE(GenerateMipChain(img.View(), opt, parallel));
+    opt.streamingStores = true;
+    ASSERT_TRUE(GenerateMipChain(img.View(), opt, streaming));
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i].pixels, parallel[i].pixels) << "level " << i;
+        EXPECT_EQ(serial[i].pixels, streaming[i].pixels) << "level " << i;
+    }
+}
+
+// 完全に透明な領域の色は 0 に落ち、不透明な単色は単色のまま縮む
+TEST(MipGenerator, AlphaWeightedKeepsSolidColor) {
+    Image img;
+    img.Allocate(64, 64);
+    for (size_t i = 0; i < img.pixels.size(); i += 4) {
+        img.pixels[i + 0] = 200;
+        img.pixels[i + 1] = 100;
+        img.pixels[i + 2] = 50;
+        img.pixels[i + 3] = 255;
+    }
+    std::vector<Image> levels;
+    ASSERT_TRUE(GenerateMipChain(img.View(), MipOptions{ MipFilter::Kaiser }, levels));
+    ASSERT_EQ(levels.size(), 7u);
+    for (const Image& level : levels) {
+        for (size_t i = 0; i < level.pixels.size(); i += 4) {
+            EXPECT_NEAR(level.pixels[i + 0], 200, 1);
+            EXPECT_NEAR(level.pixels[i + 1], 100, 1);
+            EXPECT_NEAR(level.pixels[i + 2], 50, 1);
+            EXPECT_EQ(level.pixels[i + 3], 255);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include "gfx/MipGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace jisaku {
+
+// MipGenerator のスカラー・単一スレッド参照実装（テストの正解とベンチマークの比較対象）。
+// カーネルの作り方・色変換・中間 float 精度は MipGenerator と同じにし、SIMD も JobSystem も使わない
+class MipReference {
+public:
+    static std::vector<Image> Generate(const Image& src, MipFilter filter, bool srgb, bool alphaWeighted) {
+        MipReference ref(filter, srgb, alphaWeighted);
+        std::vector<Image> levels(1, src);
+        uint32_t w = src.width, h = src.height;
+        std::vector<float> cur(size_t(w) * h * 4);
+        for (uint32_t y = 0; y < h; ++y) ref.ToFloat(src.View().Row(y), w, &cur[size_t(y) * w * 4]);
+        while (w > 1 || h > 1) {
+            const uint32_t dw = (std::max)(w / 2, 1u), dh = (std::max)(h / 2, 1u);
+            std::vector<float> next = ref.Downsample(cur, w, h, dw, dh);
+            Image out;
+            out.Allocate(dw, dh);
+            for (uint32_t y = 0; y < dh; ++y) ref.ToBytes(&next[size_t(y) * dw * 4], dw, out.View().Row(y));
+            levels.push_back(std::move(out));
+            cur = std::move(next);
+            w = dw;
+            h = dh;
+        }
+        return levels;
+    }
+
+private:
+    struct Kernel {
+        uint32_t taps = 0;
+        std::vector<uint32_t> start;
+        std::vector<float> weights;
+    };
+
+    MipReference(MipFilter filter, bool srgb, bool alphaWeighted) : m_filter(filter), m_srgb(srgb), m_alphaWeighted(alphaWeighted) {
+        for (int i = 0; i < 256; ++i) {
+            const float c = float(i) / 255.0f;
+            m_toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < 4096; ++i) {
+            const float l = float(i) / 4095.0f;
+            const float s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            m_toSrgb[i] = uint8_t(std::lround(std::clamp(s, 0.0f, 1.0f) * 255.0f));
+        }
+    }
+
+    static float Sinc(float x) {
+        if (std::fabs(x) < 1e-5f) return 1.0f;
+        x *= 3.14159265358979f;
+        return std::sin(x) / x;
+    }
+
+    static float BesselI0(float x) {
+        float sum = 1.0f, term = 1.0f;
+        const float q = x * x * 0.25f;
+        for (int k = 1; k < 20; ++k) {
+            term *= q / float(k * k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    float Eval(float x) const {
+        switch (m_filter) {
+        case MipFilter::Box:
+            return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+        case MipFilter::Kaiser: {
+            const float r = x / 3.0f;
+            if (std::fabs(r) >= 1.0f) return 0.0f;
+            return Sinc(x) * BesselI0(4.0f * std::sqrt(1.0f - r * r)) / BesselI0(4.0f);
+        }
+        case MipFilter::Lanczos:
+            if (std::fabs(x) >= 3.0f) return 0.0f;
+            return Sinc(x) * Sinc(x / 3.0f);
+        }
+        return 0.0f;
+    }
+
+    Kernel BuildKernel(uint32_t srcSize, uint32_t dstSize) const {
+        Kernel k;
+        const float scale = float(srcSize) / float(dstSize);
+        const float stretch = (std::max)(scale, 1.0f);
+        const float support = (m_filter == MipFilter::Box ? 0.5f : 3.0f) * stretch;
+        k.taps = (std::min)(uint32_t(std::ceil(support * 2.0f)) + 2, srcSize);
+        k.start.resize(dstSize);
+        k.weights.assign(size_t(dstSize) * k.taps, 0.0f);
+        for (uint32_t i = 0; i < dstSize; ++i) {
+            const float center = (float(i) + 0.5f) * scale;
+            const int lo = int(std::floor(center - support));
+            const int hi = int(std::ceil(center + support));
+            const int s = (std::min)(std::clamp(lo, 0, int(srcSize) - 1), int(srcSize - k.taps));
+            k.start[i] = uint32_t(s);
+            float* w = &k.weights[size_t(i) * k.taps];
+            float sum = 0.0f;
+            for (int j = lo; j < hi; ++j) {
+                const float v = Eval((float(j) + 0.5f - center) / stretch);
+                w[std::clamp(j, 0, int(srcSize) - 1) - s] += v;
+                sum += v;
+            }
+            if (std::fabs(sum) < 1e-6f) {
+                w[std::clamp(int(center), 0, int(srcSize) - 1) - s] = 1.0f;
+                sum = 1.0f;
+            }
+            for (uint32_t t = 0; t < k.taps; ++t) w[t] /= sum;
+        }
+        return k;
+    }
+
+    void ToFloat(const uint8_t* src, uint32_t width, float* out) const {
+        for (uint32_t x = 0; x < width; ++x, src += 4, out += 4) {
+            const float a = float(src[3]) / 255.0f;
+            const float m = m_alphaWeighted ? a : 1.0f;
+            for (int c = 0; c < 3; ++c) out[c] = (m_srgb ? m_toLinear[src[c]] : float(src[c]) / 255.0f) * m;
+            out[3] = a;
+        }
+    }
+
+    void ToBytes(const float* in, uint32_t width, uint8_t* dst) const {
+        for (uint32_t x = 0; x < width; ++x, in += 4, dst += 4) {
+            const float a = in[3];
+            const float inv = !m_alphaWeighted ? 1.0f : (a > 0.0f ? 1.0f / a : 0.0f);
+            for (int c = 0; c < 3; ++c) {
+                const float v = std::clamp(in[c] * inv, 0.0f, 1.0f);
+                dst[c] = m_srgb ? m_toSrgb[int(v * 4095.0f + 0.5f)] : uint8_t(v * 255.0f + 0.5f);
+            }
+            dst[3] = uint8_t(a * 255.0f + 0.5f);
+        }
+    }
+
+    // 縦 → 横の順に畳み込む（MipGenerator と同じ順序）
+    std::vector<float> Downsample(const std::vector<float>& src, uint32_t w, uint32_t h, uint32_t dw, uint32_t dh) const {
+        const Kernel kx = BuildKernel(w, dw), ky = BuildKernel(h, dh);
+        std::vector<float> out(size_t(dw) * dh * 4), acc(size_t(w) * 4);
+        for (uint32_t y = 0; y < dh; ++y) {
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            for (uint32_t t = 0; t < ky.taps; ++t) {
+                const float wy = ky.weights[size_t(y) * ky.taps + t];
+                const float* row = &src[size_t(ky.start[y] + t) * w * 4];
+                for (size_t i = 0; i < acc.size(); ++i) acc[i] += wy * row[i];
+            }
+            for (uint32_t x = 0; x < dw; ++x) {
+                for (int c = 0; c < 4; ++c) {
+                    float v = 0.0f;
+                    for (uint32_t t = 0; t < kx.taps; ++t) v += kx.weights[size_t(x) * kx.taps + t] * acc[size_t(kx.start[x] + t) * 4 + c];
+                    out[(size_t(y) * dw + x) * 4 + c] = std::clamp(v, 0.0f, 1.0f);
+                }
+            }
+        }
+        return out;
+    }
+
+    MipFilter m_filter;
+    bool m_srgb;
+    bool m_alphaWeighted;
+    float m_toLinear[256];
+    uint8_t m_toSrgb[4096];
+};
+
+} // namespace jisaku
@@ -0,0 +1,265 @@
+#include "core/AtomicFile.h"
+#include "core/PermutationCache.h"
+#include "core/ShaderPermutations.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// ジョブを溜めておき、テストが好きな順に動かす Executor
+struct ManualExecutor {
+    std::vector<std::function<void()>> jobs;
+
+    PermutationCache<int>::Executor Get() {
+        return [this](std::function<void()> job) { jobs.push_back(std::move(job)); };
+    }
+    // 先頭から count 個（省略時は全部）動かす
+    void Run(size_t count = SIZE_MAX) {
+        while (count-- > 0 && !jobs.empty()) {
+            std::function<void()> job = std::move(jobs.front());
+            jobs.erase(jobs.begin());
+            job();
+        }
+    }
+};
+
+// キーをそのまま値にする（作った順も記録する）
+struct KeyBuilder {
+    std::vector<PermutationKey> built;
+    PermutationKey failKey = ~PermutationKey(0);
+
+    PermutationCache<int>::Builder Get() {
+        return [this](PermutationKey key, int& out) {
+            built.push_back(key);
+            out = int(key);
+            return key != failKey;
+        };
+    }
+};
+
+} // namespace
+
+// 機能の並び順がビットになり、define・文字列と行き来できる
+TEST(PermutationSchema, KeyPacking) {
+    PermutationSchema schema{ "GRAYSCALE", "SHOW_UV", "FOG" };
+    EXPECT_EQ(schema.GetFeatureCount(), 3u);
+    EXPECT_EQ(schema.GetMask(), 0x7u);
+    EXPECT_EQ(schema.AddFeature("SHADOWS"), 0x8u);
+
+    EXPECT_TRUE(schema.MakeDefines(0).empty());
+    EXPECT_EQ(schema.MakeDefines(0x5), (std::vector<std::string>{ "GRAYSCALE=1", "FOG=1" }));
+    EXPECT_EQ(schema.Format(0), "-");
+    EXPECT_EQ(schema.Format(0xa), "SHOW_UV|SHADOWS");
+
+    PermutationKey key = 0;
+    for (PermutationKey k = 0; k <= schema.GetMask(); ++k) {
+        ASSERT_TRUE(schema.Parse(schema.Format(k), key));
+        EXPECT_EQ(key, k);
+    }
+    EXPECT_FALSE(schema.Parse("GRAYSCALE|UNKNOWN", key));
+    EXPECT_FALSE(schema.Parse("GRAYSCALE||FOG", key));
+}
+
+// 32 個を超える機能は追加できない
+TEST(PermutationSchema, FeatureLimit) {
+    PermutationSchema schema;
+    for (uint32_t i = 0; i < kMaxPermutationFeatures; ++i) EXPECT_EQ(schema.AddFeature(std::to_string(i) + "_F"), PermutationKey(1) << i);
+    EXPECT_EQ(schema.GetMask(), ~PermutationKey(0));
+    EXPECT_EQ(schema.AddFeature("EXTRA"), 0u);
+    EXPECT_EQ(schema.GetFeatureCount(), size_t(kMaxPermutationFeatures));
+}
+
+// 使用記録は保存して読み戻せ、重複は 1 つにまとまる
+TEST(PermutationUsage, SaveLoadRoundTrip) {
+    const auto dir = CreateTempDirectory("jisaku-permtest-");
+    PermutationUsage usage;
+    usage.Add("shaders/quad.hlsl", "GRAYSCALE");
+    usage.Add("shaders/quad.hlsl", "GRAYSCALE|SHOW_UV");
+    usage.Add("shaders/quad.hlsl", "GRAYSCALE");
+    usage.Add("shaders/triangle.hlsl", "-");
+    EXPECT_EQ(usage.Size(), 3u);
+    ASSERT_TRUE(usage.Save(dir / "usage.txt"));
+
+    PermutationUsage loaded;
+    ASSERT_TRUE(loaded.Load(dir / "usage.txt"));
+    EXPECT_EQ(loaded.Size(), 3u);
+    ASSERT_NE(loaded.Find("shaders/quad.hlsl"), nullptr);
+    EXPECT_EQ(*loaded.Find("shaders/quad.hlsl"), (std::vector<std::string>{ "GRAYSCALE", "GRAYSCALE|SHOW_UV" }));
+    EXPECT_EQ(loaded.Find("shaders/missing.hlsl"), nullptr);
+    EXPECT_FALSE(loaded.Load(dir / "no-such-file.txt"));
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// できるまでは、できているもののうち要求の部分集合でビットが最も多いものを返す
+TEST(PermutationCache, FallsBackToBestSubset) {
+    ManualExecutor exec;
+    KeyBuilder builder;
+    PermutationCache<int> cache(builder.Get(), {}, exec.Get());
+    std::vector<int> evicted;
+
+    PermutationKey resolved = 99;
+    EXPECT_EQ(cache.Request(0x0), nullptr);
+    exec.Run();
+    cache.Apply(evicted);
+    ASSERT_NE(cache.Request(0x0, &resolved), nullptr);
+    EXPECT_EQ(resolved, 0x0u);
+
+    for (PermutationKey k : { 0x1u, 0x4u }) cache.Prefetch(k);
+    exec.Run();
+    cache.Apply(evicted);
+
+    const int* value = cache.Request(0x7, &resolved); // 0x1 と 0x4 が同点なら小さいほう
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(resolved, 0x1u);
+    EXPECT_TRUE(cache.IsBuilding(0x7));
+    EXPECT_EQ(cache.Request(0x6, &resolved), cache.Request(0x4)); // 0x2 は無いので 0x4
+    EXPECT_EQ(resolved, 0x4u);
+
+    exec.Run();
+    EXPECT_EQ(cache.Apply(evicted), 2u);
+    ASSERT_NE(value = cache.Request(0x7, &resolved), nullptr);
+    EXPECT_EQ(resolved, 0x7u);
+    EXPECT_EQ(*value, 0x7);
+}
+
+// 同時に作るのは maxBuilding 個まで。Request は Prefetch を追い越す
+TEST(PermutationCache, RequestsJumpPrefetchQueue) {
+    ManualExecutor exec;
+    KeyBuilder builder;
+    PermutationCache<int>::Config config;
+    config.maxBuilding = 1;
+    PermutationCache<int> cache(builder.Get(), config, exec.Get());
+    std::vector<int> evicted;
+
+    for (PermutationKey k : { 1u, 2u, 3u }) cache.Prefetch(k);
+    EXPECT_EQ(exec.jobs.size(), 1u);
+    EXPECT_EQ(cache.GetBuildingCount(), 1u);
+    EXPECT_EQ(cache.GetPendingCount(), 2u);
+    cache.Request(3);
+    cache.Prefetch(3); // 待ち行列の先頭のまま
+
+    while (!exec.jobs.empty()) {
+        exec.Run(1);
+        cache.Apply(evicted);
+    }
+    EXPECT_EQ(builder.built, (std::vector<PermutationKey>{ 1, 3, 2 }));
+    EXPECT_EQ(cache.GetUsedKeys(), std::vector<PermutationKey>{ 3 });
+}
+
+// capacity を超えたら使われていない順に手放し、手放したものは evicted に返す
+TEST(PermutationCache, EvictsLeastRecentlyUsed) {
+    ManualExecutor exec;
+    KeyBuilder builder;
+    PermutationCache<int>::Config config;
+    config.capacity = 3;
+    config.maxBuilding = 8;
+    PermutationCache<int> cache(builder.Get(), config, exec.Get());
+    std::vector<int> evicted;
+
+    for (PermutationKey k : { 1u, 2u, 3u }) cache.Prefetch(k);
+    exec.Run();
+    cache.Apply(evicted);
+    EXPECT_TRUE(evicted.empty());
+
+    cache.Request(1); // 2 が最も古くなる
+    cache.Request(4);
+    exec.Run();
+    cache.Apply(evicted);
+    EXPECT_EQ(evicted, std::vector<int>{ 2 });
+    EXPECT_EQ(cache.Size(), 3u);
+    EXPECT_FALSE(cache.IsReady(2));
+    EXPECT_TRUE(cache.IsReady(1) && cache.IsReady(3) && cache.IsReady(4));
+    EXPECT_EQ(cache.GetEvictedCount(), 1u);
+
+    // 手放したものはまた要求されれば作り直す
+    cache.Request(2);
+    exec.Run();
+    cache.Apply(evicted);
+    EXPECT_EQ(evicted, (std::vector<int>{ 2, 3 }));
+    EXPECT_TRUE(cache.IsReady(2));
+}
+
+// 作れなかったものは Clear まで作り直さない
+TEST(PermutationCache, FailedBuildIsNotRetried) {
+    ManualExecutor exec;
+    KeyBuilder builder;
+    builder.failKey = 5;
+    PermutationCache<int> cache(builder.Get(), {}, exec.Get());
+    std::vector<int> evicted;
+
+    cache.Request(5);
+    exec.Run();
+    EXPECT_EQ(cache.Apply(evicted), 0u);
+    EXPECT_TRUE(cache.HasFailed(5));
+    EXPECT_EQ(cache.GetFailedCount(), 1u);
+    cache.Request(5);
+    cache.Prefetch(5);
+    EXPECT_TRUE(exec.jobs.empty());
+
+    builder.failKey = ~PermutationKey(0);
+    cache.Clear(evicted);
+    EXPECT_FALSE(cache.HasFailed(5));
+    cache.Request(5);
+    exec.Run();
+    EXPECT_EQ(cache.Apply(evicted), 1u);
+    EXPECT_TRUE(cache.IsReady(5));
+}
+
+// Clear は持っているものを返し、作りかけの古い結果は捨てて、要求されていたものを作り直す
+TEST(PermutationCache, ClearDiscardsInFlightResults) {
+    ManualExecutor exec;
+    KeyBuilder builder;
+    PermutationCache<int> cache(builder.Get(), {}, exec.Get());
+    std::vector<int> evicted;
+
+    cache.Request(1);
+    exec.Run();
+    cache.Apply(evicted);
+    cache.Request(2); // 作りかけのまま Clear する
+    ASSERT_EQ(exec.jobs.size(), 1u);
+
+    cache.Clear(evicted);
+    EXPECT_EQ(evicted, std::vector<int>{ 1 });
+    EXPECT_EQ(cache.Size(), 0u);
+    ASSERT_EQ(exec.jobs.size(), 2u); // 古いジョブ + 作り直し
+
+    exec.Run(1); // 古いシェーダーで作った結果は取り込まない
+    EXPECT_EQ(cache.Apply(evicted), 0u);
+    EXPECT_FALSE(cache.IsReady(2));
+    exec.Run();
+    EXPECT_EQ(cache.Apply(evicted), 1u);
+    EXPECT_TRUE(cache.IsReady(2));
+}
+
+// 既定の Executor（JobSystem）でも、並んで作った結果がすべて取り込まれる
+TEST(PermutationCache, BuildsOnJobSystem) {
+    PermutationCache<int>::Config config;
+    config.capacity = 64;
+    config.maxBuilding = 4;
+    std::atomic<int> calls{ 0 };
+    PermutationCache<int> cache([&calls](PermutationKey key, int& out) {
+        ++calls;
+        out = int(key) * 10;
+        return true;
+    }, config);
+    std::vector<int> evicted;
+    for (PermutationKey k = 0; k < 32; ++k) cache.Prefetch(k);
+    while (cache.Size() < 32) {
+        cache.WaitIdle();
+        cache.Apply(evicted);
+    }
+    EXPECT_EQ(calls.load(), 32);
+    for (PermutationKey k = 0; k < 32; ++k) {
+        const int* v = cache.Request(k);
+        ASSERT_NE(v, nullptr);
+        EXPECT_EQ(*v, int(k) * 10);
+    }
+}
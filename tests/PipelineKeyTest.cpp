@@ -0,0 +1,146 @@
+#include "core/PipelineKey.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+struct QuadVertex {
+    float position[3];
+    float uv[2];
+};
+
+constexpr InputLayout kQuadLayout = MakeInputLayout<QuadVertex>({
+    VertexElement<decltype(QuadVertex::position)>("POSITION", offsetof(QuadVertex, position)),
+    VertexElement<decltype(QuadVertex::uv)>("TEXCOORD", offsetof(QuadVertex, uv)),
+});
+
+constexpr PipelineStateDesc kQuadState = PipelineStateDesc{}
+    .WithInputLayout(kQuadLayout)
+    .WithRasterizer(kRasterCullNone)
+    .WithRenderTarget(PixelFormat::R8G8B8A8Unorm);
+constexpr uint64_t kQuadHash = HashPipelineState(kQuadState);
+
+// 実行時に kQuadState を組み立て直し、edit を当てたもの（constexpr の値から畳まれないように）
+PipelineStateDesc EditedQuad(const std::function<void(PipelineStateDesc&)>& edit) {
+    PipelineStateDesc d;
+    d.inputLayout = MakeInputLayout<QuadVertex>({
+        VertexElement<float[3]>("POSITION", offsetof(QuadVertex, position)),
+        VertexElement<float[2]>("TEXCOORD", offsetof(QuadVertex, uv)),
+    });
+    d.rasterizer.cullMode = CullMode::None;
+    d = d.WithRenderTarget(PixelFormat::R8G8B8A8Unorm);
+    edit(d);
+    return d;
+}
+
+ContentKey Key(uint64_t seed) {
+    return ContentKey{ seed * 0x9e3779b97f4a7c15ull, ~seed };
+}
+
+} // namespace
+
+// 実行時に組み立てた desc のハッシュはコンパイル時の値と同じ
+TEST(PipelineStateHash, RuntimeMatchesCompileTime) {
+    EXPECT_EQ(HashPipelineState(EditedQuad([](PipelineStateDesc&) {})), kQuadHash);
+    static_assert(kQuadHash != 0);
+}
+
+// D3D12 が見ない値はどう変えても同じハッシュ
+TEST(PipelineStateHash, IgnoresFieldsD3D12Ignores) {
+    const std::vector<std::function<void(PipelineStateDesc&)>> edits = {
+        [](PipelineStateDesc& d) { d.blend.renderTargets[2].srcBlend = Blend::SrcAlpha; },
+        [](PipelineStateDesc& d) { d.blend.renderTargets[0].blendOp = BlendOp::Max; },
+        [](PipelineStateDesc& d) { d.blend.renderTargets[0].logicOp = LogicOp::Set; },
+        [](PipelineStateDesc& d) { d.rtvFormats[1] = PixelFormat::R32Float; },
+        [](PipelineStateDesc& d) { d.depthStencil.depthFunc = ComparisonFunc::Always; },
+        [](PipelineStateDesc& d) { d.depthStencil.depthWriteMask = DepthWriteMask::All; },
+        [](PipelineStateDesc& d) { d.depthStencil.stencilReadMask = 0x0f; },
+        [](PipelineStateDesc& d) { d.depthStencil.backFace.func = ComparisonFunc::Less; },
+        [](PipelineStateDesc& d) { d.sampleMask = 0x1; }, // サンプル数 1 では下位 1 ビットしか見ない
+        [](PipelineStateDesc& d) { d.rasterizer.depthBiasClamp = -0.0f; },
+        [](PipelineStateDesc& d) { d.inputLayout.elements[0].semanticName = "position"; },
+        [](PipelineStateDesc& d) { d.inputLayout.elements[1].instanceDataStepRate = 3; },
+        [](PipelineStateDesc& d) { d.inputLayout.stride = 0; },
+        [](PipelineStateDesc& d) { d.inputLayout.elements[5].semanticName = "UNUSED"; }, // count より後ろ
+    };
+    for (size_t i = 0; i < edits.size(); ++i) EXPECT_EQ(HashPipelineState(EditedQuad(edits[i])), kQuadHash) << "edit " << i;
+}
+
+// PSO が変わる値はどれも別のハッシュ
+TEST(PipelineStateHash, DistinguishesFieldsD3D12Uses) {
+    const std::vector<std::function<void(PipelineStateDesc&)>> edits = {
+        [](PipelineStateDesc& d) { d.blend = kBlendAlpha; },
+        [](PipelineStateDesc& d) { d.blend.renderTargets[0].renderTargetWriteMask = 0x7; },
+        [](PipelineStateDesc& d) { d.blend.alphaToCoverageEnable = true; },
+        [](PipelineStateDesc& d) { d.rasterizer.cullMode = CullMode::Back; },
+        [](PipelineStateDesc& d) { d.rasterizer.depthBias = 1; },
+        [](PipelineStateDesc& d) { d.rasterizer.frontCounterClockwise = true; },
+        [](PipelineStateDesc& d) { d = d.WithDepthStencil(kDepthRead, PixelFormat::D32Float); },
+        [](PipelineStateDesc& d) { d.inputLayout.elements[1].alignedByteOffset = 16; },
+        [](PipelineStateDesc& d) { d.inputLayout.elements[1].semanticIndex = 1; },
+        [](PipelineStateDesc& d) {
+            d.inputLayout.elements[1].classification = InputClassification::PerInstance;
+            d.inputLayout.elements[1].instanceDataStepRate = 1;
+        },
+        [](PipelineStateDesc& d) { d.rtvFormats[0] = PixelFormat::R8G8B8A8UnormSrgb; },
+        [](PipelineStateDesc& d) { d = d.WithRenderTarget(PixelFormat::R32Float); },
+        [](PipelineStateDesc& d) { d.primitiveTopologyType = PrimitiveTopologyType::Line; },
+        [](PipelineStateDesc& d) { d.ibStripCutValue = IndexStripCut::Value0xFFFF; },
+        [](PipelineStateDesc& d) { d.sampleCount = 4; },
+        [](PipelineStateDesc& d) { d.sampleMask = 0xFFFFFFFEu; },
+    };
+    std::vector<uint64_t> hashes = { kQuadHash };
+    for (size_t i = 0; i < edits.size(); ++i) {
+        const uint64_t h = HashPipelineState(EditedQuad(edits[i]));
+        for (uint64_t other : hashes) EXPECT_NE(h, other) << "edit " << i;
+        hashes.push_back(h);
+    }
+}
+
+// 正規化は冪等で、正規化した desc のハッシュは元と同じ
+TEST(PipelineStateHash, NormalizeIsIdempotent) {
+    const PipelineStateDesc d = EditedQuad([](PipelineStateDesc& e) {
+        e.depthStencil.depthFunc = ComparisonFunc::Greater;
+        e.blend.renderTargets[4].srcBlend = Blend::DestColor;
+        e.rtvFormats[7] = PixelFormat::B8G8R8A8Unorm;
+    });
+    const PipelineStateDesc once = NormalizePipelineState(d);
+    const PipelineStateDesc twice = NormalizePipelineState(once);
+    EXPECT_EQ(HashPipelineState(once), HashPipelineState(d));
+    EXPECT_EQ(once.depthStencil.depthFunc, twice.depthStencil.depthFunc);
+    EXPECT_EQ(once.blend.renderTargets[4].srcBlend, Blend::One);
+    EXPECT_EQ(once.rtvFormats[7], PixelFormat::Unknown);
+    EXPECT_EQ(once.rtvFormats, twice.rtvFormats);
+}
+
+// キーはどのステージ・ルートシグネチャ・固定部分が変わっても変わり、同じ入力なら同じ値
+TEST(PipelineKey, EveryFieldContributes) {
+    PipelineKeyDesc base;
+    base.rootSignature = Key(1);
+    base.vs = Key(2);
+    base.ps = Key(3);
+    base.state = kQuadHash;
+    const ContentKey k = MakePipelineKey(base);
+    EXPECT_EQ(MakePipelineKey(base), k);
+
+    const std::vector<std::function<void(PipelineKeyDesc&)>> edits = {
+        [](PipelineKeyDesc& d) { d.rootSignature = Key(9); },
+        [](PipelineKeyDesc& d) { d.vs = Key(9); },
+        [](PipelineKeyDesc& d) { d.ps = Key(9); },
+        [](PipelineKeyDesc& d) { d.ds = Key(9); },
+        [](PipelineKeyDesc& d) { d.hs = Key(9); },
+        [](PipelineKeyDesc& d) { d.gs = Key(9); },
+        [](PipelineKeyDesc& d) { std::swap(d.vs, d.ps); }, // 同じバイトコードでも別のステージなら別
+        [](PipelineKeyDesc& d) { d.state ^= 1; },
+    };
+    for (size_t i = 0; i < edits.size(); ++i) {
+        PipelineKeyDesc d = base;
+        edits[i](d);
+        EXPECT_NE(MakePipelineKey(d), k) << "edit " << i;
+    }
+}
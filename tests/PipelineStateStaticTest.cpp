@@ -0,0 +1,107 @@
+#include "core/PipelineKey.h"
+#include "core/RootSignatureLayout.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+
+using namespace jisaku;
+
+// 入力レイアウト・パイプラインステート・ルートシグネチャの constexpr での確認。
+// 失敗はこのファイルのコンパイルエラーになる
+
+namespace {
+
+struct TestVertex {
+    float position[3];
+    float uv[2];
+    uint32_t id;
+};
+
+constexpr InputLayout kTestLayout = MakeInputLayout<TestVertex>({
+    VertexElement<decltype(TestVertex::position)>("POSITION", offsetof(TestVertex, position)),
+    VertexElement<decltype(TestVertex::uv)>("TEXCOORD", offsetof(TestVertex, uv)),
+    VertexElement<decltype(TestVertex::id)>("ID", offsetof(TestVertex, id)),
+});
+static_assert(kTestLayout.IsValid() && kTestLayout.count == 3 && kTestLayout.stride == 24);
+static_assert(kTestLayout.elements[1].format == PixelFormat::R32G32Float && kTestLayout.elements[1].alignedByteOffset == 12);
+static_assert(kTestLayout.elements[2].format == PixelFormat::R32Uint && kTestLayout.elements[2].alignedByteOffset == 20);
+// 重なり・構造体からのはみ出し・同じセマンティクス（大文字・小文字は区別しない）
+static_assert(!kTestLayout.With(VertexElement<float>("OTHER", 8)).IsValid());
+static_assert(!kTestLayout.With(VertexElement<float>("OTHER", 24)).IsValid());
+constexpr InputElement TestSlot1(const char* semantic, uint32_t index) {
+    InputElement e = VertexElement<float>(semantic, 0, index);
+    e.inputSlot = 1;
+    return e;
+}
+static_assert(!kTestLayout.With(TestSlot1("position", 0)).IsValid());
+static_assert(kTestLayout.With(TestSlot1("position", 1)).IsValid());
+
+constexpr PipelineStateDesc kTestState = PipelineStateDesc{}
+    .WithInputLayout(kTestLayout)
+    .WithRasterizer(kRasterCullNone)
+    .WithRenderTarget(PixelFormat::R8G8B8A8Unorm);
+static_assert(kTestState.IsValid());
+static_assert(!PipelineStateDesc{}.WithDepthStencil(kDepthReadWrite, PixelFormat::Unknown).IsValid());
+static_assert(PipelineStateDesc{}.WithDepthStencil(kDepthReadWrite, PixelFormat::D32Float).IsValid());
+
+constexpr uint64_t kTestHash = HashPipelineState(kTestState);
+// D3D12 が見ない値は変えても同じ
+static_assert(HashPipelineState([] {
+    PipelineStateDesc d = kTestState;
+    d.blend.renderTargets[3].srcBlend = Blend::SrcAlpha; // 独立ブレンドでない
+    d.blend.renderTargets[0].destBlend = Blend::One;     // ブレンドが無効
+    d.rtvFormats[5] = PixelFormat::R32Float;             // NumRenderTargets より後ろ
+    d.depthStencil.depthFunc = ComparisonFunc::Greater;  // 深度テストが無効
+    d.depthStencil.frontFace.passOp = StencilOp::Replace;
+    d.sampleMask = 1;
+    d.rasterizer.slopeScaledDepthBias = -0.0f;
+    d.inputLayout.elements[0].semanticName = "Position";
+    d.inputLayout.elements[1].instanceDataStepRate = 4;  // 頂点ごと
+    d.inputLayout.stride = 0;
+    return d;
+}()) == kTestHash);
+// PSO が変わるものは別のハッシュ
+static_assert(HashPipelineState(kTestState.WithRasterizer(kRasterCullBack)) != kTestHash);
+static_assert(HashPipelineState(kTestState.WithBlend(kBlendAlpha)) != kTestHash);
+static_assert(HashPipelineState(kTestState.WithRenderTarget(PixelFormat::R32Float)) != kTestHash);
+static_assert(HashPipelineState(kTestState.WithDepthStencil(kDepthRead, PixelFormat::D32Float)) !=
+              HashPipelineState(kTestState.WithDepthStencil(kDepthReadWrite, PixelFormat::D32Float)));
+static_assert(HashPipelineState(kTestState.WithTopology(PrimitiveTopologyType::Line)) != kTestHash);
+static_assert(HashPipelineState([] {
+    PipelineStateDesc d = kTestState;
+    d.inputLayout.elements[1].alignedByteOffset = 16;
+    return d;
+}()) != kTestHash);
+
+constexpr RootSignatureLayout kTestRoot = RootSignatureLayout{}
+    .AllowInputLayout()
+    .Cbv(0, ShaderVisibility::Vertex)
+    .Table(ShaderVisibility::Pixel, { DescriptorRange::Srv(0, 4) })
+    .Sampler(StaticSampler::LinearClamp(0));
+static_assert(kTestRoot.IsValid() && kTestRoot.parameterCount == 2 && kTestRoot.flags == kRootSignatureAllowInputLayout);
+// 同じシェーダーから見えるレジスターの重なり
+static_assert(!kTestRoot.Srv(3, ShaderVisibility::Pixel).IsValid());
+static_assert(!kTestRoot.Srv(3, ShaderVisibility::All).IsValid());
+static_assert(kTestRoot.Srv(3, ShaderVisibility::Vertex).IsValid());
+static_assert(kTestRoot.Srv(4, ShaderVisibility::Pixel).IsValid());
+static_assert(!kTestRoot.Constants(4, 0, ShaderVisibility::All).IsValid());
+static_assert(kTestRoot.Constants(4, 0, ShaderVisibility::All, 1).IsValid());
+static_assert(!kTestRoot.Sampler(StaticSampler::PointClamp(0)).IsValid());
+// 空のテーブル、サンプラーと他のビューの混在、サイズ未定の範囲の後ろ
+static_assert(!RootSignatureLayout{}.Table(ShaderVisibility::All, {}).IsValid());
+static_assert(!RootSignatureLayout{}.Table(ShaderVisibility::All, { DescriptorRange::Srv(0), DescriptorRange::Sampler(0) }).IsValid());
+static_assert(!RootSignatureLayout{}.Table(ShaderVisibility::All, { DescriptorRange::Srv(0, kUnboundedDescriptors), DescriptorRange::Srv(100) }).IsValid());
+
+} // namespace
+
+// 同じ確認を実行時の評価でも通す（constexpr でしか動かない分岐が無いこと）
+TEST(PipelineStateStatic, SameResultsAtRuntime) {
+    const InputLayout layout = kTestLayout;
+    EXPECT_TRUE(layout.IsValid());
+    EXPECT_FALSE(layout.With(VertexElement<float>("OTHER", 8)).IsValid());
+    const PipelineStateDesc state = kTestState;
+    EXPECT_TRUE(state.IsValid());
+    EXPECT_EQ(HashPipelineState(state), kTestHash);
+    const RootSignatureLayout root = kTestRoot;
+    EXPECT_TRUE(root.IsValid());
+    EXPECT_FALSE(root.Srv(3, ShaderVisibility::Pixel).IsValid());
+}
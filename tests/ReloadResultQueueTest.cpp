@@ -0,0 +1,102 @@
+#include "core/JobSystem.h"
+#include "core/ReloadResultQueue.h"
+#include <gtest/gtest.h>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace jisaku;
+
+// 結果は id ごとに 1 つずつ Take で受け取り、受け取ると空になる
+TEST(ReloadResultQueue, TakeReturnsFinishedResults) {
+    ReloadResultQueue<std::string> queue;
+    const uint64_t a = queue.Begin(1), b = queue.Begin(2);
+    EXPECT_TRUE(queue.IsRunning(1));
+    EXPECT_EQ(queue.GetInFlight(), 2u);
+    EXPECT_FALSE(queue.HasReady());
+
+    queue.Finish(2, b, "two");
+    queue.Finish(1, a, "one");
+    EXPECT_FALSE(queue.IsRunning(1));
+    EXPECT_EQ(queue.GetInFlight(), 0u);
+    ASSERT_TRUE(queue.HasReady());
+    const auto ready = queue.Take();
+    ASSERT_EQ(ready.size(), 2u);
+    EXPECT_EQ(ready[0], (std::pair<uint64_t, std::string>(2, "two")));
+    EXPECT_EQ(ready[1], (std::pair<uint64_t, std::string>(1, "one")));
+    EXPECT_TRUE(queue.Take().empty());
+}
+
+// 実行中にまた Begin したら、前の世代の結果は後から戻ってきても捨てる
+TEST(ReloadResultQueue, StaleGenerationIsDiscarded) {
+    ReloadResultQueue<int> queue;
+    const uint64_t first = queue.Begin(7);
+    const uint64_t second = queue.Begin(7);
+    EXPECT_NE(first, second);
+
+    queue.Finish(7, second, 2);
+    queue.Finish(7, first, 1); // 遅れて戻ってきた古い結果
+    EXPECT_EQ(queue.GetDiscarded(), 1u);
+    const auto ready = queue.Take();
+    ASSERT_EQ(ready.size(), 1u);
+    EXPECT_EQ(ready[0].second, 2);
+}
+
+// Take される前に同じ id の新しい結果が来たら置き換える（同じ id が 2 つ並ばない）
+TEST(ReloadResultQueue, NewerResultReplacesUntaken) {
+    ReloadResultQueue<int> queue;
+    queue.Finish(3, queue.Begin(3), 1);
+    queue.Finish(3, queue.Begin(3), 2);
+    const auto ready = queue.Take();
+    ASSERT_EQ(ready.size(), 1u);
+    EXPECT_EQ(ready[0].second, 2);
+}
+
+// Cancel は受け取り待ちも実行中も捨て、Cancel 後に戻ってきた結果も出てこない
+TEST(ReloadResultQueue, CancelDropsReadyAndRunning) {
+    ReloadResultQueue<int> queue;
+    queue.Finish(1, queue.Begin(1), 10);
+    const uint64_t running = queue.Begin(2);
+    queue.Cancel(1);
+    queue.Cancel(2);
+    EXPECT_FALSE(queue.HasReady());
+    EXPECT_FALSE(queue.IsRunning(2));
+
+    queue.Finish(2, running, 20);
+    EXPECT_FALSE(queue.HasReady());
+    EXPECT_EQ(queue.GetInFlight(), 0u);
+    // Cancel の後に Begin し直した世代は通常どおり受け取れる
+    queue.Finish(2, queue.Begin(2), 21);
+    const auto ready = queue.Take();
+    ASSERT_EQ(ready.size(), 1u);
+    EXPECT_EQ(ready[0].second, 21);
+}
+
+// ワーカーから並んで Finish しても、id ごとに最後に Begin した世代の結果だけが残る
+TEST(ReloadResultQueue, ConcurrentFinishKeepsLatest) {
+    JobSystem jobs(3);
+    ReloadResultQueue<int> queue;
+    constexpr uint64_t kIds = 16;
+    constexpr int kRounds = 50;
+    // 全部 Begin し終えるまでワーカーを止めておく（先に Finish した世代は追い越されずに受け取られてしまう）
+    std::promise<void> release;
+    const std::shared_future<void> started = release.get_future().share();
+    for (int round = 0; round < kRounds; ++round) {
+        for (uint64_t id = 0; id < kIds; ++id) {
+            const uint64_t generation = queue.Begin(id);
+            jobs.Submit([&queue, started, id, generation, round] {
+                started.wait();
+                queue.Finish(id, generation, round);
+            });
+        }
+    }
+    release.set_value();
+    queue.WaitIdle();
+    EXPECT_EQ(queue.GetInFlight(), 0u);
+
+    const auto ready = queue.Take();
+    ASSERT_EQ(ready.size(), kIds);
+    for (const auto& [id, round] : ready) EXPECT_EQ(round, kRounds - 1) << "id " << id;
+    EXPECT_EQ(queue.GetDiscarded() + kIds, kIds * kRounds);
+}
@@ -0,0 +1,119 @@
+#include "core/AtomicFile.h"
+#include "core/ByteOrder.h"
+#include "core/SceneFile.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// 2 ブロックにまたがるシーン。親は自分より前のエンティティ、テクスチャは 3 種を巡回
+EntityStore MakeScene(uint32_t count) {
+    EntityStore store;
+    const uint32_t tex[3] = { store.AddTexture(AssetPathHash("a.png"), "a.png"), store.AddTexture(AssetPathHash("b.png"), "b.png"),
+                              store.AddTexture(AssetPathHash("c.png"), "c.png") };
+    for (uint32_t i = 0; i < count; ++i) {
+        const float f = float(i);
+        store.Create({ f, -f, f * 0.5f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 2.0f, 3.0f }, tex[i % 3], i == 0 ? kNoEntity : i / 2);
+    }
+    return store;
+}
+
+std::vector<uint8_t> ReadBytes(const std::filesystem::path& file) {
+    std::ifstream f(file, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+// ブロック表の block 番目の成分配列（field: 0=texture, 1=parent）の先頭 u32 を value に書き換える
+void PatchBlockArray(std::vector<uint8_t>& bytes, uint32_t block, int field, uint32_t value) {
+    const uint64_t blocks = ReadU64(&bytes[32]);                   // FileHeader::blocks
+    const uint64_t entry = blocks + uint64_t(block) * 48;          // sizeof(Block_)
+    const uint64_t offset = ReadU64(&bytes[entry + 32 + field * 8]); // Block_::texture / parent
+    WriteU32(&bytes[offset], value);
+}
+
+class SceneFileTest : public ::testing::Test {
+protected:
+    void SetUp() override { m_dir = CreateTempDirectory("jisaku-scenetest-"); }
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(m_dir, ec);
+    }
+    std::filesystem::path m_dir;
+};
+
+} // namespace
+
+// 書き出して読み戻すと成分・テクスチャ・親がすべて一致する
+TEST_F(SceneFileTest, RoundTrip) {
+    const EntityStore src = MakeScene(kSceneBlockSize + 100);
+    const auto file = m_dir / "scene.jscn";
+    ASSERT_TRUE(WriteScene(file, src));
+
+    EntityStore dst;
+    ASSERT_TRUE(LoadScene(file, dst));
+    ASSERT_EQ(dst.Size(), src.Size());
+    ASSERT_EQ(dst.GetTextures().size(), src.GetTextures().size());
+    EXPECT_EQ(std::memcmp(dst.Positions(), src.Positions(), src.Size() * sizeof(Float3)), 0);
+    EXPECT_EQ(std::memcmp(dst.Rotations(), src.Rotations(), src.Size() * sizeof(Quat)), 0);
+    EXPECT_EQ(std::memcmp(dst.Scales(), src.Scales(), src.Size() * sizeof(Float3)), 0);
+    EXPECT_EQ(std::memcmp(dst.Textures(), src.Textures(), src.Size() * sizeof(uint32_t)), 0);
+    EXPECT_EQ(std::memcmp(dst.Parents(), src.Parents(), src.Size() * sizeof(uint32_t)), 0);
+}
+
+// 既存のエンティティの後ろに取り込むと、親はずれた位置を指し、同じテクスチャは共有される
+TEST_F(SceneFileTest, AppendsAfterExistingEntities) {
+    const auto file = m_dir / "scene.jscn";
+    ASSERT_TRUE(WriteScene(file, MakeScene(10)));
+    EntityStore store = MakeScene(5);
+    ASSERT_TRUE(LoadScene(file, store));
+    ASSERT_EQ(store.Size(), 15u);
+    EXPECT_EQ(store.GetTextures().size(), 3u);
+    EXPECT_EQ(store.Parents()[5], kNoEntity);
+    EXPECT_EQ(store.Parents()[5 + 9], 5u + 4u);
+}
+
+// 後ろのブロックに範囲外の添字があれば、前のブロックも含めて store は一切変わらない
+TEST_F(SceneFileTest, BadIndexLeavesStoreUntouched) {
+    const auto file = m_dir / "scene.jscn";
+    ASSERT_TRUE(WriteScene(file, MakeScene(kSceneBlockSize + 100)));
+    const std::vector<uint8_t> good = ReadBytes(file);
+
+    for (int field = 0; field < 2; ++field) {
+        std::vector<uint8_t> bytes = good;
+        PatchBlockArray(bytes, 1, field, 999999);
+        ASSERT_TRUE(WriteFileAtomic(file, bytes.data(), bytes.size()));
+
+        SceneFile scene;
+        ASSERT_TRUE(scene.Open(file));
+        EntityStore store = MakeScene(7);
+        EXPECT_FALSE(scene.StreamInto(store)) << "field " << field;
+        EXPECT_EQ(store.Size(), 7u);
+        EXPECT_EQ(store.GetTextures().size(), 3u);
+        // 先頭ブロックだけなら取り込める
+        EXPECT_TRUE(scene.StreamInto(store, 0, 1));
+        EXPECT_EQ(store.Size(), 7u + kSceneBlockSize);
+    }
+}
+
+// 切り詰めたファイル・範囲外のオフセットは Open で弾く
+TEST_F(SceneFileTest, RejectsCorruptFiles) {
+    const auto file = m_dir / "scene.jscn";
+    ASSERT_TRUE(WriteScene(file, MakeScene(100)));
+    const std::vector<uint8_t> good = ReadBytes(file);
+
+    ASSERT_TRUE(WriteFileAtomic(file, good.data(), good.size() - 16));
+    SceneFile scene;
+    EXPECT_FALSE(scene.Open(file));
+
+    std::vector<uint8_t> bytes = good;
+    const uint64_t entry = ReadU64(&bytes[32]);
+    WriteU64(&bytes[entry + 8], good.size()); // block 0 の position を末尾へ
+    ASSERT_TRUE(WriteFileAtomic(file, bytes.data(), bytes.size()));
+    EXPECT_FALSE(scene.Open(file));
+}
@@ -0,0 +1,175 @@
+#include "core/AtomicFile.h"
+#include "core/ShaderCache.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// メモリ上のファイル表から読む ShaderFileReader
+ShaderFileReader MapReader(const std::map<std::string, std::string>& files) {
+    return [&files](const std::string& path, std::string& out) {
+        const auto it = files.find(path);
+        if (it == files.end()) return false;
+        out = it->second;
+        return true;
+    };
+}
+
+ContentKey KeyFor(std::string_view source, const std::vector<std::string>& defines, std::string_view compiler = "dxc-1.8") {
+    ShaderKeyDesc desc;
+    desc.source = source;
+    desc.entry = "main";
+    desc.target = "ps_6_0";
+    desc.defines = &defines;
+    desc.compiler = compiler;
+    desc.args = "-O3";
+    return MakeShaderCacheKey(desc);
+}
+
+class ShaderCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override { m_dir = CreateTempDirectory("jisaku-shadercachetest-"); }
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(m_dir, ec);
+    }
+    std::filesystem::path m_dir;
+};
+
+} // namespace
+
+// 書いたものがそのまま読め、ヒット・ミス・保存の数が数えられる
+TEST_F(ShaderCacheTest, StoreThenLoad) {
+    ShaderCache cache(m_dir);
+    const ContentKey key = KeyFor("float4 main() : SV_Target { return 1; }", {});
+    const std::vector<uint8_t> bytecode = { 'D', 'X', 'B', 'C', 1, 2, 3, 4, 0, 255 };
+
+    std::vector<uint8_t> loaded;
+    EXPECT_FALSE(cache.Load(key, loaded));
+    ASSERT_TRUE(cache.Store(key, bytecode.data(), bytecode.size()));
+    ASSERT_TRUE(cache.Load(key, loaded));
+    EXPECT_EQ(loaded, bytecode);
+
+    // 別のインスタンス（次回起動）からも読める
+    ShaderCache reopened(m_dir);
+    ASSERT_TRUE(reopened.Load(key, loaded));
+    EXPECT_EQ(loaded, bytecode);
+
+    const ShaderCache::Stats s = cache.GetStats();
+    EXPECT_EQ(s.hits, 1u);
+    EXPECT_EQ(s.misses, 1u);
+    EXPECT_EQ(s.stores, 1u);
+    EXPECT_EQ(s.corrupt, 0u);
+}
+
+// 中身が壊れた・途中で切れたファイルはミス扱いにし、作り直せる
+TEST_F(ShaderCacheTest, CorruptEntryIsMiss) {
+    ShaderCache cache(m_dir);
+    const ContentKey key = KeyFor("void main() {}", {});
+    const std::vector<uint8_t> bytecode(1000, 0x5a);
+    ASSERT_TRUE(cache.Store(key, bytecode.data(), bytecode.size()));
+    const std::filesystem::path object = ContentObjectPath(m_dir, key);
+
+    {
+        std::fstream f(object, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(32 + 500);
+        f.put('\x00');
+    }
+    std::vector<uint8_t> loaded;
+    EXPECT_FALSE(cache.Load(key, loaded));
+    EXPECT_TRUE(loaded.empty());
+
+    std::filesystem::resize_file(object, 32 + 10);
+    EXPECT_FALSE(cache.Load(key, loaded));
+    EXPECT_EQ(cache.GetStats().corrupt, 2u);
+
+    ASSERT_TRUE(cache.Store(key, bytecode.data(), bytecode.size()));
+    ASSERT_TRUE(cache.Load(key, loaded));
+    EXPECT_EQ(loaded, bytecode);
+}
+
+// ソース・define（順序も）・コンパイラのどれが変わってもキーが変わる
+TEST(ShaderCacheKey, ChangesWithEveryInput) {
+    const ContentKey base = KeyFor("src", { "A=1", "B=2" });
+    EXPECT_EQ(KeyFor("src", { "A=1", "B=2" }), base);
+    EXPECT_NE(KeyFor("src ", { "A=1", "B=2" }), base);
+    EXPECT_NE(KeyFor("src", { "B=2", "A=1" }), base);
+    EXPECT_NE(KeyFor("src", { "A=1" }), base);
+    EXPECT_NE(KeyFor("src", { "A=1", "B=2" }, "dxc-1.9"), base);
+    // 区切りをまたいだ連結で同じ文字列にならない
+    EXPECT_NE(KeyFor("src", { "A=1B=2" }), KeyFor("src", { "A=1", "B=2" }));
+
+    const std::vector<std::string> none;
+    ShaderKeyDesc desc;
+    desc.source = "src";
+    desc.entry = "main";
+    desc.target = "ps_6_0";
+    desc.defines = &none;
+    const ContentKey ps = MakeShaderCacheKey(desc);
+    desc.target = "vs_6_0";
+    EXPECT_NE(MakeShaderCacheKey(desc), ps);
+    desc.target = "ps_6_0";
+    desc.entry = "main2";
+    EXPECT_NE(MakeShaderCacheKey(desc), ps);
+}
+
+// 取り込み元のディレクトリ → includeDirs の順に探し、境目に #line を入れる
+TEST(ShaderIncludes, ExpandsRelativeThenIncludeDirs) {
+    const std::map<std::string, std::string> files = {
+        { "shaders/main.hlsl", "#include \"common.hlsli\"\n#include <lib/util.hlsli>\nfloat4 main();\n" },
+        { "shaders/common.hlsli", "#define COMMON 1\n" },
+        { "inc/lib/util.hlsli", "#pragma once\nfloat util();\n" },
+    };
+    ShaderSource source;
+    std::string error;
+    ASSERT_TRUE(ExpandShaderIncludes("shaders/./main.hlsl", MapReader(files), { "inc" }, source, error)) << error;
+    EXPECT_EQ(source.text,
+              "#line 1 \"shaders/main.hlsl\"\n"
+              "#line 1 \"shaders/common.hlsli\"\n"
+              "#define COMMON 1\n"
+              "#line 2 \"shaders/main.hlsl\"\n"
+              "#line 1 \"inc/lib/util.hlsli\"\n"
+              "\n"
+              "float util();\n"
+              "#line 3 \"shaders/main.hlsl\"\n"
+              "float4 main();\n");
+    EXPECT_EQ(source.files, (std::vector<std::string>{ "shaders/main.hlsl", "shaders/common.hlsli", "inc/lib/util.hlsli" }));
+}
+
+// #pragma once は 2 回目を取り込まず、コメントの中の #include は無視する
+TEST(ShaderIncludes, PragmaOnceAndComments) {
+    const std::map<std::string, std::string> files = {
+        { "main.hlsl", "#include \"a.hlsli\"\n// #include \"missing.hlsli\"\n/*\n#include \"missing.hlsli\"\n*/\n#include \"a.hlsli\"\n" },
+        { "a.hlsli", "#pragma once\nint a;\n" },
+    };
+    ShaderSource source;
+    std::string error;
+    ASSERT_TRUE(ExpandShaderIncludes("main.hlsl", MapReader(files), {}, source, error)) << error;
+    size_t count = 0;
+    for (size_t p = source.text.find("int a;"); p != std::string::npos; p = source.text.find("int a;", p + 1)) ++count;
+    EXPECT_EQ(count, 1u);
+}
+
+// 見つからない・循環している include は行番号つきで失敗する
+TEST(ShaderIncludes, ReportsMissingAndRecursive) {
+    const std::map<std::string, std::string> files = {
+        { "missing.hlsl", "int x;\n#include \"nope.hlsli\"\n" },
+        { "a.hlsli", "#include \"b.hlsli\"\n" },
+        { "b.hlsli", "#include \"a.hlsli\"\n" },
+    };
+    ShaderSource source;
+    std::string error;
+    EXPECT_FALSE(ExpandShaderIncludes("missing.hlsl", MapReader(files), {}, source, error));
+    EXPECT_NE(error.find("missing.hlsl(2)"), std::string::npos) << error;
+    EXPECT_NE(error.find("nope.hlsli"), std::string::npos) << error;
+
+    error.clear();
+    EXPECT_FALSE(ExpandShaderIncludes("a.hlsli", MapReader(files), {}, source, error));
+    EXPECT_NE(error.find("recursive"), std::string::npos) << error;
+}
@@ -0,0 +1,221 @@
+#include "core/SharedCache.h"
+#include "gfx/TextureKey.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+using IntCache = SharedCache<int, std::string>;
+
+// count 本のスレッドを同時に走らせて fn(i) を呼び、全部終わるまで待つ
+void RunTogether(int count, const std::function<void(int)>& fn) {
+    std::latch start(count);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < count; ++i) {
+        threads.emplace_back([&start, &fn, i] {
+            start.arrive_and_wait();
+            fn(i);
+        });
+    }
+    for (std::thread& t : threads) t.join();
+}
+
+// kGateKey のハッシュを求めるところで、s_gate が下りるまで止まる（キャッシュのロックを持ったまま止めるため）
+constexpr int kGateKey = -1;
+std::atomic<bool> s_gate{ false }, s_holding{ false }, s_released{ false };
+
+struct GatedHash {
+    size_t operator()(int key) const {
+        if (key == kGateKey && s_gate) {
+            s_holding = true;
+            while (s_gate) std::this_thread::yield();
+        }
+        return std::hash<int>{}(key);
+    }
+};
+using GatedCache = SharedCache<int, std::string, GatedHash>;
+
+} // namespace
+
+// 同じキーを同時に要求しても読み込みは 1 回で、全員が同じポインタを受け取る
+TEST(SharedCache, ConcurrentGetOrLoadLoadsOnce) {
+    constexpr int kThreads = 8;
+    IntCache cache;
+    std::atomic<int> loads{ 0 };
+    std::vector<IntCache::Ptr> got(kThreads);
+    RunTogether(kThreads, [&](int i) {
+        got[i] = cache.GetOrLoad(7, [&loads](std::string& out) {
+            ++loads;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20)); // 他のスレッドが待ちに入る時間
+            out = "seven";
+            return true;
+        });
+    });
+    EXPECT_EQ(loads.load(), 1);
+    ASSERT_NE(got[0], nullptr);
+    EXPECT_EQ(*got[0], "seven");
+    for (const IntCache::Ptr& p : got) EXPECT_EQ(p, got[0]);
+    EXPECT_EQ(cache.Find(7), got[0]);
+    EXPECT_EQ(cache.Size(), 1u);
+}
+
+// 読み込みの失敗は待っていた側にも nullptr で届き、次の要求で読み直す
+TEST(SharedCache, FailedLoadReachesWaiters) {
+    constexpr int kThreads = 6;
+    IntCache cache;
+    std::atomic<int> nonNull{ 0 };
+    RunTogether(kThreads, [&](int) {
+        IntCache::Ptr p = cache.GetOrLoad(1, [](std::string&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return false;
+        });
+        if (p) ++nonNull;
+    });
+    EXPECT_EQ(nonNull.load(), 0);
+    EXPECT_EQ(cache.Size(), 0u);
+
+    IntCache::Ptr retry = cache.GetOrLoad(1, [](std::string& out) {
+        out = "ok";
+        return true;
+    });
+    ASSERT_NE(retry, nullptr);
+    EXPECT_EQ(*retry, "ok");
+}
+
+// 読み込み中の例外は待っていた側にも投げ直され、エントリは残らない
+TEST(SharedCache, LoadExceptionReachesWaiters) {
+    constexpr int kThreads = 6;
+    IntCache cache;
+    std::atomic<int> caught{ 0 };
+    RunTogether(kThreads, [&](int) {
+        try {
+            cache.GetOrLoad(1, [](std::string&) -> bool {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                throw std::runtime_error("decode failed");
+            });
+        } catch (const std::runtime_error&) {
+            ++caught;
+        }
+    });
+    EXPECT_EQ(caught.load(), kThreads);
+    EXPECT_EQ(cache.Size(), 0u);
+}
+
+// onRelease は最後の参照が外れたときに 1 回だけ、値を受け取って呼ばれる
+TEST(SharedCache, ReleaseFiresOnceOnLastReference) {
+    std::vector<std::string> released;
+    IntCache cache([&released](std::string&& v) { released.push_back(std::move(v)); });
+    IntCache::Ptr a = cache.GetOrLoad(3, [](std::string& out) {
+        out = "three";
+        return true;
+    });
+    IntCache::Ptr b = cache.GetOrLoad(3, [](std::string&) {
+        ADD_FAILURE() << "loaded twice";
+        return false;
+    });
+    EXPECT_EQ(a, b);
+
+    a.reset();
+    EXPECT_TRUE(released.empty());
+    EXPECT_EQ(cache.Find(3), b);
+    b.reset();
+    EXPECT_EQ(released, std::vector<std::string>{ "three" });
+    EXPECT_EQ(cache.Size(), 0u);
+    EXPECT_EQ(cache.Find(3), nullptr);
+}
+
+// キャッシュが先に破棄されても参照は有効なまま（onRelease は呼ばれない）
+TEST(SharedCache, ReferenceOutlivesCache) {
+    int releases = 0;
+    IntCache::Ptr p;
+    {
+        IntCache cache([&releases](std::string&&) { ++releases; });
+        p = cache.GetOrLoad(5, [](std::string& out) {
+            out = "five";
+            return true;
+        });
+    }
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(*p, "five");
+    p.reset();
+    EXPECT_EQ(releases, 0);
+}
+
+// 古い値の後始末がロック待ちの間に同じキーの読み直しが始まっても、後始末は新しいエントリを消さない。
+// 別スレッドがロックを持ったまま止まっている間に「読み直し」「最後の参照を外す」の順でロック待ちに並べる
+TEST(SharedCache, ReacquireRacingReleaseKeepsNewEntry) {
+    s_holding = false;
+    s_released = false;
+    GatedCache cache([](std::string&&) { s_released = true; });
+    GatedCache::Ptr old = cache.GetOrLoad(9, [](std::string& out) {
+        out = "old";
+        return true;
+    });
+
+    s_gate = true;
+    std::thread holder([&cache] { cache.Find(kGateKey); }); // ハッシュの中で止まる（ロックを持ったまま）
+    while (!s_holding) std::this_thread::yield();
+
+    GatedCache::Ptr reloaded;
+    size_t sizeDuringReload = 0;
+    std::thread reloader([&] {
+        reloaded = cache.GetOrLoad(9, [&](std::string& out) {
+            while (!s_released) std::this_thread::yield(); // 古い値の後始末が終わってから仕上げる
+            sizeDuringReload = cache.Size();
+            out = "new";
+            return true;
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::thread releaser([old = std::move(old)]() mutable { old.reset(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    s_gate = false;
+    for (std::thread* t : { &holder, &reloader, &releaser }) t->join();
+
+    EXPECT_TRUE(s_released);
+    EXPECT_EQ(sizeDuringReload, 1u); // 読み込み中のエントリが残っていた（消えていれば 0）
+    ASSERT_NE(reloaded, nullptr);
+    EXPECT_EQ(*reloaded, "new");
+    EXPECT_EQ(cache.Find(9), reloaded);
+}
+
+// キーはどの設定が違っても別物になり、同じなら同じハッシュ
+TEST(TextureKey, EveryFieldDistinguishes) {
+    TextureKey base;
+    base.path = L"/assets/textures/brick.png";
+    base.contentHash = 0x0123456789abcdefull;
+    const TextureKeyHash hash;
+
+    TextureKey same = base;
+    EXPECT_EQ(same, base);
+    EXPECT_EQ(hash(same), hash(base));
+
+    const std::vector<std::function<void(TextureKey&)>> edits = {
+        [](TextureKey& k) { k.path = L"/assets/textures/Brick.png"; },
+        [](TextureKey& k) { k.contentHash ^= 1; },
+        [](TextureKey& k) { k.forceSRGB = false; },
+        [](TextureKey& k) { k.generateMips = false; },
+        [](TextureKey& k) { k.compression = BCFormat::BC7; },
+        [](TextureKey& k) { k.quality = BCQuality::High; },
+        [](TextureKey& k) { k.mipFilter = MipFilter::Kaiser; },
+        [](TextureKey& k) { k.hdrBC6H = true; },
+    };
+    std::vector<size_t> hashes = { hash(base) };
+    for (size_t i = 0; i < edits.size(); ++i) {
+        TextureKey k = base;
+        edits[i](k);
+        EXPECT_NE(k, base) << "edit " << i;
+        const size_t h = hash(k);
+        for (size_t other : hashes) EXPECT_NE(h, other) << "edit " << i;
+        hashes.push_back(h);
+    }
+}
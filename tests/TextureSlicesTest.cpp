@@ -0,0 +1,200 @@
+#include "gfx/TextureSlices.h"
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace jisaku;
+
+namespace {
+
+// 画素 (x, y) に自分の座標を書いた画像。切り出した面の画素から元の位置が分かる
+Image MakeCoordImage(uint32_t width, uint32_t height) {
+    Image img;
+    img.Allocate(width, height);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* p = img.View().Row(y) + size_t(x) * 4;
+            p[0] = uint8_t(x);
+            p[1] = uint8_t(y);
+            p[2] = 0x40;
+            p[3] = 255;
+        }
+    }
+    return img;
+}
+
+Image MakeSolid(uint32_t width, uint32_t height, uint8_t r, uint8_t g, uint8_t b) {
+    Image img;
+    img.Allocate(width, height);
+    for (size_t i = 0; i < img.pixels.size(); i += 4) {
+        img.pixels[i + 0] = r;
+        img.pixels[i + 1] = g;
+        img.pixels[i + 2] = b;
+        img.pixels[i + 3] = 255;
+    }
+    return img;
+}
+
+// view の全画素が rgb から tolerance 以内か
+bool IsSolid(const ConstImageView& view, uint8_t r, uint8_t g, uint8_t b, int tolerance = 1) {
+    for (uint32_t y = 0; y < view.height; ++y) {
+        for (uint32_t x = 0; x < view.width; ++x) {
+            const uint8_t* p = view.Row(y) + size_t(x) * 4;
+            if (std::abs(p[0] - r) > tolerance || std::abs(p[1] - g) > tolerance || std::abs(p[2] - b) > tolerance) return false;
+        }
+    }
+    return true;
+}
+
+// リニアのまま平均させる（期待値を単純な算術平均で書けるように）
+MipOptions LinearOptions() {
+    MipOptions opt;
+    opt.srgb = false;
+    return opt;
+}
+
+struct CubeCase {
+    CubeLayout layout;
+    uint32_t cols, rows;
+    uint32_t cells[6][2]; // +X, -X, +Y, -Y, +Z, -Z の格子位置
+    bool rotateNegZ;
+};
+
+const CubeCase kCubeCases[] = {
+    { CubeLayout::HorizontalCross, 4, 3, { { 2, 1 }, { 0, 1 }, { 1, 0 }, { 1, 2 }, { 1, 1 }, { 3, 1 } }, false },
+    { CubeLayout::VerticalCross, 3, 4, { { 2, 1 }, { 0, 1 }, { 1, 0 }, { 1, 2 }, { 1, 1 }, { 1, 3 } }, true },
+    { CubeLayout::HorizontalStrip, 6, 1, { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 4, 0 }, { 5, 0 } }, false },
+    { CubeLayout::VerticalStrip, 1, 6, { { 0, 0 }, { 0, 1 }, { 0, 2 }, { 0, 3 }, { 0, 4 }, { 0, 5 } }, false },
+};
+
+} // namespace
+
+// 4 種類の展開図それぞれで、各面が正しい格子から切り出される（縦十字の -Z は 180 度回転）。Auto も同じ結果
+TEST(TextureSlices, CubeFacePlacement) {
+    constexpr uint32_t kSize = 5;
+    for (const CubeCase& c : kCubeCases) {
+        const Image sheet = MakeCoordImage(c.cols * kSize, c.rows * kSize);
+        for (CubeLayout layout : { c.layout, CubeLayout::Auto }) {
+            std::vector<Image> faces;
+            ASSERT_TRUE(ExtractCubeFaces(sheet.View(), layout, faces)) << "layout " << int(c.layout);
+            ASSERT_EQ(faces.size(), 6u);
+            for (uint32_t f = 0; f < 6; ++f) {
+                ASSERT_EQ(faces[f].width, kSize);
+                ASSERT_EQ(faces[f].height, kSize);
+                const bool rotated = f == 5 && c.rotateNegZ;
+                for (uint32_t y = 0; y < kSize; ++y) {
+                    for (uint32_t x = 0; x < kSize; ++x) {
+                        const uint32_t sx = c.cells[f][0] * kSize + (rotated ? kSize - 1 - x : x);
+                        const uint32_t sy = c.cells[f][1] * kSize + (rotated ? kSize - 1 - y : y);
+                        const uint8_t* p = faces[f].View().Row(y) + size_t(x) * 4;
+                        ASSERT_EQ(p[0], sx) << "layout " << int(c.layout) << " face " << f;
+                        ASSERT_EQ(p[1], sy) << "layout " << int(c.layout) << " face " << f;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 縦横比が展開図に合わない・格子で割り切れない入力は弾く
+TEST(TextureSlices, RejectsBadShapes) {
+    std::vector<Image> out;
+    EXPECT_FALSE(ExtractCubeFaces(MakeCoordImage(20, 16).View(), CubeLayout::Auto, out));            // 5:4
+    EXPECT_FALSE(ExtractCubeFaces(MakeCoordImage(16, 16).View(), CubeLayout::HorizontalCross, out)); // 高さが 3 マスでない
+    EXPECT_FALSE(ExtractCubeFaces(MakeCoordImage(18, 12).View(), CubeLayout::HorizontalCross, out)); // 幅が 4 で割れない
+    EXPECT_FALSE(ExtractCubeFaces(MakeCoordImage(3, 4).View(), CubeLayout::HorizontalStrip, out));   // 面が 0 画素
+    EXPECT_FALSE(ExtractCubeFaces(ConstImageView{}, CubeLayout::Auto, out));
+
+    const Image sheet = MakeCoordImage(12, 8);
+    EXPECT_FALSE(SplitGrid(sheet.View(), 0, 2, out));
+    EXPECT_FALSE(SplitGrid(sheet.View(), 5, 2, out));
+    EXPECT_FALSE(SplitGrid(sheet.View(), 3, 3, out));
+    EXPECT_FALSE(SplitGrid(ConstImageView{}, 1, 1, out));
+}
+
+// シートは左上から行優先で同サイズに分割される
+TEST(TextureSlices, SplitGridRowMajor) {
+    const Image sheet = MakeCoordImage(12, 8);
+    std::vector<Image> slices;
+    ASSERT_TRUE(SplitGrid(sheet.View(), 3, 2, slices));
+    ASSERT_EQ(slices.size(), 6u);
+    for (uint32_t i = 0; i < 6; ++i) {
+        const uint32_t col = i % 3, row = i / 3;
+        ASSERT_EQ(slices[i].width, 4u);
+        ASSERT_EQ(slices[i].height, 4u);
+        for (uint32_t y = 0; y < 4; ++y) {
+            for (uint32_t x = 0; x < 4; ++x) {
+                const uint8_t* p = slices[i].View().Row(y) + size_t(x) * 4;
+                EXPECT_EQ(p[0], col * 4 + x);
+                EXPECT_EQ(p[1], row * 4 + y);
+            }
+        }
+    }
+}
+
+// スライスごとに全レベルが作られ、サブリソース順に並ぶ（別のスライスの色は混ざらない）
+TEST(TextureSlices, SliceMipsPerSlice) {
+    constexpr uint32_t kWidth = 8, kHeight = 4;
+    const uint32_t levels = CalcMipCount(kWidth, kHeight);
+    ASSERT_EQ(levels, 4u);
+    const Image src[3] = { MakeSolid(kWidth, kHeight, 200, 0, 0), MakeSolid(kWidth, kHeight, 0, 100, 50),
+                           MakeCoordImage(kWidth, kHeight) };
+    const ConstImageView views[3] = { src[0].View(), src[1].View(), src[2].View() };
+
+    std::vector<Image> storage(3 * levels);
+    std::vector<ImageView> dst;
+    for (uint32_t s = 0; s < 3; ++s) {
+        for (uint32_t l = 0; l < levels; ++l) {
+            storage[s * levels + l].Allocate(MipExtent(kWidth, l), MipExtent(kHeight, l));
+            dst.push_back(storage[s * levels + l].View());
+        }
+    }
+    ASSERT_TRUE(GenerateSliceMips(views, 3, LinearOptions(), dst.data(), levels));
+
+    EXPECT_EQ(storage[2 * levels].pixels, src[2].pixels); // ミップ 0 はコピー
+    for (uint32_t l = 0; l < levels; ++l) {
+        EXPECT_EQ(storage[l].width, MipExtent(kWidth, l));
+        EXPECT_EQ(storage[l].height, MipExtent(kHeight, l));
+        EXPECT_TRUE(IsSolid(storage[l].View(), 200, 0, 0)) << "level " << l;
+        EXPECT_TRUE(IsSolid(storage[levels + l].View(), 0, 100, 50)) << "level " << l;
+    }
+
+    // ミップ 0 の大きさがスライスと違えば失敗
+    Image wrong;
+    wrong.Allocate(kWidth / 2, kHeight);
+    dst[0] = wrong.View();
+    EXPECT_FALSE(GenerateSliceMips(views, 3, LinearOptions(), dst.data(), levels));
+}
+
+// ボリュームは奥行き方向も縮み、奇数の奥行きでは端数のスライスが後ろのまとまりに入る
+TEST(TextureSlices, VolumeMipsAverageOddDepth) {
+    constexpr uint32_t kSize = 4, kDepth = 5;
+    const uint8_t gray[kDepth] = { 0, 40, 80, 120, 160 };
+    std::vector<Image> src;
+    std::vector<ConstImageView> views;
+    for (uint8_t v : gray) src.push_back(MakeSolid(kSize, kSize, v, v, v));
+    for (const Image& s : src) views.push_back(s.View());
+
+    const uint32_t levels = CalcMipCount(kSize, kSize);
+    std::vector<std::vector<Image>> storage(levels);
+    std::vector<std::vector<ImageView>> dst(levels);
+    for (uint32_t l = 0; l < levels; ++l) {
+        storage[l].resize(MipExtent(kDepth, l));
+        for (Image& img : storage[l]) {
+            img.Allocate(MipExtent(kSize, l), MipExtent(kSize, l));
+            dst[l].push_back(img.View());
+        }
+    }
+    ASSERT_TRUE(GenerateVolumeMips(views.data(), kDepth, LinearOptions(), dst));
+
+    ASSERT_EQ(storage[1].size(), 2u);
+    ASSERT_EQ(storage[2].size(), 1u);
+    for (uint32_t z = 0; z < kDepth; ++z) EXPECT_TRUE(IsSolid(storage[0][z].View(), gray[z], gray[z], gray[z]));
+    EXPECT_TRUE(IsSolid(storage[1][0].View(), 20, 20, 20));    // z = 0, 1
+    EXPECT_TRUE(IsSolid(storage[1][1].View(), 120, 120, 120)); // z = 2, 3, 4
+    EXPECT_TRUE(IsSolid(storage[2][0].View(), 80, 80, 80));    // 全部
+
+    // レベルごとの奥行き枚数が合わなければ失敗
+    dst[1].pop_back();
+    EXPECT_FALSE(GenerateVolumeMips(views.data(), kDepth, LinearOptions(), dst));
+}